@@ -176,6 +176,73 @@ namespace ImagePipeline.Tests.Cache
             CollectionAssert.AreEqual(buf1, buf2);
         }
 
+        /// <summary>
+        /// Tests that entries of 16 KB and more, read through a mapping of
+        /// the cache file, are returned in pooled memory
+        /// </summary>
+        [TestMethod]
+        public async Task TestQueriesLargeEntry()
+        {
+            ICacheKey cacheKey = new SimpleCacheKey("http://large.uri");
+            byte[] bytes = new byte[64 * 1024];
+            new Random(7).NextBytes(bytes);
+            await PutBytes(cacheKey, bytes);
+
+            using (EncodedImage image = await _bufferedDiskCache.Get(cacheKey, _isCancelled))
+            using (CloseableReference<IPooledByteBuffer> bufferRef = image.GetByteBufferRef())
+            {
+                NativePooledByteBuffer buffer = (NativePooledByteBuffer)bufferRef.Get();
+                NativeMemoryChunk chunk = buffer._bufRef.Get();
+                Assert.IsNotInstanceOfType(chunk, typeof(MappedNativeMemoryChunk));
+                Assert.IsFalse(chunk.IsReadOnly);
+
+                byte[] read = new byte[buffer.Size];
+                buffer.Read(0, read, 0, read.Length);
+                CollectionAssert.AreEqual(bytes, read);
+            }
+        }
+
+        /// <summary>
+        /// Tests that a large entry can be written again and removed while
+        /// an image read from it is still held
+        /// </summary>
+        [TestMethod]
+        public async Task TestOverwriteHeldLargeEntry()
+        {
+            RecordingCacheErrorLogger errorLogger = new RecordingCacheErrorLogger();
+            _bufferedDiskCache = new BufferedDiskCache(
+                _fileCacheFactory.Get(DiskCacheConfig.NewBuilder()
+                    .SetCacheErrorLogger(errorLogger)
+                    .Build()),
+                _byteBufferFactory,
+                _pooledByteStreams,
+                _readPriorityExecutor,
+                _writePriorityExecutor,
+                _imageCacheStatsTracker);
+
+            ICacheKey cacheKey = new SimpleCacheKey("http://overwritten.uri");
+            byte[] bytes = new byte[64 * 1024];
+            new Random(11).NextBytes(bytes);
+            await PutBytes(cacheKey, bytes);
+
+            using (EncodedImage image = await _bufferedDiskCache.Get(cacheKey, _isCancelled))
+            {
+                await PutBytes(cacheKey, bytes);
+                Assert.AreEqual(0, errorLogger.Messages.Count);
+
+                await _bufferedDiskCache.Remove(cacheKey);
+                Assert.IsFalse(_bufferedDiskCache.DiskCheckSync(cacheKey));
+
+                byte[] read = new byte[image.Size];
+                using (CloseableReference<IPooledByteBuffer> bufferRef = image.GetByteBufferRef())
+                {
+                    bufferRef.Get().Read(0, read, 0, read.Length);
+                }
+
+                CollectionAssert.AreEqual(bytes, read);
+            }
+        }
+
         /// <summary>
         /// Tests cancellation
         /// </summary>
@@ -314,5 +381,25 @@ namespace ImagePipeline.Tests.Cache
             await _bufferedDiskCache.ClearAll();
             Assert.IsTrue(0 != _stagingArea._clearAllCallsTestOnly);
         }
+
+        private async Task PutBytes(ICacheKey cacheKey, byte[] bytes)
+        {
+            using (CloseableReference<IPooledByteBuffer> bufferRef =
+                CloseableReference<IPooledByteBuffer>.of(_byteBufferFactory.NewByteBuffer(bytes)))
+            using (EncodedImage encodedImage = new EncodedImage(bufferRef))
+            {
+                await _bufferedDiskCache.Put(cacheKey, encodedImage);
+            }
+        }
+
+        private sealed class RecordingCacheErrorLogger : ICacheErrorLogger
+        {
+            public IList<string> Messages { get; } = new List<string>();
+
+            public void LogError(CacheErrorCategory category, Type clazz, string message)
+            {
+                Messages.Add(message);
+            }
+        }
     }
 }
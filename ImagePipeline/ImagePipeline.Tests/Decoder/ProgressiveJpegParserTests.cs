@@ -0,0 +1,210 @@
+﻿using FBCore.Common.Internal;
+using FBCore.Common.References;
+using ImagePipeline.Decoder;
+using ImagePipeline.Image;
+using ImagePipeline.Memory;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.Collections.Generic;
+using System.IO;
+using Windows.Storage;
+
+namespace ImagePipeline.Tests.Decoder
+{
+    /// <summary>
+    /// Tests for <see cref="ProgressiveJpegParser"/>, comparing the native
+    /// scan of native buffers with the managed parse of other buffers
+    /// </summary>
+    [TestClass]
+    public sealed class ProgressiveJpegParserTests : IDisposable
+    {
+        private const int MARKER_DQT = 0xDB;
+        private const int MARKER_DHT = 0xC4;
+        private const int MARKER_SOS = 0xDA;
+        private const int MARKER_RST0 = 0xD0;
+
+        // 10 scans with restart markers every 4 rows
+        private const int SCAN_COUNT = 10;
+
+        private PoolFactory _poolFactory;
+        private byte[] _bytes;
+        private NativePooledByteBuffer _nativeBuffer;
+
+        /// <summary>
+        /// Initialize
+        /// </summary>
+        [TestInitialize]
+        public void Initialize()
+        {
+            _poolFactory = new PoolFactory(PoolConfig.NewBuilder().Build());
+            var file = StorageFile.GetFileFromApplicationUriAsync(
+                new Uri("ms-appx:///Assets/jpegs/progressive.jpg")).GetAwaiter().GetResult();
+            using (var stream = file.OpenReadAsync().GetAwaiter().GetResult())
+            {
+                _bytes = ByteStreams.ToByteArray(stream.AsStream());
+            }
+
+            _nativeBuffer = (NativePooledByteBuffer)_poolFactory.PooledByteBufferFactory.NewByteBuffer(_bytes);
+        }
+
+        /// <summary>
+        /// Test cleanup.
+        /// </summary>
+        public void Dispose()
+        {
+            _nativeBuffer.Dispose();
+        }
+
+        /// <summary>
+        /// Tests that the whole image yields every scan, the last one
+        /// ending at EOI
+        /// </summary>
+        [TestMethod]
+        public void TestParseWholeImage()
+        {
+            IList<string> native = ParseNative(new[] { _bytes.Length });
+            IList<string> managed = ParseManaged(new[] { _bytes.Length });
+            CollectionAssert.AreEqual(managed, native);
+            Assert.AreEqual(Describe(true, SCAN_COUNT, _bytes.Length - 2), native[0]);
+        }
+
+        /// <summary>
+        /// Tests chunks ending inside a marker, a segment size, a skipped
+        /// segment, a stuffed byte and a restart marker
+        /// </summary>
+        [TestMethod]
+        public void TestSplitsInsideMarkers()
+        {
+            int sos = IndexOfMarker(MARKER_SOS, 0);
+            int stuffed = IndexOfMarker(0, sos + 2);
+            int[] ends = new[]
+            {
+                1,
+                IndexOfMarker(MARKER_DQT, 0) + 1,
+                IndexOfMarker(MARKER_DQT, 0) + 3,
+                IndexOfMarker(MARKER_DHT, 0) + 20,
+                sos + 1,
+                sos + 3,
+                sos + 5,
+                stuffed + 1,
+                IndexOfMarker(MARKER_RST0, sos) + 1,
+                IndexOfMarker(MARKER_SOS, sos + 2) + 1,
+                IndexOfMarker(MARKER_SOS, sos + 2) + 3,
+                _bytes.Length - 1,
+                _bytes.Length
+            };
+
+            IList<string> native = ParseNative(ends);
+            CollectionAssert.AreEqual(ParseManaged(ends), native);
+            Assert.AreEqual(Describe(true, SCAN_COUNT, _bytes.Length - 2), native[native.Count - 1]);
+        }
+
+        /// <summary>
+        /// Tests chunks of fixed sizes, from a byte at a time on
+        /// </summary>
+        [TestMethod]
+        public void TestFixedChunkSizes()
+        {
+            foreach (int chunkSize in new[] { 1, 2, 3, 7, 16, 17, 64, 1000 })
+            {
+                List<int> ends = new List<int>();
+                for (int end = chunkSize; end < _bytes.Length; end += chunkSize)
+                {
+                    ends.Add(end);
+                }
+
+                ends.Add(_bytes.Length);
+                IList<string> native = ParseNative(ends);
+                CollectionAssert.AreEqual(ParseManaged(ends), native, $"chunk size {chunkSize}");
+                Assert.AreEqual(Describe(true, SCAN_COUNT, _bytes.Length - 2), native[native.Count - 1]);
+            }
+        }
+
+        /// <summary>
+        /// Tests that data not starting with SOI is rejected
+        /// </summary>
+        [TestMethod]
+        public void TestNotAJpeg()
+        {
+            _bytes[1] = 0xD9;
+            _nativeBuffer.Dispose();
+            _nativeBuffer = (NativePooledByteBuffer)_poolFactory.PooledByteBufferFactory.NewByteBuffer(_bytes);
+
+            int[] ends = new[] { 1, 2, _bytes.Length };
+            IList<string> native = ParseNative(ends);
+            CollectionAssert.AreEqual(ParseManaged(ends), native);
+            Assert.AreEqual(Describe(false, 0, 0), native[native.Count - 1]);
+        }
+
+        private IList<string> ParseNative(IEnumerable<int> ends)
+        {
+            ProgressiveJpegParser parser = new ProgressiveJpegParser(_poolFactory.SmallByteArrayPool);
+            List<string> results = new List<string>();
+            foreach (int end in ends)
+            {
+                using (CloseableReference<IPooledByteBuffer> bufferRef =
+                    CloseableReference<IPooledByteBuffer>.of(_nativeBuffer.Slice(0, end)))
+                using (EncodedImage encodedImage = new EncodedImage(bufferRef))
+                {
+                    using (PooledByteBufferView view = encodedImage.GetByteBufferView())
+                    {
+                        Assert.IsNotNull(view);
+                    }
+
+                    results.Add(Parse(parser, encodedImage));
+                }
+            }
+
+            return results;
+        }
+
+        private IList<string> ParseManaged(IEnumerable<int> ends)
+        {
+            ProgressiveJpegParser parser = new ProgressiveJpegParser(_poolFactory.SmallByteArrayPool);
+            List<string> results = new List<string>();
+            foreach (int end in ends)
+            {
+                byte[] received = new byte[end];
+                Array.Copy(_bytes, received, end);
+                using (CloseableReference<IPooledByteBuffer> bufferRef =
+                    CloseableReference<IPooledByteBuffer>.of(new TrivialPooledByteBuffer(received)))
+                using (EncodedImage encodedImage = new EncodedImage(bufferRef))
+                {
+                    using (PooledByteBufferView view = encodedImage.GetByteBufferView())
+                    {
+                        Assert.IsNull(view);
+                    }
+
+                    results.Add(Parse(parser, encodedImage));
+                }
+            }
+
+            return results;
+        }
+
+        private static string Parse(ProgressiveJpegParser parser, EncodedImage encodedImage)
+        {
+            bool newScan = parser.ParseMoreData(encodedImage);
+            return $"{newScan} {parser.IsJpeg} {parser.BestScanNumber} {parser.GetBestScanEndOffset(encodedImage)}";
+        }
+
+        private static string Describe(bool isJpeg, int bestScanNumber, int bestScanEndOffset)
+        {
+            return $"{isJpeg} {isJpeg} {bestScanNumber} {bestScanEndOffset}";
+        }
+
+        private int IndexOfMarker(int marker, int start)
+        {
+            for (int i = start; i < _bytes.Length - 1; ++i)
+            {
+                if (_bytes[i] == 0xFF && _bytes[i + 1] == marker)
+                {
+                    return i;
+                }
+            }
+
+            Assert.Fail($"no marker {marker:X2}");
+            return -1;
+        }
+    }
+}
@@ -0,0 +1,189 @@
+﻿using FBCore.Common.References;
+using ImagePipeline.Memory;
+using ImagePipeline.Testing;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.IO;
+
+namespace ImagePipeline.Tests.Memory
+{
+    /// <summary>
+    /// Basic tests for <see cref="ChunkedPooledByteBuffer"/>
+    /// </summary>
+    [TestClass]
+    public sealed class ChunkedPooledByteBufferTests : IDisposable
+    {
+        private static readonly byte[] BYTES = new byte[] { 1, 4, 5, 0, 100, 34, 0, 1, 2, 2 };
+        private static readonly int[] CHUNK_SIZES = new int[] { 3, 0, 5, 2 };
+
+        private NativeMemoryChunkPool _pool;
+        private NativeMemoryChunk[] _chunks;
+        private ChunkedPooledByteBuffer _pooledByteBuffer;
+
+        /// <summary>
+        /// Initialize
+        /// </summary>
+        [TestInitialize]
+        public void Initialize()
+        {
+            _pool = new FakeNativeMemoryChunkPool();
+            _chunks = new NativeMemoryChunk[CHUNK_SIZES.Length];
+            var chunkRefs = new CloseableReference<NativeMemoryChunk>[CHUNK_SIZES.Length];
+            int offset = 0;
+            for (int i = 0; i < CHUNK_SIZES.Length; ++i)
+            {
+                // Chunks are bigger than the bytes they hold, like the
+                // buckets of the pool.
+                _chunks[i] = new FakeNativeMemoryChunk(CHUNK_SIZES[i] + 4);
+                _chunks[i].Write(0, BYTES, offset, CHUNK_SIZES[i]);
+                chunkRefs[i] = CloseableReference<NativeMemoryChunk>.of(_chunks[i], _pool);
+                offset += CHUNK_SIZES[i];
+            }
+
+            _pooledByteBuffer = new ChunkedPooledByteBuffer(chunkRefs, CHUNK_SIZES);
+            foreach (var chunkRef in chunkRefs)
+            {
+                chunkRef.Dispose();
+            }
+        }
+
+        /// <summary>
+        /// Test cleanup.
+        /// </summary>
+        public void Dispose()
+        {
+            _pooledByteBuffer.Dispose();
+            foreach (var chunk in _chunks)
+            {
+                chunk.Dispose();
+            }
+        }
+
+        /// <summary>
+        /// Tests basic operations
+        /// </summary>
+        [TestMethod]
+        public void TestBasic()
+        {
+            Assert.IsFalse(_pooledByteBuffer.IsClosed);
+            Assert.AreEqual(BYTES.Length, _pooledByteBuffer.Size);
+            Assert.AreEqual(0, _pooledByteBuffer.GetNativePtr());
+            for (int i = 0; i < _chunks.Length; ++i)
+            {
+                Assert.AreSame(_chunks[i], _pooledByteBuffer._chunkRefs[i].Get());
+            }
+        }
+
+        /// <summary>
+        /// Tests out the Read method
+        /// </summary>
+        [TestMethod]
+        public void TestSimpleRead()
+        {
+            for (int i = 0; i < BYTES.Length; ++i)
+            {
+                Assert.AreEqual(BYTES[i], _pooledByteBuffer.Read(i));
+            }
+        }
+
+        /// <summary>
+        /// Tests out the Read method in case out of bound
+        /// </summary>
+        [TestMethod]
+        public void TestSimpleReadOutOfBounds()
+        {
+            try
+            {
+                _pooledByteBuffer.Read(BYTES.Length);
+                Assert.Fail();
+            }
+            catch (ArgumentException)
+            {
+                // This is expected
+            }
+        }
+
+        /// <summary>
+        /// Tests out the Read method for every range, across chunk
+        /// boundaries
+        /// </summary>
+        [TestMethod]
+        public void TestRangeRead()
+        {
+            for (int offset = 0; offset <= BYTES.Length; ++offset)
+            {
+                for (int length = 0; offset + length <= BYTES.Length; ++length)
+                {
+                    byte[] readBuf = new byte[length + 2];
+                    _pooledByteBuffer.Read(offset, readBuf, 1, length);
+                    Assert.AreEqual(0, readBuf[0]);
+                    Assert.AreEqual(0, readBuf[length + 1]);
+                    for (int i = 0; i < length; ++i)
+                    {
+                        Assert.AreEqual(BYTES[offset + i], readBuf[i + 1]);
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests out the Read method in case out of bound
+        /// </summary>
+        [TestMethod]
+        public void TestRangeReadOutOfBounds()
+        {
+            try
+            {
+                byte[] readBuf = new byte[BYTES.Length];
+                _pooledByteBuffer.Read(1, readBuf, 0, BYTES.Length);
+                Assert.Fail();
+            }
+            catch (ArgumentException)
+            {
+                // This is expected
+            }
+        }
+
+        /// <summary>
+        /// Tests out the Read method using stream
+        /// </summary>
+        [TestMethod]
+        public void TestReadFromStream()
+        {
+            Stream inputStream = new PooledByteBufferInputStream(_pooledByteBuffer);
+            byte[] tmp = new byte[BYTES.Length + 1];
+            int bytesRead = inputStream.Read(tmp, 0, tmp.Length);
+            Assert.AreEqual(BYTES.Length, bytesRead);
+            for (int i = 0; i < BYTES.Length; i++)
+            {
+                Assert.AreEqual(BYTES[i], tmp[i]);
+            }
+
+            Assert.AreEqual(-1, inputStream.ReadByte());
+        }
+
+        /// <summary>
+        /// Tests out the Dispose method
+        /// </summary>
+        [TestMethod]
+        public void TestClose()
+        {
+            MockPoolStatsTracker statsTracker = (MockPoolStatsTracker)_pool._poolStatsTracker;
+            Assert.AreEqual(0, statsTracker.FreeCallCount);
+            _pooledByteBuffer.Dispose();
+            Assert.IsTrue(_pooledByteBuffer.IsClosed);
+            Assert.IsNull(_pooledByteBuffer._chunkRefs);
+            Assert.AreEqual(CHUNK_SIZES.Length, statsTracker.FreeCallCount);
+
+            try
+            {
+                int size = _pooledByteBuffer.Size;
+                Assert.Fail();
+            }
+            catch (ClosedException)
+            {
+                // This is expected
+            }
+        }
+    }
+}
@@ -0,0 +1,143 @@
+﻿using FBCore.Common.References;
+using ImagePipeline.Memory;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.IO;
+using Windows.Storage;
+
+namespace ImagePipeline.Tests.Memory
+{
+    /// <summary>
+    /// Tests for <see cref="MappedNativeMemoryChunk"/>
+    /// </summary>
+    [TestClass]
+    public sealed class MappedNativeMemoryChunkTests : IDisposable
+    {
+        private static readonly byte[] BYTES = new byte[] { 1, 4, 5, 0, 100, 34, 0, 1, 2, 2 };
+
+        private string _path;
+
+        /// <summary>
+        /// Initialize
+        /// </summary>
+        [TestInitialize]
+        public void Initialize()
+        {
+            _path = Path.Combine(
+                ApplicationData.Current.TemporaryFolder.Path,
+                Guid.NewGuid().ToString());
+
+            File.WriteAllBytes(_path, BYTES);
+        }
+
+        /// <summary>
+        /// Test cleanup.
+        /// </summary>
+        public void Dispose()
+        {
+            File.Delete(_path);
+        }
+
+        /// <summary>
+        /// Tests reading the mapped file
+        /// </summary>
+        [TestMethod]
+        public void TestRead()
+        {
+            using (MappedNativeMemoryChunk chunk = MappedNativeMemoryChunk.Map(_path))
+            {
+                Assert.IsNotNull(chunk);
+                Assert.IsTrue(chunk.IsReadOnly);
+                Assert.AreEqual(BYTES.Length, chunk.Size);
+
+                byte[] data = new byte[BYTES.Length];
+                Assert.AreEqual(BYTES.Length, chunk.Read(0, data, 0, data.Length));
+                CollectionAssert.AreEqual(BYTES, data);
+                Assert.AreEqual((byte)100, chunk.Read(4));
+            }
+        }
+
+        /// <summary>
+        /// Tests copying the mapped file to native memory
+        /// </summary>
+        [TestMethod]
+        public void TestReadToNativeMemory()
+        {
+            using (MappedNativeMemoryChunk chunk = MappedNativeMemoryChunk.Map(_path))
+            using (NativeMemoryChunk destination = new NativeMemoryChunk(BYTES.Length))
+            {
+                Assert.AreEqual(BYTES.Length, chunk.Read(0, destination.GetNativePtr(), BYTES.Length));
+                byte[] data = new byte[BYTES.Length];
+                destination.Read(0, data, 0, data.Length);
+                CollectionAssert.AreEqual(BYTES, data);
+
+                destination.Write(0, new byte[BYTES.Length], 0, BYTES.Length);
+                chunk.Copy(0, destination, 0, BYTES.Length);
+                destination.Read(0, data, 0, data.Length);
+                CollectionAssert.AreEqual(BYTES, data);
+            }
+        }
+
+        /// <summary>
+        /// Tests reading the mapped file through a pooled byte buffer
+        /// </summary>
+        [TestMethod]
+        public void TestPooledByteBuffer()
+        {
+            MappedNativeMemoryChunk chunk = MappedNativeMemoryChunk.Map(_path);
+            CloseableReference<NativeMemoryChunk> chunkRef =
+                CloseableReference<NativeMemoryChunk>.of(chunk);
+
+            NativePooledByteBuffer buffer = new NativePooledByteBuffer(chunkRef, chunk.Size);
+            chunkRef.Dispose();
+            Assert.IsFalse(chunk.Closed);
+            Assert.AreEqual((byte)34, buffer.Read(5));
+
+            buffer.Dispose();
+            Assert.IsTrue(chunk.Closed);
+        }
+
+        /// <summary>
+        /// Tests that mapped chunks can't be written to
+        /// </summary>
+        [TestMethod]
+        public void TestWriteFails()
+        {
+            using (MappedNativeMemoryChunk chunk = MappedNativeMemoryChunk.Map(_path))
+            using (NativeMemoryChunk source = new NativeMemoryChunk(BYTES.Length))
+            {
+                try
+                {
+                    chunk.Write(0, BYTES, 0, BYTES.Length);
+                    Assert.Fail();
+                }
+                catch (InvalidOperationException)
+                {
+                    // This is expected
+                }
+
+                try
+                {
+                    source.Copy(0, chunk, 0, BYTES.Length);
+                    Assert.Fail();
+                }
+                catch (InvalidOperationException)
+                {
+                    // This is expected
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that missing and empty files are not mapped
+        /// </summary>
+        [TestMethod]
+        public void TestMapFails()
+        {
+            Assert.IsNull(MappedNativeMemoryChunk.Map(_path + ".missing"));
+
+            File.WriteAllBytes(_path, new byte[0]);
+            Assert.IsNull(MappedNativeMemoryChunk.Map(_path));
+        }
+    }
+}
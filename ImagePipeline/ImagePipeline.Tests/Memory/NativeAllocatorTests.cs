@@ -0,0 +1,115 @@
+﻿using ImagePipeline.Memory;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System.Collections.Generic;
+
+namespace ImagePipeline.Tests.Memory
+{
+    /// <summary>
+    /// Tests for NativeAllocator
+    /// </summary>
+    [TestClass]
+    public class NativeAllocatorTests
+    {
+        private const int LARGE_CHUNK_SIZE = 3 * 1024 * 1024;
+
+        /// <summary>
+        /// Tests that chunks up to 1 MB come from arenas
+        /// </summary>
+        [TestMethod]
+        public void TestSmallChunks()
+        {
+            NativeAllocatorStats before = NativeAllocator.GetStats();
+            using (NativeMemoryChunk chunk = new NativeMemoryChunk(1024 * 1024))
+            {
+                NativeAllocatorStats stats = NativeAllocator.GetStats();
+                Assert.IsTrue(stats.ArenaCount >= 1);
+                Assert.AreEqual(before.LargeBlockCount, stats.LargeBlockCount);
+                Assert.IsTrue(stats.UsedBytes >= 1024 * 1024);
+                Assert.IsTrue(stats.ReservedBytes >= stats.UsedBytes);
+            }
+        }
+
+        /// <summary>
+        /// Tests that freed chunks are counted while the thread caches
+        /// them
+        /// </summary>
+        [TestMethod]
+        public void TestCachedChunks()
+        {
+            const int size = 64 * 1024;
+            NativeMemoryChunk chunk = new NativeMemoryChunk(size);
+            NativeAllocatorStats before = NativeAllocator.GetStats();
+            Assert.IsTrue(before.CachedBytes <= before.UsedBytes);
+
+            chunk.Dispose();
+            NativeAllocatorStats stats = NativeAllocator.GetStats();
+            Assert.AreEqual(before.CachedBytes + size, stats.CachedBytes);
+            Assert.AreEqual(before.UsedBytes, stats.UsedBytes);
+        }
+
+        /// <summary>
+        /// Tests that larger chunks are mapped one by one and kept for
+        /// reuse once freed
+        /// </summary>
+        [TestMethod]
+        public void TestLargeChunk()
+        {
+            NativeAllocator.Trim();
+            NativeAllocatorStats before = NativeAllocator.GetStats();
+            NativeMemoryChunk chunk = new NativeMemoryChunk(LARGE_CHUNK_SIZE);
+            NativeAllocatorStats stats = NativeAllocator.GetStats();
+            Assert.AreEqual(before.LargeBlockCount + 1, stats.LargeBlockCount);
+            Assert.IsTrue(stats.ReservedBytes - before.ReservedBytes >= LARGE_CHUNK_SIZE);
+
+            byte[] data = new byte[] { 1, 2, 3 };
+            chunk.Write(LARGE_CHUNK_SIZE - data.Length, data, 0, data.Length);
+            Assert.AreEqual((byte)3, chunk.Read(LARGE_CHUNK_SIZE - 1));
+
+            chunk.Dispose();
+            NativeAllocatorStats freed = NativeAllocator.GetStats();
+            Assert.AreEqual(stats.LargeBlockCount, freed.LargeBlockCount);
+            Assert.AreEqual(stats.ReservedBytes, freed.ReservedBytes);
+            Assert.IsTrue(freed.CachedBytes - stats.CachedBytes >= LARGE_CHUNK_SIZE);
+
+            // Slightly smaller chunks reuse the freed block
+            using (new NativeMemoryChunk(LARGE_CHUNK_SIZE - 64 * 1024))
+            {
+                stats = NativeAllocator.GetStats();
+                Assert.AreEqual(freed.ReservedBytes, stats.ReservedBytes);
+                Assert.AreEqual(freed.LargeBlockCount, stats.LargeBlockCount);
+            }
+
+            NativeAllocator.Trim();
+            stats = NativeAllocator.GetStats();
+            Assert.AreEqual(before.LargeBlockCount, stats.LargeBlockCount);
+            Assert.AreEqual(before.ReservedBytes, stats.ReservedBytes);
+        }
+
+        /// <summary>
+        /// Tests that Trim releases the arenas no longer used
+        /// </summary>
+        [TestMethod]
+        public void TestTrim()
+        {
+            NativeAllocator.Trim();
+            NativeAllocatorStats before = NativeAllocator.GetStats();
+
+            List<NativeMemoryChunk> chunks = new List<NativeMemoryChunk>();
+            for (int i = 0; i < 64; ++i)
+            {
+                chunks.Add(new NativeMemoryChunk(128 * 1024));
+            }
+
+            Assert.IsTrue(NativeAllocator.GetStats().ReservedBytes > before.ReservedBytes);
+            foreach (NativeMemoryChunk chunk in chunks)
+            {
+                chunk.Dispose();
+            }
+
+            NativeAllocator.Trim();
+            NativeAllocatorStats stats = NativeAllocator.GetStats();
+            Assert.AreEqual(before.ReservedBytes, stats.ReservedBytes);
+            Assert.AreEqual(before.UsedBytes, stats.UsedBytes);
+        }
+    }
+}
@@ -156,5 +156,100 @@ namespace ImagePipeline.Tests.Memory
                 }
             }
         }
+
+        /// <summary>
+        /// Tests out the Compare method
+        /// </summary>
+        [TestMethod]
+        public void TestCompare()
+        {
+            int size = 128;
+            using (NativeMemoryChunk nativeMemoryChunk = new NativeMemoryChunk(size))
+            {
+                byte[] src = new byte[size];
+                for (int i = 0; i < size; ++i)
+                {
+                    src[i] = (byte)i;
+                }
+
+                nativeMemoryChunk.Write(0, src, 0, size);
+                Assert.AreEqual(0, nativeMemoryChunk.Compare(0, src, 0, size));
+                Assert.AreEqual(0, nativeMemoryChunk.Compare(10, src, 10, 20));
+                Assert.IsTrue(nativeMemoryChunk.Compare(11, src, 10, 20) > 0);
+                Assert.IsTrue(nativeMemoryChunk.Compare(10, src, 11, 20) < 0);
+            }
+        }
+
+        /// <summary>
+        /// Tests out the IndexOf methods
+        /// </summary>
+        [TestMethod]
+        public void TestIndexOf()
+        {
+            int size = 128;
+            using (NativeMemoryChunk nativeMemoryChunk = new NativeMemoryChunk(size))
+            {
+                byte[] src = new byte[size];
+                src[40] = 0xFF;
+                src[41] = 0xDA;
+                src[90] = 0xFF;
+                src[91] = 0xD9;
+                nativeMemoryChunk.Write(0, src, 0, size);
+
+                Assert.AreEqual(40, nativeMemoryChunk.IndexOf(0, size, 0xFF));
+                Assert.AreEqual(90, nativeMemoryChunk.IndexOf(41, size - 41, 0xFF));
+                Assert.AreEqual(-1, nativeMemoryChunk.IndexOf(0, 40, 0xFF));
+                Assert.AreEqual(90, nativeMemoryChunk.IndexOf(0, size, new byte[] { 0xFF, 0xD9 }));
+                Assert.AreEqual(-1, nativeMemoryChunk.IndexOf(0, 91, new byte[] { 0xFF, 0xD9 }));
+            }
+        }
+
+        /// <summary>
+        /// Tests out the Gather and Scatter methods
+        /// </summary>
+        [TestMethod]
+        public void TestGatherScatter()
+        {
+            int size = 128;
+            using (NativeMemoryChunk nativeMemoryChunk = new NativeMemoryChunk(size),
+                                     nativeMemoryChunk2 = new NativeMemoryChunk(size))
+            {
+                byte[] src = new byte[size];
+                for (int i = 0; i < size; ++i)
+                {
+                    src[i] = (byte)i;
+                }
+
+                NativeMemoryChunk[] chunks = new NativeMemoryChunk[]
+                {
+                    nativeMemoryChunk2, nativeMemoryChunk, nativeMemoryChunk2
+                };
+
+                int[] offsets = new int[] { 0, 64, 100 };
+                int[] counts = new int[] { 10, 64, 28 };
+                Assert.AreEqual(102, NativeMemoryChunk.Scatter(src, 5, chunks, offsets, counts));
+                Assert.AreEqual(5, nativeMemoryChunk2.Read(0));
+                Assert.AreEqual(15, nativeMemoryChunk.Read(64));
+                Assert.AreEqual(79, nativeMemoryChunk2.Read(100));
+
+                byte[] dst = new byte[size];
+                Assert.AreEqual(102, NativeMemoryChunk.Gather(chunks, offsets, counts, dst, 0));
+                for (int i = 0; i < 102; ++i)
+                {
+                    Assert.AreEqual(src[i + 5], dst[i]);
+                }
+
+                try
+                {
+                    counts[2] = 29;
+                    NativeMemoryChunk.Gather(chunks, offsets, counts, dst, 0);
+                    Assert.Fail();
+                }
+                catch (ArgumentException)
+                {
+                    // This is expected
+                }
+            }
+        }
     }
 }
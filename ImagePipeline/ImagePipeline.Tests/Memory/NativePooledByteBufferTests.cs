@@ -153,6 +153,46 @@ namespace ImagePipeline.Tests.Memory
             Assert.AreEqual(1, statsTracker.FreeCallCount);
         }
 
+        /// <summary>
+        /// Tests that a slice reads from the shared chunk and keeps it
+        /// out of the pool until it is closed
+        /// </summary>
+        [TestMethod]
+        public void TestSlice()
+        {
+            MockPoolStatsTracker statsTracker = (MockPoolStatsTracker)_pool._poolStatsTracker;
+            NativePooledByteBuffer slice = _pooledByteBuffer.Slice(2, 4);
+            Assert.AreEqual(4, slice.Size);
+            Assert.AreEqual(_pooledByteBuffer.GetNativePtr() + 2, slice.GetNativePtr());
+            byte[] bytes = new byte[4];
+            slice.Read(0, bytes, 0, 4);
+            CollectionAssert.AreEqual(new byte[] { 5, 0, 100, 34 }, bytes);
+            Assert.AreEqual(BYTES[5], slice.Read(3));
+
+            _pooledByteBuffer.Dispose();
+            Assert.AreEqual(0, statsTracker.FreeCallCount);
+            Assert.AreEqual(BYTES[2], slice.Read(0));
+            slice.Dispose();
+            Assert.AreEqual(1, statsTracker.FreeCallCount);
+        }
+
+        /// <summary>
+        /// Tests that a slice cannot extend past its buffer
+        /// </summary>
+        [TestMethod]
+        public void TestSliceOutOfBounds()
+        {
+            try
+            {
+                _pooledByteBuffer.Slice(BUFFER_LENGTH - 1, 2);
+                Assert.Fail();
+            }
+            catch (ArgumentException)
+            {
+                // This is expected
+            }
+        }
+
         /// <summary>
         /// Tests out the ClosedException
         /// </summary>
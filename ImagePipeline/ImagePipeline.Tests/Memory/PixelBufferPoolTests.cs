@@ -0,0 +1,123 @@
+﻿#if HAS_LIBWEBP && HAS_LIBJPEGTURBO
+using FBCore.Common.Internal;
+using FBCore.Common.Memory;
+using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.IO;
+using Windows.Storage;
+
+namespace ImagePipeline.Tests.Memory
+{
+    /// <summary>
+    /// Tests for <see cref="PixelBufferPool"/>, which webp to jpeg
+    /// transcoding leases the decoded pixels from
+    /// </summary>
+    [TestClass]
+    public sealed class PixelBufferPoolTests : IDisposable
+    {
+        private const int WIDTH = 240;
+        private const int HEIGHT = 181;
+
+        private PoolFactory _poolFactory;
+        private NativeMemoryChunk _lossy;
+        private NativeMemoryChunk _large;
+
+        /// <summary>
+        /// Initialize
+        /// </summary>
+        [TestInitialize]
+        public void Initialize()
+        {
+            _poolFactory = new PoolFactory(PoolConfig.NewBuilder().Build());
+            _lossy = ReadAsset("ms-appx:///Assets/webps/lossy.webp");
+
+            // 4096x3072, more than the pool keeps once decoded
+            _large = ReadAsset("ms-appx:///Assets/webps/large.webp");
+            PixelBufferPool.Trim();
+        }
+
+        /// <summary>
+        /// Clean up
+        /// </summary>
+        public void Dispose()
+        {
+            _lossy.Dispose();
+            _large.Dispose();
+        }
+
+        /// <summary>
+        /// Tests that the buffer of a transcoded image returns to the pool
+        /// and is reused by the next image of the same size
+        /// </summary>
+        [TestMethod]
+        public void TestLeaseAndReuse()
+        {
+            Assert.AreEqual(0, PixelBufferPool.GetFreeBytes());
+
+            Transcode(_lossy);
+            long freeBytes = PixelBufferPool.GetFreeBytes();
+            Assert.IsTrue(freeBytes >= WIDTH * HEIGHT * 3);
+
+            Transcode(_lossy);
+            Assert.AreEqual(freeBytes, PixelBufferPool.GetFreeBytes());
+        }
+
+        /// <summary>
+        /// Tests that buffers above the size limit are released rather
+        /// than kept
+        /// </summary>
+        [TestMethod]
+        public void TestSizeLimit()
+        {
+            Transcode(_large);
+            Assert.AreEqual(0, PixelBufferPool.GetFreeBytes());
+
+            Transcode(_lossy);
+            Assert.IsTrue(PixelBufferPool.GetFreeBytes() > 0);
+        }
+
+        /// <summary>
+        /// Tests that trimming the native memory pool releases the free
+        /// pixel buffers too
+        /// </summary>
+        [TestMethod]
+        public void TestTrim()
+        {
+            Transcode(_lossy);
+            Assert.IsTrue(PixelBufferPool.GetFreeBytes() > 0);
+
+            _poolFactory.NativeMemoryChunkPool.Trim(MemoryTrimType.OnCloseToDalvikHeapLimit);
+            Assert.AreEqual(0, PixelBufferPool.GetFreeBytes());
+        }
+
+        private void Transcode(NativeMemoryChunk webp)
+        {
+            using (PooledByteBufferOutputStream outputStream =
+                _poolFactory.PooledByteBufferFactory.NewOutputStream())
+            {
+                WebpTranscoder.TranscodeWebpToJpeg(
+                    webp.GetNativePtr(),
+                    webp.Size,
+                    outputStream.AsIStream(),
+                    new JpegEncodeOptions(80));
+
+                Assert.IsTrue(outputStream.Size > 0);
+            }
+        }
+
+        private static NativeMemoryChunk ReadAsset(string asset)
+        {
+            var file = StorageFile.GetFileFromApplicationUriAsync(new Uri(asset)).GetAwaiter().GetResult();
+            using (var stream = file.OpenReadAsync().GetAwaiter().GetResult())
+            {
+                byte[] encoded = ByteStreams.ToByteArray(stream.AsStream());
+                var chunk = new NativeMemoryChunk(encoded.Length);
+                chunk.Write(0, encoded, 0, encoded.Length);
+                return chunk;
+            }
+        }
+    }
+}
+#endif // HAS_LIBWEBP && HAS_LIBJPEGTURBO
@@ -86,6 +86,35 @@ namespace ImagePipeline.Tests.Memory
             }
         }
 
+        /// <summary>
+        /// Tests out the Seek method from the beginning of the stream
+        /// </summary>
+        [TestMethod]
+        public void TestSeekBegin()
+        {
+            _pooledByteArrayBufferedInputStream.ReadByte();
+            _pooledByteArrayBufferedInputStream.ReadByte();
+            Assert.AreEqual(5, _pooledByteArrayBufferedInputStream.Seek(5, SeekOrigin.Begin));
+            Assert.AreEqual(5, _pooledByteArrayBufferedInputStream.ReadByte());
+            Assert.AreEqual(250, _pooledByteArrayBufferedInputStream.Seek(-6, SeekOrigin.End));
+            Assert.AreEqual(250, _pooledByteArrayBufferedInputStream.ReadByte());
+        }
+
+        /// <summary>
+        /// Tests out the ReadByte method
+        /// </summary>
+        [TestMethod]
+        public void TestReadByte()
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                Assert.AreEqual(i, _pooledByteArrayBufferedInputStream.ReadByte());
+                Assert.AreEqual(i + 1, _pooledByteArrayBufferedInputStream.Position);
+            }
+
+            Assert.AreEqual(-1, _pooledByteArrayBufferedInputStream.ReadByte());
+        }
+
         /// <summary>
         /// Tests out the Read method
         /// </summary>
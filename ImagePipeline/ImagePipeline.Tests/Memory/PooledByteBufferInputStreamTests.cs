@@ -162,6 +162,53 @@ namespace ImagePipeline.Tests.Memory
             }
         }
 
+        /// <summary>
+        /// Tests out the ReadByte method
+        /// </summary>
+        [TestMethod]
+        public void TestReadByte()
+        {
+            for (int i = 0; i < BYTES.Length; ++i)
+            {
+                Assert.AreEqual(BYTES[i], _stream.ReadByte());
+                Assert.AreEqual(i + 1, _stream._currentOffset);
+            }
+
+            Assert.AreEqual(-1, _stream.ReadByte());
+            Assert.AreEqual(BYTES.Length, _stream._currentOffset);
+
+            _stream.Seek(2, SeekOrigin.Begin);
+            Assert.AreEqual(BYTES[2], _stream.ReadByte());
+        }
+
+        /// <summary>
+        /// Tests out the ReadByte method across several blocks
+        /// </summary>
+        [TestMethod]
+        public void TestReadByteBlocks()
+        {
+            byte[] bytes = new byte[PooledByteBufferInputStream.BLOCK_SIZE * 2 + 7];
+            for (int i = 0; i < bytes.Length; ++i)
+            {
+                bytes[i] = (byte)(i * 7);
+            }
+
+            PooledByteBufferInputStream stream = new PooledByteBufferInputStream(
+                new TrivialPooledByteBuffer(bytes));
+
+            for (int i = 0; i < bytes.Length; i += 3)
+            {
+                Assert.AreEqual(bytes[i], stream.ReadByte());
+                stream.Seek(2, SeekOrigin.Current);
+            }
+
+            // Reading back before the current block
+            stream.Seek(5, SeekOrigin.Begin);
+            Assert.AreEqual(bytes[5], stream.ReadByte());
+            Assert.AreEqual(bytes.Length, stream.Seek(0, SeekOrigin.End));
+            Assert.AreEqual(-1, stream.ReadByte());
+        }
+
         /// <summary>
         /// Tests out the empty stream creation
         /// </summary>
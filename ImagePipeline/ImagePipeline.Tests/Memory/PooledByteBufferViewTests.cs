@@ -0,0 +1,114 @@
+﻿using FBCore.Common.References;
+using ImagePipeline.Memory;
+using ImagePipeline.Testing;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.IO;
+
+namespace ImagePipeline.Tests.Memory
+{
+    /// <summary>
+    /// Tests for <see cref="PooledByteBufferView"/>
+    /// </summary>
+    [TestClass]
+    public sealed class PooledByteBufferViewTests : IDisposable
+    {
+        private static readonly byte[] BYTES = new byte[] { 1, 4, 5, 0, 100, 34, 0, 1, 2, 2 };
+
+        private NativeMemoryChunk _chunk;
+        private MockResourceReleaser<IPooledByteBuffer> _releaser;
+        private CloseableReference<IPooledByteBuffer> _bufferRef;
+
+        /// <summary>
+        /// Initialize
+        /// </summary>
+        [TestInitialize]
+        public void Initialize()
+        {
+            _chunk = new NativeMemoryChunk(BYTES.Length);
+            _chunk.Write(0, BYTES, 0, BYTES.Length);
+            CloseableReference<NativeMemoryChunk> chunkRef =
+                CloseableReference<NativeMemoryChunk>.of(_chunk);
+
+            _releaser = new MockResourceReleaser<IPooledByteBuffer>();
+            _bufferRef = CloseableReference<IPooledByteBuffer>.of(
+                new NativePooledByteBuffer(chunkRef, 2, BYTES.Length - 2),
+                _releaser);
+
+            chunkRef.Dispose();
+        }
+
+        /// <summary>
+        /// Test cleanup.
+        /// </summary>
+        public void Dispose()
+        {
+            CloseableReference<IPooledByteBuffer>.CloseSafely(_bufferRef);
+            _chunk.Dispose();
+        }
+
+        /// <summary>
+        /// Tests reading the bytes through the view
+        /// </summary>
+        [TestMethod]
+        public void TestRead()
+        {
+            using (PooledByteBufferView view = PooledByteBufferView.Create(_bufferRef))
+            {
+                Assert.AreEqual(BYTES.Length - 2, view.Size);
+                Assert.AreEqual(BYTES.Length - 2, view.Length);
+                Assert.AreEqual(_chunk.GetNativePtr() + 2, view.NativePtr);
+                Assert.IsFalse(view.CanWrite);
+
+                byte[] buffer = new byte[BYTES.Length];
+                Assert.AreEqual(BYTES.Length - 2, view.Read(buffer, 0, buffer.Length));
+                for (int i = 0; i < BYTES.Length - 2; ++i)
+                {
+                    Assert.AreEqual(BYTES[i + 2], buffer[i]);
+                }
+
+                view.Seek(1, SeekOrigin.Begin);
+                Assert.AreEqual(BYTES[3], view.ReadByte());
+            }
+        }
+
+        /// <summary>
+        /// Tests that the view keeps the buffer alive until closed
+        /// </summary>
+        [TestMethod]
+        public void TestKeepsBufferAlive()
+        {
+            PooledByteBufferView view = PooledByteBufferView.Create(_bufferRef);
+            _bufferRef.Dispose();
+            Assert.AreEqual(0, _releaser.ReleasedCallCount);
+            Assert.AreEqual(BYTES[2], view.ReadByte());
+
+            view.Dispose();
+            Assert.AreEqual(1, _releaser.ReleasedCallCount);
+            try
+            {
+                long nativePtr = view.NativePtr;
+                Assert.Fail();
+            }
+            catch (ObjectDisposedException)
+            {
+                // This is expected
+            }
+        }
+
+        /// <summary>
+        /// Tests that buffers outside native memory have no view
+        /// </summary>
+        [TestMethod]
+        public void TestManagedBuffer()
+        {
+            using (CloseableReference<IPooledByteBuffer> bufferRef =
+                CloseableReference<IPooledByteBuffer>.of(new TrivialPooledByteBuffer(BYTES)))
+            {
+                Assert.IsNull(PooledByteBufferView.Create(bufferRef));
+            }
+
+            Assert.IsNull(PooledByteBufferView.Create(null));
+        }
+    }
+}
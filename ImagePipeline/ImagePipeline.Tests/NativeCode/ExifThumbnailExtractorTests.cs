@@ -0,0 +1,173 @@
+﻿using FBCore.Common.Internal;
+using ImageFormatUtils;
+using ImagePipeline.Image;
+using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.IO;
+using System.Linq;
+using Windows.Storage;
+
+namespace ImagePipeline.Tests.NativeCode
+{
+    /// <summary>
+    /// Tests for <see cref="ExifThumbnailExtractor"/>
+    /// </summary>
+    [TestClass]
+    public sealed class ExifThumbnailExtractorTests
+    {
+        private IPooledByteBufferFactory _byteBufferFactory;
+        private byte[] _thumbnail;
+        private byte[] _jpegWithThumbnail;
+
+        /// <summary>
+        /// Initialize
+        /// </summary>
+        [TestInitialize]
+        public void Initialize()
+        {
+            _byteBufferFactory = new PoolFactory(PoolConfig.NewBuilder().Build()).PooledByteBufferFactory;
+            _thumbnail = ReadAsset("ms-appx:///Assets/jpegs/1.jpeg");
+            _jpegWithThumbnail = AddExifThumbnail(
+                ReadAsset("ms-appx:///Assets/jpegs/2.jpeg"), _thumbnail);
+        }
+
+        /// <summary>
+        /// Tests that the thumbnail is found in place with its dimensions
+        /// and the rotation of the enclosing jpeg
+        /// </summary>
+        [TestMethod]
+        public void TestGetThumbnail()
+        {
+            EncodedImage thumbnail;
+            using (IPooledByteBuffer buffer = _byteBufferFactory.NewByteBuffer(_jpegWithThumbnail))
+            {
+                thumbnail = ExifThumbnailExtractor.GetThumbnail(buffer);
+            }
+
+            // The thumbnail keeps the memory alive after the buffer is closed
+            using (thumbnail)
+            {
+                Assert.AreEqual(ImageFormat.JPEG, thumbnail.Format);
+                Assert.AreEqual(240, thumbnail.Width);
+                Assert.AreEqual(181, thumbnail.Height);
+                Assert.AreEqual(90, thumbnail.RotationAngle);
+                Assert.AreEqual(_thumbnail.Length, thumbnail.Size);
+                CollectionAssert.AreEqual(
+                    _thumbnail,
+                    ByteStreams.ToByteArray(thumbnail.GetInputStream()));
+            }
+        }
+
+        /// <summary>
+        /// Tests that the beginning of the jpeg is enough
+        /// </summary>
+        [TestMethod]
+        public void TestGetThumbnailFromHeader()
+        {
+            byte[] header = _jpegWithThumbnail.Take(_thumbnail.Length + 100).ToArray();
+            using (IPooledByteBuffer buffer = _byteBufferFactory.NewByteBuffer(header))
+            using (EncodedImage thumbnail = ExifThumbnailExtractor.GetThumbnail(buffer))
+            {
+                Assert.IsNotNull(thumbnail);
+                Assert.AreEqual(_thumbnail.Length, thumbnail.Size);
+            }
+        }
+
+        /// <summary>
+        /// Tests jpegs without a complete thumbnail
+        /// </summary>
+        [TestMethod]
+        public void TestNoThumbnail()
+        {
+            byte[][] jpegs = new byte[][]
+            {
+                ReadAsset("ms-appx:///Assets/jpegs/beach.jpg"),
+                _jpegWithThumbnail.Take(_thumbnail.Length).ToArray(),
+                new byte[] { 0xFF, 0xD8, 0xFF, 0xE1, 0x00 }
+            };
+
+            foreach (byte[] jpeg in jpegs)
+            {
+                using (IPooledByteBuffer buffer = _byteBufferFactory.NewByteBuffer(jpeg))
+                {
+                    Assert.IsNull(ExifThumbnailExtractor.GetThumbnail(buffer));
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that buffers outside native memory are ignored
+        /// </summary>
+        [TestMethod]
+        public void TestManagedBuffer()
+        {
+            using (IPooledByteBuffer buffer = new TrivialPooledByteBuffer(_jpegWithThumbnail))
+            {
+                Assert.IsNull(ExifThumbnailExtractor.GetThumbnail(buffer));
+            }
+        }
+
+        /// <summary>
+        /// Inserts a big endian EXIF segment right after the SOI marker of
+        /// jpeg, with orientation 6 in IFD0 and thumbnail in IFD1.
+        /// </summary>
+        private static byte[] AddExifThumbnail(byte[] jpeg, byte[] thumbnail)
+        {
+            using (var stream = new MemoryStream())
+            {
+                const int TIFF_HEADER_LENGTH = 56;
+                int segmentLength = 2 + 6 + TIFF_HEADER_LENGTH + thumbnail.Length;
+
+                stream.Write(new byte[] { 0xFF, 0xD8, 0xFF, 0xE1 }, 0, 4);
+                WriteBigEndian(stream, segmentLength, 2);
+                stream.Write(new byte[] { (byte)'E', (byte)'x', (byte)'i', (byte)'f', 0, 0 }, 0, 6);
+
+                // TIFF header, IFD0 at 8
+                stream.Write(new byte[] { (byte)'M', (byte)'M', 0, 0x2A }, 0, 4);
+                WriteBigEndian(stream, 8, 4);
+
+                // IFD0 with the orientation, IFD1 at 26
+                WriteBigEndian(stream, 1, 2);
+                WriteIfdEntry(stream, 0x0112, 3, 6 << 16);
+                WriteBigEndian(stream, 26, 4);
+
+                // IFD1 with JPEGInterchangeFormat and its length
+                WriteBigEndian(stream, 2, 2);
+                WriteIfdEntry(stream, 0x0201, 4, TIFF_HEADER_LENGTH);
+                WriteIfdEntry(stream, 0x0202, 4, thumbnail.Length);
+                WriteBigEndian(stream, 0, 4);
+
+                stream.Write(thumbnail, 0, thumbnail.Length);
+                stream.Write(jpeg, 2, jpeg.Length - 2);
+                return stream.ToArray();
+            }
+        }
+
+        private static void WriteIfdEntry(Stream stream, int tag, int type, int value)
+        {
+            WriteBigEndian(stream, tag, 2);
+            WriteBigEndian(stream, type, 2);
+            WriteBigEndian(stream, 1, 4);
+            WriteBigEndian(stream, value, 4);
+        }
+
+        private static void WriteBigEndian(Stream stream, int value, int length)
+        {
+            for (int i = length - 1; i >= 0; --i)
+            {
+                stream.WriteByte((byte)(value >> (8 * i)));
+            }
+        }
+
+        private static byte[] ReadAsset(string asset)
+        {
+            var file = StorageFile.GetFileFromApplicationUriAsync(new Uri(asset)).GetAwaiter().GetResult();
+            using (var stream = file.OpenReadAsync().GetAwaiter().GetResult())
+            {
+                return ByteStreams.ToByteArray(stream.AsStream());
+            }
+        }
+    }
+}
@@ -0,0 +1,522 @@
+﻿using FBCore.Common.Internal;
+using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using System.Runtime.InteropServices;
+using Windows.Storage;
+
+namespace ImagePipeline.Tests.NativeCode
+{
+    /// <summary>
+    /// Tests for <see cref="GifAnimation"/>
+    /// </summary>
+    [TestClass]
+    public sealed class GifAnimationTests
+    {
+        private const string DOG_GIF = "ms-appx:///Assets/gifs/dog.gif";
+
+        private const int BYTES_PER_PIXEL = 4;
+        private const int CACHE_CAPACITY = 8 * 1024 * 1024;
+        private const int KEYFRAME_INTERVAL = 8;
+        private const int SEEK_COUNT = 200;
+
+        private const int SYNTHETIC_WIDTH = 64;
+        private const int SYNTHETIC_HEIGHT = 48;
+        private const int SYNTHETIC_FRAME_COUNT = 300;
+        private const int SYNTHETIC_COLORS = 128;
+        private const int SYNTHETIC_DURATION_MS = 40;
+
+        private const int DISPOSAL_KEEP = 1;
+        private const int DISPOSAL_RESTORE_TO_BACKGROUND = 2;
+        private const int DISPOSAL_RESTORE_TO_PREVIOUS = 3;
+
+        /// <summary>
+        /// Tests reading the size, frames and loop count of the asset
+        /// </summary>
+        [TestMethod]
+        public void TestDogInfo()
+        {
+            using (GifAnimation animation = Create(ReadAsset(DOG_GIF), CACHE_CAPACITY, KEYFRAME_INTERVAL))
+            {
+                Assert.AreEqual(110, animation.Width);
+                Assert.AreEqual(110, animation.Height);
+                Assert.AreEqual(12, animation.FrameCount);
+                Assert.AreEqual(0, animation.LoopCount);
+                for (int i = 0; i < animation.FrameCount; ++i)
+                {
+                    Assert.AreEqual(200, animation.GetFrameDurationMs(i));
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that the size accounts for the copy of the encoded bytes
+        /// along with the canvases and the cache
+        /// </summary>
+        [TestMethod]
+        public void TestSizeInBytes()
+        {
+            byte[] encoded = ReadAsset(DOG_GIF);
+            using (GifAnimation animation = Create(encoded, CACHE_CAPACITY, KEYFRAME_INTERVAL))
+            {
+                int canvasSize = animation.Width * animation.Height * BYTES_PER_PIXEL;
+                Assert.IsTrue(
+                    animation.SizeInBytes >= encoded.Length + 2 * canvasSize + CACHE_CAPACITY);
+            }
+        }
+
+        /// <summary>
+        /// Tests that frames of the asset render the same whether they
+        /// are played in order or seeked to
+        /// </summary>
+        [TestMethod]
+        public void TestDogSeek()
+        {
+            VerifySeek(ReadAsset(DOG_GIF), "dog.gif");
+        }
+
+        /// <summary>
+        /// Tests that frames rendered in other pixel formats match the
+        /// RGBA frame converted
+        /// </summary>
+        [TestMethod]
+        public void TestRenderPixelFormats()
+        {
+            using (GifAnimation animation = Create(ReadAsset(DOG_GIF), CACHE_CAPACITY, KEYFRAME_INTERVAL))
+            {
+                for (int i = 0; i < animation.FrameCount; ++i)
+                {
+                    byte[] rgba = Render(animation, i);
+                    byte[] bgra = Render(animation, i, NativePixelFormat.BGRA_PREMULTIPLIED);
+                    byte[] rgb565 = Render(animation, i, NativePixelFormat.RGB565);
+                    byte[] grayAlpha = Render(animation, i, NativePixelFormat.GRAY_ALPHA);
+                    for (int pixel = 0; pixel < rgba.Length / BYTES_PER_PIXEL; ++pixel)
+                    {
+                        int r = rgba[pixel * 4];
+                        int g = rgba[pixel * 4 + 1];
+                        int b = rgba[pixel * 4 + 2];
+                        int a = rgba[pixel * 4 + 3];
+                        Assert.AreEqual((b * a + 127) / 255, bgra[pixel * 4], $"frame {i}");
+                        Assert.AreEqual((g * a + 127) / 255, bgra[pixel * 4 + 1], $"frame {i}");
+                        Assert.AreEqual((r * a + 127) / 255, bgra[pixel * 4 + 2], $"frame {i}");
+                        Assert.AreEqual(a, bgra[pixel * 4 + 3], $"frame {i}");
+
+                        int packed = ((r & 0xf8) << 8) | ((g & 0xfc) << 3) | (b >> 3);
+                        Assert.AreEqual(packed, BitConverter.ToUInt16(rgb565, pixel * 2), $"frame {i}");
+
+                        int luma = (19595 * r + 38470 * g + 7471 * b + 32768) >> 16;
+                        Assert.AreEqual(luma, grayAlpha[pixel * 2], $"frame {i}");
+                        Assert.AreEqual(a, grayAlpha[pixel * 2 + 1], $"frame {i}");
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that frames of a long animation mixing every disposal
+        /// method and transparency composite as expected
+        /// </summary>
+        [TestMethod]
+        public void TestSyntheticAnimation()
+        {
+            List<byte[]> expected;
+            byte[] encoded = CreateSyntheticGif(new Random(18), SYNTHETIC_FRAME_COUNT, out expected);
+            using (GifAnimation animation = Create(encoded, CACHE_CAPACITY, KEYFRAME_INTERVAL))
+            {
+                Assert.AreEqual(SYNTHETIC_WIDTH, animation.Width);
+                Assert.AreEqual(SYNTHETIC_HEIGHT, animation.Height);
+                Assert.AreEqual(SYNTHETIC_FRAME_COUNT, animation.FrameCount);
+                Assert.AreEqual(0, animation.LoopCount);
+                for (int i = 0; i < SYNTHETIC_FRAME_COUNT; ++i)
+                {
+                    Assert.AreEqual(SYNTHETIC_DURATION_MS, animation.GetFrameDurationMs(i));
+                    Assert.IsTrue(expected[i].SequenceEqual(Render(animation, i)), $"frame {i}");
+                }
+
+                // Playing in order decodes each frame once
+                Assert.AreEqual(SYNTHETIC_FRAME_COUNT, animation.DecodedFrameCount);
+            }
+        }
+
+        /// <summary>
+        /// Tests that seeking a long animation replays at most
+        /// KEYFRAME_INTERVAL frames
+        /// </summary>
+        [TestMethod]
+        public void TestSyntheticSeek()
+        {
+            List<byte[]> expected;
+            byte[] encoded = CreateSyntheticGif(new Random(18), SYNTHETIC_FRAME_COUNT, out expected);
+            VerifySeek(encoded, "synthetic");
+        }
+
+        /// <summary>
+        /// Tests that without keyframes going back replays from the first
+        /// frame
+        /// </summary>
+        [TestMethod]
+        public void TestSeekWithoutCache()
+        {
+            List<byte[]> expected;
+            byte[] encoded = CreateSyntheticGif(new Random(18), SYNTHETIC_FRAME_COUNT, out expected);
+            using (GifAnimation animation = Create(encoded, 0, KEYFRAME_INTERVAL))
+            {
+                int last = SYNTHETIC_FRAME_COUNT - 1;
+                Render(animation, last);
+                int decoded = animation.DecodedFrameCount;
+                Assert.IsTrue(expected[last - 1].SequenceEqual(Render(animation, last - 1)));
+                Assert.AreEqual(last, animation.DecodedFrameCount - decoded);
+            }
+        }
+
+        /// <summary>
+        /// Tests that truncated animations keep their complete frames and
+        /// that invalid ones fail
+        /// </summary>
+        [TestMethod]
+        public void TestTruncated()
+        {
+            List<byte[]> expected;
+            byte[] encoded = CreateSyntheticGif(new Random(18), SYNTHETIC_FRAME_COUNT, out expected);
+            byte[] truncated = encoded.Take(encoded.Length / 2).ToArray();
+            using (GifAnimation animation = Create(truncated, CACHE_CAPACITY, KEYFRAME_INTERVAL))
+            {
+                Assert.IsTrue(animation.FrameCount > 0);
+                Assert.IsTrue(animation.FrameCount < SYNTHETIC_FRAME_COUNT);
+                for (int i = 0; i < animation.FrameCount; ++i)
+                {
+                    Assert.IsTrue(expected[i].SequenceEqual(Render(animation, i)), $"frame {i}");
+                }
+            }
+
+            // Header only, garbage
+            foreach (byte[] invalid in new[] { encoded.Take(800).ToArray(), Enumerable.Repeat((byte)0x47, 100).ToArray() })
+            {
+                try
+                {
+                    Create(invalid, CACHE_CAPACITY, KEYFRAME_INTERVAL).Dispose();
+                    Assert.Fail();
+                }
+                catch (SEHException)
+                {
+                    // This is expected
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that a frame larger than any valid gif ends the animation
+        /// instead of being decoded
+        /// </summary>
+        [TestMethod]
+        public void TestOversizedFrame()
+        {
+            List<byte[]> expected;
+            byte[] encoded = CreateSyntheticGif(new Random(18), SYNTHETIC_FRAME_COUNT, out expected);
+            byte[] oversized = new byte[]
+            {
+                // Image descriptor of 65535x65535 pixels
+                0x2c, 0, 0, 0, 0, 0xff, 0xff, 0xff, 0xff, 0,
+
+                // Clear and end codes only
+                7, 2, 0x80, 0x81, 0,
+
+                // Trailer
+                0x3b
+            };
+
+            byte[] malformed = encoded.Take(encoded.Length - 1).Concat(oversized).ToArray();
+            using (GifAnimation animation = Create(malformed, CACHE_CAPACITY, KEYFRAME_INTERVAL))
+            {
+                Assert.AreEqual(SYNTHETIC_FRAME_COUNT, animation.FrameCount);
+                for (int i = 0; i < animation.FrameCount; ++i)
+                {
+                    Assert.IsTrue(expected[i].SequenceEqual(Render(animation, i)), $"frame {i}");
+                }
+            }
+
+            // No frame left
+            byte[] header = encoded.Take(13 + SYNTHETIC_COLORS * 3).ToArray();
+            try
+            {
+                Create(header.Concat(oversized).ToArray(), CACHE_CAPACITY, KEYFRAME_INTERVAL).Dispose();
+                Assert.Fail();
+            }
+            catch (SEHException)
+            {
+                // This is expected
+            }
+        }
+
+        /// <summary>
+        /// Reports how long frames take to render when played in order
+        /// and when seeked to
+        /// </summary>
+        [TestMethod]
+        public void TestFrameTiming()
+        {
+            List<byte[]> expected;
+            byte[] encoded = CreateSyntheticGif(new Random(18), SYNTHETIC_FRAME_COUNT, out expected);
+            foreach (var entry in new Dictionary<string, byte[]>
+            {
+                { "dog.gif", ReadAsset(DOG_GIF) },
+                { "synthetic", encoded }
+            })
+            {
+                using (GifAnimation animation = Create(entry.Value, CACHE_CAPACITY, KEYFRAME_INTERVAL))
+                {
+                    int size = animation.Width * animation.Height * BYTES_PER_PIXEL;
+                    using (var pixels = new NativeMemoryChunk(size))
+                    {
+                        var stopwatch = Stopwatch.StartNew();
+                        for (int i = 0; i < animation.FrameCount; ++i)
+                        {
+                            animation.RenderFrame(
+                                i,
+                                NativePixelFormat.RGBA,
+                                pixels.GetNativePtr(),
+                                animation.Width * BYTES_PER_PIXEL,
+                                size);
+                        }
+
+                        double playTime = stopwatch.Elapsed.TotalMilliseconds / animation.FrameCount;
+
+                        var random = new Random(18);
+                        stopwatch.Restart();
+                        for (int i = 0; i < SEEK_COUNT; ++i)
+                        {
+                            animation.RenderFrame(
+                                random.Next(animation.FrameCount),
+                                NativePixelFormat.RGBA,
+                                pixels.GetNativePtr(),
+                                animation.Width * BYTES_PER_PIXEL,
+                                size);
+                        }
+
+                        double seekTime = stopwatch.Elapsed.TotalMilliseconds / SEEK_COUNT;
+                        Debug.WriteLine(
+                            $"{entry.Key} {animation.Width}x{animation.Height}, " +
+                            $"{animation.FrameCount} frames: " +
+                            $"{playTime:F3} ms per frame played, {seekTime:F3} ms per seek");
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Plays the animation once, then renders random frames and
+        /// checks them against the ones played, and that each replays at
+        /// most KEYFRAME_INTERVAL frames.
+        /// </summary>
+        private static void VerifySeek(byte[] encoded, string name)
+        {
+            using (GifAnimation animation = Create(encoded, CACHE_CAPACITY, KEYFRAME_INTERVAL))
+            {
+                var played = new List<byte[]>();
+                for (int i = 0; i < animation.FrameCount; ++i)
+                {
+                    played.Add(Render(animation, i));
+                }
+
+                var random = new Random(18);
+                for (int i = 0; i < SEEK_COUNT; ++i)
+                {
+                    int index = random.Next(animation.FrameCount);
+                    int decoded = animation.DecodedFrameCount;
+                    Assert.IsTrue(played[index].SequenceEqual(Render(animation, index)), $"{name} frame {index}");
+                    Assert.IsTrue(animation.DecodedFrameCount - decoded <= KEYFRAME_INTERVAL, $"{name} frame {index}");
+                }
+            }
+        }
+
+        private static GifAnimation Create(byte[] encoded, int cacheCapacity, int keyframeInterval)
+        {
+            using (var src = new NativeMemoryChunk(encoded.Length))
+            {
+                src.Write(0, encoded, 0, encoded.Length);
+                return new GifAnimation(src.GetNativePtr(), encoded.Length, cacheCapacity, keyframeInterval);
+            }
+        }
+
+        private static byte[] Render(GifAnimation animation, int index)
+        {
+            return Render(animation, index, NativePixelFormat.RGBA);
+        }
+
+        private static byte[] Render(GifAnimation animation, int index, NativePixelFormat pixelFormat)
+        {
+            int stride = animation.Width * JpegDecoder.GetBytesPerPixel(pixelFormat);
+            int size = stride * animation.Height;
+            using (var pixels = new NativeMemoryChunk(size))
+            {
+                animation.RenderFrame(index, pixelFormat, pixels.GetNativePtr(), stride, size);
+                byte[] result = new byte[size];
+                pixels.Read(0, result, 0, size);
+                return result;
+            }
+        }
+
+        private static byte[] ReadAsset(string asset)
+        {
+            var file = StorageFile.GetFileFromApplicationUriAsync(new Uri(asset)).GetAwaiter().GetResult();
+            using (var stream = file.OpenReadAsync().GetAwaiter().GetResult())
+            {
+                return ByteStreams.ToByteArray(stream.AsStream());
+            }
+        }
+
+        /// <summary>
+        /// Encodes an animation of random rectangles over an opaque first
+        /// frame, and composites the frames it should render to.
+        /// </summary>
+        private static byte[] CreateSyntheticGif(Random random, int frameCount, out List<byte[]> expected)
+        {
+            byte[] palette = new byte[SYNTHETIC_COLORS * 3];
+            for (int i = 0; i < SYNTHETIC_COLORS; ++i)
+            {
+                palette[i * 3] = (byte)(i * 2);
+                palette[i * 3 + 1] = (byte)(255 - i * 2);
+                palette[i * 3 + 2] = (byte)(i * 37);
+            }
+
+            var output = new MemoryStream();
+            var writer = new BinaryWriter(output);
+            writer.Write(new byte[] { (byte)'G', (byte)'I', (byte)'F', (byte)'8', (byte)'9', (byte)'a' });
+            writer.Write((ushort)SYNTHETIC_WIDTH);
+            writer.Write((ushort)SYNTHETIC_HEIGHT);
+
+            // Global color table of 128 entries, background 0
+            writer.Write(new byte[] { 0xf6, 0, 0 });
+            writer.Write(palette);
+
+            // Loop forever
+            writer.Write(new byte[] { 0x21, 0xff, 11 });
+            writer.Write(new byte[] { (byte)'N', (byte)'E', (byte)'T', (byte)'S', (byte)'C', (byte)'A', (byte)'P', (byte)'E', (byte)'2', (byte)'.', (byte)'0' });
+            writer.Write(new byte[] { 3, 1, 0, 0, 0 });
+
+            expected = new List<byte[]>();
+            byte[] canvas = new byte[SYNTHETIC_WIDTH * SYNTHETIC_HEIGHT * BYTES_PER_PIXEL];
+            for (int frame = 0; frame < frameCount; ++frame)
+            {
+                int x = 0;
+                int y = 0;
+                int width = SYNTHETIC_WIDTH;
+                int height = SYNTHETIC_HEIGHT;
+                int disposal = DISPOSAL_KEEP;
+                int transparentIndex = -1;
+                if (frame > 0)
+                {
+                    x = random.Next(SYNTHETIC_WIDTH);
+                    y = random.Next(SYNTHETIC_HEIGHT);
+                    width = 1 + random.Next(SYNTHETIC_WIDTH - x);
+                    height = 1 + random.Next(SYNTHETIC_HEIGHT - y);
+                    disposal = DISPOSAL_KEEP + random.Next(3);
+                    transparentIndex = (random.Next(2) == 0) ? 0 : -1;
+                }
+
+                byte[] indices = new byte[width * height];
+                for (int i = 0; i < indices.Length; ++i)
+                {
+                    indices[i] = (byte)random.Next(SYNTHETIC_COLORS);
+                }
+
+                // Graphic control extension
+                writer.Write(new byte[] { 0x21, 0xf9, 4 });
+                writer.Write((byte)((disposal << 2) | (transparentIndex >= 0 ? 1 : 0)));
+                writer.Write((ushort)(SYNTHETIC_DURATION_MS / 10));
+                writer.Write((byte)Math.Max(transparentIndex, 0));
+                writer.Write((byte)0);
+
+                // Image descriptor without local color table
+                writer.Write((byte)0x2c);
+                writer.Write((ushort)x);
+                writer.Write((ushort)y);
+                writer.Write((ushort)width);
+                writer.Write((ushort)height);
+                writer.Write((byte)0);
+                WriteImageData(writer, indices);
+
+                // Composite the expected frame
+                byte[] previous = (byte[])canvas.Clone();
+                for (int row = 0; row < height; ++row)
+                {
+                    for (int column = 0; column < width; ++column)
+                    {
+                        int index = indices[row * width + column];
+                        if (index == transparentIndex)
+                        {
+                            continue;
+                        }
+
+                        int offset = ((y + row) * SYNTHETIC_WIDTH + x + column) * BYTES_PER_PIXEL;
+                        canvas[offset] = palette[index * 3];
+                        canvas[offset + 1] = palette[index * 3 + 1];
+                        canvas[offset + 2] = palette[index * 3 + 2];
+                        canvas[offset + 3] = 0xff;
+                    }
+                }
+
+                expected.Add((byte[])canvas.Clone());
+                if (disposal == DISPOSAL_RESTORE_TO_PREVIOUS)
+                {
+                    canvas = previous;
+                }
+                else if (disposal == DISPOSAL_RESTORE_TO_BACKGROUND)
+                {
+                    for (int row = 0; row < height; ++row)
+                    {
+                        Array.Clear(
+                            canvas,
+                            ((y + row) * SYNTHETIC_WIDTH + x) * BYTES_PER_PIXEL,
+                            width * BYTES_PER_PIXEL);
+                    }
+                }
+            }
+
+            writer.Write((byte)0x3b);
+            writer.Flush();
+            return output.ToArray();
+        }
+
+        /// <summary>
+        /// Writes indices of 7 bits without compressing them. Codes are 8
+        /// bits wide as long as the code table is cleared before it grows
+        /// past 256 entries.
+        /// </summary>
+        private static void WriteImageData(BinaryWriter writer, byte[] indices)
+        {
+            const int minCodeSize = 7;
+            const byte clearCode = 1 << minCodeSize;
+            const byte endCode = clearCode + 1;
+            const int literalsPerClear = (1 << minCodeSize) - 2;
+
+            var codes = new List<byte>();
+            for (int i = 0; i < indices.Length; ++i)
+            {
+                if (i % literalsPerClear == 0)
+                {
+                    codes.Add(clearCode);
+                }
+
+                codes.Add(indices[i]);
+            }
+
+            codes.Add(endCode);
+
+            writer.Write((byte)minCodeSize);
+            for (int offset = 0; offset < codes.Count; offset += 255)
+            {
+                int count = Math.Min(255, codes.Count - offset);
+                writer.Write((byte)count);
+                writer.Write(codes.GetRange(offset, count).ToArray());
+            }
+
+            writer.Write((byte)0);
+        }
+    }
+}
@@ -0,0 +1,168 @@
+﻿#if HAS_LIBJPEGTURBO
+using FBCore.Common.Internal;
+using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.IO;
+using System.Linq;
+using System.Runtime.InteropServices.WindowsRuntime;
+using System.Threading.Tasks;
+using Windows.Graphics.Imaging;
+using Windows.Storage;
+using Windows.Storage.Streams;
+
+namespace ImagePipeline.Tests.NativeCode
+{
+    /// <summary>
+    /// Tests for <see cref="JpegDecoder"/>
+    /// </summary>
+    [TestClass]
+    public sealed class JpegDecoderTests
+    {
+        private static readonly string[] ASSETS = new string[]
+        {
+            "ms-appx:///Assets/jpegs/1.jpeg",
+            "ms-appx:///Assets/jpegs/5.jpeg",
+            "ms-appx:///Assets/jpegs/beach.jpg",
+            "ms-appx:///Assets/jpegs/progressive.jpg"
+        };
+
+        /// <summary>
+        /// Value of the bytes padding the rows, never written by the
+        /// decoder.
+        /// </summary>
+        private const byte PADDING = 0xCD;
+
+        /// <summary>
+        /// libjpeg-turbo and the platform decoder round the inverse DCT
+        /// and the chroma upsampling differently.
+        /// </summary>
+        private const double MAX_MEAN_DIFFERENCE = 3;
+
+        /// <summary>
+        /// Tests that images decode at the size of the platform decoder,
+        /// scaled by the scale numerator, into rows with padding
+        /// </summary>
+        [TestMethod]
+        public async Task TestDecodeSize()
+        {
+            foreach (string asset in ASSETS)
+            {
+                byte[] encoded = ReadAsset(asset);
+                BitmapDecoder platformDecoder = await CreatePlatformDecoderAsync(encoded);
+                using (var src = new NativeMemoryChunk(encoded.Length))
+                {
+                    src.Write(0, encoded, 0, encoded.Length);
+                    foreach (int scaleNumerator in new[] { 8, 4, 2, 1 })
+                    {
+                        string message = asset + " scaled by " + scaleNumerator + "/8";
+                        int width;
+                        int height;
+                        JpegDecoder.GetDecodeSize(
+                            src.GetNativePtr(), src.Size, scaleNumerator, null, out width, out height);
+
+                        Assert.AreEqual(
+                            (int)(platformDecoder.PixelWidth * scaleNumerator + 7) / 8, width, message);
+                        Assert.AreEqual(
+                            (int)(platformDecoder.PixelHeight * scaleNumerator + 7) / 8, height, message);
+
+                        int rowLength = width * 4;
+                        int stride = rowLength + 12;
+                        byte[] pixels = Decode(src, scaleNumerator, stride, height);
+                        for (int y = 0; y < height; ++y)
+                        {
+                            for (int x = rowLength; x < stride; ++x)
+                            {
+                                Assert.AreEqual(PADDING, pixels[y * stride + x], message);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that the decoded pixels are the ones of the platform
+        /// decoder
+        /// </summary>
+        [TestMethod]
+        public async Task TestDecodePixels()
+        {
+            foreach (string asset in ASSETS)
+            {
+                byte[] encoded = ReadAsset(asset);
+                BitmapDecoder platformDecoder = await CreatePlatformDecoderAsync(encoded);
+                PixelDataProvider pixelData = await platformDecoder.GetPixelDataAsync(
+                    BitmapPixelFormat.Rgba8,
+                    BitmapAlphaMode.Straight,
+                    new BitmapTransform(),
+                    ExifOrientationMode.IgnoreExifOrientation,
+                    ColorManagementMode.DoNotColorManage);
+
+                byte[] expected = pixelData.DetachPixelData();
+                using (var src = new NativeMemoryChunk(encoded.Length))
+                {
+                    src.Write(0, encoded, 0, encoded.Length);
+                    int width = (int)platformDecoder.PixelWidth;
+                    int height = (int)platformDecoder.PixelHeight;
+                    byte[] actual = Decode(src, 8, width * 4, height);
+                    Assert.AreEqual(expected.Length, actual.Length, asset);
+
+                    long difference = 0;
+                    for (int i = 0; i < expected.Length; ++i)
+                    {
+                        difference += Math.Abs(expected[i] - actual[i]);
+                    }
+
+                    double meanDifference = (double)difference / expected.Length;
+                    Assert.IsTrue(
+                        meanDifference < MAX_MEAN_DIFFERENCE, asset + ": " + meanDifference);
+                }
+            }
+        }
+
+        private static byte[] Decode(
+            NativeMemoryChunk src,
+            int scaleNumerator,
+            int stride,
+            int height)
+        {
+            byte[] pixels = Enumerable.Repeat(PADDING, stride * height).ToArray();
+            using (var dst = new NativeMemoryChunk(pixels.Length))
+            {
+                dst.Write(0, pixels, 0, pixels.Length);
+                JpegDecoder.DecodeJpeg(
+                    src.GetNativePtr(),
+                    src.Size,
+                    scaleNumerator,
+                    null,
+                    NativePixelFormat.RGBA,
+                    dst.GetNativePtr(),
+                    stride,
+                    dst.Size);
+
+                dst.Read(0, pixels, 0, pixels.Length);
+                return pixels;
+            }
+        }
+
+        private static async Task<BitmapDecoder> CreatePlatformDecoderAsync(byte[] encoded)
+        {
+            var stream = new InMemoryRandomAccessStream();
+            await stream.WriteAsync(encoded.AsBuffer());
+            stream.Seek(0);
+            return await BitmapDecoder.CreateAsync(BitmapDecoder.JpegDecoderId, stream);
+        }
+
+        private static byte[] ReadAsset(string asset)
+        {
+            var file = StorageFile.GetFileFromApplicationUriAsync(new Uri(asset)).GetAwaiter().GetResult();
+            using (var stream = file.OpenReadAsync().GetAwaiter().GetResult())
+            {
+                return ByteStreams.ToByteArray(stream.AsStream());
+            }
+        }
+    }
+}
+#endif // HAS_LIBJPEGTURBO
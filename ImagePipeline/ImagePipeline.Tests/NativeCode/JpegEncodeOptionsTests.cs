@@ -0,0 +1,108 @@
+﻿using ImagePipeline.NativeCode;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+
+namespace ImagePipeline.Tests.NativeCode
+{
+    /// <summary>
+    /// Tests for <see cref="JpegEncodeOptions"/>
+    /// </summary>
+    [TestClass]
+    public class JpegEncodeOptionsTests
+    {
+        /// <summary>
+        /// Tests that the quality only constructor keeps libjpeg defaults
+        /// </summary>
+        [TestMethod]
+        public void TestDefaults()
+        {
+            JpegEncodeOptions options = new JpegEncodeOptions(85);
+            Assert.AreEqual(85, options.Quality);
+            Assert.IsFalse(options.OptimizeCoding);
+            Assert.IsFalse(options.Progressive);
+            Assert.AreEqual(JpegSubsampling.YUV_420, options.Subsampling);
+            Assert.AreEqual(JpegDctMethod.ISLOW, options.DctMethod);
+            Assert.AreEqual(0, options.RestartRows);
+        }
+
+        /// <summary>
+        /// Tests the named presets
+        /// </summary>
+        [TestMethod]
+        public void TestPresets()
+        {
+            JpegEncodeOptions fastest = JpegEncodeOptions.FromPreset(JpegEncodePreset.FASTEST, 70);
+            Assert.AreEqual(70, fastest.Quality);
+            Assert.IsFalse(fastest.OptimizeCoding);
+            Assert.IsFalse(fastest.Progressive);
+            Assert.AreEqual(JpegDctMethod.IFAST, fastest.DctMethod);
+
+            JpegEncodeOptions balanced = JpegEncodeOptions.FromPreset(JpegEncodePreset.BALANCED, 70);
+            Assert.IsTrue(balanced.OptimizeCoding);
+            Assert.IsFalse(balanced.Progressive);
+            Assert.AreEqual(JpegDctMethod.ISLOW, balanced.DctMethod);
+
+            JpegEncodeOptions smallest = JpegEncodeOptions.FromPreset(JpegEncodePreset.SMALLEST, 70);
+            Assert.IsTrue(smallest.OptimizeCoding);
+            Assert.IsTrue(smallest.Progressive);
+            Assert.AreEqual(JpegSubsampling.YUV_420, smallest.Subsampling);
+        }
+
+        /// <summary>
+        /// Tests that options with the same parameters are equal
+        /// </summary>
+        [TestMethod]
+        public void TestEquals()
+        {
+            JpegEncodeOptions options = new JpegEncodeOptions(
+                90, true, false, JpegSubsampling.YUV_444, JpegDctMethod.FLOAT);
+
+            JpegEncodeOptions same = new JpegEncodeOptions(
+                90, true, false, JpegSubsampling.YUV_444, JpegDctMethod.FLOAT);
+
+            Assert.AreEqual(options, same);
+            Assert.AreEqual(options.GetHashCode(), same.GetHashCode());
+            Assert.AreNotEqual(options, new JpegEncodeOptions(90));
+        }
+
+        /// <summary>
+        /// Tests that restart rows out of range are rejected
+        /// </summary>
+        [TestMethod]
+        public void TestRestartRowsOutOfRange()
+        {
+            try
+            {
+                new JpegEncodeOptions(
+                    85,
+                    false,
+                    false,
+                    JpegSubsampling.YUV_420,
+                    JpegDctMethod.ISLOW,
+                    JpegEncodeOptions.MAX_RESTART_ROWS + 1);
+                Assert.Fail();
+            }
+            catch (ArgumentException)
+            {
+                // This is expected
+            }
+        }
+
+        /// <summary>
+        /// Tests that quality out of range is rejected
+        /// </summary>
+        [TestMethod]
+        public void TestQualityOutOfRange()
+        {
+            try
+            {
+                new JpegEncodeOptions(JpegTranscoder.MAX_QUALITY + 1);
+                Assert.Fail();
+            }
+            catch (ArgumentException)
+            {
+                // This is expected
+            }
+        }
+    }
+}
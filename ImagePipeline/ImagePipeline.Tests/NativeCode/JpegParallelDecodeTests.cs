@@ -0,0 +1,249 @@
+﻿#if HAS_LIBJPEGTURBO
+using FBCore.Common.Internal;
+using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.IO;
+using System.Linq;
+using Windows.Storage;
+
+namespace ImagePipeline.Tests.NativeCode
+{
+    /// <summary>
+    /// Compares serial and restart marker parallel jpeg decoding
+    /// </summary>
+    [TestClass]
+    public sealed class JpegParallelDecodeTests : IDisposable
+    {
+        private static readonly string[] ASSETS = new string[]
+        {
+            "ms-appx:///Assets/jpegs/1.jpeg",
+            "ms-appx:///Assets/jpegs/2.jpeg",
+            "ms-appx:///Assets/jpegs/3.jpeg",
+            "ms-appx:///Assets/jpegs/4.jpeg",
+            "ms-appx:///Assets/jpegs/5.jpeg",
+            "ms-appx:///Assets/jpegs/beach.jpg"
+        };
+
+        /// <summary>
+        /// The synthetic images are at least this large, the size of a
+        /// photo taken by a recent phone camera.
+        /// </summary>
+        private const int SYNTHETIC_MIN_PIXELS = 24 * 1000 * 1000;
+
+        /// <summary>
+        /// Fixed rather than the hardware thread count, so that images
+        /// are split the same way on any machine.
+        /// </summary>
+        private const int PARALLEL_THREADS = 4;
+
+        private static readonly JpegEncodeOptions SYNTHETIC_ENCODE_OPTIONS = new JpegEncodeOptions(
+            90, true, false, JpegSubsampling.YUV_420, JpegDctMethod.ISLOW, 1);
+
+        /// <summary>
+        /// Initialize
+        /// </summary>
+        [TestInitialize]
+        public void Initialize()
+        {
+            JpegDecoder.SetMaxDecodeThreads(0);
+        }
+
+        /// <summary>
+        /// Clean up
+        /// </summary>
+        public void Dispose()
+        {
+            JpegDecoder.SetMaxDecodeThreads(0);
+        }
+
+        /// <summary>
+        /// Tests that the assets, too small to be split, decode the same
+        /// with any number of threads
+        /// </summary>
+        [TestMethod]
+        public void TestAssets()
+        {
+            foreach (string asset in ASSETS)
+            {
+                byte[] encoded = ReadAsset(asset);
+                Assert.AreEqual(1, Compare(asset, encoded, JpegTranscoder.SCALE_DENOMINATOR), asset);
+            }
+        }
+
+        /// <summary>
+        /// Tests that large images with restart markers are split into
+        /// bands and decode the same on several threads
+        /// </summary>
+        [TestMethod]
+        public void TestSyntheticImages()
+        {
+            foreach (string asset in ASSETS.Take(2))
+            {
+                byte[] encoded = CreateSyntheticImage(ReadAsset(asset));
+                Assert.IsTrue(Compare(asset + " upscaled", encoded, 2) > 1, asset);
+                Assert.IsTrue(Compare(asset + " upscaled", encoded, 4) > 1, asset);
+            }
+        }
+
+        /// <summary>
+        /// Tests that resizing transcodes produce the same bytes on
+        /// several threads
+        /// </summary>
+        [TestMethod]
+        public void TestSyntheticTranscode()
+        {
+            byte[] encoded = CreateSyntheticImage(ReadAsset(ASSETS[0]));
+            JpegEncodeOptions encodeOptions = JpegEncodeOptions.FromPreset(JpegEncodePreset.BALANCED, 85);
+            using (var src = new NativeMemoryChunk(encoded.Length))
+            {
+                src.Write(0, encoded, 0, encoded.Length);
+
+                JpegDecoder.SetMaxDecodeThreads(1);
+                byte[] serial = Transcode(src, encoded.Length, 2, encodeOptions);
+
+                JpegDecoder.SetMaxDecodeThreads(PARALLEL_THREADS);
+                Assert.IsTrue(JpegDecoder.GetRestartBandCount(src.GetNativePtr(), encoded.Length) > 1);
+                byte[] parallel = Transcode(src, encoded.Length, 2, encodeOptions);
+
+                Assert.IsTrue(serial.SequenceEqual(parallel));
+            }
+        }
+
+        /// <summary>
+        /// Tests that negative thread counts are rejected
+        /// </summary>
+        [TestMethod]
+        public void TestNegativeThreads()
+        {
+            try
+            {
+                JpegDecoder.SetMaxDecodeThreads(-1);
+                Assert.Fail();
+            }
+            catch (ArgumentException)
+            {
+                // This is expected
+            }
+        }
+
+        private static byte[] ReadAsset(string asset)
+        {
+            var file = StorageFile.GetFileFromApplicationUriAsync(new Uri(asset)).GetAwaiter().GetResult();
+            using (var stream = file.OpenReadAsync().GetAwaiter().GetResult())
+            {
+                return ByteStreams.ToByteArray(stream.AsStream());
+            }
+        }
+
+        /// <summary>
+        /// Doubles the size of the image until it is large enough, with a
+        /// restart marker after every MCU row.
+        /// </summary>
+        private static byte[] CreateSyntheticImage(byte[] encoded)
+        {
+            while (true)
+            {
+                int width;
+                int height;
+                using (var src = new NativeMemoryChunk(encoded.Length))
+                {
+                    src.Write(0, encoded, 0, encoded.Length);
+                    JpegDecoder.GetDecodeSize(
+                        src.GetNativePtr(),
+                        encoded.Length,
+                        JpegTranscoder.SCALE_DENOMINATOR,
+                        null,
+                        out width,
+                        out height);
+
+                    if ((long)width * height >= SYNTHETIC_MIN_PIXELS)
+                    {
+                        return encoded;
+                    }
+
+                    encoded = Transcode(
+                        src,
+                        encoded.Length,
+                        JpegTranscoder.MAX_SCALE_NUMERATOR,
+                        SYNTHETIC_ENCODE_OPTIONS);
+                }
+            }
+        }
+
+        private static byte[] Transcode(
+            NativeMemoryChunk src,
+            int length,
+            int scaleNumerator,
+            JpegEncodeOptions encodeOptions)
+        {
+            using (var output = new MemoryStream())
+            {
+                JpegTranscoder.TranscodeJpegFromMemory(
+                    src.GetNativePtr(),
+                    length,
+                    output.AsIStream(),
+                    new JpegTranscodeOptions(0, scaleNumerator, null, null, encodeOptions));
+
+                return output.ToArray();
+            }
+        }
+
+        private static byte[] Decode(NativeMemoryChunk src, int length, int scaleNumerator)
+        {
+            int width;
+            int height;
+            JpegDecoder.GetDecodeSize(
+                src.GetNativePtr(),
+                length,
+                scaleNumerator,
+                null,
+                out width,
+                out height);
+
+            int stride = width * JpegDecoder.GetBytesPerPixel(NativePixelFormat.RGB);
+            int size = stride * height;
+            using (var pixels = new NativeMemoryChunk(size))
+            {
+                JpegDecoder.DecodeJpeg(
+                    src.GetNativePtr(),
+                    length,
+                    scaleNumerator,
+                    null,
+                    NativePixelFormat.RGB,
+                    pixels.GetNativePtr(),
+                    stride,
+                    size);
+
+                byte[] result = new byte[size];
+                pixels.Read(0, result, 0, size);
+                return result;
+            }
+        }
+
+        /// <summary>
+        /// Checks that the image decodes the same serially and on several
+        /// threads.
+        /// </summary>
+        /// <returns>The number of bands the image was decoded in.</returns>
+        private static int Compare(string name, byte[] encoded, int scaleNumerator)
+        {
+            using (var src = new NativeMemoryChunk(encoded.Length))
+            {
+                src.Write(0, encoded, 0, encoded.Length);
+
+                JpegDecoder.SetMaxDecodeThreads(1);
+                byte[] serial = Decode(src, encoded.Length, scaleNumerator);
+
+                JpegDecoder.SetMaxDecodeThreads(PARALLEL_THREADS);
+                int bandCount = JpegDecoder.GetRestartBandCount(src.GetNativePtr(), encoded.Length);
+                byte[] parallel = Decode(src, encoded.Length, scaleNumerator);
+
+                Assert.IsTrue(serial.SequenceEqual(parallel), name);
+                return bandCount;
+            }
+        }
+    }
+}
+#endif // HAS_LIBJPEGTURBO
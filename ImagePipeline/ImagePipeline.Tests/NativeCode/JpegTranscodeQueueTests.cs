@@ -0,0 +1,382 @@
+﻿#if HAS_LIBJPEGTURBO
+using FBCore.Common.Internal;
+using ImagePipeline.Common;
+using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
+using ImageUtils;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.IO;
+using System.Linq;
+using System.Threading.Tasks;
+using Windows.Storage;
+
+namespace ImagePipeline.Tests.NativeCode
+{
+    /// <summary>
+    /// Tests for <see cref="JpegTranscodeQueue"/>
+    /// </summary>
+    [TestClass]
+    public sealed class JpegTranscodeQueueTests : IDisposable
+    {
+        private static readonly string[] ASSETS = new string[]
+        {
+            "ms-appx:///Assets/jpegs/1.jpeg",
+            "ms-appx:///Assets/jpegs/2.jpeg",
+            "ms-appx:///Assets/jpegs/3.jpeg",
+            "ms-appx:///Assets/jpegs/4.jpeg",
+            "ms-appx:///Assets/jpegs/5.jpeg",
+            "ms-appx:///Assets/jpegs/beach.jpg"
+        };
+
+        private static readonly JpegEncodeOptions ENCODE_OPTIONS = new JpegEncodeOptions(85);
+
+        private PoolFactory _poolFactory;
+        private NativeMemoryChunk[] _sources;
+
+        /// <summary>
+        /// Initialize
+        /// </summary>
+        [TestInitialize]
+        public void Initialize()
+        {
+            _poolFactory = new PoolFactory(PoolConfig.NewBuilder().Build());
+            _sources = ASSETS.Select(asset =>
+            {
+                byte[] encoded = ReadAsset(asset);
+                var chunk = new NativeMemoryChunk(encoded.Length);
+                chunk.Write(0, encoded, 0, encoded.Length);
+                return chunk;
+            }).ToArray();
+        }
+
+        /// <summary>
+        /// Clean up
+        /// </summary>
+        public void Dispose()
+        {
+            foreach (NativeMemoryChunk chunk in _sources)
+            {
+                chunk.Dispose();
+            }
+        }
+
+        /// <summary>
+        /// Tests that a batch produces the same bytes as transcoding the
+        /// images one at a time
+        /// </summary>
+        [TestMethod]
+        public async Task TestBatchMatchesSynchronousTranscode()
+        {
+            JpegTranscodeRequest[] requests = _sources.Select((chunk, i) => new JpegTranscodeRequest(
+                chunk.GetNativePtr(),
+                chunk.Size,
+                new JpegTranscodeOptions((i % 2 == 0) ? 0 : 90, 4, null, null, ENCODE_OPTIONS))).ToArray();
+
+            Task<IPooledByteBuffer>[] results = JpegTranscodeQueue.TranscodeJpegBatchAsync(
+                requests, _poolFactory.NativeMemoryChunkPool);
+
+            Assert.AreEqual(requests.Length, results.Length);
+            for (int i = 0; i < requests.Length; ++i)
+            {
+                using (IPooledByteBuffer actual = await results[i].ConfigureAwait(false))
+                using (IPooledByteBuffer expected = JpegTranscoder.TranscodeJpegToByteBuffer(
+                    requests[i].SrcPtr,
+                    requests[i].SrcLength,
+                    _poolFactory.NativeMemoryChunkPool,
+                    requests[i].Options))
+                {
+                    Assert.IsTrue(ToArray(expected).SequenceEqual(ToArray(actual)), ASSETS[i]);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that a corrupt image fails its own task only
+        /// </summary>
+        [TestMethod]
+        public async Task TestCorruptImage()
+        {
+            byte[] encoded = ReadAsset(ASSETS[0]);
+            byte[] corrupt = encoded.Take(encoded.Length / 3).ToArray();
+            for (int i = 200; i < corrupt.Length; i += 7)
+            {
+                corrupt[i] = 0xFF;
+            }
+
+            using (var chunk = new NativeMemoryChunk(corrupt.Length))
+            {
+                chunk.Write(0, corrupt, 0, corrupt.Length);
+                JpegTranscodeOptions options = new JpegTranscodeOptions(0, 4, null, null, ENCODE_OPTIONS);
+                Task<IPooledByteBuffer>[] results = JpegTranscodeQueue.TranscodeJpegBatchAsync(
+                    new[]
+                    {
+                        new JpegTranscodeRequest(chunk.GetNativePtr(), chunk.Size, options),
+                        new JpegTranscodeRequest(_sources[0].GetNativePtr(), _sources[0].Size, options)
+                    },
+                    _poolFactory.NativeMemoryChunkPool);
+
+                try
+                {
+                    await results[0].ConfigureAwait(false);
+                    Assert.Fail();
+                }
+                catch (IOException)
+                {
+                    // This is expected
+                }
+
+                using (IPooledByteBuffer output = await results[1].ConfigureAwait(false))
+                {
+                    Assert.IsTrue(output.Size > 0);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that appending an image in pieces produces the same bytes
+        /// as transcoding it at once
+        /// </summary>
+        [TestMethod]
+        public async Task TestStreamingMatchesSynchronousTranscode()
+        {
+            JpegTranscodeOptions options = new JpegTranscodeOptions(0, 3, null, null, ENCODE_OPTIONS);
+            foreach (int pieceSize in new[] { 1, 4096, int.MaxValue })
+            {
+                for (int i = 0; i < _sources.Length; ++i)
+                {
+                    NativeMemoryChunk source = _sources[i];
+                    using (JpegStreamingTranscode transcode = JpegTranscodeQueue.StartStreamingTranscode(
+                        options, 1024, _poolFactory.NativeMemoryChunkPool))
+                    {
+                        for (int offset = 0; offset < source.Size; offset += pieceSize)
+                        {
+                            transcode.Append(
+                                source.GetNativePtr() + offset,
+                                Math.Min(pieceSize, source.Size - offset));
+                        }
+
+                        Assert.AreEqual(source.Size, transcode.AppendedLength);
+                        using (IPooledByteBuffer actual = await transcode.FinishAsync().ConfigureAwait(false))
+                        using (IPooledByteBuffer expected = JpegTranscoder.TranscodeJpegToByteBuffer(
+                            source.GetNativePtr(),
+                            source.Size,
+                            _poolFactory.NativeMemoryChunkPool,
+                            options))
+                        {
+                            Assert.IsTrue(ToArray(expected).SequenceEqual(ToArray(actual)), ASSETS[i]);
+                        }
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that a truncated image fails the streaming transcode and
+        /// that an unfinished one can be disposed
+        /// </summary>
+        [TestMethod]
+        public async Task TestStreamingIncompleteImage()
+        {
+            NativeMemoryChunk source = _sources[0];
+            JpegTranscodeOptions options = new JpegTranscodeOptions(0, 4, null, null, ENCODE_OPTIONS);
+            using (JpegStreamingTranscode transcode = JpegTranscodeQueue.StartStreamingTranscode(
+                options, 1024, _poolFactory.NativeMemoryChunkPool))
+            {
+                transcode.Append(source.GetNativePtr(), 100);
+                try
+                {
+                    await transcode.FinishAsync().ConfigureAwait(false);
+                    Assert.Fail();
+                }
+                catch (IOException)
+                {
+                    // This is expected
+                }
+            }
+
+            JpegStreamingTranscode cancelled = JpegTranscodeQueue.StartStreamingTranscode(
+                options, 1024, _poolFactory.NativeMemoryChunkPool);
+
+            cancelled.Append(source.GetNativePtr(), source.Size / 2);
+            cancelled.Dispose();
+            try
+            {
+                cancelled.Append(source.GetNativePtr(), 1);
+                Assert.Fail();
+            }
+            catch (InvalidOperationException)
+            {
+                // This is expected
+            }
+        }
+
+        /// <summary>
+        /// Tests that invalid requests are rejected before anything is
+        /// submitted
+        /// </summary>
+        [TestMethod]
+        public void TestInvalidRequest()
+        {
+            try
+            {
+                new JpegTranscodeOptions(45, 4, null, null, ENCODE_OPTIONS);
+                Assert.Fail();
+            }
+            catch (ArgumentException)
+            {
+                // This is expected
+            }
+
+            try
+            {
+                JpegTranscodeQueue.StartStreamingTranscode(
+                    new JpegTranscodeOptions(90, 4, null, null, ENCODE_OPTIONS),
+                    1024,
+                    _poolFactory.NativeMemoryChunkPool);
+
+                Assert.Fail();
+            }
+            catch (ArgumentException)
+            {
+                // This is expected
+            }
+        }
+
+        /// <summary>
+        /// Tests that the worker pool has at least one thread
+        /// </summary>
+        [TestMethod]
+        public void TestWorkerCount()
+        {
+            Assert.IsTrue(JpegTranscodeQueue.WorkerCount >= 1);
+        }
+
+        /// <summary>
+        /// Tests that a small output does not keep chunks sized to the
+        /// input
+        /// </summary>
+        [TestMethod]
+        public async Task TestOutputChunkSizedToOutput()
+        {
+            NativeMemoryChunkPool pool = _poolFactory.NativeMemoryChunkPool;
+            NativeMemoryChunk source = _sources[4];
+            JpegTranscodeOptions options = new JpegTranscodeOptions(0, 1, null, null, ENCODE_OPTIONS);
+            Task<IPooledByteBuffer>[] results = JpegTranscodeQueue.TranscodeJpegBatchAsync(
+                new[] { new JpegTranscodeRequest(source.GetNativePtr(), source.Size, options) },
+                pool);
+
+            using (IPooledByteBuffer queued = await results[0].ConfigureAwait(false))
+            using (IPooledByteBuffer synchronous = JpegTranscoder.TranscodeJpegToByteBuffer(
+                source.GetNativePtr(), source.Size, pool, options))
+            {
+                foreach (IPooledByteBuffer output in new[] { queued, synchronous })
+                {
+                    Assert.IsTrue(GetChunkSizes(output).Sum() < pool.GetBucketedSize(source.Size));
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that an output outgrowing its first chunk continues in
+        /// chunks taken from the pool and is returned in them unchanged
+        /// </summary>
+        [TestMethod]
+        public async Task TestOutputContinuesInPooledChunks()
+        {
+            NativeMemoryChunkPool pool = _poolFactory.NativeMemoryChunkPool;
+            JpegTranscodeOptions options = new JpegTranscodeOptions(0, 16, null, null, ENCODE_OPTIONS);
+            int chunkedCount = 0;
+            for (int i = 0; i < _sources.Length; ++i)
+            {
+                NativeMemoryChunk source = _sources[i];
+                Task<IPooledByteBuffer>[] results = JpegTranscodeQueue.TranscodeJpegBatchAsync(
+                    new[] { new JpegTranscodeRequest(source.GetNativePtr(), source.Size, options) },
+                    pool);
+
+                using (var expected = new MemoryStream())
+                using (IPooledByteBuffer queued = await results[0].ConfigureAwait(false))
+                using (IPooledByteBuffer synchronous = JpegTranscoder.TranscodeJpegToByteBuffer(
+                    source.GetNativePtr(), source.Size, pool, options))
+                {
+                    JpegTranscoder.TranscodeJpegFromMemory(
+                        source.GetNativePtr(), source.Size, expected.AsIStream(), options);
+
+                    foreach (IPooledByteBuffer output in new[] { queued, synchronous })
+                    {
+                        if (output is ChunkedPooledByteBuffer)
+                        {
+                            ++chunkedCount;
+                        }
+
+                        foreach (int chunkSize in GetChunkSizes(output))
+                        {
+                            Assert.AreEqual(chunkSize, pool.GetBucketedSize(chunkSize), ASSETS[i]);
+                        }
+
+                        Assert.IsTrue(expected.ToArray().SequenceEqual(ToArray(output)), ASSETS[i]);
+                    }
+                }
+            }
+
+            // Upscaled outputs mostly outgrow the chunk sized to the input
+            Assert.IsTrue(chunkedCount > 0);
+        }
+
+        /// <summary>
+        /// Tests that a crop off the iMCU grid covers exactly the
+        /// requested region, whatever the rotation
+        /// </summary>
+        [TestMethod]
+        public async Task TestUnalignedCrop()
+        {
+            NativeMemoryChunk source = _sources[5];
+            CropOptions cropOptions = new CropOptions(5, 5, 50, 40);
+            foreach (int rotationAngle in new[] { 0, 90, 180, 270 })
+            {
+                using (IPooledByteBuffer output = JpegTranscoder.TranscodeJpegToByteBuffer(
+                    source.GetNativePtr(),
+                    source.Size,
+                    _poolFactory.NativeMemoryChunkPool,
+                    new JpegTranscodeOptions(rotationAngle, 8, cropOptions, null, ENCODE_OPTIONS)))
+                {
+                    Tuple<int, int> dimensions = await BitmapUtil
+                        .DecodeDimensionsAsync(ToArray(output))
+                        .ConfigureAwait(false);
+
+                    bool swapped = rotationAngle == 90 || rotationAngle == 270;
+                    Assert.AreEqual(swapped ? 40 : 50, dimensions.Item1);
+                    Assert.AreEqual(swapped ? 50 : 40, dimensions.Item2);
+                }
+            }
+        }
+
+        private static int[] GetChunkSizes(IPooledByteBuffer buffer)
+        {
+            NativePooledByteBuffer nativeBuffer = buffer as NativePooledByteBuffer;
+            if (nativeBuffer != null)
+            {
+                return new[] { nativeBuffer._bufRef.Get().Size };
+            }
+
+            return ((ChunkedPooledByteBuffer)buffer)._chunkRefs.Select(chunkRef => chunkRef.Get().Size).ToArray();
+        }
+
+        private static byte[] ToArray(IPooledByteBuffer buffer)
+        {
+            byte[] bytes = new byte[buffer.Size];
+            buffer.Read(0, bytes, 0, bytes.Length);
+            return bytes;
+        }
+
+        private static byte[] ReadAsset(string asset)
+        {
+            var file = StorageFile.GetFileFromApplicationUriAsync(new Uri(asset)).GetAwaiter().GetResult();
+            using (var stream = file.OpenReadAsync().GetAwaiter().GetResult())
+            {
+                return ByteStreams.ToByteArray(stream.AsStream());
+            }
+        }
+    }
+}
+#endif // HAS_LIBJPEGTURBO
@@ -0,0 +1,282 @@
+﻿#if HAS_LIBJPEGTURBO
+using FBCore.Common.Internal;
+using ImagePipeline.Common;
+using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.IO;
+using System.Linq;
+using System.Runtime.InteropServices;
+using Windows.Storage;
+
+namespace ImagePipeline.Tests.NativeCode
+{
+    /// <summary>
+    /// Tests for <see cref="JpegTranscoder"/>
+    /// </summary>
+    [TestClass]
+    public sealed class JpegTranscoderTests
+    {
+        private static readonly string[] ASSETS = new string[]
+        {
+            "ms-appx:///Assets/jpegs/1.jpeg",
+            "ms-appx:///Assets/jpegs/5.jpeg",
+            "ms-appx:///Assets/jpegs/beach.jpg",
+            "ms-appx:///Assets/jpegs/progressive.jpg"
+        };
+
+        /// <summary>
+        /// ALIGN_SIZE of libjpeg-turbo built with AVX2.
+        /// </summary>
+        private const int SIMD_ALIGNMENT = 32;
+
+        private static readonly JpegEncodeOptions PROGRESSIVE_ENCODE_OPTIONS = new JpegEncodeOptions(
+            85, true, true, JpegSubsampling.YUV_420, JpegDctMethod.ISLOW, 0);
+
+        private PoolFactory _poolFactory;
+
+        /// <summary>
+        /// Initialize
+        /// </summary>
+        [TestInitialize]
+        public void Initialize()
+        {
+            _poolFactory = new PoolFactory(PoolConfig.NewBuilder().Build());
+        }
+
+        /// <summary>
+        /// Tests that every allocation libjpeg makes from the per-image
+        /// arena, while decoding and while encoding, is aligned for the
+        /// SIMD code of libjpeg-turbo
+        /// </summary>
+        [TestMethod]
+        public void TestArenaAllocationsAreSimdAligned()
+        {
+            foreach (string asset in ASSETS)
+            {
+                byte[] encoded = ReadAsset(asset);
+                using (var source = new NativeMemoryChunk(encoded.Length))
+                {
+                    source.Write(0, encoded, 0, encoded.Length);
+
+                    int width;
+                    int height;
+                    JpegDecoder.GetDecodeSize(
+                        source.GetNativePtr(), source.Size, 8, null, out width, out height);
+                    int stride = width * 4;
+                    using (var pixels = new NativeMemoryChunk(stride * height))
+                    {
+                        JpegDecoder.DecodeJpeg(
+                            source.GetNativePtr(),
+                            source.Size,
+                            8,
+                            null,
+                            NativePixelFormat.RGBA,
+                            pixels.GetNativePtr(),
+                            stride,
+                            pixels.Size);
+                    }
+
+                    // Rotation realizes virtual coefficient arrays, the
+                    // progressive encoder allocates its own.
+                    using (IPooledByteBuffer transcoded = JpegTranscoder.TranscodeJpegToByteBuffer(
+                        source.GetNativePtr(),
+                        source.Size,
+                        _poolFactory.NativeMemoryChunkPool,
+                        new JpegTranscodeOptions(90, 4, null, null, PROGRESSIVE_ENCODE_OPTIONS)))
+                    {
+                        Assert.IsTrue(transcoded.Size > 0, asset);
+                    }
+                }
+            }
+
+            long alignment = JpegTranscoder.GetArenaAlignment();
+            Assert.IsTrue(alignment >= SIMD_ALIGNMENT, "alignment " + alignment);
+        }
+
+        /// <summary>
+        /// Tests that scaling and rotating in a single pass gives the
+        /// dimensions and orientation of scaling first and rotating the
+        /// scaled jpeg afterwards
+        /// </summary>
+        [TestMethod]
+        public void TestFusedScaleAndRotateMatchesTwoPasses()
+        {
+            foreach (string asset in ASSETS)
+            {
+                using (NativeMemoryChunk source = ToNativeMemoryChunk(ReadAsset(asset)))
+                using (IPooledByteBuffer scaled = Transcode(source, 0, 4))
+                using (NativeMemoryChunk scaledSource = ToNativeMemoryChunk(scaled))
+                {
+                    foreach (int rotationAngle in new[] { 90, 180, 270 })
+                    {
+                        string message = asset + " rotated by " + rotationAngle;
+                        using (IPooledByteBuffer fused = Transcode(source, rotationAngle, 4))
+                        using (IPooledByteBuffer twoPasses = Transcode(scaledSource, rotationAngle, 8))
+                        {
+                            int fusedWidth;
+                            int fusedHeight;
+                            byte[] fusedPixels = Decode(fused, out fusedWidth, out fusedHeight);
+                            int width;
+                            int height;
+                            byte[] pixels = Decode(twoPasses, out width, out height);
+                            Assert.AreEqual(width, fusedWidth, message);
+                            Assert.AreEqual(height, fusedHeight, message);
+
+                            // The fused output is encoded once less, a wrong
+                            // orientation differs by far more than that
+                            long difference = 0;
+                            for (int i = 0; i < pixels.Length; ++i)
+                            {
+                                difference += Math.Abs(fusedPixels[i] - pixels[i]);
+                            }
+
+                            double meanDifference = (double)difference / pixels.Length;
+                            Assert.IsTrue(meanDifference < 6, message + ": " + meanDifference);
+                        }
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that transcoding in place from native memory gives the
+        /// bytes of transcoding from a stream
+        /// </summary>
+        [TestMethod]
+        public void TestTranscodeFromNativeMemoryChunk()
+        {
+            foreach (string asset in ASSETS)
+            {
+                byte[] encoded = ReadAsset(asset);
+                foreach (int rotationAngle in new[] { 0, 90 })
+                {
+                    var options = new JpegTranscodeOptions(rotationAngle, 3, 85);
+                    using (var input = new MemoryStream(encoded))
+                    using (var expected = new MemoryStream())
+                    using (NativeMemoryChunk source = ToNativeMemoryChunk(encoded))
+                    using (var actual = new MemoryStream())
+                    {
+                        JpegTranscoder.TranscodeJpeg(input.AsIStream(), expected.AsIStream(), options);
+                        JpegTranscoder.TranscodeJpegFromMemory(
+                            source.GetNativePtr(), source.Size, actual.AsIStream(), options);
+
+                        string message = asset + " rotated by " + rotationAngle;
+                        Assert.IsTrue(actual.Length > 0, message);
+                        Assert.IsTrue(expected.ToArray().SequenceEqual(actual.ToArray()), message);
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that the thread's libjpeg contexts are reused from one
+        /// image to the next, including after an image failed, without
+        /// changing the output
+        /// </summary>
+        [TestMethod]
+        public void TestContextsAreReused()
+        {
+            // Bogus length of the frame header
+            byte[] corrupt = new byte[] { 0xFF, 0xD8, 0xFF, 0xC0, 0x00, 0x02, 0xFF, 0xD9 };
+            using (NativeMemoryChunk source = ToNativeMemoryChunk(ReadAsset(ASSETS[2])))
+            using (NativeMemoryChunk corruptSource = ToNativeMemoryChunk(corrupt))
+            {
+                byte[] expected = ToByteArray(Transcode(source, 0, 4));
+                long createdCount = JpegTranscoder.GetCreatedContextCount();
+                long reusedCount = JpegTranscoder.GetReusedContextCount();
+
+                for (int i = 0; i < 3; ++i)
+                {
+                    try
+                    {
+                        Transcode(corruptSource, 0, 4).Dispose();
+                        Assert.Fail();
+                    }
+                    catch (SEHException)
+                    {
+                        // This is expected
+                    }
+
+                    Assert.IsTrue(expected.SequenceEqual(ToByteArray(Transcode(source, 0, 4))));
+                }
+
+                Assert.AreEqual(createdCount, JpegTranscoder.GetCreatedContextCount());
+                Assert.IsTrue(JpegTranscoder.GetReusedContextCount() >= reusedCount + 6);
+            }
+        }
+
+        private IPooledByteBuffer Transcode(
+            NativeMemoryChunk source,
+            int rotationAngle,
+            int scaleNumerator)
+        {
+            return JpegTranscoder.TranscodeJpegToByteBuffer(
+                source.GetNativePtr(),
+                source.Size,
+                _poolFactory.NativeMemoryChunkPool,
+                new JpegTranscodeOptions(rotationAngle, scaleNumerator, 85));
+        }
+
+        private static byte[] Decode(IPooledByteBuffer encoded, out int width, out int height)
+        {
+            using (NativeMemoryChunk source = ToNativeMemoryChunk(encoded))
+            {
+                JpegDecoder.GetDecodeSize(
+                    source.GetNativePtr(), source.Size, 8, null, out width, out height);
+                int stride = width * 3;
+                using (var pixels = new NativeMemoryChunk(stride * height))
+                {
+                    JpegDecoder.DecodeJpeg(
+                        source.GetNativePtr(),
+                        source.Size,
+                        8,
+                        null,
+                        NativePixelFormat.RGB,
+                        pixels.GetNativePtr(),
+                        stride,
+                        pixels.Size);
+
+                    byte[] decoded = new byte[pixels.Size];
+                    pixels.Read(0, decoded, 0, decoded.Length);
+                    return decoded;
+                }
+            }
+        }
+
+        private static NativeMemoryChunk ToNativeMemoryChunk(IPooledByteBuffer buffer)
+        {
+            byte[] bytes = new byte[buffer.Size];
+            buffer.Read(0, bytes, 0, bytes.Length);
+            return ToNativeMemoryChunk(bytes);
+        }
+
+        private static byte[] ToByteArray(IPooledByteBuffer buffer)
+        {
+            using (buffer)
+            {
+                byte[] bytes = new byte[buffer.Size];
+                buffer.Read(0, bytes, 0, bytes.Length);
+                return bytes;
+            }
+        }
+
+        private static NativeMemoryChunk ToNativeMemoryChunk(byte[] bytes)
+        {
+            var chunk = new NativeMemoryChunk(bytes.Length);
+            chunk.Write(0, bytes, 0, bytes.Length);
+            return chunk;
+        }
+
+        private static byte[] ReadAsset(string asset)
+        {
+            var file = StorageFile.GetFileFromApplicationUriAsync(new Uri(asset)).GetAwaiter().GetResult();
+            using (var stream = file.OpenReadAsync().GetAwaiter().GetResult())
+            {
+                return ByteStreams.ToByteArray(stream.AsStream());
+            }
+        }
+    }
+}
+#endif // HAS_LIBJPEGTURBO
@@ -0,0 +1,181 @@
+﻿using FBCore.Common.Internal;
+using FBCore.Common.References;
+using FBCore.Common.Util;
+using ImageFormatUtils;
+using ImagePipeline.Image;
+using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
+using ImageUtils;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.IO;
+using System.Linq;
+using System.Threading.Tasks;
+using Windows.Storage;
+
+namespace ImagePipeline.Tests.NativeCode
+{
+    /// <summary>
+    /// Tests for <see cref="NativeImageMetaDataParser"/>
+    /// </summary>
+    [TestClass]
+    public sealed class NativeImageMetaDataParserTests
+    {
+        private static readonly string[] ASSETS = new string[]
+        {
+            "ms-appx:///Assets/jpegs/1.jpeg",
+            "ms-appx:///Assets/jpegs/2.jpeg",
+            "ms-appx:///Assets/jpegs/3.jpeg",
+            "ms-appx:///Assets/jpegs/4.jpeg",
+            "ms-appx:///Assets/jpegs/5.jpeg",
+            "ms-appx:///Assets/jpegs/beach.jpg",
+            "ms-appx:///Assets/pngs/1.png",
+            "ms-appx:///Assets/pngs/2.png",
+            "ms-appx:///Assets/gifs/dog.gif"
+        };
+
+        private IPooledByteBufferFactory _byteBufferFactory;
+        private NativeImageMetaDataParser _parser;
+
+        /// <summary>
+        /// Initialize
+        /// </summary>
+        [TestInitialize]
+        public void Initialize()
+        {
+            _byteBufferFactory = new PoolFactory(PoolConfig.NewBuilder().Build()).PooledByteBufferFactory;
+            _parser = new NativeImageMetaDataParser();
+        }
+
+        /// <summary>
+        /// Tests the header fields of a jpeg with EXIF data
+        /// </summary>
+        [TestMethod]
+        public void TestParseJpeg()
+        {
+            using (IPooledByteBuffer buffer = NewByteBuffer(ReadAsset("ms-appx:///Assets/jpegs/beach.jpg")))
+            {
+                ImageMetaData metaData = _parser.Parse(buffer);
+                Assert.AreEqual(ImageFormat.JPEG, metaData.Format);
+                Assert.AreEqual(355, metaData.Width);
+                Assert.AreEqual(280, metaData.Height);
+                Assert.AreEqual(ExifInterface.ORIENTATION_ROTATE_90, metaData.ExifOrientation);
+                Assert.IsFalse(metaData.IsProgressive);
+            }
+        }
+
+        /// <summary>
+        /// Tests that the progressive flag reaches EncodedImage once the
+        /// frame header is read
+        /// </summary>
+        [TestMethod]
+        public async Task TestEncodedImageProgressive()
+        {
+            byte[] baseline = ReadAsset("ms-appx:///Assets/jpegs/beach.jpg");
+            byte[] progressive = ReadAsset("ms-appx:///Assets/jpegs/progressive.jpg");
+
+            EncodedImage encodedImage = await ParseMetaDataAsync(baseline, _parser).ConfigureAwait(false);
+            Assert.AreEqual(TriState.NO, encodedImage.IsProgressive);
+            encodedImage = await ParseMetaDataAsync(progressive, _parser).ConfigureAwait(false);
+            Assert.AreEqual(TriState.YES, encodedImage.IsProgressive);
+            encodedImage = await ParseMetaDataAsync(baseline.Take(100).ToArray(), _parser).ConfigureAwait(false);
+            Assert.AreEqual(TriState.UNSET, encodedImage.IsProgressive);
+        }
+
+        /// <summary>
+        /// Tests that a jpeg cut before its frame header only has its
+        /// format known
+        /// </summary>
+        [TestMethod]
+        public void TestParseTruncatedJpeg()
+        {
+            byte[] encoded = ReadAsset("ms-appx:///Assets/jpegs/beach.jpg").Take(100).ToArray();
+            using (IPooledByteBuffer buffer = NewByteBuffer(encoded))
+            {
+                ImageMetaData metaData = _parser.Parse(buffer);
+                Assert.AreEqual(ImageFormat.JPEG, metaData.Format);
+                Assert.AreEqual(EncodedImage.UNKNOWN_WIDTH, metaData.Width);
+                Assert.AreEqual(EncodedImage.UNKNOWN_HEIGHT, metaData.Height);
+                Assert.AreEqual(ExifInterface.ORIENTATION_UNDEFINED, metaData.ExifOrientation);
+            }
+        }
+
+        /// <summary>
+        /// Tests that unknown bytes are reported as such
+        /// </summary>
+        [TestMethod]
+        public void TestParseUnknownFormat()
+        {
+            using (IPooledByteBuffer buffer = NewByteBuffer(new byte[] { 1, 2, 3, 4, 5, 6, 7, 8 }))
+            {
+                ImageMetaData metaData = _parser.Parse(buffer);
+                Assert.AreEqual(ImageFormat.UNKNOWN, metaData.Format);
+            }
+        }
+
+        /// <summary>
+        /// Tests that buffers outside native memory are left to the
+        /// streams
+        /// </summary>
+        [TestMethod]
+        public void TestParseManagedBuffer()
+        {
+            using (IPooledByteBuffer buffer = new TrivialPooledByteBuffer(new byte[] { 0xFF, 0xD8, 0xFF }))
+            {
+                Assert.IsNull(_parser.Parse(buffer));
+            }
+        }
+
+        /// <summary>
+        /// Tests that EncodedImage gets the same meta data as when it
+        /// reads it from its streams
+        /// </summary>
+        [TestMethod]
+        public async Task TestEncodedImageMatchesStreams()
+        {
+            foreach (string asset in ASSETS)
+            {
+                byte[] encoded = ReadAsset(asset);
+                EncodedImage expected = await ParseMetaDataAsync(encoded, null).ConfigureAwait(false);
+                EncodedImage actual = await ParseMetaDataAsync(encoded, _parser).ConfigureAwait(false);
+
+                Assert.AreEqual(expected.Format, actual.Format, asset);
+                Assert.AreEqual(expected.Width, actual.Width, asset);
+                Assert.AreEqual(expected.Height, actual.Height, asset);
+                Assert.AreEqual(expected.RotationAngle, actual.RotationAngle, asset);
+            }
+        }
+
+        private IPooledByteBuffer NewByteBuffer(byte[] bytes)
+        {
+            return _byteBufferFactory.NewByteBuffer(bytes);
+        }
+
+        private async Task<EncodedImage> ParseMetaDataAsync(
+            byte[] encoded,
+            IImageMetaDataParser parser)
+        {
+            var bufferRef = CloseableReference<IPooledByteBuffer>.of(NewByteBuffer(encoded));
+            EncodedImage encodedImage = new EncodedImage(bufferRef);
+            try
+            {
+                await encodedImage.ParseMetaDataAsync(parser).ConfigureAwait(false);
+                return encodedImage;
+            }
+            finally
+            {
+                encodedImage.Dispose();
+                bufferRef.Dispose();
+            }
+        }
+
+        private static byte[] ReadAsset(string asset)
+        {
+            var file = StorageFile.GetFileFromApplicationUriAsync(new Uri(asset)).GetAwaiter().GetResult();
+            using (var stream = file.OpenReadAsync().GetAwaiter().GetResult())
+            {
+                return ByteStreams.ToByteArray(stream.AsStream());
+            }
+        }
+    }
+}
@@ -0,0 +1,513 @@
+﻿#if HAS_LIBPNG
+using FBCore.Common.Internal;
+using ImagePipeline.Common;
+using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Runtime.InteropServices.WindowsRuntime;
+using System.Threading.Tasks;
+using Windows.Foundation;
+using Windows.Graphics.Imaging;
+using Windows.Storage;
+using Windows.Storage.Streams;
+
+namespace ImagePipeline.Tests.NativeCode
+{
+    /// <summary>
+    /// Tests for <see cref="PngDecoder"/>
+    /// </summary>
+    [TestClass]
+    public sealed class PngDecoderTests
+    {
+        private static readonly string[] ASSETS = new string[]
+        {
+            "ms-appx:///Assets/pngs/1.png",
+            "ms-appx:///Assets/pngs/2.png",
+            "ms-appx:///Assets/pngs/3.png",
+            "ms-appx:///Assets/pngs/4.png",
+            "ms-appx:///Assets/pngs/5.png"
+        };
+
+        private const int WIDTH = 240;
+        private const int HEIGHT = 181;
+
+        private const int SYNTHETIC_SIZE = 4000;
+        private const int SYNTHETIC_TARGET_SIZE = 200;
+
+        private const int ITERATIONS = 3;
+
+        /// <summary>
+        /// Tests that images are scaled down but never up
+        /// </summary>
+        [TestMethod]
+        public void TestGetDecodeSize()
+        {
+            byte[] encoded = ReadAsset(ASSETS[0]);
+            using (var src = new NativeMemoryChunk(encoded.Length))
+            {
+                src.Write(0, encoded, 0, encoded.Length);
+
+                int width;
+                int height;
+                PngDecoder.GetDecodeSize(src.GetNativePtr(), encoded.Length, null, out width, out height);
+                Assert.AreEqual(WIDTH, width);
+                Assert.AreEqual(HEIGHT, height);
+
+                PngDecoder.GetDecodeSize(
+                    src.GetNativePtr(), encoded.Length, new ResizeOptions(80, 60), out width, out height);
+                Assert.AreEqual(80, width);
+                Assert.AreEqual(60, height);
+
+                PngDecoder.GetDecodeSize(
+                    src.GetNativePtr(), encoded.Length, new ResizeOptions(480, 362), out width, out height);
+                Assert.AreEqual(WIDTH, width);
+                Assert.AreEqual(HEIGHT, height);
+            }
+        }
+
+        /// <summary>
+        /// Tests that the assets decode to the same pixels as with the
+        /// platform decoder
+        /// </summary>
+        [TestMethod]
+        public async Task TestDecodeAssets()
+        {
+            foreach (string asset in ASSETS)
+            {
+                byte[] encoded = ReadAsset(asset);
+                byte[] expected = await DecodePlatformAsync(encoded);
+
+                int width;
+                int height;
+                byte[] actual = Decode(encoded, null, out width, out height);
+                Assert.IsTrue(expected.SequenceEqual(actual), asset);
+            }
+        }
+
+        /// <summary>
+        /// Tests that interlaced and 16-bit versions of the assets decode
+        /// to the same pixels as the 8-bit originals
+        /// </summary>
+        [TestMethod]
+        public async Task TestDecodeInterlacedAnd16Bit()
+        {
+            foreach (string asset in ASSETS)
+            {
+                int width;
+                int height;
+                byte[] expected = Decode(ReadAsset(asset), null, out width, out height);
+
+                foreach (bool interlaced in new[] { false, true })
+                {
+                    foreach (bool sixteenBit in new[] { false, true })
+                    {
+                        byte[] encoded = await EncodeAsync(expected, width, height, interlaced, sixteenBit);
+                        byte[] actual = Decode(encoded, null, out width, out height);
+                        Assert.IsTrue(
+                            expected.SequenceEqual(actual),
+                            $"{asset} interlaced {interlaced} 16-bit {sixteenBit}");
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that interlaced images, resampled pass by pass, scale to
+        /// the same pixels as the rows of plain images
+        /// </summary>
+        [TestMethod]
+        public async Task TestDecodeScaled()
+        {
+            foreach (string asset in ASSETS)
+            {
+                int width;
+                int height;
+                byte[] pixels = Decode(ReadAsset(asset), null, out width, out height);
+                byte[] plain = await EncodeAsync(pixels, width, height, false, false);
+                byte[] interlaced = await EncodeAsync(pixels, width, height, true, true);
+
+                // Resampled as they are, and box reduced first
+                foreach (int divisor in new[] { 3, 5 })
+                {
+                    var targetSize = new ResizeOptions(width / divisor, height / divisor);
+                    int scaledWidth;
+                    int scaledHeight;
+                    byte[] expected = Decode(plain, targetSize, out scaledWidth, out scaledHeight);
+                    Assert.AreEqual(targetSize.Width, scaledWidth);
+                    Assert.AreEqual(targetSize.Height, scaledHeight);
+
+                    byte[] actual = Decode(interlaced, targetSize, out scaledWidth, out scaledHeight);
+                    Assert.IsTrue(MaxDifference(expected, actual) <= 1, $"{asset} 1/{divisor}");
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that pixel formats other than RGBA, converted as the rows
+        /// are decoded, match the RGBA pixels converted afterwards
+        /// </summary>
+        [TestMethod]
+        public async Task TestDecodePixelFormats()
+        {
+            foreach (string asset in ASSETS)
+            {
+                int width;
+                int height;
+                byte[] pixels = Decode(ReadAsset(asset), null, out width, out height);
+                byte[] interlaced = await EncodeAsync(pixels, width, height, true, false);
+                foreach (ResizeOptions targetSize in new[] { null, new ResizeOptions(width / 3, height / 3) })
+                {
+                    byte[] rgba = Decode(interlaced, targetSize, out width, out height);
+                    byte[] bgra = Decode(
+                        interlaced, targetSize, NativePixelFormat.BGRA_PREMULTIPLIED, out width, out height);
+                    byte[] grayAlpha = Decode(
+                        interlaced, targetSize, NativePixelFormat.GRAY_ALPHA, out width, out height);
+
+                    for (int pixel = 0; pixel < width * height; ++pixel)
+                    {
+                        int r = rgba[pixel * 4];
+                        int g = rgba[pixel * 4 + 1];
+                        int b = rgba[pixel * 4 + 2];
+                        int a = rgba[pixel * 4 + 3];
+                        Assert.AreEqual((b * a + 127) / 255, bgra[pixel * 4], asset);
+                        Assert.AreEqual((g * a + 127) / 255, bgra[pixel * 4 + 1], asset);
+                        Assert.AreEqual((r * a + 127) / 255, bgra[pixel * 4 + 2], asset);
+                        Assert.AreEqual(a, bgra[pixel * 4 + 3], asset);
+
+                        int luma = (19595 * r + 38470 * g + 7471 * b + 32768) >> 16;
+                        Assert.AreEqual(luma, grayAlpha[pixel * 2], asset);
+                        Assert.AreEqual(a, grayAlpha[pixel * 2 + 1], asset);
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that decoding into a bitmap converts to the requested
+        /// format
+        /// </summary>
+        [TestMethod]
+        public void TestDecodeToSoftwareBitmap()
+        {
+            byte[] encoded = ReadAsset(ASSETS[0]);
+            var targetSize = new ResizeOptions(80, 60);
+            int width;
+            int height;
+            byte[] expected = Decode(
+                encoded, targetSize, NativePixelFormat.BGRA_PREMULTIPLIED, out width, out height);
+
+            using (var src = new NativeMemoryChunk(encoded.Length))
+            {
+                src.Write(0, encoded, 0, encoded.Length);
+                using (SoftwareBitmap bitmap = PngDecoder.DecodeToSoftwareBitmap(
+                    src.GetNativePtr(), encoded.Length, targetSize, BitmapPixelFormat.Bgra8))
+                {
+                    Assert.AreEqual(80, bitmap.PixelWidth);
+                    Assert.AreEqual(60, bitmap.PixelHeight);
+                    Assert.AreEqual(BitmapPixelFormat.Bgra8, bitmap.BitmapPixelFormat);
+                    Assert.AreEqual(BitmapAlphaMode.Premultiplied, bitmap.BitmapAlphaMode);
+
+                    byte[] actual = new byte[expected.Length];
+                    bitmap.CopyToBuffer(actual.AsBuffer());
+                    Assert.IsTrue(expected.SequenceEqual(actual));
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that decoding at a size computed beforehand matches
+        /// decoding at the size read from the header
+        /// </summary>
+        [TestMethod]
+        public void TestDecodeToSoftwareBitmapAtDecodeSize()
+        {
+            byte[] encoded = ReadAsset(ASSETS[0]);
+            using (var src = new NativeMemoryChunk(encoded.Length))
+            {
+                src.Write(0, encoded, 0, encoded.Length);
+                int width;
+                int height;
+                PngDecoder.GetDecodeSize(src.GetNativePtr(), encoded.Length, null, out width, out height);
+                foreach (var size in new[] { new[] { width, height }, new[] { 80, 60 } })
+                {
+                    using (SoftwareBitmap expected = PngDecoder.DecodeToSoftwareBitmap(
+                        src.GetNativePtr(),
+                        encoded.Length,
+                        new ResizeOptions(size[0], size[1]),
+                        BitmapPixelFormat.Bgra8))
+                    using (SoftwareBitmap actual = PngDecoder.DecodeToSoftwareBitmap(
+                        src.GetNativePtr(),
+                        encoded.Length,
+                        size[0],
+                        size[1],
+                        BitmapPixelFormat.Bgra8))
+                    {
+                        Assert.AreEqual(size[0], actual.PixelWidth);
+                        Assert.AreEqual(size[1], actual.PixelHeight);
+
+                        byte[] expectedPixels = new byte[4 * size[0] * size[1]];
+                        byte[] actualPixels = new byte[expectedPixels.Length];
+                        expected.CopyToBuffer(expectedPixels.AsBuffer());
+                        actual.CopyToBuffer(actualPixels.AsBuffer());
+                        Assert.IsTrue(expectedPixels.SequenceEqual(actualPixels));
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that truncated images fail instead of decoding garbage
+        /// </summary>
+        [TestMethod]
+        public async Task TestDecodeTruncated()
+        {
+            int width;
+            int height;
+            byte[] pixels = Decode(ReadAsset(ASSETS[0]), null, out width, out height);
+            foreach (bool interlaced in new[] { false, true })
+            {
+                byte[] encoded = await EncodeAsync(pixels, width, height, interlaced, false);
+                byte[] truncated = encoded.Take(encoded.Length / 2).ToArray();
+                try
+                {
+                    Decode(truncated, new ResizeOptions(width / 3, height / 3), out width, out height);
+                    Assert.Fail();
+                }
+                catch (SEHException)
+                {
+                    // This is expected
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that large images scale to a thumbnail about as fast as
+        /// they decode at full size, and reports both times
+        /// </summary>
+        [TestMethod]
+        public async Task TestSyntheticImages()
+        {
+            int width;
+            int height;
+            byte[] tile = Decode(ReadAsset(ASSETS[0]), null, out width, out height);
+            byte[] pixels = CreateSyntheticPixels(tile, width, height);
+            var targetSize = new ResizeOptions(SYNTHETIC_TARGET_SIZE, SYNTHETIC_TARGET_SIZE);
+
+            byte[] plainScaled = null;
+            foreach (bool interlaced in new[] { false, true })
+            {
+                byte[] encoded = await EncodeAsync(
+                    pixels, SYNTHETIC_SIZE, SYNTHETIC_SIZE, interlaced, false);
+
+                byte[] scaled = null;
+                double fullTime = Measure(() => Decode(encoded, null, out width, out height));
+                double scaledTime = Measure(() =>
+                {
+                    scaled = Decode(encoded, targetSize, out width, out height);
+                });
+
+                Assert.AreEqual(SYNTHETIC_TARGET_SIZE, width);
+                Assert.AreEqual(SYNTHETIC_TARGET_SIZE, height);
+                if (interlaced)
+                {
+                    Assert.IsTrue(MaxDifference(plainScaled, scaled) <= 1);
+                }
+                else
+                {
+                    plainScaled = scaled;
+                }
+
+                Debug.WriteLine(
+                    $"{SYNTHETIC_SIZE}x{SYNTHETIC_SIZE} interlaced {interlaced}: " +
+                    $"full {fullTime:F1} ms, " +
+                    $"{SYNTHETIC_TARGET_SIZE}x{SYNTHETIC_TARGET_SIZE} {scaledTime:F1} ms");
+            }
+        }
+
+        private static byte[] ReadAsset(string asset)
+        {
+            var file = StorageFile.GetFileFromApplicationUriAsync(new Uri(asset)).GetAwaiter().GetResult();
+            using (var stream = file.OpenReadAsync().GetAwaiter().GetResult())
+            {
+                return ByteStreams.ToByteArray(stream.AsStream());
+            }
+        }
+
+        private static byte[] Decode(
+            byte[] encoded,
+            ResizeOptions targetSize,
+            out int width,
+            out int height)
+        {
+            return Decode(encoded, targetSize, NativePixelFormat.RGBA, out width, out height);
+        }
+
+        private static byte[] Decode(
+            byte[] encoded,
+            ResizeOptions targetSize,
+            NativePixelFormat pixelFormat,
+            out int width,
+            out int height)
+        {
+            using (var src = new NativeMemoryChunk(encoded.Length))
+            {
+                src.Write(0, encoded, 0, encoded.Length);
+                PngDecoder.GetDecodeSize(
+                    src.GetNativePtr(), encoded.Length, targetSize, out width, out height);
+
+                int stride = width * JpegDecoder.GetBytesPerPixel(pixelFormat);
+                int size = stride * height;
+                using (var pixels = new NativeMemoryChunk(size))
+                {
+                    PngDecoder.DecodePng(
+                        src.GetNativePtr(),
+                        encoded.Length,
+                        targetSize,
+                        pixelFormat,
+                        pixels.GetNativePtr(),
+                        stride,
+                        size);
+
+                    byte[] result = new byte[size];
+                    pixels.Read(0, result, 0, size);
+                    return result;
+                }
+            }
+        }
+
+        private static async Task<byte[]> DecodePlatformAsync(byte[] encoded)
+        {
+            using (var stream = new InMemoryRandomAccessStream())
+            {
+                await stream.WriteAsync(encoded.AsBuffer());
+                stream.Seek(0);
+
+                BitmapDecoder decoder = await BitmapDecoder.CreateAsync(BitmapDecoder.PngDecoderId, stream);
+                PixelDataProvider pixelData = await decoder.GetPixelDataAsync(
+                    BitmapPixelFormat.Rgba8,
+                    BitmapAlphaMode.Straight,
+                    new BitmapTransform(),
+                    ExifOrientationMode.IgnoreExifOrientation,
+                    ColorManagementMode.DoNotColorManage);
+
+                return pixelData.DetachPixelData();
+            }
+        }
+
+        /// <summary>
+        /// Encodes RGBA pixels to png, 16-bit samples repeat the 8-bit
+        /// ones so that they scale back to the same values.
+        /// </summary>
+        private static async Task<byte[]> EncodeAsync(
+            byte[] pixels,
+            int width,
+            int height,
+            bool interlaced,
+            bool sixteenBit)
+        {
+            var options = new BitmapPropertySet();
+            options.Add("InterlaceOption", new BitmapTypedValue(interlaced, PropertyType.Boolean));
+
+            using (var stream = new InMemoryRandomAccessStream())
+            {
+                BitmapEncoder encoder = await BitmapEncoder.CreateAsync(
+                    BitmapEncoder.PngEncoderId, stream, options);
+
+                if (sixteenBit)
+                {
+                    byte[] samples = new byte[pixels.Length * 2];
+                    for (int i = 0; i < pixels.Length; ++i)
+                    {
+                        samples[i * 2] = pixels[i];
+                        samples[i * 2 + 1] = pixels[i];
+                    }
+
+                    encoder.SetPixelData(
+                        BitmapPixelFormat.Rgba16,
+                        BitmapAlphaMode.Straight,
+                        (uint)width,
+                        (uint)height,
+                        96,
+                        96,
+                        samples);
+                }
+                else
+                {
+                    encoder.SetPixelData(
+                        BitmapPixelFormat.Rgba8,
+                        BitmapAlphaMode.Straight,
+                        (uint)width,
+                        (uint)height,
+                        96,
+                        96,
+                        pixels);
+                }
+
+                await encoder.FlushAsync();
+
+                stream.Seek(0);
+                using (Stream encoded = stream.AsStreamForRead())
+                {
+                    return ByteStreams.ToByteArray(encoded);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tiles the image over a SYNTHETIC_SIZE square.
+        /// </summary>
+        private static byte[] CreateSyntheticPixels(byte[] tile, int width, int height)
+        {
+            int stride = SYNTHETIC_SIZE * 4;
+            byte[] pixels = new byte[stride * SYNTHETIC_SIZE];
+            for (int y = 0; y < SYNTHETIC_SIZE; ++y)
+            {
+                for (int x = 0; x < SYNTHETIC_SIZE; x += width)
+                {
+                    Buffer.BlockCopy(
+                        tile,
+                        (y % height) * width * 4,
+                        pixels,
+                        y * stride + x * 4,
+                        Math.Min(width, SYNTHETIC_SIZE - x) * 4);
+                }
+            }
+
+            return pixels;
+        }
+
+        private static int MaxDifference(byte[] expected, byte[] actual)
+        {
+            Assert.AreEqual(expected.Length, actual.Length);
+            int difference = 0;
+            for (int i = 0; i < expected.Length; ++i)
+            {
+                difference = Math.Max(difference, Math.Abs(expected[i] - actual[i]));
+            }
+
+            return difference;
+        }
+
+        /// <summary>
+        /// Returns the best time of a few runs in milliseconds.
+        /// </summary>
+        private static double Measure(Action action)
+        {
+            double best = double.MaxValue;
+            for (int i = 0; i < ITERATIONS; ++i)
+            {
+                Stopwatch stopwatch = Stopwatch.StartNew();
+                action();
+                best = Math.Min(best, stopwatch.Elapsed.TotalMilliseconds);
+            }
+
+            return best;
+        }
+    }
+}
+#endif // HAS_LIBPNG
@@ -0,0 +1,191 @@
+﻿#if HAS_LIBPNG
+using FBCore.Common.Internal;
+using ImagePipeline.Common;
+using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.IO;
+using System.Threading.Tasks;
+using Windows.Graphics.Imaging;
+using Windows.Storage.Streams;
+
+namespace ImagePipeline.Tests.NativeCode
+{
+    /// <summary>
+    /// Tests for the native resampler, driven through <see cref="PngDecoder"/>
+    /// </summary>
+    [TestClass]
+    public sealed class ResamplerTests
+    {
+        private const int WIDTH = 240;
+        private const int HEIGHT = 181;
+
+        private static readonly ResampleFilter[] FILTERS = new ResampleFilter[]
+        {
+            ResampleFilter.LANCZOS3,
+            ResampleFilter.BILINEAR,
+            ResampleFilter.BOX
+        };
+
+        /// <summary>
+        /// Tests that every filter scales to the requested size and keeps
+        /// a linear gradient linear, sampled at the output pixel centers
+        /// </summary>
+        [TestMethod]
+        public async Task TestResampleGradient()
+        {
+            byte[] pixels = new byte[WIDTH * HEIGHT * 4];
+            for (int y = 0; y < HEIGHT; ++y)
+            {
+                for (int x = 0; x < WIDTH; ++x)
+                {
+                    int offset = (y * WIDTH + x) * 4;
+                    pixels[offset] = (byte)x;
+                    pixels[offset + 1] = (byte)y;
+                    pixels[offset + 2] = 128;
+                    pixels[offset + 3] = 255;
+                }
+            }
+
+            byte[] encoded = await EncodeAsync(pixels, WIDTH, HEIGHT);
+            foreach (ResampleFilter filter in FILTERS)
+            {
+                foreach (int divisor in new[] { 2, 3, 5, 8 })
+                {
+                    var targetSize = new ResizeOptions(WIDTH / divisor, HEIGHT / divisor);
+                    int width;
+                    int height;
+                    byte[] scaled = Decode(encoded, targetSize, filter, out width, out height);
+                    Assert.AreEqual(targetSize.Width, width);
+                    Assert.AreEqual(targetSize.Height, height);
+
+                    // The filter is cut at the borders, only the inner pixels
+                    // follow the gradient, give or take rounding of the box
+                    // reduction and of the output.
+                    for (int y = 2; y < height - 2; ++y)
+                    {
+                        for (int x = 2; x < width - 2; ++x)
+                        {
+                            int offset = (y * width + x) * 4;
+                            double expectedR = (x + 0.5) * WIDTH / width - 0.5;
+                            double expectedG = (y + 0.5) * HEIGHT / height - 0.5;
+                            string message = $"{filter} 1/{divisor} ({x}, {y})";
+                            Assert.IsTrue(Math.Abs(scaled[offset] - expectedR) <= 1.5, message);
+                            Assert.IsTrue(Math.Abs(scaled[offset + 1] - expectedG) <= 1.5, message);
+                            Assert.AreEqual(128, scaled[offset + 2], message);
+                            Assert.AreEqual(255, scaled[offset + 3], message);
+                        }
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that the box filter averages the source pixels covered by
+        /// each output pixel, rounding half up
+        /// </summary>
+        [TestMethod]
+        public async Task TestBoxFilterAverages()
+        {
+            const int width = 96;
+            const int height = 64;
+            var random = new Random(7);
+            byte[] pixels = new byte[width * height * 4];
+            random.NextBytes(pixels);
+            for (int i = 3; i < pixels.Length; i += 4)
+            {
+                pixels[i] = 255;
+            }
+
+            byte[] encoded = await EncodeAsync(pixels, width, height);
+            int scaledWidth;
+            int scaledHeight;
+            byte[] scaled = Decode(
+                encoded,
+                new ResizeOptions(width / 2, height / 2),
+                ResampleFilter.BOX,
+                out scaledWidth,
+                out scaledHeight);
+
+            for (int y = 0; y < scaledHeight; ++y)
+            {
+                for (int x = 0; x < scaledWidth; ++x)
+                {
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        int sum = 0;
+                        for (int k = 0; k < 4; ++k)
+                        {
+                            sum += pixels[((y * 2 + k / 2) * width + x * 2 + k % 2) * 4 + c];
+                        }
+
+                        int actual = scaled[(y * scaledWidth + x) * 4 + c];
+                        Assert.IsTrue(Math.Abs(actual - (sum + 2) / 4) <= 1, $"({x}, {y}) {c}");
+                    }
+                }
+            }
+        }
+
+        private static byte[] Decode(
+            byte[] encoded,
+            ResizeOptions targetSize,
+            ResampleFilter filter,
+            out int width,
+            out int height)
+        {
+            using (var src = new NativeMemoryChunk(encoded.Length))
+            {
+                src.Write(0, encoded, 0, encoded.Length);
+                PngDecoder.GetDecodeSize(
+                    src.GetNativePtr(), encoded.Length, targetSize, out width, out height);
+
+                int stride = width * 4;
+                int size = stride * height;
+                using (var pixels = new NativeMemoryChunk(size))
+                {
+                    PngDecoder.DecodePng(
+                        src.GetNativePtr(),
+                        encoded.Length,
+                        targetSize,
+                        filter,
+                        NativePixelFormat.RGBA,
+                        pixels.GetNativePtr(),
+                        stride,
+                        size);
+
+                    byte[] result = new byte[size];
+                    pixels.Read(0, result, 0, size);
+                    return result;
+                }
+            }
+        }
+
+        private static async Task<byte[]> EncodeAsync(byte[] pixels, int width, int height)
+        {
+            using (var stream = new InMemoryRandomAccessStream())
+            {
+                BitmapEncoder encoder = await BitmapEncoder.CreateAsync(
+                    BitmapEncoder.PngEncoderId, stream);
+
+                encoder.SetPixelData(
+                    BitmapPixelFormat.Rgba8,
+                    BitmapAlphaMode.Straight,
+                    (uint)width,
+                    (uint)height,
+                    96,
+                    96,
+                    pixels);
+
+                await encoder.FlushAsync();
+
+                stream.Seek(0);
+                using (Stream encoded = stream.AsStreamForRead())
+                {
+                    return ByteStreams.ToByteArray(encoded);
+                }
+            }
+        }
+    }
+}
+#endif // HAS_LIBPNG
@@ -0,0 +1,289 @@
+﻿#if HAS_LIBWEBP
+using FBCore.Common.Internal;
+using FBCore.Common.References;
+using ImageFormatUtils;
+using ImagePipeline.Common;
+using ImagePipeline.Image;
+using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.IO;
+using System.Linq;
+using System.Runtime.InteropServices.WindowsRuntime;
+using System.Threading.Tasks;
+using Windows.Graphics.Imaging;
+using Windows.Storage;
+
+namespace ImagePipeline.Tests.NativeCode
+{
+    /// <summary>
+    /// Tests for <see cref="WebpTranscoder"/>
+    /// </summary>
+    [TestClass]
+    public sealed class WebpTranscoderTests : IDisposable
+    {
+        private const int WIDTH = 240;
+        private const int HEIGHT = 181;
+
+        private IPooledByteBufferFactory _byteBufferFactory;
+        private NativeMemoryChunk _lossy;
+        private NativeMemoryChunk _lossless;
+        private NativeMemoryChunk _alpha;
+
+        /// <summary>
+        /// Initialize
+        /// </summary>
+        [TestInitialize]
+        public void Initialize()
+        {
+            _byteBufferFactory = new PoolFactory(PoolConfig.NewBuilder().Build()).PooledByteBufferFactory;
+            _lossy = ReadAsset("ms-appx:///Assets/webps/lossy.webp");
+            _lossless = ReadAsset("ms-appx:///Assets/webps/lossless.webp");
+            _alpha = ReadAsset("ms-appx:///Assets/webps/alpha.webp");
+        }
+
+        /// <summary>
+        /// Clean up
+        /// </summary>
+        public void Dispose()
+        {
+            _lossy.Dispose();
+            _lossless.Dispose();
+            _alpha.Dispose();
+        }
+
+        /// <summary>
+        /// Tests that images are scaled down but never up
+        /// </summary>
+        [TestMethod]
+        public void TestGetDecodeSize()
+        {
+            int width;
+            int height;
+            WebpTranscoder.GetDecodeSize(_lossy.GetNativePtr(), _lossy.Size, null, out width, out height);
+            Assert.AreEqual(WIDTH, width);
+            Assert.AreEqual(HEIGHT, height);
+
+            WebpTranscoder.GetDecodeSize(
+                _lossless.GetNativePtr(), _lossless.Size, new ResizeOptions(120, 90), out width, out height);
+            Assert.AreEqual(120, width);
+            Assert.AreEqual(90, height);
+
+            WebpTranscoder.GetDecodeSize(
+                _alpha.GetNativePtr(), _alpha.Size, new ResizeOptions(480, 362), out width, out height);
+            Assert.AreEqual(WIDTH, width);
+            Assert.AreEqual(HEIGHT, height);
+        }
+
+        /// <summary>
+        /// Tests that alpha survives the decode and that rows are written
+        /// at the given stride
+        /// </summary>
+        [TestMethod]
+        public void TestDecodeAlpha()
+        {
+            int stride = WIDTH * 4 + 16;
+            using (var pixels = new NativeMemoryChunk(stride * HEIGHT))
+            {
+                WebpTranscoder.DecodeWebp(
+                    _alpha.GetNativePtr(),
+                    _alpha.Size,
+                    null,
+                    NativePixelFormat.RGBA,
+                    pixels.GetNativePtr(),
+                    stride,
+                    pixels.Size);
+
+                for (int y = 0; y < HEIGHT; y += 60)
+                {
+                    Assert.AreEqual((byte)0, pixels.Read(y * stride + 3));
+                    Assert.AreEqual((byte)255, pixels.Read(y * stride + (WIDTH - 1) * 4 + 3));
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that decoding into a bitmap scales and premultiplies the
+        /// pixels
+        /// </summary>
+        [TestMethod]
+        public void TestDecodeToSoftwareBitmap()
+        {
+            var targetSize = new ResizeOptions(WIDTH / 2, HEIGHT / 2);
+            int stride = targetSize.Width * 4;
+            using (var pixels = new NativeMemoryChunk(stride * targetSize.Height))
+            using (SoftwareBitmap bitmap = WebpTranscoder.DecodeToSoftwareBitmap(
+                _alpha.GetNativePtr(), _alpha.Size, targetSize, BitmapPixelFormat.Bgra8))
+            {
+                Assert.AreEqual(targetSize.Width, bitmap.PixelWidth);
+                Assert.AreEqual(targetSize.Height, bitmap.PixelHeight);
+                Assert.AreEqual(BitmapPixelFormat.Bgra8, bitmap.BitmapPixelFormat);
+                Assert.AreEqual(BitmapAlphaMode.Premultiplied, bitmap.BitmapAlphaMode);
+
+                WebpTranscoder.DecodeWebp(
+                    _alpha.GetNativePtr(),
+                    _alpha.Size,
+                    targetSize,
+                    NativePixelFormat.BGRA_PREMULTIPLIED,
+                    pixels.GetNativePtr(),
+                    stride,
+                    pixels.Size);
+
+                byte[] expected = new byte[pixels.Size];
+                pixels.Read(0, expected, 0, expected.Length);
+                byte[] actual = new byte[expected.Length];
+                bitmap.CopyToBuffer(actual.AsBuffer());
+                Assert.IsTrue(expected.SequenceEqual(actual));
+            }
+        }
+
+        /// <summary>
+        /// Tests that decoding at a size computed beforehand matches
+        /// decoding at the size read from the header
+        /// </summary>
+        [TestMethod]
+        public void TestDecodeToSoftwareBitmapAtDecodeSize()
+        {
+            foreach (var size in new[] { new[] { WIDTH, HEIGHT }, new[] { WIDTH / 2, HEIGHT / 2 } })
+            {
+                using (SoftwareBitmap expected = WebpTranscoder.DecodeToSoftwareBitmap(
+                    _alpha.GetNativePtr(),
+                    _alpha.Size,
+                    new ResizeOptions(size[0], size[1]),
+                    BitmapPixelFormat.Bgra8))
+                using (SoftwareBitmap actual = WebpTranscoder.DecodeToSoftwareBitmap(
+                    _alpha.GetNativePtr(), _alpha.Size, size[0], size[1], BitmapPixelFormat.Bgra8))
+                {
+                    Assert.AreEqual(size[0], actual.PixelWidth);
+                    Assert.AreEqual(size[1], actual.PixelHeight);
+
+                    byte[] expectedPixels = new byte[4 * size[0] * size[1]];
+                    byte[] actualPixels = new byte[expectedPixels.Length];
+                    expected.CopyToBuffer(expectedPixels.AsBuffer());
+                    actual.CopyToBuffer(actualPixels.AsBuffer());
+                    Assert.IsTrue(expectedPixels.SequenceEqual(actualPixels));
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that invalid destinations are rejected
+        /// </summary>
+        [TestMethod]
+        public void TestDecodeInvalidStride()
+        {
+            using (var pixels = new NativeMemoryChunk(WIDTH * 3 * HEIGHT))
+            {
+                try
+                {
+                    WebpTranscoder.DecodeWebp(
+                        _lossy.GetNativePtr(),
+                        _lossy.Size,
+                        null,
+                        NativePixelFormat.RGB,
+                        pixels.GetNativePtr(),
+                        0,
+                        pixels.Size);
+
+                    Assert.Fail();
+                }
+                catch (ArgumentException)
+                {
+                    // This is expected
+                }
+            }
+        }
+
+        /// <summary>
+        /// Tests that lossless webp is transcoded to a png of the same size
+        /// </summary>
+        [TestMethod]
+        public async Task TestTranscodeToPng()
+        {
+            using (PooledByteBufferOutputStream outputStream = _byteBufferFactory.NewOutputStream())
+            {
+                await WebpTranscoder.TranscodeWebpToPngAsync(
+                    _lossless.GetNativePtr(), _lossless.Size, outputStream);
+
+                await AssertEncodedImage(outputStream.ToByteBuffer(), ImageFormat.PNG);
+            }
+        }
+
+#if HAS_LIBJPEGTURBO
+        /// <summary>
+        /// Tests that lossy webp is transcoded to a jpeg of the same size
+        /// </summary>
+        [TestMethod]
+        public async Task TestTranscodeToJpeg()
+        {
+            using (PooledByteBufferOutputStream outputStream = _byteBufferFactory.NewOutputStream())
+            {
+                WebpTranscoder.TranscodeWebpToJpeg(
+                    _lossy.GetNativePtr(),
+                    _lossy.Size,
+                    outputStream.AsIStream(),
+                    new JpegEncodeOptions(80));
+
+                await AssertEncodedImage(outputStream.ToByteBuffer(), ImageFormat.JPEG);
+            }
+        }
+#endif // HAS_LIBJPEGTURBO
+
+        /// <summary>
+        /// Tests that only webp formats are accepted
+        /// </summary>
+        [TestMethod]
+        public void TestIsWebpNativelySupported()
+        {
+            Assert.IsFalse(WebpTranscoder.IsWebpNativelySupported(ImageFormat.WEBP_ANIMATED));
+            Assert.AreEqual(
+                !WebpTranscoder.IsTranscodeRequired,
+                WebpTranscoder.IsWebpNativelySupported(ImageFormat.WEBP_SIMPLE));
+
+            try
+            {
+                WebpTranscoder.IsWebpNativelySupported(ImageFormat.JPEG);
+                Assert.Fail();
+            }
+            catch (ArgumentException)
+            {
+                // This is expected
+            }
+        }
+
+        private static async Task AssertEncodedImage(IPooledByteBuffer buffer, ImageFormat format)
+        {
+            CloseableReference<IPooledByteBuffer> reference =
+                CloseableReference<IPooledByteBuffer>.of(buffer);
+
+            try
+            {
+                using (var encodedImage = new EncodedImage(reference))
+                {
+                    await encodedImage.ParseMetaDataAsync();
+                    Assert.AreEqual(format, encodedImage.Format);
+                    Assert.AreEqual(WIDTH, encodedImage.Width);
+                    Assert.AreEqual(HEIGHT, encodedImage.Height);
+                }
+            }
+            finally
+            {
+                CloseableReference<IPooledByteBuffer>.CloseSafely(reference);
+            }
+        }
+
+        private static NativeMemoryChunk ReadAsset(string asset)
+        {
+            var file = StorageFile.GetFileFromApplicationUriAsync(new Uri(asset)).GetAwaiter().GetResult();
+            using (var stream = file.OpenReadAsync().GetAwaiter().GetResult())
+            {
+                byte[] encoded = ByteStreams.ToByteArray(stream.AsStream());
+                var chunk = new NativeMemoryChunk(encoded.Length);
+                chunk.Write(0, encoded, 0, encoded.Length);
+                return chunk;
+            }
+        }
+    }
+}
+#endif // HAS_LIBWEBP
@@ -0,0 +1,159 @@
+﻿using FBCore.Common.Internal;
+using FBCore.Common.References;
+using ImagePipeline.Common;
+using ImagePipeline.Image;
+using ImagePipeline.Memory;
+using ImagePipeline.Platform;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+using System.IO;
+using System.Runtime.InteropServices.WindowsRuntime;
+using System.Threading.Tasks;
+using Windows.Graphics.Imaging;
+using Windows.Storage;
+
+namespace ImagePipeline.Tests.Platform
+{
+    /// <summary>
+    /// Tests for <see cref="WinRTDecoder"/>
+    /// </summary>
+    [TestClass]
+    public sealed class WinRTDecoderTests
+    {
+        private const int BYTES_PER_PIXEL = 4;
+
+        /// <summary>
+        /// Largest difference allowed between the pixels of a cropped
+        /// decode and of the same region of a full decode.
+        /// </summary>
+        private const int MAX_PIXEL_DIFFERENCE = 2;
+
+        private static readonly CropOptions CROP_OPTIONS = new CropOptions(32, 16, 64, 48);
+
+        private WinRTDecoder _decoder;
+        private IPooledByteBufferFactory _byteBufferFactory;
+
+        /// <summary>
+        /// Initialize
+        /// </summary>
+        [TestInitialize]
+        public void Initialize()
+        {
+            _decoder = new WinRTDecoder(1);
+            _byteBufferFactory = new PoolFactory(PoolConfig.NewBuilder().Build()).PooledByteBufferFactory;
+        }
+
+        /// <summary>
+        /// Tests that the crop region is mapped to the oriented image
+        /// </summary>
+        [TestMethod]
+        public void TestGetOrientedBounds()
+        {
+            // 100x50 image, region 10 from the left, 5 from the top,
+            // 60 from the right and 25 from the bottom
+            CropOptions cropOptions = new CropOptions(10, 5, 30, 20);
+            uint[][] expected = new uint[][]
+            {
+                new uint[] { 10, 5, 30, 20 },
+                new uint[] { 60, 5, 30, 20 },
+                new uint[] { 60, 25, 30, 20 },
+                new uint[] { 10, 25, 30, 20 },
+                new uint[] { 5, 10, 20, 30 },
+                new uint[] { 25, 10, 20, 30 },
+                new uint[] { 25, 60, 20, 30 },
+                new uint[] { 5, 60, 20, 30 }
+            };
+
+            for (ushort orientation = 1; orientation <= 8; ++orientation)
+            {
+                BitmapBounds bounds = WinRTDecoder.GetOrientedBounds(cropOptions, 100, 50, orientation);
+                uint[] bound = expected[orientation - 1];
+                Assert.AreEqual(bound[0], bounds.X, "orientation " + orientation);
+                Assert.AreEqual(bound[1], bounds.Y, "orientation " + orientation);
+                Assert.AreEqual(bound[2], bounds.Width, "orientation " + orientation);
+                Assert.AreEqual(bound[3], bounds.Height, "orientation " + orientation);
+            }
+        }
+
+        /// <summary>
+        /// Tests that the crop region is clipped to the image
+        /// </summary>
+        [TestMethod]
+        public void TestGetOrientedBoundsClipped()
+        {
+            BitmapBounds bounds = WinRTDecoder.GetOrientedBounds(
+                new CropOptions(80, 40, 50, 50), 100, 50, 1);
+
+            Assert.AreEqual(80u, bounds.X);
+            Assert.AreEqual(40u, bounds.Y);
+            Assert.AreEqual(20u, bounds.Width);
+            Assert.AreEqual(10u, bounds.Height);
+
+            try
+            {
+                WinRTDecoder.GetOrientedBounds(new CropOptions(100, 0, 10, 10), 100, 50, 1);
+                Assert.Fail();
+            }
+            catch (ArgumentException)
+            {
+                // This is expected
+            }
+        }
+
+        /// <summary>
+        /// Tests that a cropped decode has the size of the region and the
+        /// pixels of the same region of a full decode
+        /// </summary>
+        [TestMethod]
+        public async Task TestDecodeCropped()
+        {
+            byte[] encoded = ReadAsset("ms-appx:///Assets/jpegs/beach.jpg");
+            using (CloseableReference<IPooledByteBuffer> bufferRef =
+                CloseableReference<IPooledByteBuffer>.of(_byteBufferFactory.NewByteBuffer(encoded)))
+            using (EncodedImage encodedImage = new EncodedImage(bufferRef))
+            using (CloseableReference<SoftwareBitmap> fullRef = await _decoder
+                .DecodeFromEncodedImageAsync(encodedImage, BitmapPixelFormat.Bgra8)
+                .ConfigureAwait(false))
+            using (CloseableReference<SoftwareBitmap> croppedRef = await _decoder
+                .DecodeFromEncodedImageAsync(encodedImage, BitmapPixelFormat.Bgra8, CROP_OPTIONS)
+                .ConfigureAwait(false))
+            {
+                SoftwareBitmap full = fullRef.Get();
+                SoftwareBitmap cropped = croppedRef.Get();
+                Assert.AreEqual(CROP_OPTIONS.Width, cropped.PixelWidth);
+                Assert.AreEqual(CROP_OPTIONS.Height, cropped.PixelHeight);
+
+                byte[] fullPixels = GetPixels(full);
+                byte[] croppedPixels = GetPixels(cropped);
+                int fullStride = full.PixelWidth * BYTES_PER_PIXEL;
+                int croppedStride = cropped.PixelWidth * BYTES_PER_PIXEL;
+                for (int y = 0; y < cropped.PixelHeight; ++y)
+                {
+                    int fullOffset = (CROP_OPTIONS.Y + y) * fullStride + CROP_OPTIONS.X * BYTES_PER_PIXEL;
+                    for (int i = 0; i < croppedStride; ++i)
+                    {
+                        Assert.IsTrue(
+                            Math.Abs(fullPixels[fullOffset + i] - croppedPixels[y * croppedStride + i]) <=
+                                MAX_PIXEL_DIFFERENCE);
+                    }
+                }
+            }
+        }
+
+        private static byte[] GetPixels(SoftwareBitmap bitmap)
+        {
+            byte[] pixels = new byte[bitmap.PixelWidth * bitmap.PixelHeight * BYTES_PER_PIXEL];
+            bitmap.CopyToBuffer(pixels.AsBuffer());
+            return pixels;
+        }
+
+        private static byte[] ReadAsset(string asset)
+        {
+            var file = StorageFile.GetFileFromApplicationUriAsync(new Uri(asset)).GetAwaiter().GetResult();
+            using (var stream = file.OpenReadAsync().GetAwaiter().GetResult())
+            {
+                return ByteStreams.ToByteArray(stream.AsStream());
+            }
+        }
+    }
+}
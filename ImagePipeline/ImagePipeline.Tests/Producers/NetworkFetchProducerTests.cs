@@ -194,6 +194,47 @@ namespace ImagePipeline.Tests.Producers
             Assert.IsTrue(_intermediateResultProducerEventCalls == 0);
         }
 
+        /// <summary>
+        /// Tests that no intermediate results are propagated for requests
+        /// the streaming transcode cannot handle
+        /// </summary>
+        [TestMethod, Timeout(5000)]
+        public void TestNoIntermediateResultsWithoutStreamingTranscode()
+        {
+            _networkFetchProducer = new NetworkFetchProducer(
+                _pooledByteBufferFactory,
+                _byteArrayPool,
+                _networkFetcher,
+                true,
+                null);
+
+            // Cropping needs the whole image
+            _imageRequest = ImageRequestBuilder
+                .NewBuilderWithSource(IMAGE_URL)
+                .SetProgressiveRenderingEnabled(false)
+                .SetResizeOptions(new ResizeOptions(100, 100))
+                .SetCropOptions(new CropOptions(0, 0, 50, 50))
+                .Build();
+
+            _producerContext = new SettableProducerContext(
+                _imageRequest,
+                $"{ _imageRequest.SourceUri.ToString() }3",
+                _producerListener,
+                new object(),
+                RequestLevel.FULL_FETCH,
+                false,
+                true,
+                Priority.MEDIUM);
+
+            _networkFetchProducer.ProduceResults(_consumer, _producerContext);
+
+            // Wait for callback
+            _completion.WaitOne();
+
+            Assert.IsTrue(_onNewResultImplCalls == 1);
+            Assert.IsTrue(_intermediateResultProducerEventCalls == 0);
+        }
+
         /// <summary>
         /// Tests out the download handler
         /// </summary>
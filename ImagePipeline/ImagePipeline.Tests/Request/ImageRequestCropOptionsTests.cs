@@ -0,0 +1,69 @@
+﻿using ImagePipeline.Cache;
+using ImagePipeline.Common;
+using ImagePipeline.Request;
+using Microsoft.VisualStudio.TestPlatform.UnitTestFramework;
+using System;
+
+namespace ImagePipeline.Tests.Request
+{
+    /// <summary>
+    /// Tests for <see cref="CropOptions"/> in <see cref="ImageRequest"/>
+    /// </summary>
+    [TestClass]
+    public class ImageRequestCropOptionsTests
+    {
+        private static readonly Uri SOURCE_URI = new Uri("http://request");
+
+        /// <summary>
+        /// Tests that requests decode the whole image by default
+        /// </summary>
+        [TestMethod]
+        public void TestNoCropOptionsByDefault()
+        {
+            ImageRequest request = ImageRequest.FromUri(SOURCE_URI);
+            Assert.IsNull(request.CropOptions);
+        }
+
+        /// <summary>
+        /// Tests that crop options are kept by the builder
+        /// </summary>
+        [TestMethod]
+        public void TestCropOptionsArePreserved()
+        {
+            CropOptions cropOptions = new CropOptions(10, 20, 30, 40);
+            ImageRequest request = ImageRequestBuilder.NewBuilderWithSource(SOURCE_URI)
+                .SetCropOptions(cropOptions)
+                .Build();
+
+            Assert.AreEqual(cropOptions, request.CropOptions);
+            Assert.AreEqual(
+                cropOptions,
+                ImageRequestBuilder.FromRequest(request).Build().CropOptions);
+        }
+
+        /// <summary>
+        /// Tests that differently cropped requests do not share bitmaps
+        /// </summary>
+        [TestMethod]
+        public void TestBitmapCacheKeyDependsOnCropOptions()
+        {
+            ImageRequest fullRequest = ImageRequest.FromUri(SOURCE_URI);
+            ImageRequest croppedRequest = ImageRequestBuilder.NewBuilderWithSource(SOURCE_URI)
+                .SetCropOptions(new CropOptions(10, 20, 30, 40))
+                .Build();
+
+            ImageRequest sameCroppedRequest = ImageRequestBuilder.NewBuilderWithSource(SOURCE_URI)
+                .SetCropOptions(new CropOptions(10, 20, 30, 40))
+                .Build();
+
+            DefaultCacheKeyFactory factory = DefaultCacheKeyFactory.Instance;
+            Assert.AreNotEqual(
+                factory.GetBitmapCacheKey(fullRequest, null),
+                factory.GetBitmapCacheKey(croppedRequest, null));
+
+            Assert.AreEqual(
+                factory.GetBitmapCacheKey(croppedRequest, null),
+                factory.GetBitmapCacheKey(sameCroppedRequest, null));
+        }
+    }
+}
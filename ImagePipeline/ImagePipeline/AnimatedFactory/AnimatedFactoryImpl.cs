@@ -0,0 +1,53 @@
+﻿using FBCore.Common.Util;
+
+namespace ImagePipeline.AnimatedFactory
+{
+    /// <summary>
+    /// Animated factory decoding gifs natively.
+    /// </summary>
+    public class AnimatedFactoryImpl : IAnimatedFactory
+    {
+        /// <summary>
+        /// Default size in bytes of the keyframe cache of an animation.
+        /// </summary>
+        public const int DEFAULT_CACHE_CAPACITY = 8 * ByteConstants.MB;
+
+        /// <summary>
+        /// Default number of frames between two keyframes.
+        /// </summary>
+        public const int DEFAULT_KEYFRAME_INTERVAL = 10;
+
+        private readonly IAnimatedImageFactory _animatedImageFactory;
+
+        /// <summary>
+        /// Instantiates the <see cref="AnimatedFactoryImpl"/> with the
+        /// default keyframe cache.
+        /// </summary>
+        public AnimatedFactoryImpl() :
+            this(DEFAULT_CACHE_CAPACITY, DEFAULT_KEYFRAME_INTERVAL)
+        {
+        }
+
+        /// <summary>
+        /// Instantiates the <see cref="AnimatedFactoryImpl"/>.
+        /// </summary>
+        /// <param name="cacheCapacity">
+        /// Size in bytes of the keyframe cache of each animation.
+        /// </param>
+        /// <param name="keyframeInterval">
+        /// Number of frames between two keyframes.
+        /// </param>
+        public AnimatedFactoryImpl(int cacheCapacity, int keyframeInterval)
+        {
+            _animatedImageFactory = new AnimatedImageFactoryImpl(cacheCapacity, keyframeInterval);
+        }
+
+        /// <summary>
+        /// Gets the animated image factory.
+        /// </summary>
+        public IAnimatedImageFactory GetAnimatedImageFactory()
+        {
+            return _animatedImageFactory;
+        }
+    }
+}
@@ -0,0 +1,115 @@
+﻿using FBCore.Common.Internal;
+using FBCore.Common.References;
+using ImagePipeline.Common;
+using ImagePipeline.Image;
+using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
+using System;
+using System.IO;
+using Windows.Graphics.Imaging;
+
+namespace ImagePipeline.AnimatedFactory
+{
+    /// <summary>
+    /// Decodes animated gifs into <see cref="CloseableAnimatedImage"/>
+    /// whose frames are rendered natively on demand.
+    /// </summary>
+    public class AnimatedImageFactoryImpl : IAnimatedImageFactory
+    {
+        private readonly int _cacheCapacity;
+        private readonly int _keyframeInterval;
+
+        /// <summary>
+        /// Instantiates the <see cref="AnimatedImageFactoryImpl"/>.
+        /// </summary>
+        /// <param name="cacheCapacity">
+        /// Size in bytes of the keyframe cache of each animation.
+        /// </param>
+        /// <param name="keyframeInterval">
+        /// Number of frames between two keyframes.
+        /// </param>
+        public AnimatedImageFactoryImpl(int cacheCapacity, int keyframeInterval)
+        {
+            Preconditions.CheckArgument(cacheCapacity >= 0);
+            Preconditions.CheckArgument(keyframeInterval >= 0);
+            _cacheCapacity = cacheCapacity;
+            _keyframeInterval = keyframeInterval;
+        }
+
+        /// <summary>
+        /// Decodes a GIF into a CloseableImage.
+        /// </summary>
+        /// <param name="encodedImage">
+        /// Encoded image (native byte array holding the encoded bytes and
+        /// meta data).
+        /// </param>
+        /// <param name="options">The options for the decode.</param>
+        /// <param name="bitmapConfig">
+        /// The bitmap config used to generate the output bitmaps.
+        /// </param>
+        /// <returns>
+        /// A <see cref="CloseableAnimatedImage"/> for the GIF image.
+        /// </returns>
+        public CloseableImage DecodeGif(
+            EncodedImage encodedImage,
+            ImageDecodeOptions options,
+            BitmapPixelFormat bitmapConfig)
+        {
+            return new CloseableAnimatedImage(CreateGifAnimation(encodedImage), bitmapConfig);
+        }
+
+        /// <summary>
+        /// Animated webps are not supported.
+        /// </summary>
+        public CloseableImage DecodeWebP(
+            EncodedImage encodedImage,
+            ImageDecodeOptions options,
+            BitmapPixelFormat bitmapConfig)
+        {
+            throw new NotSupportedException("animated webp is not supported");
+        }
+
+        private unsafe GifAnimation CreateGifAnimation(EncodedImage encodedImage)
+        {
+            CloseableReference<IPooledByteBuffer> bufferRef = encodedImage.GetByteBufferRef();
+            try
+            {
+                NativePooledByteBuffer nativeBuffer = (bufferRef != null) ?
+                    bufferRef.Get() as NativePooledByteBuffer : null;
+
+                if (nativeBuffer != null)
+                {
+                    return new GifAnimation(
+                        nativeBuffer.GetNativePtr(),
+                        nativeBuffer.Size,
+                        _cacheCapacity,
+                        _keyframeInterval);
+                }
+            }
+            finally
+            {
+                CloseableReference<IPooledByteBuffer>.CloseSafely(bufferRef);
+            }
+
+            // The animation copies the bytes, pinning them for the call is
+            // enough.
+            byte[] bytes;
+            using (Stream inputStream = encodedImage.GetInputStream())
+            using (var memoryStream = new MemoryStream())
+            {
+                inputStream.CopyTo(memoryStream);
+                bytes = memoryStream.ToArray();
+            }
+
+            Preconditions.CheckArgument(bytes.Length > 0, "gif is empty");
+            fixed (byte* data = bytes)
+            {
+                return new GifAnimation(
+                    (long)data,
+                    bytes.Length,
+                    _cacheCapacity,
+                    _keyframeInterval);
+            }
+        }
+    }
+}
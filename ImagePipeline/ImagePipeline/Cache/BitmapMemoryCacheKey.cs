@@ -14,6 +14,7 @@ namespace ImagePipeline.Cache
     {
         private readonly string _sourceString;
         private readonly ResizeOptions _resizeOptions;
+        private readonly CropOptions _cropOptions;
         private readonly bool _autoRotated;
         private readonly ImageDecodeOptions _imageDecodeOptions;
         private readonly ICacheKey _postprocessorCacheKey;
@@ -28,6 +29,7 @@ namespace ImagePipeline.Cache
         public BitmapMemoryCacheKey(
             string sourceString,
             ResizeOptions resizeOptions,
+            CropOptions cropOptions,
             bool autoRotated,
             ImageDecodeOptions imageDecodeOptions,
             ICacheKey postprocessorCacheKey,
@@ -36,13 +38,14 @@ namespace ImagePipeline.Cache
         {
             _sourceString = Preconditions.CheckNotNull(sourceString);
             _resizeOptions = resizeOptions;
+            _cropOptions = cropOptions;
             _autoRotated = autoRotated;
             _imageDecodeOptions = imageDecodeOptions;
             _postprocessorCacheKey = postprocessorCacheKey;
             _postprocessorName = postprocessorName;
             _hash = HashCodeUtil.HashCode(
                 sourceString.GetHashCode(),
-                (resizeOptions != null) ? resizeOptions.GetHashCode() : 0,
+                HashCodeUtil.HashCode(resizeOptions, cropOptions),
                 autoRotated ? true.GetHashCode() : false.GetHashCode(),
                 _imageDecodeOptions,
                 _postprocessorCacheKey,
@@ -110,6 +113,7 @@ namespace ImagePipeline.Cache
             return _hash == otherKey._hash &&
                 _sourceString.Equals(otherKey._sourceString) &&
                 Equals(_resizeOptions, otherKey._resizeOptions) &&
+                Equals(_cropOptions, otherKey._cropOptions) &&
                 _autoRotated == otherKey._autoRotated &&
                 Equals(_imageDecodeOptions, otherKey._imageDecodeOptions) &&
                 Equals(_postprocessorCacheKey, otherKey._postprocessorCacheKey) &&
@@ -130,9 +134,10 @@ namespace ImagePipeline.Cache
         public override string ToString()
         {
             return string.Format(
-                "{0}_{1}_{2}_{3}_{4}_{5}_{6}",
+                "{0}_{1}_{2}_{3}_{4}_{5}_{6}_{7}",
                 _sourceString,
                 _resizeOptions,
+                _cropOptions,
                 _autoRotated.ToString(),
                 _imageDecodeOptions,
                 _postprocessorCacheKey,
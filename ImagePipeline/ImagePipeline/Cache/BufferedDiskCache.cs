@@ -3,6 +3,7 @@ using Cache.Common;
 using Cache.Disk;
 using FBCore.Common.Internal;
 using FBCore.Common.References;
+using FBCore.Common.Util;
 using FBCore.Concurrency;
 using ImagePipeline.Image;
 using ImagePipeline.Memory;
@@ -20,6 +21,11 @@ namespace ImagePipeline.Cache
     /// </summary>
     public class BufferedDiskCache
     {
+        /// <summary>
+        /// Smaller files are cheaper to copy than to map.
+        /// </summary>
+        private const int MIN_MAPPED_FILE_SIZE = 16 * ByteConstants.KB;
+
         private readonly IFileCache _fileCache;
         private readonly IPooledByteBufferFactory _pooledByteBufferFactory;
         private readonly PooledByteStreams _pooledByteStreams;
@@ -356,6 +362,54 @@ namespace ImagePipeline.Cache
             return Task.FromResult(pinnedImage);
         }
 
+        /// <summary>
+        /// Reads large cache files through a mapping, copying the pages
+        /// straight into pooled memory instead of going through a stream.
+        ///
+        /// <para />The mapping is released before returning. Results of the
+        /// disk cache end up in the encoded memory cache, and a file mapped
+        /// for as long as they are cached could neither be evicted nor
+        /// written again.
+        /// </summary>
+        /// <returns>
+        /// The buffer holding the file, or null if the file should be
+        /// read through a stream.
+        /// </returns>
+        private IPooledByteBuffer CopyFromMappedFile(IBinaryResource diskCacheResource)
+        {
+            FileBinaryResource fileResource = diskCacheResource as FileBinaryResource;
+            if (fileResource == null || fileResource.GetSize() < MIN_MAPPED_FILE_SIZE)
+            {
+                return null;
+            }
+
+            using (MappedNativeMemoryChunk chunk = MappedNativeMemoryChunk.Map(fileResource.File.FullName))
+            {
+                if (chunk == null)
+                {
+                    return null;
+                }
+
+                IPooledByteBuffer byteBuffer = _pooledByteBufferFactory.NewByteBuffer(chunk.Size);
+                try
+                {
+                    if (byteBuffer.GetNativePtr() == 0)
+                    {
+                        byteBuffer.Dispose();
+                        return null;
+                    }
+
+                    chunk.Read(0, byteBuffer.GetNativePtr(), chunk.Size);
+                    return byteBuffer;
+                }
+                catch (Exception)
+                {
+                    byteBuffer.Dispose();
+                    throw;
+                }
+            }
+        }
+
         /// <summary>
         /// Performs disk cache read. In case of any exception null is returned.
         /// </summary>
@@ -377,12 +431,15 @@ namespace ImagePipeline.Cache
                     _imageCacheStatsTracker.OnDiskCacheHit();
                 }
 
-                IPooledByteBuffer byteBuffer;
-                using (Stream inputStream = diskCacheResource.OpenStream())
+                IPooledByteBuffer byteBuffer = CopyFromMappedFile(diskCacheResource);
+                if (byteBuffer == null)
                 {
-                    byteBuffer = _pooledByteBufferFactory.NewByteBuffer(
-                        inputStream, 
-                        (int)diskCacheResource.GetSize());
+                    using (Stream inputStream = diskCacheResource.OpenStream())
+                    {
+                        byteBuffer = _pooledByteBufferFactory.NewByteBuffer(
+                            inputStream, 
+                            (int)diskCacheResource.GetSize());
+                    }
                 }
 
                 Debug.WriteLine($"Successful read from disk cache for { key.ToString() }");
@@ -415,11 +472,11 @@ namespace ImagePipeline.Cache
 
                 Debug.WriteLine($"Successful disk-cache write for key { key.ToString() }");
             }
-            catch (IOException)
+            catch (IOException e)
             {
-                // Log failure
+                // Log failure, the disk cache reports it to its error logger
                 // TODO: 3697790
-                Debug.WriteLine($"Failed to write to disk-cache for key { key.ToString() }");
+                Debug.WriteLine($"Failed to write to disk-cache for key { key.ToString() }: { e.Message }");
             }
         }
     }
@@ -50,6 +50,7 @@ namespace ImagePipeline.Cache
             return new BitmapMemoryCacheKey(
                 GetCacheKeySourceUri(request.SourceUri).ToString(),
                 request.ResizeOptions,
+                request.CropOptions,
                 request.IsAutoRotateEnabled,
                 request.ImageDecodeOptions,
                 null,
@@ -82,6 +83,7 @@ namespace ImagePipeline.Cache
             return new BitmapMemoryCacheKey(
                 GetCacheKeySourceUri(request.SourceUri).ToString(),
                 request.ResizeOptions,
+                request.CropOptions,
                 request.IsAutoRotateEnabled,
                 request.ImageDecodeOptions,
                 postprocessorCacheKey,
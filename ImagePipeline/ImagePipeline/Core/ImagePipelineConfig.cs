@@ -5,8 +5,10 @@ using ImagePipeline.AnimatedFactory;
 using ImagePipeline.Bitmaps;
 using ImagePipeline.Cache;
 using ImagePipeline.Decoder;
+using ImagePipeline.Image;
 using ImagePipeline.Listener;
 using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
 using ImagePipeline.Producers;
 using System;
 using System.Collections.Generic;
@@ -45,6 +47,7 @@ namespace ImagePipeline.Core
         private readonly IExecutorSupplier _executorSupplier;
         private readonly IImageCacheStatsTracker _imageCacheStatsTracker;
         private readonly ImageDecoder _imageDecoder;
+        private readonly IImageMetaDataParser _imageMetaDataParser;
         private readonly ISupplier<bool> _isPrefetchEnabledSupplier;
         private readonly DiskCacheConfig _mainDiskCacheConfig;
         private readonly IMemoryTrimmableRegistry _memoryTrimmableRegistry;
@@ -80,6 +83,12 @@ namespace ImagePipeline.Core
                     NoOpImageCacheStatsTracker.Instance;
 
             _imageDecoder = builder.ImageDecoder;
+
+            // Encoded images of the pipeline are held in native memory,
+            // their headers are parsed in place.
+            _imageMetaDataParser = builder.ImageMetaDataParser ??
+                new NativeImageMetaDataParser();
+
             _isPrefetchEnabledSupplier = builder.IsPrefetchEnabledSupplier ??
                 new SupplierImpl<bool>(
                     () =>
@@ -291,6 +300,17 @@ namespace ImagePipeline.Core
             }
         }
 
+        /// <summary>
+        /// Gets the parser reading the meta data of encoded images.
+        /// </summary>
+        public IImageMetaDataParser ImageMetaDataParser
+        {
+            get
+            {
+                return _imageMetaDataParser;
+            }
+        }
+
         /// <summary>
         /// Gets the IsPrefetchEnabledSupplier.
         /// </summary>
@@ -441,6 +461,7 @@ namespace ImagePipeline.Core
             internal IExecutorSupplier ExecutorSupplier { get; private set; }
             internal IImageCacheStatsTracker ImageCacheStatsTracker { get; private set; }
             internal ImageDecoder ImageDecoder { get; private set; }
+            internal IImageMetaDataParser ImageMetaDataParser { get; private set; }
             internal ISupplier<bool> IsPrefetchEnabledSupplier { get; private set; }
             internal DiskCacheConfig MainDiskCacheConfig { get; private set; }
             internal IMemoryTrimmableRegistry MemoryTrimmableRegistry { get; private set; }
@@ -576,6 +597,15 @@ namespace ImagePipeline.Core
                 return this;
             }
 
+            /// <summary>
+            /// Sets the parser reading the meta data of encoded images.
+            /// </summary>
+            public Builder SetImageMetaDataParser(IImageMetaDataParser imageMetaDataParser)
+            {
+                ImageMetaDataParser = imageMetaDataParser;
+                return this;
+            }
+
             /// <summary>
             /// Sets the IsPrefetchEnabledSupplier.
             /// </summary>
@@ -1,4 +1,9 @@
-﻿namespace ImagePipeline.Core
+﻿using FBCore.Common.Internal;
+using ImagePipeline.AnimatedFactory;
+using ImagePipeline.NativeCode;
+using ImagePipeline.Producers;
+
+namespace ImagePipeline.Core
 {
     /// <summary>
     /// Encapsulates additional elements of the <see cref="ImagePipelineConfig"/>
@@ -13,6 +18,8 @@
         internal readonly bool _webpSupportEnabled;
         internal readonly int _throttlingMaxSimultaneousRequests;
         internal readonly bool _externalCreatedBitmapLogEnabled;
+        internal readonly JpegEncodeOptions _jpegEncodeOptions;
+        internal readonly int _gifFrameCacheCapacity;
 
         private ImagePipelineExperiments(Builder builder, ImagePipelineConfig.Builder configBuilder)
         {
@@ -20,6 +27,8 @@
             _webpSupportEnabled = builder.IsWebpSupportEnabled;
             _throttlingMaxSimultaneousRequests = builder.ThrottlingMaxSimultaneousRequests;
             _externalCreatedBitmapLogEnabled = builder.IsExternalCreatedBitmapLogEnabled;
+            _jpegEncodeOptions = builder.JpegEncodeOptions;
+            _gifFrameCacheCapacity = builder.GifFrameCacheCapacity;
         }
 
         /// <summary>
@@ -66,6 +75,30 @@
             }
         }
 
+        /// <summary>
+        /// Gets the options used to encode jpeg images transformed by
+        /// ResizeAndRotateProducer.
+        /// </summary>
+        public JpegEncodeOptions JpegEncodeOptions
+        {
+            get
+            {
+                return _jpegEncodeOptions;
+            }
+        }
+
+        /// <summary>
+        /// Gets the size in bytes of the frame cache of each animated gif
+        /// decoded natively.
+        /// </summary>
+        public int GifFrameCacheCapacity
+        {
+            get
+            {
+                return _gifFrameCacheCapacity;
+            }
+        }
+
         /// <summary>
         /// Creates the builder for ImagePipelineExperiments.
         /// </summary>
@@ -88,6 +121,10 @@
             internal bool IsExternalCreatedBitmapLogEnabled { get; private set; }
             internal int ThrottlingMaxSimultaneousRequests { get; private set; } = 
                 DEFAULT_MAX_SIMULTANEOUS_FILE_FETCH_AND_RESIZE;
+            internal JpegEncodeOptions JpegEncodeOptions { get; private set; } =
+                new JpegEncodeOptions(ResizeAndRotateProducer.DEFAULT_JPEG_QUALITY);
+            internal int GifFrameCacheCapacity { get; private set; } =
+                AnimatedFactoryImpl.DEFAULT_CACHE_CAPACITY;
 
             /// <summary>
             /// Instantiates the ImagePipelineExperiments builder.
@@ -148,6 +185,52 @@
                 return ConfigBuilder;
             }
 
+            /// <summary>
+            /// Sets the options used to encode jpeg images resized or
+            /// rotated by the pipeline, e.g. a preset trading encode time
+            /// for smaller output.
+            ///
+            /// <para />Images are encoded at quality 85 with libjpeg
+            /// defaults otherwise. Pass
+            /// <see cref="JpegEncodeOptions.FromPreset"/> with
+            /// <see cref="JpegEncodePreset.BALANCED"/> to opt in to
+            /// Huffman optimization and progressive scans.
+            /// </summary>
+            /// <param name="jpegEncodeOptions">
+            /// The encoder options.
+            /// </param>
+            /// <returns>
+            /// The Builder itself for chaining.
+            /// </returns>
+            public ImagePipelineConfig.Builder SetJpegEncodeOptions(
+                JpegEncodeOptions jpegEncodeOptions)
+            {
+                JpegEncodeOptions = Preconditions.CheckNotNull(jpegEncodeOptions);
+                return ConfigBuilder;
+            }
+
+            /// <summary>
+            /// Sets the size in bytes of the cache keeping rendered frames
+            /// of each animated gif, so seeking back does not replay the
+            /// animation from its first frame. Defaults to 8 MB.
+            ///
+            /// <para />Only used when the animated factory is not supplied
+            /// by the application.
+            /// </summary>
+            /// <param name="gifFrameCacheCapacity">
+            /// Capacity in bytes, 0 to disable the cache.
+            /// </param>
+            /// <returns>
+            /// The Builder itself for chaining.
+            /// </returns>
+            public ImagePipelineConfig.Builder SetGifFrameCacheCapacity(
+                int gifFrameCacheCapacity)
+            {
+                Preconditions.CheckArgument(gifFrameCacheCapacity >= 0);
+                GifFrameCacheCapacity = gifFrameCacheCapacity;
+                return ConfigBuilder;
+            }
+
             /// <summary>
             /// Builds the ImagePipelineExperiments.
             /// </summary>
@@ -160,6 +160,15 @@ namespace ImagePipeline.Core
                 _animatedFactory = AnimatedFactoryProvider.GetAnimatedFactory(
                     GetPlatformBitmapFactory(),
                     _config.ExecutorSupplier);
+
+                // Animated gifs are decoded natively unless the provider
+                // supplies a factory.
+                if (_animatedFactory == null)
+                {
+                    _animatedFactory = new AnimatedFactoryImpl(
+                        _config.Experiments.GifFrameCacheCapacity,
+                        AnimatedFactoryImpl.DEFAULT_KEYFRAME_INTERVAL);
+                }
             }
 
             return _animatedFactory;
@@ -373,7 +382,9 @@ namespace ImagePipeline.Core
                         _config.CacheKeyFactory,
                         GetPlatformBitmapFactory(),
                         _config.PoolFactory.FlexByteArrayPool,
-                        _config.Experiments.ForceSmallCacheThresholdBytes);
+                        _config.Experiments.ForceSmallCacheThresholdBytes,
+                        _config.Experiments.JpegEncodeOptions,
+                        _config.ImageMetaDataParser);
             }
 
             return _producerFactory;
@@ -5,6 +5,7 @@ using ImagePipeline.Cache;
 using ImagePipeline.Decoder;
 using ImagePipeline.Image;
 using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
 using ImagePipeline.Producers;
 
 namespace ImagePipeline.Core
@@ -24,6 +25,7 @@ namespace ImagePipeline.Core
         // Dependencies used by multiple steps
         private readonly IExecutorSupplier _executorSupplier;
         private readonly IPooledByteBufferFactory _pooledByteBufferFactory;
+        private readonly IImageMetaDataParser _imageMetaDataParser;
 
         // Cache dependencies
         private readonly BufferedDiskCache _defaultBufferedDiskCache;
@@ -32,6 +34,7 @@ namespace ImagePipeline.Core
         private readonly IMemoryCache<ICacheKey, CloseableImage> _bitmapMemoryCache;
         private readonly ICacheKeyFactory _cacheKeyFactory;
         private readonly int _forceSmallCacheThresholdBytes;
+        private readonly JpegEncodeOptions _jpegEncodeOptions;
 
         // Postproc dependencies
         private readonly PlatformBitmapFactory _platformBitmapFactory;
@@ -85,6 +88,12 @@ namespace ImagePipeline.Core
         /// <param name="forceSmallCacheThresholdBytes">
         /// The threshold set for using the small buffered disk cache.
         /// </param>
+        /// <param name="jpegEncodeOptions">
+        /// The encoder options used by ResizeAndRotateProducer.
+        /// </param>
+        /// <param name="imageMetaDataParser">
+        /// The parser reading the meta data of encoded images.
+        /// </param>
         public ProducerFactory(
             IByteArrayPool byteArrayPool,
             ImageDecoder imageDecoder,
@@ -100,9 +109,13 @@ namespace ImagePipeline.Core
             ICacheKeyFactory cacheKeyFactory,
             PlatformBitmapFactory platformBitmapFactory,
             FlexByteArrayPool flexByteArrayPool,
-            int forceSmallCacheThresholdBytes)
+            int forceSmallCacheThresholdBytes,
+            JpegEncodeOptions jpegEncodeOptions,
+            IImageMetaDataParser imageMetaDataParser)
         {
             _forceSmallCacheThresholdBytes = forceSmallCacheThresholdBytes;
+            _jpegEncodeOptions = jpegEncodeOptions;
+            _imageMetaDataParser = imageMetaDataParser;
 
             _byteArrayPool = byteArrayPool;
             _imageDecoder = imageDecoder;
@@ -127,10 +140,10 @@ namespace ImagePipeline.Core
         /// Instantiates the <see cref="AddImageTransformMetaDataProducer"/>.
         /// </summary>
         /// <param name="inputProducer">The input producer.</param>
-        public static AddImageTransformMetaDataProducer NewAddImageTransformMetaDataProducer(
+        public AddImageTransformMetaDataProducer NewAddImageTransformMetaDataProducer(
             IProducer<EncodedImage> inputProducer)
         {
-            return new AddImageTransformMetaDataProducer(inputProducer);
+            return new AddImageTransformMetaDataProducer(inputProducer, _imageMetaDataParser);
         }
 
         /// <summary>
@@ -180,7 +193,7 @@ namespace ImagePipeline.Core
         /// </summary>
         public DataFetchProducer NewDataFetchProducer()
         {
-            return new DataFetchProducer(_pooledByteBufferFactory);
+            return new DataFetchProducer(_pooledByteBufferFactory, _imageMetaDataParser);
         }
 
         /// <summary>
@@ -246,7 +259,8 @@ namespace ImagePipeline.Core
         {
             return new LocalAssetFetchProducer(
                 _executorSupplier.ForLocalStorageRead,
-                _pooledByteBufferFactory);
+                _pooledByteBufferFactory,
+                _imageMetaDataParser);
         }
 
         /// <summary>
@@ -256,7 +270,8 @@ namespace ImagePipeline.Core
         {
             return new LocalContentUriFetchProducer(
                 _executorSupplier.ForLocalStorageRead,
-                _pooledByteBufferFactory);
+                _pooledByteBufferFactory,
+                _imageMetaDataParser);
         }
 
         /// <summary>
@@ -266,7 +281,8 @@ namespace ImagePipeline.Core
         {
             return new LocalContentUriThumbnailFetchProducer(
                 _executorSupplier.ForLocalStorageRead,
-                _pooledByteBufferFactory);
+                _pooledByteBufferFactory,
+                _imageMetaDataParser);
         }
 
         /// <summary>
@@ -295,7 +311,8 @@ namespace ImagePipeline.Core
         {
             return new LocalFileFetchProducer(
                 _executorSupplier.ForLocalStorageRead,
-                _pooledByteBufferFactory);
+                _pooledByteBufferFactory,
+                _imageMetaDataParser);
         }
 
         /// <summary>
@@ -305,7 +322,8 @@ namespace ImagePipeline.Core
         {
             return new LocalResourceFetchProducer(
                 _executorSupplier.ForLocalStorageRead,
-                _pooledByteBufferFactory);
+                _pooledByteBufferFactory,
+                _imageMetaDataParser);
         }
 
         /// <summary>
@@ -323,7 +341,8 @@ namespace ImagePipeline.Core
         {
             return new FutureAccessListFetchProducer(
                 _executorSupplier.ForLocalStorageRead,
-                _pooledByteBufferFactory);
+                _pooledByteBufferFactory,
+                _imageMetaDataParser);
         }
 
         /// <summary>
@@ -334,7 +353,26 @@ namespace ImagePipeline.Core
             return new NetworkFetchProducer(
                 _pooledByteBufferFactory,
                 _byteArrayPool,
-                networkFetcher);
+                networkFetcher,
+                false,
+                _imageMetaDataParser);
+        }
+
+        /// <summary>
+        /// Instantiates the <see cref="NetworkFetchProducer"/>, propagating
+        /// partial results to transcode them while they download if
+        /// streamingTranscodeEnabled is true.
+        /// </summary>
+        public NetworkFetchProducer NewNetworkFetchProducer(
+            INetworkFetcher<FetchState> networkFetcher,
+            bool streamingTranscodeEnabled)
+        {
+            return new NetworkFetchProducer(
+                _pooledByteBufferFactory,
+                _byteArrayPool,
+                networkFetcher,
+                streamingTranscodeEnabled,
+                _imageMetaDataParser);
         }
 
         /// <summary>
@@ -379,7 +417,9 @@ namespace ImagePipeline.Core
             return new ResizeAndRotateProducer(
                 _executorSupplier.ForBackgroundTasks,
                 _pooledByteBufferFactory,
-                inputProducer);
+                inputProducer,
+                _jpegEncodeOptions,
+                _imageMetaDataParser);
         }
 
         /// <summary>
@@ -438,7 +478,8 @@ namespace ImagePipeline.Core
             return new WebpTranscodeProducer(
                 _executorSupplier.ForBackgroundTasks,
                 _pooledByteBufferFactory,
-                inputProducer);
+                inputProducer,
+                _imageMetaDataParser);
         }
     }
 }
@@ -4,6 +4,7 @@ using FBCore.Common.References;
 using FBCore.Common.Util;
 using ImagePipeline.Image;
 using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
 using ImagePipeline.Producers;
 using ImagePipeline.Request;
 using System;
@@ -223,8 +224,10 @@ namespace ImagePipeline.Core
         private IProducer<EncodedImage> NewEncodedCacheMultiplexToTranscodeSequence(
             IProducer<EncodedImage> inputProducer)
         {
-            // TODO: check webp transcode support
-            //inputProducer = _producerFactory.NewWebpTranscodeProducer(inputProducer);
+            if (IsWebpTranscodeRequired)
+            {
+                inputProducer = _producerFactory.NewWebpTranscodeProducer(inputProducer);
+            }
 
             inputProducer = _producerFactory.NewDiskCacheProducer(inputProducer);
             EncodedMemoryCacheProducer encodedMemoryCacheProducer =
@@ -245,10 +248,12 @@ namespace ImagePipeline.Core
                 {
                     IProducer<EncodedImage> inputProducer = 
                         NewEncodedCacheMultiplexToTranscodeSequence(
-                            _producerFactory.NewNetworkFetchProducer(_networkFetcher));
+                            _producerFactory.NewNetworkFetchProducer(
+                                _networkFetcher,
+                                _resizeAndRotateEnabledForNetwork && !_downsampleEnabled));
 
                     _commonNetworkFetchToEncodedMemorySequence =
-                        ProducerFactory.NewAddImageTransformMetaDataProducer(inputProducer);
+                        _producerFactory.NewAddImageTransformMetaDataProducer(inputProducer);
 
                     if (_resizeAndRotateEnabledForNetwork && !_downsampleEnabled)
                     {
@@ -537,7 +542,7 @@ namespace ImagePipeline.Core
             IThumbnailProducer<EncodedImage>[] thumbnailProducers)
         {
             IProducer<EncodedImage> localImageProducer =
-                ProducerFactory.NewAddImageTransformMetaDataProducer(inputProducer);
+                _producerFactory.NewAddImageTransformMetaDataProducer(inputProducer);
 
             if (!_downsampleEnabled)
             {
@@ -629,7 +634,12 @@ namespace ImagePipeline.Core
                 if (_dataFetchSequence == null)
                 {
                     IProducer<EncodedImage> inputProducer = _producerFactory.NewDataFetchProducer();
-                    inputProducer = ProducerFactory.NewAddImageTransformMetaDataProducer(inputProducer);
+                    if (IsWebpTranscodeRequired)
+                    {
+                        inputProducer = _producerFactory.NewWebpTranscodeProducer(inputProducer);
+                    }
+
+                    inputProducer = _producerFactory.NewAddImageTransformMetaDataProducer(inputProducer);
                     if (!_downsampleEnabled)
                     {
                         inputProducer = _producerFactory.NewResizeAndRotateProducer(inputProducer);
@@ -818,6 +828,18 @@ namespace ImagePipeline.Core
             }
         }
 
+        /// <summary>
+        /// Static webp is transcoded unless the app decodes webp itself or
+        /// the platform decoder handles it.
+        /// </summary>
+        private bool IsWebpTranscodeRequired
+        {
+            get
+            {
+                return !_webpSupportEnabled && WebpTranscoder.IsTranscodeRequired;
+            }
+        }
+
         private static void ValidateEncodedImageRequest(ImageRequest imageRequest)
         {
             Preconditions.CheckNotNull(imageRequest);
@@ -49,12 +49,20 @@ namespace ImagePipeline.Datasource
 
             CloseableReference<CloseableImage> closeableImageRef = dataSource.GetResult();
             SoftwareBitmap bitmap = null;
+            SoftwareBitmap firstFrame = null;
             if (closeableImageRef != null &&
                 (closeableImageRef.Get().GetType() == typeof(CloseableBitmap) ||
                  closeableImageRef.Get().GetType() == typeof(CloseableStaticBitmap)))
             {
                 bitmap = ((CloseableBitmap)closeableImageRef.Get()).UnderlyingBitmap;
             }
+            else if (closeableImageRef != null &&
+                closeableImageRef.Get().GetType() == typeof(CloseableAnimatedImage))
+            {
+                // Clients asking for a bitmap get the first frame
+                firstFrame = ((CloseableAnimatedImage)closeableImageRef.Get()).GetFrame(0);
+                bitmap = firstFrame;
+            }
 
             try
             {
@@ -62,6 +70,7 @@ namespace ImagePipeline.Datasource
             }
             finally
             {
+                firstFrame?.Dispose();
                 CloseableReference<CloseableImage>.CloseSafely(closeableImageRef);
             }
         }
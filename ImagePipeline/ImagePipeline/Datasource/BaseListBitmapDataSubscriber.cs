@@ -53,6 +53,7 @@ namespace ImagePipeline.Datasource
                 return;
             }
 
+            IList<SoftwareBitmap> firstFrames = new List<SoftwareBitmap>();
             try
             {
                 IList<SoftwareBitmap> bitmapList = new List<SoftwareBitmap>(imageRefList.Count);
@@ -63,6 +64,16 @@ namespace ImagePipeline.Datasource
                     {
                         bitmapList.Add(((CloseableBitmap)closeableImageRef.Get()).UnderlyingBitmap);
                     }
+                    else if (closeableImageRef != null &&
+                        closeableImageRef.Get().GetType() == typeof(CloseableAnimatedImage))
+                    {
+                        // Clients asking for bitmaps get the first frame
+                        SoftwareBitmap firstFrame =
+                            ((CloseableAnimatedImage)closeableImageRef.Get()).GetFrame(0);
+
+                        firstFrames.Add(firstFrame);
+                        bitmapList.Add(firstFrame);
+                    }
                     else
                     {
                         //This is so that client gets list with same length
@@ -74,6 +85,11 @@ namespace ImagePipeline.Datasource
             }
             finally
             {
+                foreach (var firstFrame in firstFrames)
+                {
+                    firstFrame.Dispose();
+                }
+
                 foreach (var closeableImageRef in imageRefList)
                 {
                     CloseableReference<CloseableImage>.CloseSafely(closeableImageRef);
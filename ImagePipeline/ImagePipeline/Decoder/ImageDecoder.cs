@@ -1,9 +1,13 @@
 ﻿using FBCore.Common.Internal;
+using FBCore.Common.References;
 using ImageFormatUtils;
 using ImagePipeline.AnimatedFactory;
 using ImagePipeline.Common;
 using ImagePipeline.Image;
+using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
 using ImagePipeline.Platform;
+using ImagePipeline.Producers;
 using System;
 using System.IO;
 using System.Threading.Tasks;
@@ -57,6 +61,70 @@ namespace ImagePipeline.Decoder
             int length,
             IQualityInfo qualityInfo,
             ImageDecodeOptions options)
+        {
+            return DecodeImageAsync(encodedImage, length, qualityInfo, options, null);
+        }
+
+        /// <summary>
+        /// Decodes the given region of the image.
+        /// </summary>
+        /// <param name="encodedImage">
+        /// Input image (encoded bytes plus meta data).
+        /// </param>
+        /// <param name="length">
+        /// If image type supports decoding incomplete image then 
+        /// determines where the image data should be cut for decoding.
+        /// </param>
+        /// <param name="qualityInfo">
+        /// Quality information for the image.
+        /// </param>
+        /// <param name="options">
+        /// Options that cange decode behavior.
+        /// </param>
+        /// <param name="cropOptions">
+        /// Region of the image to decode, null to decode all of it.
+        /// </param>
+        public Task<CloseableImage> DecodeImageAsync(
+            EncodedImage encodedImage,
+            int length,
+            IQualityInfo qualityInfo,
+            ImageDecodeOptions options,
+            CropOptions cropOptions)
+        {
+            return DecodeImageAsync(encodedImage, length, qualityInfo, options, cropOptions, null);
+        }
+
+        /// <summary>
+        /// Decodes the given region of the image, scaled down to cover the
+        /// requested size where the decoder supports it.
+        /// </summary>
+        /// <param name="encodedImage">
+        /// Input image (encoded bytes plus meta data).
+        /// </param>
+        /// <param name="length">
+        /// If image type supports decoding incomplete image then 
+        /// determines where the image data should be cut for decoding.
+        /// </param>
+        /// <param name="qualityInfo">
+        /// Quality information for the image.
+        /// </param>
+        /// <param name="options">
+        /// Options that cange decode behavior.
+        /// </param>
+        /// <param name="cropOptions">
+        /// Region of the image to decode, null to decode all of it.
+        /// </param>
+        /// <param name="resizeOptions">
+        /// Size the image is going to be displayed at, null to decode it
+        /// at full size.
+        /// </param>
+        public Task<CloseableImage> DecodeImageAsync(
+            EncodedImage encodedImage,
+            int length,
+            IQualityInfo qualityInfo,
+            ImageDecodeOptions options,
+            CropOptions cropOptions,
+            ResizeOptions resizeOptions)
         {
             ImageFormat imageFormat = encodedImage.Format;
             if (imageFormat == ImageFormat.UNINITIALIZED || imageFormat == ImageFormat.UNKNOWN)
@@ -73,19 +141,34 @@ namespace ImagePipeline.Decoder
                     throw new ArgumentException("unknown image format");
 
                 case ImageFormat.JPEG:
-                    return DecodeJpegAsync(encodedImage, length, qualityInfo)
+                    return DecodeJpegAsync(encodedImage, length, qualityInfo, cropOptions)
                         .ContinueWith(
                         task => ((CloseableImage)task.Result), 
                         TaskContinuationOptions.ExecuteSynchronously);
 
                 case ImageFormat.GIF:
-                    return DecodeGifAsync(encodedImage, options);
+                    return DecodeGifAsync(encodedImage, options, cropOptions);
 
                 case ImageFormat.WEBP_ANIMATED:
                     return DecodeAnimatedWebpAsync(encodedImage, options);
 
+                case ImageFormat.PNG:
+                    return DecodePngAsync(encodedImage, cropOptions, resizeOptions)
+                        .ContinueWith(
+                        task => ((CloseableImage)task.Result),
+                        TaskContinuationOptions.ExecuteSynchronously);
+
+                case ImageFormat.WEBP_SIMPLE:
+                case ImageFormat.WEBP_LOSSLESS:
+                case ImageFormat.WEBP_EXTENDED:
+                case ImageFormat.WEBP_EXTENDED_WITH_ALPHA:
+                    return DecodeWebpAsync(encodedImage, cropOptions, resizeOptions)
+                        .ContinueWith(
+                        task => ((CloseableImage)task.Result),
+                        TaskContinuationOptions.ExecuteSynchronously);
+
                 default:
-                    return DecodeStaticImageAsync(encodedImage)
+                    return DecodeStaticImageAsync(encodedImage, cropOptions)
                         .ContinueWith(
                         task => ((CloseableImage)task.Result),
                         TaskContinuationOptions.ExecuteSynchronously);
@@ -93,7 +176,9 @@ namespace ImagePipeline.Decoder
         }
 
         /// <summary>
-        /// Decodes gif into CloseableImage.
+        /// Decodes gif into CloseableImage, animated gifs into a
+        /// <see cref="CloseableAnimatedImage"/> unless a static image is
+        /// forced.
         /// </summary>
         /// <param name="encodedImage">
         /// Input image (encoded bytes plus meta data).
@@ -104,7 +189,28 @@ namespace ImagePipeline.Decoder
             EncodedImage encodedImage,
             ImageDecodeOptions options)
         {
-            Stream inputStream = encodedImage.GetInputStream();
+            return DecodeGifAsync(encodedImage, options, null);
+        }
+
+        /// <summary>
+        /// Decodes the given region of gif into CloseableImage.
+        /// </summary>
+        /// <param name="encodedImage">
+        /// Input image (encoded bytes plus meta data).
+        /// </param>
+        /// <param name="options">Decode options.</param>
+        /// <param name="cropOptions">
+        /// Region of the image to decode, null to decode all of it.
+        /// </param>
+        /// <returns>A CloseableImage.</returns>
+        public Task<CloseableImage> DecodeGifAsync(
+            EncodedImage encodedImage,
+            ImageDecodeOptions options,
+            CropOptions cropOptions)
+        {
+            Stream inputStream = (Stream)encodedImage.GetByteBufferView() ??
+                encodedImage.GetInputStream();
+
             if (inputStream == null)
             {
                 return Task.FromResult(default(CloseableImage));
@@ -112,8 +218,16 @@ namespace ImagePipeline.Decoder
 
             try
             {
-                // Phong Cao: always forceStaticImage
-                return DecodeStaticImageAsync(encodedImage)
+                if (!options.ForceStaticImage &&
+                    cropOptions == null &&
+                    _animatedImageFactory != null &&
+                    GifFormatChecker.IsAnimated(inputStream))
+                {
+                    return Task.FromResult(_animatedImageFactory.DecodeGif(
+                        encodedImage, options, _bitmapConfig));
+                }
+
+                return DecodeStaticImageAsync(encodedImage, cropOptions)
                     .ContinueWith(
                     task => ((CloseableImage)task.Result),
                     TaskContinuationOptions.ExecuteSynchronously);
@@ -133,8 +247,29 @@ namespace ImagePipeline.Decoder
         /// <returns>A CloseableStaticBitmap.</returns>
         public Task<CloseableStaticBitmap> DecodeStaticImageAsync(EncodedImage encodedImage)
         {
-            return _platformDecoder
-                .DecodeFromEncodedImageAsync(encodedImage, _bitmapConfig)
+            return DecodeStaticImageAsync(encodedImage, null);
+        }
+
+        /// <summary>
+        /// Decodes the given region of a static bitmap.
+        /// </summary>
+        /// <param name="encodedImage">
+        /// Input image (encoded bytes plus meta data).
+        /// </param>
+        /// <param name="cropOptions">
+        /// Region of the image to decode, null to decode all of it.
+        /// </param>
+        /// <returns>A CloseableStaticBitmap.</returns>
+        public Task<CloseableStaticBitmap> DecodeStaticImageAsync(
+            EncodedImage encodedImage,
+            CropOptions cropOptions)
+        {
+            Task<CloseableReference<SoftwareBitmap>> decodeTask = (cropOptions == null) ?
+                _platformDecoder.DecodeFromEncodedImageAsync(encodedImage, _bitmapConfig) :
+                GetRegionPlatformDecoder().DecodeFromEncodedImageAsync(
+                    encodedImage, _bitmapConfig, cropOptions);
+
+            return decodeTask
                 .ContinueWith(
                 task =>
                 {
@@ -153,6 +288,142 @@ namespace ImagePipeline.Decoder
                 TaskContinuationOptions.ExecuteSynchronously);
         }
 
+        /// <summary>
+        /// Decodes png, natively and scaled down while decoding when it is
+        /// held in native memory and not cropped. Other pngs go to the
+        /// platform decoder.
+        /// </summary>
+        /// <param name="encodedImage">
+        /// Input image (encoded bytes plus meta data).
+        /// </param>
+        /// <param name="cropOptions">
+        /// Region of the image to decode, null to decode all of it.
+        /// </param>
+        /// <param name="resizeOptions">
+        /// Size the image is going to be displayed at, null to decode it
+        /// at full size.
+        /// </param>
+        /// <returns>A CloseableStaticBitmap.</returns>
+        public Task<CloseableStaticBitmap> DecodePngAsync(
+            EncodedImage encodedImage,
+            CropOptions cropOptions,
+            ResizeOptions resizeOptions)
+        {
+#if HAS_LIBPNG
+            if (cropOptions == null)
+            {
+                CloseableReference<IPooledByteBuffer> bufferRef = encodedImage.GetByteBufferRef();
+                try
+                {
+                    NativePooledByteBuffer nativeBuffer = (bufferRef != null) ?
+                        bufferRef.Get() as NativePooledByteBuffer : null;
+
+                    if (nativeBuffer != null)
+                    {
+                        long srcPtr = nativeBuffer.GetNativePtr();
+                        int srcLength = nativeBuffer.Size;
+                        int width = encodedImage.Width;
+                        int height = encodedImage.Height;
+                        if (width <= 0 || height <= 0)
+                        {
+                            PngDecoder.GetDecodeSize(srcPtr, srcLength, null, out width, out height);
+                        }
+
+                        ScaleToTargetSize(resizeOptions, ref width, ref height);
+                        SoftwareBitmap bitmap = PngDecoder.DecodeToSoftwareBitmap(
+                            srcPtr, srcLength, width, height, _bitmapConfig);
+
+                        try
+                        {
+                            return Task.FromResult(new CloseableStaticBitmap(
+                                bitmap,
+                                ImmutableQualityInfo.FULL_QUALITY,
+                                encodedImage.RotationAngle));
+                        }
+                        finally
+                        {
+                            bitmap.Dispose();
+                        }
+                    }
+                }
+                finally
+                {
+                    CloseableReference<IPooledByteBuffer>.CloseSafely(bufferRef);
+                }
+            }
+#endif // HAS_LIBPNG
+
+            return DecodeStaticImageAsync(encodedImage, cropOptions);
+        }
+
+        /// <summary>
+        /// Decodes static webp, natively and scaled down by libwebp while
+        /// decoding when it is held in native memory and not cropped.
+        /// Other webps go to the platform decoder.
+        /// </summary>
+        /// <param name="encodedImage">
+        /// Input image (encoded bytes plus meta data).
+        /// </param>
+        /// <param name="cropOptions">
+        /// Region of the image to decode, null to decode all of it.
+        /// </param>
+        /// <param name="resizeOptions">
+        /// Size the image is going to be displayed at, null to decode it
+        /// at full size.
+        /// </param>
+        /// <returns>A CloseableStaticBitmap.</returns>
+        public Task<CloseableStaticBitmap> DecodeWebpAsync(
+            EncodedImage encodedImage,
+            CropOptions cropOptions,
+            ResizeOptions resizeOptions)
+        {
+#if HAS_LIBWEBP
+            if (cropOptions == null)
+            {
+                CloseableReference<IPooledByteBuffer> bufferRef = encodedImage.GetByteBufferRef();
+                try
+                {
+                    NativePooledByteBuffer nativeBuffer = (bufferRef != null) ?
+                        bufferRef.Get() as NativePooledByteBuffer : null;
+
+                    if (nativeBuffer != null)
+                    {
+                        long srcPtr = nativeBuffer.GetNativePtr();
+                        int srcLength = nativeBuffer.Size;
+                        int width = encodedImage.Width;
+                        int height = encodedImage.Height;
+                        if (width <= 0 || height <= 0)
+                        {
+                            WebpTranscoder.GetDecodeSize(srcPtr, srcLength, null, out width, out height);
+                        }
+
+                        ScaleToTargetSize(resizeOptions, ref width, ref height);
+                        SoftwareBitmap bitmap = WebpTranscoder.DecodeToSoftwareBitmap(
+                            srcPtr, srcLength, width, height, _bitmapConfig);
+
+                        try
+                        {
+                            return Task.FromResult(new CloseableStaticBitmap(
+                                bitmap,
+                                ImmutableQualityInfo.FULL_QUALITY,
+                                encodedImage.RotationAngle));
+                        }
+                        finally
+                        {
+                            bitmap.Dispose();
+                        }
+                    }
+                }
+                finally
+                {
+                    CloseableReference<IPooledByteBuffer>.CloseSafely(bufferRef);
+                }
+            }
+#endif // HAS_LIBWEBP
+
+            return DecodeStaticImageAsync(encodedImage, cropOptions);
+        }
+
         /// <summary>
         /// Decodes a partial jpeg.
         /// </summary>
@@ -171,8 +442,37 @@ namespace ImagePipeline.Decoder
             int length,
             IQualityInfo qualityInfo)
         {
-            return _platformDecoder
-                .DecodeJPEGFromEncodedImageAsync(encodedImage, _bitmapConfig, length)
+            return DecodeJpegAsync(encodedImage, length, qualityInfo, null);
+        }
+
+        /// <summary>
+        /// Decodes the given region of a partial jpeg.
+        /// </summary>
+        /// <param name="encodedImage">
+        /// Input image (encoded bytes plus meta data).
+        /// </param>
+        /// <param name="length">
+        /// Amount of currently available data in bytes.
+        /// </param>
+        /// <param name="qualityInfo">
+        /// Quality info for the image.
+        /// </param>
+        /// <param name="cropOptions">
+        /// Region of the image to decode, null to decode all of it.
+        /// </param>
+        /// <returns>A CloseableStaticBitmap.</returns>
+        public Task<CloseableStaticBitmap> DecodeJpegAsync(
+            EncodedImage encodedImage,
+            int length,
+            IQualityInfo qualityInfo,
+            CropOptions cropOptions)
+        {
+            Task<CloseableReference<SoftwareBitmap>> decodeTask = (cropOptions == null) ?
+                _platformDecoder.DecodeJPEGFromEncodedImageAsync(encodedImage, _bitmapConfig, length) :
+                GetRegionPlatformDecoder().DecodeJPEGFromEncodedImageAsync(
+                    encodedImage, _bitmapConfig, length, cropOptions);
+
+            return decodeTask
                 .ContinueWith(
                 task =>
                 {
@@ -205,5 +505,43 @@ namespace ImagePipeline.Decoder
         {
             throw new NotImplementedException();
         }
+
+        /// <summary>
+        /// Gets the platform decoder for decoding a region of the image.
+        /// </summary>
+        /// <exception cref="NotSupportedException">
+        /// If the platform decoder can only decode whole images.
+        /// </exception>
+        private IRegionPlatformDecoder GetRegionPlatformDecoder()
+        {
+            IRegionPlatformDecoder regionDecoder = _platformDecoder as IRegionPlatformDecoder;
+            if (regionDecoder == null)
+            {
+                throw new NotSupportedException(
+                    "The platform decoder does not support crop options");
+            }
+
+            return regionDecoder;
+        }
+
+        /// <summary>
+        /// Scales the size of an image to the size it is decoded at
+        /// natively, the same way <see cref="ResizeAndRotateProducer"/>
+        /// picks the size of jpegs. Images are never upscaled.
+        /// </summary>
+        private static void ScaleToTargetSize(
+            ResizeOptions resizeOptions,
+            ref int width,
+            ref int height)
+        {
+            float ratio = ResizeAndRotateProducer.DetermineResizeRatio(resizeOptions, width, height);
+            if (ratio >= 1.0f)
+            {
+                return;
+            }
+
+            width = Math.Max((int)Math.Round(width * ratio), 1);
+            height = Math.Max((int)Math.Round(height * ratio), 1);
+        }
     }
 }
@@ -2,12 +2,25 @@
 using FBCore.Common.Util;
 using ImagePipeline.Image;
 using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
 using ImageUtils;
 using System.Collections.Concurrent;
 using System.IO;
+using System.Runtime.InteropServices;
 
 namespace ImagePipeline.Decoder
 {
+    /// <summary>
+    /// Matches JpegScanState in JpegMarkerScanner.h.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeJpegScanState
+    {
+        public int ParserState;
+        public int LastByteRead;
+        public int BytesParsed;
+    }
+
     /// <summary>
     /// Progressively scans jpeg data and instructs caller when enough data is
     /// available to decode a partial image.
@@ -18,6 +31,9 @@ namespace ImagePipeline.Decoder
     /// <para />Users should call ParseMoreData method each time new chunk of
     /// data is received. The buffer passed as a parameter should include entire
     /// image data received so far.
+    ///
+    /// <para />Data in native memory is scanned for markers natively, with
+    /// the state kept here between calls, other data is read byte by byte.
     /// </summary>
     public class ProgressiveJpegParser
     {
@@ -70,6 +86,12 @@ namespace ImagePipeline.Decoder
         /// </summary> 
         private const int BUFFER_SIZE = 16 * ByteConstants.KB;
 
+        /// <summary>
+        /// Number of scan offsets returned per native scan, which is
+        /// called again while it fills them all.
+        /// </summary>
+        private const int SCAN_OFFSET_CAPACITY = 16;
+
         private int _parserState;
         private int _lastByteRead;
 
@@ -88,6 +110,7 @@ namespace ImagePipeline.Decoder
 
         private readonly IByteArrayPool _byteArrayPool;
         private readonly ConcurrentDictionary<int, int> _bestScanEndOffsetList;
+        private readonly int[] _scanOffsets;
 
         /// <summary>
         /// Instantiates the <see cref="ProgressiveJpegParser"/>.
@@ -102,6 +125,7 @@ namespace ImagePipeline.Decoder
             _bestScanNumber = 0;
             _parserState = READ_FIRST_JPEG_BYTE;
             _bestScanEndOffsetList = new ConcurrentDictionary<int, int>();
+            _scanOffsets = new int[SCAN_OFFSET_CAPACITY];
         }
 
         /// <summary>
@@ -137,6 +161,14 @@ namespace ImagePipeline.Decoder
                 return false;
             }
 
+            using (PooledByteBufferView view = encodedImage.GetByteBufferView())
+            {
+                if (view != null)
+                {
+                    return DoScanMoreData(encodedImage, view);
+                }
+            }
+
             Stream bufferedDataStream = new PooledByteArrayBufferedInputStream(
                 encodedImage.GetInputStream(),
                 _byteArrayPool.Get(BUFFER_SIZE),
@@ -276,6 +308,45 @@ namespace ImagePipeline.Decoder
             return _parserState != NOT_A_JPEG && _bestScanNumber != oldBestScanNumber;
         }
 
+        /// <summary>
+        /// Scans the native memory of the image for SOS and EOI markers,
+        /// resuming from the current parser state.
+        /// </summary>
+        /// <param name="encodedImage">The encoded image.</param>
+        /// <param name="view">The view over the image data.</param>
+        private bool DoScanMoreData(EncodedImage encodedImage, PooledByteBufferView view)
+        {
+            int oldBestScanNumber = _bestScanNumber;
+            NativeJpegScanState state = new NativeJpegScanState
+            {
+                ParserState = _parserState,
+                LastByteRead = _lastByteRead,
+                BytesParsed = _bytesParsed
+            };
+
+            int count;
+            do
+            {
+                count = NativeMethods.nativeScanJpegMarkers(
+                    view.NativePtr,
+                    view.Size,
+                    ref state,
+                    _scanOffsets,
+                    SCAN_OFFSET_CAPACITY);
+
+                for (int i = 0; i < count; ++i)
+                {
+                    NewScanOrImageEndFound(encodedImage, _scanOffsets[i]);
+                }
+            }
+            while (count == SCAN_OFFSET_CAPACITY);
+
+            _parserState = state.ParserState;
+            _lastByteRead = state.LastByteRead;
+            _bytesParsed = state.BytesParsed;
+            return _parserState != NOT_A_JPEG && _bestScanNumber != oldBestScanNumber;
+        }
+
         /// <summary>
         /// Not every marker is followed by associated segment.
         /// </summary>
@@ -0,0 +1,208 @@
+﻿using FBCore.Common.Internal;
+using ImagePipeline.NativeCode;
+using ImagePipeline.Request;
+using Windows.Graphics.Imaging;
+
+namespace ImagePipeline.Image
+{
+    /// <summary>
+    /// Encapsulates an animated gif whose frames are rendered on demand.
+    ///
+    /// <para />Frames are composited natively, playback and seeking
+    /// resume from the closest keyframe held by the animation instead of
+    /// decoding every frame up front.
+    /// </summary>
+    public sealed class CloseableAnimatedImage : CloseableImage
+    {
+        private readonly object _animationGate = new object();
+
+        private readonly BitmapPixelFormat _bitmapConfig;
+
+        private GifAnimation _animation;
+
+        /// <summary>
+        /// Instantiates the <see cref="CloseableAnimatedImage"/>, taking
+        /// ownership of the animation.
+        /// </summary>
+        /// <param name="animation">The animation to render.</param>
+        /// <param name="bitmapConfig">
+        /// Pixel format of the rendered frames.
+        /// </param>
+        public CloseableAnimatedImage(GifAnimation animation, BitmapPixelFormat bitmapConfig)
+        {
+            _animation = Preconditions.CheckNotNull(animation);
+            _bitmapConfig = bitmapConfig;
+        }
+
+        /// <summary>
+        /// Number of frames of the animation.
+        /// </summary>
+        public int FrameCount
+        {
+            get
+            {
+                GifAnimation animation = _animation;
+                return (animation == null) ? 0 : animation.FrameCount;
+            }
+        }
+
+        /// <summary>
+        /// Number of times the animation repeats, 0 to repeat forever and
+        /// -1 to play it once.
+        /// </summary>
+        public int LoopCount
+        {
+            get
+            {
+                GifAnimation animation = _animation;
+                return (animation == null) ? 0 : animation.LoopCount;
+            }
+        }
+
+        /// <summary>
+        /// Returns how long given frame is shown, in milliseconds.
+        /// </summary>
+        public int GetFrameDurationMs(int index)
+        {
+            lock (_animationGate)
+            {
+                Preconditions.CheckState(_animation != null, "Cannot read a closed animated image");
+                return _animation.GetFrameDurationMs(index);
+            }
+        }
+
+        /// <summary>
+        /// Renders given frame as displayed.
+        /// </summary>
+        /// <param name="index">Index of the frame.</param>
+        /// <returns>
+        /// Bitmap with premultiplied alpha, owned by the caller.
+        /// </returns>
+        public SoftwareBitmap GetFrame(int index)
+        {
+            lock (_animationGate)
+            {
+                Preconditions.CheckState(_animation != null, "Cannot render a closed animated image");
+                if (_bitmapConfig == BitmapPixelFormat.Bgra8)
+                {
+                    // Premultiplied as the rows leave the canvas
+                    var bitmap = new SoftwareBitmap(
+                        BitmapPixelFormat.Bgra8,
+                        _animation.Width,
+                        _animation.Height,
+                        BitmapAlphaMode.Premultiplied);
+
+                    try
+                    {
+                        RenderInto(index, NativePixelFormat.BGRA_PREMULTIPLIED, bitmap);
+                        return bitmap;
+                    }
+                    catch
+                    {
+                        bitmap.Dispose();
+                        throw;
+                    }
+                }
+
+                using (var rendered = new SoftwareBitmap(
+                    BitmapPixelFormat.Rgba8,
+                    _animation.Width,
+                    _animation.Height,
+                    BitmapAlphaMode.Straight))
+                {
+                    RenderInto(index, NativePixelFormat.RGBA, rendered);
+                    return SoftwareBitmap.Convert(
+                        rendered, _bitmapConfig, BitmapAlphaMode.Premultiplied);
+                }
+            }
+        }
+
+        private unsafe void RenderInto(int index, NativePixelFormat pixelFormat, SoftwareBitmap bitmap)
+        {
+            using (BitmapBuffer buffer = bitmap.LockBuffer(BitmapBufferAccessMode.Write))
+            using (var reference = buffer.CreateReference())
+            {
+                byte* data;
+                uint capacity;
+                ((IMemoryBufferByteAccess)reference).GetBuffer(out data, out capacity);
+
+                BitmapPlaneDescription plane = buffer.GetPlaneDescription(0);
+                _animation.RenderFrame(
+                    index,
+                    pixelFormat,
+                    (long)(data + plane.StartIndex),
+                    plane.Stride,
+                    (int)capacity - plane.StartIndex);
+            }
+        }
+
+        /// <summary>
+        /// Releases the animation.
+        /// </summary>
+        protected override void Dispose(bool disposing)
+        {
+            base.Dispose(disposing);
+            GifAnimation animation;
+            lock (_animationGate)
+            {
+                animation = _animation;
+                _animation = null;
+            }
+
+            if (animation != null)
+            {
+                animation.Dispose();
+            }
+        }
+
+        /// <summary>
+        /// Returns whether this instance is closed.
+        /// </summary>
+        public override bool IsClosed
+        {
+            get
+            {
+                lock (_animationGate)
+                {
+                    return _animation == null;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Returns size in bytes of the native memory held.
+        /// </summary>
+        public override int SizeInBytes
+        {
+            get
+            {
+                GifAnimation animation = _animation;
+                return (animation == null) ? 0 : animation.SizeInBytes;
+            }
+        }
+
+        /// <summary>
+        /// Returns width of the animation.
+        /// </summary>
+        public override int Width
+        {
+            get
+            {
+                GifAnimation animation = _animation;
+                return (animation == null) ? 0 : animation.Width;
+            }
+        }
+
+        /// <summary>
+        /// Returns height of the animation.
+        /// </summary>
+        public override int Height
+        {
+            get
+            {
+                GifAnimation animation = _animation;
+                return (animation == null) ? 0 : animation.Height;
+            }
+        }
+    }
+}
@@ -448,7 +448,7 @@ namespace ImagePipeline.Memory
         /// <param name="memoryTrimType">
         /// The kind of trimming we want to perform.
         /// </param>
-        public void Trim(double memoryTrimType)
+        public virtual void Trim(double memoryTrimType)
         {
             TrimToNothing();
         }
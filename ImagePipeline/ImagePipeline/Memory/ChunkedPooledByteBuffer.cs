@@ -0,0 +1,188 @@
+﻿using FBCore.Common.Internal;
+using FBCore.Common.References;
+using System;
+using System.Collections.Generic;
+
+namespace ImagePipeline.Memory
+{
+    /// <summary>
+    /// An implementation of <see cref="IPooledByteBuffer"/> whose bytes
+    /// are spread over several pooled native memory chunks
+    /// (<see cref="NativeMemoryChunk"/>), e.g. the output of an encoder
+    /// written straight into the chunks.
+    ///
+    /// <para />The bytes are not contiguous, <see cref="GetNativePtr"/>
+    /// returns 0 and they are only accessible through Read.
+    /// </summary>
+    public sealed class ChunkedPooledByteBuffer : IPooledByteBuffer
+    {
+        private readonly object _poolGate = new object();
+        private readonly int[] _chunkSizes;
+        private readonly int _size;
+
+        internal CloseableReference<NativeMemoryChunk>[] _chunkRefs;
+
+        /// <summary>
+        /// Instantiates the <see cref="ChunkedPooledByteBuffer"/> over the
+        /// first chunkSizes[i] bytes of each chunk, in order.
+        /// </summary>
+        /// <param name="chunkRefs">
+        /// The chunks holding the bytes, cloned by the buffer.
+        /// </param>
+        /// <param name="chunkSizes">Number of bytes used in each chunk.</param>
+        public ChunkedPooledByteBuffer(
+            IList<CloseableReference<NativeMemoryChunk>> chunkRefs,
+            IList<int> chunkSizes)
+        {
+            Preconditions.CheckNotNull(chunkRefs);
+            Preconditions.CheckNotNull(chunkSizes);
+            Preconditions.CheckArgument(chunkRefs.Count == chunkSizes.Count);
+
+            _chunkSizes = new int[chunkSizes.Count];
+            for (int i = 0; i < _chunkSizes.Length; ++i)
+            {
+                Preconditions.CheckNotNull(chunkRefs[i]);
+                Preconditions.CheckArgument(chunkSizes[i] >= 0);
+                Preconditions.CheckArgument(chunkSizes[i] <= chunkRefs[i].Get().Size);
+                _chunkSizes[i] = chunkSizes[i];
+                _size = checked(_size + chunkSizes[i]);
+            }
+
+            _chunkRefs = new CloseableReference<NativeMemoryChunk>[chunkRefs.Count];
+            for (int i = 0; i < _chunkRefs.Length; ++i)
+            {
+                _chunkRefs[i] = chunkRefs[i].Clone();
+            }
+        }
+
+        /// <summary>
+        /// Gets the size of the bytebuffer if it is valid. Otherwise,
+        /// an exception is raised.
+        /// </summary>
+        /// <returns>
+        /// The size of the bytebuffer if it is not closed.
+        /// </returns>
+        public int Size
+        {
+            get
+            {
+                lock (_poolGate)
+                {
+                    EnsureValid();
+                    return _size;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Reads one byte.
+        /// </summary>
+        public byte Read(int offset)
+        {
+            lock (_poolGate)
+            {
+                EnsureValid();
+                Preconditions.CheckArgument(offset >= 0);
+                Preconditions.CheckArgument(offset < _size);
+
+                int chunk = 0;
+                while (offset >= _chunkSizes[chunk])
+                {
+                    offset -= _chunkSizes[chunk];
+                    ++chunk;
+                }
+
+                return _chunkRefs[chunk].Get().Read(offset);
+            }
+        }
+
+        /// <summary>
+        /// Reads a byte buffer, across chunk boundaries.
+        /// </summary>
+        public void Read(int offset, byte[] buffer, int bufferOffset, int length)
+        {
+            lock (_poolGate)
+            {
+                EnsureValid();
+                Preconditions.CheckArgument(offset >= 0 && length >= 0);
+                Preconditions.CheckArgument(offset <= _size - length);
+
+                for (int chunk = 0; length > 0; ++chunk)
+                {
+                    if (offset >= _chunkSizes[chunk])
+                    {
+                        offset -= _chunkSizes[chunk];
+                        continue;
+                    }
+
+                    int count = Math.Min(length, _chunkSizes[chunk] - offset);
+                    _chunkRefs[chunk].Get().Read(offset, buffer, bufferOffset, count);
+                    offset = 0;
+                    bufferOffset += count;
+                    length -= count;
+                }
+            }
+        }
+
+        /// <summary>
+        /// The bytes are not contiguous in native memory.
+        /// </summary>
+        /// <returns>Always 0.</returns>
+        public long GetNativePtr()
+        {
+            return 0;
+        }
+
+        /// <summary>
+        /// Check if this bytebuffer is already closed.
+        /// </summary>
+        /// <returns>true if this bytebuffer is closed.</returns>
+        public bool IsClosed
+        {
+            get
+            {
+                lock (_poolGate)
+                {
+                    return _chunkRefs == null;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Closes this instance, and releases the underlying chunks
+        /// to the pool. Once the bytebuffer has been closed, subsequent
+        /// operations will fail.
+        /// Note: It is not an error to close an already closed bytebuffer.
+        /// </summary>
+        public void Dispose()
+        {
+            lock (_poolGate)
+            {
+                if (_chunkRefs == null)
+                {
+                    return;
+                }
+
+                foreach (CloseableReference<NativeMemoryChunk> chunkRef in _chunkRefs)
+                {
+                    CloseableReference<NativeMemoryChunk>.CloseSafely(chunkRef);
+                }
+
+                _chunkRefs = null;
+            }
+        }
+
+        /// <summary>
+        /// Validates that the bytebuffer instance is valid
+        /// (aka not closed).
+        /// If it is closed, then we raise a ClosedException.
+        /// </summary>
+        private void EnsureValid()
+        {
+            if (IsClosed)
+            {
+                throw new ClosedException();
+            }
+        }
+    }
+}
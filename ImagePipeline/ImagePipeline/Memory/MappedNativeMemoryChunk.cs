@@ -0,0 +1,126 @@
+﻿using FBCore.Common.Internal;
+using ImagePipeline.NativeCode;
+using System;
+using System.IO;
+
+namespace ImagePipeline.Memory
+{
+    /// <summary>
+    /// Read-only <see cref="NativeMemoryChunk"/> over a file mapped into
+    /// memory.
+    ///
+    /// <para />The pages of the file are read in on first access rather
+    /// than copied up front, and the file is unmapped when the chunk is
+    /// closed. Chunks are not pooled, they are released as soon as the
+    /// last reference to them is closed.
+    ///
+    /// <para />A page that can't be read in, e.g. because the file was
+    /// truncated since it was mapped, fails the read with an
+    /// <see cref="IOException"/>. The native pointer of the chunk is not
+    /// guarded this way, so it should not be handed to native code.
+    /// </summary>
+    public class MappedNativeMemoryChunk : NativeMemoryChunk
+    {
+        private MappedNativeMemoryChunk(long nativePtr, int size) : base(nativePtr, size)
+        {
+        }
+
+        /// <summary>
+        /// Maps the file at path into memory.
+        /// </summary>
+        /// <param name="path">The path of the file.</param>
+        /// <returns>
+        /// The chunk over the whole file, or null if the file could not
+        /// be mapped or is empty.
+        /// </returns>
+        public static MappedNativeMemoryChunk Map(string path)
+        {
+            int size;
+            long nativePtr = NativeMethods.nativeMapFile(path, out size);
+            if (nativePtr == 0)
+            {
+                return null;
+            }
+
+            return new MappedNativeMemoryChunk(nativePtr, size);
+        }
+
+        /// <summary>
+        /// Mapped chunks can only be read.
+        /// </summary>
+        public override bool IsReadOnly
+        {
+            get
+            {
+                return true;
+            }
+        }
+
+        /// <summary>
+        /// Not supported, mapped chunks can only be read.
+        /// </summary>
+        public override int Write(
+            int nativeMemoryOffset,
+            byte[] byteArray,
+            int byteArrayOffset,
+            int count)
+        {
+            throw new InvalidOperationException("Mapped chunks are read-only");
+        }
+
+        /// <summary>
+        /// Reads byte at given offset.
+        /// </summary>
+        /// <exception cref="IOException">
+        /// If the page holding the byte could not be read in.
+        /// </exception>
+        public override byte Read(int offset)
+        {
+            Preconditions.CheckArgument(offset < Size);
+            byte[] value = new byte[1];
+            Read(offset, value, 0, 1);
+            return value[0];
+        }
+
+        /// <summary>
+        /// Copies bytes of the file, failing with an
+        /// <see cref="IOException"/> if its pages could not be read in.
+        /// </summary>
+        protected override void CopyToNative(long dstPtr, long srcPtr, int count)
+        {
+            if (NativeMethods.nativeCopyFromMapping(dstPtr, srcPtr, count) == 0)
+            {
+                throw new IOException("Could not read the mapped file");
+            }
+        }
+
+        /// <summary>
+        /// Copies bytes of the file, failing with an
+        /// <see cref="IOException"/> if its pages could not be read in.
+        /// </summary>
+        protected override unsafe void CopyToByteArray(
+            long srcPtr,
+            byte[] byteArray,
+            int byteArrayOffset,
+            int count)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            fixed (byte* dst = byteArray)
+            {
+                CopyToNative((long)(dst + byteArrayOffset), srcPtr, count);
+            }
+        }
+
+        /// <summary>
+        /// Unmaps the file.
+        /// </summary>
+        protected override void FreeNativeMemory(long nativePtr)
+        {
+            NativeMethods.nativeUnmap(nativePtr);
+        }
+    }
+}
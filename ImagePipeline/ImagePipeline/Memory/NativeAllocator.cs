@@ -0,0 +1,100 @@
+﻿using ImagePipeline.NativeCode;
+
+namespace ImagePipeline.Memory
+{
+    /// <summary>
+    /// Memory held by the native allocator.
+    /// </summary>
+    public sealed class NativeAllocatorStats
+    {
+        /// <summary>
+        /// Bytes reserved from the OS for arenas and large blocks.
+        /// </summary>
+        public long ReservedBytes { get; }
+
+        /// <summary>
+        /// Bytes of blocks handed out, including the freed blocks
+        /// kept for reuse.
+        /// </summary>
+        public long UsedBytes { get; }
+
+        /// <summary>
+        /// Bytes of freed blocks cached by threads and of freed blocks
+        /// larger than 1 MB kept for reuse, part of
+        /// <see cref="UsedBytes"/>.
+        /// </summary>
+        public long CachedBytes { get; }
+
+        /// <summary>
+        /// Number of 2 MB arenas holding blocks up to 1 MB.
+        /// </summary>
+        public int ArenaCount { get; }
+
+        /// <summary>
+        /// Number of blocks larger than 1 MB, mapped one by one,
+        /// including the freed ones kept for reuse.
+        /// </summary>
+        public int LargeBlockCount { get; }
+
+        internal NativeAllocatorStats(
+            long reservedBytes,
+            long usedBytes,
+            long cachedBytes,
+            int arenaCount,
+            int largeBlockCount)
+        {
+            ReservedBytes = reservedBytes;
+            UsedBytes = usedBytes;
+            CachedBytes = cachedBytes;
+            ArenaCount = arenaCount;
+            LargeBlockCount = largeBlockCount;
+        }
+    }
+
+    /// <summary>
+    /// Native allocator behind <see cref="NativeMemoryChunk"/>.
+    ///
+    /// <para />Chunks up to 1 MB are carved out of 2 MB arenas of
+    /// same sized blocks, and each thread keeps a few freed blocks
+    /// to reuse without locking. Larger chunks are mapped from the
+    /// OS directly, and up to 32 MB of them are kept once freed for
+    /// chunks at most a quarter smaller.
+    /// </summary>
+    public static class NativeAllocator
+    {
+        /// <summary>
+        /// Returns the empty arenas and the freed large blocks to the
+        /// OS. Blocks cached by other threads are returned the next
+        /// time those threads allocate or free a chunk.
+        /// </summary>
+        public static void Trim()
+        {
+            NativeMethods.nativeTrimAllocator();
+        }
+
+        /// <summary>
+        /// Gets the memory currently held by the allocator.
+        /// </summary>
+        public static NativeAllocatorStats GetStats()
+        {
+            long reservedBytes;
+            long usedBytes;
+            long cachedBytes;
+            int arenaCount;
+            int largeBlockCount;
+            NativeMethods.nativeGetAllocatorStats(
+                out reservedBytes,
+                out usedBytes,
+                out cachedBytes,
+                out arenaCount,
+                out largeBlockCount);
+
+            return new NativeAllocatorStats(
+                reservedBytes,
+                usedBytes,
+                cachedBytes,
+                arenaCount,
+                largeBlockCount);
+        }
+    }
+}
@@ -1,7 +1,9 @@
 ﻿using FBCore.Common.Internal;
 using ImagePipeline.NativeCode;
 using System;
+using System.Collections.Generic;
 using System.Diagnostics;
+using System.Threading;
 
 namespace ImagePipeline.Memory
 {
@@ -50,6 +52,22 @@ namespace ImagePipeline.Memory
             _closed = false;
         }
 
+        /// <summary>
+        /// Instantiates the <see cref="NativeMemoryChunk"/> over memory
+        /// obtained by a subclass, released by
+        /// <see cref="FreeNativeMemory(long)"/>.
+        /// </summary>
+        /// <param name="nativePtr">Address of the memory.</param>
+        /// <param name="size">The size of the chunk.</param>
+        protected NativeMemoryChunk(long nativePtr, int size)
+        {
+            Preconditions.CheckArgument(nativePtr != 0);
+            Preconditions.CheckArgument(size > 0);
+            _size = size;
+            _nativePtr = nativePtr;
+            _closed = false;
+        }
+
         /// <summary>
         /// Instantiates the <see cref="NativeMemoryChunk"/>.
         /// </summary>
@@ -86,11 +104,32 @@ namespace ImagePipeline.Memory
                     }
 
                     _closed = true;
-                    NativeMethods.nativeFree(_nativePtr);
+                    FreeNativeMemory(_nativePtr);
                 }
             }
         }
 
+        /// <summary>
+        /// Releases the memory of the chunk, called once when closed.
+        /// </summary>
+        /// <param name="nativePtr">Address of the memory.</param>
+        protected virtual void FreeNativeMemory(long nativePtr)
+        {
+            NativeMethods.nativeFree(nativePtr);
+        }
+
+        /// <summary>
+        /// Whether the memory of this chunk can only be read, in which
+        /// case it can't be written to or copied to.
+        /// </summary>
+        public virtual bool IsReadOnly
+        {
+            get
+            {
+                return false;
+            }
+        }
+
         /// <summary>
         /// Is this chunk already closed (aka freed)?
         /// </summary>
@@ -174,13 +213,204 @@ namespace ImagePipeline.Memory
                 Preconditions.CheckState(!Closed);
                 int actualCount = AdjustByteCount(nativeMemoryOffset, count);
                 CheckBounds(nativeMemoryOffset, byteArray.Length, byteArrayOffset, actualCount);
-                NativeMethods.nativeCopyToByteArray(
+                CopyToByteArray(
                     _nativePtr + nativeMemoryOffset, byteArray, byteArrayOffset, actualCount);
 
                 return actualCount;
             }
         }
 
+        /// <summary>
+        /// Copy bytes from native memory to another native buffer,
+        /// such as a pinned array or a software bitmap.
+        /// </summary>
+        /// <param name="nativeMemoryOffset">
+        /// Number of first byte to copy.
+        /// </param>
+        /// <param name="dstPtr">
+        /// Address to copy to, valid for count bytes.
+        /// </param>
+        /// <param name="count">
+        /// Number of bytes to copy.
+        /// </param>
+        /// <returns>Number of bytes read.</returns>
+        public virtual int Read(int nativeMemoryOffset, long dstPtr, int count)
+        {
+            lock (_memoryChunkGate)
+            {
+                Preconditions.CheckArgument(dstPtr != 0);
+                Preconditions.CheckState(!Closed);
+                int actualCount = AdjustByteCount(nativeMemoryOffset, count);
+                CheckBounds(nativeMemoryOffset, actualCount, 0, actualCount);
+                CopyToNative(dstPtr, _nativePtr + nativeMemoryOffset, actualCount);
+                return actualCount;
+            }
+        }
+
+        /// <summary>
+        /// Compares bytes of native memory with bytes of a byte array.
+        /// </summary>
+        /// <param name="nativeMemoryOffset">
+        /// Number of first byte to compare.
+        /// </param>
+        /// <param name="byteArray">Byte array to compare with.</param>
+        /// <param name="byteArrayOffset">
+        /// Number of first byte in byteArray to compare.
+        /// </param>
+        /// <param name="count">Number of bytes to compare.</param>
+        /// <returns>
+        /// 0 if the bytes are equal, otherwise a negative or positive
+        /// value if the first differing byte is lower or higher in
+        /// native memory.
+        /// </returns>
+        public virtual int Compare(
+            int nativeMemoryOffset,
+            byte[] byteArray,
+            int byteArrayOffset,
+            int count)
+        {
+            lock (_memoryChunkGate)
+            {
+                Preconditions.CheckNotNull(byteArray);
+                Preconditions.CheckState(!Closed);
+                CheckBounds(nativeMemoryOffset, byteArray.Length, byteArrayOffset, count);
+                return NativeMethods.nativeCompare(
+                    _nativePtr + nativeMemoryOffset, byteArray, byteArrayOffset, count);
+            }
+        }
+
+        /// <summary>
+        /// Searches native memory for a byte.
+        /// </summary>
+        /// <param name="nativeMemoryOffset">
+        /// Number of first byte to search.
+        /// </param>
+        /// <param name="count">Number of bytes to search.</param>
+        /// <param name="value">The byte to find.</param>
+        /// <returns>
+        /// Offset of the first byte equal to value, or -1 if there
+        /// is none.
+        /// </returns>
+        public virtual int IndexOf(int nativeMemoryOffset, int count, byte value)
+        {
+            lock (_memoryChunkGate)
+            {
+                Preconditions.CheckState(!Closed);
+                CheckBounds(nativeMemoryOffset, count, 0, count);
+                int index = NativeMethods.nativeIndexOf(
+                    _nativePtr + nativeMemoryOffset, count, value);
+
+                return index < 0 ? -1 : nativeMemoryOffset + index;
+            }
+        }
+
+        /// <summary>
+        /// Searches native memory for a sequence of bytes.
+        /// </summary>
+        /// <param name="nativeMemoryOffset">
+        /// Number of first byte to search.
+        /// </param>
+        /// <param name="count">Number of bytes to search.</param>
+        /// <param name="pattern">The bytes to find.</param>
+        /// <returns>
+        /// Offset of the first occurrence of pattern, or -1 if there
+        /// is none.
+        /// </returns>
+        public virtual int IndexOf(int nativeMemoryOffset, int count, byte[] pattern)
+        {
+            lock (_memoryChunkGate)
+            {
+                Preconditions.CheckNotNull(pattern);
+                Preconditions.CheckState(!Closed);
+                CheckBounds(nativeMemoryOffset, count, 0, count);
+                int index = NativeMethods.nativeIndexOfSequence(
+                    _nativePtr + nativeMemoryOffset, count, pattern, pattern.Length);
+
+                return index < 0 ? -1 : nativeMemoryOffset + index;
+            }
+        }
+
+        /// <summary>
+        /// Copies ranges of several chunks back to back into a byte
+        /// array, in a single native call.
+        /// </summary>
+        /// <param name="chunks">The chunk of each range.</param>
+        /// <param name="offsets">The start of each range.</param>
+        /// <param name="counts">The length of each range.</param>
+        /// <param name="byteArray">Byte array to copy to.</param>
+        /// <param name="byteArrayOffset">
+        /// Number of first byte in byteArray to be written.
+        /// </param>
+        /// <returns>Number of bytes copied.</returns>
+        public static int Gather(
+            NativeMemoryChunk[] chunks,
+            int[] offsets,
+            int[] counts,
+            byte[] byteArray,
+            int byteArrayOffset)
+        {
+            Preconditions.CheckNotNull(byteArray);
+            List<NativeMemoryChunk> locked = LockChunks(chunks, offsets, counts);
+            try
+            {
+                long[] sources = GetRangePointers(chunks, offsets);
+                int total = GetTotalCount(counts);
+                Preconditions.CheckArgument(byteArrayOffset >= 0);
+                Preconditions.CheckArgument(byteArrayOffset <= byteArray.Length - total);
+                NativeMethods.nativeGatherCopy(
+                    sources, counts, chunks.Length, byteArray, byteArrayOffset);
+
+                return total;
+            }
+            finally
+            {
+                UnlockChunks(locked);
+            }
+        }
+
+        /// <summary>
+        /// Copies consecutive bytes of a byte array to ranges of several
+        /// chunks, in a single native call.
+        /// </summary>
+        /// <param name="byteArray">Byte array to copy from.</param>
+        /// <param name="byteArrayOffset">
+        /// Number of first byte in byteArray to copy.
+        /// </param>
+        /// <param name="chunks">The chunk of each range.</param>
+        /// <param name="offsets">The start of each range.</param>
+        /// <param name="counts">The length of each range.</param>
+        /// <returns>Number of bytes copied.</returns>
+        public static int Scatter(
+            byte[] byteArray,
+            int byteArrayOffset,
+            NativeMemoryChunk[] chunks,
+            int[] offsets,
+            int[] counts)
+        {
+            Preconditions.CheckNotNull(byteArray);
+            List<NativeMemoryChunk> locked = LockChunks(chunks, offsets, counts);
+            try
+            {
+                foreach (NativeMemoryChunk chunk in chunks)
+                {
+                    Preconditions.CheckState(!chunk.IsReadOnly);
+                }
+
+                long[] destinations = GetRangePointers(chunks, offsets);
+                int total = GetTotalCount(counts);
+                Preconditions.CheckArgument(byteArrayOffset >= 0);
+                Preconditions.CheckArgument(byteArrayOffset <= byteArray.Length - total);
+                NativeMethods.nativeScatterCopy(
+                    destinations, counts, chunks.Length, byteArray, byteArrayOffset);
+
+                return total;
+            }
+            finally
+            {
+                UnlockChunks(locked);
+            }
+        }
+
         /// <summary>
         /// Read byte at given offset.
         /// </summary>
@@ -275,9 +505,120 @@ namespace ImagePipeline.Memory
         {
             Preconditions.CheckState(!Closed);
             Preconditions.CheckState(!other.Closed);
+            Preconditions.CheckState(!other.IsReadOnly);
             CheckBounds(offset, other.Size, otherOffset, count);
-            NativeMethods.nativeMemcpy(
-                other._nativePtr + otherOffset, _nativePtr + offset, count);
+            CopyToNative(other._nativePtr + otherOffset, _nativePtr + offset, count);
+        }
+
+        /// <summary>
+        /// Copies bytes of this chunk to native memory. Called with the
+        /// lock of the chunk held, after the bounds were checked.
+        /// </summary>
+        /// <param name="dstPtr">Address to copy to.</param>
+        /// <param name="srcPtr">Address within this chunk to copy from.</param>
+        /// <param name="count">Number of bytes to copy.</param>
+        protected virtual void CopyToNative(long dstPtr, long srcPtr, int count)
+        {
+            NativeMethods.nativeMemcpy(dstPtr, srcPtr, count);
+        }
+
+        /// <summary>
+        /// Copies bytes of this chunk to a byte array. Called with the
+        /// lock of the chunk held, after the bounds were checked.
+        /// </summary>
+        /// <param name="srcPtr">Address within this chunk to copy from.</param>
+        /// <param name="byteArray">Byte array to copy to.</param>
+        /// <param name="byteArrayOffset">
+        /// Number of first byte in byte array to be written.
+        /// </param>
+        /// <param name="count">Number of bytes to copy.</param>
+        protected virtual void CopyToByteArray(
+            long srcPtr,
+            byte[] byteArray,
+            int byteArrayOffset,
+            int count)
+        {
+            NativeMethods.nativeCopyToByteArray(srcPtr, byteArray, byteArrayOffset, count);
+        }
+
+        /// <summary>
+        /// Acquires the locks of the distinct chunks in address order,
+        /// like <see cref="Copy"/> does, then checks the ranges.
+        /// </summary>
+        private static List<NativeMemoryChunk> LockChunks(
+            NativeMemoryChunk[] chunks,
+            int[] offsets,
+            int[] counts)
+        {
+            Preconditions.CheckNotNull(chunks);
+            Preconditions.CheckNotNull(offsets);
+            Preconditions.CheckNotNull(counts);
+            Preconditions.CheckArgument(chunks.Length == offsets.Length);
+            Preconditions.CheckArgument(chunks.Length == counts.Length);
+
+            List<NativeMemoryChunk> locked = new List<NativeMemoryChunk>(chunks.Length);
+            foreach (NativeMemoryChunk chunk in chunks)
+            {
+                Preconditions.CheckNotNull(chunk);
+                if (!locked.Contains(chunk))
+                {
+                    locked.Add(chunk);
+                }
+            }
+
+            locked.Sort((a, b) => a._nativePtr.CompareTo(b._nativePtr));
+            int lockCount = 0;
+            try
+            {
+                for (; lockCount < locked.Count; ++lockCount)
+                {
+                    Monitor.Enter(locked[lockCount]._memoryChunkGate);
+                }
+
+                for (int i = 0; i < chunks.Length; ++i)
+                {
+                    Preconditions.CheckState(!chunks[i].Closed);
+                    chunks[i].CheckBounds(offsets[i], counts[i], 0, counts[i]);
+                }
+            }
+            catch
+            {
+                UnlockChunks(locked.GetRange(0, lockCount));
+                throw;
+            }
+
+            return locked;
+        }
+
+        private static void UnlockChunks(List<NativeMemoryChunk> locked)
+        {
+            for (int i = locked.Count - 1; i >= 0; --i)
+            {
+                Monitor.Exit(locked[i]._memoryChunkGate);
+            }
+        }
+
+        private static long[] GetRangePointers(NativeMemoryChunk[] chunks, int[] offsets)
+        {
+            long[] pointers = new long[chunks.Length];
+            for (int i = 0; i < chunks.Length; ++i)
+            {
+                pointers[i] = chunks[i]._nativePtr + offsets[i];
+            }
+
+            return pointers;
+        }
+
+        private static int GetTotalCount(int[] counts)
+        {
+            long total = 0;
+            foreach (int count in counts)
+            {
+                total += count;
+            }
+
+            Preconditions.CheckArgument(total <= int.MaxValue);
+            return (int)total;
         }
 
         /// <summary>
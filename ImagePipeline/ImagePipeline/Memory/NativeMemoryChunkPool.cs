@@ -48,6 +48,33 @@ namespace ImagePipeline.Memory
             return _bucketSizes[0];
         }
 
+        /// <summary>
+        /// Gets the largest size supported by the pool, bigger chunks
+        /// are allocated and freed without being pooled.
+        /// </summary>
+        /// <returns>
+        /// The largest size supported by the pool.
+        /// </returns>
+        public int GetMaxBufferSize()
+        {
+            return _bucketSizes[_bucketSizes.Length - 1];
+        }
+
+        /// <summary>
+        /// Clears out the pool, then returns the memory the native
+        /// allocator no longer uses to the OS, along with the free
+        /// pixel buffers.
+        /// </summary>
+        /// <param name="memoryTrimType">
+        /// The kind of trimming we want to perform.
+        /// </param>
+        public override void Trim(double memoryTrimType)
+        {
+            base.Trim(memoryTrimType);
+            NativeAllocator.Trim();
+            PixelBufferPool.Trim();
+        }
+
         /// <summary>
         /// Allocate a native memory chunk larger than or equal to
         /// the specified size.
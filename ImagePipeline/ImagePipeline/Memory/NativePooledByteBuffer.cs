@@ -11,6 +11,7 @@ namespace ImagePipeline.Memory
     public sealed class NativePooledByteBuffer : IPooledByteBuffer
     {
         private readonly object _poolGate = new object();
+        private readonly int _offset;
         private readonly int _size;
 
         internal CloseableReference<NativeMemoryChunk> _bufRef;
@@ -18,11 +19,25 @@ namespace ImagePipeline.Memory
         /// <summary>
         /// Instantiates the <see cref="NativePooledByteBuffer"/>.
         /// </summary>
-        public NativePooledByteBuffer(CloseableReference<NativeMemoryChunk> bufRef, int size)
+        public NativePooledByteBuffer(CloseableReference<NativeMemoryChunk> bufRef, int size) :
+            this(bufRef, 0, size)
+        {
+        }
+
+        /// <summary>
+        /// Instantiates the <see cref="NativePooledByteBuffer"/> over
+        /// size bytes of the chunk, starting at offset.
+        /// </summary>
+        public NativePooledByteBuffer(
+            CloseableReference<NativeMemoryChunk> bufRef,
+            int offset,
+            int size)
         {
             Preconditions.CheckNotNull(bufRef);
-            Preconditions.CheckArgument(size >= 0 && size <= bufRef.Get().Size);
+            Preconditions.CheckArgument(offset >= 0 && size >= 0);
+            Preconditions.CheckArgument(offset <= bufRef.Get().Size - size);
             _bufRef = bufRef.Clone();
+            _offset = offset;
             _size = size;
         }
 
@@ -55,7 +70,7 @@ namespace ImagePipeline.Memory
                 EnsureValid();
                 Preconditions.CheckArgument(offset >= 0);
                 Preconditions.CheckArgument(offset < _size);
-                return _bufRef.Get().Read(offset);
+                return _bufRef.Get().Read(_offset + offset);
             }
         }
 
@@ -72,8 +87,9 @@ namespace ImagePipeline.Memory
                 // is preserved.
                 // Al the other bounds checks will be performed by 
                 // NativeMemoryChunk.Read method.
+                Preconditions.CheckArgument(offset >= 0);
                 Preconditions.CheckArgument(offset + length <= _size);
-                _bufRef.Get().Read(offset, buffer, bufferOffset, length);
+                _bufRef.Get().Read(_offset + offset, buffer, bufferOffset, length);
             }
         }
 
@@ -85,7 +101,26 @@ namespace ImagePipeline.Memory
             lock (_poolGate)
             {
                 EnsureValid();
-                return _bufRef.Get().GetNativePtr();
+                return _bufRef.Get().GetNativePtr() + _offset;
+            }
+        }
+
+        /// <summary>
+        /// Creates a buffer over part of this one without copying. The
+        /// slice shares the underlying chunk, which goes back to the pool
+        /// once both buffers are closed.
+        /// </summary>
+        /// <param name="offset">Start of the slice in this buffer.</param>
+        /// <param name="length">Length of the slice.</param>
+        /// <returns>The slice, to be closed by the caller.</returns>
+        public NativePooledByteBuffer Slice(int offset, int length)
+        {
+            lock (_poolGate)
+            {
+                EnsureValid();
+                Preconditions.CheckArgument(offset >= 0 && length >= 0);
+                Preconditions.CheckArgument(offset <= _size - length);
+                return new NativePooledByteBuffer(_bufRef, _offset + offset, length);
             }
         }
 
@@ -28,6 +28,17 @@ namespace ImagePipeline.Memory
             _pooledByteStreams = pooledByteStreams;
         }
 
+        /// <summary>
+        /// Gets the native memory pool backing the created buffers.
+        /// </summary>
+        internal NativeMemoryChunkPool Pool
+        {
+            get
+            {
+                return _pool;
+            }
+        }
+
         /// <summary>
         /// Creates a new IPooledByteBuffer instance of given size.
         /// </summary>
@@ -0,0 +1,30 @@
+﻿using ImagePipeline.NativeCode;
+
+namespace ImagePipeline.Memory
+{
+    /// <summary>
+    /// Pool of the native pixel buffers that images are decoded into
+    /// while being transcoded or resized.
+    ///
+    /// <para />Buffers freed by an image are kept for the next one, up
+    /// to 32 MB. Larger buffers are released right away.
+    /// </summary>
+    public static class PixelBufferPool
+    {
+        /// <summary>
+        /// Releases the free buffers kept for reuse.
+        /// </summary>
+        public static void Trim()
+        {
+            NativeMethods.nativeTrimPixelBufferPool();
+        }
+
+        /// <summary>
+        /// Gets the bytes of free buffers kept for reuse.
+        /// </summary>
+        public static long GetFreeBytes()
+        {
+            return NativeMethods.nativeGetPixelBufferPoolFreeBytes();
+        }
+    }
+}
@@ -0,0 +1,90 @@
+﻿using FBCore.Common.Internal;
+using FBCore.Common.References;
+using FBCore.Common.Util;
+using ImageFormatUtils;
+using ImagePipeline.Image;
+using ImagePipeline.Memory;
+using ImageUtils;
+using System.Runtime.InteropServices;
+
+namespace ImagePipeline.NativeCode
+{
+    /// <summary>
+    /// Matches ParsedExifThumbnail in ImageMetaDataParser.h.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeExifThumbnail
+    {
+        public int Offset;
+        public int Length;
+        public int Width;
+        public int Height;
+        public int Orientation;
+    }
+
+    /// <summary>
+    /// Finds the jpeg thumbnail embedded in the EXIF data of a jpeg and
+    /// exposes it in place, without decoding or copying the image.
+    ///
+    /// <para />The EXIF data precedes the frame and is at most 64 KB, so
+    /// the first <see cref="EXIF_SEARCH_LENGTH"/> bytes of a local file or
+    /// of a download are enough.
+    /// </summary>
+    public static class ExifThumbnailExtractor
+    {
+        /// <summary>
+        /// Number of leading bytes that hold the EXIF data of a jpeg.
+        /// </summary>
+        public const int EXIF_SEARCH_LENGTH = 64 * ByteConstants.KB;
+
+        /// <summary>
+        /// Gets the EXIF thumbnail of the jpeg held by buffer.
+        /// </summary>
+        /// <param name="buffer">
+        /// The beginning of a jpeg, or all of it.
+        /// </param>
+        /// <returns>
+        /// The thumbnail sharing the memory of buffer, with its format,
+        /// dimensions and rotation set, or null if buffer is not in
+        /// native memory or has no thumbnail. To be closed by the caller.
+        /// </returns>
+        public static EncodedImage GetThumbnail(IPooledByteBuffer buffer)
+        {
+            Preconditions.CheckNotNull(buffer);
+            NativePooledByteBuffer nativeBuffer = buffer as NativePooledByteBuffer;
+            if (nativeBuffer == null)
+            {
+                return null;
+            }
+
+            NativeExifThumbnail thumbnail = default(NativeExifThumbnail);
+            if (NativeMethods.nativeFindExifThumbnail(
+                nativeBuffer.GetNativePtr(),
+                nativeBuffer.Size,
+                ref thumbnail) == 0)
+            {
+                return null;
+            }
+
+            CloseableReference<IPooledByteBuffer> thumbnailRef =
+                CloseableReference<IPooledByteBuffer>.of(
+                    nativeBuffer.Slice(thumbnail.Offset, thumbnail.Length));
+
+            try
+            {
+                EncodedImage encodedImage = new EncodedImage(thumbnailRef);
+                encodedImage.Format = ImageFormat.JPEG;
+                encodedImage.Width = thumbnail.Width;
+                encodedImage.Height = thumbnail.Height;
+                encodedImage.RotationAngle =
+                    JfifUtil.GetAutoRotateAngleFromOrientation(thumbnail.Orientation);
+
+                return encodedImage;
+            }
+            finally
+            {
+                CloseableReference<IPooledByteBuffer>.CloseSafely(thumbnailRef);
+            }
+        }
+    }
+}
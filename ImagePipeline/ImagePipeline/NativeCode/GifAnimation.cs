@@ -0,0 +1,202 @@
+﻿using FBCore.Common.Internal;
+using System;
+
+namespace ImagePipeline.NativeCode
+{
+    /// <summary>
+    /// Animated gif rendered frame by frame in native code.
+    ///
+    /// <para />Frames are decoded on demand, composited over the ones
+    /// before them. Every keyframeInterval frames a snapshot of the
+    /// canvas goes to a cache bounded by bytes, rendering a frame
+    /// replays at most keyframeInterval frames from the closest
+    /// snapshot instead of starting over from the first frame.
+    /// </summary>
+    public sealed class GifAnimation : IDisposable
+    {
+        private readonly object _gate = new object();
+        private readonly int _width;
+        private readonly int _height;
+        private readonly int _frameCount;
+        private readonly int _loopCount;
+        private readonly int _sizeInBytes;
+
+        private long _animation;
+
+        /// <summary>
+        /// Parses the gif held in native memory. The bytes are copied, the
+        /// memory may be released once this returns.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="cacheCapacity">
+        /// Size in bytes of the keyframe cache, 0 to replay from the first
+        /// frame when going back.
+        /// </param>
+        /// <param name="keyframeInterval">
+        /// Number of frames between two snapshots, 0 to never take one.
+        /// </param>
+        /// <exception cref="System.Runtime.InteropServices.SEHException">
+        /// If the bytes are not a gif with at least one complete frame.
+        /// </exception>
+        public GifAnimation(
+            long srcPtr,
+            int srcLength,
+            int cacheCapacity,
+            int keyframeInterval)
+        {
+            Preconditions.CheckArgument(srcPtr != 0);
+            Preconditions.CheckArgument(srcLength > 0);
+            Preconditions.CheckArgument(cacheCapacity >= 0);
+            Preconditions.CheckArgument(keyframeInterval >= 0);
+
+            _animation = NativeMethods.nativeCreateGifAnimation(
+                srcPtr, srcLength, cacheCapacity, keyframeInterval);
+
+            NativeMethods.nativeGetGifInfo(
+                _animation, out _width, out _height, out _frameCount, out _loopCount);
+
+            _sizeInBytes = (int)Math.Min(
+                NativeMethods.nativeGetGifMemorySize(_animation), int.MaxValue);
+        }
+
+        /// <summary>
+        /// Width of the canvas.
+        /// </summary>
+        public int Width
+        {
+            get
+            {
+                return _width;
+            }
+        }
+
+        /// <summary>
+        /// Height of the canvas.
+        /// </summary>
+        public int Height
+        {
+            get
+            {
+                return _height;
+            }
+        }
+
+        /// <summary>
+        /// Number of complete frames.
+        /// </summary>
+        public int FrameCount
+        {
+            get
+            {
+                return _frameCount;
+            }
+        }
+
+        /// <summary>
+        /// Number of times the animation repeats, 0 to repeat forever and
+        /// -1 to play it once.
+        /// </summary>
+        public int LoopCount
+        {
+            get
+            {
+                return _loopCount;
+            }
+        }
+
+        /// <summary>
+        /// Upper bound of the native memory held, the copy of the encoded
+        /// bytes, the canvas, the copy of it kept for frames restoring the
+        /// previous one, the color indices and the keyframe cache.
+        /// </summary>
+        public int SizeInBytes
+        {
+            get
+            {
+                return _sizeInBytes;
+            }
+        }
+
+        /// <summary>
+        /// Number of frames decoded since the animation was created, to
+        /// measure how much work rendering takes.
+        /// </summary>
+        public int DecodedFrameCount
+        {
+            get
+            {
+                lock (_gate)
+                {
+                    CheckNotReleased();
+                    return NativeMethods.nativeGetGifDecodedFrameCount(_animation);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Returns how long given frame is shown, in milliseconds.
+        /// </summary>
+        public int GetFrameDurationMs(int index)
+        {
+            Preconditions.CheckElementIndex(index, _frameCount);
+            lock (_gate)
+            {
+                CheckNotReleased();
+                return NativeMethods.nativeGetGifFrameDuration(_animation, index);
+            }
+        }
+
+        /// <summary>
+        /// Renders given frame as displayed, the whole canvas, into caller
+        /// provided native memory.
+        /// </summary>
+        /// <param name="index">Index of the frame.</param>
+        /// <param name="pixelFormat">
+        /// Format of the rendered pixels, converted as the rows are
+        /// copied out of the canvas.
+        /// </param>
+        /// <param name="dstPtr">Pointer to the destination buffer.</param>
+        /// <param name="stride">Distance in bytes between two rows.</param>
+        /// <param name="dstCapacity">Size of the destination buffer.</param>
+        public void RenderFrame(
+            int index,
+            NativePixelFormat pixelFormat,
+            long dstPtr,
+            int stride,
+            int dstCapacity)
+        {
+            Preconditions.CheckElementIndex(index, _frameCount);
+            Preconditions.CheckArgument(dstPtr != 0);
+            Preconditions.CheckArgument(
+                stride >= _width * JpegDecoder.GetBytesPerPixel(pixelFormat));
+            Preconditions.CheckArgument(dstCapacity > 0);
+            lock (_gate)
+            {
+                CheckNotReleased();
+                NativeMethods.nativeRenderGifFrame(
+                    _animation, index, (int)pixelFormat, dstPtr, stride, dstCapacity);
+            }
+        }
+
+        /// <summary>
+        /// Releases the native animation.
+        /// </summary>
+        public void Dispose()
+        {
+            lock (_gate)
+            {
+                if (_animation != 0)
+                {
+                    NativeMethods.nativeReleaseGifAnimation(_animation);
+                    _animation = 0;
+                }
+            }
+        }
+
+        private void CheckNotReleased()
+        {
+            Preconditions.CheckState(_animation != 0, "animation was released");
+        }
+    }
+}
@@ -0,0 +1,167 @@
+﻿using FBCore.Common.Internal;
+using ImagePipeline.Common;
+
+namespace ImagePipeline.NativeCode
+{
+    /// <summary>
+    /// Helper methods for decoding jpeg images in native code.
+    /// </summary>
+    public class JpegDecoder
+    {
+        /// <summary>
+        /// Returns the number of bytes taken by one pixel of given format.
+        /// </summary>
+        public static int GetBytesPerPixel(NativePixelFormat pixelFormat)
+        {
+            switch (pixelFormat)
+            {
+                case NativePixelFormat.RGBA:
+                case NativePixelFormat.BGRA:
+                case NativePixelFormat.BGRA_PREMULTIPLIED:
+                    return 4;
+
+                case NativePixelFormat.RGB565:
+                case NativePixelFormat.GRAY_ALPHA:
+                    return 2;
+
+                case NativePixelFormat.GRAY:
+                    return 1;
+
+                default:
+                    return 3;
+            }
+        }
+
+#if HAS_LIBJPEGTURBO
+        /// <summary>
+        /// Reads jpeg header held in native memory and computes the
+        /// dimensions of the image decoded with the given scale and crop.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="scaleNumerator">
+        /// 1 - 16, image will be scaled using scaleNumerator/8 factor.
+        /// </param>
+        /// <param name="cropOptions">
+        /// Region of the encoded image to decode, null to decode all of it.
+        /// </param>
+        /// <param name="width">Receives decoded width.</param>
+        /// <param name="height">Receives decoded height.</param>
+        public static void GetDecodeSize(
+            long srcPtr,
+            int srcLength,
+            int scaleNumerator,
+            CropOptions cropOptions,
+            out int width,
+            out int height)
+        {
+            Preconditions.CheckArgument(srcPtr != 0);
+            Preconditions.CheckArgument(srcLength > 0);
+            Preconditions.CheckArgument(scaleNumerator >= JpegTranscoder.MIN_SCALE_NUMERATOR);
+            Preconditions.CheckArgument(scaleNumerator <= JpegTranscoder.MAX_SCALE_NUMERATOR);
+
+            NativeMethods.nativeGetJpegDecodeSize(
+                srcPtr,
+                srcLength,
+                scaleNumerator,
+                JpegTranscoder.GetCropX(cropOptions),
+                JpegTranscoder.GetCropY(cropOptions),
+                JpegTranscoder.GetCropWidth(cropOptions),
+                JpegTranscoder.GetCropHeight(cropOptions),
+                out width,
+                out height);
+        }
+
+        /// <summary>
+        /// Decodes jpeg image held in native memory into caller provided
+        /// native memory.
+        ///
+        /// <para />Rows are written in place, row y starts at
+        /// dstPtr + y * stride, so the destination may be a pooled buffer
+        /// with padded rows. The call does not touch managed state and
+        /// may run on any worker thread.
+        ///
+        /// <para />With crop options only the MCU rows and columns
+        /// intersecting the region are decoded.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="scaleNumerator">
+        /// 1 - 16, image will be scaled using scaleNumerator/8 factor.
+        /// </param>
+        /// <param name="cropOptions">
+        /// Region of the encoded image to decode, null to decode all of it.
+        /// </param>
+        /// <param name="pixelFormat">Format of decoded pixels.</param>
+        /// <param name="dstPtr">Pointer to the destination buffer.</param>
+        /// <param name="stride">Distance in bytes between two rows.</param>
+        /// <param name="dstCapacity">Size of the destination buffer.</param>
+        public static void DecodeJpeg(
+            long srcPtr,
+            int srcLength,
+            int scaleNumerator,
+            CropOptions cropOptions,
+            NativePixelFormat pixelFormat,
+            long dstPtr,
+            int stride,
+            int dstCapacity)
+        {
+            Preconditions.CheckArgument(srcPtr != 0);
+            Preconditions.CheckArgument(srcLength > 0);
+            Preconditions.CheckArgument(scaleNumerator >= JpegTranscoder.MIN_SCALE_NUMERATOR);
+            Preconditions.CheckArgument(scaleNumerator <= JpegTranscoder.MAX_SCALE_NUMERATOR);
+            Preconditions.CheckArgument(dstPtr != 0);
+            Preconditions.CheckArgument(stride > 0);
+            Preconditions.CheckArgument(dstCapacity > 0);
+
+            NativeMethods.nativeDecodeJpeg(
+                srcPtr,
+                srcLength,
+                scaleNumerator,
+                JpegTranscoder.GetCropX(cropOptions),
+                JpegTranscoder.GetCropY(cropOptions),
+                JpegTranscoder.GetCropWidth(cropOptions),
+                JpegTranscoder.GetCropHeight(cropOptions),
+                (int)pixelFormat,
+                dstPtr,
+                stride,
+                dstCapacity);
+        }
+
+        /// <summary>
+        /// Sets the maximum number of threads decoding a single image.
+        ///
+        /// <para />Large baseline jpegs with restart markers held in
+        /// memory are split into horizontal bands decoded in parallel,
+        /// by <see cref="DecodeJpeg"/> and by resizing transcodes. Other
+        /// images are always decoded on the calling thread.
+        /// </summary>
+        /// <param name="threads">
+        /// 1 to decode serially, 0 to use all hardware threads.
+        /// </param>
+        public static void SetMaxDecodeThreads(int threads)
+        {
+            Preconditions.CheckArgument(threads >= 0);
+            NativeMethods.nativeSetJpegDecodeThreads(threads);
+        }
+
+        /// <summary>
+        /// Returns the number of threads a single image may be decoded on.
+        /// </summary>
+        public static int GetDecodeThreadCount()
+        {
+            return NativeMethods.nativeGetJpegDecodeThreads();
+        }
+
+        /// <summary>
+        /// Returns the number of bands <see cref="DecodeJpeg"/> splits the
+        /// jpeg into with the current thread limit, 1 if it decodes the
+        /// jpeg serially.
+        /// </summary>
+        internal static int GetRestartBandCount(long srcPtr, int srcLength)
+        {
+            return NativeMethods.nativeGetJpegRestartBandCount(srcPtr, srcLength);
+        }
+#endif // HAS_LIBJPEGTURBO
+    }
+}
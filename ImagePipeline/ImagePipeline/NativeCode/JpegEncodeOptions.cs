@@ -0,0 +1,253 @@
+﻿using FBCore.Common.Internal;
+using FBCore.Common.Util;
+
+namespace ImagePipeline.NativeCode
+{
+    /// <summary>
+    /// Parameters of the jpeg encoder used when transcoding.
+    ///
+    /// <para />Matches EncodeOptions in jpeg_encode_options.h. Lossless
+    /// transformations, i.e. rotation and crop without scaling, only apply
+    /// Huffman optimization, progressive scans and restart markers.
+    /// </summary>
+    public class JpegEncodeOptions
+    {
+        /// <summary>
+        /// Upper bound of <see cref="RestartRows"/>.
+        /// </summary>
+        public const int MAX_RESTART_ROWS = 65535;
+
+        /// <summary>
+        /// Quality passed to the encoder, 1 - 100.
+        /// </summary>
+        public int Quality { get; }
+
+        /// <summary>
+        /// Whether Huffman tables are optimized for the image.
+        ///
+        /// <para />Takes a second pass over the coefficients but leaves
+        /// the pixels untouched.
+        /// </summary>
+        public bool OptimizeCoding { get; }
+
+        /// <summary>
+        /// Whether the image is encoded with progressive scans.
+        /// </summary>
+        public bool Progressive { get; }
+
+        /// <summary>
+        /// Chroma subsampling of the encoded image.
+        /// </summary>
+        public JpegSubsampling Subsampling { get; }
+
+        /// <summary>
+        /// Forward DCT used by the encoder.
+        /// </summary>
+        public JpegDctMethod DctMethod { get; }
+
+        /// <summary>
+        /// Number of MCU rows between restart markers, 0 for none.
+        ///
+        /// <para />Large baseline images with restart markers are decoded
+        /// on several threads.
+        /// </summary>
+        public int RestartRows { get; }
+
+        /// <summary>
+        /// Instantiates the <see cref="JpegEncodeOptions"/> matching the
+        /// defaults of libjpeg: baseline, 4:2:0 and the accurate integer DCT.
+        /// </summary>
+        public JpegEncodeOptions(int quality) : this(
+            quality,
+            false,
+            false,
+            JpegSubsampling.YUV_420,
+            JpegDctMethod.ISLOW)
+        {
+        }
+
+        /// <summary>
+        /// Instantiates the <see cref="JpegEncodeOptions"/> without restart
+        /// markers.
+        /// </summary>
+        public JpegEncodeOptions(
+            int quality,
+            bool optimizeCoding,
+            bool progressive,
+            JpegSubsampling subsampling,
+            JpegDctMethod dctMethod) : this(
+                quality,
+                optimizeCoding,
+                progressive,
+                subsampling,
+                dctMethod,
+                0)
+        {
+        }
+
+        /// <summary>
+        /// Instantiates the <see cref="JpegEncodeOptions"/>.
+        /// </summary>
+        public JpegEncodeOptions(
+            int quality,
+            bool optimizeCoding,
+            bool progressive,
+            JpegSubsampling subsampling,
+            JpegDctMethod dctMethod,
+            int restartRows)
+        {
+            Preconditions.CheckArgument(quality >= JpegTranscoder.MIN_QUALITY);
+            Preconditions.CheckArgument(quality <= JpegTranscoder.MAX_QUALITY);
+            Preconditions.CheckArgument(restartRows >= 0);
+            Preconditions.CheckArgument(restartRows <= MAX_RESTART_ROWS);
+            Quality = quality;
+            OptimizeCoding = optimizeCoding;
+            Progressive = progressive;
+            Subsampling = subsampling;
+            DctMethod = dctMethod;
+            RestartRows = restartRows;
+        }
+
+        /// <summary>
+        /// Creates the options of given preset encoding with given quality.
+        /// </summary>
+        public static JpegEncodeOptions FromPreset(JpegEncodePreset preset, int quality)
+        {
+            switch (preset)
+            {
+                case JpegEncodePreset.FASTEST:
+                    return new JpegEncodeOptions(
+                        quality, false, false, JpegSubsampling.YUV_420, JpegDctMethod.IFAST);
+
+                case JpegEncodePreset.BALANCED:
+                    return new JpegEncodeOptions(
+                        quality, true, false, JpegSubsampling.YUV_420, JpegDctMethod.ISLOW);
+
+                case JpegEncodePreset.SMALLEST:
+                    return new JpegEncodeOptions(
+                        quality, true, true, JpegSubsampling.YUV_420, JpegDctMethod.ISLOW);
+
+                default:
+                    throw new System.ArgumentException("Unknown preset: " + preset);
+            }
+        }
+
+        /// <summary>
+        /// Calculates the hash code basing on the options.
+        /// </summary>
+        public override int GetHashCode()
+        {
+            return HashCodeUtil.HashCode(
+                Quality,
+                OptimizeCoding,
+                Progressive,
+                Subsampling,
+                DctMethod,
+                RestartRows);
+        }
+
+        /// <summary>
+        /// Compares with other JpegEncodeOptions objects.
+        /// </summary>
+        public override bool Equals(object other)
+        {
+            if (other == this)
+            {
+                return true;
+            }
+
+            if (other == null || other.GetType() != typeof(JpegEncodeOptions))
+            {
+                return false;
+            }
+
+            JpegEncodeOptions that = (JpegEncodeOptions)other;
+            return Quality == that.Quality &&
+                OptimizeCoding == that.OptimizeCoding &&
+                Progressive == that.Progressive &&
+                Subsampling == that.Subsampling &&
+                DctMethod == that.DctMethod &&
+                RestartRows == that.RestartRows;
+        }
+
+        /// <summary>
+        /// Provides the custom ToString method.
+        /// </summary>
+        public override string ToString()
+        {
+            return string.Format(
+                "q{0} {1} {2}{3} {4}{5}",
+                Quality,
+                Subsampling,
+                DctMethod,
+                OptimizeCoding ? " optimized" : "",
+                Progressive ? "progressive" : "baseline",
+                RestartRows > 0 ? " restart " + RestartRows : "");
+        }
+    }
+
+    /// <summary>
+    /// Chroma subsampling of encoded images.
+    ///
+    /// <para />Values match ChromaSubsampling in jpeg_encode_options.h.
+    /// </summary>
+    public enum JpegSubsampling
+    {
+        /// <summary>
+        /// Chroma halved in both directions, the smallest output.
+        /// </summary>
+        YUV_420 = 0,
+
+        /// <summary>
+        /// Full resolution chroma, keeps sharp colored edges.
+        /// </summary>
+        YUV_444 = 1
+    }
+
+    /// <summary>
+    /// Forward DCT used by the encoder.
+    ///
+    /// <para />Values match DctMethod in jpeg_encode_options.h.
+    /// </summary>
+    public enum JpegDctMethod
+    {
+        /// <summary>
+        /// Accurate integer DCT.
+        /// </summary>
+        ISLOW = 0,
+
+        /// <summary>
+        /// Fast, less accurate integer DCT.
+        /// </summary>
+        IFAST = 1,
+
+        /// <summary>
+        /// Floating point DCT.
+        /// </summary>
+        FLOAT = 2
+    }
+
+    /// <summary>
+    /// Named trade-offs between encode time and output size.
+    ///
+    /// <para />Values match EncodePreset in jpeg_encode_options.h.
+    /// </summary>
+    public enum JpegEncodePreset
+    {
+        /// <summary>
+        /// Standard Huffman tables and the fast integer DCT.
+        /// </summary>
+        FASTEST = 0,
+
+        /// <summary>
+        /// Optimized Huffman tables, usually a few percent smaller than
+        /// FASTEST with identical pixels.
+        /// </summary>
+        BALANCED = 1,
+
+        /// <summary>
+        /// Optimized Huffman tables and progressive scans.
+        /// </summary>
+        SMALLEST = 2
+    }
+}
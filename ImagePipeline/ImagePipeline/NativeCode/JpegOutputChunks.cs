@@ -0,0 +1,196 @@
+﻿using FBCore.Common.Internal;
+using FBCore.Common.References;
+using ImagePipeline.Memory;
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Threading;
+
+namespace ImagePipeline.NativeCode
+{
+#if HAS_LIBJPEGTURBO
+    /// <summary>
+    /// Pooled chunks receiving the output of a native jpeg transcode.
+    ///
+    /// <para />libjpeg writes straight into the chunks. The first one is
+    /// taken up front, the following ones are taken by the native encoder
+    /// through <see cref="Allocator"/> whenever a chunk fills up, on the
+    /// thread running the transcode. The result is handed over as the
+    /// chunks themselves, the bytes are never gathered.
+    /// </summary>
+    internal sealed class JpegOutputChunks : IDisposable
+    {
+        // Outputs a native transcode may still write to, by cookie.
+        private static readonly ConcurrentDictionary<long, JpegOutputChunks> _outputs =
+            new ConcurrentDictionary<long, JpegOutputChunks>();
+
+        // Referenced for the lifetime of the process, native workers may
+        // call it at any time.
+        internal static readonly NativeMethods.AllocateOutputChunkCallback Allocator = AllocateChunk;
+
+        private static long _lastCookie;
+
+        private readonly object _gate = new object();
+        private readonly NativeMemoryChunkPool _pool;
+        private List<CloseableReference<NativeMemoryChunk>> _chunkRefs;
+
+        /// <summary>
+        /// Identifies the output in the calls to <see cref="Allocator"/>.
+        /// </summary>
+        internal long Cookie { get; }
+
+        /// <summary>
+        /// The chunk libjpeg writes to first.
+        /// </summary>
+        internal NativeMemoryChunk FirstChunk
+        {
+            get
+            {
+                lock (_gate)
+                {
+                    Preconditions.CheckState(_chunkRefs != null);
+                    return _chunkRefs[0].Get();
+                }
+            }
+        }
+
+        /// <summary>
+        /// Takes the first chunk, of at least firstChunkSize bytes, from
+        /// the pool.
+        /// </summary>
+        internal JpegOutputChunks(NativeMemoryChunkPool pool, int firstChunkSize)
+        {
+            _pool = Preconditions.CheckNotNull(pool);
+            _chunkRefs = new List<CloseableReference<NativeMemoryChunk>>
+            {
+                CloseableReference<NativeMemoryChunk>.of(pool.Get(firstChunkSize), pool)
+            };
+
+            Cookie = Interlocked.Increment(ref _lastCookie);
+            _outputs[Cookie] = this;
+        }
+
+        /// <summary>
+        /// Size of the first chunk for a transcode of srcLength bytes.
+        ///
+        /// <para />Downscaling shrinks the output about as much as the
+        /// number of pixels, a first chunk sized to the input would mostly
+        /// stay empty and be pinned along with the image in the memory
+        /// cache. Outputs outgrowing the estimate continue in more chunks.
+        /// </summary>
+        internal static int EstimateOutputSize(int srcLength, JpegTranscodeOptions options)
+        {
+            int scaleNumerator = options.ScaleNumerator;
+            if (scaleNumerator >= JpegTranscoder.SCALE_DENOMINATOR)
+            {
+                return srcLength;
+            }
+
+            return (int)((long)srcLength * scaleNumerator * scaleNumerator /
+                (JpegTranscoder.SCALE_DENOMINATOR * JpegTranscoder.SCALE_DENOMINATOR));
+        }
+
+        /// <summary>
+        /// Wraps the bytes written by the transcode into a buffer holding
+        /// the chunks, then releases them. Chunks left empty go back to
+        /// the pool right away.
+        /// </summary>
+        /// <param name="output">
+        /// The native JpegChunkedDestination the transcode wrote to.
+        /// </param>
+        internal IPooledByteBuffer ToByteBuffer(long output)
+        {
+            lock (_gate)
+            {
+                Preconditions.CheckState(_chunkRefs != null);
+
+                int[] sizes = new int[_chunkRefs.Count];
+                NativeMethods.nativeGetChunkedOutputSizes(output, sizes, sizes.Length);
+
+                int count = sizes.Length;
+                while (count > 1 && sizes[count - 1] == 0)
+                {
+                    --count;
+                }
+
+                if (count == 1)
+                {
+                    return new NativePooledByteBuffer(_chunkRefs[0], sizes[0]);
+                }
+
+                return new ChunkedPooledByteBuffer(
+                    _chunkRefs.GetRange(0, count),
+                    new ArraySegment<int>(sizes, 0, count));
+            }
+        }
+
+        /// <summary>
+        /// Releases the chunks. Has to be called once the native transcode
+        /// no longer writes to them.
+        /// </summary>
+        public void Dispose()
+        {
+            JpegOutputChunks removed;
+            _outputs.TryRemove(Cookie, out removed);
+
+            lock (_gate)
+            {
+                if (_chunkRefs == null)
+                {
+                    return;
+                }
+
+                foreach (CloseableReference<NativeMemoryChunk> chunkRef in _chunkRefs)
+                {
+                    chunkRef.Dispose();
+                }
+
+                _chunkRefs = null;
+            }
+        }
+
+        private static long AllocateChunk(long cookie, int preferredCapacity, out int capacity)
+        {
+            capacity = 0;
+
+            JpegOutputChunks output;
+            if (!_outputs.TryGetValue(cookie, out output))
+            {
+                return 0;
+            }
+
+            try
+            {
+                NativeMemoryChunkPool pool = output._pool;
+                int size = Math.Max(
+                    pool.GetMinBufferSize(),
+                    Math.Min(preferredCapacity, pool.GetMaxBufferSize()));
+
+                CloseableReference<NativeMemoryChunk> chunkRef =
+                    CloseableReference<NativeMemoryChunk>.of(pool.Get(size), pool);
+
+                lock (output._gate)
+                {
+                    if (output._chunkRefs == null)
+                    {
+                        chunkRef.Dispose();
+                        return 0;
+                    }
+
+                    output._chunkRefs.Add(chunkRef);
+                }
+
+                NativeMemoryChunk chunk = chunkRef.Get();
+                capacity = chunk.Size;
+                return chunk.GetNativePtr();
+            }
+            catch (Exception)
+            {
+                // Exceptions cannot cross into native code, libjpeg fails
+                // the transcode instead.
+                return 0;
+            }
+        }
+    }
+#endif // HAS_LIBJPEGTURBO
+}
@@ -0,0 +1,129 @@
+﻿using FBCore.Common.Internal;
+using ImagePipeline.Memory;
+using System;
+using System.Threading.Tasks;
+
+namespace ImagePipeline.NativeCode
+{
+#if HAS_LIBJPEGTURBO
+    /// <summary>
+    /// Downscale of a jpeg whose bytes are appended as they arrive,
+    /// started by <see cref="JpegTranscodeQueue.StartStreamingTranscode"/>.
+    ///
+    /// <para />Appending only copies the bytes, the transcode runs on the
+    /// native worker pool. Disposing a transcode that was not finished
+    /// cancels it.
+    /// </summary>
+    public sealed class JpegStreamingTranscode : IDisposable
+    {
+        private readonly object _gate = new object();
+        private readonly Task _completion;
+
+        private long _job;
+        private JpegOutputChunks _output;
+        private int _appendedLength;
+
+        internal JpegStreamingTranscode(
+            long job,
+            Task completion,
+            JpegOutputChunks output)
+        {
+            _job = job;
+            _completion = completion;
+            _output = output;
+        }
+
+        /// <summary>
+        /// Number of bytes appended so far.
+        /// </summary>
+        public int AppendedLength
+        {
+            get
+            {
+                lock (_gate)
+                {
+                    return _appendedLength;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Copies the bytes following the ones appended so far.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the bytes.</param>
+        /// <param name="length">Number of bytes.</param>
+        public void Append(long srcPtr, int length)
+        {
+            Preconditions.CheckArgument(srcPtr != 0);
+            Preconditions.CheckArgument(length >= 0);
+            lock (_gate)
+            {
+                Preconditions.CheckState(_job != 0, "transcode was finished");
+                NativeMethods.nativeAppendStreamingTranscodeInput(_job, srcPtr, length);
+                _appendedLength += length;
+            }
+        }
+
+        /// <summary>
+        /// Marks the end of the input and returns the transcoded image.
+        /// </summary>
+        /// <returns>
+        /// The transcoded image, faulted with <see cref="System.IO.IOException"/>
+        /// when the bytes are not a valid jpeg.
+        /// </returns>
+        public Task<IPooledByteBuffer> FinishAsync()
+        {
+            lock (_gate)
+            {
+                Preconditions.CheckState(_job != 0, "transcode was finished");
+                NativeMethods.nativeFinishStreamingTranscodeInput(_job);
+                return TakeResult();
+            }
+        }
+
+        /// <summary>
+        /// Cancels the transcode unless it was finished.
+        /// </summary>
+        public void Dispose()
+        {
+            Task<IPooledByteBuffer> result;
+            lock (_gate)
+            {
+                if (_job == 0)
+                {
+                    return;
+                }
+
+                NativeMethods.nativeCancelStreamingTranscode(_job);
+                result = TakeResult();
+            }
+
+            // The output chunks go back to the pool once the worker no
+            // longer writes into them.
+            result.ContinueWith(
+                task =>
+                {
+                    if (task.Status == TaskStatus.RanToCompletion)
+                    {
+                        task.Result.Dispose();
+                    }
+                    else
+                    {
+                        // Observe the cancellation
+                        var exception = task.Exception;
+                    }
+                },
+                TaskContinuationOptions.ExecuteSynchronously);
+        }
+
+        private Task<IPooledByteBuffer> TakeResult()
+        {
+            long job = _job;
+            JpegOutputChunks output = _output;
+            _job = 0;
+            _output = null;
+            return JpegTranscodeQueue.CompleteJobAsync(job, _completion, output);
+        }
+    }
+#endif // HAS_LIBJPEGTURBO
+}
@@ -0,0 +1,198 @@
+﻿using FBCore.Common.Internal;
+using ImagePipeline.Common;
+using System.Runtime.InteropServices;
+
+namespace ImagePipeline.NativeCode
+{
+#if HAS_LIBJPEGTURBO
+    /// <summary>
+    /// Matches TranscodeJpegOptions in JpegTranscoder.h.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeTranscodeOptions
+    {
+        public int RotationAngle;
+        public int ScaleNominator;
+        public int CropX;
+        public int CropY;
+        public int CropWidth;
+        public int CropHeight;
+        public int TargetWidth;
+        public int TargetHeight;
+        public int Quality;
+        public int OptimizeCoding;
+        public int Progressive;
+        public int Subsampling;
+        public int DctMethod;
+        public int RestartRows;
+        public int ResampleFilter;
+    }
+
+    /// <summary>
+    /// Transformation applied by <see cref="JpegTranscoder"/> and
+    /// <see cref="JpegTranscodeQueue"/>, along with the parameters of the
+    /// encoder writing the result.
+    ///
+    /// <para />The image is cropped first, then scaled by libjpeg during
+    /// the IDCT, resampled to the target size and finally rotated.
+    /// </summary>
+    public class JpegTranscodeOptions
+    {
+        /// <summary>
+        /// 0, 90, 180 or 270.
+        /// </summary>
+        public int RotationAngle { get; }
+
+        /// <summary>
+        /// 1 - 16, image will be scaled using ScaleNumerator/8 factor.
+        /// </summary>
+        public int ScaleNumerator { get; }
+
+        /// <summary>
+        /// Region of the encoded image to keep, null to keep all of it.
+        ///
+        /// <para />Only the part of the image covered by the region is
+        /// decoded. Without scaling the crop is lossless and its top left
+        /// corner may move up and left to the nearest iMCU boundary.
+        /// </summary>
+        public CropOptions CropOptions { get; }
+
+        /// <summary>
+        /// Exact size of the output before rotation, null to keep the size
+        /// reached by <see cref="ScaleNumerator"/>. The scaled image is
+        /// resampled to it and never upscaled.
+        /// </summary>
+        public ResizeOptions TargetSize { get; }
+
+        /// <summary>
+        /// Filter resampling the image to <see cref="TargetSize"/>.
+        /// </summary>
+        public ResampleFilter ResampleFilter { get; }
+
+        /// <summary>
+        /// Parameters of the jpeg encoder.
+        /// </summary>
+        public JpegEncodeOptions EncodeOptions { get; }
+
+        /// <summary>
+        /// Instantiates the <see cref="JpegTranscodeOptions"/> downscaling
+        /// and rotating the image, encoded with the libjpeg defaults.
+        /// </summary>
+        /// <param name="rotationAngle">0, 90, 180 or 270.</param>
+        /// <param name="scaleNumerator">
+        /// 1 - 16, image will be scaled using scaleNumerator/8 factor.
+        /// </param>
+        /// <param name="quality">1 - 100.</param>
+        public JpegTranscodeOptions(
+            int rotationAngle,
+            int scaleNumerator,
+            int quality) : this(
+                rotationAngle,
+                scaleNumerator,
+                null,
+                null,
+                new JpegEncodeOptions(quality))
+        {
+        }
+
+        /// <summary>
+        /// Instantiates the <see cref="JpegTranscodeOptions"/>.
+        /// </summary>
+        /// <param name="rotationAngle">0, 90, 180 or 270.</param>
+        /// <param name="scaleNumerator">
+        /// 1 - 16, image will be scaled using scaleNumerator/8 factor.
+        /// </param>
+        /// <param name="cropOptions">
+        /// Region of the encoded image to keep, null to keep all of it.
+        /// </param>
+        /// <param name="targetSize">
+        /// Exact size of the output before rotation, null to keep the size
+        /// reached by scaleNumerator.
+        /// </param>
+        /// <param name="encodeOptions">Parameters of the jpeg encoder.</param>
+        public JpegTranscodeOptions(
+            int rotationAngle,
+            int scaleNumerator,
+            CropOptions cropOptions,
+            ResizeOptions targetSize,
+            JpegEncodeOptions encodeOptions) : this(
+                rotationAngle,
+                scaleNumerator,
+                cropOptions,
+                targetSize,
+                ResampleFilter.LANCZOS3,
+                encodeOptions)
+        {
+        }
+
+        /// <summary>
+        /// Instantiates the <see cref="JpegTranscodeOptions"/>.
+        /// </summary>
+        /// <param name="rotationAngle">0, 90, 180 or 270.</param>
+        /// <param name="scaleNumerator">
+        /// 1 - 16, image will be scaled using scaleNumerator/8 factor.
+        /// </param>
+        /// <param name="cropOptions">
+        /// Region of the encoded image to keep, null to keep all of it.
+        /// </param>
+        /// <param name="targetSize">
+        /// Exact size of the output before rotation, null to keep the size
+        /// reached by scaleNumerator.
+        /// </param>
+        /// <param name="resampleFilter">
+        /// Filter resampling the image to targetSize.
+        /// </param>
+        /// <param name="encodeOptions">Parameters of the jpeg encoder.</param>
+        public JpegTranscodeOptions(
+            int rotationAngle,
+            int scaleNumerator,
+            CropOptions cropOptions,
+            ResizeOptions targetSize,
+            ResampleFilter resampleFilter,
+            JpegEncodeOptions encodeOptions)
+        {
+            Preconditions.CheckArgument(scaleNumerator >= JpegTranscoder.MIN_SCALE_NUMERATOR);
+            Preconditions.CheckArgument(scaleNumerator <= JpegTranscoder.MAX_SCALE_NUMERATOR);
+            Preconditions.CheckNotNull(encodeOptions);
+            Preconditions.CheckArgument(encodeOptions.Quality >= JpegTranscoder.MIN_QUALITY);
+            Preconditions.CheckArgument(encodeOptions.Quality <= JpegTranscoder.MAX_QUALITY);
+            Preconditions.CheckArgument(JpegTranscoder.IsRotationAngleAllowed(rotationAngle));
+            Preconditions.CheckArgument(
+                scaleNumerator != JpegTranscoder.SCALE_DENOMINATOR ||
+                    rotationAngle != 0 ||
+                    cropOptions != null ||
+                    targetSize != null,
+                "no transformation requested");
+
+            RotationAngle = rotationAngle;
+            ScaleNumerator = scaleNumerator;
+            CropOptions = cropOptions;
+            TargetSize = targetSize;
+            ResampleFilter = resampleFilter;
+            EncodeOptions = encodeOptions;
+        }
+
+        internal NativeTranscodeOptions ToNative()
+        {
+            return new NativeTranscodeOptions
+            {
+                RotationAngle = RotationAngle,
+                ScaleNominator = ScaleNumerator,
+                CropX = JpegTranscoder.GetCropX(CropOptions),
+                CropY = JpegTranscoder.GetCropY(CropOptions),
+                CropWidth = JpegTranscoder.GetCropWidth(CropOptions),
+                CropHeight = JpegTranscoder.GetCropHeight(CropOptions),
+                TargetWidth = JpegTranscoder.GetTargetWidth(TargetSize),
+                TargetHeight = JpegTranscoder.GetTargetHeight(TargetSize),
+                Quality = EncodeOptions.Quality,
+                OptimizeCoding = EncodeOptions.OptimizeCoding ? 1 : 0,
+                Progressive = EncodeOptions.Progressive ? 1 : 0,
+                Subsampling = (int)EncodeOptions.Subsampling,
+                DctMethod = (int)EncodeOptions.DctMethod,
+                RestartRows = EncodeOptions.RestartRows,
+                ResampleFilter = (int)ResampleFilter
+            };
+        }
+    }
+#endif // HAS_LIBJPEGTURBO
+}
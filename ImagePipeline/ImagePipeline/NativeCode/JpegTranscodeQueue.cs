@@ -0,0 +1,282 @@
+﻿using FBCore.Common.Internal;
+using ImagePipeline.Memory;
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace ImagePipeline.NativeCode
+{
+#if HAS_LIBJPEGTURBO
+    /// <summary>
+    /// State of a native transcode job.
+    ///
+    /// <para />Matches TranscodeJobStatus in jpeg_transcode_job.h.
+    /// </summary>
+    internal enum TranscodeJobStatus
+    {
+        PENDING = 0,
+        SUCCEEDED = 1,
+        FAILED = 2
+    }
+
+    /// <summary>
+    /// Matches TranscodeJpegRequest in JpegTranscoder.h.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeTranscodeRequest
+    {
+        public long SrcPtr;
+        public long DstPtr;
+        public long OutputCookie;
+        public int SrcLen;
+        public int DstCapacity;
+        public NativeTranscodeOptions Options;
+    }
+
+    /// <summary>
+    /// Runs jpeg transcodes on the native worker pool.
+    ///
+    /// <para />Unlike <see cref="JpegTranscoder"/>, no managed thread is
+    /// blocked while libjpeg runs. Each job signals its completion from the
+    /// worker thread and the returned task completes on the .NET thread
+    /// pool.
+    /// </summary>
+    public static class JpegTranscodeQueue
+    {
+        private const int MAX_ERROR_LENGTH = 256;
+
+        private static readonly ConcurrentDictionary<long, TaskCompletionSource<bool>> _pendingJobs =
+            new ConcurrentDictionary<long, TaskCompletionSource<bool>>();
+
+        // Referenced for the lifetime of the process, native workers may
+        // call it at any time.
+        private static readonly NativeMethods.TranscodeJpegCallback _onJobCompleted = OnJobCompleted;
+
+        private static long _lastCookie;
+
+        /// <summary>
+        /// Number of native threads running transcodes.
+        /// </summary>
+        public static int WorkerCount
+        {
+            get
+            {
+                return NativeMethods.nativeGetTranscodeWorkerCount();
+            }
+        }
+
+        /// <summary>
+        /// Transcodes the jpeg on the native worker pool and returns the
+        /// result in a buffer taken from the given pool.
+        /// </summary>
+        /// <param name="request">The transcode to run.</param>
+        /// <param name="pool">The pool to allocate the output from.</param>
+        /// <returns>
+        /// The transcoded image, faulted with <see cref="IOException"/> when
+        /// the image cannot be transcoded.
+        /// </returns>
+        public static Task<IPooledByteBuffer> TranscodeJpegToByteBufferAsync(
+            JpegTranscodeRequest request,
+            NativeMemoryChunkPool pool)
+        {
+            return TranscodeJpegBatchAsync(new[] { request }, pool)[0];
+        }
+
+        /// <summary>
+        /// Submits the transcodes to the native worker pool in one call.
+        ///
+        /// <para />Requests are validated before any of them is queued, the
+        /// jobs then run concurrently and complete independently.
+        /// </summary>
+        /// <param name="requests">The transcodes to run.</param>
+        /// <param name="pool">The pool to allocate the outputs from.</param>
+        /// <returns>A task per request, in the order of the requests.</returns>
+        public static Task<IPooledByteBuffer>[] TranscodeJpegBatchAsync(
+            IList<JpegTranscodeRequest> requests,
+            NativeMemoryChunkPool pool)
+        {
+            Preconditions.CheckNotNull(requests);
+            Preconditions.CheckNotNull(pool);
+
+            int count = requests.Count;
+            var outputs = new JpegOutputChunks[count];
+            var nativeRequests = new NativeTranscodeRequest[count];
+            var completions = new TaskCompletionSource<bool>[count];
+            long[] jobs = new long[count];
+            long firstCookie = Interlocked.Add(ref _lastCookie, count) - count + 1;
+            bool submitted = false;
+
+            try
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    JpegTranscodeRequest request = Preconditions.CheckNotNull(requests[i]);
+                    outputs[i] = new JpegOutputChunks(
+                        pool,
+                        Math.Max(
+                            pool.GetMinBufferSize(),
+                            JpegOutputChunks.EstimateOutputSize(request.SrcLength, request.Options)));
+
+                    nativeRequests[i] = CreateNativeRequest(
+                        request.SrcPtr,
+                        request.SrcLength,
+                        request.Options,
+                        outputs[i]);
+
+                    completions[i] = new TaskCompletionSource<bool>(
+                        TaskCreationOptions.RunContinuationsAsynchronously);
+
+                    _pendingJobs[firstCookie + i] = completions[i];
+                }
+
+                NativeMethods.nativeSubmitTranscodeJpegBatch(
+                    nativeRequests,
+                    count,
+                    JpegOutputChunks.Allocator,
+                    _onJobCompleted,
+                    firstCookie,
+                    jobs);
+
+                submitted = true;
+            }
+            finally
+            {
+                if (!submitted)
+                {
+                    for (int i = 0; i < count; ++i)
+                    {
+                        TaskCompletionSource<bool> completion;
+                        _pendingJobs.TryRemove(firstCookie + i, out completion);
+                        outputs[i]?.Dispose();
+                    }
+                }
+            }
+
+            var results = new Task<IPooledByteBuffer>[count];
+            for (int i = 0; i < count; ++i)
+            {
+                results[i] = CompleteJobAsync(jobs[i], completions[i].Task, outputs[i]);
+            }
+
+            return results;
+        }
+
+        /// <summary>
+        /// Starts downscaling a jpeg whose bytes are appended as they
+        /// arrive, e.g. while it is being downloaded.
+        ///
+        /// <para />Rows are decoded, scaled and encoded on the native worker
+        /// pool as soon as their bytes are appended, so the result is ready
+        /// shortly after the last byte arrives.
+        /// </summary>
+        /// <param name="options">
+        /// The transformation to apply, without rotation nor crop.
+        /// </param>
+        /// <param name="outputCapacity">
+        /// Size of the first pooled chunk receiving the output.
+        /// </param>
+        /// <param name="pool">The pool to allocate the output from.</param>
+        /// <returns>The transcode to append the bytes to.</returns>
+        public static JpegStreamingTranscode StartStreamingTranscode(
+            JpegTranscodeOptions options,
+            int outputCapacity,
+            NativeMemoryChunkPool pool)
+        {
+            Preconditions.CheckNotNull(options);
+            Preconditions.CheckArgument(
+                options.RotationAngle == 0 && options.CropOptions == null,
+                "streaming transcode cannot rotate or crop");
+            Preconditions.CheckArgument(outputCapacity > 0);
+            Preconditions.CheckNotNull(pool);
+
+            var output = new JpegOutputChunks(pool, outputCapacity);
+
+            long cookie = Interlocked.Increment(ref _lastCookie);
+            var completion = new TaskCompletionSource<bool>(
+                TaskCreationOptions.RunContinuationsAsynchronously);
+
+            _pendingJobs[cookie] = completion;
+
+            try
+            {
+                NativeTranscodeRequest request = CreateNativeRequest(0, 0, options, output);
+
+                long job = NativeMethods.nativeStartStreamingTranscodeJpeg(
+                    ref request, JpegOutputChunks.Allocator, _onJobCompleted, cookie);
+
+                return new JpegStreamingTranscode(job, completion.Task, output);
+            }
+            catch
+            {
+                _pendingJobs.TryRemove(cookie, out completion);
+                output.Dispose();
+                throw;
+            }
+        }
+
+        private static NativeTranscodeRequest CreateNativeRequest(
+            long srcPtr,
+            int srcLength,
+            JpegTranscodeOptions options,
+            JpegOutputChunks output)
+        {
+            NativeMemoryChunk chunk = output.FirstChunk;
+            return new NativeTranscodeRequest
+            {
+                SrcPtr = srcPtr,
+                DstPtr = chunk.GetNativePtr(),
+                OutputCookie = output.Cookie,
+                SrcLen = srcLength,
+                DstCapacity = chunk.Size,
+                Options = options.ToNative()
+            };
+        }
+
+        /// <summary>
+        /// Waits for the job, then releases it along with its output
+        /// chunks.
+        /// </summary>
+        internal static async Task<IPooledByteBuffer> CompleteJobAsync(
+            long job,
+            Task completion,
+            JpegOutputChunks output)
+        {
+            try
+            {
+                await completion.ConfigureAwait(false);
+
+                TranscodeJobStatus status =
+                    (TranscodeJobStatus)NativeMethods.nativeGetTranscodeJobStatus(job);
+
+                if (status != TranscodeJobStatus.SUCCEEDED)
+                {
+                    var message = new StringBuilder(MAX_ERROR_LENGTH);
+                    NativeMethods.nativeGetTranscodeJobError(job, message, message.Capacity);
+                    throw new IOException($"jpeg transcode failed: {message}");
+                }
+
+                return output.ToByteBuffer(NativeMethods.nativeGetTranscodeJobOutput(job));
+            }
+            finally
+            {
+                NativeMethods.nativeReleaseTranscodeJob(job);
+                output.Dispose();
+            }
+        }
+
+        private static void OnJobCompleted(long cookie)
+        {
+            TaskCompletionSource<bool> completion;
+            if (_pendingJobs.TryRemove(cookie, out completion))
+            {
+                completion.SetResult(true);
+            }
+        }
+    }
+#endif // HAS_LIBJPEGTURBO
+}
@@ -0,0 +1,47 @@
+﻿using FBCore.Common.Internal;
+
+namespace ImagePipeline.NativeCode
+{
+#if HAS_LIBJPEGTURBO
+    /// <summary>
+    /// Transcode of a jpeg held in native memory, submitted to the native
+    /// worker pool through <see cref="JpegTranscodeQueue"/>.
+    ///
+    /// <para />The encoded bytes are read in place, the submitter has to
+    /// keep the memory alive until the transcode completes.
+    /// </summary>
+    public class JpegTranscodeRequest
+    {
+        /// <summary>
+        /// Pointer to the encoded image.
+        /// </summary>
+        public long SrcPtr { get; }
+
+        /// <summary>
+        /// Number of encoded bytes.
+        /// </summary>
+        public int SrcLength { get; }
+
+        /// <summary>
+        /// The transformation to apply.
+        /// </summary>
+        public JpegTranscodeOptions Options { get; }
+
+        /// <summary>
+        /// Instantiates the <see cref="JpegTranscodeRequest"/>.
+        /// </summary>
+        public JpegTranscodeRequest(
+            long srcPtr,
+            int srcLength,
+            JpegTranscodeOptions options)
+        {
+            Preconditions.CheckArgument(srcPtr != 0);
+            Preconditions.CheckArgument(srcLength > 0);
+
+            SrcPtr = srcPtr;
+            SrcLength = srcLength;
+            Options = Preconditions.CheckNotNull(options);
+        }
+    }
+#endif // HAS_LIBJPEGTURBO
+}
@@ -1,4 +1,6 @@
 ﻿using FBCore.Common.Internal;
+using ImagePipeline.Common;
+using ImagePipeline.Memory;
 using System;
 using System.Runtime.InteropServices.ComTypes;
 
@@ -65,22 +67,165 @@ namespace ImagePipeline.NativeCode
             int scaleNumerator,
             int quality)
         {
-            Preconditions.CheckArgument(scaleNumerator >= MIN_SCALE_NUMERATOR);
-            Preconditions.CheckArgument(scaleNumerator <= MAX_SCALE_NUMERATOR);
-            Preconditions.CheckArgument(quality >= MIN_QUALITY);
-            Preconditions.CheckArgument(quality <= MAX_QUALITY);
-            Preconditions.CheckArgument(IsRotationAngleAllowed(rotationAngle));
-            Preconditions.CheckArgument(
-                scaleNumerator != SCALE_DENOMINATOR || rotationAngle != 0,
-                "no transformation requested");
+            TranscodeJpeg(
+                inputStream,
+                outputStream,
+                new JpegTranscodeOptions(rotationAngle, scaleNumerator, quality));
+        }
 
+        /// <summary>
+        /// Crops, resizes and rotates jpeg image.
+        /// </summary>
+        /// <param name="inputStream">The input stream.</param>
+        /// <param name="outputStream">The output stream.</param>
+        /// <param name="options">The transformation to apply.</param>
+        public static void TranscodeJpeg(
+            IStream inputStream,
+            IStream outputStream,
+            JpegTranscodeOptions options)
+        {
+            NativeTranscodeOptions nativeOptions = Preconditions.CheckNotNull(options).ToNative();
             NativeMethods.nativeTranscodeJpeg(
                 Preconditions.CheckNotNull(inputStream),
                 Preconditions.CheckNotNull(outputStream),
-                rotationAngle,
-                scaleNumerator,
-                quality);
+                ref nativeOptions);
+        }
+
+        /// <summary>
+        /// Crops, resizes and rotates jpeg image held in native memory.
+        ///
+        /// <para />The encoded bytes are read in place, the caller has to
+        /// keep the memory alive until this method returns.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="outputStream">The output stream.</param>
+        /// <param name="options">The transformation to apply.</param>
+        public static void TranscodeJpegFromMemory(
+            long srcPtr,
+            int srcLength,
+            IStream outputStream,
+            JpegTranscodeOptions options)
+        {
+            Preconditions.CheckArgument(srcPtr != 0);
+            Preconditions.CheckArgument(srcLength > 0);
+            NativeTranscodeOptions nativeOptions = Preconditions.CheckNotNull(options).ToNative();
+            NativeMethods.nativeTranscodeJpegFromMemory(
+                srcPtr,
+                srcLength,
+                Preconditions.CheckNotNull(outputStream),
+                ref nativeOptions);
+        }
+
+        /// <summary>
+        /// Crops, resizes and rotates jpeg image held in native memory and
+        /// returns the result in a buffer taken from the given pool.
+        ///
+        /// <para />libjpeg writes directly into pooled chunks, the first
+        /// one sized after the expected output. An output that does not fit
+        /// continues in more chunks taken from the pool and is returned in
+        /// them, without gathering the bytes.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="pool">The pool to allocate the output from.</param>
+        /// <param name="options">The transformation to apply.</param>
+        /// <returns>The transcoded image.</returns>
+        public static IPooledByteBuffer TranscodeJpegToByteBuffer(
+            long srcPtr,
+            int srcLength,
+            NativeMemoryChunkPool pool,
+            JpegTranscodeOptions options)
+        {
+            Preconditions.CheckArgument(srcPtr != 0);
+            Preconditions.CheckArgument(srcLength > 0);
+            Preconditions.CheckNotNull(pool);
+            NativeTranscodeOptions nativeOptions = Preconditions.CheckNotNull(options).ToNative();
+
+            using (var chunks = new JpegOutputChunks(
+                pool,
+                Math.Max(pool.GetMinBufferSize(), JpegOutputChunks.EstimateOutputSize(srcLength, options))))
+            {
+                NativeMemoryChunk chunk = chunks.FirstChunk;
+                long output = NativeMethods.nativeTranscodeJpegIntoChunks(
+                    srcPtr,
+                    srcLength,
+                    chunk.GetNativePtr(),
+                    chunk.Size,
+                    ref nativeOptions,
+                    JpegOutputChunks.Allocator,
+                    chunks.Cookie);
+
+                try
+                {
+                    return chunks.ToByteBuffer(output);
+                }
+                finally
+                {
+                    NativeMethods.nativeReleaseChunkedOutput(output);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Gets the number of libjpeg contexts created so far.
+        ///
+        /// <para />Contexts are cached per thread and reused for the
+        /// following images, see <see cref="GetReusedContextCount"/>.
+        /// </summary>
+        public static long GetCreatedContextCount()
+        {
+            return NativeMethods.nativeGetJpegContextCreatedCount();
+        }
+
+        /// <summary>
+        /// Gets the number of times a cached libjpeg context was reused
+        /// instead of being created from scratch.
+        /// </summary>
+        public static long GetReusedContextCount()
+        {
+            return NativeMethods.nativeGetJpegContextReusedCount();
+        }
+
+        /// <summary>
+        /// Gets the alignment every libjpeg image allocation had so far,
+        /// the largest power of two dividing all of their addresses.
+        /// 0 before the first image is done.
+        /// </summary>
+        internal static long GetArenaAlignment()
+        {
+            return NativeMethods.nativeGetJpegArenaAlignment();
         }
 #endif // HAS_LIBJPEGTURBO
+
+        internal static int GetCropX(CropOptions cropOptions)
+        {
+            return (cropOptions != null) ? cropOptions.X : 0;
+        }
+
+        internal static int GetCropY(CropOptions cropOptions)
+        {
+            return (cropOptions != null) ? cropOptions.Y : 0;
+        }
+
+        internal static int GetCropWidth(CropOptions cropOptions)
+        {
+            return (cropOptions != null) ? cropOptions.Width : 0;
+        }
+
+        internal static int GetCropHeight(CropOptions cropOptions)
+        {
+            return (cropOptions != null) ? cropOptions.Height : 0;
+        }
+
+        internal static int GetTargetWidth(ResizeOptions targetSize)
+        {
+            return (targetSize != null) ? targetSize.Width : 0;
+        }
+
+        internal static int GetTargetHeight(ResizeOptions targetSize)
+        {
+            return (targetSize != null) ? targetSize.Height : 0;
+        }
     }
 }
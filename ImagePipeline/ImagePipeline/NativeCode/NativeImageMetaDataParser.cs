@@ -0,0 +1,58 @@
+﻿using FBCore.Common.Internal;
+using ImageFormatUtils;
+using ImagePipeline.Image;
+using ImagePipeline.Memory;
+using System.Runtime.InteropServices;
+
+namespace ImagePipeline.NativeCode
+{
+    /// <summary>
+    /// Matches ParsedImageMetaData in ImageMetaDataParser.h.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeImageMetaData
+    {
+        public int Format;
+        public int Width;
+        public int Height;
+        public int Orientation;
+        public int Progressive;
+    }
+
+    /// <summary>
+    /// Reads the header of images held in native memory with a single
+    /// native pass over the jpeg markers, without creating a decoder.
+    /// </summary>
+    public sealed class NativeImageMetaDataParser : IImageMetaDataParser
+    {
+        /// <summary>
+        /// Parses the header of the image held by buffer.
+        /// </summary>
+        /// <param name="buffer">The encoded image.</param>
+        /// <returns>
+        /// The meta data, or null if buffer is not in native memory.
+        /// </returns>
+        public ImageMetaData Parse(IPooledByteBuffer buffer)
+        {
+            Preconditions.CheckNotNull(buffer);
+            NativePooledByteBuffer nativeBuffer = buffer as NativePooledByteBuffer;
+            if (nativeBuffer == null)
+            {
+                return null;
+            }
+
+            NativeImageMetaData metaData = default(NativeImageMetaData);
+            NativeMethods.nativeParseImageMetaData(
+                nativeBuffer.GetNativePtr(),
+                nativeBuffer.Size,
+                ref metaData);
+
+            return new ImageMetaData(
+                (ImageFormat)metaData.Format,
+                metaData.Width,
+                metaData.Height,
+                metaData.Orientation,
+                metaData.Progressive != 0);
+        }
+    }
+}
@@ -1,5 +1,7 @@
-﻿using System.Runtime.InteropServices;
+﻿using ImagePipeline.Decoder;
+using System.Runtime.InteropServices;
 using System.Runtime.InteropServices.ComTypes;
+using System.Text;
 
 namespace ImagePipeline.NativeCode
 {
@@ -13,6 +15,34 @@ namespace ImagePipeline.NativeCode
         [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
         public static extern long nativeAllocate(int size);
 
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeTrimAllocator();
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeTrimPixelBufferPool();
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long nativeGetPixelBufferPoolFreeBytes();
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long nativeMapFile(
+            [MarshalAs(UnmanagedType.LPWStr)] string path,
+            out int size);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeUnmap(long lpointer);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int nativeCopyFromMapping(long dst, long src, int count);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeGetAllocatorStats(
+            out long reservedBytes,
+            out long usedBytes,
+            out long cachedBytes,
+            out int arenaCount,
+            out int largeBlockCount);
+
         [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
         public static extern void nativeCopyToByteArray(long lpointer, byte[] byteArray, int offset, int count);
 
@@ -25,14 +55,276 @@ namespace ImagePipeline.NativeCode
         [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
         public static extern byte nativeReadByte(long lpointer);
 
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeGatherCopy(
+            [In] long[] sources,
+            [In] int[] counts,
+            int rangeCount,
+            byte[] byteArray,
+            int offset);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeScatterCopy(
+            [In] long[] destinations,
+            [In] int[] counts,
+            int rangeCount,
+            [In] byte[] byteArray,
+            int offset);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int nativeCompare(long lpointer, [In] byte[] byteArray, int offset, int count);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int nativeIndexOf(long lpointer, int count, byte value);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int nativeIndexOfSequence(
+            long lpointer,
+            int count,
+            [In] byte[] pattern,
+            int patternLength);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeParseImageMetaData(
+            long srcPtr,
+            int srcLen,
+            ref NativeImageMetaData metaData);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int nativeFindExifThumbnail(
+            long srcPtr,
+            int srcLen,
+            ref NativeExifThumbnail thumbnail);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int nativeScanJpegMarkers(
+            long srcPtr,
+            int srcLen,
+            ref NativeJpegScanState state,
+            [Out] int[] scanOffsets,
+            int scanOffsetCapacity);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long nativeCreateGifAnimation(
+            long srcPtr,
+            int srcLen,
+            int cacheCapacity,
+            int keyframeInterval);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeGetGifInfo(
+            long animation,
+            out int width,
+            out int height,
+            out int frameCount,
+            out int loopCount);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int nativeGetGifFrameDuration(long animation, int index);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeRenderGifFrame(
+            long animation,
+            int index,
+            int pixelFormat,
+            long dstPtr,
+            int stride,
+            int dstCapacity);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int nativeGetGifDecodedFrameCount(long animation);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long nativeGetGifMemorySize(long animation);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeReleaseGifAnimation(long animation);
+
 #if HAS_LIBJPEGTURBO
         [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
         public static extern void nativeTranscodeJpeg(
             IStream inputStream,
             IStream outputStream,
-            int rotationAngle,
+            ref NativeTranscodeOptions options);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeTranscodeJpegFromMemory(
+            long srcPtr,
+            int srcLen,
+            IStream outputStream,
+            ref NativeTranscodeOptions options);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long nativeTranscodeJpegIntoChunks(
+            long srcPtr,
+            int srcLen,
+            long dstPtr,
+            int dstCapacity,
+            ref NativeTranscodeOptions options,
+            AllocateOutputChunkCallback allocate,
+            long outputCookie);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeGetChunkedOutputSizes(
+            long output,
+            [Out] int[] sizes,
+            int count);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeReleaseChunkedOutput(long output);
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate long AllocateOutputChunkCallback(
+            long cookie,
+            int preferredCapacity,
+            out int capacity);
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate void TranscodeJpegCallback(long cookie);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeSubmitTranscodeJpegBatch(
+            [In] NativeTranscodeRequest[] requests,
+            int count,
+            AllocateOutputChunkCallback allocate,
+            TranscodeJpegCallback callback,
+            long firstCookie,
+            [Out] long[] jobs);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long nativeStartStreamingTranscodeJpeg(
+            ref NativeTranscodeRequest request,
+            AllocateOutputChunkCallback allocate,
+            TranscodeJpegCallback callback,
+            long cookie);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeAppendStreamingTranscodeInput(long job, long srcPtr, int srcLen);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeFinishStreamingTranscodeInput(long job);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeCancelStreamingTranscode(long job);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int nativeGetTranscodeJobStatus(long job);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeWaitForTranscodeJob(long job);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long nativeGetTranscodeJobOutput(long job);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int nativeGetTranscodeJobError(long job, StringBuilder message, int capacity);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeReleaseTranscodeJob(long job);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int nativeGetTranscodeWorkerCount();
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long nativeGetJpegContextCreatedCount();
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long nativeGetJpegContextReusedCount();
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long nativeGetJpegArenaAlignment();
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeGetJpegDecodeSize(
+            long srcPtr,
+            int srcLen,
             int scaleNominator,
-            int quality);
+            int cropX,
+            int cropY,
+            int cropWidth,
+            int cropHeight,
+            out int width,
+            out int height);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeDecodeJpeg(
+            long srcPtr,
+            int srcLen,
+            int scaleNominator,
+            int cropX,
+            int cropY,
+            int cropWidth,
+            int cropHeight,
+            int pixelFormat,
+            long dstPtr,
+            int stride,
+            int dstCapacity);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeSetJpegDecodeThreads(int threads);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int nativeGetJpegDecodeThreads();
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int nativeGetJpegRestartBandCount(long srcPtr, int srcLen);
 #endif // HAS_LIBJPEGTURBO
+
+#if HAS_LIBWEBP
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeGetWebpDecodeSize(
+            long srcPtr,
+            int srcLen,
+            int targetWidth,
+            int targetHeight,
+            out int width,
+            out int height);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeDecodeWebp(
+            long srcPtr,
+            int srcLen,
+            int targetWidth,
+            int targetHeight,
+            int pixelFormat,
+            long dstPtr,
+            int stride,
+            int dstCapacity);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeTranscodeWebpToJpeg(
+            long srcPtr,
+            int srcLen,
+            IStream outputStream,
+            int quality,
+            int optimizeCoding,
+            int progressive,
+            int subsampling,
+            int dctMethod,
+            int restartRows);
+#endif // HAS_LIBWEBP
+
+#if HAS_LIBPNG
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeGetPngDecodeSize(
+            long srcPtr,
+            int srcLen,
+            int targetWidth,
+            int targetHeight,
+            out int width,
+            out int height);
+
+        [DllImport(DllName, ExactSpelling = true, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void nativeDecodePng(
+            long srcPtr,
+            int srcLen,
+            int targetWidth,
+            int targetHeight,
+            int resampleFilter,
+            int pixelFormat,
+            long dstPtr,
+            int stride,
+            int dstCapacity);
+#endif // HAS_LIBPNG
     }
 }
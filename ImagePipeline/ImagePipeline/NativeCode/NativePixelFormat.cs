@@ -0,0 +1,48 @@
+﻿namespace ImagePipeline.NativeCode
+{
+    /// <summary>
+    /// Pixel formats produced by the native decoders.
+    ///
+    /// <para />Values match PixelFormat in decoded_image.h.
+    /// </summary>
+    public enum NativePixelFormat
+    {
+        /// <summary>
+        /// 3 bytes per pixel, R G B.
+        /// </summary>
+        RGB = 0,
+
+        /// <summary>
+        /// 4 bytes per pixel, R G B A.
+        /// </summary>
+        RGBA = 1,
+
+        /// <summary>
+        /// 4 bytes per pixel, B G R A, matching
+        /// <see cref="Windows.Graphics.Imaging.BitmapPixelFormat.Bgra8"/>.
+        /// </summary>
+        BGRA = 2,
+
+        /// <summary>
+        /// 4 bytes per pixel, B G R A with color premultiplied by alpha,
+        /// the format bitmaps are displayed in.
+        /// </summary>
+        BGRA_PREMULTIPLIED = 3,
+
+        /// <summary>
+        /// 2 bytes per pixel, a little endian word with 5 bits of red,
+        /// 6 of green and 5 of blue from the top.
+        /// </summary>
+        RGB565 = 4,
+
+        /// <summary>
+        /// 1 byte per pixel, luma.
+        /// </summary>
+        GRAY = 5,
+
+        /// <summary>
+        /// 2 bytes per pixel, luma and alpha.
+        /// </summary>
+        GRAY_ALPHA = 6
+    }
+}
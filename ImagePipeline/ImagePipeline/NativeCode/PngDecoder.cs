@@ -0,0 +1,242 @@
+﻿using FBCore.Common.Internal;
+using ImagePipeline.Common;
+using ImagePipeline.Request;
+using Windows.Graphics.Imaging;
+
+namespace ImagePipeline.NativeCode
+{
+    /// <summary>
+    /// Helper methods for decoding png images in native code.
+    /// </summary>
+    public class PngDecoder
+    {
+#if HAS_LIBPNG
+        /// <summary>
+        /// Reads png header held in native memory and computes the
+        /// dimensions of the image decoded at the given size.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="targetSize">
+        /// Size to scale to, null to keep the size of the image. Images
+        /// are never upscaled.
+        /// </param>
+        /// <param name="width">Receives decoded width.</param>
+        /// <param name="height">Receives decoded height.</param>
+        public static void GetDecodeSize(
+            long srcPtr,
+            int srcLength,
+            ResizeOptions targetSize,
+            out int width,
+            out int height)
+        {
+            Preconditions.CheckArgument(srcPtr != 0);
+            Preconditions.CheckArgument(srcLength > 0);
+
+            NativeMethods.nativeGetPngDecodeSize(
+                srcPtr,
+                srcLength,
+                JpegTranscoder.GetTargetWidth(targetSize),
+                JpegTranscoder.GetTargetHeight(targetSize),
+                out width,
+                out height);
+        }
+
+        /// <summary>
+        /// Decodes png of any bit depth, color type and interlacing held
+        /// in native memory into caller provided native memory.
+        ///
+        /// <para />Rows are written in place, row y starts at
+        /// dstPtr + y * stride. Scaling happens row by row as libpng
+        /// decodes, the full size image is never allocated.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="targetSize">
+        /// Size to scale to, null to keep the size of the image. Images
+        /// are never upscaled.
+        /// </param>
+        /// <param name="pixelFormat">Format of decoded pixels.</param>
+        /// <param name="dstPtr">Pointer to the destination buffer.</param>
+        /// <param name="stride">Distance in bytes between two rows.</param>
+        /// <param name="dstCapacity">Size of the destination buffer.</param>
+        public static void DecodePng(
+            long srcPtr,
+            int srcLength,
+            ResizeOptions targetSize,
+            NativePixelFormat pixelFormat,
+            long dstPtr,
+            int stride,
+            int dstCapacity)
+        {
+            DecodePng(
+                srcPtr,
+                srcLength,
+                targetSize,
+                ResampleFilter.LANCZOS3,
+                pixelFormat,
+                dstPtr,
+                stride,
+                dstCapacity);
+        }
+
+        /// <summary>
+        /// Decodes png held in native memory into caller provided native
+        /// memory, resampled to the target size with the given filter.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="targetSize">
+        /// Size to scale to, null to keep the size of the image. Images
+        /// are never upscaled.
+        /// </param>
+        /// <param name="resampleFilter">
+        /// Filter resampling the image to targetSize.
+        /// </param>
+        /// <param name="pixelFormat">Format of decoded pixels.</param>
+        /// <param name="dstPtr">Pointer to the destination buffer.</param>
+        /// <param name="stride">Distance in bytes between two rows.</param>
+        /// <param name="dstCapacity">Size of the destination buffer.</param>
+        public static void DecodePng(
+            long srcPtr,
+            int srcLength,
+            ResizeOptions targetSize,
+            ResampleFilter resampleFilter,
+            NativePixelFormat pixelFormat,
+            long dstPtr,
+            int stride,
+            int dstCapacity)
+        {
+            Preconditions.CheckArgument(srcPtr != 0);
+            Preconditions.CheckArgument(srcLength > 0);
+            Preconditions.CheckArgument(dstPtr != 0);
+            Preconditions.CheckArgument(stride > 0);
+            Preconditions.CheckArgument(dstCapacity > 0);
+
+            NativeMethods.nativeDecodePng(
+                srcPtr,
+                srcLength,
+                JpegTranscoder.GetTargetWidth(targetSize),
+                JpegTranscoder.GetTargetHeight(targetSize),
+                (int)resampleFilter,
+                (int)pixelFormat,
+                dstPtr,
+                stride,
+                dstCapacity);
+        }
+
+        /// <summary>
+        /// Decodes png held in native memory straight into the buffer of
+        /// a new SoftwareBitmap.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="targetSize">
+        /// Size to scale to, null to keep the size of the image. Images
+        /// are never upscaled.
+        /// </param>
+        /// <param name="bitmapConfig">Pixel format of the bitmap.</param>
+        /// <returns>
+        /// Bitmap with premultiplied alpha, owned by the caller.
+        /// </returns>
+        public static SoftwareBitmap DecodeToSoftwareBitmap(
+            long srcPtr,
+            int srcLength,
+            ResizeOptions targetSize,
+            BitmapPixelFormat bitmapConfig)
+        {
+            int width;
+            int height;
+            GetDecodeSize(srcPtr, srcLength, targetSize, out width, out height);
+            return DecodeToSoftwareBitmap(srcPtr, srcLength, width, height, bitmapConfig);
+        }
+
+        /// <summary>
+        /// Decodes png held in native memory at the size computed by
+        /// <see cref="GetDecodeSize"/> straight into the buffer of a new
+        /// SoftwareBitmap, without reading the header again.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="width">
+        /// Decoded width, at most the width of the image.
+        /// </param>
+        /// <param name="height">
+        /// Decoded height, at most the height of the image.
+        /// </param>
+        /// <param name="bitmapConfig">Pixel format of the bitmap.</param>
+        /// <returns>
+        /// Bitmap with premultiplied alpha, owned by the caller.
+        /// </returns>
+        public static SoftwareBitmap DecodeToSoftwareBitmap(
+            long srcPtr,
+            int srcLength,
+            int width,
+            int height,
+            BitmapPixelFormat bitmapConfig)
+        {
+            Preconditions.CheckArgument(width > 0);
+            Preconditions.CheckArgument(height > 0);
+
+            // The image is kept at full size when this is its size
+            var targetSize = new ResizeOptions(width, height);
+
+            if (bitmapConfig == BitmapPixelFormat.Bgra8)
+            {
+                // Premultiplied as the rows are decoded, no conversion pass
+                var bitmap = new SoftwareBitmap(
+                    BitmapPixelFormat.Bgra8, width, height, BitmapAlphaMode.Premultiplied);
+
+                try
+                {
+                    DecodeIntoSoftwareBitmap(
+                        srcPtr, srcLength, targetSize, NativePixelFormat.BGRA_PREMULTIPLIED, bitmap);
+
+                    return bitmap;
+                }
+                catch
+                {
+                    bitmap.Dispose();
+                    throw;
+                }
+            }
+
+            using (var decoded = new SoftwareBitmap(
+                BitmapPixelFormat.Rgba8, width, height, BitmapAlphaMode.Straight))
+            {
+                DecodeIntoSoftwareBitmap(
+                    srcPtr, srcLength, targetSize, NativePixelFormat.RGBA, decoded);
+
+                return SoftwareBitmap.Convert(
+                    decoded, bitmapConfig, BitmapAlphaMode.Premultiplied);
+            }
+        }
+
+        private static unsafe void DecodeIntoSoftwareBitmap(
+            long srcPtr,
+            int srcLength,
+            ResizeOptions targetSize,
+            NativePixelFormat pixelFormat,
+            SoftwareBitmap bitmap)
+        {
+            using (BitmapBuffer buffer = bitmap.LockBuffer(BitmapBufferAccessMode.Write))
+            using (var reference = buffer.CreateReference())
+            {
+                byte* data;
+                uint capacity;
+                ((IMemoryBufferByteAccess)reference).GetBuffer(out data, out capacity);
+
+                BitmapPlaneDescription plane = buffer.GetPlaneDescription(0);
+                DecodePng(
+                    srcPtr,
+                    srcLength,
+                    targetSize,
+                    pixelFormat,
+                    (long)(data + plane.StartIndex),
+                    plane.Stride,
+                    (int)capacity - plane.StartIndex);
+            }
+        }
+#endif // HAS_LIBPNG
+    }
+}
@@ -0,0 +1,27 @@
+﻿namespace ImagePipeline.NativeCode
+{
+    /// <summary>
+    /// Filters resampling decoded images to a target size.
+    ///
+    /// <para />Values match ResampleFilter in transformations.h.
+    /// </summary>
+    public enum ResampleFilter
+    {
+        /// <summary>
+        /// Windowed sinc spanning 3 source pixels on each side, the
+        /// sharpest of the filters.
+        /// </summary>
+        LANCZOS3 = 0,
+
+        /// <summary>
+        /// Tent spanning 1 source pixel on each side.
+        /// </summary>
+        BILINEAR = 1,
+
+        /// <summary>
+        /// Average of the source pixels covered by the output pixel, the
+        /// cheapest of the filters.
+        /// </summary>
+        BOX = 2
+    }
+}
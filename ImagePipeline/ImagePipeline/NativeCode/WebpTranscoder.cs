@@ -0,0 +1,359 @@
+﻿using FBCore.Common.Internal;
+using ImageFormatUtils;
+using ImagePipeline.Common;
+using ImagePipeline.Request;
+using System;
+using System.IO;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Runtime.InteropServices.ComTypes;
+using System.Threading.Tasks;
+using Windows.Graphics.Imaging;
+using Windows.Storage.Streams;
+
+namespace ImagePipeline.NativeCode
+{
+    /// <summary>
+    /// Helper methods for decoding webp images in native code and
+    /// transcoding them to formats the platform decoder supports.
+    /// </summary>
+    public class WebpTranscoder
+    {
+        private const string WEBP_MIME_TYPE = "image/webp";
+
+        private static readonly Lazy<bool> _isWebpDecoderInstalled =
+            new Lazy<bool>(() => BitmapDecoder
+                .GetDecoderInformationEnumerator()
+                .Any(info => info.MimeTypes.Contains(WEBP_MIME_TYPE)));
+
+        /// <summary>
+        /// Checks whether the platform decoder handles images of the given
+        /// webp format. Static webp needs the WebP codec extension of
+        /// Windows, animations are never decoded by the platform.
+        /// </summary>
+        /// <param name="format">One of the webp formats.</param>
+        /// <returns>
+        /// true if images of the format do not need to be transcoded.
+        /// </returns>
+        public static bool IsWebpNativelySupported(ImageFormat format)
+        {
+            switch (format)
+            {
+                case ImageFormat.WEBP_SIMPLE:
+                case ImageFormat.WEBP_LOSSLESS:
+                case ImageFormat.WEBP_EXTENDED:
+                case ImageFormat.WEBP_EXTENDED_WITH_ALPHA:
+                    return _isWebpDecoderInstalled.Value;
+
+                case ImageFormat.WEBP_ANIMATED:
+                    return false;
+
+                default:
+                    throw new ArgumentException("Image format is not a WebP image");
+            }
+        }
+
+        /// <summary>
+        /// Checks whether static webp has to be transcoded before it
+        /// reaches the platform decoder, and can be.
+        /// </summary>
+        public static bool IsTranscodeRequired
+        {
+            get
+            {
+#if HAS_LIBWEBP
+                return !_isWebpDecoderInstalled.Value;
+#else // HAS_LIBWEBP
+                return false;
+#endif // HAS_LIBWEBP
+            }
+        }
+
+#if HAS_LIBWEBP
+        /// <summary>
+        /// Reads webp header held in native memory and computes the
+        /// dimensions of the image decoded at the given size.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="targetSize">
+        /// Size to scale to, null to keep the size of the image. Images
+        /// are never upscaled.
+        /// </param>
+        /// <param name="width">Receives decoded width.</param>
+        /// <param name="height">Receives decoded height.</param>
+        public static void GetDecodeSize(
+            long srcPtr,
+            int srcLength,
+            ResizeOptions targetSize,
+            out int width,
+            out int height)
+        {
+            Preconditions.CheckArgument(srcPtr != 0);
+            Preconditions.CheckArgument(srcLength > 0);
+
+            NativeMethods.nativeGetWebpDecodeSize(
+                srcPtr,
+                srcLength,
+                JpegTranscoder.GetTargetWidth(targetSize),
+                JpegTranscoder.GetTargetHeight(targetSize),
+                out width,
+                out height);
+        }
+
+        /// <summary>
+        /// Decodes lossy, lossless or alpha webp held in native memory
+        /// into caller provided native memory.
+        ///
+        /// <para />Rows are written in place, row y starts at
+        /// dstPtr + y * stride. Scaling happens while libwebp
+        /// reconstructs the rows, the full size image is never allocated.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="targetSize">
+        /// Size to scale to, null to keep the size of the image. Images
+        /// are never upscaled.
+        /// </param>
+        /// <param name="pixelFormat">Format of decoded pixels.</param>
+        /// <param name="dstPtr">Pointer to the destination buffer.</param>
+        /// <param name="stride">Distance in bytes between two rows.</param>
+        /// <param name="dstCapacity">Size of the destination buffer.</param>
+        public static void DecodeWebp(
+            long srcPtr,
+            int srcLength,
+            ResizeOptions targetSize,
+            NativePixelFormat pixelFormat,
+            long dstPtr,
+            int stride,
+            int dstCapacity)
+        {
+            Preconditions.CheckArgument(srcPtr != 0);
+            Preconditions.CheckArgument(srcLength > 0);
+            Preconditions.CheckArgument(dstPtr != 0);
+            Preconditions.CheckArgument(stride > 0);
+            Preconditions.CheckArgument(dstCapacity > 0);
+
+            NativeMethods.nativeDecodeWebp(
+                srcPtr,
+                srcLength,
+                JpegTranscoder.GetTargetWidth(targetSize),
+                JpegTranscoder.GetTargetHeight(targetSize),
+                (int)pixelFormat,
+                dstPtr,
+                stride,
+                dstCapacity);
+        }
+
+        /// <summary>
+        /// Decodes webp held in native memory straight into the buffer of
+        /// a new SoftwareBitmap.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="targetSize">
+        /// Size to scale to, null to keep the size of the image. Images
+        /// are never upscaled.
+        /// </param>
+        /// <param name="bitmapConfig">Pixel format of the bitmap.</param>
+        /// <returns>
+        /// Bitmap with premultiplied alpha, owned by the caller.
+        /// </returns>
+        public static SoftwareBitmap DecodeToSoftwareBitmap(
+            long srcPtr,
+            int srcLength,
+            ResizeOptions targetSize,
+            BitmapPixelFormat bitmapConfig)
+        {
+            int width;
+            int height;
+            GetDecodeSize(srcPtr, srcLength, targetSize, out width, out height);
+            return DecodeToSoftwareBitmap(srcPtr, srcLength, width, height, bitmapConfig);
+        }
+
+        /// <summary>
+        /// Decodes webp held in native memory at the size computed by
+        /// <see cref="GetDecodeSize"/> straight into the buffer of a new
+        /// SoftwareBitmap, without reading the header again.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="width">
+        /// Decoded width, at most the width of the image.
+        /// </param>
+        /// <param name="height">
+        /// Decoded height, at most the height of the image.
+        /// </param>
+        /// <param name="bitmapConfig">Pixel format of the bitmap.</param>
+        /// <returns>
+        /// Bitmap with premultiplied alpha, owned by the caller.
+        /// </returns>
+        public static SoftwareBitmap DecodeToSoftwareBitmap(
+            long srcPtr,
+            int srcLength,
+            int width,
+            int height,
+            BitmapPixelFormat bitmapConfig)
+        {
+            Preconditions.CheckArgument(width > 0);
+            Preconditions.CheckArgument(height > 0);
+
+            // The image is kept at full size when this is its size
+            var targetSize = new ResizeOptions(width, height);
+
+            if (bitmapConfig == BitmapPixelFormat.Bgra8)
+            {
+                // libwebp premultiplies while writing the rows
+                var bitmap = new SoftwareBitmap(
+                    BitmapPixelFormat.Bgra8, width, height, BitmapAlphaMode.Premultiplied);
+
+                try
+                {
+                    DecodeIntoSoftwareBitmap(
+                        srcPtr, srcLength, targetSize, NativePixelFormat.BGRA_PREMULTIPLIED, bitmap);
+
+                    return bitmap;
+                }
+                catch
+                {
+                    bitmap.Dispose();
+                    throw;
+                }
+            }
+
+            using (var decoded = new SoftwareBitmap(
+                BitmapPixelFormat.Rgba8, width, height, BitmapAlphaMode.Straight))
+            {
+                DecodeIntoSoftwareBitmap(
+                    srcPtr, srcLength, targetSize, NativePixelFormat.RGBA, decoded);
+
+                return SoftwareBitmap.Convert(
+                    decoded, bitmapConfig, BitmapAlphaMode.Premultiplied);
+            }
+        }
+
+        private static unsafe void DecodeIntoSoftwareBitmap(
+            long srcPtr,
+            int srcLength,
+            ResizeOptions targetSize,
+            NativePixelFormat pixelFormat,
+            SoftwareBitmap bitmap)
+        {
+            using (BitmapBuffer buffer = bitmap.LockBuffer(BitmapBufferAccessMode.Write))
+            using (var reference = buffer.CreateReference())
+            {
+                byte* data;
+                uint capacity;
+                ((IMemoryBufferByteAccess)reference).GetBuffer(out data, out capacity);
+
+                BitmapPlaneDescription plane = buffer.GetPlaneDescription(0);
+                DecodeWebp(
+                    srcPtr,
+                    srcLength,
+                    targetSize,
+                    pixelFormat,
+                    (long)(data + plane.StartIndex),
+                    plane.Stride,
+                    (int)capacity - plane.StartIndex);
+            }
+        }
+
+#if HAS_LIBJPEGTURBO
+        /// <summary>
+        /// Transcodes webp held in native memory to jpeg, dropping alpha.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="outputStream">The output stream.</param>
+        /// <param name="encodeOptions">Parameters of the jpeg encoder.</param>
+        public static void TranscodeWebpToJpeg(
+            long srcPtr,
+            int srcLength,
+            IStream outputStream,
+            JpegEncodeOptions encodeOptions)
+        {
+            Preconditions.CheckArgument(srcPtr != 0);
+            Preconditions.CheckArgument(srcLength > 0);
+            Preconditions.CheckNotNull(encodeOptions);
+
+            NativeMethods.nativeTranscodeWebpToJpeg(
+                srcPtr,
+                srcLength,
+                Preconditions.CheckNotNull(outputStream),
+                encodeOptions.Quality,
+                encodeOptions.OptimizeCoding ? 1 : 0,
+                encodeOptions.Progressive ? 1 : 0,
+                (int)encodeOptions.Subsampling,
+                (int)encodeOptions.DctMethod,
+                encodeOptions.RestartRows);
+        }
+#endif // HAS_LIBJPEGTURBO
+
+        /// <summary>
+        /// Transcodes webp held in native memory to png, keeping alpha
+        /// and lossless pixels.
+        ///
+        /// <para />The pixels are decoded natively and encoded by the
+        /// platform png encoder.
+        /// </summary>
+        /// <param name="srcPtr">Pointer to the encoded image.</param>
+        /// <param name="srcLength">Number of encoded bytes.</param>
+        /// <param name="outputStream">The output stream.</param>
+        public static async Task TranscodeWebpToPngAsync(
+            long srcPtr,
+            int srcLength,
+            Stream outputStream)
+        {
+            Preconditions.CheckNotNull(outputStream);
+
+            int width;
+            int height;
+            GetDecodeSize(srcPtr, srcLength, null, out width, out height);
+
+            int stride = width * JpegDecoder.GetBytesPerPixel(NativePixelFormat.RGBA);
+            byte[] pixels = new byte[stride * height];
+            GCHandle pixelsHandle = GCHandle.Alloc(pixels, GCHandleType.Pinned);
+            try
+            {
+                DecodeWebp(
+                    srcPtr,
+                    srcLength,
+                    null,
+                    NativePixelFormat.RGBA,
+                    pixelsHandle.AddrOfPinnedObject().ToInt64(),
+                    stride,
+                    pixels.Length);
+            }
+            finally
+            {
+                pixelsHandle.Free();
+            }
+
+            using (var pngStream = new InMemoryRandomAccessStream())
+            {
+                BitmapEncoder encoder = await BitmapEncoder
+                    .CreateAsync(BitmapEncoder.PngEncoderId, pngStream)
+                    .AsTask()
+                    .ConfigureAwait(false);
+
+                encoder.SetPixelData(
+                    BitmapPixelFormat.Rgba8,
+                    BitmapAlphaMode.Straight,
+                    (uint)width,
+                    (uint)height,
+                    96,
+                    96,
+                    pixels);
+
+                await encoder.FlushAsync().AsTask().ConfigureAwait(false);
+
+                pngStream.Seek(0);
+                using (Stream encoded = pngStream.AsStreamForRead())
+                {
+                    await encoded.CopyToAsync(outputStream).ConfigureAwait(false);
+                }
+            }
+        }
+#endif // HAS_LIBWEBP
+    }
+}
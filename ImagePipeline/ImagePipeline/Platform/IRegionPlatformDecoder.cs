@@ -0,0 +1,72 @@
+﻿using FBCore.Common.References;
+using ImagePipeline.Common;
+using ImagePipeline.Image;
+using System;
+using System.Threading.Tasks;
+using Windows.Graphics.Imaging;
+
+namespace ImagePipeline.Platform
+{
+    /// <summary>
+    /// Platform decoder that can decode a region of the image.
+    ///
+    /// <para />Platform decoders that only implement
+    /// <see cref="IPlatformDecoder"/> keep working for requests without
+    /// <see cref="CropOptions"/>.
+    /// </summary>
+    public interface IRegionPlatformDecoder : IPlatformDecoder
+    {
+        /// <summary>
+        /// Creates a bitmap of a region of the image from encoded bytes.
+        /// Supports JPEG but callers should use
+        /// DecodeJPEGFromEncodedImage for partial JPEGs.
+        /// </summary>
+        /// <param name="encodedImage">
+        /// The reference to the encoded image with the reference to the
+        /// encoded bytes.
+        /// </param>
+        /// <param name="bitmapConfig">
+        /// The <see cref="BitmapPixelFormat"/> used to create the decoded
+        /// SoftwareBitmap.
+        /// </param>
+        /// <param name="cropOptions">
+        /// Region of the image to decode, null to decode all of it.
+        /// </param>
+        /// <returns>The bitmap.</returns>
+        /// <exception cref="OutOfMemoryException">
+        /// If the Bitmap cannot be allocated.
+        /// </exception>
+        Task<CloseableReference<SoftwareBitmap>> DecodeFromEncodedImageAsync(
+            EncodedImage encodedImage,
+            BitmapPixelFormat bitmapConfig,
+            CropOptions cropOptions);
+
+        /// <summary>
+        /// Creates a bitmap of a region of the image from encoded JPEG
+        /// bytes. Supports a partial JPEG image.
+        /// </summary>
+        /// <param name="encodedImage">
+        /// The reference to the encoded image with the reference to the
+        /// encoded bytes.
+        /// </param>
+        /// <param name="bitmapConfig">
+        /// The <see cref="BitmapPixelFormat"/> used to create the decoded
+        /// SoftwareBitmap.
+        /// </param>
+        /// <param name="length">
+        /// The number of encoded bytes in the buffer.
+        /// </param>
+        /// <param name="cropOptions">
+        /// Region of the image to decode, null to decode all of it.
+        /// </param>
+        /// <returns>The bitmap.</returns>
+        /// <exception cref="OutOfMemoryException">
+        /// If the Bitmap cannot be allocated.
+        /// </exception>
+        Task<CloseableReference<SoftwareBitmap>> DecodeJPEGFromEncodedImageAsync(
+            EncodedImage encodedImage,
+            BitmapPixelFormat bitmapConfig,
+            int length,
+            CropOptions cropOptions);
+    }
+}
@@ -2,7 +2,9 @@
 using FBCore.Common.References;
 using FBCore.Common.Streams;
 using FBCore.Concurrency;
+using ImagePipeline.Common;
 using ImagePipeline.Image;
+using ImagePipeline.Memory;
 using ImageUtils;
 using System;
 using System.IO;
@@ -14,8 +16,22 @@ namespace ImagePipeline.Platform
     /// <summary>
     /// Bitmap decoder for Windows Runtime.
     /// </summary>
-    public class WinRTDecoder : IPlatformDecoder
+    public class WinRTDecoder : IRegionPlatformDecoder
     {
+        /// <summary>
+        /// EXIF orientation of the frame, 1 to 8.
+        /// </summary>
+        private const string ORIENTATION_PROPERTY = "System.Photo.Orientation";
+
+        private const ushort ORIENTATION_NORMAL = 1;
+        private const ushort ORIENTATION_FLIP_HORIZONTAL = 2;
+        private const ushort ORIENTATION_ROTATE_180 = 3;
+        private const ushort ORIENTATION_FLIP_VERTICAL = 4;
+        private const ushort ORIENTATION_TRANSPOSE = 5;
+        private const ushort ORIENTATION_ROTATE_90 = 6;
+        private const ushort ORIENTATION_TRANSVERSE = 7;
+        private const ushort ORIENTATION_ROTATE_270 = 8;
+
         private IExecutorService _executor;
 
         // TODO (5884402) - remove dependency on JfifUtil
@@ -53,21 +69,56 @@ namespace ImagePipeline.Platform
         public Task<CloseableReference<SoftwareBitmap>> DecodeFromEncodedImageAsync(
             EncodedImage encodedImage, BitmapPixelFormat bitmapConfig)
         {
-            Stream inputStream = encodedImage.GetInputStream();
+            return DecodeFromEncodedImageAsync(encodedImage, bitmapConfig, null);
+        }
+
+        /// <summary>
+        /// Creates a bitmap of a region of the image from encoded bytes.
+        /// Supports JPEG but callers should use DecodeJPEGFromEncodedImage
+        /// for partial JPEGs.
+        /// </summary>
+        /// <param name="encodedImage">
+        /// The reference to the encoded image with the reference to the
+        /// encoded bytes.
+        /// </param>
+        /// <param name="bitmapConfig">
+        /// The <see cref="BitmapPixelFormat"/> used to create the decoded
+        /// SoftwareBitmap.
+        /// </param>
+        /// <param name="cropOptions">
+        /// Region of the image to decode, null to decode all of it.
+        /// </param>
+        /// <returns>The bitmap.</returns>
+        /// <exception cref="OutOfMemoryException">
+        /// If the Bitmap cannot be allocated.
+        /// </exception>
+        public Task<CloseableReference<SoftwareBitmap>> DecodeFromEncodedImageAsync(
+            EncodedImage encodedImage, BitmapPixelFormat bitmapConfig, CropOptions cropOptions)
+        {
+            // The view keeps the encoded bytes alive until decoded, even
+            // if the image is closed meanwhile
+            PooledByteBufferView view = encodedImage.GetByteBufferView();
+            Stream inputStream = (Stream)view ?? encodedImage.GetInputStream();
             Preconditions.CheckNotNull(inputStream);
             return _executor.Execute(async () =>
             {
-                BitmapDecoder decoder = await BitmapDecoder.CreateAsync(
-                    inputStream.AsRandomAccessStream())
-                    .AsTask()
-                    .ConfigureAwait(false);
+                try
+                {
+                    BitmapDecoder decoder = await BitmapDecoder.CreateAsync(
+                        inputStream.AsRandomAccessStream())
+                        .AsTask()
+                        .ConfigureAwait(false);
 
-                SoftwareBitmap bitmap = await decoder
-                    .GetSoftwareBitmapAsync(bitmapConfig, BitmapAlphaMode.Premultiplied)
-                    .AsTask()
-                    .ConfigureAwait(false);
+                    SoftwareBitmap bitmap = await GetSoftwareBitmapAsync(
+                        decoder, bitmapConfig, cropOptions)
+                        .ConfigureAwait(false);
 
-                return CloseableReference<SoftwareBitmap>.of(bitmap);
+                    return CloseableReference<SoftwareBitmap>.of(bitmap);
+                }
+                finally
+                {
+                    Closeables.CloseQuietly(view);
+                }
             })
             .Unwrap();
         }
@@ -93,6 +144,34 @@ namespace ImagePipeline.Platform
         /// </exception>
         public Task<CloseableReference<SoftwareBitmap>> DecodeJPEGFromEncodedImageAsync(
             EncodedImage encodedImage, BitmapPixelFormat bitmapConfig, int length)
+        {
+            return DecodeJPEGFromEncodedImageAsync(encodedImage, bitmapConfig, length, null);
+        }
+
+        /// <summary>
+        /// Creates a bitmap of a region of the image from encoded JPEG
+        /// bytes. Supports a partial JPEG image.
+        /// </summary>
+        /// <param name="encodedImage">
+        /// The reference to the encoded image with the reference to the
+        /// encoded bytes.
+        /// </param>
+        /// <param name="bitmapConfig">
+        /// The <see cref="BitmapPixelFormat"/> used to create the decoded
+        /// SoftwareBitmap.
+        /// </param>
+        /// <param name="length">
+        /// The number of encoded bytes in the buffer.
+        /// </param>
+        /// <param name="cropOptions">
+        /// Region of the image to decode, null to decode all of it.
+        /// </param>
+        /// <returns>The bitmap.</returns>
+        /// <exception cref="OutOfMemoryException">
+        /// If the Bitmap cannot be allocated.
+        /// </exception>
+        public Task<CloseableReference<SoftwareBitmap>> DecodeJPEGFromEncodedImageAsync(
+            EncodedImage encodedImage, BitmapPixelFormat bitmapConfig, int length, CropOptions cropOptions)
         {
             return _executor.Execute(async () =>
             {
@@ -119,14 +198,147 @@ namespace ImagePipeline.Platform
                     .AsTask()
                     .ConfigureAwait(false);
 
-                SoftwareBitmap bitmap = await decoder
-                    .GetSoftwareBitmapAsync(bitmapConfig, BitmapAlphaMode.Premultiplied)
-                    .AsTask()
+                SoftwareBitmap bitmap = await GetSoftwareBitmapAsync(
+                    decoder, bitmapConfig, cropOptions)
                     .ConfigureAwait(false);
 
                 return CloseableReference<SoftwareBitmap>.of(bitmap);
             })
             .Unwrap();
         }
+
+        /// <summary>
+        /// Decodes the frame, limited to the crop region if there is one.
+        ///
+        /// <para />The EXIF orientation is applied with or without a crop
+        /// region. The region is in pixels of the encoded image, so it is
+        /// oriented the same way before being applied.
+        /// </summary>
+        private static async Task<SoftwareBitmap> GetSoftwareBitmapAsync(
+            BitmapDecoder decoder,
+            BitmapPixelFormat bitmapConfig,
+            CropOptions cropOptions)
+        {
+            if (cropOptions == null)
+            {
+                return await decoder
+                    .GetSoftwareBitmapAsync(bitmapConfig, BitmapAlphaMode.Premultiplied)
+                    .AsTask()
+                    .ConfigureAwait(false);
+            }
+
+            ushort orientation = await GetOrientationAsync(decoder).ConfigureAwait(false);
+            BitmapTransform transform = new BitmapTransform();
+            transform.Bounds = GetOrientedBounds(
+                cropOptions, decoder.PixelWidth, decoder.PixelHeight, orientation);
+
+            return await decoder
+                .GetSoftwareBitmapAsync(
+                    bitmapConfig,
+                    BitmapAlphaMode.Premultiplied,
+                    transform,
+                    ExifOrientationMode.RespectExifOrientation,
+                    ColorManagementMode.DoNotColorManage)
+                .AsTask()
+                .ConfigureAwait(false);
+        }
+
+        /// <summary>
+        /// Gets the EXIF orientation of the frame, formats without one
+        /// are not oriented.
+        /// </summary>
+        private static async Task<ushort> GetOrientationAsync(BitmapDecoder decoder)
+        {
+            try
+            {
+                BitmapPropertySet properties = await decoder.BitmapProperties
+                    .GetPropertiesAsync(new[] { ORIENTATION_PROPERTY })
+                    .AsTask()
+                    .ConfigureAwait(false);
+
+                BitmapTypedValue value;
+                if (properties.TryGetValue(ORIENTATION_PROPERTY, out value) &&
+                    value.Type == Windows.Foundation.PropertyType.UInt16)
+                {
+                    return (ushort)value.Value;
+                }
+            }
+            catch (Exception)
+            {
+                // Formats without metadata don't support the query
+            }
+
+            return ORIENTATION_NORMAL;
+        }
+
+        /// <summary>
+        /// Maps the crop region, in pixels of the encoded image, to the
+        /// image as displayed with the given EXIF orientation.
+        /// </summary>
+        /// <param name="cropOptions">The crop region.</param>
+        /// <param name="width">Width of the encoded image.</param>
+        /// <param name="height">Height of the encoded image.</param>
+        /// <param name="orientation">EXIF orientation, 1 to 8.</param>
+        /// <returns>
+        /// The region clipped to the image, in oriented pixels.
+        /// </returns>
+        internal static BitmapBounds GetOrientedBounds(
+            CropOptions cropOptions,
+            uint width,
+            uint height,
+            ushort orientation)
+        {
+            if (cropOptions.X >= width || cropOptions.Y >= height)
+            {
+                throw new ArgumentException("Crop region is outside of the image");
+            }
+
+            uint x = (uint)cropOptions.X;
+            uint y = (uint)cropOptions.Y;
+            uint cropWidth = Math.Min((uint)cropOptions.Width, width - x);
+            uint cropHeight = Math.Min((uint)cropOptions.Height, height - y);
+
+            // Offsets of the region from the right and bottom edges
+            uint right = width - x - cropWidth;
+            uint bottom = height - y - cropHeight;
+
+            switch (orientation)
+            {
+                case ORIENTATION_FLIP_HORIZONTAL:
+                    return CreateBounds(right, y, cropWidth, cropHeight);
+
+                case ORIENTATION_ROTATE_180:
+                    return CreateBounds(right, bottom, cropWidth, cropHeight);
+
+                case ORIENTATION_FLIP_VERTICAL:
+                    return CreateBounds(x, bottom, cropWidth, cropHeight);
+
+                case ORIENTATION_TRANSPOSE:
+                    return CreateBounds(y, x, cropHeight, cropWidth);
+
+                case ORIENTATION_ROTATE_90:
+                    return CreateBounds(bottom, x, cropHeight, cropWidth);
+
+                case ORIENTATION_TRANSVERSE:
+                    return CreateBounds(bottom, right, cropHeight, cropWidth);
+
+                case ORIENTATION_ROTATE_270:
+                    return CreateBounds(y, right, cropHeight, cropWidth);
+
+                default:
+                    return CreateBounds(x, y, cropWidth, cropHeight);
+            }
+        }
+
+        private static BitmapBounds CreateBounds(uint x, uint y, uint width, uint height)
+        {
+            return new BitmapBounds()
+            {
+                X = x,
+                Y = y,
+                Width = width,
+                Height = height
+            };
+        }
     }
 }
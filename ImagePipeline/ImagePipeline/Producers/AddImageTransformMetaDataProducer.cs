@@ -12,14 +12,22 @@ namespace ImagePipeline.Producers
     public class AddImageTransformMetaDataProducer : IProducer<EncodedImage>
     {
         private readonly IProducer<EncodedImage> _inputProducer;
+        private readonly IImageMetaDataParser _imageMetaDataParser;
 
         /// <summary>
         /// Instantiates the <see cref="AddImageTransformMetaDataProducer"/>.
         /// </summary>
         /// <param name="inputProducer">The input producer.</param>
-        public AddImageTransformMetaDataProducer(IProducer<EncodedImage> inputProducer)
+        /// <param name="imageMetaDataParser">
+        /// Parser reading the meta data of the encoded images, null to
+        /// read it from their streams.
+        /// </param>
+        public AddImageTransformMetaDataProducer(
+            IProducer<EncodedImage> inputProducer,
+            IImageMetaDataParser imageMetaDataParser)
         {
             _inputProducer = inputProducer;
+            _imageMetaDataParser = imageMetaDataParser;
         }
 
         /// <summary>
@@ -29,14 +37,19 @@ namespace ImagePipeline.Producers
         /// </summary>
         public void ProduceResults(IConsumer<EncodedImage> consumer, IProducerContext context)
         {
-            _inputProducer.ProduceResults(new AddImageTransformMetaDataConsumer(consumer), context);
+            _inputProducer.ProduceResults(
+                new AddImageTransformMetaDataConsumer(consumer, _imageMetaDataParser), context);
         }
 
         private class AddImageTransformMetaDataConsumer : DelegatingConsumer<EncodedImage, EncodedImage>
         {
-            internal AddImageTransformMetaDataConsumer(IConsumer<EncodedImage> consumer) :
-                base(consumer)
+            private readonly IImageMetaDataParser _imageMetaDataParser;
+
+            internal AddImageTransformMetaDataConsumer(
+                IConsumer<EncodedImage> consumer,
+                IImageMetaDataParser imageMetaDataParser) : base(consumer)
             {
+                _imageMetaDataParser = imageMetaDataParser;
             }
 
             protected override void OnNewResultImpl(EncodedImage newResult, bool isLast)
@@ -49,7 +62,7 @@ namespace ImagePipeline.Producers
 
                 if (!EncodedImage.IsMetaDataAvailable(newResult))
                 {
-                    newResult.ParseMetaDataAsync().Wait();
+                    newResult.ParseMetaDataAsync(_imageMetaDataParser).Wait();
                 }
 
                 Consumer.OnNewResult(newResult, isLast);
@@ -34,10 +34,16 @@ namespace ImagePipeline.Producers
         /// <summary>
         /// Instantiates the <see cref="DataFetchProducer"/>.
         /// </summary>
+        /// <param name="imageMetaDataParser">
+        /// Parser reading the meta data of the encoded images, null to
+        /// read it from their streams.
+        /// </param>
         public DataFetchProducer(
-            IPooledByteBufferFactory pooledByteBufferFactory) : base(
+            IPooledByteBufferFactory pooledByteBufferFactory,
+            IImageMetaDataParser imageMetaDataParser) : base(
                 CallerThreadExecutor.Instance,
-                pooledByteBufferFactory)
+                pooledByteBufferFactory,
+                imageMetaDataParser)
         {
         }
 
@@ -252,13 +252,23 @@ namespace ImagePipeline.Producers
 
                     IQualityInfo quality = isLast ? ImmutableQualityInfo.FULL_QUALITY : GetQualityInfo();
 
+                    // Crop here unless ResizeAndRotateProducer already did
+                    CropOptions cropOptions = encodedImage.IsCropped ?
+                        null : _producerContext.ImageRequest.CropOptions;
+
                     _producerListener.OnProducerStart(_producerContext.Id, PRODUCER_NAME);
                     CloseableImage image = null;
 
                     try
                     {
                         image = await _parent._imageDecoder
-                            .DecodeImageAsync(encodedImage, length, quality, _imageDecodeOptions)
+                            .DecodeImageAsync(
+                                encodedImage,
+                                length,
+                                quality,
+                                _imageDecodeOptions,
+                                cropOptions,
+                                _producerContext.ImageRequest.ResizeOptions)
                             .ConfigureAwait(false);
                     }
                     catch (Exception e)
@@ -301,10 +311,20 @@ namespace ImagePipeline.Producers
                 string qualityStr = quality.IsOfGoodEnoughQuality.ToString();
                 string finalStr = isFinal.ToString();
                 string cacheChoiceStr = _producerContext.ImageRequest.CacheChoice.ToString();
-                if (image.GetType() == typeof(CloseableStaticBitmap))
+                string sizeStr = null;
+                if (image != null && image.GetType() == typeof(CloseableStaticBitmap))
                 {
                     SoftwareBitmap bitmap = ((CloseableStaticBitmap)image).UnderlyingBitmap;
-                    string sizeStr = bitmap.PixelWidth + "x" + bitmap.PixelHeight;
+                    sizeStr = bitmap.PixelWidth + "x" + bitmap.PixelHeight;
+                }
+                else if (image != null && image.GetType() == typeof(CloseableAnimatedImage))
+                {
+                    // Frames are rendered on demand, report the canvas
+                    sizeStr = image.Width + "x" + image.Height;
+                }
+
+                if (sizeStr != null)
+                {
                     var extraMap = new Dictionary<string, string>()
                     {
                         {  BITMAP_SIZE_KEY, sizeStr },
@@ -476,6 +496,13 @@ namespace ImagePipeline.Producers
                     bool ret = base.UpdateDecodeJob(encodedImage, isLast);
                     if (!isLast && EncodedImage.IsValid(encodedImage))
                     {
+                        // A baseline jpeg has no scan to show before it is
+                        // complete, skip scanning its data for one.
+                        if (encodedImage.IsProgressive == TriState.NO)
+                        {
+                            return false;
+                        }
+
                         if (!_progressiveJpegParser.ParseMoreData(encodedImage))
                         {
                             return false;
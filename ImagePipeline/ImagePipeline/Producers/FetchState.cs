@@ -1,4 +1,5 @@
-﻿using ImagePipeline.Image;
+﻿using FBCore.Common.Util;
+using ImagePipeline.Image;
 using System;
 
 namespace ImagePipeline.Producers
@@ -15,6 +16,7 @@ namespace ImagePipeline.Producers
         private readonly IConsumer<EncodedImage> _consumer;
         private readonly IProducerContext _context;
         private long _lastIntermediateResultTimeMs;
+        private TriState _shouldStreamTranscode;
 
         /// <summary>
         /// Instantiates the <see cref="FetchState"/>.
@@ -26,6 +28,7 @@ namespace ImagePipeline.Producers
             _consumer = consumer;
             _context = context;
             _lastIntermediateResultTimeMs = 0;
+            _shouldStreamTranscode = TriState.UNSET;
         }
 
         /// <summary>
@@ -97,5 +100,21 @@ namespace ImagePipeline.Producers
                 _lastIntermediateResultTimeMs = value;
             }
         }
+
+        /// <summary>
+        /// Gets and sets whether the image is transcoded while it
+        /// downloads, unset until its header has been downloaded.
+        /// </summary>
+        public TriState ShouldStreamTranscode
+        {
+            get
+            {
+                return _shouldStreamTranscode;
+            }
+            set
+            {
+                _shouldStreamTranscode = value;
+            }
+        }
     }
 }
@@ -20,11 +20,17 @@ namespace ImagePipeline.Producers
         /// <summary>
         /// Instantiates the <see cref="FutureAccessListFetchProducer"/>.
         /// </summary>
+        /// <param name="imageMetaDataParser">
+        /// Parser reading the meta data of the encoded images, null to
+        /// read it from their streams.
+        /// </param>
         public FutureAccessListFetchProducer(
             IExecutorService executor,
-            IPooledByteBufferFactory pooledByteBufferFactory) : base(
+            IPooledByteBufferFactory pooledByteBufferFactory,
+            IImageMetaDataParser imageMetaDataParser) : base(
                 executor,
-                pooledByteBufferFactory)
+                pooledByteBufferFactory,
+                imageMetaDataParser)
         {
         }
 
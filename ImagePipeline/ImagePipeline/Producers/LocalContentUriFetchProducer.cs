@@ -17,11 +17,17 @@ namespace ImagePipeline.Producers
         /// <summary>
         /// Instantiates the <see cref="LocalContentUriFetchProducer"/>.
         /// </summary>
+        /// <param name="imageMetaDataParser">
+        /// Parser reading the meta data of the encoded images, null to
+        /// read it from their streams.
+        /// </param>
         public LocalContentUriFetchProducer(
             IExecutorService executor,
-            IPooledByteBufferFactory pooledByteBufferFactory) : base(
+            IPooledByteBufferFactory pooledByteBufferFactory,
+            IImageMetaDataParser imageMetaDataParser) : base(
                 executor,
-                pooledByteBufferFactory)
+                pooledByteBufferFactory,
+                imageMetaDataParser)
         {
         }
 
@@ -19,11 +19,17 @@ namespace ImagePipeline.Producers
         /// <summary>
         /// Instantiates the <see cref="LocalContentUriThumbnailFetchProducer"/>.
         /// </summary>
+        /// <param name="imageMetaDataParser">
+        /// Parser reading the meta data of the encoded images, null to
+        /// read it from their streams.
+        /// </param>
         public LocalContentUriThumbnailFetchProducer(
             IExecutorService executor,
-            IPooledByteBufferFactory pooledByteBufferFactory) : base(
+            IPooledByteBufferFactory pooledByteBufferFactory,
+            IImageMetaDataParser imageMetaDataParser) : base(
                 executor,
-                pooledByteBufferFactory)
+                pooledByteBufferFactory,
+                imageMetaDataParser)
         {
         }
 
@@ -1,9 +1,11 @@
 ﻿using FBCore.Common.References;
+using FBCore.Common.Streams;
 using FBCore.Concurrency;
 using ImageFormatUtils;
 using ImagePipeline.Common;
 using ImagePipeline.Image;
 using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
 using ImagePipeline.Request;
 using ImageUtils;
 using System;
@@ -19,8 +21,9 @@ namespace ImagePipeline.Producers
     /// <summary>
     /// A producer that retrieves exif thumbnails.
     ///
-    /// <para />At present, these thumbnails are retrieved on the managed
-    /// memory before being put into native memory.
+    /// <para />With a native buffer factory, the thumbnail is read in
+    /// place from the first 64 KB of the file. Otherwise, it is retrieved
+    /// on the managed memory before being put into native memory.
     /// </summary>
     public class LocalExifThumbnailProducer : IThumbnailProducer<EncodedImage>
     {
@@ -114,6 +117,12 @@ namespace ImagePipeline.Producers
 
                         using (var fileStream = await file.OpenReadAsync().AsTask().ConfigureAwait(false))
                         {
+                            EncodedImage embeddedThumbnail = GetEmbeddedThumbnail(fileStream);
+                            if (embeddedThumbnail != null)
+                            {
+                                return embeddedThumbnail;
+                            }
+
                             byte[] bytes = await BitmapUtil
                                 .GetThumbnailAsync(fileStream)
                                 .ConfigureAwait(false);
@@ -146,6 +155,33 @@ namespace ImagePipeline.Producers
             _executor.Execute(cancellableProducerRunnable.Runnable);
         }
 
+        /// <summary>
+        /// Reads the EXIF data at the beginning of the file into native
+        /// memory and returns the thumbnail it embeds, without decoding.
+        /// </summary>
+        /// <returns>
+        /// The thumbnail, or null if the buffer factory is not native or
+        /// there is no thumbnail.
+        /// </returns>
+        private EncodedImage GetEmbeddedThumbnail(IRandomAccessStream fileStream)
+        {
+            if (!(_pooledByteBufferFactory is NativePooledByteBufferFactory))
+            {
+                return null;
+            }
+
+            int length = (int)Math.Min(
+                fileStream.Size, ExifThumbnailExtractor.EXIF_SEARCH_LENGTH);
+
+            using (var inputStream = new LimitedInputStream(
+                fileStream.GetInputStreamAt(0).AsStreamForRead(), length))
+            using (IPooledByteBuffer header = _pooledByteBufferFactory.NewByteBuffer(
+                inputStream, length))
+            {
+                return ExifThumbnailExtractor.GetThumbnail(header);
+            }
+        }
+
         private async Task<EncodedImage> BuildEncodedImage(
             IPooledByteBuffer imageBytes,
             IRandomAccessStream imageStream)
@@ -16,16 +16,23 @@ namespace ImagePipeline.Producers
     {
         private readonly IExecutorService _executor;
         private readonly IPooledByteBufferFactory _pooledByteBufferFactory;
+        private readonly IImageMetaDataParser _imageMetaDataParser;
 
         /// <summary>
         /// Instantiates the <see cref="LocalFetchProducer"/>.
         /// </summary>
+        /// <param name="imageMetaDataParser">
+        /// Parser reading the meta data of the encoded images, null to
+        /// read it from their streams.
+        /// </param>
         protected LocalFetchProducer(
             IExecutorService executor,
-            IPooledByteBufferFactory pooledByteBufferFactory)
+            IPooledByteBufferFactory pooledByteBufferFactory,
+            IImageMetaDataParser imageMetaDataParser)
         {
             _executor = executor;
             _pooledByteBufferFactory = pooledByteBufferFactory;
+            _imageMetaDataParser = imageMetaDataParser;
         }
 
         /// <summary>
@@ -66,7 +73,8 @@ namespace ImagePipeline.Producers
                             return null;
                         }
 
-                        await encodedImage.ParseMetaDataAsync().ConfigureAwait(false);
+                        await encodedImage.ParseMetaDataAsync(_imageMetaDataParser)
+                            .ConfigureAwait(false);
                         return encodedImage;
                     });
 
@@ -3,6 +3,7 @@ using FBCore.Common.Time;
 using FBCore.Common.Util;
 using ImagePipeline.Image;
 using ImagePipeline.Memory;
+using ImagePipeline.Request;
 using System;
 using System.Collections.Generic;
 using System.IO;
@@ -48,6 +49,8 @@ namespace ImagePipeline.Producers
         private readonly IPooledByteBufferFactory _pooledByteBufferFactory;
         private readonly IByteArrayPool _byteArrayPool;
         private readonly INetworkFetcher<FetchState> _networkFetcher;
+        private readonly bool _streamingTranscodeEnabled;
+        private readonly IImageMetaDataParser _imageMetaDataParser;
 
         /// <summary>
         /// Instantiates the <see cref="NetworkFetchProducer"/>.
@@ -55,11 +58,38 @@ namespace ImagePipeline.Producers
         public NetworkFetchProducer(
             IPooledByteBufferFactory pooledByteBufferFactory,
             IByteArrayPool byteArrayPool,
-            INetworkFetcher<FetchState> networkFetcher)
+            INetworkFetcher<FetchState> networkFetcher) : this(
+                pooledByteBufferFactory,
+                byteArrayPool,
+                networkFetcher,
+                false,
+                null)
+        {
+        }
+
+        /// <summary>
+        /// Instantiates the <see cref="NetworkFetchProducer"/>.
+        ///
+        /// <para />If streamingTranscodeEnabled is true, partial results
+        /// that <see cref="ResizeAndRotateProducer"/> transcodes while they
+        /// download are propagated even without progressive rendering.
+        /// </summary>
+        /// <param name="imageMetaDataParser">
+        /// Parser reading the meta data of the encoded images, null to
+        /// read it from their streams.
+        /// </param>
+        public NetworkFetchProducer(
+            IPooledByteBufferFactory pooledByteBufferFactory,
+            IByteArrayPool byteArrayPool,
+            INetworkFetcher<FetchState> networkFetcher,
+            bool streamingTranscodeEnabled,
+            IImageMetaDataParser imageMetaDataParser)
         {
             _pooledByteBufferFactory = pooledByteBufferFactory;
             _byteArrayPool = byteArrayPool;
             _networkFetcher = networkFetcher;
+            _streamingTranscodeEnabled = streamingTranscodeEnabled;
+            _imageMetaDataParser = imageMetaDataParser;
         }
 
         /// <summary>
@@ -157,9 +187,7 @@ namespace ImagePipeline.Producers
                 nowMs - fetchState.LastIntermediateResultTimeMs >= TIME_BETWEEN_PARTIAL_RESULTS_MS)
             {
                 fetchState.LastIntermediateResultTimeMs = nowMs;
-                fetchState.Listener.OnProducerEvent(
-                    fetchState.Id, PRODUCER_NAME, INTERMEDIATE_RESULT_PRODUCER_EVENT);
-                NotifyConsumer(pooledOutputStream, false, fetchState.Consumer);
+                NotifyConsumer(pooledOutputStream, false, fetchState);
             }
         }
 
@@ -169,13 +197,13 @@ namespace ImagePipeline.Producers
         {
             IDictionary<string, string> extraMap = GetExtraMap(fetchState, pooledOutputStream.Size);
             fetchState.Listener.OnProducerFinishWithSuccess(fetchState.Id, PRODUCER_NAME, extraMap);
-            NotifyConsumer(pooledOutputStream, true, fetchState.Consumer);
+            NotifyConsumer(pooledOutputStream, true, fetchState);
         }
 
         private void NotifyConsumer(
             PooledByteBufferOutputStream pooledOutputStream,
             bool isFinal,
-            IConsumer<EncodedImage> consumer)
+            FetchState fetchState)
         {
             CloseableReference<IPooledByteBuffer> result = 
                 CloseableReference<IPooledByteBuffer>.of(pooledOutputStream.ToByteBuffer());
@@ -185,8 +213,19 @@ namespace ImagePipeline.Producers
             try
             {
                 encodedImage = new EncodedImage(result);
-                encodedImage.ParseMetaDataAsync().Wait();
-                consumer.OnNewResult(encodedImage, isFinal);
+                encodedImage.ParseMetaDataAsync(_imageMetaDataParser).Wait();
+                if (!isFinal)
+                {
+                    if (!ShouldPropagateIntermediateResult(fetchState, encodedImage))
+                    {
+                        return;
+                    }
+
+                    fetchState.Listener.OnProducerEvent(
+                        fetchState.Id, PRODUCER_NAME, INTERMEDIATE_RESULT_PRODUCER_EVENT);
+                }
+
+                fetchState.Consumer.OnNewResult(encodedImage, isFinal);
             }
             finally
             {
@@ -209,7 +248,9 @@ namespace ImagePipeline.Producers
 
         private bool ShouldPropagateIntermediateResults(FetchState fetchState)
         {
-            if (!fetchState.Context.ImageRequest.IsProgressiveRenderingEnabled)
+            ImageRequest imageRequest = fetchState.Context.ImageRequest;
+            if (!imageRequest.IsProgressiveRenderingEnabled &&
+                !(_streamingTranscodeEnabled && fetchState.ShouldStreamTranscode != TriState.NO))
             {
                 return false;
             }
@@ -217,6 +258,27 @@ namespace ImagePipeline.Producers
             return _networkFetcher.ShouldPropagate(fetchState);
         }
 
+        /// <summary>
+        /// Without progressive rendering, intermediate results are only
+        /// propagated once the header shows that they will be transcoded
+        /// while the image downloads.
+        /// </summary>
+        private static bool ShouldPropagateIntermediateResult(
+            FetchState fetchState,
+            EncodedImage encodedImage)
+        {
+            ImageRequest imageRequest = fetchState.Context.ImageRequest;
+            if (imageRequest.IsProgressiveRenderingEnabled)
+            {
+                return true;
+            }
+
+            fetchState.ShouldStreamTranscode = ResizeAndRotateProducer.ShouldStreamTranscode(
+                imageRequest, encodedImage);
+
+            return fetchState.ShouldStreamTranscode == TriState.YES;
+        }
+
         private IDictionary<string, string> GetExtraMap(FetchState fetchState, int byteSize)
         {
             if (!fetchState.Listener.RequiresExtraMap(fetchState.Id))
@@ -291,8 +291,18 @@ namespace ImagePipeline.Producers
                 return new ReadOnlyDictionary<string, string>(extraMap);
             }
 
+            /// <summary>
+            /// Postprocessors work on a single bitmap. Animated images are
+            /// passed through untouched rather than flattened to one of
+            /// their frames.
+            /// </summary>
             private bool ShouldPostprocess(CloseableImage sourceImage)
             {
+                if (sourceImage.GetType() == typeof(CloseableAnimatedImage))
+                {
+                    return false;
+                }
+
                 return (sourceImage.GetType() == typeof(CloseableStaticBitmap));
             }
 
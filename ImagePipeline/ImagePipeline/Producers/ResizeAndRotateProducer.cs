@@ -32,12 +32,15 @@ namespace ImagePipeline.Producers
         internal const int DEFAULT_JPEG_QUALITY = 85;
         internal const int MAX_JPEG_SCALE_NUMERATOR = JpegTranscoder.SCALE_DENOMINATOR;
         internal const int MIN_TRANSFORM_INTERVAL_MS = 100;
+        internal const int MIN_STREAMING_OUTPUT_CAPACITY = 64 * ByteConstants.KB;
 
         internal const float ROUNDUP_FRACTION = 2.0f / 3;
 
         private readonly IExecutorService _executor;
         private readonly IPooledByteBufferFactory _pooledByteBufferFactory;
         private readonly IProducer<EncodedImage> _inputProducer;
+        private readonly JpegEncodeOptions _encodeOptions;
+        private readonly IImageMetaDataParser _imageMetaDataParser;
 
         /// <summary>
         /// Instantiates the <see cref="ResizeAndRotateProducer"/>.
@@ -45,11 +48,35 @@ namespace ImagePipeline.Producers
         public ResizeAndRotateProducer(
             IExecutorService executor,
             IPooledByteBufferFactory pooledByteBufferFactory,
-            IProducer<EncodedImage> inputProducer)
+            IProducer<EncodedImage> inputProducer) : this(
+                executor,
+                pooledByteBufferFactory,
+                inputProducer,
+                new JpegEncodeOptions(DEFAULT_JPEG_QUALITY),
+                null)
+        {
+        }
+
+        /// <summary>
+        /// Instantiates the <see cref="ResizeAndRotateProducer"/>
+        /// encoding transformed images with given options.
+        /// </summary>
+        /// <param name="imageMetaDataParser">
+        /// Parser reading the meta data of the encoded images, null to
+        /// read it from their streams.
+        /// </param>
+        public ResizeAndRotateProducer(
+            IExecutorService executor,
+            IPooledByteBufferFactory pooledByteBufferFactory,
+            IProducer<EncodedImage> inputProducer,
+            JpegEncodeOptions encodeOptions,
+            IImageMetaDataParser imageMetaDataParser)
         {
             _executor = Preconditions.CheckNotNull(executor);
             _pooledByteBufferFactory = Preconditions.CheckNotNull(pooledByteBufferFactory);
             _inputProducer = Preconditions.CheckNotNull(inputProducer);
+            _encodeOptions = Preconditions.CheckNotNull(encodeOptions);
+            _imageMetaDataParser = imageMetaDataParser;
         }
 
         /// <summary>
@@ -62,6 +89,76 @@ namespace ImagePipeline.Producers
             _inputProducer.ProduceResults(new TransformingConsumer(this, consumer, context), context);
         }
 
+        /// <summary>
+        /// Computes the ratio an image of the given size is scaled by to
+        /// cover the requested size, capped by the maximum bitmap size.
+        /// </summary>
+        internal static float DetermineResizeRatio(
+            ResizeOptions resizeOptions,
+            int width,
+            int height)
+        {
+
+            if (resizeOptions == null)
+            {
+                return 1.0f;
+            }
+
+            float widthRatio = ((float)resizeOptions.Width) / width;
+            float heightRatio = ((float)resizeOptions.Height) / height;
+            float ratio = Math.Max(widthRatio, heightRatio);
+
+            // TODO: The limit is larger than this on newer devices.
+            if (width * ratio > BitmapUtil.MAX_BITMAP_SIZE)
+            {
+                ratio = BitmapUtil.MAX_BITMAP_SIZE / width;
+            }
+
+            if (height * ratio > BitmapUtil.MAX_BITMAP_SIZE)
+            {
+                ratio = BitmapUtil.MAX_BITMAP_SIZE / height;
+            }
+
+            return ratio;
+        }
+
+        /// <summary>
+        /// Whether an intermediate result of the request is transcoded
+        /// while the image downloads, without progressive rendering.
+        /// </summary>
+        /// <returns>
+        /// UNSET until the frame header of the image has been downloaded.
+        /// </returns>
+        internal static TriState ShouldStreamTranscode(
+            ImageRequest imageRequest,
+            EncodedImage encodedImage)
+        {
+#if HAS_LIBJPEGTURBO
+            if (imageRequest.ResizeOptions == null ||
+                imageRequest.CropOptions != null ||
+                (encodedImage.Format != ImageFormat.UNKNOWN &&
+                    encodedImage.Format != ImageFormat.JPEG))
+            {
+                return TriState.NO;
+            }
+
+            if (encodedImage.Width <= 0 || encodedImage.Height <= 0)
+            {
+                return TriState.UNSET;
+            }
+
+            // Rotation needs the whole image
+            if (TransformingConsumer.GetRotationAngle(imageRequest, encodedImage) != 0)
+            {
+                return TriState.NO;
+            }
+
+            return TransformingConsumer.ShouldTransform(imageRequest, encodedImage);
+#else // HAS_LIBJPEGTURBO
+            return TriState.NO;
+#endif // HAS_LIBJPEGTURBO
+        }
+
         private class TransformingConsumer : DelegatingConsumer<EncodedImage, EncodedImage> 
         {
             private readonly ResizeAndRotateProducer _parent;
@@ -70,6 +167,14 @@ namespace ImagePipeline.Producers
 
             private readonly JobScheduler _jobScheduler;
 
+#if HAS_LIBJPEGTURBO
+            private readonly object _streamingGate = new object();
+            private JpegStreamingTranscode _streamingTranscode;
+            private int _streamingScaleNumerator;
+            private ResizeOptions _streamingTargetSize;
+            private bool _streamingDisabled;
+#endif // HAS_LIBJPEGTURBO
+
             /// <summary>
             /// Instantiates the <see cref="TransformingConsumer"/>.
             /// </summary>
@@ -97,6 +202,9 @@ namespace ImagePipeline.Producers
                         {
                             _jobScheduler.ClearJob();
                             _isCancelled = true;
+#if HAS_LIBJPEGTURBO
+                            CancelStreamingTranscode();
+#endif // HAS_LIBJPEGTURBO
 
                             // This only works if it is safe to discard the output of 
                             // previous producer
@@ -148,6 +256,17 @@ namespace ImagePipeline.Producers
                     return;
                 }
 
+#if HAS_LIBJPEGTURBO
+                // Without progressive rendering, intermediate results to
+                // transform are only propagated to be transcoded while they
+                // download.
+                if (!isLast && !_producerContext.ImageRequest.IsProgressiveRenderingEnabled)
+                {
+                    StreamIntermediateResult(newResult);
+                    return;
+                }
+#endif // HAS_LIBJPEGTURBO
+
                 // We know that the result should be transformed, hence schedule it
                 if (!_jobScheduler.UpdateJob(newResult, isLast))
                 {
@@ -164,40 +283,114 @@ namespace ImagePipeline.Producers
             {
                 _producerContext.Listener.OnProducerStart(_producerContext.Id, PRODUCER_NAME);
                 ImageRequest imageRequest = _producerContext.ImageRequest;
-                PooledByteBufferOutputStream outputStream = 
-                    _parent._pooledByteBufferFactory.NewOutputStream();
+                PooledByteBufferOutputStream outputStream = default(PooledByteBufferOutputStream);
 
                 IDictionary<string, string> extraMap = default(IDictionary<string, string>);
                 EncodedImage ret = default(EncodedImage);
                 Stream inputStream = default(Stream);
+                CloseableReference<IPooledByteBuffer> inputBufferRef = default(CloseableReference<IPooledByteBuffer>);
+#if HAS_LIBJPEGTURBO
+                JpegStreamingTranscode streamingTranscode = TakeStreamingTranscode();
+#endif // HAS_LIBJPEGTURBO
 
                 try
                 {
                     int numerator = GetScaleNumerator(imageRequest, encodedImage);
                     extraMap = GetExtraMap(encodedImage, imageRequest, numerator);
-                    inputStream = encodedImage.GetInputStream();
+                    IPooledByteBuffer outputBuffer = default(IPooledByteBuffer);
+                    CropOptions cropOptions = default(CropOptions);
 #if HAS_LIBJPEGTURBO
-                    JpegTranscoder.TranscodeJpeg(
-                        inputStream.AsIStream(),
-                        outputStream.AsIStream(),
+                    cropOptions = imageRequest.CropOptions;
+                    ResizeOptions targetSize = GetTargetSize(imageRequest, encodedImage);
+                    JpegTranscodeOptions transcodeOptions = new JpegTranscodeOptions(
                         GetRotationAngle(imageRequest, encodedImage),
                         numerator,
-                        DEFAULT_JPEG_QUALITY);
+                        cropOptions,
+                        targetSize,
+                        _parent._encodeOptions);
+
+                    // Native buffers are handed to the transcoder in place,
+                    // everything else goes through the stream adapters.
+                    inputBufferRef = encodedImage.GetByteBufferRef();
+                    NativePooledByteBuffer nativeBuffer = (inputBufferRef != null) ?
+                        inputBufferRef.Get() as NativePooledByteBuffer : null;
+
+                    NativePooledByteBufferFactory nativeFactory =
+                        _parent._pooledByteBufferFactory as NativePooledByteBufferFactory;
+
+                    if (nativeBuffer != null && nativeFactory != null)
+                    {
+                        if (streamingTranscode != null)
+                        {
+                            // Most of the image was transcoded while it
+                            // downloaded.
+                            outputBuffer = await FinishStreamingTranscodeAsync(
+                                streamingTranscode,
+                                nativeBuffer,
+                                numerator,
+                                targetSize,
+                                _streamingScaleNumerator,
+                                _streamingTargetSize).ConfigureAwait(false);
+                        }
+
+                        if (outputBuffer == null)
+                        {
+                            // The output is encoded straight into pooled
+                            // chunks on the native worker pool,
+                            // inputBufferRef keeps the source alive until the
+                            // transcode completes.
+                            JpegTranscodeRequest request = new JpegTranscodeRequest(
+                                nativeBuffer.GetNativePtr(),
+                                nativeBuffer.Size,
+                                transcodeOptions);
+
+                            outputBuffer = await JpegTranscodeQueue
+                                .TranscodeJpegToByteBufferAsync(request, nativeFactory.Pool)
+                                .ConfigureAwait(false);
+                        }
+                    }
+                    else if (nativeBuffer != null)
+                    {
+                        outputStream = _parent._pooledByteBufferFactory.NewOutputStream();
+                        JpegTranscoder.TranscodeJpegFromMemory(
+                            nativeBuffer.GetNativePtr(),
+                            nativeBuffer.Size,
+                            outputStream.AsIStream(),
+                            transcodeOptions);
+                    }
+                    else
+                    {
+                        outputStream = _parent._pooledByteBufferFactory.NewOutputStream();
+                        inputStream = encodedImage.GetInputStream();
+                        JpegTranscoder.TranscodeJpeg(
+                            inputStream.AsIStream(),
+                            outputStream.AsIStream(),
+                            transcodeOptions);
+                    }
 #else // HAS_LIBJPEGTURBO
+                    outputStream = _parent._pooledByteBufferFactory.NewOutputStream();
+                    inputStream = encodedImage.GetInputStream();
                     inputStream.CopyTo(outputStream);
 #endif // HAS_LIBJPEGTURBO
 
+                    if (outputBuffer == null)
+                    {
+                        outputBuffer = outputStream.ToByteBuffer();
+                    }
+
                     CloseableReference<IPooledByteBuffer> reference =
-                           CloseableReference<IPooledByteBuffer>.of(outputStream.ToByteBuffer());
+                           CloseableReference<IPooledByteBuffer>.of(outputBuffer);
 
                     try
                     {
                         ret = new EncodedImage(reference);
                         ret.Format = ImageFormat.JPEG;
+                        ret.IsCropped = cropOptions != null;
 
                         try
                         {
-                            await ret.ParseMetaDataAsync().ConfigureAwait(false);
+                            await ret.ParseMetaDataAsync(_parent._imageMetaDataParser)
+                                .ConfigureAwait(false);
                             _producerContext.Listener.OnProducerFinishWithSuccess(
                                 _producerContext.Id, PRODUCER_NAME, extraMap);
 
@@ -224,10 +417,178 @@ namespace ImagePipeline.Producers
                 finally
                 {
                     Closeables.CloseQuietly(inputStream);
-                    outputStream.Dispose();
+                    CloseableReference<IPooledByteBuffer>.CloseSafely(inputBufferRef);
+#if HAS_LIBJPEGTURBO
+                    if (streamingTranscode != null)
+                    {
+                        streamingTranscode.Dispose();
+                    }
+#endif // HAS_LIBJPEGTURBO
+                    if (outputStream != null)
+                    {
+                        outputStream.Dispose();
+                    }
                 }
             }
 
+#if HAS_LIBJPEGTURBO
+            protected override void OnFailureImpl(Exception error)
+            {
+                CancelStreamingTranscode();
+                base.OnFailureImpl(error);
+            }
+
+            protected override void OnCancellationImpl()
+            {
+                CancelStreamingTranscode();
+                base.OnCancellationImpl();
+            }
+
+            /// <summary>
+            /// Appends the bytes downloaded since the previous intermediate
+            /// result to the streaming transcode, starting it on the first
+            /// one.
+            ///
+            /// <para />Rotated and cropped images, and images that are not
+            /// in native memory, are transcoded once they are complete.
+            /// </summary>
+            private void StreamIntermediateResult(EncodedImage encodedImage)
+            {
+                ImageRequest imageRequest = _producerContext.ImageRequest;
+                NativePooledByteBufferFactory nativeFactory =
+                    _parent._pooledByteBufferFactory as NativePooledByteBufferFactory;
+
+                lock (_streamingGate)
+                {
+                    if (_streamingDisabled || _isCancelled)
+                    {
+                        return;
+                    }
+
+                    TriState shouldStream = ShouldStreamTranscode(imageRequest, encodedImage);
+                    if (shouldStream == TriState.UNSET)
+                    {
+                        return;
+                    }
+
+                    if (nativeFactory == null || shouldStream == TriState.NO)
+                    {
+                        _streamingDisabled = true;
+                        return;
+                    }
+
+                    CloseableReference<IPooledByteBuffer> bufferRef = encodedImage.GetByteBufferRef();
+                    try
+                    {
+                        NativePooledByteBuffer nativeBuffer = (bufferRef != null) ?
+                            bufferRef.Get() as NativePooledByteBuffer : null;
+
+                        if (nativeBuffer == null)
+                        {
+                            _streamingDisabled = true;
+                            return;
+                        }
+
+                        if (_streamingTranscode == null)
+                        {
+                            _streamingScaleNumerator = GetScaleNumerator(imageRequest, encodedImage);
+                            _streamingTargetSize = GetTargetSize(imageRequest, encodedImage);
+                            _streamingTranscode = JpegTranscodeQueue.StartStreamingTranscode(
+                                new JpegTranscodeOptions(
+                                    0,
+                                    _streamingScaleNumerator,
+                                    null,
+                                    _streamingTargetSize,
+                                    _parent._encodeOptions),
+                                Math.Max(nativeBuffer.Size, MIN_STREAMING_OUTPUT_CAPACITY),
+                                nativeFactory.Pool);
+                        }
+
+                        int appendedLength = _streamingTranscode.AppendedLength;
+                        if (nativeBuffer.Size > appendedLength)
+                        {
+                            _streamingTranscode.Append(
+                                nativeBuffer.GetNativePtr() + appendedLength,
+                                nativeBuffer.Size - appendedLength);
+                        }
+                    }
+                    catch (Exception)
+                    {
+                        // The final result is transcoded as a whole instead
+                        _streamingDisabled = true;
+                        if (_streamingTranscode != null)
+                        {
+                            _streamingTranscode.Dispose();
+                            _streamingTranscode = null;
+                        }
+                    }
+                    finally
+                    {
+                        CloseableReference<IPooledByteBuffer>.CloseSafely(bufferRef);
+                    }
+                }
+            }
+
+            /// <summary>
+            /// Appends the rest of the final result and waits for the
+            /// streaming transcode.
+            /// </summary>
+            /// <returns>
+            /// The transcoded image, or null if the final result has to be
+            /// transcoded as a whole.
+            /// </returns>
+            private static async Task<IPooledByteBuffer> FinishStreamingTranscodeAsync(
+                JpegStreamingTranscode streamingTranscode,
+                NativePooledByteBuffer nativeBuffer,
+                int numerator,
+                ResizeOptions targetSize,
+                int streamingNumerator,
+                ResizeOptions streamingTargetSize)
+            {
+                int appendedLength = streamingTranscode.AppendedLength;
+                if (numerator != streamingNumerator ||
+                    !Equals(targetSize, streamingTargetSize) ||
+                    nativeBuffer.Size < appendedLength)
+                {
+                    return null;
+                }
+
+                try
+                {
+                    streamingTranscode.Append(
+                        nativeBuffer.GetNativePtr() + appendedLength,
+                        nativeBuffer.Size - appendedLength);
+
+                    return await streamingTranscode.FinishAsync().ConfigureAwait(false);
+                }
+                catch (IOException)
+                {
+                    // Transcoding the whole image reports the error
+                    return null;
+                }
+            }
+
+            private JpegStreamingTranscode TakeStreamingTranscode()
+            {
+                lock (_streamingGate)
+                {
+                    JpegStreamingTranscode streamingTranscode = _streamingTranscode;
+                    _streamingTranscode = null;
+                    _streamingDisabled = true;
+                    return streamingTranscode;
+                }
+            }
+
+            private void CancelStreamingTranscode()
+            {
+                JpegStreamingTranscode streamingTranscode = TakeStreamingTranscode();
+                if (streamingTranscode != null)
+                {
+                    streamingTranscode.Dispose();
+                }
+            }
+#endif // HAS_LIBJPEGTURBO
+
             private IDictionary<string, string> GetExtraMap(
                 EncodedImage encodedImage,
                 ImageRequest imageRequest,
@@ -262,7 +623,7 @@ namespace ImagePipeline.Producers
                 return extraMap;
             }
 
-            private static TriState ShouldTransform(
+            internal static TriState ShouldTransform(
                 ImageRequest request,
                 EncodedImage encodedImage)
             {
@@ -278,72 +639,136 @@ namespace ImagePipeline.Producers
 
                 return TriStateHelper.ValueOf(
                     GetRotationAngle(request, encodedImage) != 0 ||
-                    ShouldResize(GetScaleNumerator(request, encodedImage)));
+                    ShouldResize(GetScaleNumerator(request, encodedImage)) ||
+                    GetTargetSize(request, encodedImage) != null ||
+                    ShouldCrop(request));
             }
 
-            internal static float DetermineResizeRatio(
-                ResizeOptions resizeOptions,
-                int width,
-                int height)
+            internal static int RoundNumerator(float maxRatio)
             {
+                return (int)(ROUNDUP_FRACTION + maxRatio * JpegTranscoder.SCALE_DENOMINATOR);
+            }
 
-                if (resizeOptions == null)
+            private static int GetScaleNumerator(
+                ImageRequest imageRequest,
+                EncodedImage encodedImage)
+            {
+                if (imageRequest.ResizeOptions == null)
                 {
-                    return 1.0f;
+                    return JpegTranscoder.SCALE_DENOMINATOR;
                 }
 
-                float widthRatio = ((float)resizeOptions.Width) / width;
-                float heightRatio = ((float)resizeOptions.Height) / height;
-                float ratio = Math.Max(widthRatio, heightRatio);
+                int width;
+                int height;
+                GetSourceSize(imageRequest, encodedImage, out width, out height);
+                float ratio = GetResizeRatio(imageRequest, encodedImage, width, height);
+
+                // The resampler needs at least as many pixels as it outputs,
+                // so round up instead of accepting a slightly smaller image.
+                int numerator = ShouldResample(ratio) ?
+                    (int)Math.Ceiling(ratio * JpegTranscoder.SCALE_DENOMINATOR) :
+                    RoundNumerator(ratio);
 
-                // TODO: The limit is larger than this on newer devices.
-                if (width * ratio > BitmapUtil.MAX_BITMAP_SIZE)
+                if (numerator > MAX_JPEG_SCALE_NUMERATOR)
                 {
-                    ratio = BitmapUtil.MAX_BITMAP_SIZE / width;
+                    return MAX_JPEG_SCALE_NUMERATOR;
                 }
 
-                if (height * ratio > BitmapUtil.MAX_BITMAP_SIZE)
+                return (numerator < 1) ? 1 : numerator;
+            }
+
+            /// <summary>
+            /// Returns the exact size, before rotation, the transcoded image
+            /// is resampled to, or null if n/8 scaling is all it needs.
+            /// </summary>
+            private static ResizeOptions GetTargetSize(
+                ImageRequest imageRequest,
+                EncodedImage encodedImage)
+            {
+                if (imageRequest.ResizeOptions == null)
+                {
+                    return null;
+                }
+
+                int width;
+                int height;
+                GetSourceSize(imageRequest, encodedImage, out width, out height);
+                float ratio = GetResizeRatio(imageRequest, encodedImage, width, height);
+                if (!ShouldResample(ratio))
+                {
+                    return null;
+                }
+
+                int targetWidth = Math.Max((int)Math.Round(width * ratio), 1);
+                int targetHeight = Math.Max((int)Math.Round(height * ratio), 1);
+                if (targetWidth >= width && targetHeight >= height)
+                {
+                    return null;
+                }
+
+                // A pixel off is not worth a full resampling pass, keep the
+                // size n/8 scaling gives instead.
+                int numerator = GetScaleNumerator(imageRequest, encodedImage);
+                if (IsWithinOnePixel(GetScaledSize(width, numerator), targetWidth) &&
+                    IsWithinOnePixel(GetScaledSize(height, numerator), targetHeight))
                 {
-                    ratio = BitmapUtil.MAX_BITMAP_SIZE / height;
+                    return null;
                 }
 
-                return ratio;
+                return new ResizeOptions(targetWidth, targetHeight);
             }
 
-            internal static int RoundNumerator(float maxRatio)
+            /// <summary>
+            /// Returns the size libjpeg-turbo scales given size to, it
+            /// rounds up.
+            /// </summary>
+            private static int GetScaledSize(int size, int scaleNumerator)
             {
-                return (int)(ROUNDUP_FRACTION + maxRatio * JpegTranscoder.SCALE_DENOMINATOR);
+                return (int)(((long)size * scaleNumerator + JpegTranscoder.SCALE_DENOMINATOR - 1) /
+                    JpegTranscoder.SCALE_DENOMINATOR);
             }
 
-            private static int GetScaleNumerator(
+            private static bool IsWithinOnePixel(int size, int targetSize)
+            {
+                return Math.Abs(size - targetSize) <= 1;
+            }
+
+            /// <summary>
+            /// Gets the size of the part of the image being transcoded,
+            /// before rotation.
+            /// </summary>
+            private static void GetSourceSize(
                 ImageRequest imageRequest,
-                EncodedImage encodedImage)
+                EncodedImage encodedImage,
+                out int width,
+                out int height)
             {
-                ResizeOptions resizeOptions = imageRequest.ResizeOptions;
-                if (resizeOptions == null)
+                width = encodedImage.Width;
+                height = encodedImage.Height;
+                if (ShouldCrop(imageRequest))
                 {
-                    return JpegTranscoder.SCALE_DENOMINATOR;
+                    // Only the cropped region has to fit the requested size
+                    CropOptions cropOptions = imageRequest.CropOptions;
+                    width = Math.Max(Math.Min(cropOptions.Width, width - cropOptions.X), 1);
+                    height = Math.Max(Math.Min(cropOptions.Height, height - cropOptions.Y), 1);
                 }
+            }
 
+            private static float GetResizeRatio(
+                ImageRequest imageRequest,
+                EncodedImage encodedImage,
+                int width,
+                int height)
+            {
                 int rotationAngle = GetRotationAngle(imageRequest, encodedImage);
                 bool swapDimensions = rotationAngle == 90 || rotationAngle == 270;
-                int widthAfterRotation = swapDimensions ? encodedImage.Height :
-                        encodedImage.Width;
-
-                int heightAfterRotation = swapDimensions ? encodedImage.Width : encodedImage.Height;
-                float ratio = DetermineResizeRatio(
-                    resizeOptions, widthAfterRotation, heightAfterRotation);
-
-                int numerator = RoundNumerator(ratio);
-                if (numerator > MAX_JPEG_SCALE_NUMERATOR)
-                {
-                    return MAX_JPEG_SCALE_NUMERATOR;
-                }
-
-                return (numerator < 1) ? 1 : numerator;
+                int widthAfterRotation = swapDimensions ? height : width;
+                int heightAfterRotation = swapDimensions ? width : height;
+                return DetermineResizeRatio(
+                    imageRequest.ResizeOptions, widthAfterRotation, heightAfterRotation);
             }
 
-            private static int GetRotationAngle(ImageRequest imageRequest, EncodedImage encodedImage)
+            internal static int GetRotationAngle(ImageRequest imageRequest, EncodedImage encodedImage)
             {
                 if (!imageRequest.IsAutoRotateEnabled)
                 {
@@ -364,6 +789,26 @@ namespace ImagePipeline.Producers
             {
                 return numerator < MAX_JPEG_SCALE_NUMERATOR;
             }
+
+            private static bool ShouldResample(float ratio)
+            {
+#if HAS_LIBJPEGTURBO
+                return ratio < 1.0f;
+#else // HAS_LIBJPEGTURBO
+                // The transcoder is the one doing the resampling
+                return false;
+#endif // HAS_LIBJPEGTURBO
+            }
+
+            private static bool ShouldCrop(ImageRequest imageRequest)
+            {
+#if HAS_LIBJPEGTURBO
+                return imageRequest.CropOptions != null;
+#else // HAS_LIBJPEGTURBO
+                // Without the native transcoder the decoder crops the image
+                return false;
+#endif // HAS_LIBJPEGTURBO
+            }
         }
     }
 }
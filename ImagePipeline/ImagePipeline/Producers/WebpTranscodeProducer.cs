@@ -1,8 +1,14 @@
-﻿using System;
-using FBCore.Common.Internal;
+﻿using FBCore.Common.Internal;
+using FBCore.Common.References;
+using FBCore.Common.Util;
 using FBCore.Concurrency;
+using ImageFormatUtils;
 using ImagePipeline.Image;
 using ImagePipeline.Memory;
+using ImagePipeline.NativeCode;
+using System;
+using System.IO;
+using System.Threading.Tasks;
 
 namespace ImagePipeline.Producers
 {
@@ -10,10 +16,13 @@ namespace ImagePipeline.Producers
     /// Transcodes WebP to JPEG / PNG.
     ///
     /// <para />If processed image is one of VP8, VP8X or VP8L non-animated WebPs
-    /// then it is transcoded to jpeg if the decoder on the running version of
-    /// Android does not support this format.
-    /// This was the case prior to version 4.2.1.
+    /// then it is transcoded if the platform decoder does not support this
+    /// format, which is the case unless the WebP codec extension of Windows
+    /// is installed. Lossy images are transcoded to JPEG, images with alpha
+    /// or lossless data to PNG.
     /// <para />If the image is not WebP, no transformation is applied.
+    /// <para />The image is never resized, the producer sits in front of the
+    /// encoded caches.
     /// </summary>
     public class WebpTranscodeProducer : IProducer<EncodedImage>
     {
@@ -23,18 +32,25 @@ namespace ImagePipeline.Producers
         private readonly IExecutorService _executor;
         private readonly IPooledByteBufferFactory _pooledByteBufferFactory;
         private readonly IProducer<EncodedImage> _inputProducer;
+        private readonly IImageMetaDataParser _imageMetaDataParser;
 
         /// <summary>
         /// Instantiates the <see cref="WebpTranscodeProducer"/>.
         /// </summary>
+        /// <param name="imageMetaDataParser">
+        /// Parser reading the meta data of the encoded images, null to
+        /// read it from their streams.
+        /// </param>
         public WebpTranscodeProducer(
             IExecutorService executor,
             IPooledByteBufferFactory pooledByteBufferFactory,
-            IProducer<EncodedImage> inputProducer)
+            IProducer<EncodedImage> inputProducer,
+            IImageMetaDataParser imageMetaDataParser)
         {
             _executor = Preconditions.CheckNotNull(executor);
             _pooledByteBufferFactory = Preconditions.CheckNotNull(pooledByteBufferFactory);
             _inputProducer = Preconditions.CheckNotNull(inputProducer);
+            _imageMetaDataParser = imageMetaDataParser;
         }
 
         /// <summary>
@@ -44,7 +60,294 @@ namespace ImagePipeline.Producers
         /// </summary>
         public void ProduceResults(IConsumer<EncodedImage> consumer, IProducerContext context)
         {
-            throw new NotImplementedException();
+            _inputProducer.ProduceResults(new WebpTranscodeConsumer(this, consumer, context), context);
+        }
+
+        private void TranscodeLastResult(
+            EncodedImage originalResult,
+            IConsumer<EncodedImage> consumer,
+            IProducerContext producerContext)
+        {
+            Preconditions.CheckNotNull(originalResult);
+            EncodedImage encodedImageCopy = EncodedImage.CloneOrNull(originalResult);
+            TranscodeRunnable runnable = new TranscodeRunnable(
+                this,
+                encodedImageCopy,
+                consumer,
+                producerContext.Listener,
+                producerContext.Id);
+
+            producerContext.AddCallbacks(
+                new BaseProducerContextCallbacks(
+                    () =>
+                    {
+                        runnable.Cancel();
+                    },
+                    () => { },
+                    () => { },
+                    () => { }));
+
+            _executor.Execute(runnable.Runnable);
+        }
+
+        internal static TriState ShouldTranscode(EncodedImage encodedImage)
+        {
+            Preconditions.CheckNotNull(encodedImage);
+            ImageFormat imageFormat = ImageFormatChecker.GetImageFormat_WrapIOException(
+                encodedImage.GetInputStream());
+
+            switch (imageFormat)
+            {
+                case ImageFormat.WEBP_SIMPLE:
+                case ImageFormat.WEBP_LOSSLESS:
+                case ImageFormat.WEBP_EXTENDED:
+                case ImageFormat.WEBP_EXTENDED_WITH_ALPHA:
+                    return TriStateHelper.ValueOf(WebpTranscoder.IsTranscodeRequired);
+
+                case ImageFormat.UNKNOWN:
+                    // The header might not be complete yet
+                    return TriState.UNSET;
+
+                default:
+                    return TriState.NO;
+            }
+        }
+
+        private async Task<ImageFormat> DoTranscodeAsync(
+            EncodedImage encodedImage,
+            PooledByteBufferOutputStream outputStream)
+        {
+#if HAS_LIBWEBP
+            ImageFormat imageFormat = ImageFormatChecker.GetImageFormat_WrapIOException(
+                encodedImage.GetInputStream());
+
+            CloseableReference<IPooledByteBuffer> inputBufferRef = encodedImage.GetByteBufferRef();
+            NativeMemoryChunk inputChunk = default(NativeMemoryChunk);
+            try
+            {
+                // libwebp reads the image in place, everything not held in
+                // native memory is copied there first.
+                NativePooledByteBuffer nativeBuffer = (inputBufferRef != null) ?
+                    inputBufferRef.Get() as NativePooledByteBuffer : null;
+
+                long srcPtr;
+                int srcLength;
+                if (nativeBuffer != null)
+                {
+                    srcPtr = nativeBuffer.GetNativePtr();
+                    srcLength = nativeBuffer.Size;
+                }
+                else
+                {
+                    byte[] bytes;
+                    using (Stream inputStream = encodedImage.GetInputStream())
+                    using (MemoryStream memoryStream = new MemoryStream())
+                    {
+                        inputStream.CopyTo(memoryStream);
+                        bytes = memoryStream.ToArray();
+                    }
+
+                    inputChunk = new NativeMemoryChunk(Math.Max(bytes.Length, 1));
+                    inputChunk.Write(0, bytes, 0, bytes.Length);
+                    srcPtr = inputChunk.GetNativePtr();
+                    srcLength = bytes.Length;
+                }
+
+                switch (imageFormat)
+                {
+                    case ImageFormat.WEBP_SIMPLE:
+                    case ImageFormat.WEBP_EXTENDED:
+#if HAS_LIBJPEGTURBO
+                        WebpTranscoder.TranscodeWebpToJpeg(
+                            srcPtr,
+                            srcLength,
+                            outputStream.AsIStream(),
+                            new JpegEncodeOptions(DEFAULT_JPEG_QUALITY));
+
+                        return ImageFormat.JPEG;
+#else // HAS_LIBJPEGTURBO
+                        // Without libjpeg-turbo lossy images go to png as well
+                        await WebpTranscoder
+                            .TranscodeWebpToPngAsync(srcPtr, srcLength, outputStream)
+                            .ConfigureAwait(false);
+
+                        return ImageFormat.PNG;
+#endif // HAS_LIBJPEGTURBO
+
+                    case ImageFormat.WEBP_LOSSLESS:
+                    case ImageFormat.WEBP_EXTENDED_WITH_ALPHA:
+                        // In order to preserve alpha channel use png
+                        await WebpTranscoder
+                            .TranscodeWebpToPngAsync(srcPtr, srcLength, outputStream)
+                            .ConfigureAwait(false);
+
+                        return ImageFormat.PNG;
+
+                    default:
+                        throw new ArgumentException("Wrong image format");
+                }
+            }
+            finally
+            {
+                inputChunk?.Dispose();
+                CloseableReference<IPooledByteBuffer>.CloseSafely(inputBufferRef);
+            }
+#else // HAS_LIBWEBP
+            await Task.CompletedTask.ConfigureAwait(false);
+            throw new InvalidOperationException("webp transcoding requires libwebp");
+#endif // HAS_LIBWEBP
+        }
+
+        /// <summary>
+        /// Transcodes the last result on the executor.
+        /// </summary>
+        private class TranscodeRunnable : StatefulProducerRunnable<EncodedImage>
+        {
+            private readonly WebpTranscodeProducer _parent;
+            private readonly EncodedImage _encodedImageCopy;
+
+            /// <summary>
+            /// Instantiates the <see cref="TranscodeRunnable"/>.
+            /// </summary>
+            public TranscodeRunnable(
+                WebpTranscodeProducer parent,
+                EncodedImage encodedImageCopy,
+                IConsumer<EncodedImage> consumer,
+                IProducerListener producerListener,
+                string requestId) :
+                    base(consumer, producerListener, PRODUCER_NAME, requestId)
+            {
+                _parent = parent;
+                _encodedImageCopy = encodedImageCopy;
+            }
+
+            /// <summary>
+            /// Gets the transcoded image.
+            /// </summary>
+            protected override async Task<EncodedImage> GetResult()
+            {
+                PooledByteBufferOutputStream outputStream =
+                    _parent._pooledByteBufferFactory.NewOutputStream();
+
+                try
+                {
+                    ImageFormat imageFormat = await _parent
+                        .DoTranscodeAsync(_encodedImageCopy, outputStream)
+                        .ConfigureAwait(false);
+
+                    CloseableReference<IPooledByteBuffer> reference =
+                        CloseableReference<IPooledByteBuffer>.of(outputStream.ToByteBuffer());
+
+                    try
+                    {
+                        EncodedImage encodedImage = new EncodedImage(reference);
+                        encodedImage.CopyMetaDataFrom(_encodedImageCopy);
+                        encodedImage.Format = imageFormat;
+                        await encodedImage.ParseMetaDataAsync(_parent._imageMetaDataParser)
+                            .ConfigureAwait(false);
+                        return encodedImage;
+                    }
+                    finally
+                    {
+                        CloseableReference<IPooledByteBuffer>.CloseSafely(reference);
+                    }
+                }
+                finally
+                {
+                    outputStream.Dispose();
+                }
+            }
+
+            /// <summary>
+            /// Disposes the result.
+            /// </summary>
+            protected override void DisposeResult(EncodedImage result)
+            {
+                EncodedImage.CloseSafely(result);
+            }
+
+            /// <summary>
+            /// Called after computing result successfully.
+            /// </summary>
+            protected override void OnSuccess(EncodedImage result)
+            {
+                EncodedImage.CloseSafely(_encodedImageCopy);
+                base.OnSuccess(result);
+            }
+
+            /// <summary>
+            /// Called if exception occurred during computation.
+            /// </summary>
+            protected override void OnFailure(Exception e)
+            {
+                EncodedImage.CloseSafely(_encodedImageCopy);
+                base.OnFailure(e);
+            }
+
+            /// <summary>
+            /// Called when the runnable is cancelled.
+            /// </summary>
+            protected override void OnCancellation()
+            {
+                EncodedImage.CloseSafely(_encodedImageCopy);
+                base.OnCancellation();
+            }
+        }
+
+        /// <summary>
+        /// Consumer that forwards everything but webp the platform cannot
+        /// decode, the last result of which is transcoded.
+        /// </summary>
+        private class WebpTranscodeConsumer : DelegatingConsumer<EncodedImage, EncodedImage>
+        {
+            private readonly WebpTranscodeProducer _parent;
+            private readonly IProducerContext _context;
+            private TriState _shouldTranscodeWhenFinished;
+
+            /// <summary>
+            /// Instantiates the <see cref="WebpTranscodeConsumer"/>.
+            /// </summary>
+            public WebpTranscodeConsumer(
+                WebpTranscodeProducer parent,
+                IConsumer<EncodedImage> consumer,
+                IProducerContext context) :
+                    base(consumer)
+            {
+                _parent = parent;
+                _context = context;
+                _shouldTranscodeWhenFinished = TriState.UNSET;
+            }
+
+            /// <summary>
+            /// Called by OnNewResult, override this method instead.
+            /// </summary>
+            protected override void OnNewResultImpl(EncodedImage newResult, bool isLast)
+            {
+                // Try to determine if the last result should be transformed
+                if (_shouldTranscodeWhenFinished == TriState.UNSET && newResult != null)
+                {
+                    _shouldTranscodeWhenFinished = ShouldTranscode(newResult);
+                }
+
+                // Just propagate result if it shouldn't be transformed
+                if (_shouldTranscodeWhenFinished == TriState.NO)
+                {
+                    Consumer.OnNewResult(newResult, isLast);
+                    return;
+                }
+
+                if (isLast)
+                {
+                    if (_shouldTranscodeWhenFinished == TriState.YES && newResult != null)
+                    {
+                        _parent.TranscodeLastResult(newResult, Consumer, _context);
+                    }
+                    else
+                    {
+                        Consumer.OnNewResult(newResult, isLast);
+                    }
+                }
+            }
         }
     }
 }
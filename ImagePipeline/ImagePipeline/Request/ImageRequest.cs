@@ -67,6 +67,11 @@ namespace ImagePipeline.Request
         /// </summary>
         public ResizeOptions ResizeOptions { get; } = null;
 
+        /// <summary>
+        /// Crop options, null to decode the whole image.
+        /// </summary>
+        public CropOptions CropOptions { get; } = null;
+
         /// <summary>
         /// Is auto-rotate enabled?
         /// </summary>
@@ -160,6 +165,7 @@ namespace ImagePipeline.Request
             ImageDecodeOptions = builder.ImageDecodeOptions;
 
             ResizeOptions = builder.ResizeOptions;
+            CropOptions = builder.CropOptions;
             IsAutoRotateEnabled = builder.IsAutoRotateEnabled;
 
             Priority = builder.Priority;
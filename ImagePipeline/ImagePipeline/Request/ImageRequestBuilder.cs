@@ -23,6 +23,8 @@ namespace ImagePipeline.Request
 
         internal ResizeOptions ResizeOptions { get; private set; } = null;
 
+        internal CropOptions CropOptions { get; private set; } = null;
+
         internal ImageDecodeOptions ImageDecodeOptions { get; private set; } = 
             ImageDecodeOptions.Defaults;
 
@@ -77,6 +79,7 @@ namespace ImagePipeline.Request
                 .SetProgressiveRenderingEnabled(imageRequest.IsProgressiveRenderingEnabled)
                 .SetRequestPriority(imageRequest.Priority)
                 .SetResizeOptions(imageRequest.ResizeOptions)
+                .SetCropOptions(imageRequest.CropOptions)
                 .SetRequestListener(imageRequest.RequestListener);
         }
 
@@ -134,6 +137,18 @@ namespace ImagePipeline.Request
             return this;
         }
 
+        /// <summary>
+        /// Sets crop options in case only a region of the image should
+        /// be decoded.
+        /// </summary>
+        /// <param name="cropOptions">Crop options.</param>
+        /// <returns>The modified builder instance.</returns>
+        public ImageRequestBuilder SetCropOptions(CropOptions cropOptions)
+        {
+            CropOptions = cropOptions;
+            return this;
+        }
+
         /// <summary>
         /// Sets image decode options.
         /// </summary>
@@ -962,11 +962,14 @@ namespace Cache.Disk
                 }
                 catch (RenameException)
                 {
+                    // The previous file of the entry can't be replaced while
+                    // it is in use, e.g. opened by another process
+                    targetFile.Refresh();
                     CacheErrorCategory category = CacheErrorCategory.WRITE_RENAME_FILE_OTHER;
                     _parent._cacheErrorLogger.LogError(
                         category,
                         typeof(DefaultDiskStorage),
-                        "commit");
+                        targetFile.Exists ? "commit, target file in use" : "commit");
 
                     throw;
                 }
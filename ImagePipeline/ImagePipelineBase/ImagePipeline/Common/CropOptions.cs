@@ -0,0 +1,89 @@
+﻿using FBCore.Common.Internal;
+using FBCore.Common.Util;
+
+namespace ImagePipeline.Common
+{
+    /// <summary>
+    /// Options for region decoding.
+    ///
+    /// <para />Describes the rectangle of the image to decode, in pixels
+    /// of the encoded image, before any rotation or resizing is applied.
+    /// The rectangle is clamped to the image bounds.
+    /// </summary>
+    public class CropOptions
+    {
+        /// <summary>
+        /// Left edge of the region (in pixels).
+        /// </summary>
+        public int X { get; }
+
+        /// <summary>
+        /// Top edge of the region (in pixels).
+        /// </summary>
+        public int Y { get; }
+
+        /// <summary>
+        /// Region width (in pixels).
+        /// </summary>
+        public int Width { get; }
+
+        /// <summary>
+        /// Region height (in pixels).
+        /// </summary>
+        public int Height { get; }
+
+        /// <summary>
+        /// Instantiates the <see cref="CropOptions"/>.
+        /// </summary>
+        public CropOptions(
+            int x,
+            int y,
+            int width,
+            int height)
+        {
+            Preconditions.CheckArgument(x >= 0);
+            Preconditions.CheckArgument(y >= 0);
+            Preconditions.CheckArgument(width > 0);
+            Preconditions.CheckArgument(height > 0);
+            X = x;
+            Y = y;
+            Width = width;
+            Height = height;
+        }
+
+        /// <summary>
+        /// Calculates the hash code basing on the region.
+        /// </summary>
+        public override int GetHashCode()
+        {
+            return HashCodeUtil.HashCode(X, Y, Width, Height);
+        }
+
+        /// <summary>
+        /// Compares with other CropOptions objects.
+        /// </summary>
+        public override bool Equals(object other)
+        {
+            if (other == this)
+            {
+                return true;
+            }
+
+            if (other.GetType() != typeof(CropOptions))
+            {
+                return false;
+            }
+
+            CropOptions that = (CropOptions)other;
+            return X == that.X && Y == that.Y && Width == that.Width && Height == that.Height;
+        }
+
+        /// <summary>
+        /// Provides the custom ToString method.
+        /// </summary>
+        public override string ToString()
+        {
+            return string.Format("{0},{1}:{2}x{3}", X, Y, Width, Height);
+        }
+    }
+}
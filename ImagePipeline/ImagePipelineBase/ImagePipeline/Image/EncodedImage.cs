@@ -1,5 +1,6 @@
 ﻿using FBCore.Common.Internal;
 using FBCore.Common.References;
+using FBCore.Common.Util;
 using ImageFormatUtils;
 using ImagePipeline.Memory;
 using ImageUtils;
@@ -209,6 +210,22 @@ namespace ImagePipeline.Image
             return null;
         }
 
+        /// <summary>
+        /// Returns a read-only view over the encoded bytes, which reads
+        /// the native memory directly and keeps it alive until closed.
+        ///
+        /// <para />The caller has to close the view after using it.
+        /// </summary>
+        /// <returns>
+        /// The view, or null if the image is backed by a stream supplier
+        /// or its bytes are not in native memory. In that case
+        /// <see cref="GetInputStream"/> is to be used instead.
+        /// </returns>
+        public PooledByteBufferView GetByteBufferView()
+        {
+            return PooledByteBufferView.Create(_pooledByteBufferRef);
+        }
+
         /// <summary>
         /// Image format.
         /// </summary>
@@ -234,6 +251,18 @@ namespace ImagePipeline.Image
         /// </summary>
         public int SampleSize { get; set; } = DEFAULT_SAMPLE_SIZE;
 
+        /// <summary>
+        /// Whether the crop options of the request have already been
+        /// applied to the encoded bytes.
+        /// </summary>
+        public bool IsCropped { get; set; } = false;
+
+        /// <summary>
+        /// Whether the jpeg is progressive, unset until its frame header
+        /// has been read.
+        /// </summary>
+        public TriState IsProgressive { get; set; } = TriState.UNSET;
+
         /// <summary>
         /// Stream size.
         /// </summary>
@@ -287,44 +316,138 @@ namespace ImagePipeline.Image
         /// <summary>
         /// Sets the encoded image meta data.
         /// </summary>
-        public async Task ParseMetaDataAsync()
+        public Task ParseMetaDataAsync()
         {
-            ImageFormat format = ImageFormatChecker.GetImageFormat_WrapIOException(
-                GetInputStream());
+            return ParseMetaDataAsync(null);
+        }
 
-            Format = format;
+        /// <summary>
+        /// Sets the encoded image meta data.
+        /// </summary>
+        /// <param name="parser">
+        /// Parser reading the meta data of buffer backed images in a
+        /// single pass over their bytes, instead of opening a stream for
+        /// each of format, dimensions and orientation. Null to always use
+        /// the streams.
+        /// </param>
+        public async Task ParseMetaDataAsync(IImageMetaDataParser parser)
+        {
+            if (parser != null && TryParseMetaDataFromBuffer(parser))
+            {
+                return;
+            }
 
-            // Dimensions decoding is not yet supported for WebP since
-            // BitmapUtil.DecodeDimensions has a bug where it will return 100x100 for
-            // some WebPs even though those are not its actual dimensions.
-            if (!ImageFormatHelper.IsWebpFormat(Format))
+            // A single view serves all the passes below
+            using (PooledByteBufferView view = GetByteBufferView())
             {
-                Tuple<int, int> dimensions = await BitmapUtil
-                    .DecodeDimensionsAsync(GetInputStream())
-                    .ConfigureAwait(false);
+                ImageFormat format = ImageFormatChecker.GetImageFormat_WrapIOException(
+                    Rewind(view) ?? GetInputStream());
 
-                if (dimensions != default(Tuple<int, int>))
+                Format = format;
+
+                // Dimensions decoding is not yet supported for WebP since
+                // BitmapUtil.DecodeDimensions has a bug where it will return 100x100 for
+                // some WebPs even though those are not its actual dimensions.
+                if (!ImageFormatHelper.IsWebpFormat(Format))
                 {
-                    Width = dimensions.Item1;
-                    Height = dimensions.Item2;
+                    Tuple<int, int> dimensions = await BitmapUtil
+                        .DecodeDimensionsAsync(Rewind(view) ?? GetInputStream())
+                        .ConfigureAwait(false);
 
-                    // Load the rotation angle only if we have the dimensions
-                    if (Format == ImageFormat.JPEG)
+                    if (dimensions != default(Tuple<int, int>))
                     {
-                        if (RotationAngle == UNKNOWN_ROTATION_ANGLE)
+                        Width = dimensions.Item1;
+                        Height = dimensions.Item2;
+
+                        // Load the rotation angle only if we have the dimensions
+                        if (Format == ImageFormat.JPEG)
                         {
-                            RotationAngle = JfifUtil.GetAutoRotateAngleFromOrientation(
-                                JfifUtil.GetOrientation(GetInputStream()));
+                            if (RotationAngle == UNKNOWN_ROTATION_ANGLE)
+                            {
+                                RotationAngle = JfifUtil.GetAutoRotateAngleFromOrientation(
+                                    JfifUtil.GetOrientation(Rewind(view) ?? GetInputStream()));
+                            }
+                        }
+                        else
+                        {
+                            RotationAngle = 0;
                         }
-                    }
-                    else
-                    {
-                        RotationAngle = 0;
                     }
                 }
             }
         }
 
+        private static Stream Rewind(PooledByteBufferView view)
+        {
+            if (view != null)
+            {
+                view.Position = 0;
+            }
+
+            return view;
+        }
+
+        /// <summary>
+        /// Sets the meta data read by the parser.
+        /// </summary>
+        /// <returns>
+        /// false if the meta data has to be read from the input streams.
+        /// </returns>
+        private bool TryParseMetaDataFromBuffer(IImageMetaDataParser parser)
+        {
+            ImageMetaData metaData;
+            CloseableReference<IPooledByteBuffer> bufferRef = GetByteBufferRef();
+            try
+            {
+                if (bufferRef == null)
+                {
+                    return false;
+                }
+
+                metaData = parser.Parse(bufferRef.Get());
+            }
+            finally
+            {
+                CloseableReference<IPooledByteBuffer>.CloseSafely(bufferRef);
+            }
+
+            // The platform decoder may still know the dimensions of
+            // formats the parser does not.
+            if (metaData == null || metaData.Format == ImageFormat.UNKNOWN)
+            {
+                return false;
+            }
+
+            Format = metaData.Format;
+
+            // Dimensions are not read for WebP, as in ParseMetaDataAsync
+            if (ImageFormatHelper.IsWebpFormat(Format) ||
+                metaData.Width <= 0 ||
+                metaData.Height <= 0)
+            {
+                return true;
+            }
+
+            Width = metaData.Width;
+            Height = metaData.Height;
+            if (Format == ImageFormat.JPEG)
+            {
+                // Read from the same frame header as the dimensions
+                IsProgressive = TriStateHelper.ValueOf(metaData.IsProgressive);
+                if (RotationAngle == UNKNOWN_ROTATION_ANGLE)
+                {
+                    RotationAngle = JfifUtil.GetAutoRotateAngleFromOrientation(
+                        metaData.ExifOrientation);
+                }
+            }
+            else
+            {
+                RotationAngle = 0;
+            }
+
+            return true;
+        }
+
         /// <summary>
         /// Copy the meta data from another EncodedImage.
         /// </summary>
@@ -338,6 +461,8 @@ namespace ImagePipeline.Image
             Height = encodedImage.Height;
             RotationAngle = encodedImage.RotationAngle;
             SampleSize = encodedImage.SampleSize;
+            IsCropped = encodedImage.IsCropped;
+            IsProgressive = encodedImage.IsProgressive;
             StreamSize = encodedImage.Size;
         }
 
@@ -0,0 +1,20 @@
+﻿using ImagePipeline.Memory;
+
+namespace ImagePipeline.Image
+{
+    /// <summary>
+    /// Reads the header of an encoded image straight from the bytes of
+    /// its buffer.
+    /// </summary>
+    public interface IImageMetaDataParser
+    {
+        /// <summary>
+        /// Parses the header of the image held by buffer.
+        /// </summary>
+        /// <param name="buffer">The encoded image.</param>
+        /// <returns>
+        /// The meta data, or null if this parser cannot read the buffer.
+        /// </returns>
+        ImageMetaData Parse(IPooledByteBuffer buffer);
+    }
+}
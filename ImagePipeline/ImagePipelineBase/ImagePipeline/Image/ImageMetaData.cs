@@ -0,0 +1,58 @@
+﻿using ImageFormatUtils;
+
+namespace ImagePipeline.Image
+{
+    /// <summary>
+    /// Header fields of an encoded image, read by an
+    /// <see cref="IImageMetaDataParser"/>.
+    ///
+    /// <para />Fields that are not present in the image, or not in the
+    /// part downloaded so far, keep the defaults of
+    /// <see cref="EncodedImage"/>.
+    /// </summary>
+    public sealed class ImageMetaData
+    {
+        /// <summary>
+        /// Instantiates the <see cref="ImageMetaData"/>.
+        /// </summary>
+        public ImageMetaData(
+            ImageFormat format,
+            int width,
+            int height,
+            int exifOrientation,
+            bool isProgressive)
+        {
+            Format = format;
+            Width = width;
+            Height = height;
+            ExifOrientation = exifOrientation;
+            IsProgressive = isProgressive;
+        }
+
+        /// <summary>
+        /// Image format.
+        /// </summary>
+        public ImageFormat Format { get; }
+
+        /// <summary>
+        /// Image width, before any rotation.
+        /// </summary>
+        public int Width { get; }
+
+        /// <summary>
+        /// Image height, before any rotation.
+        /// </summary>
+        public int Height { get; }
+
+        /// <summary>
+        /// One of the ExifInterface.ORIENTATION_ values.
+        /// </summary>
+        public int ExifOrientation { get; }
+
+        /// <summary>
+        /// Whether the jpeg is progressive, only meaningful once its
+        /// dimensions are known.
+        /// </summary>
+        public bool IsProgressive { get; }
+    }
+}
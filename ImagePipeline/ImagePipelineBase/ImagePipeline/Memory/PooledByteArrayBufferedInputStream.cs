@@ -233,6 +233,30 @@ namespace ImagePipeline.Memory
             return bytesToRead;
         }
 
+        /// <summary>
+        /// Reads a byte from the stream and advances the position within
+        /// the stream by one byte, or returns -1 if at the end of the
+        /// stream.
+        /// </summary>
+        /// <returns>
+        /// The unsigned byte cast to an Int32, or -1 if at the end of
+        /// the stream.
+        /// </returns>
+        /// <exception cref="ObjectDisposedException">
+        /// Methods were called after the stream was closed.
+        /// </exception>
+        public override int ReadByte()
+        {
+            Preconditions.CheckState(_bufferOffset <= _bufferedSize);
+            EnsureNotClosed();
+            if (!EnsureDataInBuffer())
+            {
+                return -1;
+            }
+
+            return _byteArray[_bufferOffset++];
+        }
+
         /// <summary>
         /// When overridden in a derived class, sets the position within
         /// the current stream.
@@ -287,7 +311,7 @@ namespace ImagePipeline.Memory
             }
             else
             {
-                _bufferOffset += (int)(newOffset - originOffset);
+                _bufferOffset += (int)(newOffset - Position);
             }
 
             return newOffset;
@@ -6,9 +6,19 @@ namespace ImagePipeline.Memory
 {
     /// <summary>
     /// A Stream implementation over a <see cref="IPooledByteBuffer"/> instance.
+    ///
+    /// <para />Single bytes are served from a block fetched from the
+    /// buffer at once, so that a byte by byte parse crosses into native
+    /// memory once per <see cref="BLOCK_SIZE"/> bytes instead of once
+    /// per byte.
     /// </summary>
     public class PooledByteBufferInputStream : Stream
     {
+        /// <summary>
+        /// Number of bytes fetched at once by ReadByte.
+        /// </summary>
+        internal const int BLOCK_SIZE = 4096;
+
         internal readonly IPooledByteBuffer _pooledByteBuffer;
 
         /// <summary>
@@ -16,6 +26,15 @@ namespace ImagePipeline.Memory
         /// </summary>
         internal int _currentOffset;
 
+        /// <summary>
+        /// Bytes of the buffer starting at _blockOffset, allocated by the
+        /// first ReadByte. The buffer is immutable, so the block stays
+        /// valid across seeks.
+        /// </summary>
+        private byte[] _block;
+        private int _blockOffset;
+        private int _blockLength;
+
         /// <summary>
         /// Creates a new inputstream instance over the specific buffer.
         /// </summary>
@@ -201,6 +220,41 @@ namespace ImagePipeline.Memory
             return numToRead;
         }
 
+        /// <summary>
+        /// Reads a byte from the stream and advances the position within
+        /// the stream by one byte, or returns -1 if at the end of the
+        /// stream.
+        /// </summary>
+        /// <returns>
+        /// The unsigned byte cast to an Int32, or -1 if at the end of
+        /// the stream.
+        /// </returns>
+        public override int ReadByte()
+        {
+            int blockIndex = _currentOffset - _blockOffset;
+            if (blockIndex < 0 || blockIndex >= _blockLength)
+            {
+                int available = _pooledByteBuffer.Size - _currentOffset;
+                if (available <= 0 || _currentOffset < 0)
+                {
+                    return -1;
+                }
+
+                if (_block == null)
+                {
+                    _block = new byte[BLOCK_SIZE];
+                }
+
+                _blockOffset = _currentOffset;
+                _blockLength = Math.Min(available, BLOCK_SIZE);
+                _pooledByteBuffer.Read(_blockOffset, _block, 0, _blockLength);
+                blockIndex = 0;
+            }
+
+            _currentOffset++;
+            return _block[blockIndex];
+        }
+
         /// <summary>
         /// When overridden in a derived class, sets the position within
         /// the current stream.
@@ -0,0 +1,140 @@
+﻿using FBCore.Common.References;
+using System;
+using System.IO;
+using System.Threading;
+
+namespace ImagePipeline.Memory
+{
+    /// <summary>
+    /// Read-only stream over the native memory of a finished
+    /// <see cref="IPooledByteBuffer"/>.
+    ///
+    /// <para />Bytes are read straight from the memory, without copies
+    /// through the buffer and without taking its lock, so that several
+    /// readers of the same encoded image do not contend. The view keeps
+    /// its own reference to the buffer, the memory goes back to the pool
+    /// only after the view is closed.
+    ///
+    /// <para />The buffer must not be written to while viewed, which
+    /// holds for buffers returned by
+    /// <see cref="PooledByteBufferOutputStream.ToByteBuffer"/>.
+    /// </summary>
+    public sealed class PooledByteBufferView : UnmanagedMemoryStream
+    {
+        private readonly long _nativePtr;
+        private readonly int _size;
+        private CloseableReference<IPooledByteBuffer> _bufferRef;
+
+        private unsafe PooledByteBufferView(
+            CloseableReference<IPooledByteBuffer> bufferRef,
+            long nativePtr,
+            int size) : base((byte*)nativePtr, size)
+        {
+            _bufferRef = bufferRef;
+            _nativePtr = nativePtr;
+            _size = size;
+        }
+
+        /// <summary>
+        /// Creates a view over the buffer held by bufferRef.
+        /// </summary>
+        /// <param name="bufferRef">
+        /// The reference to the buffer, cloned by the view.
+        /// </param>
+        /// <returns>
+        /// The view, to be closed by the caller, or null if the reference
+        /// is not valid or the buffer is not in native memory.
+        /// </returns>
+        public static PooledByteBufferView Create(CloseableReference<IPooledByteBuffer> bufferRef)
+        {
+            CloseableReference<IPooledByteBuffer> viewRef =
+                CloseableReference<IPooledByteBuffer>.CloneOrNull(bufferRef);
+
+            if (viewRef == null)
+            {
+                return null;
+            }
+
+            try
+            {
+                IPooledByteBuffer buffer = viewRef.Get();
+                long nativePtr = buffer.GetNativePtr();
+                if (nativePtr != 0)
+                {
+                    PooledByteBufferView view = new PooledByteBufferView(
+                        viewRef, nativePtr, buffer.Size);
+
+                    viewRef = null;
+                    return view;
+                }
+
+                return null;
+            }
+            finally
+            {
+                CloseableReference<IPooledByteBuffer>.CloseSafely(viewRef);
+            }
+        }
+
+        /// <summary>
+        /// Gets the address of the first byte, valid until the view is
+        /// closed.
+        /// </summary>
+        public long NativePtr
+        {
+            get
+            {
+                EnsureValid();
+                return _nativePtr;
+            }
+        }
+
+        /// <summary>
+        /// Gets the pointer to the first byte, valid until the view is
+        /// closed.
+        /// </summary>
+        public unsafe byte* Pointer
+        {
+            get
+            {
+                EnsureValid();
+                return (byte*)_nativePtr;
+            }
+        }
+
+        /// <summary>
+        /// Gets the number of bytes in the view.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                return _size;
+            }
+        }
+
+        /// <summary>
+        /// Releases the reference to the buffer.
+        /// </summary>
+        protected override void Dispose(bool disposing)
+        {
+            try
+            {
+                base.Dispose(disposing);
+            }
+            finally
+            {
+                CloseableReference<IPooledByteBuffer>.CloseSafely(
+                    Interlocked.Exchange(ref _bufferRef, null));
+            }
+        }
+
+        private void EnsureValid()
+        {
+            if (Volatile.Read(ref _bufferRef) == null)
+            {
+                throw new ObjectDisposedException(nameof(PooledByteBufferView));
+            }
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "GifDecoder.h"
+#include "decoded_image.h"
+#include "exceptions.h"
+#include "gif/gif_animation.h"
+
+using facebook::imagepipeline::PixelFormat;
+using facebook::imagepipeline::gif::GifAnimation;
+using facebook::imagepipeline::gif::GifImage;
+
+static GifAnimation& getGifAnimation(int64_t animation)
+{
+	return *(GifAnimation*)LONG_TO_PTR(animation);
+}
+
+int64_t nativeCreateGifAnimation(
+	int64_t srcPtr,
+	int srcLen,
+	int cacheCapacity,
+	int keyframeInterval)
+{
+	THROW_AND_RETURNVAL_IF(srcPtr == 0 || srcLen <= 0, "invalid source", 0);
+	THROW_AND_RETURNVAL_IF(cacheCapacity < 0, "cache capacity cannot be negative", 0);
+	THROW_AND_RETURNVAL_IF(keyframeInterval < 0, "keyframe interval cannot be negative", 0);
+
+	return PTR_TO_LONG(new GifAnimation(
+		(const uint8_t*)LONG_TO_PTR(srcPtr),
+		(size_t)srcLen,
+		(size_t)cacheCapacity,
+		(uint32_t)keyframeInterval));
+}
+
+void nativeGetGifInfo(
+	int64_t animation,
+	int* width,
+	int* height,
+	int* frameCount,
+	int* loopCount)
+{
+	const GifImage& image = getGifAnimation(animation).getImage();
+	*width = (int)image.getWidth();
+	*height = (int)image.getHeight();
+	*frameCount = (int)image.getFrameCount();
+	*loopCount = image.getLoopCount();
+}
+
+int nativeGetGifFrameDuration(int64_t animation, int index)
+{
+	const GifImage& image = getGifAnimation(animation).getImage();
+	THROW_AND_RETURNVAL_IF(
+		index < 0 || (uint32_t)index >= image.getFrameCount(),
+		"frame index is out of range",
+		0);
+
+	return (int)image.getFrame((uint32_t)index).duration_ms;
+}
+
+void nativeRenderGifFrame(
+	int64_t animation,
+	int index,
+	int pixelFormat,
+	int64_t dstPtr,
+	int stride,
+	int dstCapacity)
+{
+	THROW_AND_RETURN_IF(index < 0, "frame index is out of range");
+	THROW_AND_RETURN_IF(stride <= 0, "stride should be positive");
+	THROW_AND_RETURN_IF(dstCapacity <= 0, "output capacity should be positive");
+	THROW_AND_RETURN_IF(
+		pixelFormat < (int)PixelFormat::RGB || pixelFormat > (int)PixelFormat::GRAY_ALPHA,
+		"unsupported pixel format");
+
+	getGifAnimation(animation).renderFrame(
+		(uint32_t)index,
+		(PixelFormat)pixelFormat,
+		(uint8_t*)LONG_TO_PTR(dstPtr),
+		(size_t)stride,
+		(size_t)dstCapacity);
+}
+
+int nativeGetGifDecodedFrameCount(int64_t animation)
+{
+	return (int)getGifAnimation(animation).getDecodedFrameCount();
+}
+
+int64_t nativeGetGifMemorySize(int64_t animation)
+{
+	return (int64_t)getGifAnimation(animation).getMaxMemorySize();
+}
+
+void nativeReleaseGifAnimation(int64_t animation)
+{
+	delete (GifAnimation*)LONG_TO_PTR(animation);
+}
@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "common.h"
+
+EXTERN_C_BEGIN
+
+/**
+ * Parses a gif and returns the animation rendering its frames, to be
+ * released with nativeReleaseGifAnimation. The encoded bytes are copied.
+ */
+WIN_EXPORT int64_t nativeCreateGifAnimation(
+	int64_t srcPtr,
+	int srcLen,
+	int cacheCapacity,
+	int keyframeInterval);
+
+WIN_EXPORT void nativeGetGifInfo(
+	int64_t animation,
+	int* width,
+	int* height,
+	int* frameCount,
+	int* loopCount);
+
+WIN_EXPORT int nativeGetGifFrameDuration(int64_t animation, int index);
+
+/**
+ * Renders frame index as displayed, the full canvas in given PixelFormat.
+ */
+WIN_EXPORT void nativeRenderGifFrame(
+	int64_t animation,
+	int index,
+	int pixelFormat,
+	int64_t dstPtr,
+	int stride,
+	int dstCapacity);
+
+WIN_EXPORT int nativeGetGifDecodedFrameCount(int64_t animation);
+
+/**
+ * Returns an upper bound of the native memory held by the animation.
+ */
+WIN_EXPORT int64_t nativeGetGifMemorySize(int64_t animation);
+
+WIN_EXPORT void nativeReleaseGifAnimation(int64_t animation);
+
+EXTERN_C_END
@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "ImageMetaDataParser.h"
+#include "image_metadata.h"
+#include "exceptions.h"
+
+using facebook::imagepipeline::ExifThumbnail;
+using facebook::imagepipeline::ImageMetaData;
+using facebook::imagepipeline::findExifThumbnail;
+using facebook::imagepipeline::parseImageMetaData;
+
+void nativeParseImageMetaData(
+	int64_t srcPtr,
+	int srcLen,
+	ParsedImageMetaData* metaData)
+{
+	THROW_AND_RETURN_IF(srcPtr == 0 || srcLen < 0, "invalid source");
+	THROW_AND_RETURN_IF(metaData == nullptr, "metaData cannot be null");
+
+	ImageMetaData meta_data;
+	parseImageMetaData((const uint8_t*)LONG_TO_PTR(srcPtr), (size_t)srcLen, meta_data);
+
+	metaData->format = (int)meta_data.format;
+	metaData->width = meta_data.width;
+	metaData->height = meta_data.height;
+	metaData->orientation = meta_data.orientation;
+	metaData->progressive = meta_data.progressive ? 1 : 0;
+}
+
+int nativeFindExifThumbnail(
+	int64_t srcPtr,
+	int srcLen,
+	ParsedExifThumbnail* thumbnail)
+{
+	THROW_AND_RETURNVAL_IF(srcPtr == 0 || srcLen < 0, "invalid source", 0);
+	THROW_AND_RETURNVAL_IF(thumbnail == nullptr, "thumbnail cannot be null", 0);
+
+	ExifThumbnail exif_thumbnail;
+	if (!findExifThumbnail((const uint8_t*)LONG_TO_PTR(srcPtr), (size_t)srcLen, exif_thumbnail))
+	{
+		return 0;
+	}
+
+	thumbnail->offset = (int)exif_thumbnail.offset;
+	thumbnail->length = (int)exif_thumbnail.length;
+	thumbnail->width = exif_thumbnail.width;
+	thumbnail->height = exif_thumbnail.height;
+	thumbnail->orientation = exif_thumbnail.orientation;
+	return 1;
+}
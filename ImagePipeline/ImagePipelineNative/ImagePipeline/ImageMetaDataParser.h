@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "common.h"
+
+EXTERN_C_BEGIN
+
+/**
+ * Header fields of an encoded image, laid out to match
+ * NativeImageMetaData in NativeImageMetaDataParser.cs.
+ */
+typedef struct
+{
+	int format;
+	int width;
+	int height;
+	int orientation;
+	int progressive;
+} ParsedImageMetaData;
+
+/**
+ * Jpeg thumbnail in the EXIF data of a jpeg, laid out to match
+ * NativeExifThumbnail in ExifThumbnailExtractor.cs.
+ */
+typedef struct
+{
+	int offset;
+	int length;
+	int width;
+	int height;
+	int orientation;
+} ParsedExifThumbnail;
+
+/**
+ * Parses the header of the image at srcPtr.
+ */
+WIN_EXPORT void nativeParseImageMetaData(
+	int64_t srcPtr,
+	int srcLen,
+	ParsedImageMetaData* metaData);
+
+/**
+ * Locates the jpeg thumbnail embedded in the EXIF data of the jpeg at
+ * srcPtr. The offset of the thumbnail is relative to srcPtr.
+ *
+ * @return 1 if a thumbnail was found, 0 otherwise
+ */
+WIN_EXPORT int nativeFindExifThumbnail(
+	int64_t srcPtr,
+	int srcLen,
+	ParsedExifThumbnail* thumbnail);
+
+EXTERN_C_END
@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifdef HAS_LIBJPEGTURBO
+
+#include "JpegDecoder.h"
+#include "decoded_image.h"
+#include "transformations.h"
+#include "exceptions.h"
+#include "jpeg/jpeg_codec.h"
+#include "jpeg/jpeg_restart_bands.h"
+
+using facebook::imagepipeline::CropRegion;
+using facebook::imagepipeline::PixelFormat;
+using facebook::imagepipeline::ScaleFactor;
+using facebook::imagepipeline::jpeg::decodeJpeg;
+using facebook::imagepipeline::jpeg::getJpegDecodeSize;
+using facebook::imagepipeline::jpeg::getDecodeThreadCount;
+using facebook::imagepipeline::jpeg::setMaxDecodeThreads;
+using facebook::imagepipeline::jpeg::splitAtRestartMarkers;
+using facebook::imagepipeline::jpeg::RestartBand;
+
+void nativeGetJpegDecodeSize(
+	int64_t srcPtr,
+	int srcLen,
+	int scaleNominator,
+	int cropX,
+	int cropY,
+	int cropWidth,
+	int cropHeight,
+	int* width,
+	int* height)
+{
+	THROW_AND_RETURN_IF(
+		cropX < 0 || cropY < 0 || cropWidth < 0 || cropHeight < 0,
+		"crop region cannot be negative");
+
+	ScaleFactor scale_factor
+	{
+		(uint8_t)scaleNominator, 8
+	};
+
+	CropRegion crop_region
+	{
+		(uint32_t)cropX, (uint32_t)cropY, (uint32_t)cropWidth, (uint32_t)cropHeight
+	};
+
+	unsigned int decoded_width = 0;
+	unsigned int decoded_height = 0;
+	getJpegDecodeSize(
+		(const uint8_t*)LONG_TO_PTR(srcPtr),
+		(size_t)srcLen,
+		scale_factor,
+		crop_region,
+		decoded_width,
+		decoded_height);
+
+	*width = (int)decoded_width;
+	*height = (int)decoded_height;
+}
+
+void nativeDecodeJpeg(
+	int64_t srcPtr,
+	int srcLen,
+	int scaleNominator,
+	int cropX,
+	int cropY,
+	int cropWidth,
+	int cropHeight,
+	int pixelFormat,
+	int64_t dstPtr,
+	int stride,
+	int dstCapacity)
+{
+	THROW_AND_RETURN_IF(stride <= 0, "stride should be positive");
+	THROW_AND_RETURN_IF(
+		cropX < 0 || cropY < 0 || cropWidth < 0 || cropHeight < 0,
+		"crop region cannot be negative");
+	THROW_AND_RETURN_IF(dstCapacity <= 0, "output capacity should be positive");
+	THROW_AND_RETURN_IF(
+		pixelFormat < (int)PixelFormat::RGB || pixelFormat > (int)PixelFormat::GRAY_ALPHA,
+		"unsupported pixel format");
+
+	ScaleFactor scale_factor
+	{
+		(uint8_t)scaleNominator, 8
+	};
+
+	CropRegion crop_region
+	{
+		(uint32_t)cropX, (uint32_t)cropY, (uint32_t)cropWidth, (uint32_t)cropHeight
+	};
+
+	decodeJpeg(
+		(const uint8_t*)LONG_TO_PTR(srcPtr),
+		(size_t)srcLen,
+		scale_factor,
+		crop_region,
+		(PixelFormat)pixelFormat,
+		(uint8_t*)LONG_TO_PTR(dstPtr),
+		(size_t)stride,
+		(size_t)dstCapacity);
+}
+
+void nativeSetJpegDecodeThreads(int threads)
+{
+	THROW_AND_RETURN_IF(threads < 0, "decode threads cannot be negative");
+	setMaxDecodeThreads((unsigned int)threads);
+}
+
+int nativeGetJpegDecodeThreads()
+{
+	return (int)getDecodeThreadCount();
+}
+
+int nativeGetJpegRestartBandCount(int64_t srcPtr, int srcLen)
+{
+	THROW_AND_RETURNVAL_IF(srcPtr == 0, "jpeg data cannot be null", 0);
+	THROW_AND_RETURNVAL_IF(srcLen <= 0, "jpeg data length should be positive", 0);
+
+	std::vector<RestartBand> bands;
+	if (!splitAtRestartMarkers(
+		(const uint8_t*)LONG_TO_PTR(srcPtr),
+		(size_t)srcLen,
+		getDecodeThreadCount(),
+		bands))
+	{
+		return 1;
+	}
+
+	return (int)bands.size();
+}
+
+#endif // HAS_LIBJPEGTURBO
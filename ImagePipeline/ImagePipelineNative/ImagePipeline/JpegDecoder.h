@@ -0,0 +1,44 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "common.h"
+
+EXTERN_C_BEGIN
+
+WIN_EXPORT void nativeGetJpegDecodeSize(
+	int64_t srcPtr,
+	int srcLen,
+	int scaleNominator,
+	int cropX,
+	int cropY,
+	int cropWidth,
+	int cropHeight,
+	int* width,
+	int* height);
+
+WIN_EXPORT void nativeDecodeJpeg(
+	int64_t srcPtr,
+	int srcLen,
+	int scaleNominator,
+	int cropX,
+	int cropY,
+	int cropWidth,
+	int cropHeight,
+	int pixelFormat,
+	int64_t dstPtr,
+	int stride,
+	int dstCapacity);
+
+WIN_EXPORT void nativeSetJpegDecodeThreads(int threads);
+
+WIN_EXPORT int nativeGetJpegDecodeThreads();
+
+WIN_EXPORT int nativeGetJpegRestartBandCount(int64_t srcPtr, int srcLen);
+
+EXTERN_C_END
@@ -0,0 +1,49 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "JpegMarkerScanner.h"
+#include "jpeg/jpeg_marker_scanner.h"
+#include "exceptions.h"
+
+using facebook::imagepipeline::jpeg::MarkerScanState;
+using facebook::imagepipeline::jpeg::MarkerScanner;
+using facebook::imagepipeline::jpeg::scanMarkers;
+
+int nativeScanJpegMarkers(
+	int64_t srcPtr,
+	int srcLen,
+	JpegScanState* state,
+	int* scanOffsets,
+	int scanOffsetCapacity)
+{
+	THROW_AND_RETURNVAL_IF(srcPtr == 0 || srcLen < 0, "invalid source", 0);
+	THROW_AND_RETURNVAL_IF(state == nullptr || state->bytesParsed < 0, "invalid state", 0);
+	THROW_AND_RETURNVAL_IF(
+		scanOffsetCapacity <= 0 || scanOffsets == nullptr,
+		"invalid scanOffsets",
+		0);
+
+	MarkerScanner scanner;
+	scanner.state = (MarkerScanState)state->parserState;
+	scanner.size_first_byte = (uint8_t)state->lastByteRead;
+	scanner.bytes_parsed = (size_t)state->bytesParsed;
+
+	// The caller calls again while its buffer comes back full
+	const size_t count = scanMarkers(
+		(const uint8_t*)LONG_TO_PTR(srcPtr),
+		(size_t)srcLen,
+		scanner,
+		(int32_t*)scanOffsets,
+		(size_t)scanOffsetCapacity);
+
+	state->parserState = (int)scanner.state;
+	state->lastByteRead = scanner.size_first_byte;
+	state->bytesParsed = (int)scanner.bytes_parsed;
+	return (int)count;
+}
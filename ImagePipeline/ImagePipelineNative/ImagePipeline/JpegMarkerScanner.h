@@ -0,0 +1,39 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "common.h"
+
+EXTERN_C_BEGIN
+
+/**
+ * Resumable state of the progressive jpeg scan, laid out to match
+ * NativeJpegScanState in ProgressiveJpegParser.cs.
+ */
+typedef struct
+{
+	int parserState;
+	int lastByteRead;
+	int bytesParsed;
+} JpegScanState;
+
+/**
+ * Scans the jpeg received so far at srcPtr from state->bytesParsed on,
+ * writing the offsets of up to scanOffsetCapacity SOS and EOI markers
+ * to scanOffsets and updating state to resume from.
+ *
+ * @return the number of offsets written to scanOffsets
+ */
+WIN_EXPORT int nativeScanJpegMarkers(
+	int64_t srcPtr,
+	int srcLen,
+	JpegScanState* state,
+	int* scanOffsets,
+	int scanOffsetCapacity);
+
+EXTERN_C_END
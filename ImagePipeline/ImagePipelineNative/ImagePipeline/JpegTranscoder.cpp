@@ -9,35 +9,353 @@
 
 #ifdef HAS_LIBJPEGTURBO
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <string.h>
+
 #include "JpegTranscoder.h"
 #include "transformations.h"
 #include "exceptions.h"
 #include "jpeg/jpeg_codec.h"
+#include "jpeg/jpeg_context.h"
+#include "jpeg/jpeg_memory_manager.h"
+#include "jpeg/jpeg_memory_io.h"
+#include "jpeg/jpeg_transcode_job.h"
+#include "worker_pool.h"
 
+using facebook::imagepipeline::CropRegion;
 using facebook::imagepipeline::getRotationTypeFromDegrees;
+using facebook::imagepipeline::ResampleFilter;
 using facebook::imagepipeline::RotationType;
 using facebook::imagepipeline::ScaleFactor;
+using facebook::imagepipeline::TargetSize;
+using facebook::imagepipeline::jpeg::ChromaSubsampling;
+using facebook::imagepipeline::jpeg::DctMethod;
+using facebook::imagepipeline::jpeg::EncodeOptions;
+using facebook::imagepipeline::WorkerPool;
+using facebook::imagepipeline::jpeg::JpegChunkedDestination;
+using facebook::imagepipeline::jpeg::MemoryTranscodeJob;
+using facebook::imagepipeline::jpeg::StreamingTranscodeJob;
+using facebook::imagepipeline::jpeg::submitTranscodeJob;
+using facebook::imagepipeline::jpeg::TranscodeJob;
 using facebook::imagepipeline::jpeg::transformJpeg;
 
+/**
+ * Parameters of a transcode, unpacked once from TranscodeJpegOptions.
+ */
+struct TranscodeParams
+{
+	const RotationType rotation_type;
+	const ScaleFactor scale_factor;
+	const CropRegion crop_region;
+	const TargetSize target_size;
+	const EncodeOptions encode_options;
+
+	explicit TranscodeParams(const TranscodeJpegOptions& options)
+		: rotation_type(getRotationTypeFromDegrees(options.rotationAngle)),
+		  scale_factor((uint8_t)options.scaleNominator, 8),
+		  crop_region(
+			  (uint32_t)options.cropX,
+			  (uint32_t)options.cropY,
+			  (uint32_t)options.cropWidth,
+			  (uint32_t)options.cropHeight),
+		  target_size(
+			  (uint32_t)options.targetWidth,
+			  (uint32_t)options.targetHeight,
+			  (ResampleFilter)options.resampleFilter),
+		  encode_options(
+			  options.quality,
+			  options.optimizeCoding != 0,
+			  options.progressive != 0,
+			  (ChromaSubsampling)options.subsampling,
+			  (DctMethod)options.dctMethod,
+			  options.restartRows)
+	{
+	}
+};
+
 void nativeTranscodeJpeg(
 	LPSTREAM is,
 	LPSTREAM os,
-	int rotationAngle,
-	int scaleNominator,
-	int quality)
+	const TranscodeJpegOptions* options)
 {
-	ScaleFactor scale_factor
-	{ 
-		(uint8_t)scaleNominator, 8
-	};
+	THROW_AND_RETURN_IF(options == nullptr, "options cannot be null");
 
-	RotationType rotation_type = getRotationTypeFromDegrees(rotationAngle);
+	const TranscodeParams params(*options);
 	transformJpeg(
 		is,
 		os,
-		rotation_type,
-		scale_factor,
-		quality);
+		params.rotation_type,
+		params.scale_factor,
+		params.crop_region,
+		params.target_size,
+		params.encode_options);
+}
+
+void nativeTranscodeJpegFromMemory(
+	int64_t srcPtr,
+	int srcLen,
+	LPSTREAM os,
+	const TranscodeJpegOptions* options)
+{
+	THROW_AND_RETURN_IF(options == nullptr, "options cannot be null");
+
+	const TranscodeParams params(*options);
+	transformJpeg(
+		(const uint8_t*)LONG_TO_PTR(srcPtr),
+		(size_t)srcLen,
+		os,
+		params.rotation_type,
+		params.scale_factor,
+		params.crop_region,
+		params.target_size,
+		params.encode_options);
+}
+
+int64_t nativeTranscodeJpegIntoChunks(
+	int64_t srcPtr,
+	int srcLen,
+	int64_t dstPtr,
+	int dstCapacity,
+	const TranscodeJpegOptions* options,
+	AllocateOutputChunkCallback allocate,
+	int64_t outputCookie)
+{
+	THROW_AND_RETURNVAL_IF(dstCapacity <= 0, "output capacity should be positive", 0);
+	THROW_AND_RETURNVAL_IF(options == nullptr, "options cannot be null", 0);
+
+	const TranscodeParams params(*options);
+	std::unique_ptr<JpegChunkedDestination> destination(new JpegChunkedDestination(
+		(JOCTET*)LONG_TO_PTR(dstPtr),
+		(size_t)dstCapacity,
+		allocate,
+		outputCookie));
+
+	transformJpeg(
+		(const uint8_t*)LONG_TO_PTR(srcPtr),
+		(size_t)srcLen,
+		*destination,
+		params.rotation_type,
+		params.scale_factor,
+		params.crop_region,
+		params.target_size,
+		params.encode_options);
+
+	return PTR_TO_LONG(destination.release());
+}
+
+void nativeGetChunkedOutputSizes(int64_t output, int* sizes, int count)
+{
+	const JpegChunkedDestination* destination = (JpegChunkedDestination*)LONG_TO_PTR(output);
+	THROW_AND_RETURN_IF(sizes == nullptr, "sizes cannot be null");
+	THROW_AND_RETURN_IF(
+		(size_t)count != destination->chunks.size(),
+		"count does not match the number of output chunks");
+
+	for (int i = 0; i < count; ++i)
+	{
+		sizes[i] = (int)destination->chunks[i].size;
+	}
+}
+
+void nativeReleaseChunkedOutput(int64_t output)
+{
+	delete (JpegChunkedDestination*)LONG_TO_PTR(output);
+}
+
+/**
+ * Handles given to managed code keep the job alive, the worker pool holds
+ * another reference while the job is queued or running.
+ */
+typedef std::shared_ptr<TranscodeJob> TranscodeJobHandle;
+
+static TranscodeJob& getTranscodeJob(int64_t job)
+{
+	return **(TranscodeJobHandle*)LONG_TO_PTR(job);
+}
+
+static StreamingTranscodeJob* getStreamingTranscodeJob(int64_t job)
+{
+	StreamingTranscodeJob* streaming_job = dynamic_cast<StreamingTranscodeJob*>(&getTranscodeJob(job));
+	THROW_AND_RETURNVAL_IF(streaming_job == nullptr, "not a streaming transcode", nullptr);
+	return streaming_job;
+}
+
+static std::function<void()> createCompletionCallback(
+	TranscodeJpegCallback callback,
+	int64_t cookie)
+{
+	if (callback == nullptr)
+	{
+		return std::function<void()>();
+	}
+
+	return [callback, cookie]() { callback(cookie); };
+}
+
+static std::shared_ptr<MemoryTranscodeJob> createTranscodeJob(
+	const TranscodeJpegRequest& request,
+	AllocateOutputChunkCallback allocate,
+	TranscodeJpegCallback callback,
+	int64_t cookie)
+{
+	THROW_AND_RETURNVAL_IF(request.srcPtr == 0, "jpeg data cannot be null", nullptr);
+	THROW_AND_RETURNVAL_IF(request.dstPtr == 0, "output cannot be null", nullptr);
+	THROW_AND_RETURNVAL_IF(request.dstCapacity <= 0, "output capacity should be positive", nullptr);
+
+	const TranscodeParams params(request.options);
+	return std::make_shared<MemoryTranscodeJob>(
+		(const uint8_t*)LONG_TO_PTR(request.srcPtr),
+		(size_t)request.srcLen,
+		(JOCTET*)LONG_TO_PTR(request.dstPtr),
+		(size_t)request.dstCapacity,
+		allocate,
+		request.outputCookie,
+		params.rotation_type,
+		params.scale_factor,
+		params.crop_region,
+		params.target_size,
+		params.encode_options,
+		createCompletionCallback(callback, cookie));
+}
+
+int64_t nativeSubmitTranscodeJpeg(
+	const TranscodeJpegRequest* request,
+	AllocateOutputChunkCallback allocate,
+	TranscodeJpegCallback callback,
+	int64_t cookie)
+{
+	int64_t job = 0;
+	nativeSubmitTranscodeJpegBatch(request, 1, allocate, callback, cookie, &job);
+	return job;
+}
+
+void nativeSubmitTranscodeJpegBatch(
+	const TranscodeJpegRequest* requests,
+	int count,
+	AllocateOutputChunkCallback allocate,
+	TranscodeJpegCallback callback,
+	int64_t firstCookie,
+	int64_t* jobs)
+{
+	THROW_AND_RETURN_IF(requests == nullptr || jobs == nullptr, "requests cannot be null");
+	THROW_AND_RETURN_IF(count < 0, "request count cannot be negative");
+
+	// Validate all requests before queueing any of them.
+	std::vector<std::shared_ptr<MemoryTranscodeJob>> batch;
+	batch.reserve(count);
+	for (int i = 0; i < count; ++i)
+	{
+		batch.push_back(createTranscodeJob(requests[i], allocate, callback, firstCookie + i));
+	}
+
+	for (int i = 0; i < count; ++i)
+	{
+		jobs[i] = PTR_TO_LONG(new TranscodeJobHandle(batch[i]));
+		submitTranscodeJob(batch[i]);
+	}
+}
+
+int64_t nativeStartStreamingTranscodeJpeg(
+	const TranscodeJpegRequest* request,
+	AllocateOutputChunkCallback allocate,
+	TranscodeJpegCallback callback,
+	int64_t cookie)
+{
+	THROW_AND_RETURNVAL_IF(request == nullptr, "request cannot be null", 0);
+	THROW_AND_RETURNVAL_IF(request->dstPtr == 0, "output cannot be null", 0);
+	THROW_AND_RETURNVAL_IF(request->dstCapacity <= 0, "output capacity should be positive", 0);
+	THROW_AND_RETURNVAL_IF(
+		request->options.rotationAngle != 0 ||
+			request->options.cropWidth != 0 ||
+			request->options.cropHeight != 0,
+		"streaming transcode cannot rotate or crop",
+		0);
+
+	const TranscodeParams params(request->options);
+	TranscodeJobHandle job = std::make_shared<StreamingTranscodeJob>(
+		(JOCTET*)LONG_TO_PTR(request->dstPtr),
+		(size_t)request->dstCapacity,
+		allocate,
+		request->outputCookie,
+		params.scale_factor,
+		params.target_size,
+		params.encode_options,
+		createCompletionCallback(callback, cookie));
+
+	return PTR_TO_LONG(new TranscodeJobHandle(job));
+}
+
+void nativeAppendStreamingTranscodeInput(int64_t job, int64_t srcPtr, int srcLen)
+{
+	THROW_AND_RETURN_IF(srcPtr == 0 && srcLen > 0, "jpeg data cannot be null");
+	THROW_AND_RETURN_IF(srcLen < 0, "length cannot be negative");
+	getStreamingTranscodeJob(job)->appendInput((const uint8_t*)LONG_TO_PTR(srcPtr), (size_t)srcLen);
+}
+
+void nativeFinishStreamingTranscodeInput(int64_t job)
+{
+	getStreamingTranscodeJob(job)->finishInput();
+}
+
+void nativeCancelStreamingTranscode(int64_t job)
+{
+	getStreamingTranscodeJob(job)->cancel();
+}
+
+int nativeGetTranscodeJobStatus(int64_t job)
+{
+	return (int)getTranscodeJob(job).getStatus();
+}
+
+void nativeWaitForTranscodeJob(int64_t job)
+{
+	getTranscodeJob(job).wait();
+}
+
+int64_t nativeGetTranscodeJobOutput(int64_t job)
+{
+	return PTR_TO_LONG(&getTranscodeJob(job).getOutput());
+}
+
+int nativeGetTranscodeJobError(int64_t job, char* message, int capacity)
+{
+	const std::string error = getTranscodeJob(job).getError();
+	if (message != nullptr && capacity > 0)
+	{
+		const size_t length = std::min<size_t>(error.size(), (size_t)capacity - 1);
+		memcpy(message, error.data(), length);
+		message[length] = '\0';
+	}
+
+	return (int)error.size();
+}
+
+void nativeReleaseTranscodeJob(int64_t job)
+{
+	delete (TranscodeJobHandle*)LONG_TO_PTR(job);
+}
+
+int nativeGetTranscodeWorkerCount()
+{
+	return (int)WorkerPool::getInstance().getThreadCount();
+}
+
+int64_t nativeGetJpegContextCreatedCount()
+{
+	return (int64_t)facebook::imagepipeline::jpeg::getCreatedContextCount();
+}
+
+int64_t nativeGetJpegContextReusedCount()
+{
+	return (int64_t)facebook::imagepipeline::jpeg::getReusedContextCount();
+}
+
+int64_t nativeGetJpegArenaAlignment()
+{
+	return (int64_t)facebook::imagepipeline::jpeg::getArenaAlignment();
 }
 
 #endif // HAS_LIBJPEGTURBO
@@ -11,11 +11,130 @@
 
 EXTERN_C_BEGIN
 
+/**
+ * Transformation and encoder parameters of a transcode, laid out to match
+ * NativeTranscodeOptions in JpegTranscodeOptions.cs.
+ */
+typedef struct
+{
+	int rotationAngle;
+	int scaleNominator;
+	int cropX;
+	int cropY;
+	int cropWidth;
+	int cropHeight;
+	int targetWidth;
+	int targetHeight;
+	int quality;
+	int optimizeCoding;
+	int progressive;
+	int subsampling;
+	int dctMethod;
+	int restartRows;
+	int resampleFilter;
+} TranscodeJpegOptions;
+
+/**
+ * Provides the output chunk following a full one, see OutputChunkAllocator
+ * in jpeg_memory_io.h. May be called on a worker thread.
+ */
+typedef int64_t (*AllocateOutputChunkCallback)(int64_t cookie, int preferredCapacity, int* capacity);
+
 WIN_EXPORT void nativeTranscodeJpeg(
 	LPSTREAM inputStream,
 	LPSTREAM outputStream,
-	int rotationAngle,
-	int scaleNominator,
-	int quality);
+	const TranscodeJpegOptions* options);
+
+WIN_EXPORT void nativeTranscodeJpegFromMemory(
+	int64_t srcPtr,
+	int srcLen,
+	LPSTREAM outputStream,
+	const TranscodeJpegOptions* options);
+
+WIN_EXPORT int64_t nativeTranscodeJpegIntoChunks(
+	int64_t srcPtr,
+	int srcLen,
+	int64_t dstPtr,
+	int dstCapacity,
+	const TranscodeJpegOptions* options,
+	AllocateOutputChunkCallback allocate,
+	int64_t outputCookie);
+
+/**
+ * Stores the number of bytes written to each chunk of the output, in the
+ * order the chunks were provided. count has to match the number of chunks.
+ */
+WIN_EXPORT void nativeGetChunkedOutputSizes(int64_t output, int* sizes, int count);
+
+WIN_EXPORT void nativeReleaseChunkedOutput(int64_t output);
+
+/**
+ * Transcode submitted to the worker pool, laid out to match
+ * NativeTranscodeRequest in JpegTranscodeQueue.cs.
+ */
+typedef struct
+{
+	int64_t srcPtr;
+	int64_t dstPtr;
+	int64_t outputCookie;
+	int srcLen;
+	int dstCapacity;
+	TranscodeJpegOptions options;
+} TranscodeJpegRequest;
+
+/**
+ * Called on a worker thread when a submitted transcode completes.
+ */
+typedef void (*TranscodeJpegCallback)(int64_t cookie);
+
+WIN_EXPORT int64_t nativeSubmitTranscodeJpeg(
+	const TranscodeJpegRequest* request,
+	AllocateOutputChunkCallback allocate,
+	TranscodeJpegCallback callback,
+	int64_t cookie);
+
+WIN_EXPORT void nativeSubmitTranscodeJpegBatch(
+	const TranscodeJpegRequest* requests,
+	int count,
+	AllocateOutputChunkCallback allocate,
+	TranscodeJpegCallback callback,
+	int64_t firstCookie,
+	int64_t* jobs);
+
+/**
+ * Starts downscaling a jpeg whose bytes are appended as they arrive.
+ * srcPtr and srcLen of the request are ignored, rotation and crop are not
+ * supported. The handle is polled and released like the ones returned by
+ * nativeSubmitTranscodeJpeg.
+ */
+WIN_EXPORT int64_t nativeStartStreamingTranscodeJpeg(
+	const TranscodeJpegRequest* request,
+	AllocateOutputChunkCallback allocate,
+	TranscodeJpegCallback callback,
+	int64_t cookie);
+
+WIN_EXPORT void nativeAppendStreamingTranscodeInput(int64_t job, int64_t srcPtr, int srcLen);
+
+WIN_EXPORT void nativeFinishStreamingTranscodeInput(int64_t job);
+
+WIN_EXPORT void nativeCancelStreamingTranscode(int64_t job);
+
+WIN_EXPORT int nativeGetTranscodeJobStatus(int64_t job);
+
+WIN_EXPORT void nativeWaitForTranscodeJob(int64_t job);
+
+WIN_EXPORT int64_t nativeGetTranscodeJobOutput(int64_t job);
+
+WIN_EXPORT int nativeGetTranscodeJobError(int64_t job, char* message, int capacity);
+
+WIN_EXPORT void nativeReleaseTranscodeJob(int64_t job);
+
+WIN_EXPORT int nativeGetTranscodeWorkerCount();
+
+WIN_EXPORT int64_t nativeGetJpegContextCreatedCount();
+
+WIN_EXPORT int64_t nativeGetJpegContextReusedCount();
+
+WIN_EXPORT int64_t nativeGetJpegArenaAlignment();
 
 EXTERN_C_END
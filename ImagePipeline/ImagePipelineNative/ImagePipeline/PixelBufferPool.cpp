@@ -0,0 +1,23 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "PixelBufferPool.h"
+#include "pixel_buffer_pool.h"
+
+using facebook::imagepipeline::PixelBufferPool;
+
+void nativeTrimPixelBufferPool()
+{
+	PixelBufferPool::getInstance().trim();
+}
+
+int64_t nativeGetPixelBufferPoolFreeBytes()
+{
+	return (int64_t)PixelBufferPool::getInstance().getFreeBytes();
+}
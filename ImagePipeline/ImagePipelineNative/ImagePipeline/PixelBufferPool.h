@@ -0,0 +1,25 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "common.h"
+
+EXTERN_C_BEGIN
+
+/**
+ * Releases the free buffers of the pixel buffer pool, see
+ * pixel_buffer_pool.h.
+ */
+WIN_EXPORT void nativeTrimPixelBufferPool();
+
+/**
+ * Returns the bytes of free buffers the pool keeps for reuse.
+ */
+WIN_EXPORT int64_t nativeGetPixelBufferPoolFreeBytes();
+
+EXTERN_C_END
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifdef HAS_LIBPNG
+
+#include "PngDecoder.h"
+#include "decoded_image.h"
+#include "transformations.h"
+#include "exceptions.h"
+#include "png/png_codec.h"
+
+using facebook::imagepipeline::PixelFormat;
+using facebook::imagepipeline::ResampleFilter;
+using facebook::imagepipeline::TargetSize;
+using facebook::imagepipeline::png::decodePng;
+using facebook::imagepipeline::png::getPngDecodeSize;
+
+void nativeGetPngDecodeSize(
+	int64_t srcPtr,
+	int srcLen,
+	int targetWidth,
+	int targetHeight,
+	int* width,
+	int* height)
+{
+	THROW_AND_RETURN_IF(srcPtr == 0 || srcLen <= 0, "invalid source");
+	THROW_AND_RETURN_IF(targetWidth < 0 || targetHeight < 0, "target size cannot be negative");
+
+	TargetSize target_size
+	{
+		(uint32_t)targetWidth, (uint32_t)targetHeight
+	};
+
+	unsigned int decoded_width = 0;
+	unsigned int decoded_height = 0;
+	getPngDecodeSize(
+		(const uint8_t*)LONG_TO_PTR(srcPtr),
+		(size_t)srcLen,
+		target_size,
+		decoded_width,
+		decoded_height);
+
+	*width = (int)decoded_width;
+	*height = (int)decoded_height;
+}
+
+void nativeDecodePng(
+	int64_t srcPtr,
+	int srcLen,
+	int targetWidth,
+	int targetHeight,
+	int resampleFilter,
+	int pixelFormat,
+	int64_t dstPtr,
+	int stride,
+	int dstCapacity)
+{
+	THROW_AND_RETURN_IF(srcPtr == 0 || srcLen <= 0, "invalid source");
+	THROW_AND_RETURN_IF(targetWidth < 0 || targetHeight < 0, "target size cannot be negative");
+	THROW_AND_RETURN_IF(
+		resampleFilter < (int)ResampleFilter::LANCZOS3 || resampleFilter > (int)ResampleFilter::BOX,
+		"unsupported resample filter");
+	THROW_AND_RETURN_IF(stride <= 0, "stride should be positive");
+	THROW_AND_RETURN_IF(dstCapacity <= 0, "output capacity should be positive");
+	THROW_AND_RETURN_IF(
+		pixelFormat < (int)PixelFormat::RGB || pixelFormat > (int)PixelFormat::GRAY_ALPHA,
+		"unsupported pixel format");
+
+	TargetSize target_size
+	{
+		(uint32_t)targetWidth, (uint32_t)targetHeight, (ResampleFilter)resampleFilter
+	};
+
+	decodePng(
+		(const uint8_t*)LONG_TO_PTR(srcPtr),
+		(size_t)srcLen,
+		target_size,
+		(PixelFormat)pixelFormat,
+		(uint8_t*)LONG_TO_PTR(dstPtr),
+		(size_t)stride,
+		(size_t)dstCapacity);
+}
+
+#endif // HAS_LIBPNG
@@ -0,0 +1,33 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "common.h"
+
+EXTERN_C_BEGIN
+
+WIN_EXPORT void nativeGetPngDecodeSize(
+	int64_t srcPtr,
+	int srcLen,
+	int targetWidth,
+	int targetHeight,
+	int* width,
+	int* height);
+
+WIN_EXPORT void nativeDecodePng(
+	int64_t srcPtr,
+	int srcLen,
+	int targetWidth,
+	int targetHeight,
+	int resampleFilter,
+	int pixelFormat,
+	int64_t dstPtr,
+	int stride,
+	int dstCapacity);
+
+EXTERN_C_END
@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifdef HAS_LIBWEBP
+
+#include <memory>
+
+#include "WebpTranscoder.h"
+#include "decoded_image.h"
+#include "transformations.h"
+#include "exceptions.h"
+#include "webp/webp_codec.h"
+
+#ifdef HAS_LIBJPEGTURBO
+#include "jpeg/jpeg_codec.h"
+#include "jpeg/jpeg_encode_options.h"
+#endif // HAS_LIBJPEGTURBO
+
+using facebook::imagepipeline::PixelFormat;
+using facebook::imagepipeline::TargetSize;
+using facebook::imagepipeline::webp::decodeWebp;
+using facebook::imagepipeline::webp::getWebpDecodeSize;
+using facebook::imagepipeline::webp::WebpRowDecoder;
+
+void nativeGetWebpDecodeSize(
+	int64_t srcPtr,
+	int srcLen,
+	int targetWidth,
+	int targetHeight,
+	int* width,
+	int* height)
+{
+	THROW_AND_RETURN_IF(srcPtr == 0 || srcLen <= 0, "invalid source");
+	THROW_AND_RETURN_IF(targetWidth < 0 || targetHeight < 0, "target size cannot be negative");
+
+	TargetSize target_size
+	{
+		(uint32_t)targetWidth, (uint32_t)targetHeight
+	};
+
+	unsigned int decoded_width = 0;
+	unsigned int decoded_height = 0;
+	getWebpDecodeSize(
+		(const uint8_t*)LONG_TO_PTR(srcPtr),
+		(size_t)srcLen,
+		target_size,
+		decoded_width,
+		decoded_height);
+
+	*width = (int)decoded_width;
+	*height = (int)decoded_height;
+}
+
+void nativeDecodeWebp(
+	int64_t srcPtr,
+	int srcLen,
+	int targetWidth,
+	int targetHeight,
+	int pixelFormat,
+	int64_t dstPtr,
+	int stride,
+	int dstCapacity)
+{
+	THROW_AND_RETURN_IF(srcPtr == 0 || srcLen <= 0, "invalid source");
+	THROW_AND_RETURN_IF(targetWidth < 0 || targetHeight < 0, "target size cannot be negative");
+	THROW_AND_RETURN_IF(stride <= 0, "stride should be positive");
+	THROW_AND_RETURN_IF(dstCapacity <= 0, "output capacity should be positive");
+	THROW_AND_RETURN_IF(
+		pixelFormat < (int)PixelFormat::RGB || pixelFormat > (int)PixelFormat::GRAY_ALPHA,
+		"unsupported pixel format");
+
+	TargetSize target_size
+	{
+		(uint32_t)targetWidth, (uint32_t)targetHeight
+	};
+
+	decodeWebp(
+		(const uint8_t*)LONG_TO_PTR(srcPtr),
+		(size_t)srcLen,
+		target_size,
+		(PixelFormat)pixelFormat,
+		(uint8_t*)LONG_TO_PTR(dstPtr),
+		(size_t)stride,
+		(size_t)dstCapacity);
+}
+
+void nativeTranscodeWebpToJpeg(
+	int64_t srcPtr,
+	int srcLen,
+	LPSTREAM os,
+	int quality,
+	int optimizeCoding,
+	int progressive,
+	int subsampling,
+	int dctMethod,
+	int restartRows)
+{
+#ifdef HAS_LIBJPEGTURBO
+	using facebook::imagepipeline::jpeg::ChromaSubsampling;
+	using facebook::imagepipeline::jpeg::DctMethod;
+	using facebook::imagepipeline::jpeg::EncodeOptions;
+	using facebook::imagepipeline::jpeg::encodeJpegIntoOutputStream;
+
+	THROW_AND_RETURN_IF(srcPtr == 0 || srcLen <= 0, "invalid source");
+	THROW_AND_RETURN_IF(os == nullptr, "output stream cannot be null");
+
+	EncodeOptions encode_options
+	{
+		quality,
+		optimizeCoding != 0,
+		progressive != 0,
+		(ChromaSubsampling)subsampling,
+		(DctMethod)dctMethod,
+		restartRows
+	};
+
+	// Rows are encoded as libwebp reconstructs them
+	WebpRowDecoder decoder(
+		(const uint8_t*)LONG_TO_PTR(srcPtr),
+		(size_t)srcLen,
+		TargetSize(),
+		PixelFormat::RGB);
+
+	encodeJpegIntoOutputStream(
+		decoder.getWidth(),
+		decoder.getHeight(),
+		[&decoder]() { return decoder.readRow(); },
+		os,
+		encode_options);
+#else // HAS_LIBJPEGTURBO
+	facebook::imagepipeline::safeThrowException("jpeg encoding requires libjpeg-turbo");
+#endif // HAS_LIBJPEGTURBO
+}
+
+#endif // HAS_LIBWEBP
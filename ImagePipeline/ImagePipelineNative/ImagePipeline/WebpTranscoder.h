@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "common.h"
+
+EXTERN_C_BEGIN
+
+WIN_EXPORT void nativeGetWebpDecodeSize(
+	int64_t srcPtr,
+	int srcLen,
+	int targetWidth,
+	int targetHeight,
+	int* width,
+	int* height);
+
+WIN_EXPORT void nativeDecodeWebp(
+	int64_t srcPtr,
+	int srcLen,
+	int targetWidth,
+	int targetHeight,
+	int pixelFormat,
+	int64_t dstPtr,
+	int stride,
+	int dstCapacity);
+
+/**
+ * Decodes the webp at srcPtr and encodes it as jpeg into outputStream.
+ * Alpha is dropped.
+ */
+WIN_EXPORT void nativeTranscodeWebpToJpeg(
+	int64_t srcPtr,
+	int srcLen,
+	LPSTREAM outputStream,
+	int quality,
+	int optimizeCoding,
+	int progressive,
+	int subsampling,
+	int dctMethod,
+	int restartRows);
+
+EXTERN_C_END
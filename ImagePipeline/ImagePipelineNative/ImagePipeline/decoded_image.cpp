@@ -21,11 +21,34 @@ namespace facebook
 				return 3;
 
 				case PixelFormat::RGBA:
+				case PixelFormat::BGRA:
+				case PixelFormat::BGRA_PREMULTIPLIED:
 				return 4;
 
+				case PixelFormat::RGB565:
+				case PixelFormat::GRAY_ALPHA:
+				return 2;
+
+				case PixelFormat::GRAY:
+				return 1;
+
 				default:
 				return 0;
 			}
 		}
+
+		unsigned int computeStride(
+			PixelFormat pixel_format,
+			unsigned int width,
+			unsigned int alignment) 
+		{
+			const unsigned int row_bytes = bytesPerPixel(pixel_format) * width;
+			return (row_bytes + alignment - 1) & ~(alignment - 1);
+		}
+
+		pixels_t borrowPixels(uint8_t* pixels) 
+		{
+			return pixels_t(pixels, [](uint8_t*) {});
+		}
 	} 
 }
@@ -10,9 +10,12 @@
 #ifndef _DECODED_IMAGE_H_
 #define _DECODED_IMAGE_H_
 
+#include <functional>
 #include <memory>
 #include <vector>
 
+#include "exceptions.h"
+
 namespace facebook
 {
 	namespace imagepipeline 
@@ -23,7 +26,18 @@ namespace facebook
 		enum class PixelFormat 
 		{
 			RGB, 
-			RGBA
+			RGBA,
+
+			// Byte order of Windows bitmaps, alpha straight or premultiplied
+			BGRA,
+			BGRA_PREMULTIPLIED,
+
+			// 16-bit words in native byte order, red in the top 5 bits
+			RGB565,
+
+			// Luma of the color, followed by alpha for GRAY_ALPHA
+			GRAY,
+			GRAY_ALPHA
 		};
 
 		/**
@@ -34,15 +48,43 @@ namespace facebook
 		int bytesPerPixel(PixelFormat pixel_format);
 
 		/**
-		 * Type of pixel buffer
+		 * Alignment of the rows of images allocated by the decoders, wide
+		 * enough for AVX2 loads and a cache line.
+		 */
+		static const unsigned int kRowAlignment = 64;
+
+		/**
+		 * Returns the distance in bytes between two rows of given width,
+		 * rounded up to a multiple of alignment.
+		 *
+		 * @param alignment power of two, 1 for packed rows
+		 */
+		unsigned int computeStride(
+			PixelFormat pixel_format,
+			unsigned int width,
+			unsigned int alignment);
+
+		/**
+		 * Type of pixel buffer. The deleter frees the pixels, gives them
+		 * back to the pool they were leased from, or does nothing if they
+		 * are owned by someone else.
 		 */
-		typedef std::unique_ptr<uint8_t, void(*)(uint8_t*)> pixels_t;
+		typedef std::unique_ptr<uint8_t, std::function<void(uint8_t*)>> pixels_t;
+
+		/**
+		 * Wraps pixels owned by the caller, which have to outlive the
+		 * returned pointer.
+		 */
+		pixels_t borrowPixels(uint8_t* pixels);
 
 		/**
 		 * Class representing an image.
 		 *
 		 * <p> Convenient wrapper around pixel buffer and basic information
 		 * used to pass images between different image decoders/encoders.
+		 *
+		 * <p> Rows may be padded, row y starts at getPixelsPtr() + y *
+		 * getStride().
 		 */
 		class DecodedImage 
 		{
@@ -51,6 +93,7 @@ namespace facebook
 			const PixelFormat pixelFormat_;
 			const unsigned int width_;
 			const unsigned int height_;
+			const unsigned int stride_;
 
 			const std::vector<uint8_t> metadata_;
 
@@ -60,13 +103,39 @@ namespace facebook
 				PixelFormat pixelFormat,
 				unsigned int width,
 				unsigned int height,
+				std::vector<uint8_t> metadata) : DecodedImage(
+					std::move(pixels),
+					pixelFormat,
+					width,
+					height,
+					bytesPerPixel(pixelFormat) * width,
+					std::move(metadata))
+			{
+			}
+
+			/**
+			 * @param stride distance in bytes between starts of two rows, at
+			 *        least width times the size of a pixel. Throws if it is
+			 *        smaller.
+			 */
+			DecodedImage(
+				pixels_t&& pixels,
+				PixelFormat pixelFormat,
+				unsigned int width,
+				unsigned int height,
+				unsigned int stride,
 				std::vector<uint8_t> metadata) : pixels_(
 					std::move(pixels)), 
 					pixelFormat_(pixelFormat),
 					width_(width), 
 					height_(height), 
+					stride_(stride),
 					metadata_(std::move(metadata)) 
 			{
+				if (stride_ < bytesPerPixel(pixelFormat_) * width_)
+				{
+					safeThrowException("stride is smaller than a row");
+				}
 			}
 
 			// Disallow copying
@@ -91,7 +160,7 @@ namespace facebook
 
 			unsigned int getStride() const 
 			{
-				return bytesPerPixel(pixelFormat_) * width_;
+				return stride_;
 			}
 
 			unsigned int getWidth() const 
@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <algorithm>
+
+#include <string.h>
+
+#include "exceptions.h"
+#include "gif_animation.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace gif
+		{
+			static const size_t kComponents = 4;
+
+			/**
+			 * Part of a frame that lies on the canvas.
+			 */
+			struct CanvasArea
+			{
+				uint32_t left;
+				uint32_t top;
+				uint32_t right;
+				uint32_t bottom;
+			};
+
+			static CanvasArea getCanvasArea(const GifImage& image, const GifFrame& frame)
+			{
+				return CanvasArea
+				{
+					std::min<uint32_t>(frame.x, image.getWidth()),
+					std::min<uint32_t>(frame.y, image.getHeight()),
+					std::min<uint32_t>(frame.x + frame.width, image.getWidth()),
+					std::min<uint32_t>(frame.y + frame.height, image.getHeight())
+				};
+			}
+
+			GifAnimation::GifAnimation(
+				const uint8_t* data,
+				size_t length,
+				size_t cache_capacity,
+				uint32_t keyframe_interval)
+				: image_(data, length),
+				  cache_(cache_capacity),
+				  keyframe_interval_(keyframe_interval),
+				  canvas_((size_t)image_.getWidth() * image_.getHeight() * kComponents, 0),
+				  next_frame_(0),
+				  decoded_frames_(0)
+			{
+				size_t max_frame_pixels = 0;
+				for (uint32_t i = 0; i < image_.getFrameCount(); ++i)
+				{
+					const GifFrame& frame = image_.getFrame(i);
+					max_frame_pixels = std::max<size_t>(
+						max_frame_pixels,
+						(size_t)frame.width * frame.height);
+				}
+
+				indices_.resize(max_frame_pixels);
+			}
+
+			size_t GifAnimation::getMaxMemorySize() const
+			{
+				return image_.getDataSize() +
+					image_.getFrameCount() * sizeof(GifFrame) +
+					2 * canvas_.size() +
+					indices_.size() +
+					cache_.getCapacity();
+			}
+
+			void GifAnimation::renderFrame(
+				uint32_t index,
+				PixelFormat pixel_format,
+				uint8_t* pixels,
+				size_t stride,
+				size_t capacity)
+			{
+				THROW_AND_RETURN_IF(index >= image_.getFrameCount(), "frame index is out of range");
+				THROW_AND_RETURN_IF(pixels == nullptr, "pixels cannot be null");
+
+				const PixelConverter converter(PixelFormat::RGBA, pixel_format);
+				const size_t row_bytes = (size_t)image_.getWidth() * bytesPerPixel(pixel_format);
+				THROW_AND_RETURN_IF(stride < row_bytes, "stride is too small for the decoded rows");
+				THROW_AND_RETURN_IF(
+					capacity < stride * (image_.getHeight() - 1) + row_bytes,
+					"output buffer is too small for the decoded image");
+
+				seek(index);
+				advance(pixels, stride, &converter);
+			}
+
+			/**
+			 * Brings the canvas to the state frame index is drawn onto.
+			 */
+			void GifAnimation::seek(uint32_t index)
+			{
+				if (index == next_frame_)
+				{
+					return;
+				}
+
+				uint32_t cached_frame = 0;
+				const std::vector<uint8_t>* snapshot = cache_.findLatest(index, cached_frame);
+				if (snapshot != nullptr && (index < next_frame_ || cached_frame > next_frame_))
+				{
+					canvas_ = *snapshot;
+					next_frame_ = cached_frame;
+				}
+				else if (index < next_frame_)
+				{
+					std::fill(canvas_.begin(), canvas_.end(), (uint8_t)0);
+					next_frame_ = 0;
+				}
+
+				while (next_frame_ < index)
+				{
+					advance(nullptr, 0, nullptr);
+				}
+			}
+
+			/**
+			 * Draws the next frame, converts the canvas into pixels unless
+			 * null and disposes the frame. Takes a snapshot if the frame after
+			 * it is a keyframe.
+			 */
+			void GifAnimation::advance(
+				uint8_t* pixels,
+				size_t stride,
+				const PixelConverter* converter)
+			{
+				const GifFrame& frame = image_.getFrame(next_frame_);
+				if (frame.disposal == DisposalMethod::RESTORE_TO_PREVIOUS)
+				{
+					saveArea(frame);
+				}
+
+				drawFrame(frame);
+				if (pixels != nullptr)
+				{
+					const size_t row_bytes = (size_t)image_.getWidth() * kComponents;
+					for (uint32_t y = 0; y < image_.getHeight(); ++y)
+					{
+						converter->convertRow(
+							canvas_.data() + y * row_bytes,
+							pixels + y * stride,
+							image_.getWidth());
+					}
+				}
+
+				disposeFrame(frame);
+				++next_frame_;
+
+				if (keyframe_interval_ != 0 &&
+					next_frame_ % keyframe_interval_ == 0 &&
+					next_frame_ < image_.getFrameCount())
+				{
+					cache_.put(next_frame_, canvas_);
+				}
+			}
+
+			void GifAnimation::drawFrame(const GifFrame& frame)
+			{
+				const size_t count = image_.decodeIndices(frame, indices_.data());
+				++decoded_frames_;
+
+				const uint8_t* color_table = image_.getColorTable(frame);
+				if (color_table == nullptr)
+				{
+					return;
+				}
+
+				const CanvasArea area = getCanvasArea(image_, frame);
+				const uint32_t columns = area.right - area.left;
+				for (uint32_t row = 0; row < frame.height; ++row)
+				{
+					const size_t row_start = (size_t)row * frame.width;
+					if (row_start >= count)
+					{
+						break;
+					}
+
+					const uint32_t y = frame.y + GifImage::getDisplayRow(frame, row);
+					if (y >= area.bottom)
+					{
+						continue;
+					}
+
+					const uint8_t* in = indices_.data() + row_start;
+					uint8_t* out = canvas_.data() + ((size_t)y * image_.getWidth() + area.left) * kComponents;
+					const uint32_t decoded_columns = (uint32_t)std::min<size_t>(columns, count - row_start);
+					for (uint32_t x = 0; x < decoded_columns; ++x, out += kComponents)
+					{
+						const uint8_t index = in[x];
+						if (index == frame.transparent_index || index >= frame.color_table_size)
+						{
+							continue;
+						}
+
+						const uint8_t* color = color_table + index * 3;
+						out[0] = color[0];
+						out[1] = color[1];
+						out[2] = color[2];
+						out[3] = 0xff;
+					}
+				}
+			}
+
+			void GifAnimation::saveArea(const GifFrame& frame)
+			{
+				const CanvasArea area = getCanvasArea(image_, frame);
+				const size_t area_row_bytes = (size_t)(area.right - area.left) * kComponents;
+				previous_.resize(area_row_bytes * (area.bottom - area.top));
+				for (uint32_t y = area.top; y < area.bottom; ++y)
+				{
+					memcpy(
+						previous_.data() + (y - area.top) * area_row_bytes,
+						canvas_.data() + ((size_t)y * image_.getWidth() + area.left) * kComponents,
+						area_row_bytes);
+				}
+			}
+
+			void GifAnimation::disposeFrame(const GifFrame& frame)
+			{
+				const CanvasArea area = getCanvasArea(image_, frame);
+				const size_t area_row_bytes = (size_t)(area.right - area.left) * kComponents;
+				for (uint32_t y = area.top; y < area.bottom; ++y)
+				{
+					uint8_t* out = canvas_.data() + ((size_t)y * image_.getWidth() + area.left) * kComponents;
+					switch (frame.disposal)
+					{
+					case DisposalMethod::RESTORE_TO_BACKGROUND:
+						memset(out, 0, area_row_bytes);
+						break;
+
+					case DisposalMethod::RESTORE_TO_PREVIOUS:
+						memcpy(out, previous_.data() + (y - area.top) * area_row_bytes, area_row_bytes);
+						break;
+
+					default:
+						return;
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef _GIF_ANIMATION_H_
+#define _GIF_ANIMATION_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "gif_frame_cache.h"
+#include "gif_image.h"
+#include "pixel_conversion.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace gif
+		{
+			/**
+			 * Renders the frames of a gif one at a time onto an RGBA canvas.
+			 *
+			 * <p> The canvas holds the state the next frame is drawn onto, so
+			 * playing frames in order decodes each of them once. Every
+			 * keyframe_interval frames a snapshot of the canvas goes to the
+			 * frame cache. Seeking restores the latest snapshot before the
+			 * requested frame and only replays the frames after it.
+			 *
+			 * <p> Frames are composited the way browsers do, starting from a
+			 * transparent canvas and ignoring the background color.
+			 */
+			class GifAnimation
+			{
+			private:
+				const GifImage image_;
+				GifFrameCache cache_;
+				const uint32_t keyframe_interval_;
+
+				// RGBA canvas next_frame_ is drawn onto
+				std::vector<uint8_t> canvas_;
+				uint32_t next_frame_;
+
+				// Area of the canvas restored after a RESTORE_TO_PREVIOUS frame
+				std::vector<uint8_t> previous_;
+				std::vector<uint8_t> indices_;
+				uint32_t decoded_frames_;
+
+				void seek(uint32_t index);
+
+				void advance(uint8_t* pixels, size_t stride, const PixelConverter* converter);
+
+				void drawFrame(const GifFrame& frame);
+
+				void saveArea(const GifFrame& frame);
+
+				void disposeFrame(const GifFrame& frame);
+
+			public:
+				/**
+				 * @param data pointer to encoded gif
+				 * @param length number of encoded bytes
+				 * @param cache_capacity bytes of canvas snapshots kept
+				 * @param keyframe_interval frames between two snapshots, 0 to
+				 *        never take one
+				 */
+				GifAnimation(
+					const uint8_t* data,
+					size_t length,
+					size_t cache_capacity,
+					uint32_t keyframe_interval);
+
+				// Disallow copying
+				GifAnimation(const GifAnimation& other) = delete;
+
+				GifAnimation& operator=(const GifAnimation& other) = delete;
+
+				const GifImage& getImage() const
+				{
+					return image_;
+				}
+
+				/**
+				 * Returns the number of frames decompressed so far, including
+				 * the ones replayed while seeking.
+				 */
+				uint32_t getDecodedFrameCount() const
+				{
+					return decoded_frames_;
+				}
+
+				size_t getCacheSize() const
+				{
+					return cache_.getSize();
+				}
+
+				/**
+				 * Returns an upper bound of the memory held: the encoded
+				 * bytes, the canvas, the area saved for frames restoring the
+				 * previous one, the color indices and the frame cache.
+				 */
+				size_t getMaxMemorySize() const;
+
+				/**
+				 * Writes frame index as it is displayed, rows of the full canvas
+				 * in given pixel format starting at pixels + y * stride.
+				 */
+				void renderFrame(
+					uint32_t index,
+					PixelFormat pixel_format,
+					uint8_t* pixels,
+					size_t stride,
+					size_t capacity);
+			};
+		}
+	}
+}
+
+#endif // _GIF_ANIMATION_H_
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "gif_frame_cache.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace gif
+		{
+			GifFrameCache::GifFrameCache(size_t capacity)
+				: capacity_(capacity),
+				  size_(0)
+			{
+			}
+
+			bool GifFrameCache::contains(uint32_t frame) const
+			{
+				for (const Entry& entry : entries_)
+				{
+					if (entry.frame == frame)
+					{
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			void GifFrameCache::put(uint32_t frame, const std::vector<uint8_t>& canvas)
+			{
+				if (canvas.size() > capacity_ || contains(frame))
+				{
+					return;
+				}
+
+				while (size_ + canvas.size() > capacity_)
+				{
+					size_ -= entries_.back().canvas.size();
+					entries_.pop_back();
+				}
+
+				entries_.push_front(Entry{ frame, canvas });
+				size_ += canvas.size();
+			}
+
+			const std::vector<uint8_t>* GifFrameCache::findLatest(
+				uint32_t frame,
+				uint32_t& cached_frame)
+			{
+				auto latest = entries_.end();
+				for (auto it = entries_.begin(); it != entries_.end(); ++it)
+				{
+					if (it->frame <= frame && (latest == entries_.end() || it->frame > latest->frame))
+					{
+						latest = it;
+					}
+				}
+
+				if (latest == entries_.end())
+				{
+					return nullptr;
+				}
+
+				entries_.splice(entries_.begin(), entries_, latest);
+				cached_frame = latest->frame;
+				return &latest->canvas;
+			}
+		}
+	}
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef _GIF_FRAME_CACHE_H_
+#define _GIF_FRAME_CACHE_H_
+
+#include <stdint.h>
+#include <list>
+#include <vector>
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace gif
+		{
+			/**
+			 * Snapshots of the canvas of an animation, bounded by bytes.
+			 *
+			 * <p> The least recently used snapshot is evicted first.
+			 * Snapshots larger than the capacity are not kept at all.
+			 */
+			class GifFrameCache
+			{
+			private:
+				struct Entry
+				{
+					uint32_t frame;
+					std::vector<uint8_t> canvas;
+				};
+
+				const size_t capacity_;
+				size_t size_;
+
+				// Most recently used first
+				std::list<Entry> entries_;
+
+			public:
+				explicit GifFrameCache(size_t capacity);
+
+				// Disallow copying
+				GifFrameCache(const GifFrameCache& other) = delete;
+
+				GifFrameCache& operator=(const GifFrameCache& other) = delete;
+
+				bool contains(uint32_t frame) const;
+
+				/**
+				 * Keeps a copy of the canvas the given frame is drawn onto.
+				 */
+				void put(uint32_t frame, const std::vector<uint8_t>& canvas);
+
+				/**
+				 * Finds the snapshot of the latest frame no later than the
+				 * given one.
+				 *
+				 * @param frame frame to look up
+				 * @param cached_frame receives the frame of the snapshot
+				 * @return the snapshot, null if there is none
+				 */
+				const std::vector<uint8_t>* findLatest(uint32_t frame, uint32_t& cached_frame);
+
+				size_t getSize() const
+				{
+					return size_;
+				}
+
+				size_t getCapacity() const
+				{
+					return capacity_;
+				}
+			};
+		}
+	}
+}
+
+#endif // _GIF_FRAME_CACHE_H_
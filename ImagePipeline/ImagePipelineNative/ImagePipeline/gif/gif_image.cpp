@@ -0,0 +1,460 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <string.h>
+
+#include "exceptions.h"
+#include "gif_image.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace gif
+		{
+			static const size_t kHeaderLength = 13;
+			static const size_t kMaxPixels = 1 << 26;
+
+			static const uint8_t kExtensionIntroducer = 0x21;
+			static const uint8_t kImageSeparator = 0x2c;
+			static const uint8_t kTrailer = 0x3b;
+			static const uint8_t kGraphicControlLabel = 0xf9;
+			static const uint8_t kApplicationLabel = 0xff;
+
+			static const uint32_t kMaxCodeSize = 12;
+			static const uint32_t kMaxCodes = 1 << kMaxCodeSize;
+
+			/**
+			 * Browsers show frames of 10 ms or less for 100 ms, so do we.
+			 */
+			static const uint32_t kMinDurationMs = 20;
+			static const uint32_t kDefaultDurationMs = 100;
+
+			/**
+			 * Bounds checked cursor over the encoded bytes.
+			 */
+			class GifReader
+			{
+			private:
+				const uint8_t* data_;
+				size_t length_;
+				size_t offset_;
+
+			public:
+				GifReader(const uint8_t* data, size_t length)
+					: data_(data),
+					  length_(length),
+					  offset_(0)
+				{
+				}
+
+				size_t getOffset() const
+				{
+					return offset_;
+				}
+
+				bool has(size_t count) const
+				{
+					return count <= length_ - offset_;
+				}
+
+				uint8_t readByte()
+				{
+					return data_[offset_++];
+				}
+
+				uint32_t readShort()
+				{
+					const uint32_t value = data_[offset_] | (data_[offset_ + 1] << 8);
+					offset_ += 2;
+					return value;
+				}
+
+				const uint8_t* current() const
+				{
+					return data_ + offset_;
+				}
+
+				void skip(size_t count)
+				{
+					offset_ += count;
+				}
+
+				/**
+				 * Skips data sub-blocks up to and including the terminator.
+				 *
+				 * @return false if the data ends first
+				 */
+				bool skipSubBlocks()
+				{
+					while (has(1))
+					{
+						const uint8_t size = readByte();
+						if (size == 0)
+						{
+							return true;
+						}
+
+						if (!has(size))
+						{
+							return false;
+						}
+
+						skip(size);
+					}
+
+					return false;
+				}
+			};
+
+			/**
+			 * Graphic control extension, applies to the next frame only.
+			 */
+			struct GraphicControl
+			{
+				uint32_t duration_ms;
+				DisposalMethod disposal;
+				int transparent_index;
+			};
+
+			static GraphicControl defaultGraphicControl()
+			{
+				return GraphicControl
+				{
+					kDefaultDurationMs, DisposalMethod::NONE, -1
+				};
+			}
+
+			/**
+			 * Reads the extension following its introducer.
+			 *
+			 * @return false if the data ends first
+			 */
+			static bool readExtension(
+				GifReader& reader,
+				GraphicControl& control,
+				int& loop_count)
+			{
+				if (!reader.has(1))
+				{
+					return false;
+				}
+
+				const uint8_t label = reader.readByte();
+				if (label == kGraphicControlLabel && reader.has(6) && reader.current()[0] == 4)
+				{
+					reader.skip(1);
+					const uint8_t packed = reader.readByte();
+					const uint32_t delay = reader.readShort();
+					const uint8_t transparent_index = reader.readByte();
+
+					control.duration_ms = delay * 10 < kMinDurationMs ? kDefaultDurationMs : delay * 10;
+					control.disposal = (DisposalMethod)((packed >> 2) & 0x07);
+					if (control.disposal > DisposalMethod::RESTORE_TO_PREVIOUS)
+					{
+						control.disposal = DisposalMethod::NONE;
+					}
+
+					control.transparent_index = (packed & 0x01) ? transparent_index : -1;
+				}
+				else if (label == kApplicationLabel && reader.has(12) && reader.current()[0] == 11)
+				{
+					const bool is_loop_extension =
+						memcmp(reader.current() + 1, "NETSCAPE2.0", 11) == 0 ||
+						memcmp(reader.current() + 1, "ANIMEXTS1.0", 11) == 0;
+
+					reader.skip(12);
+					if (is_loop_extension && reader.has(4) &&
+						reader.current()[0] == 3 &&
+						reader.current()[1] == 1)
+					{
+						reader.skip(2);
+						loop_count = reader.readShort();
+					}
+				}
+
+				return reader.skipSubBlocks();
+			}
+
+			GifImage::GifImage(const uint8_t* data, size_t length)
+				: width_(0),
+				  height_(0),
+				  loop_count_(-1)
+			{
+				THROW_AND_RETURN_IF(data == nullptr, "gif data cannot be null");
+				THROW_AND_RETURN_IF(
+					length < kHeaderLength ||
+						(memcmp(data, "GIF87a", 6) != 0 && memcmp(data, "GIF89a", 6) != 0),
+					"invalid gif signature");
+
+				data_.assign(data, data + length);
+				GifReader reader(data_.data(), data_.size());
+				reader.skip(6);
+				width_ = reader.readShort();
+				height_ = reader.readShort();
+				const uint8_t packed = reader.readByte();
+				reader.skip(2);
+
+				THROW_AND_RETURN_IF(width_ == 0 || height_ == 0, "gif has no pixels");
+				THROW_AND_RETURN_IF((size_t)width_ * height_ > kMaxPixels, "gif is too large");
+
+				size_t global_table_offset = 0;
+				uint32_t global_table_size = 0;
+				if (packed & 0x80)
+				{
+					global_table_size = 2u << (packed & 0x07);
+					global_table_offset = reader.getOffset();
+					THROW_AND_RETURN_IF(!reader.has(global_table_size * 3), "gif data is incomplete");
+					reader.skip(global_table_size * 3);
+				}
+
+				GraphicControl control = defaultGraphicControl();
+				bool complete = true;
+				while (complete && reader.has(1))
+				{
+					const uint8_t introducer = reader.readByte();
+					if (introducer == kTrailer)
+					{
+						break;
+					}
+					else if (introducer == kExtensionIntroducer)
+					{
+						complete = readExtension(reader, control, loop_count_);
+					}
+					else if (introducer == kImageSeparator)
+					{
+						if (!reader.has(9))
+						{
+							break;
+						}
+
+						GifFrame frame;
+						frame.x = reader.readShort();
+						frame.y = reader.readShort();
+						frame.width = reader.readShort();
+						frame.height = reader.readShort();
+						if ((size_t)frame.width * frame.height > kMaxPixels)
+						{
+							// Decoding it would need more memory than any valid
+							// frame, the data can't be trusted from here on
+							break;
+						}
+
+						const uint8_t frame_packed = reader.readByte();
+						frame.interlaced = (frame_packed & 0x40) != 0;
+						frame.duration_ms = control.duration_ms;
+						frame.disposal = control.disposal;
+						frame.transparent_index = control.transparent_index;
+						frame.color_table_offset = global_table_offset;
+						frame.color_table_size = global_table_size;
+						if (frame_packed & 0x80)
+						{
+							frame.color_table_size = 2u << (frame_packed & 0x07);
+							frame.color_table_offset = reader.getOffset();
+							if (!reader.has(frame.color_table_size * 3))
+							{
+								break;
+							}
+
+							reader.skip(frame.color_table_size * 3);
+						}
+
+						frame.data_offset = reader.getOffset();
+						if (!reader.has(1))
+						{
+							break;
+						}
+
+						reader.skip(1);
+						complete = reader.skipSubBlocks();
+						if (complete)
+						{
+							frames_.push_back(frame);
+						}
+
+						control = defaultGraphicControl();
+					}
+					else
+					{
+						// Unknown block, nothing after it can be trusted
+						break;
+					}
+				}
+
+				THROW_AND_RETURN_IF(frames_.empty(), "gif has no complete frame");
+			}
+
+			const uint8_t* GifImage::getColorTable(const GifFrame& frame) const
+			{
+				return frame.color_table_size != 0 ? data_.data() + frame.color_table_offset : nullptr;
+			}
+
+			size_t GifImage::decodeIndices(const GifFrame& frame, uint8_t* indices) const
+			{
+				const size_t pixel_count = (size_t)frame.width * frame.height;
+				const uint8_t* in = data_.data() + frame.data_offset;
+				const uint8_t* const end = data_.data() + data_.size();
+
+				const uint32_t min_code_size = *in++;
+				if (min_code_size == 0 || min_code_size >= kMaxCodeSize)
+				{
+					return 0;
+				}
+
+				uint16_t prefixes[kMaxCodes];
+				uint8_t suffixes[kMaxCodes];
+				uint8_t stack[kMaxCodes + 1];
+
+				const uint32_t clear_code = 1 << min_code_size;
+				const uint32_t end_code = clear_code + 1;
+				uint32_t code_size = min_code_size + 1;
+				uint32_t next_code = clear_code + 2;
+				int previous_code = -1;
+				uint8_t first_byte = 0;
+
+				uint32_t bits = 0;
+				uint32_t bit_count = 0;
+				uint32_t block_remaining = 0;
+				size_t count = 0;
+
+				while (count < pixel_count)
+				{
+					while (bit_count < code_size)
+					{
+						if (block_remaining == 0)
+						{
+							if (in >= end || *in == 0)
+							{
+								return count;
+							}
+
+							block_remaining = *in++;
+						}
+
+						if (in >= end)
+						{
+							return count;
+						}
+
+						bits |= (uint32_t)*in++ << bit_count;
+						bit_count += 8;
+						--block_remaining;
+					}
+
+					uint32_t code = bits & ((1 << code_size) - 1);
+					bits >>= code_size;
+					bit_count -= code_size;
+
+					if (code == clear_code)
+					{
+						code_size = min_code_size + 1;
+						next_code = clear_code + 2;
+						previous_code = -1;
+						continue;
+					}
+
+					if (code == end_code)
+					{
+						break;
+					}
+
+					if (previous_code < 0)
+					{
+						if (code > clear_code)
+						{
+							break;
+						}
+
+						first_byte = (uint8_t)code;
+						indices[count++] = first_byte;
+						previous_code = code;
+						continue;
+					}
+
+					const uint32_t current_code = code;
+					uint32_t depth = 0;
+					if (code >= next_code)
+					{
+						if (code > next_code)
+						{
+							break;
+						}
+
+						// The code being defined, previous string + its first byte
+						stack[depth++] = first_byte;
+						code = previous_code;
+					}
+
+					while (code > clear_code)
+					{
+						stack[depth++] = suffixes[code];
+						code = prefixes[code];
+					}
+
+					first_byte = (uint8_t)code;
+					stack[depth++] = first_byte;
+
+					if (next_code < kMaxCodes)
+					{
+						prefixes[next_code] = (uint16_t)previous_code;
+						suffixes[next_code] = first_byte;
+						++next_code;
+						if (next_code == (1u << code_size) && code_size < kMaxCodeSize)
+						{
+							++code_size;
+						}
+					}
+
+					while (depth > 0 && count < pixel_count)
+					{
+						indices[count++] = stack[--depth];
+					}
+
+					previous_code = current_code;
+				}
+
+				return count;
+			}
+
+			uint32_t GifImage::getDisplayRow(const GifFrame& frame, uint32_t row)
+			{
+				if (!frame.interlaced)
+				{
+					return row;
+				}
+
+				// Every 8th row from 0, every 8th from 4, every 4th from 2,
+				// every 2nd from 1
+				const uint32_t height = frame.height;
+				const uint32_t pass1 = (height + 7) / 8;
+				if (row < pass1)
+				{
+					return row * 8;
+				}
+
+				row -= pass1;
+				const uint32_t pass2 = (height + 3) / 8;
+				if (row < pass2)
+				{
+					return 4 + row * 8;
+				}
+
+				row -= pass2;
+				const uint32_t pass3 = (height + 1) / 4;
+				if (row < pass3)
+				{
+					return 2 + row * 4;
+				}
+
+				row -= pass3;
+				return 1 + row * 2;
+			}
+		}
+	}
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef _GIF_IMAGE_H_
+#define _GIF_IMAGE_H_
+
+#include <stdint.h>
+#include <vector>
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace gif
+		{
+			/**
+			 * What happens to the area of a frame once it has been shown.
+			 */
+			enum class DisposalMethod
+			{
+				NONE = 0,
+				KEEP = 1,
+				RESTORE_TO_BACKGROUND = 2,
+				RESTORE_TO_PREVIOUS = 3
+			};
+
+			/**
+			 * Frame of a gif, located in the encoded bytes but not decoded.
+			 */
+			struct GifFrame
+			{
+				uint32_t x;
+				uint32_t y;
+				uint32_t width;
+				uint32_t height;
+				uint32_t duration_ms;
+				DisposalMethod disposal;
+				int transparent_index;
+				bool interlaced;
+
+				// Offset and number of entries of the color table, the
+				// global one unless the frame has its own
+				size_t color_table_offset;
+				uint32_t color_table_size;
+
+				// Offset of the LZW minimum code size, followed by the
+				// data sub-blocks
+				size_t data_offset;
+			};
+
+			/**
+			 * Container of a gif, parsed once up front.
+			 *
+			 * <p> Parsing only walks the blocks, frames are decoded on
+			 * demand. The encoded bytes are copied, the image does not
+			 * depend on the memory it was created from.
+			 */
+			class GifImage
+			{
+			private:
+				std::vector<uint8_t> data_;
+				uint32_t width_;
+				uint32_t height_;
+				int loop_count_;
+				std::vector<GifFrame> frames_;
+
+			public:
+				/**
+				 * Parses the blocks of given gif. Truncated images keep the
+				 * frames whose data is complete.
+				 */
+				GifImage(const uint8_t* data, size_t length);
+
+				// Disallow copying
+				GifImage(const GifImage& other) = delete;
+
+				GifImage& operator=(const GifImage& other) = delete;
+
+				uint32_t getWidth() const
+				{
+					return width_;
+				}
+
+				uint32_t getHeight() const
+				{
+					return height_;
+				}
+
+				/**
+				 * Returns the number of times the animation repeats, 0 to
+				 * repeat forever and -1 to play it once.
+				 */
+				int getLoopCount() const
+				{
+					return loop_count_;
+				}
+
+				uint32_t getFrameCount() const
+				{
+					return (uint32_t)frames_.size();
+				}
+
+				const GifFrame& getFrame(uint32_t index) const
+				{
+					return frames_[index];
+				}
+
+				/**
+				 * Returns the number of encoded bytes kept by the image.
+				 */
+				size_t getDataSize() const
+				{
+					return data_.size();
+				}
+
+				/**
+				 * Returns the RGB color table of given frame, null if there
+				 * is none.
+				 */
+				const uint8_t* getColorTable(const GifFrame& frame) const;
+
+				/**
+				 * Decompresses the color indices of given frame in the order
+				 * they are stored, see getDisplayRow for interlaced frames.
+				 *
+				 * @param frame frame to decode
+				 * @param indices destination of frame.width * frame.height
+				 *        indices
+				 * @return number of indices decoded, fewer than the frame has
+				 *         if its data is corrupt
+				 */
+				size_t decodeIndices(const GifFrame& frame, uint8_t* indices) const;
+
+				/**
+				 * Returns the row of the frame the stored row is displayed at.
+				 */
+				static uint32_t getDisplayRow(const GifFrame& frame, uint32_t row);
+			};
+		}
+	}
+}
+
+#endif // _GIF_IMAGE_H_
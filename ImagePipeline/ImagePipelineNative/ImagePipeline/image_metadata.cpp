@@ -0,0 +1,512 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <string.h>
+
+#include "image_metadata.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		static const uint8_t MARKER_PREFIX = 0xFF;
+		static const uint8_t MARKER_SOI = 0xD8;
+		static const uint8_t MARKER_EOI = 0xD9;
+		static const uint8_t MARKER_SOS = 0xDA;
+		static const uint8_t MARKER_TEM = 0x01;
+		static const uint8_t MARKER_APP0 = 0xE0;
+		static const uint8_t MARKER_APP1 = 0xE1;
+		static const uint8_t MARKER_APP15 = 0xEF;
+
+		static const uint16_t TIFF_TAG_ORIENTATION = 0x0112;
+		static const uint16_t TIFF_TAG_JPEG_INTERCHANGE_FORMAT = 0x0201;
+		static const uint16_t TIFF_TAG_JPEG_INTERCHANGE_FORMAT_LENGTH = 0x0202;
+		static const uint16_t TIFF_TYPE_SHORT = 3;
+		static const uint16_t TIFF_TYPE_LONG = 4;
+
+		static const size_t SIMPLE_WEBP_HEADER_LENGTH = 20;
+		static const size_t EXTENDED_WEBP_HEADER_LENGTH = 21;
+
+		static uint16_t readUint16(const uint8_t* data, bool little_endian)
+		{
+			return little_endian ?
+				(uint16_t)(data[0] | (data[1] << 8)) :
+				(uint16_t)((data[0] << 8) | data[1]);
+		}
+
+		static uint32_t readUint32(const uint8_t* data, bool little_endian)
+		{
+			return little_endian ?
+				(uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+					((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24) :
+				((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) |
+					((uint32_t)data[2] << 8) | (uint32_t)data[3];
+		}
+
+		static bool startsWith(
+			const uint8_t* data,
+			size_t length,
+			size_t offset,
+			const char* pattern)
+		{
+			size_t pattern_length = strlen(pattern);
+			return offset + pattern_length <= length &&
+				memcmp(data + offset, pattern, pattern_length) == 0;
+		}
+
+		static bool isSofMarker(uint8_t marker)
+		{
+			// There are no SOF4, SOF8 and SOF12, those are DHT, JPG and DAC
+			return marker >= 0xC0 && marker <= 0xCF &&
+				marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+		}
+
+		static bool isProgressiveSofMarker(uint8_t marker)
+		{
+			return marker == 0xC2 || marker == 0xC6 || marker == 0xCA || marker == 0xCE;
+		}
+
+		static bool isRstMarker(uint8_t marker)
+		{
+			return marker >= 0xD0 && marker <= 0xD7;
+		}
+
+		/**
+		 * Reads the header of TIFF data, returning false if it is invalid.
+		 */
+		static bool readTiffHeader(
+			const uint8_t* tiff,
+			size_t length,
+			bool& little_endian,
+			uint32_t& first_ifd_offset)
+		{
+			if (length <= 8)
+			{
+				return false;
+			}
+
+			if (tiff[0] == 'I' && tiff[1] == 'I' && tiff[2] == 0x2A && tiff[3] == 0)
+			{
+				little_endian = true;
+			}
+			else if (tiff[0] == 'M' && tiff[1] == 'M' && tiff[2] == 0 && tiff[3] == 0x2A)
+			{
+				little_endian = false;
+			}
+			else
+			{
+				return false;
+			}
+
+			// Offsets are relative to the beginning of the TIFF data
+			first_ifd_offset = readUint32(tiff + 4, little_endian);
+			return first_ifd_offset >= 8;
+		}
+
+		/**
+		 * Returns the entry of the IFD at ifd_offset with given tag, or
+		 * nullptr if there is none. Each entry is
+		 * {TAG [2], TYPE [2], COUNT [4], VALUE/OFFSET [4]}.
+		 */
+		static const uint8_t* findTiffEntry(
+			const uint8_t* tiff,
+			size_t length,
+			bool little_endian,
+			uint32_t ifd_offset,
+			uint16_t tag)
+		{
+			if (ifd_offset < 8 || ifd_offset > length - 2)
+			{
+				return nullptr;
+			}
+
+			size_t entry_count = readUint16(tiff + ifd_offset, little_endian);
+			const uint8_t* entry = tiff + ifd_offset + 2;
+			for (; entry_count > 0 && entry + 12 <= tiff + length; --entry_count, entry += 12)
+			{
+				if (readUint16(entry, little_endian) == tag)
+				{
+					return entry;
+				}
+			}
+
+			return nullptr;
+		}
+
+		/**
+		 * Returns the offset of the IFD following the one at ifd_offset,
+		 * 0 if it is the last one.
+		 */
+		static uint32_t getNextIfdOffset(
+			const uint8_t* tiff,
+			size_t length,
+			bool little_endian,
+			uint32_t ifd_offset)
+		{
+			if (ifd_offset < 8 || ifd_offset > length - 2)
+			{
+				return 0;
+			}
+
+			size_t next_offset_position =
+				ifd_offset + 2 + 12 * (size_t)readUint16(tiff + ifd_offset, little_endian);
+			if (next_offset_position + 4 > length)
+			{
+				return 0;
+			}
+
+			return readUint32(tiff + next_offset_position, little_endian);
+		}
+
+		/**
+		 * Reads the single SHORT or LONG value of an entry, returning false
+		 * if the entry holds anything else.
+		 */
+		static bool readTiffInteger(const uint8_t* entry, bool little_endian, uint32_t& value)
+		{
+			if (readUint32(entry + 4, little_endian) != 1)
+			{
+				return false;
+			}
+
+			switch (readUint16(entry + 2, little_endian))
+			{
+			case TIFF_TYPE_SHORT:
+				value = readUint16(entry + 8, little_endian);
+				return true;
+
+			case TIFF_TYPE_LONG:
+				value = readUint32(entry + 8, little_endian);
+				return true;
+
+			default:
+				return false;
+			}
+		}
+
+		/**
+		 * Returns the TIFF data of an APP1 segment payload, or nullptr if
+		 * it does not hold EXIF data.
+		 */
+		static const uint8_t* getExifTiffData(
+			const uint8_t* payload,
+			size_t payload_length,
+			size_t& tiff_length)
+		{
+			static const uint8_t EXIF_HEADER[] = { 'E', 'x', 'i', 'f', 0, 0 };
+			if (payload_length <= sizeof(EXIF_HEADER) ||
+				memcmp(payload, EXIF_HEADER, sizeof(EXIF_HEADER)) != 0)
+			{
+				return nullptr;
+			}
+
+			tiff_length = payload_length - sizeof(EXIF_HEADER);
+			return payload + sizeof(EXIF_HEADER);
+		}
+
+		/**
+		 * Reads the orientation tag of the first IFD of EXIF data.
+		 *
+		 * @return 1 - 8, or 0 if the tag is missing or invalid
+		 */
+		static int readExifOrientation(const uint8_t* tiff, size_t length)
+		{
+			bool little_endian;
+			uint32_t ifd_offset;
+			if (!readTiffHeader(tiff, length, little_endian, ifd_offset))
+			{
+				return 0;
+			}
+
+			const uint8_t* entry = findTiffEntry(
+				tiff, length, little_endian, ifd_offset, TIFF_TAG_ORIENTATION);
+
+			// The orientation is a single SHORT
+			if (entry == nullptr ||
+				readUint16(entry + 2, little_endian) != TIFF_TYPE_SHORT ||
+				readUint32(entry + 4, little_endian) != 1)
+			{
+				return 0;
+			}
+
+			int orientation = readUint16(entry + 8, little_endian);
+			return (orientation >= 1 && orientation <= 8) ? orientation : 0;
+		}
+
+		static void parseJpegMetaData(
+			const uint8_t* data,
+			size_t length,
+			ImageMetaData& meta_data)
+		{
+			bool app1_seen = false;
+			size_t position = 2;
+			while (position < length && data[position] == MARKER_PREFIX)
+			{
+				// Any number of fill bytes may precede a marker
+				while (position < length && data[position] == MARKER_PREFIX)
+				{
+					++position;
+				}
+
+				if (position >= length)
+				{
+					return;
+				}
+
+				uint8_t marker = data[position++];
+				if (marker == MARKER_SOI || marker == MARKER_TEM || isRstMarker(marker))
+				{
+					continue;
+				}
+
+				// Header segments do not follow these
+				if (marker == MARKER_EOI || marker == MARKER_SOS)
+				{
+					return;
+				}
+
+				if (position + 2 > length)
+				{
+					return;
+				}
+
+				size_t segment_length = readUint16(data + position, false);
+				if (segment_length < 2)
+				{
+					return;
+				}
+
+				const size_t payload_offset = position + 2;
+				const size_t payload_length = segment_length - 2;
+				position += segment_length;
+
+				// Recorded even if not downloaded completely yet
+				if (marker >= MARKER_APP0 && marker <= MARKER_APP15)
+				{
+					meta_data.app_segments.push_back(
+						ImageSegment{ marker, payload_offset, payload_length });
+				}
+
+				if (position > length)
+				{
+					return;
+				}
+
+				const uint8_t* payload = data + payload_offset;
+				if (isSofMarker(marker))
+				{
+					// P [1], Y [2], X [2]
+					if (payload_length >= 5)
+					{
+						meta_data.height = readUint16(payload + 1, false);
+						meta_data.width = readUint16(payload + 3, false);
+						meta_data.progressive = isProgressiveSofMarker(marker);
+					}
+				}
+				else if (marker == MARKER_APP1 && !app1_seen)
+				{
+					// Only the first APP1 may hold EXIF data
+					app1_seen = true;
+					size_t tiff_length;
+					const uint8_t* tiff = getExifTiffData(payload, payload_length, tiff_length);
+					if (tiff != nullptr)
+					{
+						meta_data.orientation = readExifOrientation(tiff, tiff_length);
+					}
+				}
+			}
+		}
+
+		static ImageFormat getWebpFormat(const uint8_t* data, size_t length)
+		{
+			if (startsWith(data, length, 12, "VP8 "))
+			{
+				return ImageFormat::WEBP_SIMPLE;
+			}
+
+			if (startsWith(data, length, 12, "VP8L"))
+			{
+				return ImageFormat::WEBP_LOSSLESS;
+			}
+
+			if (length >= EXTENDED_WEBP_HEADER_LENGTH && startsWith(data, length, 12, "VP8X"))
+			{
+				// ANIM is the 2nd and ALPHA the 5th bit of the flags
+				if ((data[20] & 0x02) != 0)
+				{
+					return ImageFormat::WEBP_ANIMATED;
+				}
+
+				if ((data[20] & 0x10) != 0)
+				{
+					return ImageFormat::WEBP_EXTENDED_WITH_ALPHA;
+				}
+
+				return ImageFormat::WEBP_EXTENDED;
+			}
+
+			return ImageFormat::UNKNOWN;
+		}
+
+		static void parseBmpMetaData(
+			const uint8_t* data,
+			size_t length,
+			ImageMetaData& meta_data)
+		{
+			if (length < 18)
+			{
+				return;
+			}
+
+			uint32_t header_size = readUint32(data + 14, true);
+			if (header_size == 12 && length >= 22)
+			{
+				// BITMAPCOREHEADER
+				meta_data.width = readUint16(data + 18, true);
+				meta_data.height = readUint16(data + 20, true);
+			}
+			else if (header_size >= 40 && length >= 26)
+			{
+				// Negative heights are top-down bitmaps
+				int32_t width = (int32_t)readUint32(data + 18, true);
+				int32_t height = (int32_t)readUint32(data + 22, true);
+				if (width > 0 && height != 0 && height != INT32_MIN)
+				{
+					meta_data.width = width;
+					meta_data.height = height < 0 ? -height : height;
+				}
+			}
+		}
+
+		void parseImageMetaData(
+			const uint8_t* data,
+			size_t length,
+			ImageMetaData& meta_data)
+		{
+			meta_data = ImageMetaData();
+			if (length >= SIMPLE_WEBP_HEADER_LENGTH &&
+				startsWith(data, length, 0, "RIFF") &&
+				startsWith(data, length, 8, "WEBP"))
+			{
+				meta_data.format = getWebpFormat(data, length);
+			}
+			else if (length >= 3 && data[0] == 0xFF && data[1] == MARKER_SOI && data[2] == 0xFF)
+			{
+				meta_data.format = ImageFormat::JPEG;
+				parseJpegMetaData(data, length, meta_data);
+			}
+			else if (startsWith(data, length, 0, "\x89PNG\r\n\x1A\n"))
+			{
+				meta_data.format = ImageFormat::PNG;
+
+				// The IHDR chunk comes first
+				if (length >= 24 && startsWith(data, length, 12, "IHDR"))
+				{
+					meta_data.width = (int)readUint32(data + 16, false);
+					meta_data.height = (int)readUint32(data + 20, false);
+				}
+			}
+			else if (startsWith(data, length, 0, "GIF87a") || startsWith(data, length, 0, "GIF89a"))
+			{
+				meta_data.format = ImageFormat::GIF;
+				if (length >= 10)
+				{
+					meta_data.width = readUint16(data + 6, true);
+					meta_data.height = readUint16(data + 8, true);
+				}
+			}
+			else if (startsWith(data, length, 0, "BM"))
+			{
+				meta_data.format = ImageFormat::BMP;
+				parseBmpMetaData(data, length, meta_data);
+			}
+
+			// Dimensions that do not fit an int are as good as unknown
+			if (meta_data.width <= 0 || meta_data.height <= 0)
+			{
+				meta_data.width = -1;
+				meta_data.height = -1;
+			}
+		}
+
+		bool findExifThumbnail(
+			const uint8_t* data,
+			size_t length,
+			ExifThumbnail& thumbnail)
+		{
+			ImageMetaData meta_data;
+			parseImageMetaData(data, length, meta_data);
+			if (meta_data.format != ImageFormat::JPEG)
+			{
+				return false;
+			}
+
+			// Only the first APP1 may hold EXIF data
+			const ImageSegment* app1 = nullptr;
+			for (const ImageSegment& segment : meta_data.app_segments)
+			{
+				if (segment.marker == MARKER_APP1)
+				{
+					app1 = &segment;
+					break;
+				}
+			}
+
+			if (app1 == nullptr || app1->offset + app1->length > length)
+			{
+				return false;
+			}
+
+			size_t tiff_length;
+			const uint8_t* tiff = getExifTiffData(data + app1->offset, app1->length, tiff_length);
+			bool little_endian;
+			uint32_t ifd0_offset;
+			if (tiff == nullptr || !readTiffHeader(tiff, tiff_length, little_endian, ifd0_offset))
+			{
+				return false;
+			}
+
+			// IFD1 describes the thumbnail
+			uint32_t ifd1_offset = getNextIfdOffset(tiff, tiff_length, little_endian, ifd0_offset);
+			const uint8_t* offset_entry = findTiffEntry(
+				tiff, tiff_length, little_endian, ifd1_offset, TIFF_TAG_JPEG_INTERCHANGE_FORMAT);
+			const uint8_t* length_entry = findTiffEntry(
+				tiff, tiff_length, little_endian, ifd1_offset, TIFF_TAG_JPEG_INTERCHANGE_FORMAT_LENGTH);
+
+			uint32_t thumbnail_offset;
+			uint32_t thumbnail_length;
+			if (offset_entry == nullptr ||
+				length_entry == nullptr ||
+				!readTiffInteger(offset_entry, little_endian, thumbnail_offset) ||
+				!readTiffInteger(length_entry, little_endian, thumbnail_length) ||
+				thumbnail_offset > tiff_length ||
+				thumbnail_length > tiff_length - thumbnail_offset)
+			{
+				return false;
+			}
+
+			const uint8_t* thumbnail_data = tiff + thumbnail_offset;
+			ImageMetaData thumbnail_meta_data;
+			parseImageMetaData(thumbnail_data, thumbnail_length, thumbnail_meta_data);
+			if (thumbnail_meta_data.format != ImageFormat::JPEG ||
+				thumbnail_meta_data.width <= 0 ||
+				thumbnail_meta_data.height <= 0)
+			{
+				return false;
+			}
+
+			thumbnail.offset = (size_t)(thumbnail_data - data);
+			thumbnail.length = thumbnail_length;
+			thumbnail.width = thumbnail_meta_data.width;
+			thumbnail.height = thumbnail_meta_data.height;
+			thumbnail.orientation = meta_data.orientation;
+			return true;
+		}
+	}
+}
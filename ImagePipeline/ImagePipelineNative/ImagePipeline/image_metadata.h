@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef _IMAGE_METADATA_H_
+#define _IMAGE_METADATA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		/**
+		 * Formats told apart by the header of an image.
+		 *
+		 * <p> Values match ImageFormat in ImageFormatHelper.cs.
+		 */
+		enum class ImageFormat
+		{
+			UNINITIALIZED = 0,
+			WEBP_SIMPLE = 1,
+			WEBP_LOSSLESS = 2,
+			WEBP_EXTENDED = 3,
+			WEBP_EXTENDED_WITH_ALPHA = 4,
+			WEBP_ANIMATED = 5,
+			JPEG = 6,
+			PNG = 7,
+			GIF = 8,
+			BMP = 9,
+			UNKNOWN = 10
+		};
+
+		/**
+		 * Marker segment of a jpeg, offset and length are those of the
+		 * payload following the length field.
+		 */
+		struct ImageSegment
+		{
+			uint8_t marker;
+			size_t offset;
+			size_t length;
+		};
+
+		/**
+		 * Header fields of an encoded image.
+		 *
+		 * <p> Fields that are not present in the image, or not in the
+		 * part that has been downloaded so far, keep their defaults.
+		 */
+		struct ImageMetaData
+		{
+			ImageFormat format = ImageFormat::UNKNOWN;
+			int width = -1;
+			int height = -1;
+
+			/** EXIF orientation 1 - 8, 0 if the image has none */
+			int orientation = 0;
+
+			bool progressive = false;
+
+			/** APPn segments of a jpeg, in file order */
+			std::vector<ImageSegment> app_segments;
+		};
+
+		/**
+		 * Jpeg thumbnail embedded in the EXIF data of a jpeg.
+		 */
+		struct ExifThumbnail
+		{
+			/** Position of the thumbnail within the enclosing jpeg */
+			size_t offset;
+			size_t length;
+
+			int width;
+			int height;
+
+			/** EXIF orientation of the enclosing jpeg, which applies to the thumbnail too */
+			int orientation;
+		};
+
+		/**
+		 * Reads format, dimensions and the jpeg header fields in a single
+		 * pass over the bytes, without creating a decoder.
+		 *
+		 * <p> Jpeg markers are walked up to the first SOS, other formats
+		 * only have their fixed size header read. Never throws, truncated
+		 * or corrupt headers just leave fields unknown.
+		 */
+		void parseImageMetaData(
+			const uint8_t* data,
+			size_t length,
+			ImageMetaData& meta_data);
+
+		/**
+		 * Locates the jpeg thumbnail referenced by the JPEGInterchangeFormat
+		 * tags of IFD1 in the EXIF data, so that it can be used in place.
+		 *
+		 * <p> The EXIF data is at most 64 KB and precedes the frame, so
+		 * the beginning of the file is enough.
+		 *
+		 * @return false if there is no valid thumbnail within the bytes
+		 */
+		bool findExifThumbnail(
+			const uint8_t* data,
+			size_t length,
+			ExifThumbnail& thumbnail);
+	}
+}
+
+#endif // _IMAGE_METADATA_H_
@@ -11,9 +11,9 @@
 
 #include <algorithm>
 #include <iterator>
+#include <memory>
 
 #include <stdio.h>
-#include <setjmp.h>
 
 #include <jpeglib.h>
 
@@ -24,9 +24,15 @@ extern "C"
 
 #include "decoded_image.h"
 #include "exceptions.h"
+#include "jpeg_context.h"
+#include "jpeg_encode_options.h"
 #include "jpeg_error_handler.h"
 #include "jpeg_memory_io.h"
+#include "jpeg_restart_bands.h"
 #include "jpeg_stream_wrappers.h"
+#include "pixel_buffer_pool.h"
+#include "pixel_conversion.h"
+#include "resampler.h"
 #include "transformations.h"
 #include "jpeg_codec.h"
 
@@ -41,6 +47,12 @@ namespace facebook
 			 */
 			static const int kMaxMemoryForDecode = 30 * 1024 * 1024;
 
+			/**
+			 * Bound of the frame holding all rows of an image resized on
+			 * several threads, 64 MB.
+			 */
+			static const size_t kMaxMemoryForParallelResize = 64 * 1024 * 1024;
+
 			/**
 			 * The xmp segment header needs a trailing 0 character, so we need 29
 			 * characters instead of 28.
@@ -95,60 +107,90 @@ namespace facebook
 					jpeg_metadata_writer);
 			}
 
-			void encodeJpegIntoOutputStream(
-				DecodedImage& decoded_image,
+			/**
+			 * Encodes RGB rows pulled from given source, followed by the
+			 * metadata of given image if there is one.
+			 */
+			static void encodeRowsIntoOutputStream(
+				uint32_t width,
+				uint32_t height,
+				const RowSource& next_row,
 				LPSTREAM os,
-				int quality) 
+				const EncodeOptions& encode_options,
+				const DecodedImage* metadata_image) 
 			{
-				// jpeg does not support alpha channel.
-				THROW_AND_RETURN_IF(
-					decoded_image.getPixelFormat() != PixelFormat::RGB,
-					"Wrong pixel format for jpeg encoding");
-
-				struct jpeg_compress_struct cinfo;
-
-				// Set up error handling.
-				JpegErrorHandler error_handler;
-				error_handler.setCompressStruct(cinfo);
-				if (setjmp(error_handler.setjmpBuffer)) 
-				{
-					return;
-				}
+				JpegCompressLease compress_lease;
+				struct jpeg_compress_struct& cinfo = compress_lease.get();
 
 				// Set up OutputStream as jpeg codec destination.
-				jpeg_create_compress(&cinfo);
 				JpegOutputStreamWrapper os_wrapper { os };
 				cinfo.dest = &(os_wrapper.public_fields);
 
 				// Set up image properties.
-				cinfo.image_width = decoded_image.getWidth();
-				cinfo.image_height = decoded_image.getHeight();
+				cinfo.image_width = width;
+				cinfo.image_height = height;
 				cinfo.input_components = 3;
 				cinfo.in_color_space = JCS_RGB;
 
 				jpeg_set_defaults(&cinfo);
-				jpeg_set_quality(&cinfo, quality, TRUE);
+				setEncodeParameters(cinfo, encode_options);
 				jpeg_start_compress(&cinfo, TRUE);
 
-				writeMetadata(cinfo, decoded_image);
+				if (metadata_image != nullptr) 
+				{
+					writeMetadata(cinfo, *metadata_image);
+				}
 
 				// Write all pixels, row by row.
-				JSAMPROW row_pointer = decoded_image.getPixelsPtr();
-				const int stride = decoded_image.getStride();
 				while (cinfo.next_scanline < cinfo.image_height) 
 				{
+					JSAMPROW row_pointer = (JSAMPROW)next_row();
 					if (jpeg_write_scanlines(&cinfo, &row_pointer, 1) != 1) 
 					{
 						jpegSafeThrow(
 							(j_common_ptr) &cinfo,
 							"Could not write scanline");
 					}
-
-					std::advance(row_pointer, stride);
 				}
 
 				jpeg_finish_compress(&cinfo);
-				jpeg_destroy_compress(&cinfo);
+			}
+
+			void encodeJpegIntoOutputStream(
+				DecodedImage& decoded_image,
+				LPSTREAM os,
+				const EncodeOptions& encode_options) 
+			{
+				// jpeg does not support alpha channel.
+				THROW_AND_RETURN_IF(
+					decoded_image.getPixelFormat() != PixelFormat::RGB,
+					"Wrong pixel format for jpeg encoding");
+
+				const uint8_t* row_pointer = decoded_image.getPixelsPtr();
+				const int stride = decoded_image.getStride();
+				encodeRowsIntoOutputStream(
+					decoded_image.getWidth(),
+					decoded_image.getHeight(),
+					[&row_pointer, stride]() 
+					{
+						const uint8_t* row = row_pointer;
+						std::advance(row_pointer, stride);
+						return row;
+					},
+					os,
+					encode_options,
+					&decoded_image);
+			}
+
+			void encodeJpegIntoOutputStream(
+				uint32_t width,
+				uint32_t height,
+				const RowSource& next_row,
+				LPSTREAM os,
+				const EncodeOptions& encode_options) 
+			{
+				THROW_AND_RETURN_IF(!next_row, "row source cannot be empty");
+				encodeRowsIntoOutputStream(width, height, next_row, os, encode_options, nullptr);
 			}
 
 			/**
@@ -174,21 +216,10 @@ namespace facebook
 			}
 
 			/**
-			 * Initializes decompress struct.
-			 *
-			 * <p> Sets source and error handling.
-			 *
-			 * <p> Sets decompress parameters to optimize decode time.
+			 * Sets decompress parameters to optimize decode time.
 			 */
-			static void initDecompressStruct(
-				struct jpeg_decompress_struct& dinfo,
-				JpegErrorHandler& error_handler,
-				struct jpeg_source_mgr& source) 
+			static void setFastDecodeParameters(struct jpeg_decompress_struct& dinfo) 
 			{
-				memset(&dinfo, 0, sizeof(struct jpeg_decompress_struct));
-				error_handler.setDecompressStruct(dinfo);
-				jpeg_create_decompress(&dinfo);
-
 				// 30 MB
 				dinfo.mem->max_memory_to_use = kMaxMemoryForDecode;
 
@@ -207,28 +238,35 @@ namespace facebook
 				dinfo.do_fancy_upsampling = FALSE;
 				dinfo.do_block_smoothing = FALSE;
 				dinfo.enable_2pass_quant = FALSE;
+			}
 
+			/**
+			 * Initializes leased decompress struct for the next image.
+			 *
+			 * <p> Sets the fast decode parameters and source, then reads the
+			 * header.
+			 */
+			static void initDecompressStruct(
+				struct jpeg_decompress_struct& dinfo,
+				struct jpeg_source_mgr& source) 
+			{
+				setFastDecodeParameters(dinfo);
 				dinfo.src = &source;
 				jpeg_read_header(&dinfo, true);
 			}
 
 			/**
-			 * Initializes compress struct.
+			 * Initializes leased compress struct for the next image.
 			 *
-			 * <p> Sets destination and error handler.
+			 * <p> Sets destination.
 			 *
 			 * <p> Sets copies params from given decompress struct.
 			 */
 			static void initCompressStruct(
 				struct jpeg_compress_struct& cinfo,
 				struct jpeg_decompress_struct& dinfo,
-				JpegErrorHandler& error_handler,
 				struct jpeg_destination_mgr& destination) 
 			{
-				memset(&cinfo, 0, sizeof(struct jpeg_compress_struct));
-				error_handler.setCompressStruct(cinfo);
-				jpeg_create_compress(&cinfo);
-				cinfo.dct_method = JDCT_IFAST;
 				cinfo.dest = &destination;
 				cinfo.image_width = dinfo.output_width;
 				cinfo.image_height = dinfo.output_height;
@@ -237,6 +275,95 @@ namespace facebook
 				jpeg_set_defaults(&cinfo);
 			}
 
+			/**
+			 * Drops the partial iMCU at the end of given dimension, unless the
+			 * dimension is shorter than a single iMCU.
+			 */
+			static JDIMENSION trimToIMCU(JDIMENSION size, int iMCU_size) 
+			{
+				const JDIMENSION iMCUs = size / iMCU_size;
+				return iMCUs > 0 ? iMCUs * iMCU_size : size;
+			}
+
+			/**
+			 * Requests lossless crop of given region.
+			 *
+			 * <p> transupp applies the crop after the rotation, so the region,
+			 * given in pixels of the source image, is mapped into the rotated
+			 * image first. Edges dropped by trim are taken into account, the
+			 * same way getRotatedSize does.
+			 */
+			static void setLosslessCrop(
+				jpeg_transform_info& xinfo,
+				jpeg_decompress_struct& dinfo,
+				RotationType rotation_type,
+				const CropRegion& crop_region) 
+			{
+				const JDIMENSION width = trimToIMCU(
+					dinfo.image_width,
+					dinfo.max_h_samp_factor * DCTSIZE);
+				const JDIMENSION height = trimToIMCU(
+					dinfo.image_height,
+					dinfo.max_v_samp_factor * DCTSIZE);
+
+				// Region clamped to the part of the source kept by the rotation.
+				const bool trims_width = rotation_type == RotationType::ROTATE_180 ||
+					rotation_type == RotationType::ROTATE_270;
+				const bool trims_height = rotation_type == RotationType::ROTATE_90 ||
+					rotation_type == RotationType::ROTATE_180;
+				const JDIMENSION source_width = trims_width ? width : dinfo.image_width;
+				const JDIMENSION source_height = trims_height ? height : dinfo.image_height;
+				if (crop_region.getX() >= source_width || crop_region.getY() >= source_height) 
+				{
+					jpegSafeThrow(
+						(j_common_ptr) &dinfo,
+						"Crop region is outside of the image");
+				}
+
+				const JDIMENSION x = crop_region.getX();
+				const JDIMENSION y = crop_region.getY();
+				const JDIMENSION w = std::min<JDIMENSION>(crop_region.getWidth(), source_width - x);
+				const JDIMENSION h = std::min<JDIMENSION>(crop_region.getHeight(), source_height - y);
+
+				switch (rotation_type) 
+				{
+					case RotationType::ROTATE_90:
+					xinfo.crop_xoffset = source_height - (y + h);
+					xinfo.crop_yoffset = x;
+					xinfo.crop_width = h;
+					xinfo.crop_height = w;
+					break;
+
+					case RotationType::ROTATE_180:
+					xinfo.crop_xoffset = source_width - (x + w);
+					xinfo.crop_yoffset = source_height - (y + h);
+					xinfo.crop_width = w;
+					xinfo.crop_height = h;
+					break;
+
+					case RotationType::ROTATE_270:
+					xinfo.crop_xoffset = y;
+					xinfo.crop_yoffset = source_width - (x + w);
+					xinfo.crop_width = h;
+					xinfo.crop_height = w;
+					break;
+
+					case RotationType::ROTATE_0:
+					default:
+					xinfo.crop_xoffset = x;
+					xinfo.crop_yoffset = y;
+					xinfo.crop_width = w;
+					xinfo.crop_height = h;
+					break;
+				}
+
+				xinfo.crop = true;
+				xinfo.crop_xoffset_set = JCROP_POS;
+				xinfo.crop_yoffset_set = JCROP_POS;
+				xinfo.crop_width_set = JCROP_POS;
+				xinfo.crop_height_set = JCROP_POS;
+			}
+
 			/**
 			 * Initialize transform info structure.
 			 *
@@ -245,102 +372,276 @@ namespace facebook
 			static void initTransformInfo(
 				jpeg_transform_info& xinfo,
 				jpeg_decompress_struct& dinfo,
-				RotationType rotation_type) 
+				RotationType rotation_type,
+				const CropRegion& crop_region) 
 			{
 				memset(&xinfo, 0, sizeof(jpeg_transform_info));
 				xinfo.transform = getTransformForRotationType(rotation_type);
 				xinfo.trim = true;
-				jtransform_request_workspace(&dinfo, &xinfo);
+				if (!crop_region.isEmpty()) 
+				{
+					setLosslessCrop(xinfo, dinfo, rotation_type, crop_region);
+				}
 			}
 
 			/**
-			 * Rotates jpeg image.
+			 * Returns true if the lossless crop set up in xinfo starts on an
+			 * iMCU boundary of the rotated image. transupp moves other crops
+			 * up and left to the closest boundary, growing the output by up
+			 * to an iMCU.
+			 */
+			static bool isLosslessCropExact(
+				const jpeg_transform_info& xinfo,
+				const jpeg_decompress_struct& dinfo,
+				RotationType rotation_type) 
+			{
+				const bool swap = rotation_type == RotationType::ROTATE_90 ||
+					rotation_type == RotationType::ROTATE_270;
+				const JDIMENSION iMCU_width =
+					(swap ? dinfo.max_v_samp_factor : dinfo.max_h_samp_factor) * DCTSIZE;
+				const JDIMENSION iMCU_height =
+					(swap ? dinfo.max_h_samp_factor : dinfo.max_v_samp_factor) * DCTSIZE;
+				return xinfo.crop_xoffset % iMCU_width == 0 &&
+					xinfo.crop_yoffset % iMCU_height == 0;
+			}
+
+			static void decodeAndTransformJpeg(
+				jpeg_decompress_struct& dinfo,
+				struct jpeg_destination_mgr& destination,
+				RotationType rotation_type,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options);
+
+			/**
+			 * Rotates and crops jpeg image.
 			 *
 			 * <p> Operates on DCT blocks to avoid doing a full decode.
+			 *
+			 * <p> The crop is lossless too when its top left corner lies on an
+			 * iMCU boundary. Other crops are decoded and encoded again, so that
+			 * the output covers exactly the requested region.
 			 */
 			static void rotateJpeg(
 				struct jpeg_source_mgr& source,
 				struct jpeg_destination_mgr& destination,
-				RotationType rotation_type) 
+				RotationType rotation_type,
+				const CropRegion& crop_region,
+				const EncodeOptions& encode_options) 
 			{
-				JpegErrorHandler error_handler;
-				if (setjmp(error_handler.setjmpBuffer)) 
+				// Prepare decompress struct.
+				JpegDecompressLease decompress_lease;
+				struct jpeg_decompress_struct& dinfo = decompress_lease.get();
+				initDecompressStruct(dinfo, source);
+
+				// Prepare transform struct.
+				jpeg_transform_info xinfo;
+				initTransformInfo(xinfo, dinfo, rotation_type, crop_region);
+				if (!crop_region.isEmpty() && !isLosslessCropExact(xinfo, dinfo, rotation_type)) 
 				{
+					// Leases its own compress struct, none is held yet.
+					decodeAndTransformJpeg(
+						dinfo,
+						destination,
+						rotation_type,
+						ScaleFactor(DCTSIZE, DCTSIZE),
+						crop_region,
+						TargetSize(),
+						encode_options);
 					return;
 				}
 
-				// Prepare decompress struct.
-				struct jpeg_decompress_struct dinfo;
-				initDecompressStruct(dinfo, error_handler, source);
-
 				// Create compress struct.
-				struct jpeg_compress_struct cinfo;
-				initCompressStruct(cinfo, dinfo, error_handler, destination);
+				JpegCompressLease compress_lease;
+				struct jpeg_compress_struct& cinfo = compress_lease.get();
+				initCompressStruct(cinfo, dinfo, destination);
 
-				// Prepare transform struct.
-				jpeg_transform_info xinfo;
-				initTransformInfo(xinfo, dinfo, rotation_type);
+				jtransform_request_workspace(&dinfo, &xinfo);
 
 				// transform
 				jvirt_barray_ptr* srccoefs = jpeg_read_coefficients(&dinfo);
 				jpeg_copy_critical_parameters(&dinfo, &cinfo);
+				setLosslessEncodeParameters(cinfo, encode_options);
 				jvirt_barray_ptr* dstcoefs = jtransform_adjust_parameters(&dinfo, &cinfo, srccoefs, &xinfo);
 				jpeg_write_coefficients(&cinfo, dstcoefs);
 				jcopy_markers_execute(&dinfo, &cinfo, JCOPYOPT_ALL);
 				jtransform_execute_transformation(&dinfo, &cinfo, srccoefs, &xinfo);
 
-				// tear down
+				// tear down, leased structs are aborted when released
 				jpeg_finish_compress(&cinfo);
-				jpeg_destroy_compress(&cinfo);
-				jpeg_destroy_decompress(&dinfo);
 			}
 
 			/**
-			 * Resizes jpeg.
+			 * Validates scale factor passed to decoding and resizing functions.
 			 *
-			 * <p> During the resize, the image is decoded line by line and encoded again.
+			 * @return true if the scale factor is valid
 			 */
-			static void resizeJpeg(
-				struct jpeg_source_mgr& source,
-				struct jpeg_destination_mgr& destination,
-				const ScaleFactor& scale_factor,
-				int quality) 
+			static bool checkScaleFactor(const ScaleFactor& scale_factor) 
 			{
-				THROW_AND_RETURN_IF(quality < 1, "quality should not be lower than 1");
-				THROW_AND_RETURN_IF(quality > 100, "quality should not be greater than 100");
-				THROW_AND_RETURN_IF(
+				THROW_AND_RETURNVAL_IF(
 					8 % scale_factor.getDenominator() > 0,
-					"wrong scale denominator");
+					"wrong scale denominator",
+					false);
 
-				THROW_AND_RETURN_IF(
+				THROW_AND_RETURNVAL_IF(
 					scale_factor.getNumerator() < 1,
-					"scale numerator cannot be lower than 1");
+					"scale numerator cannot be lower than 1",
+					false);
 
-				THROW_AND_RETURN_IF(
+				THROW_AND_RETURNVAL_IF(
 					scale_factor.getNumerator() > 16,
-					"scale numerator cannot be greater than 16");
+					"scale numerator cannot be greater than 16",
+					false);
+
+				return true;
+			}
+
+			/**
+			 * Validates quality and scale factor passed to resizing functions.
+			 *
+			 * @return true if the parameters are valid
+			 */
+			static bool checkResizeParameters(
+				const ScaleFactor& scale_factor,
+				const EncodeOptions& encode_options) 
+			{
+				const int quality = encode_options.getQuality();
+				THROW_AND_RETURNVAL_IF(quality < 1, "quality should not be lower than 1", false);
+				THROW_AND_RETURNVAL_IF(quality > 100, "quality should not be greater than 100", false);
+				return checkScaleFactor(scale_factor);
+			}
+
+			/**
+			 * Creates resampler bringing rows of given size to target size, or
+			 * null if the rows have the target size already. The rows are never
+			 * upscaled, dimensions of the target larger than the rows are
+			 * clamped.
+			 */
+			static std::unique_ptr<RowResampler> createResampler(
+				JDIMENSION width,
+				JDIMENSION height,
+				int components,
+				const TargetSize& target_size) 
+			{
+				if (target_size.isEmpty()) 
+				{
+					return nullptr;
+				}
+
+				const JDIMENSION target_width = std::min<JDIMENSION>(target_size.getWidth(), width);
+				const JDIMENSION target_height = std::min<JDIMENSION>(target_size.getHeight(), height);
+				if (target_width == width && target_height == height) 
+				{
+					return nullptr;
+				}
+
+				return std::unique_ptr<RowResampler>(new RowResampler(
+					width,
+					height,
+					target_width,
+					target_height,
+					components,
+					target_size.getFilter()));
+			}
+
+			/**
+			 * Starts compressing the rows decoded by given decompress struct,
+			 * resampled to target size.
+			 *
+			 * @return resampler the decoded rows have to go through, null if
+			 *         they are encoded as they are
+			 */
+			static std::unique_ptr<RowResampler> startResizedCompress(
+				struct jpeg_decompress_struct& dinfo,
+				struct jpeg_compress_struct& cinfo,
+				struct jpeg_destination_mgr& destination,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options) 
+			{
+				std::unique_ptr<RowResampler> resampler = createResampler(
+					dinfo.output_width,
+					dinfo.output_height,
+					dinfo.output_components,
+					target_size);
+
+				initCompressStruct(cinfo, dinfo, destination);
+				if (resampler) 
+				{
+					cinfo.image_width = resampler->getOutputWidth();
+					cinfo.image_height = resampler->getOutputHeight();
+				}
+
+				setEncodeParameters(cinfo, encode_options);
+				jpeg_start_compress(&cinfo, true);
+				jcopy_markers_execute(&dinfo, &cinfo, JCOPYOPT_ALL);
+				return resampler;
+			}
+
+			/**
+			 * Encodes given decoded row, or the resampled rows it completes.
+			 *
+			 * @param resampled single row buffer of the encoded width
+			 */
+			static void writeResizedScanline(
+				struct jpeg_compress_struct& cinfo,
+				RowResampler* resampler,
+				JSAMPROW row,
+				JSAMPARRAY resampled) 
+			{
+				if (!resampler) 
+				{
+					(void)jpeg_write_scanlines(&cinfo, &row, 1);
+					return;
+				}
+
+				resampler->pushRow(row);
+				while (resampler->hasOutputRow()) 
+				{
+					resampler->readRow(resampled[0]);
+					(void)jpeg_write_scanlines(&cinfo, resampled, 1);
+				}
+			}
 
-				JpegErrorHandler error_handler;
-				if (setjmp(error_handler.setjmpBuffer)) 
+			/**
+			 * Resizes jpeg.
+			 *
+			 * <p> During the resize, the image is decoded line by line and encoded again.
+			 *
+			 * <p> libjpeg can only scale by n/8. If target size is not empty the
+			 * scaled rows are resampled to it on the fly, before being encoded.
+			 */
+			static void resizeJpeg(
+				struct jpeg_source_mgr& source,
+				struct jpeg_destination_mgr& destination,
+				const ScaleFactor& scale_factor,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options) 
+			{
+				if (!checkResizeParameters(scale_factor, encode_options))
 				{
 					return;
 				}
 
 				// Prepare decompress struct.
-				struct jpeg_decompress_struct dinfo;
-				initDecompressStruct(dinfo, error_handler, source);
+				JpegDecompressLease decompress_lease;
+				struct jpeg_decompress_struct& dinfo = decompress_lease.get();
+				initDecompressStruct(dinfo, source);
 				dinfo.scale_num = scale_factor.getNumerator();
 				dinfo.scale_denom = scale_factor.getDenominator();
 				dinfo.out_color_space = JCS_RGB;
 				(void)jpeg_start_decompress(&dinfo);
 
 				// Create compress struct.
-				struct jpeg_compress_struct cinfo;
-				initCompressStruct(cinfo, dinfo, error_handler, destination);
-				jpeg_set_quality(&cinfo, quality, false);
-				jpeg_start_compress(&cinfo, true);
+				JpegCompressLease compress_lease;
+				struct jpeg_compress_struct& cinfo = compress_lease.get();
+				std::unique_ptr<RowResampler> resampler = startResizedCompress(
+					dinfo,
+					cinfo,
+					destination,
+					target_size,
+					encode_options);
 
-				jcopy_markers_execute(&dinfo, &cinfo, JCOPYOPT_ALL);
 				size_t row_stride = dinfo.output_width * dinfo.output_components;
 				JSAMPARRAY buffer = (*dinfo.mem->alloc_sarray)(
 					(j_common_ptr)&dinfo, 
@@ -348,57 +649,1123 @@ namespace facebook
 					(JDIMENSION)row_stride,
 					1);
 
+				JSAMPARRAY resampled = (*dinfo.mem->alloc_sarray)(
+					(j_common_ptr)&dinfo, 
+					JPOOL_IMAGE, 
+					cinfo.image_width * cinfo.input_components,
+					1);
+
 				while (dinfo.output_scanline < dinfo.output_height) 
 				{
 					jpeg_read_scanlines(&dinfo, buffer, 1);
-					(void)jpeg_write_scanlines(&cinfo, buffer, 1);
+					writeResizedScanline(cinfo, resampler.get(), buffer[0], resampled);
 				}
 
-				// Tear down.
+				// Tear down, leased structs are aborted when released.
 				jpeg_finish_compress(&cinfo);
-				jpeg_destroy_decompress(&dinfo);
-				jpeg_destroy_compress(&cinfo);
 			}
 
-			void transformJpeg(
-				LPSTREAM is,
-				LPSTREAM os,
+			/**
+			 * Computes size of the rotated image.
+			 *
+			 * <p> Follows the rules of jtransform_request_workspace with trim enabled,
+			 * so the result matches the output of rotateJpeg applied to an image
+			 * encoded with given compress struct.
+			 */
+			static void getRotatedSize(
+				const struct jpeg_compress_struct& cinfo,
 				RotationType rotation_type,
-				const ScaleFactor& scale_factor,
-				int quality) 
+				JDIMENSION width,
+				JDIMENSION height,
+				JDIMENSION& rotated_width,
+				JDIMENSION& rotated_height) 
 			{
-				const bool should_scale = scale_factor.shouldScale();
-				const bool should_rotate = rotation_type != RotationType::ROTATE_0;
-				THROW_AND_RETURN_IF(
-					!should_scale && !should_rotate,
-					"no transformation to perform");
-
-				JpegInputStreamWrapper is_wrapper { is };
-				JpegOutputStreamWrapper os_wrapper{ os };
-				JpegMemoryDestination mem_destination;
-				JpegMemorySource mem_source;
+				int max_h_samp_factor = 1;
+				int max_v_samp_factor = 1;
+				for (int ci = 0; ci < cinfo.num_components; ++ci) 
+				{
+					max_h_samp_factor = std::max(max_h_samp_factor, cinfo.comp_info[ci].h_samp_factor);
+					max_v_samp_factor = std::max(max_v_samp_factor, cinfo.comp_info[ci].v_samp_factor);
+				}
 
-				if (should_scale) 
+				const int iMCU_width = max_h_samp_factor * DCTSIZE;
+				const int iMCU_height = max_v_samp_factor * DCTSIZE;
+				switch (rotation_type) 
 				{
-					resizeJpeg(
-						is_wrapper.public_fields,
-						should_rotate ? mem_destination.public_fields : os_wrapper.public_fields,
-						scale_factor,
-						quality);
+					case RotationType::ROTATE_90:
+					rotated_width = trimToIMCU(height, iMCU_height);
+					rotated_height = width;
+					break;
+
+					case RotationType::ROTATE_180:
+					rotated_width = trimToIMCU(width, iMCU_width);
+					rotated_height = trimToIMCU(height, iMCU_height);
+					break;
+
+					case RotationType::ROTATE_270:
+					rotated_width = height;
+					rotated_height = trimToIMCU(width, iMCU_width);
+					break;
+
+					case RotationType::ROTATE_0:
+					default:
+					rotated_width = width;
+					rotated_height = height;
+					break;
 				}
+			}
 
-				if (should_rotate) 
+			/**
+			 * Copies pixels of a single decoded scanline to their rotated position
+			 * in the output frame. Pixels trimmed away by getRotatedSize are skipped.
+			 */
+			static void rotateScanline(
+				JSAMPROW scanline,
+				JDIMENSION scanline_index,
+				JDIMENSION width,
+				int components,
+				JSAMPARRAY frame,
+				JDIMENSION rotated_width,
+				JDIMENSION rotated_height,
+				RotationType rotation_type) 
+			{
+				switch (rotation_type) 
 				{
-					if (should_scale) 
+					case RotationType::ROTATE_90:
 					{
-						mem_source.setBuffer(std::move(mem_destination.buffer));
+						if (scanline_index >= rotated_width) 
+						{
+							return;
+						}
+
+						const JDIMENSION column = (rotated_width - 1 - scanline_index) * components;
+						for (JDIMENSION x = 0; x < width; ++x) 
+						{
+							memcpy(frame[x] + column, scanline + x * components, components);
+						}
+
+						break;
 					}
 
-					rotateJpeg(
-						should_scale ? mem_source.public_fields : is_wrapper.public_fields,
-						os_wrapper.public_fields,
-						rotation_type);
+					case RotationType::ROTATE_180:
+					{
+						if (scanline_index >= rotated_height) 
+						{
+							return;
+						}
+
+						JSAMPROW row = frame[rotated_height - 1 - scanline_index];
+						for (JDIMENSION x = 0; x < rotated_width; ++x) 
+						{
+							memcpy(
+								row + (rotated_width - 1 - x) * components,
+								scanline + x * components,
+								components);
+						}
+
+						break;
+					}
+
+					case RotationType::ROTATE_270:
+					{
+						const JDIMENSION column = scanline_index * components;
+						for (JDIMENSION x = 0; x < rotated_height; ++x) 
+						{
+							memcpy(
+								frame[rotated_height - 1 - x] + column,
+								scanline + x * components,
+								components);
+						}
+
+						break;
+					}
+
+					case RotationType::ROTATE_0:
+					default:
+					memcpy(frame[scanline_index], scanline, width * components);
+					break;
+				}
+			}
+
+			/**
+			 * Part of the decoder output covered by a crop region.
+			 *
+			 * <p> x, y, width and height are in pixels of the scaled output.
+			 * skip is the number of pixels at the start of every cropped
+			 * scanline that precede x, because libjpeg can only start a
+			 * scanline at an iMCU boundary.
+			 */
+			struct OutputWindow 
+			{
+				JDIMENSION x;
+				JDIMENSION y;
+				JDIMENSION width;
+				JDIMENSION height;
+				JDIMENSION skip;
+			};
+
+			/**
+			 * Maps crop region onto the output of decompress struct with
+			 * computed output dimensions. The region is clamped to the image.
+			 */
+			static void computeOutputWindow(
+				struct jpeg_decompress_struct& dinfo,
+				const CropRegion& crop_region,
+				OutputWindow& window) 
+			{
+				window.skip = 0;
+				if (crop_region.isEmpty()) 
+				{
+					window.x = 0;
+					window.y = 0;
+					window.width = dinfo.output_width;
+					window.height = dinfo.output_height;
+					return;
+				}
+
+				if (crop_region.getX() >= dinfo.image_width ||
+					crop_region.getY() >= dinfo.image_height) 
+				{
+					jpegSafeThrow(
+						(j_common_ptr) &dinfo,
+						"Crop region is outside of the image");
 				}
+
+				const uint64_t right = std::min<uint64_t>(
+					(uint64_t)crop_region.getX() + crop_region.getWidth(),
+					dinfo.image_width);
+				const uint64_t bottom = std::min<uint64_t>(
+					(uint64_t)crop_region.getY() + crop_region.getHeight(),
+					dinfo.image_height);
+
+				// Round outwards so that no requested pixel is lost to scaling.
+				const JDIMENSION x0 = (JDIMENSION)(
+					crop_region.getX() * (uint64_t)dinfo.output_width / dinfo.image_width);
+				const JDIMENSION y0 = (JDIMENSION)(
+					crop_region.getY() * (uint64_t)dinfo.output_height / dinfo.image_height);
+				const JDIMENSION x1 = (JDIMENSION)std::min<uint64_t>(
+					(right * dinfo.output_width + dinfo.image_width - 1) / dinfo.image_width,
+					dinfo.output_width);
+				const JDIMENSION y1 = (JDIMENSION)std::min<uint64_t>(
+					(bottom * dinfo.output_height + dinfo.image_height - 1) / dinfo.image_height,
+					dinfo.output_height);
+
+				window.x = x0;
+				window.y = y0;
+				window.width = std::max<JDIMENSION>(x1 - x0, 1);
+				window.height = std::max<JDIMENSION>(y1 - y0, 1);
+			}
+
+			/**
+			 * Starts decompression limited to given window.
+			 *
+			 * <p> Columns outside of the window are not decoded thanks to
+			 * jpeg_crop_scanline, rows above it are skipped with
+			 * jpeg_skip_scanlines, and the caller stops reading after the
+			 * last row of the window.
+			 */
+			static void startDecompressInWindow(
+				struct jpeg_decompress_struct& dinfo,
+				OutputWindow& window) 
+			{
+				(void)jpeg_start_decompress(&dinfo);
+
+				if (window.width < dinfo.output_width) 
+				{
+					JDIMENSION xoffset = window.x;
+					JDIMENSION width = window.width;
+					jpeg_crop_scanline(&dinfo, &xoffset, &width);
+					window.skip = window.x - xoffset;
+				}
+
+				if (window.y > 0 && jpeg_skip_scanlines(&dinfo, window.y) != window.y) 
+				{
+					jpegSafeThrow(
+						(j_common_ptr) &dinfo,
+						"Could not skip scanlines");
+				}
+			}
+
+			/**
+			 * Resizes and rotates jpeg in a single pass.
+			 *
+			 * <p> Scanlines are decoded at the requested scale and scattered into
+			 * a rotated frame, which is then encoded once. Compared to resizeJpeg
+			 * followed by rotateJpeg this avoids encoding, decoding and holding the
+			 * coefficients of an intermediate jpeg.
+			 *
+			 * <p> The output has the same dimensions and orientation as the two-pass
+			 * result, including the edge trimming done by the lossless rotation.
+			 *
+			 * <p> If crop region is not empty only the iMCUs intersecting it are
+			 * decoded and the output covers exactly the region. Without rotation
+			 * no frame is needed, the decoded rows are encoded straight away.
+			 *
+			 * <p> If target size is not empty the scanlines are resampled to it
+			 * before being rotated. Nothing is trimmed then, so the output has
+			 * exactly the target size.
+			 */
+			static void resizeAndRotateJpeg(
+				struct jpeg_source_mgr& source,
+				struct jpeg_destination_mgr& destination,
+				RotationType rotation_type,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options) 
+			{
+				if (!checkResizeParameters(scale_factor, encode_options))
+				{
+					return;
+				}
+
+				// Prepare decompress struct.
+				JpegDecompressLease decompress_lease;
+				struct jpeg_decompress_struct& dinfo = decompress_lease.get();
+				initDecompressStruct(dinfo, source);
+				decodeAndTransformJpeg(
+					dinfo,
+					destination,
+					rotation_type,
+					scale_factor,
+					crop_region,
+					target_size,
+					encode_options);
+			}
+
+			/**
+			 * Implements resizeAndRotateJpeg once the header of the source has
+			 * been read into dinfo.
+			 */
+			static void decodeAndTransformJpeg(
+				jpeg_decompress_struct& dinfo,
+				struct jpeg_destination_mgr& destination,
+				RotationType rotation_type,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options) 
+			{
+				dinfo.scale_num = scale_factor.getNumerator();
+				dinfo.scale_denom = scale_factor.getDenominator();
+				dinfo.out_color_space = JCS_RGB;
+				jpeg_calc_output_dimensions(&dinfo);
+
+				OutputWindow window;
+				computeOutputWindow(dinfo, crop_region, window);
+				startDecompressInWindow(dinfo, window);
+
+				const int components = dinfo.output_components;
+				std::unique_ptr<RowResampler> resampler = createResampler(
+					window.width,
+					window.height,
+					components,
+					target_size);
+
+				// Create compress struct with the dimensions of the rotated image.
+				JpegCompressLease compress_lease;
+				struct jpeg_compress_struct& cinfo = compress_lease.get();
+				initCompressStruct(cinfo, dinfo, destination);
+				setEncodeParameters(cinfo, encode_options);
+
+				JDIMENSION width = window.width;
+				JDIMENSION height = window.height;
+				if (resampler) 
+				{
+					width = resampler->getOutputWidth();
+					height = resampler->getOutputHeight();
+				}
+
+				JSAMPARRAY buffer = (*dinfo.mem->alloc_sarray)(
+					(j_common_ptr)&dinfo,
+					JPOOL_IMAGE,
+					dinfo.output_width * components,
+					1);
+
+				JSAMPARRAY resampled = (*dinfo.mem->alloc_sarray)(
+					(j_common_ptr)&dinfo,
+					JPOOL_IMAGE,
+					width * components,
+					1);
+
+				const JDIMENSION window_end = window.y + window.height;
+				if (rotation_type == RotationType::ROTATE_0) 
+				{
+					// Nothing to rotate, the rows of the window are encoded as
+					// they are decoded and the frame is never held in memory.
+					cinfo.image_width = width;
+					cinfo.image_height = height;
+					jpeg_start_compress(&cinfo, true);
+					jcopy_markers_execute(&dinfo, &cinfo, JCOPYOPT_ALL);
+					while (dinfo.output_scanline < window_end) 
+					{
+						jpeg_read_scanlines(&dinfo, buffer, 1);
+						writeResizedScanline(
+							cinfo,
+							resampler.get(),
+							buffer[0] + window.skip * components,
+							resampled);
+					}
+
+					// Tear down, leased structs are aborted when released.
+					jpeg_finish_compress(&cinfo);
+					return;
+				}
+
+				// Resampled and cropped images keep their exact size, only whole
+				// images are trimmed like the lossless rotation does.
+				JDIMENSION rotated_width;
+				JDIMENSION rotated_height;
+				if (resampler || !crop_region.isEmpty()) 
+				{
+					const bool swap = rotation_type == RotationType::ROTATE_90 ||
+						rotation_type == RotationType::ROTATE_270;
+					rotated_width = swap ? height : width;
+					rotated_height = swap ? width : height;
+				}
+				else 
+				{
+					getRotatedSize(
+						cinfo,
+						rotation_type,
+						window.width,
+						window.height,
+						rotated_width,
+						rotated_height);
+				}
+
+				if ((size_t)rotated_width * rotated_height * components > kMaxMemoryForDecode) 
+				{
+					jpegSafeThrow(
+						(j_common_ptr) &dinfo,
+						"Rotated image exceeds memory limit");
+				}
+
+				JSAMPARRAY frame = (*dinfo.mem->alloc_sarray)(
+					(j_common_ptr)&dinfo,
+					JPOOL_IMAGE,
+					rotated_width * components,
+					rotated_height);
+
+				JDIMENSION scanline_index = 0;
+				while (dinfo.output_scanline < window_end) 
+				{
+					jpeg_read_scanlines(&dinfo, buffer, 1);
+					JSAMPROW scanline = buffer[0] + window.skip * components;
+					if (!resampler) 
+					{
+						rotateScanline(
+							scanline,
+							scanline_index++,
+							width,
+							components,
+							frame,
+							rotated_width,
+							rotated_height,
+							rotation_type);
+						continue;
+					}
+
+					resampler->pushRow(scanline);
+					while (resampler->hasOutputRow()) 
+					{
+						resampler->readRow(resampled[0]);
+						rotateScanline(
+							resampled[0],
+							scanline_index++,
+							width,
+							components,
+							frame,
+							rotated_width,
+							rotated_height,
+							rotation_type);
+					}
+				}
+
+				cinfo.image_width = rotated_width;
+				cinfo.image_height = rotated_height;
+				jpeg_start_compress(&cinfo, true);
+				jcopy_markers_execute(&dinfo, &cinfo, JCOPYOPT_ALL);
+				while (cinfo.next_scanline < cinfo.image_height) 
+				{
+					(void)jpeg_write_scanlines(
+						&cinfo,
+						frame + cinfo.next_scanline,
+						cinfo.image_height - cinfo.next_scanline);
+				}
+
+				// Tear down, leased structs are aborted when released.
+				jpeg_finish_compress(&cinfo);
+			}
+
+			/**
+			 * Returns the pixel format libjpeg writes when decoding to given
+			 * pixel format, rows are converted if the two differ.
+			 */
+			static PixelFormat getDecodedPixelFormat(PixelFormat pixel_format) 
+			{
+				return (pixel_format == PixelFormat::GRAY_ALPHA) ? PixelFormat::GRAY : pixel_format;
+			}
+
+			/**
+			 * Returns libjpeg color space producing given pixel format.
+			 *
+			 * <p> Jpegs are opaque, so premultiplied BGRA is plain BGRA.
+			 */
+			static J_COLOR_SPACE getColorSpaceForPixelFormat(PixelFormat pixel_format) 
+			{
+				switch (getDecodedPixelFormat(pixel_format)) 
+				{
+					case PixelFormat::RGBA:
+					return JCS_EXT_RGBA;
+
+					case PixelFormat::BGRA:
+					case PixelFormat::BGRA_PREMULTIPLIED:
+					return JCS_EXT_BGRA;
+
+					case PixelFormat::RGB565:
+					return JCS_RGB565;
+
+					case PixelFormat::GRAY:
+					return JCS_GRAYSCALE;
+
+					case PixelFormat::RGB:
+					default:
+					return JCS_RGB;
+				}
+			}
+
+			/**
+			 * Requests output format and scale, and computes the part of the
+			 * output covered by crop region.
+			 */
+			static void setDecodeParameters(
+				struct jpeg_decompress_struct& dinfo,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				PixelFormat pixel_format,
+				OutputWindow& window) 
+			{
+				dinfo.scale_num = scale_factor.getNumerator();
+				dinfo.scale_denom = scale_factor.getDenominator();
+				dinfo.out_color_space = getColorSpaceForPixelFormat(pixel_format);
+				jpeg_calc_output_dimensions(&dinfo);
+				computeOutputWindow(dinfo, crop_region, window);
+			}
+
+			/**
+			 * Reads scanlines of the window of started decompress struct, writing
+			 * each row at its place in given buffer.
+			 *
+			 * <p> Rows are decoded straight into the buffer unless the scanlines
+			 * start before the window or libjpeg cannot write the pixel format,
+			 * in which case they go through a single row of scratch memory and
+			 * are converted from there.
+			 */
+			static void readScanlinesIntoBuffer(
+				struct jpeg_decompress_struct& dinfo,
+				const OutputWindow& window,
+				PixelFormat pixel_format,
+				uint8_t* pixels,
+				size_t stride,
+				size_t capacity) 
+			{
+				// output_components counts color channels, RGB565 has 3 of them
+				// packed in 2 bytes.
+				const PixelConverter converter(getDecodedPixelFormat(pixel_format), pixel_format);
+				const int decoded_bytes = bytesPerPixel(converter.getSource());
+				const size_t row_bytes = (size_t)window.width * bytesPerPixel(pixel_format);
+				if (stride < row_bytes) 
+				{
+					jpegSafeThrow(
+						(j_common_ptr) &dinfo,
+						"Stride is smaller than decoded row");
+				}
+
+				if (capacity < stride * (window.height - 1) + row_bytes) 
+				{
+					jpegSafeThrow(
+						(j_common_ptr) &dinfo,
+						"Pixel buffer is too small for decoded image");
+				}
+
+				JSAMPARRAY scratch = nullptr;
+				if (window.skip > 0 || !converter.isIdentity()) 
+				{
+					scratch = (*dinfo.mem->alloc_sarray)(
+						(j_common_ptr)&dinfo,
+						JPOOL_IMAGE,
+						dinfo.output_width * decoded_bytes,
+						1);
+				}
+
+				const JDIMENSION window_end = window.y + window.height;
+				while (dinfo.output_scanline < window_end) 
+				{
+					uint8_t* destination = pixels + (dinfo.output_scanline - window.y) * stride;
+					JSAMPROW row = scratch ? scratch[0] : destination;
+					if (jpeg_read_scanlines(&dinfo, &row, 1) != 1) 
+					{
+						jpegSafeThrow(
+							(j_common_ptr) &dinfo,
+							"Could not read scanline");
+					}
+
+					if (scratch) 
+					{
+						converter.convertRow(row + window.skip * decoded_bytes, destination, window.width);
+					}
+				}
+			}
+
+			/**
+			 * Returns the number of output rows given number of source rows
+			 * scales to, rounding up like libjpeg does.
+			 *
+			 * <p> libjpeg scales by the smallest N/8 not below the requested
+			 * factor. Bands start on MCU rows, so their first output row is
+			 * exact.
+			 */
+			static size_t getScaledBandRow(uint32_t row, const ScaleFactor& scale_factor) 
+			{
+				const size_t block_scale = std::min<size_t>(
+					(size_t)scale_factor.getNumerator() * DCTSIZE / scale_factor.getDenominator(),
+					2 * DCTSIZE);
+				return ((size_t)row * block_scale + DCTSIZE - 1) / DCTSIZE;
+			}
+
+			/**
+			 * Splits jpeg at restart markers into a band per decode thread.
+			 *
+			 * @return false if the jpeg should be decoded serially
+			 */
+			static bool splitIntoRestartBands(
+				const uint8_t* data,
+				size_t length,
+				std::vector<RestartBand>& bands) 
+			{
+				return splitAtRestartMarkers(data, length, getDecodeThreadCount(), bands);
+			}
+
+			/**
+			 * Decodes bands of a jpeg, each on its own thread, writing the rows
+			 * of all bands into given buffer.
+			 *
+			 * <p> The context rows of each band are skipped and the rows past
+			 * its end left unread, so the output matches a serial decode bit
+			 * for bit.
+			 */
+			static void decodeRestartBands(
+				const std::vector<RestartBand>& bands,
+				const ScaleFactor& scale_factor,
+				PixelFormat pixel_format,
+				uint8_t* pixels,
+				size_t stride,
+				size_t capacity) 
+			{
+				runInParallel(bands.size(), [&](size_t index) 
+				{
+					const RestartBand& band = bands[index];
+					const size_t first_row = getScaledBandRow(band.first_row, scale_factor);
+					const size_t offset = first_row * stride;
+					THROW_AND_RETURN_IF(
+						offset >= capacity,
+						"Pixel buffer is too small for decoded image");
+
+					JpegMemorySource mem_source;
+					mem_source.setBuffer(band.data.data(), band.data.size());
+					JpegDecompressLease decompress_lease;
+					struct jpeg_decompress_struct& dinfo = decompress_lease.get();
+					initDecompressStruct(dinfo, mem_source.public_fields);
+					OutputWindow window;
+					setDecodeParameters(dinfo, scale_factor, CropRegion(), pixel_format, window);
+					window.y = (JDIMENSION)getScaledBandRow(band.context_rows, scale_factor);
+					window.height = (JDIMENSION)(
+						getScaledBandRow(band.first_row + band.height, scale_factor) - first_row);
+					startDecompressInWindow(dinfo, window);
+					readScanlinesIntoBuffer(
+						dinfo, window, pixel_format, pixels + offset, stride, capacity - offset);
+				});
+			}
+
+			void getJpegDecodeSize(
+				const uint8_t* data,
+				size_t length,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				unsigned int& width,
+				unsigned int& height) 
+			{
+				THROW_AND_RETURN_IF(data == nullptr, "jpeg data cannot be null");
+				if (!checkScaleFactor(scale_factor)) 
+				{
+					return;
+				}
+
+				JpegMemorySource mem_source;
+				mem_source.setBuffer(data, length);
+				JpegDecompressLease decompress_lease;
+				struct jpeg_decompress_struct& dinfo = decompress_lease.get();
+				initDecompressStruct(dinfo, mem_source.public_fields);
+				OutputWindow window;
+				setDecodeParameters(dinfo, scale_factor, crop_region, PixelFormat::RGB, window);
+				width = window.width;
+				height = window.height;
+			}
+
+			void decodeJpeg(
+				const uint8_t* data,
+				size_t length,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				PixelFormat pixel_format,
+				uint8_t* pixels,
+				size_t stride,
+				size_t capacity) 
+			{
+				THROW_AND_RETURN_IF(data == nullptr, "jpeg data cannot be null");
+				THROW_AND_RETURN_IF(pixels == nullptr, "pixel buffer cannot be null");
+				if (!checkScaleFactor(scale_factor)) 
+				{
+					return;
+				}
+
+				std::vector<RestartBand> bands;
+				if (crop_region.isEmpty() && splitIntoRestartBands(data, length, bands)) 
+				{
+					decodeRestartBands(bands, scale_factor, pixel_format, pixels, stride, capacity);
+					return;
+				}
+
+				JpegMemorySource mem_source;
+				mem_source.setBuffer(data, length);
+				JpegDecompressLease decompress_lease;
+				struct jpeg_decompress_struct& dinfo = decompress_lease.get();
+				initDecompressStruct(dinfo, mem_source.public_fields);
+				OutputWindow window;
+				setDecodeParameters(dinfo, scale_factor, crop_region, pixel_format, window);
+				startDecompressInWindow(dinfo, window);
+				readScanlinesIntoBuffer(dinfo, window, pixel_format, pixels, stride, capacity);
+			}
+
+			std::unique_ptr<DecodedImage> decodeJpeg(
+				const uint8_t* data,
+				size_t length,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				PixelFormat pixel_format) 
+			{
+				THROW_AND_RETURNVAL_IF(data == nullptr, "jpeg data cannot be null", nullptr);
+				if (!checkScaleFactor(scale_factor)) 
+				{
+					return nullptr;
+				}
+
+				JpegMemorySource mem_source;
+				mem_source.setBuffer(data, length);
+				JpegDecompressLease decompress_lease;
+				struct jpeg_decompress_struct& dinfo = decompress_lease.get();
+				initDecompressStruct(dinfo, mem_source.public_fields);
+				OutputWindow window;
+				setDecodeParameters(dinfo, scale_factor, crop_region, pixel_format, window);
+
+				const size_t stride = computeStride(pixel_format, window.width, kRowAlignment);
+				const size_t capacity = stride * window.height;
+				pixels_t pixels = PixelBufferPool::getInstance().lease(capacity);
+				std::vector<RestartBand> bands;
+				if (crop_region.isEmpty() && splitIntoRestartBands(data, length, bands)) 
+				{
+					decodeRestartBands(bands, scale_factor, pixel_format, pixels.get(), stride, capacity);
+				}
+				else 
+				{
+					startDecompressInWindow(dinfo, window);
+					readScanlinesIntoBuffer(dinfo, window, pixel_format, pixels.get(), stride, capacity);
+				}
+
+				std::unique_ptr<DecodedImage> decoded_image(new DecodedImage(
+					std::move(pixels),
+					pixel_format,
+					window.width,
+					window.height,
+					(unsigned int)stride,
+					std::vector<uint8_t>()));
+
+				return decoded_image;
+			}
+
+			/**
+			 * Crops, downscales and/or rotates jpeg read from given source and
+			 * writes the result to given destination.
+			 */
+			static void transformJpeg(
+				struct jpeg_source_mgr& source,
+				struct jpeg_destination_mgr& destination,
+				RotationType rotation_type,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options) 
+			{
+				const bool should_scale = scale_factor.shouldScale() || !target_size.isEmpty();
+				const bool should_rotate = rotation_type != RotationType::ROTATE_0;
+				const bool should_crop = !crop_region.isEmpty();
+				THROW_AND_RETURN_IF(
+					!should_scale && !should_rotate && !should_crop,
+					"no transformation to perform");
+
+				if (should_scale && (should_crop || should_rotate)) 
+				{
+					resizeAndRotateJpeg(
+						source,
+						destination,
+						rotation_type,
+						scale_factor,
+						crop_region,
+						target_size,
+						encode_options);
+				}
+				else if (should_scale) 
+				{
+					resizeJpeg(
+						source,
+						destination,
+						scale_factor,
+						target_size,
+						encode_options);
+				}
+				else 
+				{
+					rotateJpeg(
+						source,
+						destination,
+						rotation_type,
+						crop_region,
+						encode_options);
+				}
+			}
+
+			/**
+			 * Resizes jpeg held in memory, decoding bands split at restart
+			 * markers on several threads.
+			 *
+			 * <p> Unlike resizeJpeg, which streams rows from the decoder to the
+			 * encoder, all rows are decoded into a frame first, so images whose
+			 * scaled size exceeds kMaxMemoryForParallelResize are left to
+			 * resizeJpeg.
+			 *
+			 * @return false if the jpeg was not resized
+			 */
+			static bool resizeJpegInParallel(
+				const uint8_t* data,
+				size_t length,
+				struct jpeg_destination_mgr& destination,
+				const ScaleFactor& scale_factor,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options) 
+			{
+				std::vector<RestartBand> bands;
+				if (!splitIntoRestartBands(data, length, bands) ||
+					!checkResizeParameters(scale_factor, encode_options)) 
+				{
+					return false;
+				}
+
+				JpegMemorySource mem_source;
+				mem_source.setBuffer(data, length);
+				JpegDecompressLease decompress_lease;
+				struct jpeg_decompress_struct& dinfo = decompress_lease.get();
+				initDecompressStruct(dinfo, mem_source.public_fields);
+				dinfo.scale_num = scale_factor.getNumerator();
+				dinfo.scale_denom = scale_factor.getDenominator();
+				dinfo.out_color_space = JCS_RGB;
+				jpeg_calc_output_dimensions(&dinfo);
+
+				const int components = dinfo.output_components;
+				const size_t stride = (size_t)dinfo.output_width * components;
+				const size_t capacity = stride * dinfo.output_height;
+				if (capacity > kMaxMemoryForParallelResize) 
+				{
+					return false;
+				}
+
+				std::unique_ptr<uint8_t[]> frame(new uint8_t[capacity]);
+				decodeRestartBands(bands, scale_factor, PixelFormat::RGB, frame.get(), stride, capacity);
+
+				// Create compress struct.
+				JpegCompressLease compress_lease;
+				struct jpeg_compress_struct& cinfo = compress_lease.get();
+				std::unique_ptr<RowResampler> resampler = startResizedCompress(
+					dinfo,
+					cinfo,
+					destination,
+					target_size,
+					encode_options);
+
+				JSAMPARRAY resampled = (*dinfo.mem->alloc_sarray)(
+					(j_common_ptr)&dinfo,
+					JPOOL_IMAGE,
+					cinfo.image_width * components,
+					1);
+
+				for (JDIMENSION y = 0; y < dinfo.output_height; ++y) 
+				{
+					writeResizedScanline(cinfo, resampler.get(), frame.get() + y * stride, resampled);
+				}
+
+				// Tear down, leased structs are aborted when released.
+				jpeg_finish_compress(&cinfo);
+				return true;
+			}
+
+			/**
+			 * transformJpeg for jpeg held in memory. Resizes without cropping
+			 * or rotation run on several threads when the jpeg has restart
+			 * markers.
+			 */
+			static void transformJpegInMemory(
+				const uint8_t* data,
+				size_t length,
+				struct jpeg_destination_mgr& destination,
+				RotationType rotation_type,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options) 
+			{
+				THROW_AND_RETURN_IF(data == nullptr, "jpeg data cannot be null");
+
+				const bool should_scale = scale_factor.shouldScale() || !target_size.isEmpty();
+				if (should_scale &&
+					rotation_type == RotationType::ROTATE_0 &&
+					crop_region.isEmpty() &&
+					resizeJpegInParallel(
+						data,
+						length,
+						destination,
+						scale_factor,
+						target_size,
+						encode_options)) 
+				{
+					return;
+				}
+
+				JpegMemorySource mem_source;
+				mem_source.setBuffer(data, length);
+				transformJpeg(
+					mem_source.public_fields,
+					destination,
+					rotation_type,
+					scale_factor,
+					crop_region,
+					target_size,
+					encode_options);
+			}
+
+			void transformJpeg(
+				LPSTREAM is,
+				LPSTREAM os,
+				RotationType rotation_type,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options) 
+			{
+				JpegInputStreamWrapper is_wrapper { is };
+				JpegOutputStreamWrapper os_wrapper{ os };
+				transformJpeg(
+					is_wrapper.public_fields,
+					os_wrapper.public_fields,
+					rotation_type,
+					scale_factor,
+					crop_region,
+					target_size,
+					encode_options);
+			}
+
+			void transformJpeg(
+				const uint8_t* data,
+				size_t length,
+				LPSTREAM os,
+				RotationType rotation_type,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options) 
+			{
+				JpegOutputStreamWrapper os_wrapper{ os };
+				transformJpegInMemory(
+					data,
+					length,
+					os_wrapper.public_fields,
+					rotation_type,
+					scale_factor,
+					crop_region,
+					target_size,
+					encode_options);
+			}
+
+			void transformJpeg(
+				const uint8_t* data,
+				size_t length,
+				JpegChunkedDestination& destination,
+				RotationType rotation_type,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options) 
+			{
+				transformJpegInMemory(
+					data,
+					length,
+					destination.public_fields,
+					rotation_type,
+					scale_factor,
+					crop_region,
+					target_size,
+					encode_options);
+			}
+
+			/**
+			 * Stages of StreamingTranscoder, each one resumed until the
+			 * libjpeg call it waits for stops suspending.
+			 */
+			enum class StreamingStage
+			{
+				READ_HEADER,
+				START_DECOMPRESS,
+				READ_SCANLINES,
+				DONE
+			};
+
+			struct StreamingTranscoder::State
+			{
+				JpegStreamingSource source;
+				struct jpeg_destination_mgr& destination;
+				const ScaleFactor scale_factor;
+				const TargetSize target_size;
+				const EncodeOptions encode_options;
+				JpegDecompressLease decompress_lease;
+				JpegCompressLease compress_lease;
+				std::unique_ptr<RowResampler> resampler;
+				JSAMPARRAY buffer;
+				JSAMPARRAY resampled;
+				StreamingStage stage;
+
+				State(
+					struct jpeg_destination_mgr& destination,
+					const ScaleFactor& scale_factor,
+					const TargetSize& target_size,
+					const EncodeOptions& encode_options)
+					: destination(destination),
+					  scale_factor(scale_factor),
+					  target_size(target_size),
+					  encode_options(encode_options),
+					  buffer(nullptr),
+					  resampled(nullptr),
+					  stage(StreamingStage::READ_HEADER)
+				{
+				}
+			};
+
+			StreamingTranscoder::StreamingTranscoder(
+				JpegChunkedDestination& destination,
+				const ScaleFactor& scale_factor,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options)
+			{
+				// Nothing is leased before the parameters are known to be valid
+				THROW_AND_RETURN_IF(
+					!checkResizeParameters(scale_factor, encode_options),
+					"invalid transcode parameters");
+
+				state_.reset(new State(destination.public_fields, scale_factor, target_size, encode_options));
+				setFastDecodeParameters(state_->decompress_lease.get());
+				state_->decompress_lease.get().src = &state_->source.public_fields;
+			}
+
+			StreamingTranscoder::~StreamingTranscoder()
+			{
+			}
+
+			void StreamingTranscoder::appendInput(const uint8_t* data, size_t length)
+			{
+				state_->source.append(data, length);
+			}
+
+			void StreamingTranscoder::finishInput()
+			{
+				state_->source.finish();
+			}
+
+			bool StreamingTranscoder::resume()
+			{
+				State& state = *state_;
+				struct jpeg_decompress_struct& dinfo = state.decompress_lease.get();
+				struct jpeg_compress_struct& cinfo = state.compress_lease.get();
+
+				if (state.stage == StreamingStage::READ_HEADER) 
+				{
+					if (jpeg_read_header(&dinfo, true) == JPEG_SUSPENDED) 
+					{
+						return false;
+					}
+
+					dinfo.scale_num = state.scale_factor.getNumerator();
+					dinfo.scale_denom = state.scale_factor.getDenominator();
+					dinfo.out_color_space = JCS_RGB;
+					state.stage = StreamingStage::START_DECOMPRESS;
+				}
+
+				if (state.stage == StreamingStage::START_DECOMPRESS) 
+				{
+					// Absorbs all scans of a progressive jpeg before returning true.
+					if (!jpeg_start_decompress(&dinfo)) 
+					{
+						return false;
+					}
+
+					state.resampler = startResizedCompress(
+						dinfo,
+						cinfo,
+						state.destination,
+						state.target_size,
+						state.encode_options);
+
+					state.buffer = (*dinfo.mem->alloc_sarray)(
+						(j_common_ptr)&dinfo,
+						JPOOL_IMAGE,
+						dinfo.output_width * dinfo.output_components,
+						1);
+
+					state.resampled = (*dinfo.mem->alloc_sarray)(
+						(j_common_ptr)&dinfo,
+						JPOOL_IMAGE,
+						cinfo.image_width * cinfo.input_components,
+						1);
+
+					state.stage = StreamingStage::READ_SCANLINES;
+				}
+
+				if (state.stage == StreamingStage::READ_SCANLINES) 
+				{
+					while (dinfo.output_scanline < dinfo.output_height) 
+					{
+						if (jpeg_read_scanlines(&dinfo, state.buffer, 1) == 0) 
+						{
+							return false;
+						}
+
+						writeResizedScanline(cinfo, state.resampler.get(), state.buffer[0], state.resampled);
+					}
+
+					// Bytes after the last scanline are not needed, leased structs
+					// are aborted when released.
+					jpeg_finish_compress(&cinfo);
+					state.stage = StreamingStage::DONE;
+				}
+
+				return state.stage == StreamingStage::DONE;
 			}
 		} 
 	} 
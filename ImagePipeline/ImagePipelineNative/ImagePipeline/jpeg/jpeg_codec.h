@@ -10,8 +10,12 @@
 #ifndef _JPEG_CODEC_H_
 #define _JPEG_CODEC_H_
 
+#include <functional>
+#include <memory>
+
 #include "decoded_image.h"
 #include "transformations.h"
+#include "jpeg_encode_options.h"
 
 namespace facebook 
 {
@@ -19,35 +23,255 @@ namespace facebook
 	{
 		namespace jpeg 
 		{
+			struct JpegChunkedDestination;
+
 			/**
 			 * Encodes given image using libjpeg and writtes encoded bytes
 			 * into provided output stream.
 			 *
 			 * @param decoded_image
 			 * @param os output stream to write data to
-			 * @param quality value passed to jpeg encoder
+			 * @param encode_options parameters of the jpeg encoder
 			 */
 			void encodeJpegIntoOutputStream(
 				DecodedImage& decoded_image,
 				LPSTREAM os,
-				int quality);
+				const EncodeOptions& encode_options);
+
+			/**
+			 * Supplies the rows of an image being encoded, in order.
+			 */
+			typedef std::function<const uint8_t*()> RowSource;
 
 			/**
-			 * Downscales and rotates jpeg image
+			 * Encodes RGB rows pulled from given source one at a time, e.g.
+			 * as another decoder produces them, and writes encoded bytes
+			 * into provided output stream.
+			 *
+			 * @param width width of the image
+			 * @param height height of the image
+			 * @param next_row returns the next row of width RGB pixels,
+			 *        called height times
+			 * @param os output stream to write data to
+			 * @param encode_options parameters of the jpeg encoder
+			 */
+			void encodeJpegIntoOutputStream(
+				uint32_t width,
+				uint32_t height,
+				const RowSource& next_row,
+				LPSTREAM os,
+				const EncodeOptions& encode_options);
+
+			/**
+			 * Reads jpeg header and computes dimensions of the image decoded
+			 * with given scale factor and crop region.
+			 *
+			 * @param data pointer to encoded jpeg
+			 * @param length number of encoded bytes
+			 * @param scale_factor DCT scaling to apply, n/8
+			 * @param crop_region part of the image to decode, empty for all
+			 * @param width receives decoded width
+			 * @param height receives decoded height
+			 */
+			void getJpegDecodeSize(
+				const uint8_t* data,
+				size_t length,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				unsigned int& width,
+				unsigned int& height);
+
+			/**
+			 * Decodes jpeg into caller provided memory.
+			 *
+			 * <p> Rows are written directly into the buffer, row y starting at
+			 * pixels + y * stride, so the buffer may come from a pool and use
+			 * padded rows. Scaling is done by libjpeg during the IDCT.
+			 *
+			 * <p> If crop region is not empty only the iMCU rows and columns
+			 * intersecting it are decoded. The region is given in pixels of the
+			 * encoded image and is scaled along with the image.
+			 *
+			 * @param data pointer to encoded jpeg
+			 * @param length number of encoded bytes
+			 * @param scale_factor DCT scaling to apply, n/8
+			 * @param crop_region part of the image to decode, empty for all
+			 * @param pixel_format format of decoded pixels
+			 * @param pixels destination buffer
+			 * @param stride distance in bytes between starts of two rows
+			 * @param capacity size of destination buffer in bytes
+			 */
+			void decodeJpeg(
+				const uint8_t* data,
+				size_t length,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				PixelFormat pixel_format,
+				uint8_t* pixels,
+				size_t stride,
+				size_t capacity);
+
+			/**
+			 * Decodes jpeg into newly allocated DecodedImage, rows aligned
+			 * to kRowAlignment in a buffer leased from PixelBufferPool.
+			 *
+			 * @param data pointer to encoded jpeg
+			 * @param length number of encoded bytes
+			 * @param scale_factor DCT scaling to apply, n/8
+			 * @param crop_region part of the image to decode, empty for all
+			 * @param pixel_format format of decoded pixels
+			 */
+			std::unique_ptr<DecodedImage> decodeJpeg(
+				const uint8_t* data,
+				size_t length,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				PixelFormat pixel_format);
+
+			/**
+			 * Crops, downscales and rotates jpeg image
+			 *
+			 * <p> Crop region is given in pixels of the encoded image, an empty
+			 * region keeps the whole image.
+			 *
+			 * <p> Without scaling the crop is lossless, done on DCT blocks
+			 * together with the rotation. Its top left corner is then moved up
+			 * and left to the nearest iMCU boundary, so the output may be
+			 * slightly larger than the requested region.
 			 *
 			 * @param is InputStream
 			 * @param os OutputStream
 			 * @param rotation_type
 			 * @param scale_factor
-			 * @param crop_info
-			 * @param quality
+			 * @param crop_region
+			 * @param target_size exact size of the output before rotation, empty
+			 *        to keep the size reached by scale_factor
+			 * @param encode_options parameters of the jpeg encoder, only Huffman
+			 *        optimization and progressive scans apply to lossless
+			 *        transformations
 			 */
 			void transformJpeg(
 				LPSTREAM is,
 				LPSTREAM os,
 				RotationType rotation_type,
 				const ScaleFactor& scale_factor,
-				int quality);
+				const CropRegion& crop_region,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options);
+
+			/**
+			 * Crops, downscales and rotates jpeg image held in memory
+			 *
+			 * <p> The encoded bytes are read in place, without copying them
+			 * into intermediate buffers.
+			 *
+			 * @param data pointer to encoded jpeg
+			 * @param length number of encoded bytes
+			 * @param os OutputStream
+			 * @param rotation_type
+			 * @param scale_factor
+			 * @param crop_region
+			 * @param target_size exact size of the output before rotation, empty
+			 *        to keep the size reached by scale_factor
+			 * @param encode_options parameters of the jpeg encoder, only Huffman
+			 *        optimization and progressive scans apply to lossless
+			 *        transformations
+			 */
+			void transformJpeg(
+				const uint8_t* data,
+				size_t length,
+				LPSTREAM os,
+				RotationType rotation_type,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options);
+
+			/**
+			 * Crops, downscales and rotates jpeg image held in memory, writing the
+			 * result into chained chunks of native memory.
+			 *
+			 * @param data pointer to encoded jpeg
+			 * @param length number of encoded bytes
+			 * @param destination chunks receiving encoded bytes
+			 * @param rotation_type
+			 * @param scale_factor
+			 * @param crop_region
+			 * @param target_size exact size of the output before rotation, empty
+			 *        to keep the size reached by scale_factor
+			 * @param encode_options parameters of the jpeg encoder, only Huffman
+			 *        optimization and progressive scans apply to lossless
+			 *        transformations
+			 */
+			void transformJpeg(
+				const uint8_t* data,
+				size_t length,
+				JpegChunkedDestination& destination,
+				RotationType rotation_type,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options);
+
+			/**
+			 * Downscales jpeg whose bytes arrive over time, e.g. while it is
+			 * being downloaded.
+			 *
+			 * <p> Decoding suspends when the bytes received so far run out and
+			 * resumes once more are appended. Rows are scaled and encoded as
+			 * soon as they are decoded, so the output is complete shortly after
+			 * the last byte arrives. Progressive jpegs only produce rows after
+			 * their last scan, their bytes are still parsed as they arrive.
+			 *
+			 * <p> Rotation and crop need the whole image and are not supported.
+			 *
+			 * <p> Not thread safe, see StreamingTranscodeJob.
+			 */
+			class StreamingTranscoder
+			{
+			private:
+				struct State;
+				std::unique_ptr<State> state_;
+
+			public:
+				/**
+				 * @param destination chunks receiving encoded bytes
+				 * @param scale_factor
+				 * @param target_size exact size of the output, empty to keep the
+				 *        size reached by scale_factor
+				 * @param encode_options parameters of the jpeg encoder
+				 */
+				StreamingTranscoder(
+					JpegChunkedDestination& destination,
+					const ScaleFactor& scale_factor,
+					const TargetSize& target_size,
+					const EncodeOptions& encode_options);
+
+				~StreamingTranscoder();
+
+				// Disallow copying
+				StreamingTranscoder(const StreamingTranscoder& other) = delete;
+
+				StreamingTranscoder& operator=(const StreamingTranscoder& other) = delete;
+
+				/**
+				 * Copies given bytes after the ones received so far.
+				 */
+				void appendInput(const uint8_t* data, size_t length);
+
+				/**
+				 * Marks the end of the input. A jpeg still incomplete is then
+				 * decoded as if it ended with an EOI marker.
+				 */
+				void finishInput();
+
+				/**
+				 * Decodes and encodes as far as the received bytes allow.
+				 *
+				 * @return true once the output is complete
+				 */
+				bool resume();
+			};
 		}
 	}
 }
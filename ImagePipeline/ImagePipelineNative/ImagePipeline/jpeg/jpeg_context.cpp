@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifdef HAS_LIBJPEGTURBO
+
+#include <atomic>
+#include <string.h>
+#include <vector>
+
+#include "jpeg_context.h"
+#include "jpeg_memory_manager.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace jpeg
+		{
+			/**
+			 * Contexts kept per thread and struct type. A transcode leases one
+			 * of each, a few spare ones cover nested use.
+			 */
+			static const size_t kMaxCachedContexts = 2;
+
+			static std::atomic<uint64_t> created_context_count(0);
+			static std::atomic<uint64_t> reused_context_count(0);
+
+			static thread_local std::vector<std::unique_ptr<JpegDecompressContext>> decompress_contexts;
+			static thread_local std::vector<std::unique_ptr<JpegCompressContext>> compress_contexts;
+
+			JpegDecompressContext::JpegDecompressContext()
+			{
+				memset(&dinfo_, 0, sizeof(struct jpeg_decompress_struct));
+				error_handler_.setDecompressStruct(dinfo_);
+				jpeg_create_decompress(&dinfo_);
+				installArenaMemoryManager(reinterpret_cast<j_common_ptr>(&dinfo_));
+			}
+
+			JpegDecompressContext::~JpegDecompressContext()
+			{
+				jpeg_destroy_decompress(&dinfo_);
+			}
+
+			void JpegDecompressContext::reset()
+			{
+				jpeg_abort_decompress(&dinfo_);
+			}
+
+			JpegCompressContext::JpegCompressContext()
+			{
+				memset(&cinfo_, 0, sizeof(struct jpeg_compress_struct));
+				error_handler_.setCompressStruct(cinfo_);
+				jpeg_create_compress(&cinfo_);
+				installArenaMemoryManager(reinterpret_cast<j_common_ptr>(&cinfo_));
+
+				// Let libjpeg allocate and fill the standard tables once.
+				memset(standard_dc_huff_tbls_, 0, sizeof(standard_dc_huff_tbls_));
+				memset(standard_ac_huff_tbls_, 0, sizeof(standard_ac_huff_tbls_));
+				cinfo_.in_color_space = JCS_RGB;
+				cinfo_.input_components = 3;
+				jpeg_set_defaults(&cinfo_);
+				for (int i = 0; i < NUM_HUFF_TBLS; ++i)
+				{
+					if (cinfo_.dc_huff_tbl_ptrs[i])
+					{
+						standard_dc_huff_tbls_[i] = *cinfo_.dc_huff_tbl_ptrs[i];
+					}
+
+					if (cinfo_.ac_huff_tbl_ptrs[i])
+					{
+						standard_ac_huff_tbls_[i] = *cinfo_.ac_huff_tbl_ptrs[i];
+					}
+				}
+			}
+
+			JpegCompressContext::~JpegCompressContext()
+			{
+				jpeg_destroy_compress(&cinfo_);
+			}
+
+			void JpegCompressContext::reset()
+			{
+				jpeg_abort_compress(&cinfo_);
+				for (int i = 0; i < NUM_HUFF_TBLS; ++i)
+				{
+					if (cinfo_.dc_huff_tbl_ptrs[i])
+					{
+						*cinfo_.dc_huff_tbl_ptrs[i] = standard_dc_huff_tbls_[i];
+					}
+
+					if (cinfo_.ac_huff_tbl_ptrs[i])
+					{
+						*cinfo_.ac_huff_tbl_ptrs[i] = standard_ac_huff_tbls_[i];
+					}
+				}
+			}
+
+			template <typename Context>
+			static std::unique_ptr<Context> acquireContext(
+				std::vector<std::unique_ptr<Context>>& cache)
+			{
+				if (cache.empty())
+				{
+					// Reserved here so that releasing never allocates.
+					cache.reserve(kMaxCachedContexts);
+					++created_context_count;
+					return std::unique_ptr<Context>(new Context());
+				}
+
+				++reused_context_count;
+				std::unique_ptr<Context> context = std::move(cache.back());
+				cache.pop_back();
+				return context;
+			}
+
+			template <typename Context>
+			static void releaseContext(
+				std::vector<std::unique_ptr<Context>>& cache,
+				std::unique_ptr<Context> context)
+			{
+				if (!context)
+				{
+					return;
+				}
+
+				context->reset();
+				if (cache.size() < kMaxCachedContexts)
+				{
+					cache.push_back(std::move(context));
+				}
+			}
+
+			std::unique_ptr<JpegDecompressContext> acquireDecompressContext()
+			{
+				return acquireContext(decompress_contexts);
+			}
+
+			std::unique_ptr<JpegCompressContext> acquireCompressContext()
+			{
+				return acquireContext(compress_contexts);
+			}
+
+			void releaseDecompressContext(std::unique_ptr<JpegDecompressContext> context)
+			{
+				releaseContext(decompress_contexts, std::move(context));
+			}
+
+			void releaseCompressContext(std::unique_ptr<JpegCompressContext> context)
+			{
+				releaseContext(compress_contexts, std::move(context));
+			}
+
+			uint64_t getCreatedContextCount()
+			{
+				return created_context_count.load();
+			}
+
+			uint64_t getReusedContextCount()
+			{
+				return reused_context_count.load();
+			}
+		}
+	}
+}
+
+#endif // HAS_LIBJPEGTURBO
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#ifndef _JPEG_CONTEXT_H_
+#define _JPEG_CONTEXT_H_
+
+#include <memory>
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <jpeglib.h>
+
+#include "jpeg_error_handler.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace jpeg
+		{
+			/**
+			 * Created decompress struct together with the error handler it
+			 * reports to.
+			 *
+			 * <p> Creating the struct sets up the memory manager and the error
+			 * handler, destroying it frees all of its pools. Between images the
+			 * struct is only aborted, which rewinds the per-image arena and
+			 * brings the struct back to its initial state while keeping the
+			 * permanent allocations, e.g. Huffman and quantization tables.
+			 */
+			class JpegDecompressContext
+			{
+			private:
+				JpegErrorHandler error_handler_;
+				struct jpeg_decompress_struct dinfo_;
+
+			public:
+				JpegDecompressContext();
+
+				~JpegDecompressContext();
+
+				// Disallow copying
+				JpegDecompressContext(const JpegDecompressContext& other) = delete;
+
+				JpegDecompressContext& operator=(const JpegDecompressContext& other) = delete;
+
+				struct jpeg_decompress_struct& get()
+				{
+					return dinfo_;
+				}
+
+				/**
+				 * Aborts the image being decoded, if any.
+				 */
+				void reset();
+			};
+
+			/**
+			 * Created compress struct together with the error handler it
+			 * reports to. See JpegDecompressContext.
+			 */
+			class JpegCompressContext
+			{
+			private:
+				JpegErrorHandler error_handler_;
+				struct jpeg_compress_struct cinfo_;
+
+				/**
+				 * Standard Huffman tables, restored on reset. jpeg_set_defaults
+				 * only fills tables that are not allocated yet, so tables
+				 * optimized for the previous image would be used otherwise.
+				 */
+				JHUFF_TBL standard_dc_huff_tbls_[NUM_HUFF_TBLS];
+				JHUFF_TBL standard_ac_huff_tbls_[NUM_HUFF_TBLS];
+
+			public:
+				JpegCompressContext();
+
+				~JpegCompressContext();
+
+				// Disallow copying
+				JpegCompressContext(const JpegCompressContext& other) = delete;
+
+				JpegCompressContext& operator=(const JpegCompressContext& other) = delete;
+
+				struct jpeg_compress_struct& get()
+				{
+					return cinfo_;
+				}
+
+				/**
+				 * Aborts the image being encoded, if any, and restores the
+				 * standard Huffman tables.
+				 */
+				void reset();
+			};
+
+			/**
+			 * Takes a context from the cache of the calling thread, or creates
+			 * one if the cache is empty.
+			 */
+			std::unique_ptr<JpegDecompressContext> acquireDecompressContext();
+
+			std::unique_ptr<JpegCompressContext> acquireCompressContext();
+
+			/**
+			 * Resets given context and puts it back to the cache of the calling
+			 * thread. The context is destroyed if the cache is full.
+			 */
+			void releaseDecompressContext(std::unique_ptr<JpegDecompressContext> context);
+
+			void releaseCompressContext(std::unique_ptr<JpegCompressContext> context);
+
+			/**
+			 * Returns number of contexts created so far, on all threads.
+			 */
+			uint64_t getCreatedContextCount();
+
+			/**
+			 * Returns number of times a cached context was handed out again,
+			 * on all threads.
+			 */
+			uint64_t getReusedContextCount();
+
+			/**
+			 * Scoped lease of a decompress struct.
+			 *
+			 * <p> The struct goes back to the cache when the lease goes out of
+			 * scope, also when an exception thrown by the error handler unwinds
+			 * the stack, so libjpeg memory is never leaked.
+			 */
+			class JpegDecompressLease
+			{
+			private:
+				std::unique_ptr<JpegDecompressContext> context_;
+
+			public:
+				JpegDecompressLease() : context_(acquireDecompressContext())
+				{
+				}
+
+				~JpegDecompressLease()
+				{
+					releaseDecompressContext(std::move(context_));
+				}
+
+				// Disallow copying
+				JpegDecompressLease(const JpegDecompressLease& other) = delete;
+
+				JpegDecompressLease& operator=(const JpegDecompressLease& other) = delete;
+
+				struct jpeg_decompress_struct& get()
+				{
+					return context_->get();
+				}
+			};
+
+			/**
+			 * Scoped lease of a compress struct. See JpegDecompressLease.
+			 */
+			class JpegCompressLease
+			{
+			private:
+				std::unique_ptr<JpegCompressContext> context_;
+
+			public:
+				JpegCompressLease() : context_(acquireCompressContext())
+				{
+				}
+
+				~JpegCompressLease()
+				{
+					releaseCompressContext(std::move(context_));
+				}
+
+				// Disallow copying
+				JpegCompressLease(const JpegCompressLease& other) = delete;
+
+				JpegCompressLease& operator=(const JpegCompressLease& other) = delete;
+
+				struct jpeg_compress_struct& get()
+				{
+					return context_->get();
+				}
+			};
+		}
+	}
+}
+
+#endif // _JPEG_CONTEXT_H_
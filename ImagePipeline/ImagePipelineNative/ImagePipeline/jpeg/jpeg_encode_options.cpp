@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifdef HAS_LIBJPEGTURBO
+
+#include "exceptions.h"
+#include "jpeg_encode_options.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace jpeg
+		{
+			EncodeOptions getEncodePreset(EncodePreset preset, int quality)
+			{
+				switch (preset)
+				{
+					case EncodePreset::FASTEST:
+						return EncodeOptions(
+							quality,
+							false,
+							false,
+							ChromaSubsampling::YUV_420,
+							DctMethod::IFAST);
+
+					case EncodePreset::BALANCED:
+						return EncodeOptions(
+							quality,
+							true,
+							false,
+							ChromaSubsampling::YUV_420,
+							DctMethod::ISLOW);
+
+					case EncodePreset::SMALLEST:
+						return EncodeOptions(
+							quality,
+							true,
+							true,
+							ChromaSubsampling::YUV_420,
+							DctMethod::ISLOW);
+
+					default:
+						THROW_AND_RETURNVAL_IF(
+							true,
+							"wrong encode preset",
+							EncodeOptions(quality));
+				}
+			}
+
+			static J_DCT_METHOD getDctMethod(DctMethod dct_method)
+			{
+				switch (dct_method)
+				{
+					case DctMethod::ISLOW:
+						return JDCT_ISLOW;
+
+					case DctMethod::IFAST:
+						return JDCT_IFAST;
+
+					case DctMethod::FLOAT:
+						return JDCT_FLOAT;
+
+					default:
+						THROW_AND_RETURNVAL_IF(true, "wrong dct method", JDCT_ISLOW);
+				}
+			}
+
+			/**
+			 * Sets sampling factors of the luma component, chroma components
+			 * are never upsampled.
+			 */
+			static void setSubsampling(
+				struct jpeg_compress_struct& cinfo,
+				ChromaSubsampling subsampling)
+			{
+				int factor;
+				switch (subsampling)
+				{
+					case ChromaSubsampling::YUV_420:
+						factor = 2;
+						break;
+
+					case ChromaSubsampling::YUV_444:
+						factor = 1;
+						break;
+
+					default:
+						THROW_AND_RETURN_IF(true, "wrong chroma subsampling");
+				}
+
+				// Grayscale and RGB output has no chroma to subsample.
+				if (cinfo.jpeg_color_space != JCS_YCbCr || cinfo.num_components != 3)
+				{
+					return;
+				}
+
+				cinfo.comp_info[0].h_samp_factor = factor;
+				cinfo.comp_info[0].v_samp_factor = factor;
+				for (int i = 1; i < cinfo.num_components; ++i)
+				{
+					cinfo.comp_info[i].h_samp_factor = 1;
+					cinfo.comp_info[i].v_samp_factor = 1;
+				}
+			}
+
+			void setEncodeParameters(
+				struct jpeg_compress_struct& cinfo,
+				const EncodeOptions& options)
+			{
+				THROW_AND_RETURN_IF(
+					options.getQuality() < 1,
+					"quality should not be lower than 1");
+				THROW_AND_RETURN_IF(
+					options.getQuality() > 100,
+					"quality should not be greater than 100");
+
+				jpeg_set_quality(&cinfo, options.getQuality(), FALSE);
+				cinfo.dct_method = getDctMethod(options.getDctMethod());
+				setSubsampling(cinfo, options.getSubsampling());
+				setLosslessEncodeParameters(cinfo, options);
+			}
+
+			void setLosslessEncodeParameters(
+				struct jpeg_compress_struct& cinfo,
+				const EncodeOptions& options)
+			{
+				THROW_AND_RETURN_IF(
+					options.getRestartRows() < 0,
+					"restart rows should not be negative");
+				THROW_AND_RETURN_IF(
+					options.getRestartRows() > 0xFFFF,
+					"restart rows should not be greater than 65535");
+
+				cinfo.restart_in_rows = options.getRestartRows();
+				cinfo.optimize_coding = options.shouldOptimizeCoding() ? TRUE : FALSE;
+				if (options.isProgressive())
+				{
+					// Progressive scans always use optimized Huffman tables.
+					jpeg_simple_progression(&cinfo);
+				}
+			}
+		}
+	}
+}
+
+#endif // HAS_LIBJPEGTURBO
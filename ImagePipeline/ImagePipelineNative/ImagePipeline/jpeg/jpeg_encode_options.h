@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#ifndef _JPEG_ENCODE_OPTIONS_H_
+#define _JPEG_ENCODE_OPTIONS_H_
+
+#include <stdio.h>
+
+#include <jpeglib.h>
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace jpeg
+		{
+			/**
+			 * Chroma subsampling of encoded YCbCr images.
+			 *
+			 * <p> Values match JpegSubsampling in JpegEncodeOptions.cs.
+			 */
+			enum class ChromaSubsampling
+			{
+				YUV_420 = 0,
+				YUV_444 = 1
+			};
+
+			/**
+			 * Forward DCT used by the encoder.
+			 *
+			 * <p> Values match JpegDctMethod in JpegEncodeOptions.cs.
+			 */
+			enum class DctMethod
+			{
+				ISLOW = 0,
+				IFAST = 1,
+				FLOAT = 2
+			};
+
+			/**
+			 * Named trade-offs between encode time and output size.
+			 *
+			 * <p> Values match JpegEncodePreset in JpegEncodeOptions.cs.
+			 */
+			enum class EncodePreset
+			{
+				/**
+				 * Baseline Huffman tables and the fast integer DCT.
+				 */
+				FASTEST = 0,
+
+				/**
+				 * Optimized Huffman tables, a second pass over the coefficients
+				 * that leaves the pixels untouched.
+				 */
+				BALANCED = 1,
+
+				/**
+				 * Optimized Huffman tables and progressive scans.
+				 */
+				SMALLEST = 2
+			};
+
+			/**
+			 * Parameters of the jpeg encoder.
+			 */
+			class EncodeOptions
+			{
+			private:
+				const int quality_;
+				const bool optimize_coding_;
+				const bool progressive_;
+				const ChromaSubsampling subsampling_;
+				const DctMethod dct_method_;
+				const int restart_rows_;
+
+			public:
+				/**
+				 * Options matching the defaults of libjpeg: baseline, 4:2:0 and
+				 * the accurate integer DCT.
+				 */
+				explicit EncodeOptions(int quality)
+					: quality_(quality),
+					  optimize_coding_(false),
+					  progressive_(false),
+					  subsampling_(ChromaSubsampling::YUV_420),
+					  dct_method_(DctMethod::ISLOW),
+					  restart_rows_(0)
+				{
+				}
+
+				EncodeOptions(
+					int quality,
+					bool optimize_coding,
+					bool progressive,
+					ChromaSubsampling subsampling,
+					DctMethod dct_method,
+					int restart_rows = 0)
+					: quality_(quality),
+					  optimize_coding_(optimize_coding),
+					  progressive_(progressive),
+					  subsampling_(subsampling),
+					  dct_method_(dct_method),
+					  restart_rows_(restart_rows)
+				{
+				}
+
+				int getQuality() const
+				{
+					return quality_;
+				}
+
+				bool shouldOptimizeCoding() const
+				{
+					return optimize_coding_;
+				}
+
+				bool isProgressive() const
+				{
+					return progressive_;
+				}
+
+				ChromaSubsampling getSubsampling() const
+				{
+					return subsampling_;
+				}
+
+				DctMethod getDctMethod() const
+				{
+					return dct_method_;
+				}
+
+				/**
+				 * Number of MCU rows between restart markers, 0 for none.
+				 * Baseline images with restart markers can be decoded on
+				 * several threads.
+				 */
+				int getRestartRows() const
+				{
+					return restart_rows_;
+				}
+			};
+
+			/**
+			 * Returns options of given preset encoding with given quality.
+			 */
+			EncodeOptions getEncodePreset(EncodePreset preset, int quality);
+
+			/**
+			 * Applies given options to a compress struct encoding pixels.
+			 *
+			 * <p> Has to be called after jpeg_set_defaults, once the input
+			 * color space is known.
+			 */
+			void setEncodeParameters(
+				struct jpeg_compress_struct& cinfo,
+				const EncodeOptions& options);
+
+			/**
+			 * Applies options that do not touch the coefficients to a compress
+			 * struct writing coefficients, i.e. Huffman optimization,
+			 * progressive scans and restart markers.
+			 *
+			 * <p> Has to be called after jpeg_copy_critical_parameters.
+			 */
+			void setLosslessEncodeParameters(
+				struct jpeg_compress_struct& cinfo,
+				const EncodeOptions& options);
+		}
+	}
+}
+
+#endif // _JPEG_ENCODE_OPTIONS_H_
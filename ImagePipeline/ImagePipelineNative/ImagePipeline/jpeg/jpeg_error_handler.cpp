@@ -10,7 +10,6 @@
 #ifdef HAS_LIBJPEGTURBO
 
 #include <stdio.h>
-#include <setjmp.h>
 #include <stdexcept>
 
 #include <jpeglib.h>
@@ -24,7 +23,7 @@ namespace facebook
 	{
 		namespace jpeg 
 		{
-			JpegErrorHandler::JpegErrorHandler() : dinfoPtr(nullptr), cinfoPtr(nullptr) 
+			JpegErrorHandler::JpegErrorHandler() 
 			{
 				jpeg_std_error(&pub);
 				pub.error_exit = jpegThrow;
@@ -33,35 +32,11 @@ namespace facebook
 			void JpegErrorHandler::setDecompressStruct(jpeg_decompress_struct& dinfo) 
 			{
 				dinfo.err = &pub;
-				dinfoPtr = &dinfo;
 			}
 
 			void JpegErrorHandler::setCompressStruct(jpeg_compress_struct& cinfo) 
 			{
 				cinfo.err = &pub;
-				cinfoPtr = &cinfo;
-			}
-
-			/**
-			 * private method doing the actual cleanup:
-			 *  - free jpeg-turbo data structures
-			 *  - jump back to place determined by setjmpBuffer
-			 */
-			void jpegCleanup(JpegErrorHandler* error_handler) 
-			{
-				if (error_handler->dinfoPtr) 
-				{
-					jpeg_destroy_decompress(error_handler->dinfoPtr);
-					error_handler->dinfoPtr = nullptr;
-				}
-
-				if (error_handler->cinfoPtr) 
-				{
-					jpeg_destroy_compress(error_handler->cinfoPtr);
-					error_handler->cinfoPtr = nullptr;
-				}
-
-				longjmp(error_handler->setjmpBuffer, 1);
 			}
 
 			void jpegThrow(j_common_ptr cinfo) 
@@ -76,9 +51,7 @@ namespace facebook
 				j_common_ptr cinfo,
 				const char* msg) 
 			{
-				JpegErrorHandler* error_handler = (JpegErrorHandler*)cinfo->err;
 				throw exception(msg);
-				jpegCleanup(error_handler);
 			}
 		} 
 	} 
@@ -13,7 +13,6 @@
 #include <type_traits>
 
 #include <stdio.h>
-#include <setjmp.h>
 
 #include <jpeglib.h>
 
@@ -27,11 +26,17 @@ namespace facebook
 			 * Custom error handler for libjpeg-turbo.
 			 *
 			 * <p> By default libjpeg handles errors by terminating running process.
-			 * This one uses setjmp / longjmp instead.
+			 * This one throws an exception encapsulating the error message passed
+			 * by libjpeg instead.
 			 *
-			 * <p> In addition to calling longjmp when error occurs, the error handler
-			 * will throw instance of RuntimeException encapsulating error message
-			 * passed by libjpeg.
+			 * <p> The handler does not free the struct it is attached to. The owner
+			 * of the struct, see JpegDecompressLease and JpegCompressLease, aborts
+			 * or destroys it while the exception unwinds the stack, which keeps
+			 * the struct usable for the next image.
+			 *
+			 * <p> The exception unwinds through libjpeg, which is c code. The
+			 * project compiles with /EHs instead of /EHsc so that the compiler
+			 * doesn't assume extern "C" functions never throw.
 			 *
 			 * <p> This is not a c++ class because the only purpose of the handler is to
 			 * be used with libjpeg which is a c library.
@@ -39,10 +44,6 @@ namespace facebook
 			struct JpegErrorHandler 
 			{
 				struct jpeg_error_mgr pub;      // default fields defined by libjpeg
-				jmp_buf setjmpBuffer;           // return point
-
-				jpeg_decompress_struct* dinfoPtr;
-				jpeg_compress_struct* cinfoPtr;
 
 				/**
 				* Constructs JpegErrorHanlder.
@@ -78,26 +79,16 @@ namespace facebook
 				"offset of fb_jpeg_error_handler.pub should be 0");
 
 			/**
-			 * Throws RuntimeException with message formatted by libjpeg and jumps
-			 * to the place pointed by setjmp buffer of associated fb_jpeg_error_handler
+			 * Throws RuntimeException with message formatted by libjpeg.
 			 */
 			void jpegThrow(j_common_ptr cinfo);
 
 			/**
-			 * If there is no exception pending, throws RuntimeException initialized
-			 * with passed message. In any case, returns control to the place poitned
-			 * by setjmp buffer of associated JpegErrorHandler structure.
+			 * Throws RuntimeException initialized with passed message.
 			 */
 			void jpegSafeThrow(
 				j_common_ptr cinfo,
 				const char* msg);
-
-			/**
-			 * Doing the actual cleanup:
-			 *  - free jpeg-turbo data structures
-			 *  - jump back to place determined by setjmpBuffer
-			 */
-			void jpegCleanup(JpegErrorHandler* error_handler);
 		} 
 	} 
 }
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <string.h>
+
+#include "jpeg_marker_scanner.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MARKER_SCANNER_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM) || defined(_M_ARM64)
+#define MARKER_SCANNER_USE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace jpeg
+		{
+			static const uint8_t kMarkerPrefix = 0xFF;
+			static const uint8_t kStuffedZero = 0x00;
+			static const uint8_t kTEM = 0x01;
+			static const uint8_t kRST0 = 0xD0;
+			static const uint8_t kRST7 = 0xD7;
+			static const uint8_t kSOI = 0xD8;
+			static const uint8_t kEOI = 0xD9;
+			static const uint8_t kSOS = 0xDA;
+
+#if defined(MARKER_SCANNER_USE_SSE2)
+			static inline unsigned int countTrailingZeros(uint32_t mask)
+			{
+#if defined(_MSC_VER)
+				unsigned long index;
+				_BitScanForward(&index, mask);
+				return (unsigned int)index;
+#else
+				return (unsigned int)__builtin_ctz(mask);
+#endif
+			}
+#endif
+
+			/**
+			 * Returns the first 0xFF in [data, end), or end if there is none.
+			 *
+			 * <p> Entropy coded data holds few 0xFF bytes, each followed by a
+			 * stuffed zero, so nearly all of it is skipped a vector at a time.
+			 */
+			static const uint8_t* findMarkerPrefix(const uint8_t* data, const uint8_t* end)
+			{
+#if defined(MARKER_SCANNER_USE_SSE2)
+				const __m128i prefix16 = _mm_set1_epi8((char)kMarkerPrefix);
+				for (; end - data >= 16; data += 16)
+				{
+					const __m128i bytes = _mm_loadu_si128((const __m128i*)data);
+					const uint32_t mask = (uint32_t)_mm_movemask_epi8(
+						_mm_cmpeq_epi8(bytes, prefix16));
+					if (mask != 0)
+					{
+						return data + countTrailingZeros(mask);
+					}
+				}
+#elif defined(MARKER_SCANNER_USE_NEON)
+				const uint8x16_t prefix16 = vdupq_n_u8(kMarkerPrefix);
+				for (; end - data >= 16; data += 16)
+				{
+					const uint64x2_t found = vreinterpretq_u64_u8(
+						vceqq_u8(vld1q_u8(data), prefix16));
+					if ((vgetq_lane_u64(found, 0) | vgetq_lane_u64(found, 1)) != 0)
+					{
+						// NEON has no movemask, the prefix is within these 16 bytes
+						break;
+					}
+				}
+#endif
+
+				const uint8_t* prefix =
+					(const uint8_t*)memchr(data, kMarkerPrefix, end - data);
+				return prefix ? prefix : end;
+			}
+
+			/**
+			 * Not every marker is followed by associated segment.
+			 */
+			static bool doesMarkerStartSegment(uint8_t marker)
+			{
+				if (marker == kTEM)
+				{
+					return false;
+				}
+
+				if (marker >= kRST0 && marker <= kRST7)
+				{
+					return false;
+				}
+
+				return marker != kEOI && marker != kSOI;
+			}
+
+			size_t scanMarkers(
+				const uint8_t* data,
+				size_t length,
+				MarkerScanner& scanner,
+				int32_t* scan_offsets,
+				size_t capacity)
+			{
+				size_t count = 0;
+				size_t offset = scanner.bytes_parsed;
+				while (offset < length &&
+					count < capacity &&
+					scanner.state != MarkerScanState::NOT_A_JPEG)
+				{
+					if (scanner.state == MarkerScanState::READ_MARKER_FIRST_BYTE_OR_ENTROPY_DATA)
+					{
+						const uint8_t* prefix = findMarkerPrefix(data + offset, data + length);
+						offset = prefix - data;
+						if (offset < length)
+						{
+							++offset;
+							scanner.state = MarkerScanState::READ_MARKER_SECOND_BYTE;
+						}
+
+						continue;
+					}
+
+					const uint8_t next_byte = data[offset++];
+					switch (scanner.state)
+					{
+					case MarkerScanState::READ_FIRST_JPEG_BYTE:
+						scanner.state = next_byte == kMarkerPrefix ?
+							MarkerScanState::READ_SECOND_JPEG_BYTE :
+							MarkerScanState::NOT_A_JPEG;
+						break;
+
+					case MarkerScanState::READ_SECOND_JPEG_BYTE:
+						scanner.state = next_byte == kSOI ?
+							MarkerScanState::READ_MARKER_FIRST_BYTE_OR_ENTROPY_DATA :
+							MarkerScanState::NOT_A_JPEG;
+						break;
+
+					case MarkerScanState::READ_MARKER_SECOND_BYTE:
+						if (next_byte == kMarkerPrefix)
+						{
+							// Fill byte, the marker is yet to come
+						}
+						else if (next_byte == kStuffedZero)
+						{
+							scanner.state = MarkerScanState::READ_MARKER_FIRST_BYTE_OR_ENTROPY_DATA;
+						}
+						else
+						{
+							if (next_byte == kSOS || next_byte == kEOI)
+							{
+								scan_offsets[count++] = (int32_t)(offset - 2);
+							}
+
+							scanner.state = doesMarkerStartSegment(next_byte) ?
+								MarkerScanState::READ_SIZE_FIRST_BYTE :
+								MarkerScanState::READ_MARKER_FIRST_BYTE_OR_ENTROPY_DATA;
+						}
+
+						break;
+
+					case MarkerScanState::READ_SIZE_FIRST_BYTE:
+						scanner.size_first_byte = next_byte;
+						scanner.state = MarkerScanState::READ_SIZE_SECOND_BYTE;
+						break;
+
+					case MarkerScanState::READ_SIZE_SECOND_BYTE:
+					{
+						// The size includes its own two bytes. The segment may end
+						// past the data received so far, offset then tells how
+						// much is left to skip on the next call.
+						const size_t size = ((size_t)scanner.size_first_byte << 8) + next_byte;
+						if (size > 2)
+						{
+							offset += size - 2;
+						}
+
+						scanner.state = MarkerScanState::READ_MARKER_FIRST_BYTE_OR_ENTROPY_DATA;
+						break;
+					}
+
+					default:
+						scanner.state = MarkerScanState::NOT_A_JPEG;
+						break;
+					}
+				}
+
+				scanner.bytes_parsed = offset;
+				return count;
+			}
+		}
+	}
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#ifndef _JPEG_MARKER_SCANNER_H_
+#define _JPEG_MARKER_SCANNER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace jpeg
+		{
+			/**
+			 * States of the marker scanner.
+			 *
+			 * <p> Values match the parser states in ProgressiveJpegParser.cs.
+			 */
+			enum class MarkerScanState
+			{
+				READ_FIRST_JPEG_BYTE = 0,
+				READ_SECOND_JPEG_BYTE = 1,
+				READ_MARKER_FIRST_BYTE_OR_ENTROPY_DATA = 2,
+				READ_MARKER_SECOND_BYTE = 3,
+				READ_SIZE_FIRST_BYTE = 4,
+				READ_SIZE_SECOND_BYTE = 5,
+				NOT_A_JPEG = 6
+			};
+
+			/**
+			 * Position of the scanner in a jpeg being downloaded, kept by the
+			 * caller between calls.
+			 */
+			struct MarkerScanner
+			{
+				MarkerScanState state;
+
+				/**
+				 * First byte of the segment size, while in READ_SIZE_SECOND_BYTE.
+				 */
+				uint8_t size_first_byte;
+
+				/**
+				 * Offset of the next byte to scan, past the end of the data
+				 * received so far when skipping a segment not fully received.
+				 */
+				size_t bytes_parsed;
+			};
+
+			/**
+			 * Scans the jpeg from scanner.bytes_parsed up to length for SOS and
+			 * EOI markers, skipping marker segments and stuffed bytes the same
+			 * way ProgressiveJpegParser does.
+			 *
+			 * <p> Entropy coded data is searched for 0xFF 16 bytes at a time.
+			 * Scanning stops once capacity markers were found, calling
+			 * again resumes right after the last of them.
+			 *
+			 * @param data pointer to the jpeg received so far
+			 * @param length number of bytes received so far
+			 * @param scanner the scanner position, updated
+			 * @param scan_offsets receives the offsets of the SOS and EOI markers,
+			 * 32 bits as the managed parser passes its own buffer
+			 * @param capacity maximum number of offsets to return
+			 * @return number of offsets written to scan_offsets
+			 */
+			size_t scanMarkers(
+				const uint8_t* data,
+				size_t length,
+				MarkerScanner& scanner,
+				int32_t* scan_offsets,
+				size_t capacity);
+		}
+	}
+}
+
+#endif // _JPEG_MARKER_SCANNER_H_
@@ -11,6 +11,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <limits.h>
 #include <stdio.h>
 
 #include <jpeglib.h>
@@ -38,8 +39,8 @@ namespace facebook
 			static void memSourceInit(j_decompress_ptr dinfo) 
 			{
 				JpegMemorySource* src = reinterpret_cast<JpegMemorySource*>(dinfo->src);
-				src->public_fields.next_input_byte = src->buffer.data();
-				src->public_fields.bytes_in_buffer = src->buffer.size();
+				src->public_fields.next_input_byte = src->data;
+				src->public_fields.bytes_in_buffer = src->length;
 			}
 
 			/*
@@ -111,6 +112,92 @@ namespace facebook
 				public_fields.term_source = memSourceTermSource;
 				public_fields.bytes_in_buffer = 0;
 				public_fields.next_input_byte = nullptr;
+				data = nullptr;
+				length = 0;
+			}
+
+			/**
+			 * Initialize streaming source.
+			 *
+			 * <p> This function is a callback passed to libjpeg and should not be used
+			 * directly.
+			 *
+			 * <p> The read pointer is kept up to date by append, so there is nothing
+			 * to do.
+			 */
+			static void streamingSourceInit(j_decompress_ptr dinfo) 
+			{
+			}
+
+			/**
+			 * Fill the input buffer of streaming source.
+			 *
+			 * <p> This function is a callback passed to libjpeg and should not be used
+			 * directly.
+			 *
+			 * <p> Suspends libjpeg until more bytes are appended. Once the source is
+			 * finished, provides extra EOI marker, see memSourceFillInputBuffer.
+			 */
+			static boolean streamingSourceFillInputBuffer(j_decompress_ptr dinfo) 
+			{
+				JpegStreamingSource* src = reinterpret_cast<JpegStreamingSource*>(dinfo->src);
+				if (!src->finished) 
+				{
+					return false;
+				}
+
+				return memSourceFillInputBuffer(dinfo);
+			}
+
+			/**
+			 * Skip data of streaming source.
+			 *
+			 * <p> This function is a callback passed to libjpeg and should not be used
+			 * directly.
+			 *
+			 * <p> Bytes that did not arrive yet are remembered and dropped by append.
+			 */
+			static void streamingSourceSkipInputData(j_decompress_ptr dinfo, long num_bytes) 
+			{
+				if (num_bytes <= 0) 
+				{
+					return;
+				}
+
+				JpegStreamingSource* src = reinterpret_cast<JpegStreamingSource*>(dinfo->src);
+				const size_t available = src->public_fields.bytes_in_buffer;
+				const size_t skipped = std::min<size_t>((size_t)num_bytes, available);
+				src->public_fields.next_input_byte += skipped;
+				src->public_fields.bytes_in_buffer -= skipped;
+				src->bytes_to_skip += (size_t)num_bytes - skipped;
+			}
+
+			JpegStreamingSource::JpegStreamingSource() 
+			{
+				public_fields.init_source = streamingSourceInit;
+				public_fields.fill_input_buffer = streamingSourceFillInputBuffer;
+				public_fields.skip_input_data = streamingSourceSkipInputData;
+				public_fields.resync_to_restart = jpeg_resync_to_restart;
+				public_fields.term_source = memSourceTermSource;
+				public_fields.bytes_in_buffer = 0;
+				public_fields.next_input_byte = nullptr;
+				bytes_to_skip = 0;
+				finished = false;
+			}
+
+			void JpegStreamingSource::append(const uint8_t* data, size_t length) 
+			{
+				const size_t skipped = std::min(bytes_to_skip, length);
+				bytes_to_skip -= skipped;
+				data += skipped;
+				length -= skipped;
+
+				// libjpeg never reads again bytes before next_input_byte, after a
+				// suspension it resumes from there.
+				buffer.erase(buffer.begin(), buffer.end() - public_fields.bytes_in_buffer);
+				buffer.insert(buffer.end(), data, data + length);
+				public_fields.next_input_byte = buffer.data();
+				public_fields.bytes_in_buffer = buffer.size();
 			}
 
 			/**
@@ -193,6 +280,107 @@ namespace facebook
 				public_fields.empty_output_buffer = memDestinationEmptyOutputBuffer;
 				public_fields.term_destination = memDestinationTerm;
 			}
+
+			/**
+			 * Initialize chunked destination.
+			 *
+			 * <p> This function is a callback passed to libjpeg and should not be used
+			 * directly.
+			 *
+			 * <p> Points libjpeg at the beginning of the first chunk.
+			 */
+			static void chunkedDestinationInit(j_compress_ptr cinfo) 
+			{
+				JpegChunkedDestination* dest =
+					reinterpret_cast<JpegChunkedDestination*>(cinfo->dest);
+
+				JpegOutputChunk& chunk = dest->chunks.front();
+				chunk.size = 0;
+				dest->public_fields.next_output_byte = chunk.data;
+				dest->public_fields.free_in_buffer = chunk.capacity;
+			}
+
+			/**
+			 * Chain next chunk.
+			 *
+			 * <p> This function is a callback passed to libjpeg and should not be used
+			 * directly.
+			 *
+			 * <p> Called by libjpeg when the current chunk is full. Asks the allocator
+			 * for a chunk as big as the current one and lets libjpeg continue there.
+			 * Chunks double the capacity written so far until the allocator caps
+			 * their size.
+			 */
+			static boolean chunkedDestinationEmptyOutputBuffer(j_compress_ptr cinfo) 
+			{
+				JpegChunkedDestination* dest =
+					reinterpret_cast<JpegChunkedDestination*>(cinfo->dest);
+
+				dest->chunks.back().size = dest->chunks.back().capacity;
+				const int preferred_capacity =
+					(int)std::min<size_t>(dest->chunks.back().capacity, INT_MAX);
+				int capacity = 0;
+				JOCTET* data = nullptr;
+				if (dest->allocate_chunk != nullptr) 
+				{
+					data = (JOCTET*)LONG_TO_PTR(
+						dest->allocate_chunk(dest->cookie, preferred_capacity, &capacity));
+				}
+
+				if (data == nullptr || capacity <= 0) 
+				{
+					jpegSafeThrow(
+						(j_common_ptr) cinfo,
+						"Failed to allocate memory for libjpeg output chunk.");
+				}
+
+				dest->chunks.push_back({ data, (size_t)capacity, 0 });
+				dest->public_fields.next_output_byte = data;
+				dest->public_fields.free_in_buffer = capacity;
+				return true;
+			}
+
+			/**
+			 * Terminate chunked destination.
+			 *
+			 * <p> This function is a callback passed to libjpeg and should not be used
+			 * directly.
+			 *
+			 * <p> Records number of bytes written to the last chunk.
+			 */
+			static void chunkedDestinationTerm(j_compress_ptr cinfo) 
+			{
+				JpegChunkedDestination* dest =
+					reinterpret_cast<JpegChunkedDestination*>(cinfo->dest);
+
+				JpegOutputChunk& chunk = dest->chunks.back();
+				chunk.size = chunk.capacity - dest->public_fields.free_in_buffer;
+			}
+
+			JpegChunkedDestination::JpegChunkedDestination(
+				JOCTET* first_chunk,
+				size_t capacity,
+				OutputChunkAllocator allocate_chunk,
+				int64_t cookie) 
+				: allocate_chunk(allocate_chunk),
+				  cookie(cookie)
+			{
+				public_fields.init_destination = chunkedDestinationInit;
+				public_fields.empty_output_buffer = chunkedDestinationEmptyOutputBuffer;
+				public_fields.term_destination = chunkedDestinationTerm;
+				chunks.push_back({ first_chunk, capacity, 0 });
+			}
+
+			size_t JpegChunkedDestination::getSize() const 
+			{
+				size_t size = 0;
+				for (const JpegOutputChunk& chunk : chunks) 
+				{
+					size += chunk.size;
+				}
+
+				return size;
+			}
 		} 
 	} 
 }
@@ -21,7 +21,10 @@ namespace facebook
 		namespace jpeg 
 		{
 			/**
-			 * Provides jpeg data from std::vector.
+			 * Provides jpeg data from memory.
+			 *
+			 * <p> The bytes are either owned by the source (std::vector) or borrowed
+			 * from the caller, in which case libjpeg reads them in place.
 			 *
 			 * <p> This struct is designed to be directly castable to and from
 			 * jpeg_source_mgr so it can be passed to and from libjpeg.
@@ -31,19 +34,37 @@ namespace facebook
 				/**
 				 * jpeg_source_mgr is a struct used by libjpeg to encapsulate bytes source.
 				 * It consists of callbacks (fucntion pointers) and memory pointer to read
-				 * buffer. Our implementations point public_fields correctly at buffer.
+				 * buffer. Our implementations point public_fields correctly at data.
 				 */
 				struct jpeg_source_mgr public_fields;
 				std::vector<uint8_t> buffer;
+				const uint8_t* data;
+				size_t length;
 
 				/**
-				 * Creates jpeg_source_mgr providing bytes from std::vector.
+				 * Creates jpeg_source_mgr providing bytes from memory.
 				 */
 				JpegMemorySource();
 
+				/**
+				 * Takes ownership of given buffer.
+				 */
 				void setBuffer(std::vector<uint8_t>&& new_buffer) 
 				{
 					buffer = std::move(new_buffer);
+					data = buffer.data();
+					length = buffer.size();
+				}
+
+				/**
+				 * Reads given memory in place. The memory has to stay valid
+				 * until libjpeg is done with the source.
+				 */
+				void setBuffer(const uint8_t* new_data, size_t new_length) 
+				{
+					buffer.clear();
+					data = new_data;
+					length = new_length;
 				}
 			};
 
@@ -61,6 +82,69 @@ namespace facebook
 				offsetof(JpegMemorySource, public_fields) == 0,
 				"offset of JpegMemorySource.public_fields should be 0");
 
+			/**
+			 * Provides jpeg data arriving over time, e.g. while downloading.
+			 *
+			 * <p> This is a suspending source: when libjpeg runs out of bytes before
+			 * finish is called, fill_input_buffer returns false and the libjpeg
+			 * call that needed them returns without progress. It can be called
+			 * again once more bytes are appended.
+			 *
+			 * <p> Only the bytes libjpeg has not consumed yet are kept.
+			 *
+			 * <p> This struct is designed to be directly castable to and from
+			 * jpeg_source_mgr so it can be passed to and from libjpeg.
+			 */
+			struct JpegStreamingSource 
+			{
+				struct jpeg_source_mgr public_fields;
+				std::vector<uint8_t> buffer;
+
+				/**
+				 * Bytes libjpeg asked to skip beyond the end of the buffer, dropped
+				 * from the following appends.
+				 */
+				size_t bytes_to_skip;
+
+				/**
+				 * Set once all bytes were appended.
+				 */
+				bool finished;
+
+				/**
+				 * Creates suspending jpeg_source_mgr with no bytes.
+				 */
+				JpegStreamingSource();
+
+				/**
+				 * Copies given bytes after the ones received so far.
+				 */
+				void append(const uint8_t* data, size_t length);
+
+				/**
+				 * Marks the end of the data. A jpeg still incomplete is then
+				 * ended with an EOI marker, like with JpegMemorySource.
+				 */
+				void finish() 
+				{
+					finished = true;
+				}
+			};
+
+			/**
+			 * We cast pointers of type struct jpeg_source_mgr* pointing to public_fields
+			 * to a pointer of type struct JpegStreamingSource* and expect that we obtain a
+			 * valid pointer to enclosing structure. Assertions below ensure that this
+			 * assumption is always true.
+			 */
+			static_assert(
+				std::is_standard_layout<JpegStreamingSource>::value,
+				"JpegStreamingSource has to be type of standard layout");
+
+			static_assert(
+				offsetof(JpegStreamingSource, public_fields) == 0,
+				"offset of JpegStreamingSource.public_fields should be 0");
+
 			/**
 			 * Stores libjpeg output in memory using std::vector
 			 *
@@ -106,6 +190,79 @@ namespace facebook
 			static_assert(
 				offsetof(JpegMemoryDestination, public_fields) == 0,
 				"offset of JpegMemoryDestination.public_fields should be 0");
+
+			/**
+			 * Block of memory written by JpegChunkedDestination.
+			 */
+			struct JpegOutputChunk 
+			{
+				JOCTET* data;
+				size_t capacity;
+				size_t size;
+			};
+
+			/**
+			 * Provides the chunk following a full one, typically taken from
+			 * NativeMemoryChunkPool. Returns the address of the chunk, preferably
+			 * of at least preferred_capacity bytes, and stores its size in
+			 * capacity, or returns 0 if no memory is available. cookie is the one
+			 * the destination was created with.
+			 */
+			typedef int64_t (*OutputChunkAllocator)(int64_t cookie, int preferred_capacity, int* capacity);
+
+			/**
+			 * Stores libjpeg output directly in chunks of native memory.
+			 *
+			 * <p> libjpeg writes straight into the free space of the current chunk.
+			 * All chunks are provided by the caller, the first one up front and
+			 * the following ones by the allocator whenever a chunk fills up.
+			 * Bytes written so far are never moved, the caller reads the output
+			 * from its chunks once libjpeg is done.
+			 *
+			 * <p> This struct is designed to be directly castable to and from
+			 * jpeg_destination_mgr so it can be passed to and from libjpeg.
+			 */
+			struct JpegChunkedDestination 
+			{
+				struct jpeg_destination_mgr public_fields;
+				std::vector<JpegOutputChunk> chunks;
+				OutputChunkAllocator allocate_chunk;
+				int64_t cookie;
+
+				/**
+				 * Creates jpeg_destination_mgr writing into given memory first.
+				 * All chunks stay owned by the caller.
+				 */
+				JpegChunkedDestination(
+					JOCTET* first_chunk,
+					size_t capacity,
+					OutputChunkAllocator allocate_chunk,
+					int64_t cookie);
+
+				// Disallow copying
+				JpegChunkedDestination(const JpegChunkedDestination& other) = delete;
+
+				JpegChunkedDestination& operator=(const JpegChunkedDestination& other) = delete;
+
+				/**
+				 * Returns total number of bytes written.
+				 */
+				size_t getSize() const;
+			};
+
+			/**
+			 * We cast pointers of type struct jpeg_destination_mgr* pointing to public_fields
+			 * to a pointer of type struct JpegChunkedDestination* and expect that we obtain a
+			 * valid pointer to enclosing structure. Assertions below ensure that this
+			 * assumption is always true.
+			 */
+			static_assert(
+				std::is_standard_layout<JpegChunkedDestination>::value,
+				"JpegChunkedDestination has to be type of standard layout");
+
+			static_assert(
+				offsetof(JpegChunkedDestination, public_fields) == 0,
+				"offset of JpegChunkedDestination.public_fields should be 0");
 		} 
 	} 
 }
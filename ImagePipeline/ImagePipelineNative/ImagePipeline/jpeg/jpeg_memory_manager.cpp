@@ -0,0 +1,565 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifdef HAS_LIBJPEGTURBO
+
+#include <algorithm>
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <stdio.h>
+
+#include <jpeglib.h>
+#include <jerror.h>
+
+#include "jpeg_memory_manager.h"
+
+/**
+ * Virtual array control blocks. libjpeg only declares these, each memory
+ * manager defines its own.
+ */
+struct jvirt_sarray_control
+{
+	JSAMPARRAY mem_buffer;
+	JDIMENSION rows_in_array;
+	JDIMENSION samplesperrow;
+	JDIMENSION maxaccess;
+	boolean pre_zero;
+	boolean realized;
+	jvirt_sarray_ptr next;
+};
+
+struct jvirt_barray_control
+{
+	JBLOCKARRAY mem_buffer;
+	JDIMENSION rows_in_array;
+	JDIMENSION blocksperrow;
+	JDIMENSION maxaccess;
+	boolean pre_zero;
+	boolean realized;
+	jvirt_barray_ptr next;
+};
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace jpeg
+		{
+			/**
+			 * Alignment of sample and coefficient rows, one cache line. Wide
+			 * enough for any SIMD load used by libjpeg-turbo.
+			 */
+			static const size_t kArenaRowAlignment = 64;
+
+			/**
+			 * Alignment of other objects. Matches ALIGN_SIZE of libjpeg-turbo
+			 * built with SIMD, 32 bytes for AVX2, which its own manager
+			 * guarantees for every alloc_small and alloc_large result.
+			 */
+			static const size_t kArenaAlignment = 32;
+
+			/**
+			 * Size of the first block. Later blocks double in size up to
+			 * kMaxArenaBlockSize, larger requests get a block of their own.
+			 */
+			static const size_t kMinArenaBlockSize = 256 * 1024;
+
+			static const size_t kMaxArenaBlockSize = 4 * 1024 * 1024;
+
+			/**
+			 * Blocks kept once the image pool is freed. Anything above is given
+			 * back so that a single huge image does not pin its memory.
+			 */
+			static const size_t kMaxRetainedArenaSize = 8 * 1024 * 1024;
+
+			/**
+			 * Largest single request, mirrors MAX_ALLOC_CHUNK of libjpeg.
+			 */
+			static const size_t kMaxArenaAllocation = 1000000000;
+
+			struct ArenaBlock
+			{
+				ArenaBlock* next;
+				uint8_t* data;
+				size_t capacity;
+				size_t used;
+			};
+
+			struct ArenaMemoryManager
+			{
+				struct jpeg_memory_mgr pub; // public fields, must be first
+				struct jpeg_memory_mgr* base;
+
+				ArenaBlock* blocks;
+				ArenaBlock* current;
+				size_t next_block_size;
+
+				size_t virtual_bytes;
+				jvirt_sarray_ptr virt_sarray_list;
+				jvirt_barray_ptr virt_barray_list;
+
+				// Addresses handed out since the last reset, or-ed together.
+				uintptr_t address_bits;
+			};
+
+			/**
+			 * Address bits of all arenas, published when an arena is reset.
+			 */
+			static std::atomic<uintptr_t> arena_address_bits(0);
+
+			static ArenaMemoryManager* getManager(j_common_ptr cinfo)
+			{
+				return reinterpret_cast<ArenaMemoryManager*>(cinfo->mem);
+			}
+
+			static size_t alignSize(size_t size, size_t alignment)
+			{
+				return (size + alignment - 1) & ~(alignment - 1);
+			}
+
+			/**
+			 * The default manager casts cinfo->mem to its own private struct,
+			 * so it must be swapped in while one of its methods runs. The scope
+			 * also restores the arena if the call exits with an error.
+			 */
+			class BaseManagerScope
+			{
+			private:
+				j_common_ptr cinfo_;
+				struct jpeg_memory_mgr* arena_;
+
+			public:
+				BaseManagerScope(j_common_ptr cinfo) :
+					cinfo_(cinfo),
+					arena_(cinfo->mem)
+				{
+					cinfo_->mem = getManager(cinfo)->base;
+				}
+
+				~BaseManagerScope()
+				{
+					cinfo_->mem = arena_;
+				}
+
+				// Disallow copying
+				BaseManagerScope(const BaseManagerScope& other) = delete;
+
+				BaseManagerScope& operator=(const BaseManagerScope& other) = delete;
+			};
+
+			static ArenaBlock* newArenaBlock(j_common_ptr cinfo, size_t capacity)
+			{
+				uint8_t* memory = static_cast<uint8_t*>(
+					malloc(sizeof(ArenaBlock) + capacity + kArenaRowAlignment));
+				if (!memory)
+				{
+					ERREXIT1(cinfo, JERR_OUT_OF_MEMORY, 0);
+				}
+
+				ArenaBlock* block = reinterpret_cast<ArenaBlock*>(memory);
+				uintptr_t data = reinterpret_cast<uintptr_t>(memory + sizeof(ArenaBlock));
+				block->next = nullptr;
+				block->data = reinterpret_cast<uint8_t*>(
+					alignSize(data, kArenaRowAlignment));
+				block->capacity = capacity;
+				block->used = 0;
+				return block;
+			}
+
+			static void* arenaAllocate(j_common_ptr cinfo, size_t size, size_t alignment)
+			{
+				if (size > kMaxArenaAllocation)
+				{
+					ERREXIT1(cinfo, JERR_OUT_OF_MEMORY, 1);
+				}
+
+				ArenaMemoryManager* mem = getManager(cinfo);
+				size = alignSize(std::max<size_t>(size, 1), kArenaAlignment);
+
+				// Blocks kept from previous images are tried in order before
+				// a new one is allocated.
+				ArenaBlock* last = nullptr;
+				for (ArenaBlock* block = mem->current; block; block = block->next)
+				{
+					size_t offset = alignSize(block->used, alignment);
+					if (offset + size <= block->capacity)
+					{
+						block->used = offset + size;
+						mem->current = block;
+						mem->address_bits |= reinterpret_cast<uintptr_t>(block->data + offset);
+						return block->data + offset;
+					}
+
+					last = block;
+				}
+
+				ArenaBlock* block = newArenaBlock(
+					cinfo, std::max(size, mem->next_block_size));
+				mem->next_block_size = std::min(
+					mem->next_block_size * 2, kMaxArenaBlockSize);
+				if (last)
+				{
+					last->next = block;
+				}
+				else
+				{
+					mem->blocks = block;
+				}
+
+				block->used = size;
+				mem->current = block;
+				mem->address_bits |= reinterpret_cast<uintptr_t>(block->data);
+				return block->data;
+			}
+
+			/**
+			 * Rewinds the arena, giving back the blocks beyond the retained
+			 * size.
+			 */
+			static void resetArena(ArenaMemoryManager* mem)
+			{
+				if (mem->address_bits != 0)
+				{
+					arena_address_bits.fetch_or(mem->address_bits, std::memory_order_relaxed);
+					mem->address_bits = 0;
+				}
+
+				size_t retained = 0;
+				ArenaBlock** link = &mem->blocks;
+				while (*link)
+				{
+					ArenaBlock* block = *link;
+					if (retained + block->capacity > kMaxRetainedArenaSize)
+					{
+						*link = block->next;
+						free(block);
+						continue;
+					}
+
+					retained += block->capacity;
+					block->used = 0;
+					link = &block->next;
+				}
+
+				mem->current = mem->blocks;
+				mem->virtual_bytes = 0;
+				mem->virt_sarray_list = nullptr;
+				mem->virt_barray_list = nullptr;
+			}
+
+			static void freeArena(ArenaMemoryManager* mem)
+			{
+				while (mem->blocks)
+				{
+					ArenaBlock* next = mem->blocks->next;
+					free(mem->blocks);
+					mem->blocks = next;
+				}
+
+				mem->current = nullptr;
+			}
+
+			static void* arenaAllocSmall(j_common_ptr cinfo, int pool_id, size_t sizeofobject)
+			{
+				if (pool_id != JPOOL_IMAGE)
+				{
+					BaseManagerScope scope(cinfo);
+					return (*cinfo->mem->alloc_small)(cinfo, pool_id, sizeofobject);
+				}
+
+				return arenaAllocate(cinfo, sizeofobject, kArenaAlignment);
+			}
+
+			static void* arenaAllocLarge(j_common_ptr cinfo, int pool_id, size_t sizeofobject)
+			{
+				if (pool_id != JPOOL_IMAGE)
+				{
+					BaseManagerScope scope(cinfo);
+					return (*cinfo->mem->alloc_large)(cinfo, pool_id, sizeofobject);
+				}
+
+				return arenaAllocate(cinfo, sizeofobject, kArenaRowAlignment);
+			}
+
+			/**
+			 * Allocates row pointers followed by a contiguous buffer of rows,
+			 * each row aligned to a cache line.
+			 */
+			template <typename Row>
+			static Row* allocateRows(
+				j_common_ptr cinfo,
+				size_t row_size,
+				JDIMENSION numrows)
+			{
+				size_t stride = alignSize(row_size, kArenaRowAlignment);
+				if (numrows > 0 && stride > kMaxArenaAllocation / numrows)
+				{
+					ERREXIT(cinfo, JERR_WIDTH_OVERFLOW);
+				}
+
+				Row* rows = static_cast<Row*>(arenaAllocate(
+					cinfo, numrows * sizeof(Row), kArenaAlignment));
+				uint8_t* buffer = static_cast<uint8_t*>(arenaAllocate(
+					cinfo, stride * numrows, kArenaRowAlignment));
+				for (JDIMENSION i = 0; i < numrows; ++i)
+				{
+					rows[i] = reinterpret_cast<Row>(buffer + i * stride);
+				}
+
+				return rows;
+			}
+
+			static JSAMPARRAY arenaAllocSarray(
+				j_common_ptr cinfo,
+				int pool_id,
+				JDIMENSION samplesperrow,
+				JDIMENSION numrows)
+			{
+				if (pool_id != JPOOL_IMAGE)
+				{
+					BaseManagerScope scope(cinfo);
+					return (*cinfo->mem->alloc_sarray)(cinfo, pool_id, samplesperrow, numrows);
+				}
+
+				return allocateRows<JSAMPROW>(
+					cinfo, samplesperrow * sizeof(JSAMPLE), numrows);
+			}
+
+			static JBLOCKARRAY arenaAllocBarray(
+				j_common_ptr cinfo,
+				int pool_id,
+				JDIMENSION blocksperrow,
+				JDIMENSION numrows)
+			{
+				if (pool_id != JPOOL_IMAGE)
+				{
+					BaseManagerScope scope(cinfo);
+					return (*cinfo->mem->alloc_barray)(cinfo, pool_id, blocksperrow, numrows);
+				}
+
+				return allocateRows<JBLOCKROW>(
+					cinfo, blocksperrow * sizeof(JBLOCK), numrows);
+			}
+
+			static jvirt_sarray_ptr arenaRequestVirtSarray(
+				j_common_ptr cinfo,
+				int pool_id,
+				boolean pre_zero,
+				JDIMENSION samplesperrow,
+				JDIMENSION numrows,
+				JDIMENSION maxaccess)
+			{
+				if (pool_id != JPOOL_IMAGE)
+				{
+					ERREXIT1(cinfo, JERR_BAD_POOL_ID, pool_id);
+				}
+
+				ArenaMemoryManager* mem = getManager(cinfo);
+				jvirt_sarray_ptr result = static_cast<jvirt_sarray_ptr>(
+					arenaAllocate(cinfo, sizeof(struct jvirt_sarray_control), kArenaAlignment));
+				result->mem_buffer = nullptr;
+				result->rows_in_array = numrows;
+				result->samplesperrow = samplesperrow;
+				result->maxaccess = maxaccess;
+				result->pre_zero = pre_zero;
+				result->realized = FALSE;
+				result->next = mem->virt_sarray_list;
+				mem->virt_sarray_list = result;
+				mem->virtual_bytes +=
+					alignSize(samplesperrow * sizeof(JSAMPLE), kArenaRowAlignment) * numrows;
+				return result;
+			}
+
+			static jvirt_barray_ptr arenaRequestVirtBarray(
+				j_common_ptr cinfo,
+				int pool_id,
+				boolean pre_zero,
+				JDIMENSION blocksperrow,
+				JDIMENSION numrows,
+				JDIMENSION maxaccess)
+			{
+				if (pool_id != JPOOL_IMAGE)
+				{
+					ERREXIT1(cinfo, JERR_BAD_POOL_ID, pool_id);
+				}
+
+				ArenaMemoryManager* mem = getManager(cinfo);
+				jvirt_barray_ptr result = static_cast<jvirt_barray_ptr>(
+					arenaAllocate(cinfo, sizeof(struct jvirt_barray_control), kArenaAlignment));
+				result->mem_buffer = nullptr;
+				result->rows_in_array = numrows;
+				result->blocksperrow = blocksperrow;
+				result->maxaccess = maxaccess;
+				result->pre_zero = pre_zero;
+				result->realized = FALSE;
+				result->next = mem->virt_barray_list;
+				mem->virt_barray_list = result;
+				mem->virtual_bytes +=
+					alignSize(blocksperrow * sizeof(JBLOCK), kArenaRowAlignment) * numrows;
+				return result;
+			}
+
+			/**
+			 * Virtual arrays are always realized in memory, there is no
+			 * backing store to fall back to when they exceed the limit.
+			 */
+			static void arenaRealizeVirtArrays(j_common_ptr cinfo)
+			{
+				ArenaMemoryManager* mem = getManager(cinfo);
+				if (mem->pub.max_memory_to_use > 0 &&
+					mem->virtual_bytes > static_cast<size_t>(mem->pub.max_memory_to_use))
+				{
+					ERREXIT(cinfo, JERR_NO_BACKING_STORE);
+				}
+
+				for (jvirt_sarray_ptr sptr = mem->virt_sarray_list; sptr; sptr = sptr->next)
+				{
+					if (sptr->realized)
+					{
+						continue;
+					}
+
+					sptr->mem_buffer = allocateRows<JSAMPROW>(
+						cinfo, sptr->samplesperrow * sizeof(JSAMPLE), sptr->rows_in_array);
+					if (sptr->pre_zero)
+					{
+						for (JDIMENSION i = 0; i < sptr->rows_in_array; ++i)
+						{
+							memset(sptr->mem_buffer[i], 0, sptr->samplesperrow * sizeof(JSAMPLE));
+						}
+					}
+
+					sptr->realized = TRUE;
+				}
+
+				for (jvirt_barray_ptr bptr = mem->virt_barray_list; bptr; bptr = bptr->next)
+				{
+					if (bptr->realized)
+					{
+						continue;
+					}
+
+					bptr->mem_buffer = allocateRows<JBLOCKROW>(
+						cinfo, bptr->blocksperrow * sizeof(JBLOCK), bptr->rows_in_array);
+					if (bptr->pre_zero)
+					{
+						for (JDIMENSION i = 0; i < bptr->rows_in_array; ++i)
+						{
+							memset(bptr->mem_buffer[i], 0, bptr->blocksperrow * sizeof(JBLOCK));
+						}
+					}
+
+					bptr->realized = TRUE;
+				}
+			}
+
+			static JSAMPARRAY arenaAccessVirtSarray(
+				j_common_ptr cinfo,
+				jvirt_sarray_ptr ptr,
+				JDIMENSION start_row,
+				JDIMENSION num_rows,
+				boolean /* writable */)
+			{
+				JDIMENSION end_row = start_row + num_rows;
+				if (end_row > ptr->rows_in_array || end_row < start_row ||
+					num_rows > ptr->maxaccess || !ptr->realized)
+				{
+					ERREXIT(cinfo, JERR_BAD_VIRTUAL_ACCESS);
+				}
+
+				return ptr->mem_buffer + start_row;
+			}
+
+			static JBLOCKARRAY arenaAccessVirtBarray(
+				j_common_ptr cinfo,
+				jvirt_barray_ptr ptr,
+				JDIMENSION start_row,
+				JDIMENSION num_rows,
+				boolean /* writable */)
+			{
+				JDIMENSION end_row = start_row + num_rows;
+				if (end_row > ptr->rows_in_array || end_row < start_row ||
+					num_rows > ptr->maxaccess || !ptr->realized)
+				{
+					ERREXIT(cinfo, JERR_BAD_VIRTUAL_ACCESS);
+				}
+
+				return ptr->mem_buffer + start_row;
+			}
+
+			static void arenaFreePool(j_common_ptr cinfo, int pool_id)
+			{
+				if (pool_id == JPOOL_IMAGE)
+				{
+					resetArena(getManager(cinfo));
+				}
+
+				BaseManagerScope scope(cinfo);
+				(*cinfo->mem->free_pool)(cinfo, pool_id);
+			}
+
+			static void arenaSelfDestruct(j_common_ptr cinfo)
+			{
+				// The manager itself lives in the permanent pool of the base
+				// manager and is gone once the base destructs.
+				ArenaMemoryManager* mem = getManager(cinfo);
+				struct jpeg_memory_mgr* base = mem->base;
+				resetArena(mem);
+				freeArena(mem);
+
+				cinfo->mem = base;
+				(*base->self_destruct)(cinfo);
+			}
+
+			void installArenaMemoryManager(j_common_ptr cinfo)
+			{
+				struct jpeg_memory_mgr* base = cinfo->mem;
+				ArenaMemoryManager* mem = static_cast<ArenaMemoryManager*>(
+					(*base->alloc_small)(cinfo, JPOOL_PERMANENT, sizeof(ArenaMemoryManager)));
+
+				mem->pub.alloc_small = arenaAllocSmall;
+				mem->pub.alloc_large = arenaAllocLarge;
+				mem->pub.alloc_sarray = arenaAllocSarray;
+				mem->pub.alloc_barray = arenaAllocBarray;
+				mem->pub.request_virt_sarray = arenaRequestVirtSarray;
+				mem->pub.request_virt_barray = arenaRequestVirtBarray;
+				mem->pub.realize_virt_arrays = arenaRealizeVirtArrays;
+				mem->pub.access_virt_sarray = arenaAccessVirtSarray;
+				mem->pub.access_virt_barray = arenaAccessVirtBarray;
+				mem->pub.free_pool = arenaFreePool;
+				mem->pub.self_destruct = arenaSelfDestruct;
+				mem->pub.max_memory_to_use = base->max_memory_to_use;
+				mem->pub.max_alloc_chunk = base->max_alloc_chunk;
+
+				mem->base = base;
+				mem->blocks = nullptr;
+				mem->current = nullptr;
+				mem->next_block_size = kMinArenaBlockSize;
+				mem->virtual_bytes = 0;
+				mem->virt_sarray_list = nullptr;
+				mem->virt_barray_list = nullptr;
+				mem->address_bits = 0;
+
+				cinfo->mem = &mem->pub;
+			}
+
+			size_t getArenaAlignment()
+			{
+				uintptr_t bits = arena_address_bits.load(std::memory_order_relaxed);
+				return (size_t)(bits & (~bits + 1));
+			}
+		}
+	}
+}
+
+#endif // HAS_LIBJPEGTURBO
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#ifndef _JPEG_MEMORY_MANAGER_H_
+#define _JPEG_MEMORY_MANAGER_H_
+
+#include <stdio.h>
+
+#include <jpeglib.h>
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace jpeg
+		{
+			/**
+			 * Replaces the memory manager of a freshly created compress or
+			 * decompress struct with one serving the image pool from an arena.
+			 *
+			 * <p> libjpeg allocates most of its memory in the image pool: rows,
+			 * coefficient buffers, virtual arrays and per-image state. With the
+			 * default manager each of these requests goes to malloc. The arena
+			 * bumps a pointer through a few large blocks of native memory
+			 * instead, and freeing the image pool, e.g. by jpeg_abort, only
+			 * rewinds it. Blocks are kept for the next image, so a struct reused
+			 * for many images stops allocating once it is warmed up.
+			 *
+			 * <p> Permanent pool requests still go to the original manager.
+			 * Virtual arrays are always kept in memory, within the limit set by
+			 * max_memory_to_use.
+			 */
+			void installArenaMemoryManager(j_common_ptr cinfo);
+
+			/**
+			 * Returns the largest power of two dividing every address handed
+			 * out by an arena since startup, 0 before the first image is done.
+			 * Addresses are published when the image pool is freed.
+			 */
+			size_t getArenaAlignment();
+		}
+	}
+}
+
+#endif // _JPEG_MEMORY_MANAGER_H_
@@ -0,0 +1,475 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifdef HAS_LIBJPEGTURBO
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+#include <string.h>
+
+#include "worker_pool.h"
+#include "jpeg_restart_bands.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace jpeg
+		{
+			/**
+			 * Smaller images decode faster than the bands are handed out.
+			 */
+			static const uint64_t kMinParallelDecodePixels = 4 * 1024 * 1024;
+
+			/**
+			 * Size of an 8x8 block in pixels.
+			 */
+			static const unsigned int kBlockSize = 8;
+
+			static const uint8_t kMarkerPrefix = 0xFF;
+			static const uint8_t kStuffedZero = 0x00;
+			static const uint8_t kSOF0 = 0xC0;
+			static const uint8_t kSOF1 = 0xC1;
+			static const uint8_t kSOF15 = 0xCF;
+			static const uint8_t kDHT = 0xC4;
+			static const uint8_t kJPG = 0xC8;
+			static const uint8_t kDAC = 0xCC;
+			static const uint8_t kRST0 = 0xD0;
+			static const uint8_t kRST7 = 0xD7;
+			static const uint8_t kSOI = 0xD8;
+			static const uint8_t kEOI = 0xD9;
+			static const uint8_t kSOS = 0xDA;
+			static const uint8_t kDRI = 0xDD;
+
+			/**
+			 * 0 stands for all threads of the worker pool.
+			 */
+			static std::atomic<unsigned int> max_decode_threads(0);
+
+			/**
+			 * Tasks of a single runInParallel call, claimed one at a time by
+			 * the calling thread and the pool threads helping it.
+			 *
+			 * <p> Helpers may be scheduled after all tasks are done, so the
+			 * state is shared with them, but they only touch the task after
+			 * claiming an index, while the caller still waits.
+			 */
+			struct ParallelTasks
+			{
+				const std::function<void(size_t)>& task;
+				const size_t count;
+				std::atomic<size_t> next;
+				std::vector<std::exception_ptr> errors;
+				std::mutex mutex;
+				std::condition_variable finished;
+				size_t done;
+
+				ParallelTasks(const std::function<void(size_t)>& task, size_t count)
+					: task(task), count(count), next(0), errors(count), done(0)
+				{
+				}
+			};
+
+			static void runClaimedTasks(ParallelTasks& tasks)
+			{
+				size_t index;
+				while ((index = tasks.next++) < tasks.count)
+				{
+					try
+					{
+						tasks.task(index);
+					}
+					catch (...)
+					{
+						tasks.errors[index] = std::current_exception();
+					}
+
+					std::lock_guard<std::mutex> lock(tasks.mutex);
+					if (++tasks.done == tasks.count)
+					{
+						tasks.finished.notify_all();
+					}
+				}
+			}
+
+			/**
+			 * Frame and scan parameters needed to locate the MCU rows.
+			 */
+			struct FrameInfo
+			{
+				size_t sof_offset;
+				size_t scan_offset;
+				uint32_t width;
+				uint32_t height;
+				unsigned int components;
+				unsigned int max_h_samp_factor;
+				unsigned int max_v_samp_factor;
+				unsigned int restart_interval;
+			};
+
+			/**
+			 * Entropy coded segment between two restart markers.
+			 */
+			struct Segment
+			{
+				size_t begin;
+				size_t end;
+			};
+
+			static unsigned int readUInt16(const uint8_t* data)
+			{
+				return (data[0] << 8) | data[1];
+			}
+
+			static void writeUInt16(uint8_t* data, unsigned int value)
+			{
+				data[0] = (uint8_t)(value >> 8);
+				data[1] = (uint8_t)value;
+			}
+
+			/**
+			 * Walks the markers up to the first scan.
+			 *
+			 * @return true if the image has a single baseline scan covering
+			 * all components and a restart interval
+			 */
+			static bool readFrameInfo(const uint8_t* data, size_t length, FrameInfo& frame)
+			{
+				if (length < 4 || data[0] != kMarkerPrefix || data[1] != kSOI)
+				{
+					return false;
+				}
+
+				bool has_frame = false;
+				frame.restart_interval = 0;
+				size_t offset = 2;
+				while (offset + 4 <= length)
+				{
+					if (data[offset] != kMarkerPrefix)
+					{
+						return false;
+					}
+
+					const uint8_t marker = data[offset + 1];
+					if (marker == kMarkerPrefix)
+					{
+						// Fill byte.
+						++offset;
+						continue;
+					}
+
+					const size_t segment_length = readUInt16(data + offset + 2);
+					const uint8_t* segment = data + offset + 4;
+					if (segment_length < 2 || offset + 2 + segment_length > length)
+					{
+						return false;
+					}
+
+					if (marker == kSOF0 || marker == kSOF1)
+					{
+						if (has_frame || segment_length < 8)
+						{
+							return false;
+						}
+
+						frame.sof_offset = offset;
+						frame.height = readUInt16(segment + 1);
+						frame.width = readUInt16(segment + 3);
+						frame.components = segment[5];
+						if (segment[0] != 8 ||
+							frame.components == 0 ||
+							segment_length < 8 + 3 * frame.components)
+						{
+							return false;
+						}
+
+						frame.max_h_samp_factor = 1;
+						frame.max_v_samp_factor = 1;
+						for (unsigned int i = 0; i < frame.components; ++i)
+						{
+							const uint8_t sampling = segment[6 + 3 * i + 1];
+							frame.max_h_samp_factor = std::max<unsigned int>(frame.max_h_samp_factor, sampling >> 4);
+							frame.max_v_samp_factor = std::max<unsigned int>(frame.max_v_samp_factor, sampling & 0x0F);
+						}
+
+						has_frame = true;
+					}
+					else if (marker > kSOF1 && marker <= kSOF15 &&
+						marker != kDHT && marker != kJPG && marker != kDAC)
+					{
+						// Progressive, lossless or arithmetic coded.
+						return false;
+					}
+					else if (marker == kDRI)
+					{
+						if (segment_length < 4)
+						{
+							return false;
+						}
+
+						frame.restart_interval = readUInt16(segment);
+					}
+					else if (marker == kSOS)
+					{
+						frame.scan_offset = offset + 2 + segment_length;
+						return has_frame &&
+							frame.restart_interval > 0 &&
+							frame.width > 0 &&
+							frame.height > 0 &&
+							segment[0] == frame.components;
+					}
+					else if ((marker >= kRST0 && marker <= kRST7) || marker == kSOI || marker == kEOI)
+					{
+						return false;
+					}
+
+					offset += 2 + segment_length;
+				}
+
+				return false;
+			}
+
+			/**
+			 * Splits the entropy coded data of the scan at restart markers.
+			 *
+			 * @return true if the scan is terminated by EOI
+			 */
+			static bool readSegments(
+				const uint8_t* data,
+				size_t length,
+				size_t offset,
+				std::vector<Segment>& segments)
+			{
+				Segment segment { offset, offset };
+				while (offset < length)
+				{
+					const uint8_t* prefix = (const uint8_t*)memchr(
+						data + offset,
+						kMarkerPrefix,
+						length - offset);
+					if (prefix == nullptr)
+					{
+						return false;
+					}
+
+					const size_t prefix_offset = prefix - data;
+					size_t marker_offset = prefix_offset + 1;
+					while (marker_offset < length && data[marker_offset] == kMarkerPrefix)
+					{
+						++marker_offset;
+					}
+
+					if (marker_offset >= length)
+					{
+						return false;
+					}
+
+					const uint8_t marker = data[marker_offset];
+					offset = marker_offset + 1;
+					if (marker == kStuffedZero)
+					{
+						continue;
+					}
+
+					segment.end = prefix_offset;
+					segments.push_back(segment);
+					if (marker < kRST0 || marker > kRST7)
+					{
+						return marker == kEOI;
+					}
+
+					// Markers have to come in order for the decoder to accept them.
+					if (marker != kRST0 + (segments.size() - 1) % 8)
+					{
+						return false;
+					}
+
+					segment.begin = offset;
+				}
+
+				return false;
+			}
+
+			bool splitAtRestartMarkers(
+				const uint8_t* data,
+				size_t length,
+				unsigned int max_bands,
+				std::vector<RestartBand>& bands)
+			{
+				bands.clear();
+				if (data == nullptr || max_bands < 2)
+				{
+					return false;
+				}
+
+				FrameInfo frame;
+				if (!readFrameInfo(data, length, frame) ||
+					(uint64_t)frame.width * frame.height < kMinParallelDecodePixels)
+				{
+					return false;
+				}
+
+				// A scan of a single component is not interleaved, its MCU is one block.
+				const bool interleaved = frame.components > 1;
+				const unsigned int mcu_width = interleaved ? kBlockSize * frame.max_h_samp_factor : kBlockSize;
+				const unsigned int mcu_height = interleaved ? kBlockSize * frame.max_v_samp_factor : kBlockSize;
+				const uint64_t mcus_per_row = (frame.width + mcu_width - 1) / mcu_width;
+				const uint64_t mcu_rows = (frame.height + mcu_height - 1) / mcu_height;
+				const uint64_t intervals =
+					(mcus_per_row * mcu_rows + frame.restart_interval - 1) / frame.restart_interval;
+
+				std::vector<Segment> segments;
+				if (!readSegments(data, length, frame.scan_offset, segments) ||
+					segments.size() != intervals)
+				{
+					return false;
+				}
+
+				// Bands can only start where a restart interval starts a new MCU row.
+				uint64_t a = frame.restart_interval;
+				uint64_t b = mcus_per_row;
+				while (b != 0)
+				{
+					const uint64_t r = a % b;
+					a = b;
+					b = r;
+				}
+
+				const uint64_t row_step = frame.restart_interval / a;
+
+				// Vertically subsampled chroma is upsampled from the rows around
+				// it, the nearest restart interval starting a row on either
+				// side of the band provides them.
+				const uint64_t context_rows =
+					(interleaved && frame.max_v_samp_factor > 1) ? row_step : 0;
+				std::vector<uint64_t> first_rows;
+				for (unsigned int i = 0; i < max_bands; ++i)
+				{
+					const uint64_t target = mcu_rows * i / max_bands;
+					const uint64_t row = (target + row_step - 1) / row_step * row_step;
+					if (row < mcu_rows && (first_rows.empty() || row > first_rows.back()))
+					{
+						first_rows.push_back(row);
+					}
+				}
+
+				if (first_rows.size() < 2)
+				{
+					return false;
+				}
+
+				bands.resize(first_rows.size());
+				for (size_t i = 0; i < first_rows.size(); ++i)
+				{
+					const uint64_t end_row = i + 1 < first_rows.size() ? first_rows[i + 1] : mcu_rows;
+					const uint64_t data_first_row = first_rows[i] - std::min(first_rows[i], context_rows);
+					const uint64_t data_end_row = std::min(end_row + context_rows, mcu_rows);
+					const uint32_t first_row = (uint32_t)(data_first_row * mcu_height);
+					const uint32_t height = (uint32_t)std::min<uint64_t>(
+						data_end_row * mcu_height,
+						frame.height) - first_row;
+					const size_t first_segment = (size_t)(data_first_row * mcus_per_row / frame.restart_interval);
+					const size_t end_segment = data_end_row < mcu_rows ?
+						(size_t)(data_end_row * mcus_per_row / frame.restart_interval) :
+						segments.size();
+
+					size_t band_length = frame.scan_offset + 2;
+					for (size_t s = first_segment; s < end_segment; ++s)
+					{
+						band_length += segments[s].end - segments[s].begin + 2;
+					}
+
+					RestartBand& band = bands[i];
+					band.first_row = (uint32_t)(first_rows[i] * mcu_height);
+					band.height = (uint32_t)std::min<uint64_t>(
+						end_row * mcu_height,
+						frame.height) - band.first_row;
+					band.context_rows = band.first_row - first_row;
+					band.data.reserve(band_length);
+					band.data.assign(data, data + frame.scan_offset);
+					writeUInt16(band.data.data() + frame.sof_offset + 5, height);
+					for (size_t s = first_segment; s < end_segment; ++s)
+					{
+						if (s > first_segment)
+						{
+							band.data.push_back(kMarkerPrefix);
+							band.data.push_back((uint8_t)(kRST0 + (s - first_segment - 1) % 8));
+						}
+
+						band.data.insert(
+							band.data.end(),
+							data + segments[s].begin,
+							data + segments[s].end);
+					}
+
+					band.data.push_back(kMarkerPrefix);
+					band.data.push_back(kEOI);
+				}
+
+				return true;
+			}
+
+			void setMaxDecodeThreads(unsigned int threads)
+			{
+				max_decode_threads = threads;
+			}
+
+			unsigned int getDecodeThreadCount()
+			{
+				const unsigned int threads = max_decode_threads;
+				if (threads > 0)
+				{
+					return threads;
+				}
+
+				return WorkerPool::getInstance().getThreadCount();
+			}
+
+			void runInParallel(size_t count, const std::function<void(size_t)>& task)
+			{
+				if (count == 0)
+				{
+					return;
+				}
+
+				std::shared_ptr<ParallelTasks> tasks = std::make_shared<ParallelTasks>(task, count);
+
+				// Pool threads only help, the calling thread runs whatever they
+				// have not claimed, so a busy pool cannot stall the call.
+				WorkerPool& pool = WorkerPool::getInstance();
+				const size_t helpers = std::min<size_t>(count, pool.getThreadCount()) - 1;
+				for (size_t i = 0; i < helpers; ++i)
+				{
+					pool.submit([tasks]() { runClaimedTasks(*tasks); });
+				}
+
+				runClaimedTasks(*tasks);
+				{
+					std::unique_lock<std::mutex> lock(tasks->mutex);
+					tasks->finished.wait(lock, [&tasks] { return tasks->done == tasks->count; });
+				}
+
+				for (const std::exception_ptr& error : tasks->errors)
+				{
+					if (error)
+					{
+						std::rethrow_exception(error);
+					}
+				}
+			}
+		}
+	}
+}
+
+#endif // HAS_LIBJPEGTURBO
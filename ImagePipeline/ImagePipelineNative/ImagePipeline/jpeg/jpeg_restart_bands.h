@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#ifndef _JPEG_RESTART_BANDS_H_
+#define _JPEG_RESTART_BANDS_H_
+
+#include <functional>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace jpeg
+		{
+			/**
+			 * Horizontal band of a jpeg, encoded as a standalone image.
+			 */
+			struct RestartBand
+			{
+				/**
+				 * Headers of the source image with the height of the band,
+				 * followed by the entropy coded segments of the band and EOI.
+				 */
+				std::vector<uint8_t> data;
+
+				/**
+				 * First row of the band in the source image, always on an
+				 * MCU row boundary.
+				 */
+				uint32_t first_row;
+
+				/**
+				 * Number of rows the band covers in the source image.
+				 */
+				uint32_t height;
+
+				/**
+				 * Rows above first_row held in data only as context for the
+				 * upsampling of the first rows, not part of the band.
+				 */
+				uint32_t context_rows;
+			};
+
+			/**
+			 * Splits a baseline jpeg at restart markers into at most max_bands
+			 * bands that decode independently of each other.
+			 *
+			 * <p> The entropy decoder is reset at every restart marker, so a
+			 * band starting at a marker does not depend on the data before it.
+			 * Bands only start at markers falling on an MCU row boundary. Each
+			 * band gets the headers of the source image, with the frame height
+			 * of the band, and its restart markers renumbered from RST0.
+			 *
+			 * <p> Fancy upsampling of vertically subsampled chroma reads the
+			 * chroma rows next to the current one. Bands of such images hold
+			 * a few MCU rows above and below as context, so that their rows
+			 * decode exactly as they do in the full image.
+			 *
+			 * <p> Progressive, arithmetic coded and multi-scan images, images
+			 * without restart markers and images too small to be worth it are
+			 * not split.
+			 *
+			 * @param data pointer to encoded jpeg
+			 * @param length number of encoded bytes
+			 * @param max_bands upper limit of the number of bands
+			 * @param bands receives the bands
+			 * @return true if the image was split into at least two bands
+			 */
+			bool splitAtRestartMarkers(
+				const uint8_t* data,
+				size_t length,
+				unsigned int max_bands,
+				std::vector<RestartBand>& bands);
+
+			/**
+			 * Sets the maximum number of threads decoding a single image.
+			 * 1 disables parallel decoding, 0 uses all threads of the worker
+			 * pool.
+			 */
+			void setMaxDecodeThreads(unsigned int threads);
+
+			/**
+			 * Returns the number of threads a single image may be decoded on.
+			 */
+			unsigned int getDecodeThreadCount();
+
+			/**
+			 * Runs task for indices 0 to count - 1 on the calling thread and
+			 * the threads of the worker pool.
+			 *
+			 * <p> Returns once all tasks are done. If any task throws, the
+			 * first exception is rethrown.
+			 */
+			void runInParallel(size_t count, const std::function<void(size_t)>& task);
+		}
+	}
+}
+
+#endif // _JPEG_RESTART_BANDS_H_
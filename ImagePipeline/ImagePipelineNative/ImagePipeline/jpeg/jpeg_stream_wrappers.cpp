@@ -28,25 +28,21 @@ namespace facebook
 			 */
 			static void isInitSource(j_decompress_ptr dinfo)
 			{
-				try
-				{
-					JpegInputStreamWrapper* src = (JpegInputStreamWrapper*)dinfo->src;
-					src->start = true;
-					src->buffer = (JOCTET*)(*dinfo->mem->alloc_small)(
-						(j_common_ptr)dinfo,
-						JPOOL_PERMANENT,
-						STREAM_BUFFER_SIZE * sizeof(JOCTET));
+				JpegInputStreamWrapper* src = (JpegInputStreamWrapper*)dinfo->src;
+				src->start = true;
 
-					if (src->buffer == nullptr)
-					{
-						jpegSafeThrow(
-							(j_common_ptr)dinfo,
-							"Failed to allocate memory for read buffer");
-					}
-				}
-				catch (int)
+				// Image pool, so that decompress structs reused for many images
+				// do not accumulate read buffers.
+				src->buffer = (JOCTET*)(*dinfo->mem->alloc_small)(
+					(j_common_ptr)dinfo,
+					JPOOL_IMAGE,
+					STREAM_BUFFER_SIZE * sizeof(JOCTET));
+
+				if (src->buffer == nullptr)
 				{
-					jpegCleanup((JpegErrorHandler*)dinfo->err);
+					jpegSafeThrow(
+						(j_common_ptr)dinfo,
+						"Failed to allocate memory for read buffer");
 				}
 			}
 
@@ -55,38 +51,30 @@ namespace facebook
 			 */
 			static boolean isFillInputBuffer(j_decompress_ptr dinfo)
 			{
-				try
-				{
-					JpegInputStreamWrapper* src = (JpegInputStreamWrapper*)dinfo->src;
-					ULONG nbytes = 0;
-					src->inputStream->Read(src->readBuffer, STREAM_BUFFER_SIZE, &nbytes);
+				JpegInputStreamWrapper* src = (JpegInputStreamWrapper*)dinfo->src;
+				ULONG nbytes = 0;
+				src->inputStream->Read(src->readBuffer, STREAM_BUFFER_SIZE, &nbytes);
 
-					if (nbytes <= 0)
-					{
-						if (src->start)
-						{
-							ERREXIT(dinfo, JERR_INPUT_EMPTY);
-						}
-
-						src->buffer[0] = (JOCTET)0xFF;
-						src->buffer[1] = (JOCTET)JPEG_EOI;
-						nbytes = 2;
-					}
-					else
+				if (nbytes <= 0)
+				{
+					if (src->start)
 					{
-						memcpy(src->buffer, src->readBuffer, STREAM_BUFFER_SIZE);
+						ERREXIT(dinfo, JERR_INPUT_EMPTY);
 					}
 
-					src->public_fields.next_input_byte = src->buffer;
-					src->public_fields.bytes_in_buffer = nbytes;
-					src->start = false;
-					return true;
+					src->buffer[0] = (JOCTET)0xFF;
+					src->buffer[1] = (JOCTET)JPEG_EOI;
+					nbytes = 2;
 				}
-				catch (int)
+				else
 				{
-					jpegCleanup((JpegErrorHandler*)dinfo->err);
-					return false;
+					memcpy(src->buffer, src->readBuffer, STREAM_BUFFER_SIZE);
 				}
+
+				src->public_fields.next_input_byte = src->buffer;
+				src->public_fields.bytes_in_buffer = nbytes;
+				src->start = false;
+				return true;
 			}
 
 			/*
@@ -95,34 +83,27 @@ namespace facebook
 			 */
 			static void isSkipInputData(j_decompress_ptr dinfo, long num_bytes)
 			{
-				try
+				JpegInputStreamWrapper* src = (JpegInputStreamWrapper*)dinfo->src;
+				if (num_bytes > 0)
 				{
-					JpegInputStreamWrapper* src = (JpegInputStreamWrapper*)dinfo->src;
-					if (num_bytes > 0)
+					if (src->public_fields.bytes_in_buffer > (unsigned long)num_bytes)
 					{
-						if (src->public_fields.bytes_in_buffer > (unsigned long)num_bytes)
-						{
-							src->public_fields.next_input_byte += (size_t)num_bytes;
-							src->public_fields.bytes_in_buffer -= (size_t)num_bytes;
-						}
-						else
-						{
-							long to_skip = num_bytes - (long)src->public_fields.bytes_in_buffer;
-							LARGE_INTEGER li_to_skip;
-							li_to_skip.QuadPart = to_skip;
-							ULARGE_INTEGER new_postion;
-
-							// We could at least try to skip appropriate amout of bytes...
-							// TODO: 3752653
-							src->inputStream->Seek(li_to_skip, STREAM_SEEK_CUR, &new_postion);
-							src->public_fields.next_input_byte = nullptr;
-							src->public_fields.bytes_in_buffer = 0;
-						}
+						src->public_fields.next_input_byte += (size_t)num_bytes;
+						src->public_fields.bytes_in_buffer -= (size_t)num_bytes;
+					}
+					else
+					{
+						long to_skip = num_bytes - (long)src->public_fields.bytes_in_buffer;
+						LARGE_INTEGER li_to_skip;
+						li_to_skip.QuadPart = to_skip;
+						ULARGE_INTEGER new_postion;
+
+						// We could at least try to skip appropriate amout of bytes...
+						// TODO: 3752653
+						src->inputStream->Seek(li_to_skip, STREAM_SEEK_CUR, &new_postion);
+						src->public_fields.next_input_byte = nullptr;
+						src->public_fields.bytes_in_buffer = 0;
 					}
-				}
-				catch (int)
-				{
-					jpegCleanup((JpegErrorHandler*)dinfo->err);
 				}
 			}
 
@@ -152,30 +133,23 @@ namespace facebook
 			 */
 			static void osInitDestination(j_compress_ptr cinfo) 
 			{
-				try
-				{
-					JpegOutputStreamWrapper* dest = (JpegOutputStreamWrapper*)cinfo->dest;
-
-					// Allocate the output buffer --- it will be released when done with image
-					dest->buffer = (JOCTET *)(*cinfo->mem->alloc_small)(
-						(j_common_ptr)cinfo,
-						JPOOL_IMAGE,
-						STREAM_BUFFER_SIZE * sizeof(JOCTET));
+				JpegOutputStreamWrapper* dest = (JpegOutputStreamWrapper*)cinfo->dest;
 
-					if (dest->buffer == NULL)
-					{
-						jpegSafeThrow(
-							(j_common_ptr)cinfo,
-							"Failed to allcoate memory for byte buffer.");
-					}
+				// Allocate the output buffer --- it will be released when done with image
+				dest->buffer = (JOCTET *)(*cinfo->mem->alloc_small)(
+					(j_common_ptr)cinfo,
+					JPOOL_IMAGE,
+					STREAM_BUFFER_SIZE * sizeof(JOCTET));
 
-					dest->public_fields.next_output_byte = dest->buffer;
-					dest->public_fields.free_in_buffer = STREAM_BUFFER_SIZE;
-				}
-				catch (int)
+				if (dest->buffer == NULL)
 				{
-					jpegCleanup((JpegErrorHandler*)cinfo->err);
+					jpegSafeThrow(
+						(j_common_ptr)cinfo,
+						"Failed to allcoate memory for byte buffer.");
 				}
+
+				dest->public_fields.next_output_byte = dest->buffer;
+				dest->public_fields.free_in_buffer = STREAM_BUFFER_SIZE;
 			}
 
 			/**
@@ -183,21 +157,13 @@ namespace facebook
 			 */
 			static boolean osEmptyOutputBuffer(j_compress_ptr cinfo) 
 			{
-				try
-				{
-					JpegOutputStreamWrapper* dest = (JpegOutputStreamWrapper*)cinfo->dest;
-					memcpy(dest->writeBuffer, dest->buffer, STREAM_BUFFER_SIZE);
-					ULONG nbytes = 0;
-					dest->outputStream->Write(dest->writeBuffer, STREAM_BUFFER_SIZE, &nbytes);
-					dest->public_fields.next_output_byte = dest->buffer;
-					dest->public_fields.free_in_buffer = STREAM_BUFFER_SIZE;
-					return true;
-				}
-				catch (int)
-				{
-					jpegCleanup((JpegErrorHandler*)cinfo->err);
-					return false;
-				}
+				JpegOutputStreamWrapper* dest = (JpegOutputStreamWrapper*)cinfo->dest;
+				memcpy(dest->writeBuffer, dest->buffer, STREAM_BUFFER_SIZE);
+				ULONG nbytes = 0;
+				dest->outputStream->Write(dest->writeBuffer, STREAM_BUFFER_SIZE, &nbytes);
+				dest->public_fields.next_output_byte = dest->buffer;
+				dest->public_fields.free_in_buffer = STREAM_BUFFER_SIZE;
+				return true;
 			}
 
 			/**
@@ -206,21 +172,14 @@ namespace facebook
 			 */
 			static void osTermDestination(j_compress_ptr cinfo) 
 			{
-				try
-				{
-					JpegOutputStreamWrapper* dest = (JpegOutputStreamWrapper*)cinfo->dest;
-					size_t datacount = STREAM_BUFFER_SIZE - dest->public_fields.free_in_buffer;
+				JpegOutputStreamWrapper* dest = (JpegOutputStreamWrapper*)cinfo->dest;
+				size_t datacount = STREAM_BUFFER_SIZE - dest->public_fields.free_in_buffer;
 
-					if (datacount > 0)
-					{
-						memcpy(dest->writeBuffer, dest->buffer, datacount);
-						ULONG nbytes = 0;
-						dest->outputStream->Write(dest->writeBuffer, (ULONG)datacount, &nbytes);
-					}
-				}
-				catch (int)
+				if (datacount > 0)
 				{
-					jpegCleanup((JpegErrorHandler*)cinfo->err);
+					memcpy(dest->writeBuffer, dest->buffer, datacount);
+					ULONG nbytes = 0;
+					dest->outputStream->Write(dest->writeBuffer, (ULONG)datacount, &nbytes);
 				}
 			}
 
@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifdef HAS_LIBJPEGTURBO
+
+#include <exception>
+
+#include "worker_pool.h"
+#include "jpeg_codec.h"
+#include "jpeg_transcode_job.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace jpeg
+		{
+			TranscodeJob::TranscodeJob(
+				JOCTET* first_chunk,
+				size_t capacity,
+				OutputChunkAllocator allocate_chunk,
+				int64_t output_cookie,
+				std::function<void()> on_complete)
+				: on_complete_(std::move(on_complete)),
+				  status_(TranscodeJobStatus::PENDING),
+				  destination_(first_chunk, capacity, allocate_chunk, output_cookie)
+			{
+			}
+
+			void TranscodeJob::complete(TranscodeJobStatus status, std::string error)
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					if (isCompletedLocked())
+					{
+						return;
+					}
+
+					status_ = status;
+					error_ = std::move(error);
+				}
+
+				completed_.notify_all();
+				if (on_complete_)
+				{
+					on_complete_();
+				}
+			}
+
+			TranscodeJobStatus TranscodeJob::getStatus() const
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				return status_;
+			}
+
+			void TranscodeJob::wait() const
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				completed_.wait(lock, [this] { return isCompletedLocked(); });
+			}
+
+			std::string TranscodeJob::getError() const
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				return error_;
+			}
+
+			MemoryTranscodeJob::MemoryTranscodeJob(
+				const uint8_t* data,
+				size_t length,
+				JOCTET* first_chunk,
+				size_t capacity,
+				OutputChunkAllocator allocate_chunk,
+				int64_t output_cookie,
+				RotationType rotation_type,
+				const ScaleFactor& scale_factor,
+				const CropRegion& crop_region,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options,
+				std::function<void()> on_complete)
+				: TranscodeJob(
+					  first_chunk,
+					  capacity,
+					  allocate_chunk,
+					  output_cookie,
+					  std::move(on_complete)),
+				  data_(data),
+				  length_(length),
+				  rotation_type_(rotation_type),
+				  scale_factor_(scale_factor),
+				  crop_region_(crop_region),
+				  target_size_(target_size),
+				  encode_options_(encode_options)
+			{
+			}
+
+			void MemoryTranscodeJob::run()
+			{
+				try
+				{
+					transformJpeg(
+						data_,
+						length_,
+						destination_,
+						rotation_type_,
+						scale_factor_,
+						crop_region_,
+						target_size_,
+						encode_options_);
+				}
+				catch (const std::exception& e)
+				{
+					complete(TranscodeJobStatus::FAILED, e.what());
+					return;
+				}
+				catch (...)
+				{
+					complete(TranscodeJobStatus::FAILED, "unknown transcode error");
+					return;
+				}
+
+				complete(TranscodeJobStatus::SUCCEEDED, std::string());
+			}
+
+			StreamingTranscodeJob::StreamingTranscodeJob(
+				JOCTET* first_chunk,
+				size_t capacity,
+				OutputChunkAllocator allocate_chunk,
+				int64_t output_cookie,
+				const ScaleFactor& scale_factor,
+				const TargetSize& target_size,
+				const EncodeOptions& encode_options,
+				std::function<void()> on_complete)
+				: TranscodeJob(
+					  first_chunk,
+					  capacity,
+					  allocate_chunk,
+					  output_cookie,
+					  std::move(on_complete)),
+				  transcoder_(destination_, scale_factor, target_size, encode_options),
+				  input_finished_(false),
+				  finish_delivered_(false),
+				  cancelled_(false),
+				  draining_(false)
+			{
+			}
+
+			void StreamingTranscodeJob::appendInput(const uint8_t* data, size_t length)
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (isCompletedLocked() || input_finished_)
+				{
+					return;
+				}
+
+				pending_input_.insert(pending_input_.end(), data, data + length);
+				scheduleDrainLocked();
+			}
+
+			void StreamingTranscodeJob::finishInput()
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				input_finished_ = true;
+				scheduleDrainLocked();
+			}
+
+			void StreamingTranscodeJob::cancel()
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					cancelled_ = true;
+					pending_input_.clear();
+					if (draining_)
+					{
+						// drain completes the job once the transcoder returns.
+						return;
+					}
+				}
+
+				complete(TranscodeJobStatus::FAILED, "transcode cancelled");
+			}
+
+			void StreamingTranscodeJob::scheduleDrainLocked()
+			{
+				if (draining_)
+				{
+					return;
+				}
+
+				draining_ = true;
+				std::shared_ptr<StreamingTranscodeJob> self = shared_from_this();
+				WorkerPool::getInstance().submit([self]() { self->drain(); });
+			}
+
+			void StreamingTranscodeJob::drain()
+			{
+				std::vector<uint8_t> input;
+				while (true)
+				{
+					bool finish;
+					{
+						std::unique_lock<std::mutex> lock(mutex_);
+						if (cancelled_)
+						{
+							draining_ = false;
+							lock.unlock();
+							complete(TranscodeJobStatus::FAILED, "transcode cancelled");
+							return;
+						}
+
+						finish = input_finished_ && !finish_delivered_;
+						if (isCompletedLocked() || (pending_input_.empty() && !finish))
+						{
+							draining_ = false;
+							return;
+						}
+
+						// Swapping keeps the capacity of both buffers.
+						input.swap(pending_input_);
+						finish_delivered_ = input_finished_;
+					}
+
+					try
+					{
+						transcoder_.appendInput(input.data(), input.size());
+						if (finish)
+						{
+							transcoder_.finishInput();
+						}
+
+						if (transcoder_.resume())
+						{
+							complete(TranscodeJobStatus::SUCCEEDED, std::string());
+						}
+						else if (finish)
+						{
+							// A finished source never suspends.
+							complete(TranscodeJobStatus::FAILED, "jpeg ended before the last scanline");
+						}
+					}
+					catch (const std::exception& e)
+					{
+						complete(TranscodeJobStatus::FAILED, e.what());
+					}
+					catch (...)
+					{
+						complete(TranscodeJobStatus::FAILED, "unknown transcode error");
+					}
+
+					input.clear();
+				}
+			}
+
+			void submitTranscodeJob(const std::shared_ptr<MemoryTranscodeJob>& job)
+			{
+				WorkerPool::getInstance().submit([job]() { job->run(); });
+			}
+		}
+	}
+}
+
+#endif // HAS_LIBJPEGTURBO
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#ifndef _JPEG_TRANSCODE_JOB_H_
+#define _JPEG_TRANSCODE_JOB_H_
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+
+#include <jpeglib.h>
+
+#include "transformations.h"
+#include "jpeg_codec.h"
+#include "jpeg_encode_options.h"
+#include "jpeg_memory_io.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace jpeg
+		{
+			/**
+			 * State of a transcode job.
+			 *
+			 * <p> Values match TranscodeJobStatus in JpegTranscodeQueue.cs.
+			 */
+			enum class TranscodeJobStatus
+			{
+				PENDING = 0,
+				SUCCEEDED = 1,
+				FAILED = 2
+			};
+
+			/**
+			 * Transcode running on the worker pool into chunked output.
+			 *
+			 * <p> The output chunks are owned by the submitter, the first one
+			 * is provided up front and the following ones by the allocator. They
+			 * have to stay alive until the job completes.
+			 */
+			class TranscodeJob
+			{
+			private:
+				const std::function<void()> on_complete_;
+				mutable std::condition_variable completed_;
+				TranscodeJobStatus status_;
+				std::string error_;
+
+			protected:
+				JpegChunkedDestination destination_;
+				mutable std::mutex mutex_;
+
+				/**
+				 * @param on_complete called on the worker thread once the
+				 *        result is available, may be empty
+				 */
+				TranscodeJob(
+					JOCTET* first_chunk,
+					size_t capacity,
+					OutputChunkAllocator allocate_chunk,
+					int64_t output_cookie,
+					std::function<void()> on_complete);
+
+				/**
+				 * Records the result and notifies waiters and the completion
+				 * callback. Does nothing if the job already completed.
+				 */
+				void complete(TranscodeJobStatus status, std::string error);
+
+				/**
+				 * Returns true if the job completed. Has to be called with
+				 * mutex_ held.
+				 */
+				bool isCompletedLocked() const
+				{
+					return status_ != TranscodeJobStatus::PENDING;
+				}
+
+			public:
+				virtual ~TranscodeJob() = default;
+
+				// Disallow copying
+				TranscodeJob(const TranscodeJob& other) = delete;
+
+				TranscodeJob& operator=(const TranscodeJob& other) = delete;
+
+				TranscodeJobStatus getStatus() const;
+
+				/**
+				 * Blocks until the job completes.
+				 */
+				void wait() const;
+
+				/**
+				 * Returns the encoded output. Valid once the job succeeded.
+				 */
+				JpegChunkedDestination& getOutput()
+				{
+					return destination_;
+				}
+
+				/**
+				 * Returns the message of the error that failed the job.
+				 */
+				std::string getError() const;
+			};
+
+			/**
+			 * Transcode of a jpeg held in memory.
+			 *
+			 * <p> The source memory is owned by the submitter and has to stay
+			 * alive until the job completes.
+			 */
+			class MemoryTranscodeJob : public TranscodeJob
+			{
+			private:
+				const uint8_t* const data_;
+				const size_t length_;
+				const RotationType rotation_type_;
+				const ScaleFactor scale_factor_;
+				const CropRegion crop_region_;
+				const TargetSize target_size_;
+				const EncodeOptions encode_options_;
+
+			public:
+				MemoryTranscodeJob(
+					const uint8_t* data,
+					size_t length,
+					JOCTET* first_chunk,
+					size_t capacity,
+					OutputChunkAllocator allocate_chunk,
+					int64_t output_cookie,
+					RotationType rotation_type,
+					const ScaleFactor& scale_factor,
+					const CropRegion& crop_region,
+					const TargetSize& target_size,
+					const EncodeOptions& encode_options,
+					std::function<void()> on_complete);
+
+				/**
+				 * Transcodes the image and completes the job.
+				 */
+				void run();
+			};
+
+			/**
+			 * Downscale of a jpeg whose bytes are appended as they arrive,
+			 * see StreamingTranscoder.
+			 *
+			 * <p> Appending only copies the bytes, the transcoder is resumed
+			 * on the worker pool, one task at a time. The job fails if the
+			 * bytes are not a valid jpeg, input appended after that is
+			 * dropped.
+			 */
+			class StreamingTranscodeJob :
+				public TranscodeJob,
+				public std::enable_shared_from_this<StreamingTranscodeJob>
+			{
+			private:
+				StreamingTranscoder transcoder_;
+
+				// Guarded by mutex_
+				std::vector<uint8_t> pending_input_;
+				bool input_finished_;
+				bool finish_delivered_;
+				bool cancelled_;
+				bool draining_;
+
+				/**
+				 * Feeds the pending input to the transcoder until none is
+				 * left. Runs on the worker pool.
+				 */
+				void drain();
+
+				/**
+				 * Queues drain unless it is queued or running already. Has to
+				 * be called with mutex_ held.
+				 */
+				void scheduleDrainLocked();
+
+			public:
+				StreamingTranscodeJob(
+					JOCTET* first_chunk,
+					size_t capacity,
+					OutputChunkAllocator allocate_chunk,
+					int64_t output_cookie,
+					const ScaleFactor& scale_factor,
+					const TargetSize& target_size,
+					const EncodeOptions& encode_options,
+					std::function<void()> on_complete);
+
+				/**
+				 * Copies given bytes after the ones appended so far.
+				 */
+				void appendInput(const uint8_t* data, size_t length);
+
+				/**
+				 * Marks the end of the input.
+				 */
+				void finishInput();
+
+				/**
+				 * Fails the job without decoding the remaining input. The
+				 * job completes once the transcoder is no longer running, the
+				 * output chunks can be reused after that.
+				 */
+				void cancel();
+			};
+
+			/**
+			 * Queues job on the worker pool. The pool keeps the job alive
+			 * until it has run.
+			 */
+			void submitTranscodeJob(const std::shared_ptr<MemoryTranscodeJob>& job);
+		}
+	}
+}
+
+#endif // _JPEG_TRANSCODE_JOB_H_
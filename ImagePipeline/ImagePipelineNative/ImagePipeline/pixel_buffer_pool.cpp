@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "pixel_buffer_pool.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		// Enough for a couple of full screen images
+		static const size_t kMaxFreeBytes = 32 * 1024 * 1024;
+
+		PixelBufferPool::PixelBufferPool(size_t max_free_bytes)
+			: free_bytes_(0),
+			  max_free_bytes_(max_free_bytes)
+		{
+		}
+
+		PixelBufferPool::~PixelBufferPool()
+		{
+			trim();
+		}
+
+		pixels_t PixelBufferPool::lease(size_t capacity)
+		{
+			Buffer buffer = { nullptr, nullptr };
+			size_t buffer_capacity = capacity;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				auto it = free_buffers_.lower_bound(capacity);
+				if (it != free_buffers_.end() && it->first / 2 <= capacity)
+				{
+					buffer = it->second;
+					buffer_capacity = it->first;
+					free_bytes_ -= it->first;
+					free_buffers_.erase(it);
+				}
+			}
+
+			if (buffer.allocation == nullptr)
+			{
+				buffer.allocation = new uint8_t[capacity + kRowAlignment - 1];
+				buffer.pixels = (uint8_t*)(
+					((uintptr_t)buffer.allocation + kRowAlignment - 1) &
+					~(uintptr_t)(kRowAlignment - 1));
+			}
+
+			// The pool has to outlive the buffers leased from it
+			return pixels_t(buffer.pixels, [this, buffer_capacity, buffer](uint8_t*)
+			{
+				release(buffer_capacity, buffer);
+			});
+		}
+
+		void PixelBufferPool::release(size_t capacity, const Buffer& buffer)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (free_bytes_ + capacity <= max_free_bytes_)
+				{
+					free_buffers_.emplace(capacity, buffer);
+					free_bytes_ += capacity;
+					return;
+				}
+			}
+
+			delete[] buffer.allocation;
+		}
+
+		void PixelBufferPool::trim()
+		{
+			std::multimap<size_t, Buffer> released;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				released.swap(free_buffers_);
+				free_bytes_ = 0;
+			}
+
+			for (const auto& entry : released)
+			{
+				delete[] entry.second.allocation;
+			}
+		}
+
+		size_t PixelBufferPool::getFreeBytes()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			return free_bytes_;
+		}
+
+		PixelBufferPool& PixelBufferPool::getInstance()
+		{
+			// Never destroyed, images may be released while the dll unloads.
+			static PixelBufferPool* instance = new PixelBufferPool(kMaxFreeBytes);
+			return *instance;
+		}
+	}
+}
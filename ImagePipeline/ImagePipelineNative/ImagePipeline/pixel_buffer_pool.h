@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef _PIXEL_BUFFER_POOL_H_
+#define _PIXEL_BUFFER_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+
+#include "decoded_image.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		/**
+		 * Pool of pixel buffers starting at kRowAlignment boundaries.
+		 *
+		 * <p> Leased buffers return to the pool when the pixels_t holding
+		 * them is destroyed, so an image decoded, resampled and encoded
+		 * in a row reuses the memory of the previous one. Free buffers
+		 * above the byte limit are released right away.
+		 */
+		class PixelBufferPool
+		{
+		private:
+			struct Buffer
+			{
+				uint8_t* allocation;
+				uint8_t* pixels;
+			};
+
+			std::mutex mutex_;
+
+			// Free buffers by capacity
+			std::multimap<size_t, Buffer> free_buffers_;
+			size_t free_bytes_;
+			const size_t max_free_bytes_;
+
+			void release(size_t capacity, const Buffer& buffer);
+
+		public:
+			/**
+			 * @param max_free_bytes bytes of free buffers kept for reuse
+			 */
+			explicit PixelBufferPool(size_t max_free_bytes);
+
+			~PixelBufferPool();
+
+			PixelBufferPool(const PixelBufferPool&) = delete;
+			PixelBufferPool& operator=(const PixelBufferPool&) = delete;
+
+			/**
+			 * Returns a buffer of at least capacity bytes, reused if the pool
+			 * holds one at most twice as large.
+			 */
+			pixels_t lease(size_t capacity);
+
+			/**
+			 * Releases all free buffers.
+			 */
+			void trim();
+
+			size_t getFreeBytes();
+
+			/**
+			 * Returns the pool shared by the whole library.
+			 */
+			static PixelBufferPool& getInstance();
+		};
+	}
+}
+
+#endif // _PIXEL_BUFFER_POOL_H_
@@ -0,0 +1,490 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <string.h>
+
+#include "exceptions.h"
+#include "pixel_conversion.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIXEL_CONVERSION_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM) || defined(_M_ARM64)
+#define PIXEL_CONVERSION_USE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		/**
+		 * Rounds c * a / 255 exactly, the way the vector kernels do.
+		 */
+		static inline uint8_t premultiply(uint32_t c, uint32_t a)
+		{
+			const uint32_t t = c * a + 128;
+			return (uint8_t)((t + (t >> 8)) >> 8);
+		}
+
+		/**
+		 * Luma weights of libjpeg, so that gray pixels of all codecs match
+		 * the ones of grayscale jpegs.
+		 */
+		static inline uint8_t luma(uint32_t r, uint32_t g, uint32_t b)
+		{
+			return (uint8_t)((19595 * r + 38470 * g + 7471 * b + 32768) >> 16);
+		}
+
+		static inline uint16_t packRgb565(uint32_t r, uint32_t g, uint32_t b)
+		{
+			return (uint16_t)(((r & 0xf8) << 8) | ((g & 0xfc) << 3) | (b >> 3));
+		}
+
+#ifdef PIXEL_CONVERSION_USE_SSE2
+		static inline __m128i swapRedBlue(__m128i pixels)
+		{
+			const __m128i green_alpha = _mm_set1_epi32((int)0xff00ff00);
+			const __m128i low_byte = _mm_set1_epi32(0xff);
+			return _mm_or_si128(
+				_mm_and_si128(pixels, green_alpha),
+				_mm_or_si128(
+					_mm_and_si128(_mm_srli_epi32(pixels, 16), low_byte),
+					_mm_slli_epi32(_mm_and_si128(pixels, low_byte), 16)));
+		}
+
+		/**
+		 * Premultiplies 2 pixels widened to 16-bit words.
+		 */
+		static inline __m128i premultiplyWords(__m128i words)
+		{
+			const __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(words, 0xff), 0xff);
+			const __m128i t = _mm_add_epi16(_mm_mullo_epi16(words, alpha), _mm_set1_epi16(128));
+			return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+		}
+
+		static inline __m128i premultiply(__m128i pixels)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i premultiplied = _mm_packus_epi16(
+				premultiplyWords(_mm_unpacklo_epi8(pixels, zero)),
+				premultiplyWords(_mm_unpackhi_epi8(pixels, zero)));
+
+			// Alpha itself stays as it is
+			const __m128i alpha_mask = _mm_set1_epi32((int)0xff000000);
+			return _mm_or_si128(
+				_mm_andnot_si128(alpha_mask, premultiplied),
+				_mm_and_si128(alpha_mask, pixels));
+		}
+
+		/**
+		 * Lumas of 4 RGBA pixels in the low byte of each 32-bit lane, with
+		 * the weights of the scalar code. 38470 does not fit a signed word,
+		 * green is weighted twice by half of it.
+		 */
+		static inline __m128i luma(__m128i pixels)
+		{
+			const __m128i low_byte = _mm_set1_epi32(0xff);
+			const __m128i red_blue = _mm_and_si128(pixels, _mm_set1_epi32(0x00ff00ff));
+			const __m128i green = _mm_and_si128(_mm_srli_epi32(pixels, 8), low_byte);
+			const __m128i sum = _mm_add_epi32(
+				_mm_madd_epi16(red_blue, _mm_set1_epi32((7471 << 16) | 19595)),
+				_mm_madd_epi16(
+					_mm_or_si128(green, _mm_slli_epi32(green, 16)),
+					_mm_set1_epi32((19235 << 16) | 19235)));
+			return _mm_srli_epi32(_mm_add_epi32(sum, _mm_set1_epi32(32768)), 16);
+		}
+
+		/**
+		 * RGB565 of 4 RGBA pixels in the low word of each 32-bit lane,
+		 * sign extended so that packing them does not saturate.
+		 */
+		static inline __m128i packRgb565(__m128i pixels)
+		{
+			const __m128i rgb565 = _mm_or_si128(
+				_mm_or_si128(
+					_mm_slli_epi32(_mm_and_si128(pixels, _mm_set1_epi32(0xf8)), 8),
+					_mm_srli_epi32(_mm_and_si128(pixels, _mm_set1_epi32(0xfc00)), 5)),
+				_mm_and_si128(_mm_srli_epi32(pixels, 19), _mm_set1_epi32(0x1f)));
+			return _mm_srai_epi32(_mm_slli_epi32(rgb565, 16), 16);
+		}
+#endif
+
+#ifdef PIXEL_CONVERSION_USE_NEON
+		static inline uint8x16_t premultiply(uint8x16_t c, uint8x16_t a)
+		{
+			// (t + ((t + 128) >> 8) + 128) >> 8, same as the scalar code
+			const uint16x8_t low = vmull_u8(vget_low_u8(c), vget_low_u8(a));
+			const uint16x8_t high = vmull_u8(vget_high_u8(c), vget_high_u8(a));
+			return vcombine_u8(
+				vraddhn_u16(low, vrshrq_n_u16(low, 8)),
+				vraddhn_u16(high, vrshrq_n_u16(high, 8)));
+		}
+#endif
+
+		/**
+		 * RGBA to BGRA and back, one kernel since the swap is symmetric.
+		 */
+		static void swapRedBlueRow(const uint8_t* src, uint8_t* dst, size_t width)
+		{
+			size_t x = 0;
+
+#ifdef PIXEL_CONVERSION_USE_SSE2
+			for (; x + 4 <= width; x += 4)
+			{
+				const __m128i pixels = _mm_loadu_si128((const __m128i*)(src + x * 4));
+				_mm_storeu_si128((__m128i*)(dst + x * 4), swapRedBlue(pixels));
+			}
+#endif
+
+#ifdef PIXEL_CONVERSION_USE_NEON
+			for (; x + 16 <= width; x += 16)
+			{
+				uint8x16x4_t pixels = vld4q_u8(src + x * 4);
+				const uint8x16_t red = pixels.val[0];
+				pixels.val[0] = pixels.val[2];
+				pixels.val[2] = red;
+				vst4q_u8(dst + x * 4, pixels);
+			}
+#endif
+
+			for (; x < width; ++x)
+			{
+				const uint8_t* in = src + x * 4;
+				uint8_t* out = dst + x * 4;
+				const uint8_t red = in[0];
+				out[0] = in[2];
+				out[1] = in[1];
+				out[2] = red;
+				out[3] = in[3];
+			}
+		}
+
+		/**
+		 * Premultiplies the 3 color components of 4-byte pixels by the 4th,
+		 * whichever their order.
+		 */
+		static void premultiplyRow(const uint8_t* src, uint8_t* dst, size_t width)
+		{
+			size_t x = 0;
+
+#ifdef PIXEL_CONVERSION_USE_SSE2
+			for (; x + 4 <= width; x += 4)
+			{
+				const __m128i pixels = _mm_loadu_si128((const __m128i*)(src + x * 4));
+				_mm_storeu_si128((__m128i*)(dst + x * 4), premultiply(pixels));
+			}
+#endif
+
+#ifdef PIXEL_CONVERSION_USE_NEON
+			for (; x + 16 <= width; x += 16)
+			{
+				uint8x16x4_t pixels = vld4q_u8(src + x * 4);
+				pixels.val[0] = premultiply(pixels.val[0], pixels.val[3]);
+				pixels.val[1] = premultiply(pixels.val[1], pixels.val[3]);
+				pixels.val[2] = premultiply(pixels.val[2], pixels.val[3]);
+				vst4q_u8(dst + x * 4, pixels);
+			}
+#endif
+
+			for (; x < width; ++x)
+			{
+				const uint8_t* in = src + x * 4;
+				uint8_t* out = dst + x * 4;
+				const uint8_t alpha = in[3];
+				out[0] = premultiply(in[0], alpha);
+				out[1] = premultiply(in[1], alpha);
+				out[2] = premultiply(in[2], alpha);
+				out[3] = alpha;
+			}
+		}
+
+		/**
+		 * RGBA to premultiplied BGRA in a single pass.
+		 */
+		static void swapRedBluePremultiplyRow(const uint8_t* src, uint8_t* dst, size_t width)
+		{
+			size_t x = 0;
+
+#ifdef PIXEL_CONVERSION_USE_SSE2
+			for (; x + 4 <= width; x += 4)
+			{
+				const __m128i pixels = _mm_loadu_si128((const __m128i*)(src + x * 4));
+				_mm_storeu_si128((__m128i*)(dst + x * 4), premultiply(swapRedBlue(pixels)));
+			}
+#endif
+
+#ifdef PIXEL_CONVERSION_USE_NEON
+			for (; x + 16 <= width; x += 16)
+			{
+				uint8x16x4_t pixels = vld4q_u8(src + x * 4);
+				const uint8x16_t red = premultiply(pixels.val[0], pixels.val[3]);
+				pixels.val[0] = premultiply(pixels.val[2], pixels.val[3]);
+				pixels.val[1] = premultiply(pixels.val[1], pixels.val[3]);
+				pixels.val[2] = red;
+				vst4q_u8(dst + x * 4, pixels);
+			}
+#endif
+
+			for (; x < width; ++x)
+			{
+				const uint8_t* in = src + x * 4;
+				uint8_t* out = dst + x * 4;
+				const uint8_t red = in[0];
+				const uint8_t alpha = in[3];
+				out[0] = premultiply(in[2], alpha);
+				out[1] = premultiply(in[1], alpha);
+				out[2] = premultiply(red, alpha);
+				out[3] = alpha;
+			}
+		}
+
+		/**
+		 * RGB to opaque RGBA or BGRA, premultiplied or not.
+		 */
+		template<bool swap>
+		static void expandRgbRow(const uint8_t* src, uint8_t* dst, size_t width)
+		{
+			size_t x = 0;
+
+#ifdef PIXEL_CONVERSION_USE_NEON
+			for (; x + 16 <= width; x += 16)
+			{
+				const uint8x16x3_t rgb = vld3q_u8(src + x * 3);
+				uint8x16x4_t pixels;
+				pixels.val[0] = rgb.val[swap ? 2 : 0];
+				pixels.val[1] = rgb.val[1];
+				pixels.val[2] = rgb.val[swap ? 0 : 2];
+				pixels.val[3] = vdupq_n_u8(0xff);
+				vst4q_u8(dst + x * 4, pixels);
+			}
+#endif
+
+			for (; x < width; ++x)
+			{
+				const uint8_t* in = src + x * 3;
+				uint8_t* out = dst + x * 4;
+				out[0] = in[swap ? 2 : 0];
+				out[1] = in[1];
+				out[2] = in[swap ? 0 : 2];
+				out[3] = 0xff;
+			}
+		}
+
+		static void rgbaToRgbRow(const uint8_t* src, uint8_t* dst, size_t width)
+		{
+			for (size_t x = 0; x < width; ++x)
+			{
+				dst[x * 3] = src[x * 4];
+				dst[x * 3 + 1] = src[x * 4 + 1];
+				dst[x * 3 + 2] = src[x * 4 + 2];
+			}
+		}
+
+		template<size_t components>
+		static void toRgb565Row(const uint8_t* src, uint8_t* dst, size_t width)
+		{
+			uint16_t* out = (uint16_t*)dst;
+			size_t x = 0;
+
+#ifdef PIXEL_CONVERSION_USE_SSE2
+			for (; components == 4 && x + 8 <= width; x += 8, src += 32)
+			{
+				const __m128i low = _mm_loadu_si128((const __m128i*)src);
+				const __m128i high = _mm_loadu_si128((const __m128i*)(src + 16));
+				_mm_storeu_si128(
+					(__m128i*)(out + x),
+					_mm_packs_epi32(packRgb565(low), packRgb565(high)));
+			}
+#endif
+
+			for (; x < width; ++x, src += components)
+			{
+				out[x] = packRgb565(src[0], src[1], src[2]);
+			}
+		}
+
+		template<size_t components>
+		static void toGrayRow(const uint8_t* src, uint8_t* dst, size_t width)
+		{
+			size_t x = 0;
+
+#ifdef PIXEL_CONVERSION_USE_SSE2
+			for (; components == 4 && x + 16 <= width; x += 16, src += 64)
+			{
+				const __m128i low = _mm_packs_epi32(
+					luma(_mm_loadu_si128((const __m128i*)src)),
+					luma(_mm_loadu_si128((const __m128i*)(src + 16))));
+				const __m128i high = _mm_packs_epi32(
+					luma(_mm_loadu_si128((const __m128i*)(src + 32))),
+					luma(_mm_loadu_si128((const __m128i*)(src + 48))));
+				_mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(low, high));
+			}
+#endif
+
+			for (; x < width; ++x, src += components)
+			{
+				dst[x] = luma(src[0], src[1], src[2]);
+			}
+		}
+
+		template<size_t components>
+		static void toGrayAlphaRow(const uint8_t* src, uint8_t* dst, size_t width)
+		{
+			size_t x = 0;
+
+#ifdef PIXEL_CONVERSION_USE_SSE2
+			// Alpha goes above luma in the high word of each lane, shifting
+			// it down sign extends the pair so that packing does not saturate
+			const __m128i alpha_mask = _mm_set1_epi32((int)0xff000000);
+			for (; components == 4 && x + 8 <= width; x += 8, src += 32)
+			{
+				const __m128i low = _mm_loadu_si128((const __m128i*)src);
+				const __m128i high = _mm_loadu_si128((const __m128i*)(src + 16));
+				_mm_storeu_si128(
+					(__m128i*)(dst + x * 2),
+					_mm_packs_epi32(
+						_mm_srai_epi32(_mm_or_si128(_mm_slli_epi32(luma(low), 16), _mm_and_si128(low, alpha_mask)), 16),
+						_mm_srai_epi32(_mm_or_si128(_mm_slli_epi32(luma(high), 16), _mm_and_si128(high, alpha_mask)), 16)));
+			}
+#endif
+
+			for (; x < width; ++x, src += components)
+			{
+				dst[x * 2] = luma(src[0], src[1], src[2]);
+				dst[x * 2 + 1] = components == 4 ? src[3] : 0xff;
+			}
+		}
+
+		static void grayToGrayAlphaRow(const uint8_t* src, uint8_t* dst, size_t width)
+		{
+			for (size_t x = 0; x < width; ++x)
+			{
+				dst[x * 2] = src[x];
+				dst[x * 2 + 1] = 0xff;
+			}
+		}
+
+		/**
+		 * Returns the kernel converting source to target, null if no
+		 * conversion is needed. Throws if there is none.
+		 */
+		static PixelConverter::ConvertRowFunction getConvertRowFunction(
+			PixelFormat source,
+			PixelFormat target)
+		{
+			if (source == target)
+			{
+				return nullptr;
+			}
+
+			switch (source)
+			{
+			case PixelFormat::RGBA:
+				switch (target)
+				{
+				case PixelFormat::RGB:
+					return rgbaToRgbRow;
+
+				case PixelFormat::BGRA:
+					return swapRedBlueRow;
+
+				case PixelFormat::BGRA_PREMULTIPLIED:
+					return swapRedBluePremultiplyRow;
+
+				case PixelFormat::RGB565:
+					return toRgb565Row<4>;
+
+				case PixelFormat::GRAY:
+					return toGrayRow<4>;
+
+				case PixelFormat::GRAY_ALPHA:
+					return toGrayAlphaRow<4>;
+
+				default:
+					break;
+				}
+				break;
+
+			case PixelFormat::RGB:
+				switch (target)
+				{
+				case PixelFormat::RGBA:
+					return expandRgbRow<false>;
+
+				// Opaque pixels are the same premultiplied
+				case PixelFormat::BGRA:
+				case PixelFormat::BGRA_PREMULTIPLIED:
+					return expandRgbRow<true>;
+
+				case PixelFormat::RGB565:
+					return toRgb565Row<3>;
+
+				case PixelFormat::GRAY:
+					return toGrayRow<3>;
+
+				case PixelFormat::GRAY_ALPHA:
+					return toGrayAlphaRow<3>;
+
+				default:
+					break;
+				}
+				break;
+
+			case PixelFormat::BGRA:
+				switch (target)
+				{
+				case PixelFormat::RGBA:
+					return swapRedBlueRow;
+
+				case PixelFormat::BGRA_PREMULTIPLIED:
+					return premultiplyRow;
+
+				default:
+					break;
+				}
+				break;
+
+			case PixelFormat::GRAY:
+				if (target == PixelFormat::GRAY_ALPHA)
+				{
+					return grayToGrayAlphaRow;
+				}
+				break;
+
+			default:
+				break;
+			}
+
+			safeThrowException("unsupported pixel format conversion");
+			return nullptr;
+		}
+
+		PixelConverter::PixelConverter(PixelFormat source, PixelFormat target)
+			: source_(source),
+			  target_(target),
+			  convert_row_(getConvertRowFunction(source, target))
+		{
+		}
+
+		void PixelConverter::convertRow(const uint8_t* src, uint8_t* dst, size_t width) const
+		{
+			if (convert_row_ != nullptr)
+			{
+				convert_row_(src, dst, width);
+			}
+			else if (src != dst)
+			{
+				memcpy(dst, src, width * bytesPerPixel(target_));
+			}
+		}
+	}
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef _PIXEL_CONVERSION_H_
+#define _PIXEL_CONVERSION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "decoded_image.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		/**
+		 * Converts rows from the format a codec writes to the format the
+		 * caller asked for.
+		 *
+		 * <p> Codecs convert each row right after decoding it, while it is
+		 * still in cache, so that the destination is written once in its
+		 * final format. Swizzling and premultiplying run with SSE2 or NEON
+		 * when the target supports them. SSE2 also converts RGBA to RGB565
+		 * and gray, NEON expands RGB to RGBA. Other conversions are scalar.
+		 */
+		class PixelConverter
+		{
+		public:
+			typedef void (*ConvertRowFunction)(const uint8_t* src, uint8_t* dst, size_t width);
+
+		private:
+			PixelFormat source_;
+			PixelFormat target_;
+			ConvertRowFunction convert_row_;
+
+		public:
+			/**
+			 * Throws if pixels of source format cannot be converted to target
+			 * format.
+			 */
+			PixelConverter(PixelFormat source, PixelFormat target);
+
+			PixelFormat getSource() const
+			{
+				return source_;
+			}
+
+			PixelFormat getTarget() const
+			{
+				return target_;
+			}
+
+			/**
+			 * Whether rows are already in the target format.
+			 */
+			bool isIdentity() const
+			{
+				return convert_row_ == nullptr;
+			}
+
+			/**
+			 * Whether source and target pixels have the same size, so that
+			 * rows can be converted where they were decoded.
+			 */
+			bool isInPlace() const
+			{
+				return bytesPerPixel(source_) == bytesPerPixel(target_);
+			}
+
+			/**
+			 * Converts width pixels of src into dst. src and dst may be the
+			 * same row if the conversion is in place, otherwise they must not
+			 * overlap.
+			 */
+			void convertRow(const uint8_t* src, uint8_t* dst, size_t width) const;
+		};
+	}
+}
+
+#endif // _PIXEL_CONVERSION_H_
@@ -0,0 +1,759 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifdef HAS_LIBPNG
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <string.h>
+
+#include <png.h>
+
+#include "decoded_image.h"
+#include "exceptions.h"
+#include "pixel_buffer_pool.h"
+#include "pixel_conversion.h"
+#include "resampler.h"
+#include "transformations.h"
+#include "png_codec.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace png
+		{
+			static const size_t kSignatureLength = 8;
+
+			/**
+			 * Position of libpng in the encoded bytes.
+			 */
+			struct PngMemorySource
+			{
+				const uint8_t* data;
+				size_t length;
+				size_t offset;
+			};
+
+			/**
+			 * Replaces the longjmp libpng does by default with an exception
+			 * encapsulating the error message, see JpegErrorHandler.
+			 */
+			static void pngThrow(png_structp png_ptr, png_const_charp message)
+			{
+				safeThrowException(message);
+			}
+
+			static void pngWarning(png_structp png_ptr, png_const_charp message)
+			{
+			}
+
+			static void readFromMemory(png_structp png_ptr, png_bytep out, png_size_t count)
+			{
+				PngMemorySource* source = (PngMemorySource*)png_get_io_ptr(png_ptr);
+				if (count > source->length - source->offset)
+				{
+					png_error(png_ptr, "png data is incomplete");
+				}
+
+				memcpy(out, source->data + source->offset, count);
+				source->offset += count;
+			}
+
+			/**
+			 * Owns the libpng read structs, which are destroyed also when
+			 * an exception unwinds the stack.
+			 */
+			class PngReadLease
+			{
+			private:
+				PngMemorySource source_;
+				png_structp png_ptr_;
+				png_infop info_ptr_;
+
+			public:
+				PngReadLease(const uint8_t* data, size_t length)
+					: png_ptr_(nullptr),
+					  info_ptr_(nullptr)
+				{
+					THROW_AND_RETURN_IF(data == nullptr, "png data cannot be null");
+					THROW_AND_RETURN_IF(
+						length < kSignatureLength || png_sig_cmp(data, 0, kSignatureLength) != 0,
+						"invalid png signature");
+
+					source_.data = data;
+					source_.length = length;
+					source_.offset = 0;
+
+					png_ptr_ = png_create_read_struct(
+						PNG_LIBPNG_VER_STRING,
+						nullptr,
+						pngThrow,
+						pngWarning);
+					THROW_AND_RETURN_IF(png_ptr_ == nullptr, "could not create png read struct");
+
+					info_ptr_ = png_create_info_struct(png_ptr_);
+					if (info_ptr_ == nullptr)
+					{
+						// The destructor does not run when the constructor throws
+						png_destroy_read_struct(&png_ptr_, nullptr, nullptr);
+						safeThrowException("could not create png info struct");
+						return;
+					}
+
+					png_set_read_fn(png_ptr_, &source_, readFromMemory);
+				}
+
+				~PngReadLease()
+				{
+					png_destroy_read_struct(&png_ptr_, &info_ptr_, nullptr);
+				}
+
+				// Disallow copying
+				PngReadLease(const PngReadLease& other) = delete;
+
+				PngReadLease& operator=(const PngReadLease& other) = delete;
+
+				png_structp getPng()
+				{
+					return png_ptr_;
+				}
+
+				png_infop getInfo()
+				{
+					return info_ptr_;
+				}
+			};
+
+			/**
+			 * Averages blocks of factor x factor source pixels, the png
+			 * counterpart of the DCT scaling the jpeg decoder does before
+			 * resampling. Blocks on the right and bottom edges may be
+			 * smaller.
+			 *
+			 * <p> Sums are kept for as many reduced rows as rows_held, a
+			 * single one when rows arrive in order. Interlaced passes only
+			 * add their own pixels, so the sums of all passes are those of
+			 * the full image.
+			 */
+			class BoxReducer
+			{
+			private:
+				const uint32_t width_;
+				const uint32_t height_;
+				const uint32_t components_;
+				const uint32_t factor_;
+				const uint32_t reduced_width_;
+				const uint32_t reduced_height_;
+				const uint32_t rows_held_;
+				std::vector<uint32_t> sums_;
+
+			public:
+				BoxReducer(
+					uint32_t width,
+					uint32_t height,
+					uint32_t components,
+					uint32_t factor,
+					uint32_t rows_held)
+					: width_(width),
+					  height_(height),
+					  components_(components),
+					  factor_(factor),
+					  reduced_width_((width + factor - 1) / factor),
+					  reduced_height_((height + factor - 1) / factor),
+					  rows_held_(rows_held),
+					  sums_((size_t)reduced_width_ * components * rows_held, 0)
+				{
+				}
+
+				uint32_t getReducedWidth() const
+				{
+					return reduced_width_;
+				}
+
+				uint32_t getReducedHeight() const
+				{
+					return reduced_height_;
+				}
+
+				/**
+				 * Adds the pixels of source row y starting at first_column,
+				 * every column_step pixels.
+				 */
+				void addRow(
+					const uint8_t* row,
+					uint32_t y,
+					uint32_t first_column,
+					uint32_t column_step)
+				{
+					uint32_t* sums = &sums_[
+						(size_t)((y / factor_) % rows_held_) * reduced_width_ * components_];
+					for (uint32_t x = first_column; x < width_; x += column_step)
+					{
+						const uint8_t* in = row + (size_t)x * components_;
+						uint32_t* out = sums + (size_t)(x / factor_) * components_;
+						for (uint32_t c = 0; c < components_; ++c)
+						{
+							out[c] += in[c];
+						}
+					}
+				}
+
+				/**
+				 * Returns true if source row y completes its reduced row.
+				 */
+				bool completesRow(uint32_t y) const
+				{
+					return (y + 1) % factor_ == 0 || y + 1 == height_;
+				}
+
+				/**
+				 * Writes the averages of reduced row y and clears its sums.
+				 */
+				void readRow(uint32_t y, uint8_t* row)
+				{
+					uint32_t* sums = &sums_[
+						(size_t)(y % rows_held_) * reduced_width_ * components_];
+					const uint32_t rows = std::min<uint32_t>(factor_, height_ - y * factor_);
+					for (uint32_t x = 0; x < reduced_width_; ++x)
+					{
+						const uint32_t columns = std::min<uint32_t>(factor_, width_ - x * factor_);
+						const uint32_t count = rows * columns;
+						for (uint32_t c = 0; c < components_; ++c)
+						{
+							uint32_t& sum = sums[(size_t)x * components_ + c];
+							row[(size_t)x * components_ + c] = (uint8_t)((sum + count / 2) / count);
+							sum = 0;
+						}
+					}
+				}
+			};
+
+			/**
+			 * Returns the factor the image can be box reduced by before
+			 * resampling, so that the resampler still sees at least twice
+			 * the target size.
+			 */
+			static uint32_t computeReductionFactor(
+				png_uint_32 image_width,
+				png_uint_32 image_height,
+				unsigned int target_width,
+				unsigned int target_height)
+			{
+				const uint32_t factor = std::min<uint32_t>(
+					image_width / target_width,
+					image_height / target_height) / 2;
+				return std::max<uint32_t>(factor, 1);
+			}
+
+			/**
+			 * Returns the dimensions of the image decoded at given target
+			 * size.
+			 */
+			static void computeDecodeSize(
+				png_uint_32 image_width,
+				png_uint_32 image_height,
+				const TargetSize& target_size,
+				unsigned int& width,
+				unsigned int& height)
+			{
+				if (!target_size.isEmpty() &&
+					target_size.getWidth() <= image_width &&
+					target_size.getHeight() <= image_height)
+				{
+					width = target_size.getWidth();
+					height = target_size.getHeight();
+				}
+				else
+				{
+					width = image_width;
+					height = image_height;
+				}
+			}
+
+			/**
+			 * Returns the pixel format libpng writes when decoding to given
+			 * pixel format, rows are converted if the two differ.
+			 */
+			static PixelFormat getDecodedPixelFormat(PixelFormat pixel_format)
+			{
+				switch (pixel_format)
+				{
+				case PixelFormat::BGRA_PREMULTIPLIED:
+					return PixelFormat::BGRA;
+
+				case PixelFormat::RGB565:
+				case PixelFormat::GRAY:
+					return PixelFormat::RGB;
+
+				case PixelFormat::GRAY_ALPHA:
+					return PixelFormat::RGBA;
+
+				default:
+					return pixel_format;
+				}
+			}
+
+			/**
+			 * Returns where to write a decoded row that ends up at destination,
+			 * destination itself if rows are converted in place.
+			 */
+			static uint8_t* getDecodedRow(
+				const PixelConverter& converter,
+				uint8_t* destination,
+				std::vector<uint8_t>& scratch)
+			{
+				return converter.isInPlace() ? destination : scratch.data();
+			}
+
+			/**
+			 * Returns the last pass writing pixels of given row.
+			 */
+			static int getLastPassOfRow(png_uint_32 width, png_uint_32 y, int passes)
+			{
+				int pass = passes - 1;
+				while (pass > 0 &&
+					(PNG_PASS_COLS(width, pass) == 0 || !PNG_ROW_IN_INTERLACE_PASS(y, pass)))
+				{
+					--pass;
+				}
+
+				return pass;
+			}
+
+			/**
+			 * Reads the chunks up to the image data and sets up the
+			 * transformations bringing any png to 8-bit samples of given
+			 * format, one of RGB, RGBA and BGRA.
+			 *
+			 * @return number of passes the rows have to be read in
+			 */
+			static int readHeader(PngReadLease& lease, PixelFormat pixel_format)
+			{
+				png_structp png_ptr = lease.getPng();
+				png_infop info_ptr = lease.getInfo();
+				png_read_info(png_ptr, info_ptr);
+
+				const int bit_depth = png_get_bit_depth(png_ptr, info_ptr);
+				const int color_type = png_get_color_type(png_ptr, info_ptr);
+				if (color_type == PNG_COLOR_TYPE_PALETTE)
+				{
+					png_set_palette_to_rgb(png_ptr);
+				}
+
+				if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8)
+				{
+					png_set_expand_gray_1_2_4_to_8(png_ptr);
+				}
+
+				if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS))
+				{
+					png_set_tRNS_to_alpha(png_ptr);
+				}
+
+				if (bit_depth == 16)
+				{
+					png_set_scale_16(png_ptr);
+				}
+
+				if (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_GRAY_ALPHA)
+				{
+					png_set_gray_to_rgb(png_ptr);
+				}
+
+				if (pixel_format != PixelFormat::RGB)
+				{
+					// Only added to images without alpha
+					png_set_add_alpha(png_ptr, 0xff, PNG_FILLER_AFTER);
+				}
+				else
+				{
+					png_set_strip_alpha(png_ptr);
+				}
+
+				if (pixel_format == PixelFormat::BGRA)
+				{
+					png_set_bgr(png_ptr);
+				}
+
+				const int passes = png_set_interlace_handling(png_ptr);
+				png_read_update_info(png_ptr, info_ptr);
+
+				THROW_AND_RETURNVAL_IF(
+					png_get_rowbytes(png_ptr, info_ptr) !=
+						(size_t)png_get_image_width(png_ptr, info_ptr) * bytesPerPixel(pixel_format),
+					"unexpected png row layout",
+					0);
+
+				return passes;
+			}
+
+			/**
+			 * Reads the rows of all passes straight into the destination,
+			 * each pass only writes its own pixels. A row is converted once
+			 * its last pass is read.
+			 *
+			 * <p> Pixel formats smaller than the decoded ones are decoded into
+			 * scratch memory first, a row for non-interlaced images and the
+			 * whole image otherwise.
+			 */
+			static void readRows(
+				png_structp png_ptr,
+				png_uint_32 width,
+				png_uint_32 height,
+				int passes,
+				const PixelConverter& converter,
+				uint8_t* pixels,
+				size_t stride)
+			{
+				const size_t decoded_stride = (size_t)width * bytesPerPixel(converter.getSource());
+				std::vector<uint8_t> scratch;
+				if (!converter.isInPlace())
+				{
+					scratch.resize(passes == 1 ? decoded_stride : decoded_stride * height);
+				}
+
+				for (int pass = 0; pass < passes; ++pass)
+				{
+					for (png_uint_32 y = 0; y < height; ++y)
+					{
+						uint8_t* destination = pixels + y * stride;
+						uint8_t* row = getDecodedRow(converter, destination, scratch);
+						if (!converter.isInPlace() && passes > 1)
+						{
+							row += y * decoded_stride;
+						}
+
+						png_read_row(png_ptr, row, nullptr);
+						if (passes == 1 || getLastPassOfRow(width, y, passes) == pass)
+						{
+							converter.convertRow(row, destination, width);
+						}
+					}
+				}
+			}
+
+			/**
+			 * Resamples the rows of a non-interlaced image as they are
+			 * decoded.
+			 */
+			static void readResampledRows(
+				png_structp png_ptr,
+				png_uint_32 width,
+				png_uint_32 height,
+				const PixelConverter& converter,
+				unsigned int target_width,
+				unsigned int target_height,
+				ResampleFilter filter,
+				uint8_t* pixels,
+				size_t stride)
+			{
+				const int components = bytesPerPixel(converter.getSource());
+				RowResampler resampler(
+					width,
+					height,
+					target_width,
+					target_height,
+					components,
+					filter);
+
+				std::vector<uint8_t> row((size_t)width * components);
+				std::vector<uint8_t> resampled_row((size_t)target_width * components);
+				unsigned int output_row = 0;
+				for (png_uint_32 y = 0; y < height; ++y)
+				{
+					png_read_row(png_ptr, row.data(), nullptr);
+					resampler.pushRow(row.data());
+					while (resampler.hasOutputRow())
+					{
+						uint8_t* destination = pixels + output_row * stride;
+						uint8_t* resampled = getDecodedRow(converter, destination, resampled_row);
+						resampler.readRow(resampled);
+						converter.convertRow(resampled, destination, target_width);
+						++output_row;
+					}
+				}
+			}
+
+			/**
+			 * Resamples the rows of an interlaced image pass by pass. Each
+			 * pass row holds only the pixels of the pass, the rest of it is
+			 * zero.
+			 */
+			static void readResampledPasses(
+				png_structp png_ptr,
+				png_uint_32 width,
+				png_uint_32 height,
+				int passes,
+				const PixelConverter& converter,
+				unsigned int target_width,
+				unsigned int target_height,
+				ResampleFilter filter,
+				uint8_t* pixels,
+				size_t stride)
+			{
+				const int components = bytesPerPixel(converter.getSource());
+				AccumulatingResampler resampler(
+					width,
+					height,
+					target_width,
+					target_height,
+					components,
+					filter);
+
+				std::vector<uint8_t> row((size_t)width * components);
+				for (int pass = 0; pass < passes; ++pass)
+				{
+					const bool empty_pass = PNG_PASS_COLS(width, pass) == 0;
+					for (png_uint_32 y = 0; y < height; ++y)
+					{
+						if (empty_pass || !PNG_ROW_IN_INTERLACE_PASS(y, pass))
+						{
+							// libpng still expects the call, it returns early
+							png_read_row(png_ptr, nullptr, nullptr);
+							continue;
+						}
+
+						memset(row.data(), 0, row.size());
+						png_read_row(png_ptr, row.data(), nullptr);
+						resampler.addRow(row.data(), y);
+					}
+				}
+
+				std::vector<uint8_t> resampled_row((size_t)target_width * components);
+				for (unsigned int y = 0; y < target_height; ++y)
+				{
+					uint8_t* destination = pixels + y * stride;
+					uint8_t* resampled = getDecodedRow(converter, destination, resampled_row);
+					resampler.readRow(y, resampled);
+					converter.convertRow(resampled, destination, target_width);
+				}
+			}
+
+			/**
+			 * Box reduces the rows as they are decoded and resamples the
+			 * reduced rows to target size. Interlaced images have all passes
+			 * summed before the reduced rows are resampled.
+			 */
+			static void readReducedRows(
+				png_structp png_ptr,
+				png_uint_32 width,
+				png_uint_32 height,
+				int passes,
+				const PixelConverter& converter,
+				uint32_t factor,
+				unsigned int target_width,
+				unsigned int target_height,
+				ResampleFilter filter,
+				uint8_t* pixels,
+				size_t stride)
+			{
+				const int components = bytesPerPixel(converter.getSource());
+				BoxReducer reducer(
+					width,
+					height,
+					components,
+					factor,
+					passes == 1 ? 1 : (height + factor - 1) / factor);
+				RowResampler resampler(
+					reducer.getReducedWidth(),
+					reducer.getReducedHeight(),
+					target_width,
+					target_height,
+					components,
+					filter);
+
+				std::vector<uint8_t> row((size_t)width * components);
+				std::vector<uint8_t> reduced_row((size_t)reducer.getReducedWidth() * components);
+				std::vector<uint8_t> resampled_row((size_t)target_width * components);
+				unsigned int output_row = 0;
+				const auto pushReducedRow = [&](uint32_t reduced_y)
+				{
+					reducer.readRow(reduced_y, reduced_row.data());
+					resampler.pushRow(reduced_row.data());
+					while (resampler.hasOutputRow())
+					{
+						uint8_t* destination = pixels + output_row * stride;
+						uint8_t* resampled = getDecodedRow(converter, destination, resampled_row);
+						resampler.readRow(resampled);
+						converter.convertRow(resampled, destination, target_width);
+						++output_row;
+					}
+				};
+
+				if (passes == 1)
+				{
+					for (png_uint_32 y = 0; y < height; ++y)
+					{
+						png_read_row(png_ptr, row.data(), nullptr);
+						reducer.addRow(row.data(), y, 0, 1);
+						if (reducer.completesRow(y))
+						{
+							pushReducedRow(y / factor);
+						}
+					}
+
+					return;
+				}
+
+				for (int pass = 0; pass < passes; ++pass)
+				{
+					const bool empty_pass = PNG_PASS_COLS(width, pass) == 0;
+					for (png_uint_32 y = 0; y < height; ++y)
+					{
+						if (empty_pass || !PNG_ROW_IN_INTERLACE_PASS(y, pass))
+						{
+							png_read_row(png_ptr, nullptr, nullptr);
+							continue;
+						}
+
+						png_read_row(png_ptr, row.data(), nullptr);
+						reducer.addRow(
+							row.data(),
+							y,
+							PNG_PASS_START_COL(pass),
+							1 << PNG_PASS_COL_SHIFT(pass));
+					}
+				}
+
+				for (uint32_t y = 0; y < reducer.getReducedHeight(); ++y)
+				{
+					pushReducedRow(y);
+				}
+			}
+
+			void getPngDecodeSize(
+				const uint8_t* data,
+				size_t length,
+				const TargetSize& target_size,
+				unsigned int& width,
+				unsigned int& height)
+			{
+				PngReadLease lease(data, length);
+				png_read_info(lease.getPng(), lease.getInfo());
+				computeDecodeSize(
+					png_get_image_width(lease.getPng(), lease.getInfo()),
+					png_get_image_height(lease.getPng(), lease.getInfo()),
+					target_size,
+					width,
+					height);
+			}
+
+			void decodePng(
+				const uint8_t* data,
+				size_t length,
+				const TargetSize& target_size,
+				PixelFormat pixel_format,
+				uint8_t* pixels,
+				size_t stride,
+				size_t capacity)
+			{
+				THROW_AND_RETURN_IF(pixels == nullptr, "pixels cannot be null");
+				const PixelConverter converter(getDecodedPixelFormat(pixel_format), pixel_format);
+
+				PngReadLease lease(data, length);
+				const int passes = readHeader(lease, converter.getSource());
+
+				png_structp png_ptr = lease.getPng();
+				const png_uint_32 image_width = png_get_image_width(png_ptr, lease.getInfo());
+				const png_uint_32 image_height = png_get_image_height(png_ptr, lease.getInfo());
+				unsigned int width = 0;
+				unsigned int height = 0;
+				computeDecodeSize(image_width, image_height, target_size, width, height);
+
+				THROW_AND_RETURN_IF(
+					stride < (size_t)width * bytesPerPixel(pixel_format),
+					"stride is too small for the decoded rows");
+				THROW_AND_RETURN_IF(
+					capacity < stride * (height - 1) + (size_t)width * bytesPerPixel(pixel_format),
+					"output buffer is too small for the decoded image");
+
+				const uint32_t factor = computeReductionFactor(image_width, image_height, width, height);
+				if (width == image_width && height == image_height)
+				{
+					readRows(png_ptr, image_width, image_height, passes, converter, pixels, stride);
+				}
+				else if (factor > 1)
+				{
+					readReducedRows(
+						png_ptr,
+						image_width,
+						image_height,
+						passes,
+						converter,
+						factor,
+						width,
+						height,
+						target_size.getFilter(),
+						pixels,
+						stride);
+				}
+				else if (passes == 1)
+				{
+					readResampledRows(
+						png_ptr,
+						image_width,
+						image_height,
+						converter,
+						width,
+						height,
+						target_size.getFilter(),
+						pixels,
+						stride);
+				}
+				else
+				{
+					readResampledPasses(
+						png_ptr,
+						image_width,
+						image_height,
+						passes,
+						converter,
+						width,
+						height,
+						target_size.getFilter(),
+						pixels,
+						stride);
+				}
+
+				// The chunks after the image data are of no interest
+			}
+
+			std::unique_ptr<DecodedImage> decodePng(
+				const uint8_t* data,
+				size_t length,
+				const TargetSize& target_size,
+				PixelFormat pixel_format)
+			{
+				unsigned int width = 0;
+				unsigned int height = 0;
+				getPngDecodeSize(data, length, target_size, width, height);
+
+				const size_t stride = computeStride(pixel_format, width, kRowAlignment);
+				const size_t capacity = stride * height;
+				pixels_t pixels = PixelBufferPool::getInstance().lease(capacity);
+				decodePng(data, length, target_size, pixel_format, pixels.get(), stride, capacity);
+
+				std::unique_ptr<DecodedImage> decoded_image(new DecodedImage(
+					std::move(pixels),
+					pixel_format,
+					width,
+					height,
+					(unsigned int)stride,
+					std::vector<uint8_t>()));
+
+				return decoded_image;
+			}
+		}
+	}
+}
+
+#endif // HAS_LIBPNG
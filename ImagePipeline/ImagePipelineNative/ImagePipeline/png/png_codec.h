@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef _PNG_CODEC_H_
+#define _PNG_CODEC_H_
+
+#include <memory>
+
+#include "decoded_image.h"
+#include "transformations.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace png
+		{
+			/**
+			 * Reads the header of a png image and computes the dimensions
+			 * of the image decoded at given target size.
+			 *
+			 * <p> Images are never upscaled, a target larger than the image
+			 * in either dimension keeps the dimensions of the image.
+			 *
+			 * @param data pointer to encoded png
+			 * @param length number of encoded bytes
+			 * @param target_size size to scale to, empty to keep the
+			 *        dimensions of the image
+			 * @param width receives decoded width
+			 * @param height receives decoded height
+			 */
+			void getPngDecodeSize(
+				const uint8_t* data,
+				size_t length,
+				const TargetSize& target_size,
+				unsigned int& width,
+				unsigned int& height);
+
+			/**
+			 * Decodes png of any bit depth and color type into caller
+			 * provided memory, 16-bit samples are scaled to 8 bits.
+			 *
+			 * <p> Rows are decoded one at a time. When scaling, each one goes
+			 * through the resampler as soon as it is decoded and output rows
+			 * are written to pixels + y * stride once complete. Large
+			 * reductions first average blocks of pixels, so the resampler
+			 * filter stays short. Interlaced images are resampled
+			 * pass by pass. Either way the full size image is never
+			 * allocated.
+			 *
+			 * @param data pointer to encoded png
+			 * @param length number of encoded bytes
+			 * @param target_size size to scale to, see getPngDecodeSize
+			 * @param pixel_format format of decoded pixels, alpha is dropped
+			 *        by RGB
+			 * @param pixels destination buffer
+			 * @param stride distance in bytes between starts of two rows
+			 * @param capacity size of destination buffer in bytes
+			 */
+			void decodePng(
+				const uint8_t* data,
+				size_t length,
+				const TargetSize& target_size,
+				PixelFormat pixel_format,
+				uint8_t* pixels,
+				size_t stride,
+				size_t capacity);
+
+			/**
+			 * Decodes png into newly allocated DecodedImage, rows aligned
+			 * to kRowAlignment in a buffer leased from PixelBufferPool.
+			 *
+			 * @param data pointer to encoded png
+			 * @param length number of encoded bytes
+			 * @param target_size size to scale to, see getPngDecodeSize
+			 * @param pixel_format format of decoded pixels
+			 */
+			std::unique_ptr<DecodedImage> decodePng(
+				const uint8_t* data,
+				size_t length,
+				const TargetSize& target_size,
+				PixelFormat pixel_format);
+		}
+	}
+}
+
+#endif // _PNG_CODEC_H_
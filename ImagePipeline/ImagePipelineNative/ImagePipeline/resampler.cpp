@@ -0,0 +1,520 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+#include "resampler.h"
+#include "exceptions.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RESAMPLER_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM) || defined(_M_ARM64)
+#define RESAMPLER_USE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		static const double kPi = 3.14159265358979323846;
+
+		/**
+		 * Returns the radius of given filter at scale 1.
+		 */
+		static double getFilterSupport(ResampleFilter filter)
+		{
+			switch (filter)
+			{
+				case ResampleFilter::BOX:
+				return 0.5;
+
+				case ResampleFilter::BILINEAR:
+				return 1.0;
+
+				case ResampleFilter::LANCZOS3:
+				default:
+				return 3.0;
+			}
+		}
+
+		static double sinc(double x)
+		{
+			if (x == 0.0)
+			{
+				return 1.0;
+			}
+
+			x *= kPi;
+			return std::sin(x) / x;
+		}
+
+		/**
+		 * Evaluates given filter at distance x from the sample center.
+		 */
+		static double getFilterWeight(ResampleFilter filter, double x)
+		{
+			switch (filter)
+			{
+				case ResampleFilter::BOX:
+				return (x >= -0.5 && x < 0.5) ? 1.0 : 0.0;
+
+				case ResampleFilter::BILINEAR:
+				x = std::fabs(x);
+				return x < 1.0 ? 1.0 - x : 0.0;
+
+				case ResampleFilter::LANCZOS3:
+				default:
+				x = std::fabs(x);
+				return x < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+			}
+		}
+
+		ResampleTaps::ResampleTaps(
+			uint32_t src_size,
+			uint32_t dst_size,
+			ResampleFilter filter) :
+				stride_(0),
+				max_count_(0)
+		{
+			THROW_AND_RETURN_IF(
+				src_size == 0 || dst_size == 0,
+				"Resampler dimensions must be positive");
+
+			const double scale = (double)src_size / dst_size;
+			const double filter_scale = std::max(scale, 1.0);
+			const double support = getFilterSupport(filter) * filter_scale;
+			const uint32_t stride = (uint32_t)std::ceil(support) * 2 + 1;
+
+			spans_.resize(dst_size);
+			weights_.assign((size_t)dst_size * stride, 0.0f);
+			stride_ = stride;
+			std::vector<double> row_weights(stride);
+			for (uint32_t i = 0; i < dst_size; ++i)
+			{
+				const double center = (i + 0.5) * scale;
+				const int64_t first = std::max<int64_t>(
+					(int64_t)std::floor(center - support + 0.5), 0);
+				const int64_t last = std::min<int64_t>(
+					(int64_t)std::floor(center + support + 0.5), src_size);
+				const uint32_t count = (uint32_t)std::min<int64_t>(
+					std::max<int64_t>(last - first, 1),
+					stride);
+
+				double sum = 0.0;
+				for (uint32_t k = 0; k < count; ++k)
+				{
+					row_weights[k] = getFilterWeight(
+						filter,
+						(first + k - center + 0.5) / filter_scale);
+					sum += row_weights[k];
+				}
+
+				float* out = &weights_[(size_t)i * stride];
+				for (uint32_t k = 0; k < count; ++k)
+				{
+					out[k] = (float)(sum != 0.0 ? row_weights[k] / sum : (k == 0 ? 1.0 : 0.0));
+				}
+
+				spans_[i].first = (uint32_t)first;
+				spans_[i].count = count;
+				max_count_ = std::max(max_count_, count);
+			}
+		}
+
+#if defined(RESAMPLER_USE_SSE2) || defined(RESAMPLER_USE_NEON)
+		/**
+		 * Filters a single row of 3 or 4 components horizontally into float
+		 * samples, one pixel per vector.
+		 *
+		 * <p> Samples are multiplied and added in the same order as in the
+		 * scalar loop, so the results are the same.
+		 */
+		template <uint32_t kComponents>
+		static void filterRowOfPixels(
+			const uint8_t* src,
+			float* dst,
+			uint32_t dst_width,
+			const ResampleTaps& taps)
+		{
+#ifdef RESAMPLER_USE_SSE2
+			const __m128i zero = _mm_setzero_si128();
+#endif
+			for (uint32_t x = 0; x < dst_width; ++x)
+			{
+				const uint8_t* in = src + (size_t)taps.getFirst(x) * kComponents;
+				const float* w = taps.getWeights(x);
+				const uint32_t count = taps.getCount(x);
+#ifdef RESAMPLER_USE_SSE2
+				__m128 acc = _mm_setzero_ps();
+				for (uint32_t k = 0; k < count; ++k)
+				{
+					uint32_t pixel = 0;
+					memcpy(&pixel, in + k * kComponents, kComponents);
+					const __m128i words = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)pixel), zero);
+					const __m128 samples = _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero));
+					acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), samples));
+				}
+
+				float samples[4];
+				_mm_storeu_ps(samples, acc);
+#else
+				float32x4_t acc = vdupq_n_f32(0.0f);
+				for (uint32_t k = 0; k < count; ++k)
+				{
+					uint32_t pixel = 0;
+					memcpy(&pixel, in + k * kComponents, kComponents);
+					const uint16x4_t words = vget_low_u16(vmovl_u8(vcreate_u8(pixel)));
+					const float32x4_t samples = vcvtq_f32_u32(vmovl_u16(words));
+					acc = vmlaq_f32(acc, vdupq_n_f32(w[k]), samples);
+				}
+
+				float samples[4];
+				vst1q_f32(samples, acc);
+#endif
+				memcpy(dst + (size_t)x * kComponents, samples, kComponents * sizeof(float));
+			}
+		}
+#endif
+
+		/**
+		 * Filters a single row horizontally into float samples.
+		 *
+		 * <p> The number of components is a template parameter for the common
+		 * RGB and RGBA layouts, so the inner loop gets fully unrolled.
+		 */
+		template <uint32_t kComponents>
+		static void filterRow(
+			const uint8_t* src,
+			float* dst,
+			uint32_t dst_width,
+			const ResampleTaps& taps)
+		{
+			for (uint32_t x = 0; x < dst_width; ++x)
+			{
+				const uint8_t* in = src + (size_t)taps.getFirst(x) * kComponents;
+				const float* w = taps.getWeights(x);
+				float acc[kComponents] = {};
+				for (uint32_t k = 0; k < taps.getCount(x); ++k)
+				{
+					for (uint32_t c = 0; c < kComponents; ++c)
+					{
+						acc[c] += w[k] * in[k * kComponents + c];
+					}
+				}
+
+				for (uint32_t c = 0; c < kComponents; ++c)
+				{
+					dst[x * kComponents + c] = acc[c];
+				}
+			}
+		}
+
+		static void filterRow(
+			const uint8_t* src,
+			float* dst,
+			uint32_t dst_width,
+			uint32_t components,
+			const ResampleTaps& taps)
+		{
+			for (uint32_t x = 0; x < dst_width; ++x)
+			{
+				const uint8_t* in = src + (size_t)taps.getFirst(x) * components;
+				const float* w = taps.getWeights(x);
+				for (uint32_t c = 0; c < components; ++c)
+				{
+					float acc = 0.0f;
+					for (uint32_t k = 0; k < taps.getCount(x); ++k)
+					{
+						acc += w[k] * in[k * components + c];
+					}
+
+					dst[x * components + c] = acc;
+				}
+			}
+		}
+
+		/**
+		 * Filters a single row horizontally, picking the vectorized or
+		 * unrolled loop for the common layouts.
+		 */
+		static void filterRowOfComponents(
+			const uint8_t* src,
+			float* dst,
+			uint32_t dst_width,
+			uint32_t components,
+			const ResampleTaps& taps)
+		{
+			switch (components)
+			{
+#if defined(RESAMPLER_USE_SSE2) || defined(RESAMPLER_USE_NEON)
+				case 3:
+				filterRowOfPixels<3>(src, dst, dst_width, taps);
+				break;
+
+				case 4:
+				filterRowOfPixels<4>(src, dst, dst_width, taps);
+				break;
+#else
+				case 3:
+				filterRow<3>(src, dst, dst_width, taps);
+				break;
+
+				case 4:
+				filterRow<4>(src, dst, dst_width, taps);
+				break;
+#endif
+
+				default:
+				filterRow(src, dst, dst_width, components, taps);
+				break;
+			}
+		}
+
+		/**
+		 * Rounds half up by truncating value + 0.5, the same way the vector
+		 * paths of combineRows do, then clamps to a byte.
+		 */
+		static uint8_t clampToByte(float value)
+		{
+			const int rounded = (int)(value + 0.5f);
+			return (uint8_t)std::min(std::max(rounded, 0), 255);
+		}
+
+		/**
+		 * Combines filtered rows with given weights into a row of bytes.
+		 *
+		 * <p> Every sample is computed the same way, which makes this pass the
+		 * one that vectorizes well, 4 samples at a time with SSE2 and 8 at a
+		 * time with NEON. The tail is done with scalar code. All of them
+		 * truncate value + 0.5, so a sample rounds the same whichever path
+		 * computes it.
+		 */
+		static void combineRows(
+			const float* const* rows,
+			const float* weights,
+			uint32_t count,
+			uint32_t length,
+			uint8_t* dst)
+		{
+			uint32_t i = 0;
+
+#ifdef RESAMPLER_USE_SSE2
+			const __m128 half = _mm_set1_ps(0.5f);
+			for (; i + 4 <= length; i += 4)
+			{
+				__m128 acc = _mm_setzero_ps();
+				for (uint32_t k = 0; k < count; ++k)
+				{
+					acc = _mm_add_ps(
+						acc,
+						_mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + i)));
+				}
+
+				// Conversion truncates, negative values end up clamped to 0 anyway.
+				const __m128i values = _mm_cvttps_epi32(_mm_add_ps(acc, half));
+				const __m128i words = _mm_packs_epi32(values, values);
+				const int bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+				memcpy(dst + i, &bytes, 4);
+			}
+#endif
+
+#ifdef RESAMPLER_USE_NEON
+			const float32x4_t half = vdupq_n_f32(0.5f);
+			for (; i + 8 <= length; i += 8)
+			{
+				float32x4_t acc_low = vdupq_n_f32(0.0f);
+				float32x4_t acc_high = vdupq_n_f32(0.0f);
+				for (uint32_t k = 0; k < count; ++k)
+				{
+					const float32x4_t weight = vdupq_n_f32(weights[k]);
+					acc_low = vmlaq_f32(acc_low, weight, vld1q_f32(rows[k] + i));
+					acc_high = vmlaq_f32(acc_high, weight, vld1q_f32(rows[k] + i + 4));
+				}
+
+				// Conversion truncates, negative values end up clamped to 0 anyway.
+				const int16x8_t words = vcombine_s16(
+					vqmovn_s32(vcvtq_s32_f32(vaddq_f32(acc_low, half))),
+					vqmovn_s32(vcvtq_s32_f32(vaddq_f32(acc_high, half))));
+				vst1_u8(dst + i, vqmovun_s16(words));
+			}
+#endif
+
+			for (; i < length; ++i)
+			{
+				float acc = 0.0f;
+				for (uint32_t k = 0; k < count; ++k)
+				{
+					acc += weights[k] * rows[k][i];
+				}
+
+				dst[i] = clampToByte(acc);
+			}
+		}
+
+		RowResampler::RowResampler(
+			uint32_t src_width,
+			uint32_t src_height,
+			uint32_t dst_width,
+			uint32_t dst_height,
+			uint32_t components,
+			ResampleFilter filter) :
+				src_width_(src_width),
+				src_height_(src_height),
+				dst_width_(dst_width),
+				dst_height_(dst_height),
+				components_(components),
+				horizontal_taps_(src_width, dst_width, filter),
+				vertical_taps_(src_height, dst_height, filter),
+				ring_size_(0),
+				pushed_rows_(0),
+				next_output_row_(0)
+		{
+			THROW_AND_RETURN_IF(
+				components == 0,
+				"Resampler needs at least one component");
+
+			// The ring holds the rows spanned by the widest vertical filter.
+			ring_size_ = vertical_taps_.getMaxCount();
+			ring_.resize((size_t)ring_size_ * dst_width * components);
+			rows_.resize(ring_size_);
+		}
+
+		void RowResampler::pushRow(const uint8_t* row)
+		{
+			THROW_AND_RETURN_IF(
+				hasOutputRow(),
+				"Pending output rows have to be read first");
+			THROW_AND_RETURN_IF(
+				pushed_rows_ >= src_height_,
+				"All source rows have been pushed already");
+
+			const size_t row_length = (size_t)dst_width_ * components_;
+			float* dst = &ring_[(pushed_rows_ % ring_size_) * row_length];
+			filterRowOfComponents(row, dst, dst_width_, components_, horizontal_taps_);
+
+			++pushed_rows_;
+		}
+
+		bool RowResampler::hasOutputRow() const
+		{
+			if (next_output_row_ >= dst_height_)
+			{
+				return false;
+			}
+
+			return pushed_rows_ >=
+				vertical_taps_.getFirst(next_output_row_) + vertical_taps_.getCount(next_output_row_);
+		}
+
+		void RowResampler::readRow(uint8_t* row)
+		{
+			THROW_AND_RETURN_IF(
+				!hasOutputRow(),
+				"No output row is ready");
+
+			const size_t row_length = (size_t)dst_width_ * components_;
+			const uint32_t first = vertical_taps_.getFirst(next_output_row_);
+			const uint32_t count = vertical_taps_.getCount(next_output_row_);
+			for (uint32_t k = 0; k < count; ++k)
+			{
+				rows_[k] = &ring_[((first + k) % ring_size_) * row_length];
+			}
+
+			combineRows(
+				rows_.data(),
+				vertical_taps_.getWeights(next_output_row_),
+				count,
+				(uint32_t)row_length,
+				row);
+			++next_output_row_;
+		}
+
+		AccumulatingResampler::AccumulatingResampler(
+			uint32_t src_width,
+			uint32_t src_height,
+			uint32_t dst_width,
+			uint32_t dst_height,
+			uint32_t components,
+			ResampleFilter filter) :
+				src_width_(src_width),
+				src_height_(src_height),
+				dst_width_(dst_width),
+				dst_height_(dst_height),
+				components_(components),
+				horizontal_taps_(src_width, dst_width, filter),
+				vertical_taps_(src_height, dst_height, filter)
+		{
+			THROW_AND_RETURN_IF(
+				components == 0,
+				"Resampler needs at least one component");
+
+			// Taps only move forward, so the output rows a source row
+			// contributes to start where the previous ones did.
+			first_output_rows_.resize(src_height);
+			uint32_t output_row = 0;
+			for (uint32_t y = 0; y < src_height; ++y)
+			{
+				while (output_row < dst_height &&
+					vertical_taps_.getFirst(output_row) + vertical_taps_.getCount(output_row) <= y)
+				{
+					++output_row;
+				}
+
+				first_output_rows_[y] = output_row;
+			}
+
+			const size_t row_length = (size_t)dst_width * components;
+			filtered_.resize(row_length);
+			accumulator_.assign(row_length * dst_height, 0.0f);
+		}
+
+		void AccumulatingResampler::addRow(const uint8_t* row, uint32_t y)
+		{
+			THROW_AND_RETURN_IF(y >= src_height_, "Source row is out of bounds");
+
+			const size_t row_length = (size_t)dst_width_ * components_;
+			float* const filtered = filtered_.data();
+			filterRowOfComponents(row, filtered, dst_width_, components_, horizontal_taps_);
+
+			for (uint32_t output_row = first_output_rows_[y];
+				output_row < dst_height_ && vertical_taps_.getFirst(output_row) <= y;
+				++output_row)
+			{
+				const uint32_t first = vertical_taps_.getFirst(output_row);
+				if (y >= first + vertical_taps_.getCount(output_row))
+				{
+					continue;
+				}
+
+				const float weight = vertical_taps_.getWeights(output_row)[y - first];
+				float* const dst = &accumulator_[output_row * row_length];
+				for (size_t i = 0; i < row_length; ++i)
+				{
+					dst[i] += weight * filtered[i];
+				}
+			}
+		}
+
+		void AccumulatingResampler::readRow(uint32_t y, uint8_t* row) const
+		{
+			THROW_AND_RETURN_IF(y >= dst_height_, "Output row is out of bounds");
+
+			const size_t row_length = (size_t)dst_width_ * components_;
+			const float* rows[] = { &accumulator_[y * row_length] };
+			const float weights[] = { 1.0f };
+			combineRows(rows, weights, 1, (uint32_t)row_length, row);
+		}
+	}
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef _RESAMPLER_H_
+#define _RESAMPLER_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "transformations.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		/**
+		 * Normalized filter taps mapping src_size samples onto dst_size
+		 * samples along one axis, shared by both resamplers.
+		 *
+		 * <p> When downscaling the filter is stretched by the scale, so every
+		 * source sample contributes to the output.
+		 */
+		class ResampleTaps
+		{
+		private:
+			/**
+			 * Taps of a single output sample, spanning count source samples
+			 * starting at first.
+			 */
+			struct Span
+			{
+				uint32_t first;
+				uint32_t count;
+			};
+
+			std::vector<Span> spans_;
+			std::vector<float> weights_;
+			uint32_t stride_;
+			uint32_t max_count_;
+
+		public:
+			ResampleTaps(uint32_t src_size, uint32_t dst_size, ResampleFilter filter);
+
+			uint32_t getFirst(uint32_t i) const
+			{
+				return spans_[i].first;
+			}
+
+			uint32_t getCount(uint32_t i) const
+			{
+				return spans_[i].count;
+			}
+
+			/**
+			 * Returns the getCount(i) weights of output sample i.
+			 */
+			const float* getWeights(uint32_t i) const
+			{
+				return &weights_[(size_t)i * stride_];
+			}
+
+			/**
+			 * Returns the largest number of taps of any output sample.
+			 */
+			uint32_t getMaxCount() const
+			{
+				return max_count_;
+			}
+		};
+
+		/**
+		 * Separable resampler working on a stream of rows.
+		 *
+		 * <p> Source rows are pushed one at a time and filtered horizontally
+		 * straight away. Only as many filtered rows as the vertical filter
+		 * spans are kept, so the full frame is never held in memory. After
+		 * each pushed row all output rows that became ready have to be read
+		 * before the next row is pushed.
+		 *
+		 * <p> Samples are interleaved 8-bit components, e.g. RGB or RGBA.
+		 */
+		class RowResampler
+		{
+		private:
+			const uint32_t src_width_;
+			const uint32_t src_height_;
+			const uint32_t dst_width_;
+			const uint32_t dst_height_;
+			const uint32_t components_;
+
+			const ResampleTaps horizontal_taps_;
+			const ResampleTaps vertical_taps_;
+
+			std::vector<float> ring_;
+			std::vector<const float*> rows_;
+			uint32_t ring_size_;
+			uint32_t pushed_rows_;
+			uint32_t next_output_row_;
+
+		public:
+			RowResampler(
+				uint32_t src_width,
+				uint32_t src_height,
+				uint32_t dst_width,
+				uint32_t dst_height,
+				uint32_t components,
+				ResampleFilter filter);
+
+			// Disallow copying
+			RowResampler(const RowResampler& other) = delete;
+
+			RowResampler& operator=(const RowResampler& other) = delete;
+
+			/**
+			 * Feeds the next source row of src_width * components samples.
+			 */
+			void pushRow(const uint8_t* row);
+
+			/**
+			 * Returns true if the next output row can be read.
+			 */
+			bool hasOutputRow() const;
+
+			/**
+			 * Writes the next output row of dst_width * components samples.
+			 */
+			void readRow(uint8_t* row);
+
+			uint32_t getOutputWidth() const
+			{
+				return dst_width_;
+			}
+
+			uint32_t getOutputHeight() const
+			{
+				return dst_height_;
+			}
+		};
+
+		/**
+		 * Separable resampler for sources whose rows arrive in several
+		 * partial passes, e.g. Adam7 interlaced png.
+		 *
+		 * <p> Every pass row has the missing pixels set to zero. Filtering is
+		 * linear, so the filtered pass rows add up to the filtered image. Each
+		 * one is filtered horizontally and added to all output rows it
+		 * contributes to straight away, only the output is held in memory.
+		 * Output rows can be read once all rows have been added.
+		 */
+		class AccumulatingResampler
+		{
+		private:
+			const uint32_t src_width_;
+			const uint32_t src_height_;
+			const uint32_t dst_width_;
+			const uint32_t dst_height_;
+			const uint32_t components_;
+
+			const ResampleTaps horizontal_taps_;
+			const ResampleTaps vertical_taps_;
+
+			// First output row each source row contributes to
+			std::vector<uint32_t> first_output_rows_;
+			std::vector<float> filtered_;
+			std::vector<float> accumulator_;
+
+		public:
+			AccumulatingResampler(
+				uint32_t src_width,
+				uint32_t src_height,
+				uint32_t dst_width,
+				uint32_t dst_height,
+				uint32_t components,
+				ResampleFilter filter);
+
+			// Disallow copying
+			AccumulatingResampler(const AccumulatingResampler& other) = delete;
+
+			AccumulatingResampler& operator=(const AccumulatingResampler& other) = delete;
+
+			/**
+			 * Adds source row y of src_width * components samples, rows may
+			 * be added in any order and more than once.
+			 */
+			void addRow(const uint8_t* row, uint32_t y);
+
+			/**
+			 * Writes output row y of dst_width * components samples.
+			 */
+			void readRow(uint32_t y, uint8_t* row) const;
+
+			uint32_t getOutputWidth() const
+			{
+				return dst_width_;
+			}
+
+			uint32_t getOutputHeight() const
+			{
+				return dst_height_;
+			}
+		};
+	}
+}
+
+#endif // _RESAMPLER_H_
@@ -32,6 +32,17 @@ namespace facebook
 		 */
 		RotationType getRotationTypeFromDegrees(uint16_t degrees);
 
+		/**
+		 * Filters used to resample to a target size, values match
+		 * ResampleFilter in ResampleFilter.cs.
+		 */
+		enum class ResampleFilter
+		{
+			LANCZOS3 = 0,
+			BILINEAR = 1,
+			BOX = 2
+		};
+
 		/**
 		 * Scale factor to be used for resizing.
 		 */
@@ -72,6 +83,102 @@ namespace facebook
 				return (dimension * numerator_) / denominator_;
 			}
 		};
+
+		/**
+		 * Rectangle of the source image to be decoded, in pixels of the
+		 * encoded image. An empty region stands for the whole image.
+		 */
+		class CropRegion
+		{
+		private:
+			const uint32_t x_;
+			const uint32_t y_;
+			const uint32_t width_;
+			const uint32_t height_;
+
+		public:
+			CropRegion()
+				: x_(0), y_(0), width_(0), height_(0)
+			{
+			}
+
+			CropRegion(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+				: x_(x), y_(y), width_(width), height_(height)
+			{
+			}
+
+			uint32_t getX() const
+			{
+				return x_;
+			}
+
+			uint32_t getY() const
+			{
+				return y_;
+			}
+
+			uint32_t getWidth() const
+			{
+				return width_;
+			}
+
+			uint32_t getHeight() const
+			{
+				return height_;
+			}
+
+			bool isEmpty() const
+			{
+				return width_ == 0 || height_ == 0;
+			}
+		};
+
+		/**
+		 * Exact dimensions of the output, before rotation, and the filter
+		 * resampling to them. An empty size keeps the dimensions reached by
+		 * the scale factor.
+		 */
+		class TargetSize
+		{
+		private:
+			const uint32_t width_;
+			const uint32_t height_;
+			const ResampleFilter filter_;
+
+		public:
+			TargetSize()
+				: width_(0), height_(0), filter_(ResampleFilter::LANCZOS3)
+			{
+			}
+
+			TargetSize(
+				uint32_t width,
+				uint32_t height,
+				ResampleFilter filter = ResampleFilter::LANCZOS3)
+				: width_(width), height_(height), filter_(filter)
+			{
+			}
+
+			uint32_t getWidth() const
+			{
+				return width_;
+			}
+
+			uint32_t getHeight() const
+			{
+				return height_;
+			}
+
+			ResampleFilter getFilter() const
+			{
+				return filter_;
+			}
+
+			bool isEmpty() const
+			{
+				return width_ == 0 || height_ == 0;
+			}
+		};
 	}
 }
 
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifdef HAS_LIBWEBP
+
+#include <algorithm>
+#include <memory>
+
+#include <webp/decode.h>
+
+#include "decoded_image.h"
+#include "exceptions.h"
+#include "pixel_conversion.h"
+#include "transformations.h"
+#include "webp_codec.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace webp
+		{
+			/**
+			 * Number of encoded bytes WebpRowDecoder hands to libwebp at a
+			 * time. Every chunk completes a few rows of a typical image.
+			 */
+			static const size_t kInputChunkSize = 16 * 1024;
+
+			/**
+			 * Returns the message describing a libwebp status code.
+			 */
+			static const char* getStatusMessage(VP8StatusCode status)
+			{
+				switch (status)
+				{
+				case VP8_STATUS_OUT_OF_MEMORY:
+					return "out of memory while decoding webp";
+
+				case VP8_STATUS_INVALID_PARAM:
+					return "invalid webp decode parameters";
+
+				case VP8_STATUS_UNSUPPORTED_FEATURE:
+					return "unsupported webp feature";
+
+				case VP8_STATUS_NOT_ENOUGH_DATA:
+					return "webp data is incomplete";
+
+				default:
+					return "invalid webp bitstream";
+				}
+			}
+
+			/**
+			 * Returns the pixel format libwebp writes when decoding to given
+			 * pixel format, rows are converted if the two differ.
+			 *
+			 * <p> libwebp has no gray output and writes RGB565 big endian.
+			 */
+			static PixelFormat getDecodedPixelFormat(PixelFormat pixel_format)
+			{
+				switch (pixel_format)
+				{
+				case PixelFormat::RGB565:
+				case PixelFormat::GRAY:
+					return PixelFormat::RGB;
+
+				case PixelFormat::GRAY_ALPHA:
+					return PixelFormat::RGBA;
+
+				default:
+					return pixel_format;
+				}
+			}
+
+			/**
+			 * Returns the libwebp colorspace writing pixels of given format.
+			 */
+			static WEBP_CSP_MODE getColorspace(PixelFormat pixel_format)
+			{
+				switch (pixel_format)
+				{
+				case PixelFormat::RGBA:
+					return MODE_RGBA;
+
+				case PixelFormat::BGRA:
+					return MODE_BGRA;
+
+				case PixelFormat::BGRA_PREMULTIPLIED:
+					return MODE_bgrA;
+
+				case PixelFormat::RGB:
+				default:
+					return MODE_RGB;
+				}
+			}
+
+			/**
+			 * Decodes into memory laid out as libwebp colorspace requires.
+			 */
+			static VP8StatusCode decodeInto(
+				const uint8_t* data,
+				size_t length,
+				PixelFormat pixel_format,
+				uint8_t* pixels,
+				size_t stride,
+				size_t capacity,
+				WebPDecoderConfig& config)
+			{
+				config.output.colorspace = getColorspace(pixel_format);
+				config.output.is_external_memory = 1;
+				config.output.u.RGBA.rgba = pixels;
+				config.output.u.RGBA.stride = (int)stride;
+				config.output.u.RGBA.size = capacity;
+
+				VP8StatusCode status = WebPDecode(data, length, &config);
+				WebPFreeDecBuffer(&config.output);
+				return status;
+			}
+
+			/**
+			 * Reads the features of the bitstream and the decode size into
+			 * config.
+			 */
+			static void initDecoderConfig(
+				const uint8_t* data,
+				size_t length,
+				const TargetSize& target_size,
+				WebPDecoderConfig& config)
+			{
+				THROW_AND_RETURN_IF(data == nullptr, "webp data cannot be null");
+				THROW_AND_RETURN_IF(!WebPInitDecoderConfig(&config), "incompatible libwebp version");
+
+				VP8StatusCode status = WebPGetFeatures(data, length, &config.input);
+				THROW_AND_RETURN_IF(status != VP8_STATUS_OK, getStatusMessage(status));
+				THROW_AND_RETURN_IF(
+					config.input.has_animation,
+					"animated webp has to be decoded frame by frame");
+
+				if (!target_size.isEmpty() &&
+					target_size.getWidth() <= (uint32_t)config.input.width &&
+					target_size.getHeight() <= (uint32_t)config.input.height &&
+					(target_size.getWidth() < (uint32_t)config.input.width ||
+						target_size.getHeight() < (uint32_t)config.input.height))
+				{
+					config.options.use_scaling = 1;
+					config.options.scaled_width = (int)target_size.getWidth();
+					config.options.scaled_height = (int)target_size.getHeight();
+				}
+			}
+
+			void getWebpDecodeSize(
+				const uint8_t* data,
+				size_t length,
+				const TargetSize& target_size,
+				unsigned int& width,
+				unsigned int& height)
+			{
+				WebPDecoderConfig config;
+				initDecoderConfig(data, length, target_size, config);
+				if (config.options.use_scaling)
+				{
+					width = (unsigned int)config.options.scaled_width;
+					height = (unsigned int)config.options.scaled_height;
+				}
+				else
+				{
+					width = (unsigned int)config.input.width;
+					height = (unsigned int)config.input.height;
+				}
+			}
+
+			/**
+			 * Checks that the caller's buffer holds an image of given size.
+			 */
+			static void checkOutputBuffer(
+				size_t width,
+				size_t height,
+				PixelFormat pixel_format,
+				size_t stride,
+				size_t capacity)
+			{
+				THROW_AND_RETURN_IF(
+					stride < width * bytesPerPixel(pixel_format),
+					"stride is too small for the decoded rows");
+				THROW_AND_RETURN_IF(
+					capacity < stride * (height - 1) + width * bytesPerPixel(pixel_format),
+					"output buffer is too small for the decoded image");
+			}
+
+			void decodeWebp(
+				const uint8_t* data,
+				size_t length,
+				const TargetSize& target_size,
+				PixelFormat pixel_format,
+				uint8_t* pixels,
+				size_t stride,
+				size_t capacity)
+			{
+				THROW_AND_RETURN_IF(pixels == nullptr, "pixels cannot be null");
+				const PixelConverter converter(getDecodedPixelFormat(pixel_format), pixel_format);
+
+				if (!converter.isIdentity())
+				{
+					// Formats libwebp cannot write are converted a row at a time
+					WebpRowDecoder decoder(data, length, target_size, converter.getSource());
+					checkOutputBuffer(
+						decoder.getWidth(), decoder.getHeight(), pixel_format, stride, capacity);
+					for (uint32_t y = 0; y < decoder.getHeight(); y++)
+					{
+						converter.convertRow(decoder.readRow(), pixels + y * stride, decoder.getWidth());
+					}
+
+					return;
+				}
+
+				WebPDecoderConfig config;
+				initDecoderConfig(data, length, target_size, config);
+				checkOutputBuffer(
+					config.options.use_scaling ? config.options.scaled_width : config.input.width,
+					config.options.use_scaling ? config.options.scaled_height : config.input.height,
+					pixel_format,
+					stride,
+					capacity);
+
+				// libwebp writes the rows straight into the caller's memory
+				VP8StatusCode status = decodeInto(
+					data, length, pixel_format, pixels, stride, capacity, config);
+				THROW_AND_RETURN_IF(status != VP8_STATUS_OK, getStatusMessage(status));
+			}
+
+			WebpRowDecoder::WebpRowDecoder(
+				const uint8_t* data,
+				size_t length,
+				const TargetSize& target_size,
+				PixelFormat pixel_format) :
+					data_(data),
+					length_(length),
+					fed_length_(0),
+					config_(new WebPDecoderConfig()),
+					decoder_(nullptr),
+					width_(0),
+					height_(0),
+					rows_(nullptr),
+					stride_(0),
+					decoded_rows_(0),
+					next_row_(0)
+			{
+				THROW_AND_RETURN_IF(
+					getDecodedPixelFormat(pixel_format) != pixel_format,
+					"libwebp cannot decode to this pixel format");
+
+				initDecoderConfig(data, length, target_size, *config_);
+				width_ = (uint32_t)(config_->options.use_scaling ?
+					config_->options.scaled_width : config_->input.width);
+				height_ = (uint32_t)(config_->options.use_scaling ?
+					config_->options.scaled_height : config_->input.height);
+
+				config_->output.colorspace = getColorspace(pixel_format);
+				decoder_ = WebPIDecode(data, length, config_.get());
+				THROW_AND_RETURN_IF(decoder_ == nullptr, "could not create webp decoder");
+			}
+
+			WebpRowDecoder::~WebpRowDecoder()
+			{
+				if (decoder_ != nullptr)
+				{
+					WebPIDelete(decoder_);
+				}
+
+				WebPFreeDecBuffer(&config_->output);
+			}
+
+			const uint8_t* WebpRowDecoder::readRow()
+			{
+				THROW_AND_RETURNVAL_IF(next_row_ >= height_, "all rows have been read", nullptr);
+
+				while (next_row_ >= decoded_rows_)
+				{
+					THROW_AND_RETURNVAL_IF(
+						fed_length_ == length_,
+						getStatusMessage(VP8_STATUS_NOT_ENOUGH_DATA),
+						nullptr);
+
+					// libwebp reads the bytes in place, each update sees more of them
+					fed_length_ = std::min(length_, fed_length_ + kInputChunkSize);
+					VP8StatusCode status = WebPIUpdate(decoder_, data_, fed_length_);
+					THROW_AND_RETURNVAL_IF(
+						status != VP8_STATUS_OK && status != VP8_STATUS_SUSPENDED,
+						getStatusMessage(status),
+						nullptr);
+
+					int last_row = 0;
+					rows_ = WebPIDecGetRGB(decoder_, &last_row, nullptr, nullptr, &stride_);
+					decoded_rows_ = (rows_ != nullptr) ? (uint32_t)last_row : 0;
+				}
+
+				return rows_ + (size_t)next_row_++ * stride_;
+			}
+		}
+	}
+}
+
+#endif // HAS_LIBWEBP
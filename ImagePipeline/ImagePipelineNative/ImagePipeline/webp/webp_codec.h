@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef _WEBP_CODEC_H_
+#define _WEBP_CODEC_H_
+
+#include <memory>
+
+#include "decoded_image.h"
+#include "transformations.h"
+
+struct WebPDecoderConfig;
+struct WebPIDecoder;
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		namespace webp
+		{
+			/**
+			 * Reads the header of a webp image and computes the dimensions
+			 * of the image decoded at given target size.
+			 *
+			 * <p> Images are never upscaled, a target larger than the image
+			 * in either dimension keeps the dimensions of the image.
+			 *
+			 * @param data pointer to encoded webp
+			 * @param length number of encoded bytes
+			 * @param target_size size to scale to, empty to keep the
+			 *        dimensions of the image
+			 * @param width receives decoded width
+			 * @param height receives decoded height
+			 */
+			void getWebpDecodeSize(
+				const uint8_t* data,
+				size_t length,
+				const TargetSize& target_size,
+				unsigned int& width,
+				unsigned int& height);
+
+			/**
+			 * Decodes lossy, lossless or alpha webp into caller provided
+			 * memory.
+			 *
+			 * <p> Rows are written directly into the buffer, row y starting at
+			 * pixels + y * stride. Scaling is done by libwebp while the rows
+			 * are reconstructed, the full size image is never allocated.
+			 * Formats libwebp cannot write, RGB565, GRAY and GRAY_ALPHA, are
+			 * converted from each row as soon as it is reconstructed.
+			 *
+			 * @param data pointer to encoded webp
+			 * @param length number of encoded bytes
+			 * @param target_size size to scale to, see getWebpDecodeSize
+			 * @param pixel_format format of decoded pixels, alpha is dropped
+			 *        by RGB
+			 * @param pixels destination buffer
+			 * @param stride distance in bytes between starts of two rows
+			 * @param capacity size of destination buffer in bytes
+			 */
+			void decodeWebp(
+				const uint8_t* data,
+				size_t length,
+				const TargetSize& target_size,
+				PixelFormat pixel_format,
+				uint8_t* pixels,
+				size_t stride,
+				size_t capacity);
+
+			/**
+			 * Decodes webp incrementally, row by row.
+			 *
+			 * <p> The encoded bytes are handed to libwebp a chunk at a time and
+			 * every row is read as soon as libwebp has reconstructed it, while
+			 * it is still in cache. libwebp holds the decoded rows in a frame
+			 * of its own, released with the decoder.
+			 */
+			class WebpRowDecoder
+			{
+			private:
+				const uint8_t* const data_;
+				const size_t length_;
+				size_t fed_length_;
+				std::unique_ptr<WebPDecoderConfig> config_;
+				WebPIDecoder* decoder_;
+				uint32_t width_;
+				uint32_t height_;
+				uint8_t* rows_;
+				int stride_;
+				uint32_t decoded_rows_;
+				uint32_t next_row_;
+
+			public:
+				/**
+				 * @param data pointer to encoded webp, kept until the decoder
+				 *        is destroyed
+				 * @param length number of encoded bytes
+				 * @param target_size size to scale to, see getWebpDecodeSize
+				 * @param pixel_format format of decoded pixels, one of those
+				 *        libwebp writes: RGB, RGBA, BGRA or BGRA_PREMULTIPLIED
+				 */
+				WebpRowDecoder(
+					const uint8_t* data,
+					size_t length,
+					const TargetSize& target_size,
+					PixelFormat pixel_format);
+
+				~WebpRowDecoder();
+
+				// Disallow copying
+				WebpRowDecoder(const WebpRowDecoder& other) = delete;
+
+				WebpRowDecoder& operator=(const WebpRowDecoder& other) = delete;
+
+				uint32_t getWidth() const
+				{
+					return width_;
+				}
+
+				uint32_t getHeight() const
+				{
+					return height_;
+				}
+
+				/**
+				 * Decodes as much as needed and returns the next row, valid
+				 * until the decoder is destroyed.
+				 */
+				const uint8_t* readRow();
+			};
+		}
+	}
+}
+
+#endif // _WEBP_CODEC_H_
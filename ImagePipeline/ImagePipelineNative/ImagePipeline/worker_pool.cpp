@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <algorithm>
+
+#include "worker_pool.h"
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		WorkerPool::WorkerPool(unsigned int threads) : stopped_(false)
+		{
+			threads = std::max(threads, 1u);
+			threads_.reserve(threads);
+			for (unsigned int i = 0; i < threads; ++i)
+			{
+				threads_.emplace_back(&WorkerPool::run, this);
+			}
+		}
+
+		WorkerPool::~WorkerPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				stopped_ = true;
+			}
+
+			has_tasks_.notify_all();
+			for (std::thread& thread : threads_)
+			{
+				thread.join();
+			}
+		}
+
+		void WorkerPool::submit(std::function<void()> task)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				tasks_.push_back(std::move(task));
+			}
+
+			has_tasks_.notify_one();
+		}
+
+		void WorkerPool::run()
+		{
+			while (true)
+			{
+				std::function<void()> task;
+				{
+					std::unique_lock<std::mutex> lock(mutex_);
+					has_tasks_.wait(lock, [this] { return stopped_ || !tasks_.empty(); });
+					if (tasks_.empty())
+					{
+						return;
+					}
+
+					task = std::move(tasks_.front());
+					tasks_.pop_front();
+				}
+
+				try
+				{
+					task();
+				}
+				catch (...)
+				{
+					// A failing task must not take the thread down.
+				}
+			}
+		}
+
+		WorkerPool& WorkerPool::getInstance()
+		{
+			// Never destroyed, joining threads while the dll unloads would
+			// deadlock on the loader lock.
+			static WorkerPool* instance =
+				new WorkerPool(std::thread::hardware_concurrency());
+			return *instance;
+		}
+	}
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef _WORKER_POOL_H_
+#define _WORKER_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace facebook
+{
+	namespace imagepipeline
+	{
+		/**
+		 * Fixed set of native threads running tasks in submission order.
+		 *
+		 * <p> Codec work submitted from managed code runs here instead of
+		 * blocking threads of the .NET thread pool, and nested work, like
+		 * decoding the bands of a jpeg, shares the same threads instead of
+		 * starting new ones.
+		 */
+		class WorkerPool
+		{
+		private:
+			std::mutex mutex_;
+			std::condition_variable has_tasks_;
+			std::deque<std::function<void()>> tasks_;
+			std::vector<std::thread> threads_;
+			bool stopped_;
+
+			void run();
+
+		public:
+			/**
+			 * Starts given number of threads, at least one.
+			 */
+			explicit WorkerPool(unsigned int threads);
+
+			/**
+			 * Waits for the queued tasks to finish and stops the threads.
+			 */
+			~WorkerPool();
+
+			WorkerPool(const WorkerPool&) = delete;
+			WorkerPool& operator=(const WorkerPool&) = delete;
+
+			/**
+			 * Queues task to run on one of the threads.
+			 *
+			 * <p> Exceptions thrown by the task are swallowed, tasks that
+			 * need to report errors have to catch them.
+			 */
+			void submit(std::function<void()> task);
+
+			unsigned int getThreadCount() const
+			{
+				return (unsigned int)threads_.size();
+			}
+
+			/**
+			 * Returns the pool shared by the whole library, with a thread per
+			 * hardware thread.
+			 */
+			static WorkerPool& getInstance();
+		};
+	}
+}
+
+#endif // _WORKER_POOL_H_
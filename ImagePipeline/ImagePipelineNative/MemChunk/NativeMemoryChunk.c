@@ -7,11 +7,19 @@
  * of patent rights can be found in the PATENTS file in the same directory.
  */
 
+#include <limits.h>
+
 #include "NativeMemoryChunk.h"
+#include "slab_allocator.h"
 
 int64_t nativeAllocate(int size)
 {
-	void* pointer = malloc(size);
+	if (size < 0)
+	{
+		return 0;
+	}
+
+	void* pointer = slabAllocate((size_t)size);
 	if (!pointer)
 	{
 		return 0;
@@ -22,7 +30,94 @@ int64_t nativeAllocate(int size)
 
 void nativeFree(int64_t lpointer)
 {
-	free(LONG_TO_PTR(lpointer));
+	slabFree(LONG_TO_PTR(lpointer));
+}
+
+void nativeTrimAllocator()
+{
+	slabTrim();
+}
+
+void nativeGetAllocatorStats(
+	int64_t* reservedBytes,
+	int64_t* usedBytes,
+	int64_t* cachedBytes,
+	int* arenaCount,
+	int* largeBlockCount)
+{
+	SlabStats stats;
+	slabGetStats(&stats);
+	*reservedBytes = stats.reservedBytes;
+	*usedBytes = stats.usedBytes;
+	*cachedBytes = stats.cachedBytes;
+	*arenaCount = stats.arenaCount;
+	*largeBlockCount = stats.largeBlockCount;
+}
+
+int64_t nativeMapFile(const wchar_t* path, int* size)
+{
+	*size = 0;
+
+	// Sharing deletes lets the disk cache evict the file while mapped
+	HANDLE file = CreateFile2(
+		path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, OPEN_EXISTING, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return 0;
+	}
+
+	void* view = NULL;
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(file, &fileSize) &&
+		fileSize.QuadPart > 0 &&
+		fileSize.QuadPart <= INT_MAX)
+	{
+#if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+		HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+#else
+		HANDLE mapping = CreateFileMappingFromApp(file, NULL, PAGE_READONLY, 0, NULL);
+#endif
+		if (mapping)
+		{
+#if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+			view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+			view = MapViewOfFileFromApp(mapping, FILE_MAP_READ, 0, 0);
+#endif
+
+			// The view keeps the mapping and the file open
+			CloseHandle(mapping);
+		}
+	}
+
+	CloseHandle(file);
+	if (!view)
+	{
+		return 0;
+	}
+
+	*size = (int)fileSize.QuadPart;
+	return PTR_TO_LONG(view);
+}
+
+void nativeUnmap(int64_t lpointer)
+{
+	UnmapViewOfFile(LONG_TO_PTR(lpointer));
+}
+
+int nativeCopyFromMapping(int64_t dst, int64_t src, int count)
+{
+	__try
+	{
+		memcpy(LONG_TO_PTR(dst), LONG_TO_PTR(src), count);
+	}
+	__except (GetExceptionCode() == EXCEPTION_IN_PAGE_ERROR ?
+		EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH)
+	{
+		return 0;
+	}
+
+	return 1;
 }
 
 void nativeCopyToByteArray(int64_t lpointer, uint8_t* byteArray, int offset, int count)
@@ -44,3 +139,85 @@ uint8_t nativeReadByte(int64_t lpointer)
 {
 	return *((uint8_t*)LONG_TO_PTR(lpointer));
 }
+
+void nativeGatherCopy(
+	const int64_t* sources,
+	const int* counts,
+	int rangeCount,
+	uint8_t* byteArray,
+	int offset)
+{
+	uint8_t* dst = byteArray + offset;
+	for (int i = 0; i < rangeCount; ++i)
+	{
+		memcpy(dst, LONG_TO_PTR(sources[i]), counts[i]);
+		dst += counts[i];
+	}
+}
+
+void nativeScatterCopy(
+	const int64_t* destinations,
+	const int* counts,
+	int rangeCount,
+	const uint8_t* byteArray,
+	int offset)
+{
+	const uint8_t* src = byteArray + offset;
+	for (int i = 0; i < rangeCount; ++i)
+	{
+		memcpy(LONG_TO_PTR(destinations[i]), src, counts[i]);
+		src += counts[i];
+	}
+}
+
+int nativeCompare(int64_t lpointer, const uint8_t* byteArray, int offset, int count)
+{
+	return memcmp(LONG_TO_PTR(lpointer), byteArray + offset, count);
+}
+
+int nativeIndexOf(int64_t lpointer, int count, uint8_t value)
+{
+	const uint8_t* data = (const uint8_t*)LONG_TO_PTR(lpointer);
+	const uint8_t* found = (const uint8_t*)memchr(data, value, count);
+	return found ? (int)(found - data) : -1;
+}
+
+int nativeIndexOfSequence(
+	int64_t lpointer,
+	int count,
+	const uint8_t* pattern,
+	int patternLength)
+{
+	if (patternLength == 0)
+	{
+		return 0;
+	}
+
+	if (patternLength > count)
+	{
+		return -1;
+	}
+
+	// memchr finds candidates for the first byte far faster than a
+	// byte by byte comparison would
+	const uint8_t* data = (const uint8_t*)LONG_TO_PTR(lpointer);
+	const uint8_t* current = data;
+	const uint8_t* last = data + count - patternLength;
+	while (current <= last)
+	{
+		current = (const uint8_t*)memchr(current, pattern[0], last - current + 1);
+		if (!current)
+		{
+			break;
+		}
+
+		if (memcmp(current + 1, pattern + 1, patternLength - 1) == 0)
+		{
+			return (int)(current - data);
+		}
+
+		++current;
+	}
+
+	return -1;
+}
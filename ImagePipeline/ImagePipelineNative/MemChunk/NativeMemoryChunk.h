@@ -11,10 +11,46 @@
 
 EXTERN_C_BEGIN
 
+/**
+ * Allocates from the slab allocator, see slab_allocator.h.
+ */
 WIN_EXPORT int64_t nativeAllocate(int size);
 
 WIN_EXPORT void nativeFree(int64_t lpointer);
 
+/**
+ * Returns empty arenas of the allocator to the OS.
+ */
+WIN_EXPORT void nativeTrimAllocator();
+
+WIN_EXPORT void nativeGetAllocatorStats(
+	int64_t* reservedBytes,
+	int64_t* usedBytes,
+	int64_t* cachedBytes,
+	int* arenaCount,
+	int* largeBlockCount);
+
+/**
+ * Maps a whole file read-only, for its content to be read from the page
+ * cache instead of being copied into allocated memory.
+ *
+ * @param size set to the size of the file
+ * @return address of the mapping to be released by nativeUnmap, 0 if the
+ * file can't be opened, is empty or is larger than 2 GB
+ */
+WIN_EXPORT int64_t nativeMapFile(const wchar_t* path, int* size);
+
+WIN_EXPORT void nativeUnmap(int64_t lpointer);
+
+/**
+ * Copies count bytes of a mapping made by nativeMapFile. Pages are read in
+ * on access, so a truncated file or an I/O error raises
+ * EXCEPTION_IN_PAGE_ERROR rather than failing a read call.
+ *
+ * @return 1 if the bytes were copied, 0 if a page could not be read in
+ */
+WIN_EXPORT int nativeCopyFromMapping(int64_t dst, int64_t src, int count);
+
 WIN_EXPORT void nativeCopyToByteArray(int64_t lpointer, uint8_t* byteArray, int offset, int count);
 
 WIN_EXPORT void nativeCopyFromByteArray(int64_t lpointer, uint8_t* byteArray, int offset, int count);
@@ -23,4 +59,50 @@ WIN_EXPORT void nativeMemcpy(int64_t dst, int64_t src, int count);
 
 WIN_EXPORT uint8_t nativeReadByte(int64_t lpointer);
 
+/**
+ * Copies rangeCount ranges, each starting at sources[i] and counts[i]
+ * bytes long, back to back into byteArray starting at offset.
+ *
+ * <p> The ranges may belong to different chunks.
+ */
+WIN_EXPORT void nativeGatherCopy(
+	const int64_t* sources,
+	const int* counts,
+	int rangeCount,
+	uint8_t* byteArray,
+	int offset);
+
+/**
+ * Copies consecutive bytes of byteArray starting at offset to rangeCount
+ * ranges, each starting at destinations[i] and counts[i] bytes long.
+ */
+WIN_EXPORT void nativeScatterCopy(
+	const int64_t* destinations,
+	const int* counts,
+	int rangeCount,
+	const uint8_t* byteArray,
+	int offset);
+
+/**
+ * Compares count bytes at lpointer with the ones of byteArray starting
+ * at offset, same result as memcmp.
+ */
+WIN_EXPORT int nativeCompare(int64_t lpointer, const uint8_t* byteArray, int offset, int count);
+
+/**
+ * @return index of the first of count bytes at lpointer equal to value,
+ * -1 if none is
+ */
+WIN_EXPORT int nativeIndexOf(int64_t lpointer, int count, uint8_t value);
+
+/**
+ * @return index of the first occurrence of pattern within count bytes at
+ * lpointer, -1 if there is none
+ */
+WIN_EXPORT int nativeIndexOfSequence(
+	int64_t lpointer,
+	int count,
+	const uint8_t* pattern,
+	int patternLength);
+
 EXTERN_C_END
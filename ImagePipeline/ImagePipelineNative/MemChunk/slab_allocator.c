@@ -0,0 +1,752 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "slab_allocator.h"
+
+#define ARENA_SHIFT 21
+#define ARENA_SIZE ((size_t)1 << ARENA_SHIFT)
+#define ARENA_RETRIES 8
+
+// Blocks of 64 bytes to 1 MB, one class per power of two
+#define MIN_CLASS_SHIFT 6
+#define MAX_CLASS_SHIFT 20
+#define CLASS_COUNT (MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1)
+#define CLASS_SIZE(c) ((size_t)1 << ((c) + MIN_CLASS_SHIFT))
+
+// Arenas of classes from 64 KB are backed by large pages when the
+// process is allowed to lock them
+#define LARGE_PAGE_MIN_CLASS (16 - MIN_CLASS_SHIFT)
+
+// Freed blocks a thread keeps per class, at least one
+#define THREAD_CACHE_BYTES (256 * 1024)
+#define THREAD_CACHE_MAX_BLOCKS 32
+
+// Large blocks start after their size, keeping cache line alignment
+#define LARGE_HEADER_SIZE 64
+
+// Large blocks are mapped in multiples of the allocation granularity
+#define LARGE_GRANULARITY ((size_t)64 * 1024)
+
+// Freed large blocks kept for blocks at most a quarter smaller, the
+// oldest ones released first
+#define LARGE_CACHE_BYTES ((size_t)32 * 1024 * 1024)
+#define LARGE_CACHE_MAX_BLOCKS 8
+
+// Arena of an address is found in a two level table indexed by the
+// address divided by the arena size
+#ifdef _WIN64
+#define RADIX_LEAF_BITS 14
+#define RADIX_ROOT_BITS (48 - ARENA_SHIFT - RADIX_LEAF_BITS)
+#else
+#define RADIX_LEAF_BITS (32 - ARENA_SHIFT)
+#define RADIX_ROOT_BITS 0
+#endif
+
+typedef struct Arena
+{
+	uint8_t* base;
+	struct Arena* previous;
+	struct Arena* next;
+
+	// Freed blocks, each holding the next one
+	void* freeList;
+
+	// Blocks from this index on were never handed out
+	uint32_t fresh;
+	uint32_t used;
+	uint32_t capacity;
+	uint32_t sizeClass;
+	BOOL largePages;
+} Arena;
+
+typedef struct SizeClass
+{
+	SRWLOCK lock;
+
+	// Arenas with free blocks
+	Arena* available;
+	uint32_t emptyArenas;
+} SizeClass;
+
+typedef struct ThreadCache
+{
+	LONG generation;
+	BOOL registered;
+	struct ThreadCache* previous;
+	struct ThreadCache* next;
+
+	// Bytes of the cached blocks, only written by the owning thread
+	volatile LONG bytes;
+	uint32_t counts[CLASS_COUNT];
+	void* blocks[CLASS_COUNT][THREAD_CACHE_MAX_BLOCKS];
+} ThreadCache;
+
+static SizeClass s_classes[CLASS_COUNT];
+
+static Arena** s_radix[(size_t)1 << RADIX_ROOT_BITS];
+static SRWLOCK s_radixLock = SRWLOCK_INIT;
+
+// Bumped by slabTrim, threads flush their cache when they see it change.
+// Starts past the generation of new caches so they register first.
+static volatile LONG s_generation = 1;
+
+// Caches of the threads that allocated or freed, for slabGetStats
+static ThreadCache* s_threadCaches;
+static SRWLOCK s_threadCacheLock = SRWLOCK_INIT;
+
+// Set once an arena could not be backed by large pages, all later
+// arenas use regular pages
+static volatile LONG s_largePagesFailed;
+
+static volatile LONG64 s_reservedBytes;
+static volatile LONG64 s_usedBytes;
+static volatile LONG s_arenaCount;
+static volatile LONG s_largeBlockCount;
+
+// Freed large blocks, oldest first, each starting with its size
+static uint8_t* s_largeCache[LARGE_CACHE_MAX_BLOCKS];
+static uint32_t s_largeCacheCount;
+static size_t s_largeCacheBytes;
+static SRWLOCK s_largeCacheLock = SRWLOCK_INIT;
+
+static __declspec(thread) ThreadCache t_cache;
+
+static void* mapMemory(void* address, size_t size, DWORD allocationType)
+{
+#if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+	return VirtualAlloc(address, size, allocationType, PAGE_READWRITE);
+#else
+	return VirtualAllocFromApp(address, size, allocationType, PAGE_READWRITE);
+#endif
+}
+
+static uint32_t getSizeClass(size_t size)
+{
+	uint32_t sizeClass = 0;
+	while (CLASS_SIZE(sizeClass) < size)
+	{
+		++sizeClass;
+	}
+
+	return sizeClass;
+}
+
+static uint32_t getThreadCacheLimit(uint32_t sizeClass)
+{
+	size_t limit = THREAD_CACHE_BYTES / CLASS_SIZE(sizeClass);
+	if (limit < 1)
+	{
+		return 1;
+	}
+
+	return (uint32_t)(limit < THREAD_CACHE_MAX_BLOCKS ? limit : THREAD_CACHE_MAX_BLOCKS);
+}
+
+static Arena* findArena(const void* pointer)
+{
+	uintptr_t index = (uintptr_t)pointer >> ARENA_SHIFT;
+	Arena** leaf = s_radix[index >> RADIX_LEAF_BITS];
+	if (!leaf)
+	{
+		return NULL;
+	}
+
+	return leaf[index & (((uintptr_t)1 << RADIX_LEAF_BITS) - 1)];
+}
+
+static BOOL setArena(const uint8_t* base, Arena* arena)
+{
+	uintptr_t index = (uintptr_t)base >> ARENA_SHIFT;
+	BOOL result = TRUE;
+	AcquireSRWLockExclusive(&s_radixLock);
+	Arena*** leaf = &s_radix[index >> RADIX_LEAF_BITS];
+	if (!*leaf)
+	{
+		*leaf = (Arena**)calloc((size_t)1 << RADIX_LEAF_BITS, sizeof(Arena*));
+	}
+
+	if (*leaf)
+	{
+		(*leaf)[index & (((uintptr_t)1 << RADIX_LEAF_BITS) - 1)] = arena;
+	}
+	else
+	{
+		result = FALSE;
+	}
+
+	ReleaseSRWLockExclusive(&s_radixLock);
+	return result;
+}
+
+/**
+ * Maps 2 MB of memory starting at a multiple of 2 MB, so that the
+ * arena of any block is found from its address alone.
+ */
+static uint8_t* mapArena(BOOL tryLargePages, BOOL* largePages)
+{
+#if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+	// Without SeLockMemoryPrivilege the call fails and regular pages are
+	// used instead, it is not tried again as it would keep failing
+	if (tryLargePages && !s_largePagesFailed && GetLargePageMinimum() == ARENA_SIZE)
+	{
+		uint8_t* arena = (uint8_t*)VirtualAlloc(
+			NULL, ARENA_SIZE, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (arena)
+		{
+			*largePages = TRUE;
+			return arena;
+		}
+
+		s_largePagesFailed = TRUE;
+	}
+#else
+	(void)tryLargePages;
+#endif
+
+	*largePages = FALSE;
+	for (int attempt = 0; attempt < ARENA_RETRIES; ++attempt)
+	{
+		uint8_t* reserved = (uint8_t*)mapMemory(NULL, 2 * ARENA_SIZE, MEM_RESERVE);
+		if (!reserved)
+		{
+			return NULL;
+		}
+
+		uint8_t* aligned = (uint8_t*)(
+			((uintptr_t)reserved + ARENA_SIZE - 1) & ~(uintptr_t)(ARENA_SIZE - 1));
+		VirtualFree(reserved, 0, MEM_RELEASE);
+
+		// Another thread may map the range in between, then try again
+		uint8_t* arena = (uint8_t*)mapMemory(aligned, ARENA_SIZE, MEM_RESERVE | MEM_COMMIT);
+		if (arena)
+		{
+			return arena;
+		}
+	}
+
+	return NULL;
+}
+
+static Arena* createArena(uint32_t sizeClass)
+{
+	Arena* arena = (Arena*)calloc(1, sizeof(Arena));
+	if (!arena)
+	{
+		return NULL;
+	}
+
+	arena->base = mapArena(sizeClass >= LARGE_PAGE_MIN_CLASS, &arena->largePages);
+	if (!arena->base)
+	{
+		free(arena);
+		return NULL;
+	}
+
+	arena->capacity = (uint32_t)(ARENA_SIZE / CLASS_SIZE(sizeClass));
+	arena->sizeClass = sizeClass;
+	if (!setArena(arena->base, arena))
+	{
+		VirtualFree(arena->base, 0, MEM_RELEASE);
+		free(arena);
+		return NULL;
+	}
+
+	InterlockedExchangeAdd64(&s_reservedBytes, (LONG64)ARENA_SIZE);
+	InterlockedIncrement(&s_arenaCount);
+	return arena;
+}
+
+static void releaseArena(Arena* arena)
+{
+	setArena(arena->base, NULL);
+	VirtualFree(arena->base, 0, MEM_RELEASE);
+	free(arena);
+	InterlockedExchangeAdd64(&s_reservedBytes, -(LONG64)ARENA_SIZE);
+	InterlockedDecrement(&s_arenaCount);
+}
+
+static void linkArena(SizeClass* sizeClass, Arena* arena)
+{
+	arena->previous = NULL;
+	arena->next = sizeClass->available;
+	if (sizeClass->available)
+	{
+		sizeClass->available->previous = arena;
+	}
+
+	sizeClass->available = arena;
+}
+
+static void unlinkArena(SizeClass* sizeClass, Arena* arena)
+{
+	if (arena->previous)
+	{
+		arena->previous->next = arena->next;
+	}
+	else
+	{
+		sizeClass->available = arena->next;
+	}
+
+	if (arena->next)
+	{
+		arena->next->previous = arena->previous;
+	}
+
+	arena->previous = NULL;
+	arena->next = NULL;
+}
+
+/**
+ * Takes up to count blocks of given class out of the arenas, mapping a
+ * new arena if none has free blocks.
+ *
+ * @return number of blocks taken, 0 if out of memory
+ */
+static uint32_t takeBlocks(uint32_t index, void** blocks, uint32_t count)
+{
+	SizeClass* sizeClass = &s_classes[index];
+	const size_t blockSize = CLASS_SIZE(index);
+	uint32_t taken = 0;
+
+	AcquireSRWLockExclusive(&sizeClass->lock);
+	while (taken < count)
+	{
+		Arena* arena = sizeClass->available;
+		if (!arena)
+		{
+			if (taken > 0)
+			{
+				break;
+			}
+
+			arena = createArena(index);
+			if (!arena)
+			{
+				break;
+			}
+
+			linkArena(sizeClass, arena);
+			++sizeClass->emptyArenas;
+		}
+
+		if (arena->used == 0)
+		{
+			--sizeClass->emptyArenas;
+		}
+
+		while (taken < count && arena->used < arena->capacity)
+		{
+			void* block = arena->freeList;
+			if (block)
+			{
+				arena->freeList = *(void**)block;
+			}
+			else
+			{
+				block = arena->base + (size_t)arena->fresh * blockSize;
+				++arena->fresh;
+			}
+
+			++arena->used;
+			blocks[taken++] = block;
+		}
+
+		if (arena->used == arena->capacity)
+		{
+			unlinkArena(sizeClass, arena);
+		}
+	}
+
+	ReleaseSRWLockExclusive(&sizeClass->lock);
+
+	InterlockedExchangeAdd64(&s_usedBytes, (LONG64)(taken * blockSize));
+	return taken;
+}
+
+/**
+ * Returns blocks of given class to their arenas. A single empty arena
+ * per class is kept mapped, the others are released.
+ *
+ * @param trimming whether to release every arena left empty, once the
+ *        memory was trimmed
+ */
+static void returnBlocks(
+	uint32_t index,
+	void* const* blocks,
+	uint32_t count,
+	BOOL trimming)
+{
+	SizeClass* sizeClass = &s_classes[index];
+	AcquireSRWLockExclusive(&sizeClass->lock);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		Arena* arena = findArena(blocks[i]);
+		if (arena->used == arena->capacity)
+		{
+			linkArena(sizeClass, arena);
+		}
+
+		*(void**)blocks[i] = arena->freeList;
+		arena->freeList = blocks[i];
+		if (--arena->used > 0)
+		{
+			continue;
+		}
+
+		if (trimming || sizeClass->emptyArenas > 0)
+		{
+			unlinkArena(sizeClass, arena);
+			releaseArena(arena);
+			continue;
+		}
+
+		// Hand out blocks in address order again
+		arena->freeList = NULL;
+		arena->fresh = 0;
+		++sizeClass->emptyArenas;
+	}
+
+	ReleaseSRWLockExclusive(&sizeClass->lock);
+
+	InterlockedExchangeAdd64(&s_usedBytes, -(LONG64)(count * CLASS_SIZE(index)));
+}
+
+static void flushThreadCache(ThreadCache* cache, BOOL trimming)
+{
+	for (uint32_t index = 0; index < CLASS_COUNT; ++index)
+	{
+		if (cache->counts[index] > 0)
+		{
+			returnBlocks(index, cache->blocks[index], cache->counts[index], trimming);
+			cache->counts[index] = 0;
+		}
+	}
+
+	cache->bytes = 0;
+}
+
+static void registerThreadCache(ThreadCache* cache)
+{
+	AcquireSRWLockExclusive(&s_threadCacheLock);
+	cache->previous = NULL;
+	cache->next = s_threadCaches;
+	if (s_threadCaches)
+	{
+		s_threadCaches->previous = cache;
+	}
+
+	s_threadCaches = cache;
+	cache->registered = TRUE;
+	ReleaseSRWLockExclusive(&s_threadCacheLock);
+}
+
+static void unregisterThreadCache(ThreadCache* cache)
+{
+	AcquireSRWLockExclusive(&s_threadCacheLock);
+	if (cache->previous)
+	{
+		cache->previous->next = cache->next;
+	}
+	else
+	{
+		s_threadCaches = cache->next;
+	}
+
+	if (cache->next)
+	{
+		cache->next->previous = cache->previous;
+	}
+
+	cache->previous = NULL;
+	cache->next = NULL;
+	cache->registered = FALSE;
+	ReleaseSRWLockExclusive(&s_threadCacheLock);
+}
+
+/**
+ * Returns the cache of the calling thread, flushed first if the memory
+ * was trimmed since the thread last allocated or freed.
+ */
+static ThreadCache* getThreadCache(void)
+{
+	ThreadCache* cache = &t_cache;
+	LONG generation = s_generation;
+	if (cache->generation != generation)
+	{
+		if (!cache->registered)
+		{
+			registerThreadCache(cache);
+		}
+
+		flushThreadCache(cache, TRUE);
+		cache->generation = generation;
+	}
+
+	return cache;
+}
+
+static void unmapLarge(uint8_t* base)
+{
+	const size_t total = *(size_t*)base;
+	VirtualFree(base, 0, MEM_RELEASE);
+	InterlockedExchangeAdd64(&s_reservedBytes, -(LONG64)total);
+	InterlockedExchangeAdd64(&s_usedBytes, -(LONG64)total);
+	InterlockedDecrement(&s_largeBlockCount);
+}
+
+/**
+ * Takes the smallest cached large block of at least total bytes, if
+ * it is at most a quarter larger.
+ */
+static uint8_t* takeCachedLarge(size_t total)
+{
+	uint8_t* base = NULL;
+	AcquireSRWLockExclusive(&s_largeCacheLock);
+	uint32_t found = s_largeCacheCount;
+	for (uint32_t i = 0; i < s_largeCacheCount; ++i)
+	{
+		const size_t cached = *(size_t*)s_largeCache[i];
+		if (cached >= total &&
+			cached - total <= total / 4 &&
+			(found == s_largeCacheCount || cached < *(size_t*)s_largeCache[found]))
+		{
+			found = i;
+		}
+	}
+
+	if (found < s_largeCacheCount)
+	{
+		base = s_largeCache[found];
+		s_largeCacheBytes -= *(size_t*)base;
+		memmove(
+			s_largeCache + found,
+			s_largeCache + found + 1,
+			(--s_largeCacheCount - found) * sizeof(uint8_t*));
+	}
+
+	ReleaseSRWLockExclusive(&s_largeCacheLock);
+	return base;
+}
+
+/**
+ * Keeps a freed large block for reuse, releasing the oldest ones it
+ * does not fit next to. Blocks of more than half the cache are released
+ * right away.
+ */
+static void cacheLarge(uint8_t* base)
+{
+	const size_t total = *(size_t*)base;
+	if (total > LARGE_CACHE_BYTES / 2)
+	{
+		unmapLarge(base);
+		return;
+	}
+
+	uint8_t* released[LARGE_CACHE_MAX_BLOCKS];
+	uint32_t releasedCount = 0;
+	AcquireSRWLockExclusive(&s_largeCacheLock);
+	while (s_largeCacheCount == LARGE_CACHE_MAX_BLOCKS ||
+		s_largeCacheBytes + total > LARGE_CACHE_BYTES)
+	{
+		released[releasedCount] = s_largeCache[releasedCount];
+		s_largeCacheBytes -= *(size_t*)released[releasedCount];
+		--s_largeCacheCount;
+		++releasedCount;
+	}
+
+	memmove(s_largeCache, s_largeCache + releasedCount, s_largeCacheCount * sizeof(uint8_t*));
+	s_largeCache[s_largeCacheCount++] = base;
+	s_largeCacheBytes += total;
+	ReleaseSRWLockExclusive(&s_largeCacheLock);
+
+	// Unmapped out of the lock, other threads keep taking blocks
+	for (uint32_t i = 0; i < releasedCount; ++i)
+	{
+		unmapLarge(released[i]);
+	}
+}
+
+static void releaseCachedLarge(void)
+{
+	uint8_t* released[LARGE_CACHE_MAX_BLOCKS];
+	AcquireSRWLockExclusive(&s_largeCacheLock);
+	const uint32_t releasedCount = s_largeCacheCount;
+	memcpy(released, s_largeCache, releasedCount * sizeof(uint8_t*));
+	s_largeCacheCount = 0;
+	s_largeCacheBytes = 0;
+	ReleaseSRWLockExclusive(&s_largeCacheLock);
+
+	for (uint32_t i = 0; i < releasedCount; ++i)
+	{
+		unmapLarge(released[i]);
+	}
+}
+
+static void* allocateLarge(size_t size)
+{
+	if (size > (size_t)-1 - LARGE_HEADER_SIZE - LARGE_GRANULARITY)
+	{
+		return NULL;
+	}
+
+	const size_t total =
+		(size + LARGE_HEADER_SIZE + LARGE_GRANULARITY - 1) & ~(LARGE_GRANULARITY - 1);
+	uint8_t* base = takeCachedLarge(total);
+	if (base)
+	{
+		return base + LARGE_HEADER_SIZE;
+	}
+
+	base = (uint8_t*)mapMemory(NULL, total, MEM_RESERVE | MEM_COMMIT);
+	if (!base)
+	{
+		return NULL;
+	}
+
+	*(size_t*)base = total;
+	InterlockedExchangeAdd64(&s_reservedBytes, (LONG64)total);
+	InterlockedExchangeAdd64(&s_usedBytes, (LONG64)total);
+	InterlockedIncrement(&s_largeBlockCount);
+	return base + LARGE_HEADER_SIZE;
+}
+
+static void freeLarge(void* pointer)
+{
+	cacheLarge((uint8_t*)pointer - LARGE_HEADER_SIZE);
+}
+
+void* slabAllocate(size_t size)
+{
+	// Threads allocating large blocks only still flush after a trim
+	ThreadCache* cache = getThreadCache();
+	if (size > CLASS_SIZE(CLASS_COUNT - 1))
+	{
+		return allocateLarge(size);
+	}
+
+	const uint32_t index = getSizeClass(size);
+	if (cache->counts[index] == 0)
+	{
+		uint32_t refill = (getThreadCacheLimit(index) + 1) / 2;
+		cache->counts[index] = takeBlocks(index, cache->blocks[index], refill);
+		if (cache->counts[index] == 0)
+		{
+			return NULL;
+		}
+
+		cache->bytes += (LONG)(cache->counts[index] * CLASS_SIZE(index));
+	}
+
+	cache->bytes -= (LONG)CLASS_SIZE(index);
+	return cache->blocks[index][--cache->counts[index]];
+}
+
+void slabFree(void* pointer)
+{
+	if (!pointer)
+	{
+		return;
+	}
+
+	ThreadCache* cache = getThreadCache();
+
+	// The class of an arena never changes while it holds blocks
+	Arena* arena = findArena(pointer);
+	if (!arena)
+	{
+		freeLarge(pointer);
+		return;
+	}
+
+	const uint32_t index = arena->sizeClass;
+	const uint32_t limit = getThreadCacheLimit(index);
+	if (cache->counts[index] == limit)
+	{
+		// Keep the most recently freed half, likely still in cache
+		const uint32_t kept = limit / 2;
+		returnBlocks(index, cache->blocks[index], limit - kept, FALSE);
+		memmove(
+			cache->blocks[index],
+			cache->blocks[index] + (limit - kept),
+			kept * sizeof(void*));
+		cache->counts[index] = kept;
+		cache->bytes -= (LONG)((limit - kept) * CLASS_SIZE(index));
+	}
+
+	cache->bytes += (LONG)CLASS_SIZE(index);
+	cache->blocks[index][cache->counts[index]++] = pointer;
+}
+
+void slabTrim(void)
+{
+	// The calling thread flushes its cache right away, other threads on
+	// their next call, see getThreadCache
+	InterlockedIncrement(&s_generation);
+	getThreadCache();
+	releaseCachedLarge();
+
+	for (uint32_t index = 0; index < CLASS_COUNT; ++index)
+	{
+		SizeClass* sizeClass = &s_classes[index];
+		AcquireSRWLockExclusive(&sizeClass->lock);
+		Arena* arena = sizeClass->available;
+		while (arena && sizeClass->emptyArenas > 0)
+		{
+			Arena* next = arena->next;
+			if (arena->used == 0)
+			{
+				unlinkArena(sizeClass, arena);
+				releaseArena(arena);
+				--sizeClass->emptyArenas;
+			}
+
+			arena = next;
+		}
+
+		ReleaseSRWLockExclusive(&sizeClass->lock);
+	}
+}
+
+void slabFlushThreadCache(void)
+{
+	ThreadCache* cache = &t_cache;
+	flushThreadCache(cache, FALSE);
+
+	// The cache goes away with the thread, it registers again if the
+	// thread allocates once more
+	if (cache->registered)
+	{
+		unregisterThreadCache(cache);
+	}
+
+	cache->generation = 0;
+}
+
+void slabGetStats(SlabStats* stats)
+{
+	int64_t cachedBytes = 0;
+	AcquireSRWLockExclusive(&s_threadCacheLock);
+	for (const ThreadCache* cache = s_threadCaches; cache; cache = cache->next)
+	{
+		cachedBytes += cache->bytes;
+	}
+
+	ReleaseSRWLockExclusive(&s_threadCacheLock);
+
+	AcquireSRWLockExclusive(&s_largeCacheLock);
+	cachedBytes += (int64_t)s_largeCacheBytes;
+	ReleaseSRWLockExclusive(&s_largeCacheLock);
+
+	stats->reservedBytes = s_reservedBytes;
+	stats->usedBytes = s_usedBytes;
+	stats->cachedBytes = cachedBytes;
+	stats->arenaCount = s_arenaCount;
+	stats->largeBlockCount = s_largeBlockCount;
+}
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef _SLAB_ALLOCATOR_H_
+#define _SLAB_ALLOCATOR_H_
+
+#include "common.h"
+
+EXTERN_C_BEGIN
+
+/**
+ * Memory held by the slab allocator.
+ */
+typedef struct SlabStats
+{
+	// Bytes reserved from the OS, arenas and large blocks
+	int64_t reservedBytes;
+
+	// Bytes of blocks handed out, including the ones cached for reuse
+	int64_t usedBytes;
+
+	// Bytes of freed blocks cached by threads and of freed large blocks
+	// kept for reuse
+	int64_t cachedBytes;
+
+	int32_t arenaCount;
+
+	// Mapped large blocks, including the ones kept for reuse
+	int32_t largeBlockCount;
+} SlabStats;
+
+/**
+ * Allocates size bytes, 16-byte aligned.
+ *
+ * <p> Sizes up to 1 MB are rounded up to a power of two and carved out
+ * of 2 MB arenas holding blocks of a single size. Each thread keeps a
+ * few freed blocks per size to reuse without locking. Larger sizes are
+ * mapped from the OS directly. Up to 32 MB of them are kept once freed,
+ * to be handed out again for sizes at most a quarter smaller.
+ *
+ * @return null if out of memory
+ */
+void* slabAllocate(size_t size);
+
+/**
+ * Frees memory returned by slabAllocate, null is ignored.
+ */
+void slabFree(void* pointer);
+
+/**
+ * Returns the empty arenas and the freed large blocks to the OS. Blocks
+ * cached by other threads go back to their arenas the next time those
+ * threads allocate or free, arenas they leave empty are then released
+ * as well.
+ */
+void slabTrim(void);
+
+/**
+ * Returns the blocks cached by the calling thread to their arenas. Has
+ * to be called before a thread that allocated or freed exits, as
+ * slabGetStats reads the cache of every such thread.
+ */
+void slabFlushThreadCache(void);
+
+void slabGetStats(SlabStats* stats);
+
+EXTERN_C_END
+
+#endif // _SLAB_ALLOCATOR_H_
@@ -8,14 +8,19 @@
  */
 
 #include "common.h"
+#include "MemChunk/slab_allocator.h"
 
 BOOL APIENTRY DllMain(HMODULE /* hModule */, DWORD ul_reason_for_call, LPVOID /* lpReserved */)
 {
     switch (ul_reason_for_call)
     {
+		case DLL_THREAD_DETACH:
+			// Blocks cached by the thread would never be reused
+			slabFlushThreadCache();
+			break;
+
 		case DLL_PROCESS_ATTACH:
 		case DLL_THREAD_ATTACH:
-		case DLL_THREAD_DETACH:
 		case DLL_PROCESS_DETACH:
 			break;
     }